@@ -356,11 +356,64 @@ add_subtree(netsnmp_subtree *new_tree, const char *context_name)
     return ptr->first_subtree;
 }
 
+/*
+ * The subtree most recently merged in by netsnmp_subtree_load(), and the
+ * context it belongs to.  Registrations (notably those arriving from an
+ * AgentX subagent, or a table registering one row at a time) usually come
+ * in ascending order, so the next one can be found by walking on from
+ * here rather than from the start of the context's list.
+ */
+static netsnmp_subtree *subtree_load_hint = NULL;
+static char    *subtree_load_hint_context = NULL;
+
+static void
+netsnmp_subtree_load_hint_set(netsnmp_subtree *tree, const char *context_name)
+{
+    if (!context_name)
+        context_name = "";
+    if (!subtree_load_hint_context ||
+        strcmp(subtree_load_hint_context, context_name) != 0) {
+        SNMP_FREE(subtree_load_hint_context);
+        subtree_load_hint_context = strdup(context_name);
+        if (!subtree_load_hint_context)
+            tree = NULL;
+    }
+    subtree_load_hint = tree;
+}
+
+/*
+ * Returns the hint if it's usable as the starting point of a search for
+ * new_sub: same context, still linked into the top level list (rather
+ * than having been pushed down to a child by a higher priority
+ * registration), and not beyond the start of new_sub.
+ */
+static netsnmp_subtree *
+netsnmp_subtree_load_hint_get(const netsnmp_subtree *new_sub,
+                              const char *context_name)
+{
+    netsnmp_subtree *hint = subtree_load_hint;
+
+    if (!context_name)
+        context_name = "";
+    if (!hint || strcmp(subtree_load_hint_context, context_name) != 0)
+        return NULL;
+    if (hint->prev ? hint->prev->next != hint :
+        netsnmp_subtree_find_first(context_name) != hint)
+        return NULL;
+    if (snmp_oid_compare(new_sub->start_a, new_sub->start_len,
+                         hint->start_a, hint->start_len) < 0)
+        return NULL;
+    return hint;
+}
+
 void
 netsnmp_remove_subtree(netsnmp_subtree *tree)
 {
     subtree_context_cache *ptr;
 
+    if (tree == subtree_load_hint)
+        subtree_load_hint = NULL;
+
     if (!tree->prev) {
         for (ptr = context_subtrees; ptr; ptr = ptr->next)
             if (ptr->first_subtree == tree)
@@ -434,6 +487,8 @@ clear_context(void) {
     }
     context_subtrees = NULL; /* !!! */
     clear_lookup_cache();
+    subtree_load_hint = NULL;
+    SNMP_FREE(subtree_load_hint_context);
 }
 
 /**  @} */
@@ -460,6 +515,8 @@ void
 netsnmp_subtree_free(netsnmp_subtree *a)
 {
   if (a != NULL) {
+    if (a == subtree_load_hint)
+      subtree_load_hint = NULL;
     if (a->variables != NULL && netsnmp_oid_equals(a->name_a, a->namelen, 
 					     a->start_a, a->start_len) == 0) {
       SNMP_FREE(a->variables);
@@ -752,7 +809,7 @@ int
 netsnmp_subtree_load(netsnmp_subtree *new_sub, const char *context_name)
 {
     netsnmp_subtree *tree1, *tree2;
-    netsnmp_subtree *prev, *next;
+    netsnmp_subtree *prev, *next, *hint;
 
     if (new_sub == NULL) {
         return MIB_REGISTERED_OK;       /* Degenerate case */
@@ -778,15 +835,16 @@ netsnmp_subtree_load(netsnmp_subtree *new_sub, const char *context_name)
     /*  Find the subtree that contains the start of the new subtree (if
 	any)...*/
 
+    hint = netsnmp_subtree_load_hint_get(new_sub, context_name);
     tree1 = netsnmp_subtree_find(new_sub->start_a, new_sub->start_len, 
-				 NULL, context_name);
+				 hint, context_name);
 
     /*  ... and the subtree that follows the new one (NULL implies this is the
 	final region covered).  */
 
     if (tree1 == NULL) {
 	tree2 = netsnmp_subtree_find_next(new_sub->start_a, new_sub->start_len,
-					  NULL, context_name);
+					  hint, context_name);
     } else {
 	tree2 = tree1->next;
     }
@@ -811,7 +869,7 @@ netsnmp_subtree_load(netsnmp_subtree *new_sub, const char *context_name)
 	} else {
             netsnmp_subtree_change_prev(new_sub,
                                         netsnmp_subtree_find_prev(new_sub->start_a,
-                                                                  new_sub->start_len, NULL, context_name));
+                                                                  new_sub->start_len, hint, context_name));
 
 	    if (new_sub->prev) {
                 netsnmp_subtree_change_next(new_sub->prev, new_sub);
@@ -938,6 +996,7 @@ netsnmp_subtree_load(netsnmp_subtree *new_sub, const char *context_name)
             }
         }
     }
+    netsnmp_subtree_load_hint_set(new_sub, context_name);
     return 0;
 }
 
@@ -1593,6 +1652,9 @@ netsnmp_subtree_unload(netsnmp_subtree *sub, netsnmp_subtree *prev, const char *
     }
     DEBUGMSG(("register_mib", ")\n"));
 
+    if (sub == subtree_load_hint)
+        subtree_load_hint = NULL;
+
     if (prev != NULL) {         /* non-leading entries are easy */
         prev->children = sub->children;
         invalidate_lookup_cache(context);
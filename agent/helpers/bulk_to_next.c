@@ -61,11 +61,12 @@ netsnmp_bulk_to_next_fix_requests(netsnmp_request_info *requests)
             request->requestvb = request->requestvb->next_variable;
             request->requestvb->type = ASN_PRIV_RETRY;
             /*
-             * if inclusive == 2, it was set in check_getnext_results for
-             * the previous requestvb. Now that we've moved on, clear it.
+             * an inclusive search was for the previous requestvb, be it
+             * set in check_getnext_results (inclusive == 2) or by an
+             * AgentX GetBulk's include flag.  The next repetition starts
+             * after its answer, so clear it now that we've moved on.
              */
-            if (2 == request->inclusive)
-                request->inclusive = 0;
+            request->inclusive = 0;
         }
     }
 }
@@ -26,6 +26,7 @@ netsnmp_feature_child_of(cache_handler, mib_helpers)
 
 netsnmp_feature_child_of(cache_find_by_oid, cache_handler)
 netsnmp_feature_child_of(cache_get_head, cache_handler)
+netsnmp_feature_child_of(cache_hint_range, cache_handler)
 
 static netsnmp_cache  *cache_head = NULL;
 static int             cache_outstanding_valid = 0;
@@ -93,6 +94,11 @@ void            release_cached_resources(unsigned int regNo,
  *  not be used if cache is not synchronized automatically as it would
  *  result in stale cache information when if polling happens too fast.
  *
+ *  NETSNMP_CACHE_PARTIAL_LOAD is set by the load_cache routine itself,
+ *  when it only loaded what the current request needs (see
+ *  netsnmp_cache_hint_range()). The cache is then only used for that
+ *  request, and the next one reloads it. The flag is cleared again.
+ *
  *
  *  Here are some suggestions for some common situations.
  *
@@ -364,6 +370,7 @@ netsnmp_cache_timer_stop(netsnmp_cache *cache)
                "stopping timer %lu for cache %p\n", cache->timer_id, cache));
 
     snmp_alarm_unregister(cache->timer_id);
+    cache->timer_id = 0;
     cache->flags |= NETSNMP_CACHE_AUTO_RELOAD;
 }
 
@@ -567,6 +574,103 @@ netsnmp_is_cache_valid(netsnmp_agent_request_info * reqinfo)
 }
 #endif /* NETSNMP_FEATURE_REMOVE_NETSNMP_IS_CACHE_VALID */
 
+#ifndef NETSNMP_FEATURE_REMOVE_CACHE_HINT_RANGE
+/** Which part of a table does the request loading its cache need?
+ *
+ * For load_cache routines of large tables, which can load a single row
+ * much more cheaply than the whole table. A GET whose varbinds are all
+ * for the same row only needs that row, and a GETNEXT whose varbinds
+ * all follow the same index, in valid columns, only needs the first row
+ * after it.
+ *
+ * If the cache was loaded less than its timeout ago, the table is being
+ * walked or polled, and the whole table is needed: it is cheaper to
+ * load it once than to load a row for every request.
+ *
+ * A load_cache routine that only loads the range must set
+ * NETSNMP_CACHE_PARTIAL_LOAD. If it finds no row after the index for a
+ * GETNEXT, the next row is in another column, and it has to load the
+ * whole table after all.
+ *
+ * @param cache the cache being loaded
+ * @param range filled in with the part of the table needed
+ *
+ * @return 1 if range was filled in, 0 if the whole table is needed
+ */
+int
+netsnmp_cache_hint_range(netsnmp_cache *cache, netsnmp_cache_range *range)
+{
+    netsnmp_handler_args *hint;
+    netsnmp_table_registration_info *tbl_info;
+    netsnmp_request_info *request;
+    const oid      *rootoid;
+    size_t          rootoid_len, len;
+    unsigned int    column;
+    int             found = 0;
+
+    if (!cache || !range || !(hint = cache->cache_hint))
+        return 0;
+    if (MODE_GET != hint->reqinfo->mode &&
+        MODE_GETNEXT != hint->reqinfo->mode)
+        return 0;
+    /** a GETBULK arrives here as a GETNEXT, but needs more rows */
+    if (hint->reqinfo->asp && hint->reqinfo->asp->pdu &&
+        SNMP_MSG_GETBULK == hint->reqinfo->asp->pdu->command)
+        return 0;
+    if (cache->timestamp &&
+        !atime_ready(cache->timestamp, 1000 * cache->timeout))
+        return 0;
+
+    tbl_info = netsnmp_find_table_registration_info(hint->reginfo);
+    if (!tbl_info)
+        return 0;
+    rootoid = hint->reginfo->rootoid;
+    rootoid_len = hint->reginfo->rootoid_len;
+
+    range->exact = (MODE_GET == hint->reqinfo->mode);
+    for (request = hint->requests; request; request = request->next) {
+        const netsnmp_variable_list *var = request->requestvb;
+
+        /** table.entry.column.index */
+        if (var->name_length < rootoid_len + 2 ||
+            snmp_oid_compare(var->name, rootoid_len,
+                             rootoid, rootoid_len) != 0 ||
+            var->name[rootoid_len] != 1)
+            return 0;
+        column = var->name[rootoid_len + 1];
+        if (!range->exact &&
+            (column < tbl_info->min_column ||
+             column > tbl_info->max_column ||
+             (tbl_info->valid_columns &&
+              netsnmp_closest_column(column, tbl_info->valid_columns) !=
+              column)))
+            return 0;
+
+        len = var->name_length - rootoid_len - 2;
+        if (!found) {
+            memcpy(range->index_oid, var->name + rootoid_len + 2,
+                   len * sizeof(oid));
+            range->index.oids = range->index_oid;
+            range->index.len = len;
+            found = 1;
+        } else if (snmp_oid_compare(range->index.oids, range->index.len,
+                                    var->name + rootoid_len + 2, len) != 0)
+            return 0;
+    }
+
+    if (found) {
+        DEBUGMSGTL(("helper:cache_handler", "%s only needs the row %s ",
+                    hint->reginfo->handlerName,
+                    range->exact ? "at" : "after"));
+        if (range->index.len)
+            DEBUGMSGSUBOID(("helper:cache_handler", range->index.oids,
+                            range->index.len));
+        DEBUGMSG(("helper:cache_handler", "\n"));
+    }
+    return found;
+}
+#endif /* NETSNMP_FEATURE_REMOVE_CACHE_HINT_RANGE */
+
 /** Implements the cache handler */
 int
 netsnmp_cache_helper_handler(netsnmp_mib_handler * handler,
@@ -667,10 +771,17 @@ netsnmp_cache_helper_handler(netsnmp_mib_handler * handler,
         snmp_log(LOG_WARNING, "cache_handler: Unrecognised mode (%d)\n",
                  reqinfo->mode);
         netsnmp_request_set_error_all(requests, SNMP_ERR_GENERR);
+        cache->cache_hint = NULL;
         return SNMP_ERR_GENERR;
     }
     if (cache->flags & NETSNMP_CACHE_RESET_TIMER_ON_USE)
         atime_setMarker(cache->timestamp);
+
+    /*
+     * cache_hint is on our stack: don't leave it for a load made
+     * outside a request (a timer, say) to find
+     */
+    cache->cache_hint = NULL;
     return SNMP_ERR_NOERROR;
 }
 
@@ -721,6 +832,12 @@ _cache_load( netsnmp_cache *cache )
         cache->timestamp = atime_newMarker();
     DEBUGMSGT(("helper:cache_handler", " loaded (%d)\n", cache->timeout));
 
+    if (cache->flags & NETSNMP_CACHE_PARTIAL_LOAD) {
+        DEBUGMSGT(("helper:cache_handler", " partial load\n"));
+        cache->flags &= ~NETSNMP_CACHE_PARTIAL_LOAD;
+        cache->expired = 1;
+    }
+
     return ret;
 }
 
@@ -22,6 +22,10 @@
 #include <net-snmp/net-snmp-includes.h>
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 
+#ifdef USING_IF_MIB_DATA_ACCESS_INTERFACE_MODULE
+#include <net-snmp/data_access/interface.h>
+#endif
+
 #include "agutil.h"
 #include "agutil_api.h"
 
@@ -208,10 +212,40 @@ AGUTIL_sys_up_time(void)
     return delta.tv_sec * 100 + delta.tv_usec / 10000;
 }
 
+#if !OPTICALL_ACESS && defined(USING_IF_MIB_DATA_ACCESS_INTERFACE_MODULE)
+/*
+ * The statistics of all the interfaces are loaded together, and
+ * this snapshot is shared by every row sampled (or retrieved)
+ * within the same second.
+ */
+static netsnmp_container *eth_stats_container = NULL;
+static time_t   eth_stats_loaded = 0;
+
+static netsnmp_container *
+SYSTEM_load_eth_statistics(void)
+{
+    time_t          curr_time = time(NULL);
+
+    if (eth_stats_container && curr_time == eth_stats_loaded)
+        return eth_stats_container;
+
+    if (eth_stats_container)
+        netsnmp_access_interface_container_free(eth_stats_container,
+                                                NETSNMP_ACCESS_INTERFACE_FREE_NOFLAGS);
+    eth_stats_container =
+        netsnmp_access_interface_container_load(NULL,
+                                                NETSNMP_ACCESS_INTERFACE_LOAD_NOFLAGS);
+    eth_stats_loaded = curr_time;
+    if (!eth_stats_container)
+        ag_trace("Err: can't load the interface statistics");
+    return eth_stats_container;
+}
+#endif
+
 /*
  * NOTE: this function is a template for system dependent
- * implementation. Actually it (in debug purposes) returns
- * random (but likely) data */
+ * implementation. Without the interface data access (and
+ * in debug purposes) it returns random (but likely) data */
 void
 SYSTEM_get_eth_statistics(VAR_OID_T * data_source, ETH_STATS_T * where)
 {
@@ -219,6 +253,38 @@ SYSTEM_get_eth_statistics(VAR_OID_T * data_source, ETH_STATS_T * where)
     where->ifIndex = data_source->objid[data_source->length - 1];
     agent_get_Rmon_ethernet_statistics(where->ifIndex, 1,       /* exact */
                                        where);
+#elif defined(USING_IF_MIB_DATA_ACCESS_INTERFACE_MODULE)
+    netsnmp_container *container;
+    netsnmp_interface_entry *ifentry = NULL;
+    netsnmp_interface_stats *stats;
+
+    memset(where, 0, sizeof(ETH_STATS_T));
+    where->ifIndex = data_source->objid[data_source->length - 1];
+
+    container = SYSTEM_load_eth_statistics();
+    if (container)
+        ifentry = netsnmp_access_interface_entry_get_by_index(container,
+                                                              where->ifIndex);
+    if (!ifentry)
+        return;
+
+    /*
+     * Only the counters kept for every interface are available;
+     * the others (CRC/alignment errors, undersize, oversize,
+     * fragments, jabbers and the packet size distribution) stay zero.
+     * ifInErrors counts more than CRC and alignment errors, so it
+     * isn't used for etherStatsCRCAlignErrors.
+     */
+    stats = &ifentry->stats;
+    where->octets = stats->ibytes.low;
+    if (ifentry->ns_flags & NETSNMP_INTERFACE_FLAGS_CALCULATE_UCAST)
+        where->packets = stats->iall.low;
+    else
+        where->packets = stats->iucast.low + stats->imcast.low +
+            stats->ibcast.low;
+    where->bcast_pkts = stats->ibcast.low;
+    where->mcast_pkts = stats->imcast.low;
+    where->collisions = stats->collisions;
 #else                           /* OPTICALL_ACESS */
     static ETH_STATS_T prev = { -1, -1 };
     static time_t   ifLastRead = 0;
@@ -26,6 +26,25 @@ netsnmp_feature_require(table_tdata_insert_row)
 netsnmp_feature_require(iquery_pdu_session)
 #endif /* NETSNMP_NO_WRITE_SUPPORT */
 
+/*
+ * Alarms are sampled in groups, one group per alarmInterval: each
+ * time a group runs, the variables of its alarms are retrieved
+ * together (a batch of varbinds per internal GET request), and all
+ * the thresholds are then checked against these values.
+ */
+#define ALARMTABLE_MAX_GET  64    /* varbinds per internal GET request */
+
+struct alarmTable_group {
+    long            interval;
+    unsigned int    alarm_reg;
+    unsigned int    startup_reg;
+    int             count;      /* alarms in this group */
+    struct alarmTable_group *next;
+};
+
+static struct alarmTable_group *alarmTable_groups = NULL;
+static netsnmp_tdata *alarmTable_data = NULL;
+
 /** Initializes the alarmTable module */
 void
 init_alarmTable(void)
@@ -55,6 +74,7 @@ initialize_table_alarmTable(void)
                                             HANDLER_CAN_RWRITE);
 
     table_data = netsnmp_tdata_create_table("alarmTable", 0);
+    alarmTable_data = table_data;
     table_info = SNMP_MALLOC_TYPEDEF(netsnmp_table_registration_info);
     netsnmp_table_helper_add_indexes(table_info, ASN_INTEGER,   /* index: alarmIndex */
                                      0);
@@ -139,42 +159,21 @@ struct alarmTable_entry {
     long            old_alarmStatus;
 
     int             valid;
-    unsigned int    alarm_reg;
+    struct alarmTable_group *group;
+    int             first;      /* not sampled since being enabled */
     netsnmp_session *session;
     u_long          last_abs_value;
     ALARM_TYPE_T    prev_alarm;        /* NOTHING | RISING | FALLING */
 };
 
 
-void
-alarmTable_run( unsigned int reg, void *clientarg)
+/*
+ * Check a sampled value of the alarm variable against the thresholds
+ */
+static void
+alarmTable_check(struct alarmTable_entry *entry, netsnmp_variable_list *var)
 {
-    struct alarmTable_entry *entry = (struct alarmTable_entry *)clientarg;
-    netsnmp_variable_list *var;
     u_long new_value;
-    int rc;
-
-    if (!entry) {
-        snmp_alarm_unregister( reg );
-        return;
-    }
-    /*
-     * Retrieve the requested MIB value(s)...
-     */
-    DEBUGMSGTL(( "rmon:alarmTable", "alarmTable_run called\n"));
-    var = (netsnmp_variable_list *)SNMP_MALLOC_TYPEDEF( netsnmp_variable_list );
-    if (!var) {
-        snmp_log(LOG_ERR,"failed to create alarmTable query varbind");
-        return;
-    }
-    snmp_set_var_objid( var, entry->alarmVariable,
-                             entry->alarmVariable_len );
-    
-    rc = netsnmp_query_get(  var, entry->session );
-    if ( rc != SNMP_ERR_NOERROR ) {
-        DEBUGMSGTL(( "rmon:alarmTable", "alarmVariable query failed (%d)\n", rc));
-        return;
-    }
 
 	switch (var->type) {
     case ASN_INTEGER:
@@ -225,44 +224,226 @@ alarmTable_run( unsigned int reg, void *clientarg)
             snmp_log(LOG_ERR,"failed to send falling alarm\n");
     }
     else
-        snmp_log(LOG_ERR,"no alarm sent\n");
+        DEBUGMSGTL(("rmon:alarmTable", "alarmIndex.%ld no alarm sent\n",
+                    entry->alarmIndex));
 }
 
 void
-alarmTable_enable( struct alarmTable_entry *entry )
+alarmTable_run( unsigned int reg, void *clientarg)
 {
-    if (!entry)
+    struct alarmTable_entry *entry = (struct alarmTable_entry *)clientarg;
+    netsnmp_variable_list *var;
+    int rc;
+
+    if (!entry) {
+        snmp_alarm_unregister( reg );
+        return;
+    }
+    /*
+     * Retrieve the requested MIB value(s)...
+     */
+    DEBUGMSGTL(( "rmon:alarmTable", "alarmTable_run called\n"));
+    var = (netsnmp_variable_list *)SNMP_MALLOC_TYPEDEF( netsnmp_variable_list );
+    if (!var) {
+        snmp_log(LOG_ERR,"failed to create alarmTable query varbind");
+        return;
+    }
+    snmp_set_var_objid( var, entry->alarmVariable,
+                             entry->alarmVariable_len );
+    
+    rc = netsnmp_query_get(  var, entry->session );
+    if ( rc != SNMP_ERR_NOERROR ) {
+        DEBUGMSGTL(( "rmon:alarmTable", "alarmVariable query failed (%d)\n", rc));
+        snmp_free_varbind(var);
+        return;
+    }
+
+    alarmTable_check(entry, var);
+    snmp_free_varbind(var);
+}
+
+struct alarmTable_batch {
+    netsnmp_session       *session;
+    netsnmp_variable_list *list, *last;
+    struct alarmTable_entry *entries[ALARMTABLE_MAX_GET];
+    int                    count;
+};
+
+static void
+alarmTable_run_batch(struct alarmTable_batch *batch)
+{
+    netsnmp_variable_list *var;
+    int i, rc;
+
+    if (!batch->count)
         return;
+    rc = netsnmp_query_get(batch->list, batch->session);
 
-    DEBUGMSGTL(( "rmon:alarmTable", "alarmTable_enable called.\n"));
-    if (entry->alarm_reg) {
-        snmp_alarm_unregister( entry->alarm_reg );
-        entry->alarm_reg = 0;
+    /*
+     * The results should line up with the request.  If they don't
+     *   (or the request failed), each alarm is sampled on its own.
+     * A variable that failed is dropped from the request and retried
+     *   without it, which can leave its varbind still NULL.
+     */
+    for (i = 0, var = batch->list;
+         rc == SNMP_ERR_NOERROR && i < batch->count;
+         i++, var = var->next_variable) {
+        if (!var || var->type == ASN_NULL ||
+            snmp_oid_compare(var->name, var->name_length,
+                             batch->entries[i]->alarmVariable,
+                             batch->entries[i]->alarmVariable_len))
+            rc = SNMP_ERR_GENERR;
     }
+    DEBUGMSGTL(("rmon:alarmTable", "got %d values: %d\n",
+                batch->count, rc));
+    for (i = 0, var = batch->list; i < batch->count; i++) {
+        if (rc == SNMP_ERR_NOERROR) {
+            alarmTable_check(batch->entries[i], var);
+            var = var->next_variable;
+        } else
+            alarmTable_run(0, batch->entries[i]);
+    }
+    snmp_free_varbind(batch->list);
+    batch->list  = NULL;
+    batch->last  = NULL;
+    batch->count = 0;
+}
 
-    if (entry->alarmInterval) {
-        /*
-         * register once to run ASAP, and another to run
-         * at the trigger frequency
-         */
-        snmp_alarm_register(0, 0, alarmTable_run, entry );
-        entry->alarm_reg = snmp_alarm_register(
-                           entry->alarmInterval, SA_REPEAT,
-                           alarmTable_run, entry );
+static void
+alarmTable_batch_add(struct alarmTable_batch *batch,
+                     struct alarmTable_entry *entry)
+{
+    netsnmp_variable_list *var;
+
+    if (batch->count && batch->session != entry->session)
+        alarmTable_run_batch(batch);
+
+    var = SNMP_MALLOC_TYPEDEF(netsnmp_variable_list);
+    if (!var) {
+        snmp_log(LOG_ERR,"failed to create alarmTable query varbind");
+        return;
+    }
+    snmp_set_var_objid(var, entry->alarmVariable, entry->alarmVariable_len);
+    snmp_set_var_typed_value(var, ASN_NULL, NULL, 0);
+    if (batch->last)
+        batch->last->next_variable = var;
+    else
+        batch->list = var;
+    batch->last = var;
+    batch->session = entry->session;
+    batch->entries[batch->count++] = entry;
+
+    if (batch->count == ALARMTABLE_MAX_GET)
+        alarmTable_run_batch(batch);
+}
+
+/*
+ * Sample the alarms in this group (or just the newly enabled ones)
+ */
+static void
+alarmTable_run_group(struct alarmTable_group *group, int first)
+{
+    struct alarmTable_batch batch;
+    struct alarmTable_entry *entry;
+    netsnmp_tdata_row *row;
+
+    DEBUGMSGTL(("rmon:alarmTable", "Sampling %ld second alarms%s\n",
+                group->interval, first ? " (new)" : ""));
+    memset(&batch, 0, sizeof(batch));
+    for (row = netsnmp_tdata_row_first(alarmTable_data);
+         row;
+         row = netsnmp_tdata_row_next(alarmTable_data, row)) {
+        entry = (struct alarmTable_entry *)row->data;
+        if (entry->group != group || (first && !entry->first))
+            continue;
+        entry->first = 0;
+        alarmTable_batch_add(&batch, entry);
     }
+    alarmTable_run_batch(&batch);
+}
+
+static void
+alarmTable_group_run( unsigned int reg, void *clientarg)
+{
+    alarmTable_run_group((struct alarmTable_group *)clientarg, 0);
+}
+
+static void
+alarmTable_group_startup( unsigned int reg, void *clientarg)
+{
+    struct alarmTable_group *group = (struct alarmTable_group *)clientarg;
+
+    group->startup_reg = 0;
+    alarmTable_run_group(group, 1);
 }
 
 void
 alarmTable_disable( struct alarmTable_entry *entry )
 {
+    struct alarmTable_group *group, **gp;
+
     if (!entry)
         return;
 
     DEBUGMSGTL(( "rmon:alarmTable", "alarmTable_disable called.\n"));
-    if (entry->alarm_reg) {
-        snmp_alarm_unregister( entry->alarm_reg );
-        entry->alarm_reg = 0;
+    group = entry->group;
+    if (group) {
+        entry->group = NULL;
+        entry->first = 0;
         /* XXX - perhaps release any previous results */
+        if (--group->count > 0)
+            return;
+
+        for (gp = &alarmTable_groups; *gp; gp = &(*gp)->next)
+            if (*gp == group) {
+                *gp = group->next;
+                break;
+            }
+        snmp_alarm_unregister( group->alarm_reg );
+        if (group->startup_reg)
+            snmp_alarm_unregister( group->startup_reg );
+        SNMP_FREE(group);
+    }
+}
+
+void
+alarmTable_enable( struct alarmTable_entry *entry )
+{
+    struct alarmTable_group *group;
+
+    if (!entry)
+        return;
+
+    DEBUGMSGTL(( "rmon:alarmTable", "alarmTable_enable called.\n"));
+    alarmTable_disable( entry );
+
+    if (entry->alarmInterval) {
+        for (group = alarmTable_groups; group; group = group->next)
+            if (group->interval == entry->alarmInterval)
+                break;
+        if (!group) {
+            group = SNMP_MALLOC_TYPEDEF(struct alarmTable_group);
+            if (!group) {
+                snmp_log(LOG_ERR,"failed to create alarmTable group\n");
+                return;
+            }
+            group->interval  = entry->alarmInterval;
+            group->alarm_reg = snmp_alarm_register(
+                               group->interval, SA_REPEAT,
+                               alarmTable_group_run, group );
+            group->next = alarmTable_groups;
+            alarmTable_groups = group;
+        }
+        group->count++;
+        entry->group = group;
+
+        /*
+         * run once ASAP, as well as at the alarm interval
+         */
+        entry->first = 1;
+        if (!group->startup_reg)
+            group->startup_reg = snmp_alarm_register(0, 0,
+                                     alarmTable_group_startup, group );
     }
 }
 
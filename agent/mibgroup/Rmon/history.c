@@ -97,9 +97,21 @@ typedef struct data_struct_t {
     ETH_STATS_T     EthData;
 } DATA_ENTRY_T;
 
+/*
+ * Control rows are sampled in groups, one group per interval:
+ * each time a group runs, a bucket is filled for every valid row
+ * with that interval, from one snapshot of the interface statistics.
+ */
+typedef struct hist_group_t {
+    struct hist_group_t *next;
+    u_long          interval;
+    unsigned int    timer_id;
+    int             count;      /* rows in this group */
+} HIST_GROUP_T;
+
 typedef struct {
     u_long          interval;
-    u_long          timer_id;
+    HIST_GROUP_T   *group;
     VAR_OID_T       data_source;
 
     u_long          coeff;
@@ -110,6 +122,7 @@ typedef struct {
 
 static TABLE_DEFINTION_T HistoryCtrlTable;
 static TABLE_DEFINTION_T *table_ptr = &HistoryCtrlTable;
+static HIST_GROUP_T *history_groups = NULL;
 
 /*
  * Main section 
@@ -321,7 +334,10 @@ static void
 compute_delta(ETH_STATS_T * delta,
               ETH_STATS_T * newval, ETH_STATS_T * prevval)
 {
-#define CNT_DIF(X) delta->X = newval->X - prevval->X
+    /*
+     * the counters are Counter32s, so their deltas are taken modulo 2^32
+     */
+#define CNT_DIF(X) delta->X = (newval->X - prevval->X) & 0xffffffff
 
     CNT_DIF(octets);
     CNT_DIF(packets);
@@ -336,41 +352,12 @@ compute_delta(ETH_STATS_T * delta,
 }
 
 static void
-history_get_backet(unsigned int clientreg, void *clientarg)
+history_get_backet(RMON_ENTRY_T * hdr_ptr)
 {
-    RMON_ENTRY_T   *hdr_ptr;
-    CRTL_ENTRY_T   *body;
+    CRTL_ENTRY_T   *body = (CRTL_ENTRY_T *) hdr_ptr->body;
     DATA_ENTRY_T   *bptr;
     ETH_STATS_T     newSample;
 
-    /*
-     * ag_trace ("history_get_backet: timer_id=%d", (int) clientreg); 
-     */
-    hdr_ptr = (RMON_ENTRY_T *) clientarg;
-    if (!hdr_ptr) {
-        ag_trace
-            ("Err: history_get_backet: hdr_ptr=NULL ? (Inserted in shock)");
-        return;
-    }
-
-    body = (CRTL_ENTRY_T *) hdr_ptr->body;
-    if (!body) {
-        ag_trace
-            ("Err: history_get_backet: body=NULL ? (Inserted in shock)");
-        return;
-    }
-
-    if (RMON1_ENTRY_VALID != hdr_ptr->status) {
-        ag_trace("Err: history_get_backet when entry %d is not valid ?!!",
-                 (int) hdr_ptr->ctrl_index);
-        /*
-         * snmp_alarm_print_list (); 
-         */
-        snmp_alarm_unregister(body->timer_id);
-        ag_trace("Err: unregistered %ld", (long) body->timer_id);
-        return;
-    }
-
     SYSTEM_get_eth_statistics(&body->data_source, &newSample);
 
     bptr = ROWDATAAPI_locate_new_data(&body->scrlr);
@@ -400,6 +387,74 @@ history_get_backet(unsigned int clientreg, void *clientarg)
            sizeof(ETH_STATS_T));
 }
 
+static void
+history_run_group(unsigned int clientreg, void *clientarg)
+{
+    HIST_GROUP_T   *group = (HIST_GROUP_T *) clientarg;
+    RMON_ENTRY_T   *hdr_ptr;
+    CRTL_ENTRY_T   *body;
+
+    /*
+     * ag_trace ("history_run_group: interval=%ld", (long) group->interval); 
+     */
+    for (hdr_ptr = ROWAPI_first(table_ptr); hdr_ptr;
+         hdr_ptr = hdr_ptr->next) {
+        body = (CRTL_ENTRY_T *) hdr_ptr->body;
+        if (RMON1_ENTRY_VALID == hdr_ptr->status && body &&
+            body->group == group)
+            history_get_backet(hdr_ptr);
+    }
+}
+
+static void
+history_unschedule(CRTL_ENTRY_T * body)
+{
+    HIST_GROUP_T  **gp;
+    HIST_GROUP_T   *group = body->group;
+
+    if (!group)
+        return;
+    body->group = NULL;
+    if (--group->count > 0)
+        return;
+
+    for (gp = &history_groups; *gp; gp = &(*gp)->next)
+        if (*gp == group) {
+            *gp = group->next;
+            break;
+        }
+    snmp_alarm_unregister(group->timer_id);
+    AGFREE(group);
+}
+
+static int
+history_schedule(CRTL_ENTRY_T * body)
+{
+    HIST_GROUP_T   *group;
+
+    history_unschedule(body);
+
+    for (group = history_groups; group; group = group->next)
+        if (group->interval == body->interval)
+            break;
+    if (!group) {
+        group = AGMALLOC(sizeof(HIST_GROUP_T));
+        if (!group) {
+            ag_trace("Err: no memory for history group");
+            return -1;
+        }
+        group->interval = body->interval;
+        group->count = 0;
+        group->timer_id = snmp_alarm_register(group->interval, SA_REPEAT,
+                                              history_run_group, group);
+        group->next = history_groups;
+        history_groups = group;
+    }
+    group->count++;
+    body->group = group;
+    return 0;
+}
+
 /*
  * Control Table RowApi Callbacks 
  */
@@ -418,7 +473,7 @@ history_Create(RMON_ENTRY_T * eptr)
      * set defaults 
      */
     body->interval = HIST_DEF_INTERVAL;
-    body->timer_id = 0;
+    body->group = NULL;
     memcpy(&body->data_source, &DEFAULT_DATA_SOURCE, sizeof(VAR_OID_T));
 
     ROWDATAAPI_init(&body->scrlr, HIST_DEF_BUCK_REQ,
@@ -455,9 +510,7 @@ history_Activate(RMON_ENTRY_T * eptr)
     /*
      * ag_trace ("Dbg:   registered in history_Activate"); 
      */
-    body->timer_id = snmp_alarm_register(body->interval, SA_REPEAT,
-                                         history_get_backet, eptr);
-    return 0;
+    return history_schedule(body);
 }
 
 int
@@ -465,10 +518,10 @@ history_Deactivate(RMON_ENTRY_T * eptr)
 {
     CRTL_ENTRY_T   *body = (CRTL_ENTRY_T *) eptr->body;
 
-    snmp_alarm_unregister(body->timer_id);
+    history_unschedule(body);
     /*
-     * ag_trace ("Dbg: unregistered in history_Deactivate timer_id=%d",
-     * (int) body->timer_id); 
+     * ag_trace ("Dbg: unregistered in history_Deactivate interval=%ld",
+     * (long) body->interval); 
      */
 
     /*
@@ -491,14 +544,11 @@ history_Copy(RMON_ENTRY_T * eptr)
     }
 
     if (body->interval != clone->interval) {
+        body->interval = clone->interval;
         if (RMON1_ENTRY_VALID == eptr->status) {
-            snmp_alarm_unregister(body->timer_id);
-            body->timer_id =
-                snmp_alarm_register(clone->interval, SA_REPEAT,
-                                    history_get_backet, eptr);
+            body->coeff = 100000L * (long) body->interval;
+            history_schedule(body);
         }
-
-        body->interval = clone->interval;
     }
 
     if (snmp_oid_compare
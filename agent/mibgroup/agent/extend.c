@@ -39,6 +39,20 @@ typedef struct extend_registration_block_s {
 } extend_registration_block;
 extend_registration_block *ereg_head = NULL;
 
+/*
+ * extendRefresh: run the commands in the background every so often,
+ * and answer requests from the last output, rather than running them
+ * (and keeping the request waiting) when a request finds the output
+ * out of date.
+ */
+static int          extend_refresh = 0;
+static int          extend_timeout = 30;
+static unsigned int extend_tick = 0;
+
+static int  _extend_output(netsnmp_extend *extension);
+static void _extend_parse_refresh(const char *token, char *cptr);
+static void _extend_free_refresh(void);
+
 
 #ifndef USING_UCD_SNMP_EXTENSIBLE_MODULE
 typedef struct netsnmp_old_extend_s {
@@ -260,6 +274,12 @@ void init_extend( void )
     snmpd_register_config_handler("exec2", extend_parse_config, NULL, NULL);
     snmpd_register_config_handler("sh2",   extend_parse_config, NULL, NULL);
     snmpd_register_config_handler("execFix2", extend_parse_config, NULL, NULL);
+    snmpd_register_config_handler("extendRefresh", _extend_parse_refresh,
+                                  _extend_free_refresh, "SECONDS");
+    snmpd_register_config_handler("extendTimeout", _extend_parse_refresh,
+                                  NULL, "SECONDS");
+    snmpd_register_config_handler("extendMaxJobs", _extend_parse_refresh,
+                                  NULL, "NUMBER");
     (void)_register_extend( ns_extend_oid, OID_LENGTH(ns_extend_oid));
 
 #ifndef USING_UCD_SNMP_EXTENSIBLE_MODULE
@@ -295,6 +315,54 @@ shutdown_extend(void)
          *
          *************************/
 
+static void
+_extend_command(netsnmp_extend *extension, char *cmd_buf, int cmd_len)
+{
+    if ( extension->args )
+        snprintf( cmd_buf, cmd_len, "%s %s", extension->command, extension->args );
+    else 
+        snprintf( cmd_buf, cmd_len, "%s", extension->command );
+}
+
+/*
+ * Keep the output of a run, picked apart into separate lines
+ */
+static void
+_extend_set_output(netsnmp_extend *extension, char *out_buf, int out_len)
+{
+    char *cp;
+    int   i;
+
+    if (out_len > 0 && out_buf[ out_len-1 ] == '\n')
+        out_buf[ --out_len ] =  '\0';	/* Stomp on trailing newline */
+    extension->output   = strdup( out_len > 0 ? out_buf : "" );
+    extension->out_len  = extension->output ? out_len : 0;
+    extension->numlines = 1;
+    if (!extension->output) {
+        extension->lines = &extension->output;
+        return;
+    }
+    for (cp=extension->output; *cp; cp++) {
+        if (*cp == '\n')
+            extension->numlines++;
+    }
+    if ( extension->numlines > 1 ) {
+        extension->lines = (char**)calloc( sizeof(char *), extension->numlines );
+        if (!extension->lines) {
+            extension->numlines = 1;
+            extension->lines = &extension->output;
+            return;
+        }
+        extension->lines[ 0 ] = extension->output;
+        for (cp=extension->output, i=1; *cp; cp++) {
+            if (*cp == '\n')
+                extension->lines[ i++ ] = cp+1;
+        }
+    } else {
+        extension->lines = &extension->output;
+    }
+}
+
 int
 extend_load_cache(netsnmp_cache *cache, void *magic)
 {
@@ -307,47 +375,19 @@ extend_load_cache(netsnmp_cache *cache, void *magic)
     int  cmd_len = 255*2 + 2;	/* 2 * DisplayStrings */
     char cmd_buf[ 255*2 + 2 ];
     int  ret;
-    char *cp;
-    char *line_buf[ 1024 ];
     netsnmp_extend *extension = (netsnmp_extend *)magic;
 
     if (!magic)
         return -1;
     DEBUGMSGTL(( "nsExtendTable:cache", "load %s", extension->token ));
-    if ( extension->args )
-        snprintf( cmd_buf, cmd_len, "%s %s", extension->command, extension->args );
-    else 
-        snprintf( cmd_buf, cmd_len, "%s", extension->command );
+    _extend_command( extension, cmd_buf, cmd_len );
     if ( extension->flags & NS_EXTEND_FLAGS_SHELL )
         ret = run_shell_command( cmd_buf, extension->input, out_buf, &out_len);
     else
         ret = run_exec_command(  cmd_buf, extension->input, out_buf, &out_len);
     DEBUGMSG(( "nsExtendTable:cache", ": %s : %d\n", cmd_buf, ret));
-    if (ret >= 0) {
-        if (out_buf[   out_len-1 ] == '\n')
-            out_buf[ --out_len   ] =  '\0';	/* Stomp on trailing newline */
-        extension->output   = strdup( out_buf );
-        extension->out_len  = out_len;
-        /*
-         * Now we need to pick the output apart into separate lines.
-         * Start by counting how many lines we've got, and keeping
-         * track of where each line starts in a static buffer
-         */
-        extension->numlines = 1;
-        line_buf[ 0 ] = extension->output;
-        for (cp=extension->output; *cp; cp++) {
-            if (*cp == '\n') {
-                line_buf[ extension->numlines++ ] = cp+1;
-            }
-        }
-        if ( extension->numlines > 1 ) {
-            extension->lines = (char**)calloc( sizeof(char *), extension->numlines );
-            memcpy( extension->lines, line_buf,
-                                       sizeof(char *) * extension->numlines );
-        } else {
-            extension->lines = &extension->output;
-        }
-    }
+    if (ret >= 0)
+        _extend_set_output( extension, out_buf, out_len );
     extension->result = ret;
     return ret;
 #endif /* !defined(USING_UTILITIES_EXECUTE_MODULE) */
@@ -374,6 +414,132 @@ extend_free_cache(netsnmp_cache *cache, void *magic)
 }
 
 
+        /*************************
+         *
+         *  Background runs (extendRefresh)
+         *
+         *************************/
+
+#ifdef USING_UTILITIES_EXECUTE_MODULE
+static void
+_extend_done(void *ctx, int result, char *output, int out_len)
+{
+    netsnmp_extend *extension = (netsnmp_extend *)ctx;
+
+    DEBUGMSGTL(( "nsExtendTable:refresh", "%s done: %d\n",
+                 extension->token, result));
+    extension->job = NULL;
+    if (result >= 0) {
+        extend_free_cache( NULL, extension );
+        _extend_set_output( extension, output, out_len );
+        extension->loaded = 1;
+    }
+    extension->result = result;
+}
+#endif
+
+static void
+_extend_start(netsnmp_extend *extension)
+{
+#ifdef USING_UTILITIES_EXECUTE_MODULE
+    char cmd_buf[ 255*2 + 2 ];
+    u_long now = netsnmp_get_agent_uptime();
+
+    if (extension->job)
+        return;
+    _extend_command( extension, cmd_buf, sizeof(cmd_buf) );
+    DEBUGMSGTL(( "nsExtendTable:refresh", "run %s: %s\n",
+                 extension->token, cmd_buf));
+    extension->last_run = now ? now : 1;
+    extension->job = netsnmp_exec_start( cmd_buf, extension->input,
+                                         extension->flags & NS_EXTEND_FLAGS_SHELL,
+                                         extend_timeout, 1024*100,
+                                         _extend_done, extension );
+#endif
+}
+
+/*
+ * Once a second, start the run of any entry that is due one: every
+ * extendRefresh seconds, or its nsExtendCacheTime if that is longer.
+ * Run-on-write (extendfix) entries are only run when asked to.
+ */
+static void
+_extend_tick_run(unsigned int reg, void *clientarg)
+{
+    extend_registration_block *eptr;
+    netsnmp_extend *extension;
+    u_long now = netsnmp_get_agent_uptime();
+    int    period;
+
+    if (!extend_refresh)
+        return;
+    for ( eptr=ereg_head; eptr; eptr=eptr->next ) {
+        for ( extension=eptr->ehead; extension; extension=extension->next ) {
+            if (!(extension->flags & NS_EXTEND_FLAGS_ACTIVE) ||
+                 (extension->flags & NS_EXTEND_FLAGS_WRITEABLE) ||
+                 extension->job)
+                continue;
+            period = SNMP_MAX( extend_refresh, extension->cache->timeout );
+            if (extension->last_run &&
+                now - extension->last_run < (u_long)period * 100)
+                continue;
+            _extend_start( extension );
+        }
+    }
+}
+
+/*
+ * Make sure that an entry's output can be used: run-on-read entries
+ * are run now if their output is out of date, unless extendRefresh
+ * runs them in the background, when the last output is used (if
+ * there has been a run yet).
+ */
+static int
+_extend_output(netsnmp_extend *extension)
+{
+    if (!extend_refresh || (extension->flags & NS_EXTEND_FLAGS_WRITEABLE))
+        return netsnmp_cache_check_and_reload( extension->cache );
+    if (extension->loaded)
+        return 0;
+    _extend_start( extension );
+    return -1;
+}
+
+static void
+_extend_parse_refresh(const char *token, char *cptr)
+{
+    int i = atoi(cptr);
+
+    if (i < 0) {
+        config_perror("value can't be negative");
+        return;
+    }
+    if (!strcmp(token, "extendTimeout")) {
+        extend_timeout = i;
+        return;
+    }
+    if (!strcmp(token, "extendMaxJobs")) {
+#ifdef USING_UTILITIES_EXECUTE_MODULE
+        netsnmp_exec_set_max_jobs(i);
+#endif
+        return;
+    }
+    extend_refresh = i;
+    if (extend_refresh && !extend_tick)
+        extend_tick = snmp_alarm_register(1, SA_REPEAT, _extend_tick_run, NULL);
+}
+
+static void
+_extend_free_refresh(void)
+{
+    extend_refresh = 0;
+    extend_timeout = 30;
+#ifdef USING_UTILITIES_EXECUTE_MODULE
+    netsnmp_exec_set_max_jobs(4);
+#endif
+}
+
+
         /*************************
          *
          *  Utility routines for setting up a new entry
@@ -408,6 +574,12 @@ _free_extension( netsnmp_extend *extension, extend_registration_block *ereg )
             ereg->ehead = eptr->next;
     }
 
+#ifdef USING_UTILITIES_EXECUTE_MODULE
+    if (extension->job)
+        netsnmp_exec_cancel( extension->job );
+#endif
+    if (extension->loaded)
+        extend_free_cache( NULL, extension );
     netsnmp_table_data_remove_and_delete_row( ereg->dinfo, extension->row);
     SNMP_FREE( extension->token );
     SNMP_FREE( extension->cache );
@@ -1078,7 +1250,7 @@ handle_nsExtendOutput1Table(netsnmp_mib_handler          *handler,
                 continue;
             }
             if (!(extension->flags & NS_EXTEND_FLAGS_WRITEABLE) &&
-                (netsnmp_cache_check_and_reload( extension->cache ) < 0 )) {
+                (_extend_output( extension ) < 0 )) {
                 /*
                  * If reloading the output cache of a 'run-on-read'
                  * entry fails, then skip it.
@@ -1202,7 +1374,7 @@ _extend_find_entry( netsnmp_request_info       *request,
              * Ensure the output is available...
              */
             if (!(eptr->flags & NS_EXTEND_FLAGS_ACTIVE) ||
-               (netsnmp_cache_check_and_reload( eptr->cache ) < 0 ))
+               (_extend_output( eptr ) < 0 ))
                 return NULL;
 
             /*
@@ -1226,7 +1398,7 @@ _extend_find_entry( netsnmp_request_info       *request,
              */
             for (eptr = ereg->ehead; eptr; eptr = eptr->next ) {
                 if ((eptr->flags & NS_EXTEND_FLAGS_ACTIVE) &&
-                    (netsnmp_cache_check_and_reload( eptr->cache ) >= 0 )) {
+                    (_extend_output( eptr ) >= 0 )) {
                     line_idx = 1;
                     break;
                 }
@@ -1257,7 +1429,7 @@ _extend_find_entry( netsnmp_request_info       *request,
              */
             for (    ; eptr; eptr = eptr->next ) {
                 if ((eptr->flags & NS_EXTEND_FLAGS_ACTIVE) &&
-                    (netsnmp_cache_check_and_reload( eptr->cache ) >= 0 )) {
+                    (_extend_output( eptr ) >= 0 )) {
                     break;
                 }
                 line_idx = 1;
@@ -1279,7 +1451,7 @@ _extend_find_entry( netsnmp_request_info       *request,
                     line_idx = 1;
                     for (eptr = eptr->next ; eptr; eptr = eptr->next ) {
                         if ((eptr->flags & NS_EXTEND_FLAGS_ACTIVE) &&
-                            (netsnmp_cache_check_and_reload( eptr->cache ) >= 0 )) {
+                            (_extend_output( eptr ) >= 0 )) {
                             break;
                         }
                     }
@@ -1446,11 +1618,11 @@ var_extensible_old(struct variable * vp,
             *var_len = strlen(exten->exec_entry->command);
             return ((u_char *) (exten->exec_entry->command));
         case ERRORFLAG:        /* return code from the process */
-            netsnmp_cache_check_and_reload( exten->exec_entry->cache );
+            _extend_output( exten->exec_entry );
             long_ret = exten->exec_entry->result;
             return ((u_char *) (&long_ret));
         case ERRORMSG:         /* first line of text returned from the process */
-            netsnmp_cache_check_and_reload( exten->exec_entry->cache );
+            _extend_output( exten->exec_entry );
             if (exten->exec_entry->numlines > 1) {
                 *var_len = (exten->exec_entry->lines[1])-
                            (exten->exec_entry->output) -1;
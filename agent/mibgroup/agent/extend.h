@@ -22,6 +22,10 @@ typedef struct netsnmp_extend_s {
 
     int      flags;
     netsnmp_cache     *cache;
+    /* with extendRefresh: the background run, and when it was started */
+    struct netsnmp_exec_job_s *job;
+    u_long   last_run;
+    int      loaded;
     netsnmp_table_row *row;
     netsnmp_table_data *dinfo;
     struct netsnmp_extend_s *next;
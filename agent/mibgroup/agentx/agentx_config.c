@@ -138,6 +138,44 @@ agentx_parse_agentx_retries(const char *token, char *cptr)
     netsnmp_ds_set_int(NETSNMP_DS_APPLICATION_ID,
                        NETSNMP_DS_AGENT_AGENTX_RETRIES, x);
 }
+
+void
+agentx_parse_agentx_max_outstanding(const char *token, char *cptr)
+{
+    int x = atoi(cptr);
+    DEBUGMSGTL(("agentx/config/maxoutstanding", "%s\n", cptr));
+    if (x < 0) {
+        config_perror("Invalid number of outstanding requests");
+        return;
+    }
+    netsnmp_ds_set_int(NETSNMP_DS_APPLICATION_ID,
+                       NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING, x);
+}
+
+void
+agentx_parse_agentx_adaptive_timeout(const char *token, char *cptr)
+{
+    char *min_str, *max_str, *st;
+    int tmin, tmax;
+
+    DEBUGMSGTL(("agentx/config/timeout", "adaptive %s\n", cptr));
+    min_str = strtok_r(cptr, " \t", &st);
+    max_str = strtok_r(NULL, " \t", &st);
+    if (!min_str || !max_str) {
+        config_perror("Usage: agentxAdaptiveTimeout MIN MAX");
+        return;
+    }
+    tmin = netsnmp_string_time_to_secs(min_str);
+    tmax = netsnmp_string_time_to_secs(max_str);
+    if (tmin == -1 || tmax == -1 || tmax == 0 || tmin > tmax) {
+        config_perror("Invalid adaptive timeout bounds");
+        return;
+    }
+    netsnmp_ds_set_int(NETSNMP_DS_APPLICATION_ID,
+                       NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MIN, tmin * ONE_SEC);
+    netsnmp_ds_set_int(NETSNMP_DS_APPLICATION_ID,
+                       NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MAX, tmax * ONE_SEC);
+}
 #endif                          /* USING_AGENTX_MASTER_MODULE */
 
 /* ---------------------------------------------------------------------
@@ -204,6 +242,12 @@ agentx_config_init(void)
     agentx_register_config_handler("agentxTimeout",
                                   agentx_parse_agentx_timeout, NULL,
                                   "AgentX Timeout (seconds)");
+    agentx_register_config_handler("agentxMaxOutstanding",
+                                  agentx_parse_agentx_max_outstanding, NULL,
+                                  "AgentX requests in flight per subagent (0 = unlimited)");
+    agentx_register_config_handler("agentxAdaptiveTimeout",
+                                  agentx_parse_agentx_adaptive_timeout, NULL,
+                                  "AgentX per-subagent timeout bounds: min_seconds max_seconds");
     }
 #endif                          /* USING_AGENTX_MASTER_MODULE */
 
@@ -96,6 +96,261 @@ agentx_synch_response(netsnmp_session * ss, netsnmp_pdu *pdu,
 }
 
 
+        /*
+         * Batched registration
+         *
+         * Between agentx_register_batch_begin() and _end(), Register PDUs
+         * are queued rather than sent one at a time and waited for.  The
+         * batch is then sorted (so the master can merge it into its
+         * registry as a single ascending pass) and pipelined to the
+         * master, a window at a time, with the overall outcome reported
+         * through one callback once every response is in.  Each failed
+         * registration is logged as it is answered, as agentx_register()
+         * has already returned by then.
+         */
+
+#define AGENTX_REGISTER_BATCH_WINDOW 64
+
+static struct agentx_register_batch_s {
+    netsnmp_session *ss;
+    int             collecting;
+    netsnmp_pdu   **pdus;
+    size_t          count, size, next;
+    int             outstanding, registered, failed;
+    agentx_register_batch_callback *callback;
+    void           *magic;
+    unsigned int    generation;
+} agentx_batch;
+
+/*
+ * What a sent registration's response is matched up with: the batch it
+ * was sent in, and the subtree it registers (for the log).
+ */
+struct agentx_register_batch_entry_s {
+    unsigned int    generation;
+    netsnmp_variable_list *var;
+};
+
+static int
+agentx_register_batch_compare(const void *a, const void *b)
+{
+    const netsnmp_pdu *pa = *(const netsnmp_pdu * const *) a;
+    const netsnmp_pdu *pb = *(const netsnmp_pdu * const *) b;
+    int             rc;
+
+    rc = strcmp(pa->community ? (const char *) pa->community : "",
+                pb->community ? (const char *) pb->community : "");
+    if (rc)
+        return rc;
+    return snmp_oid_compare(pa->variables->name, pa->variables->name_length,
+                            pb->variables->name, pb->variables->name_length);
+}
+
+/*
+ * Queue a Register PDU if a batch is being collected for this session.
+ * Returns 1 if the batch has taken ownership of the PDU.
+ */
+static int
+agentx_register_batch_add(netsnmp_session * ss, netsnmp_pdu *pdu)
+{
+    if (!agentx_batch.collecting || agentx_batch.ss != ss)
+        return 0;
+
+    if (agentx_batch.count == agentx_batch.size) {
+        size_t          size = agentx_batch.size ? 2 * agentx_batch.size : 64;
+        netsnmp_pdu   **pdus = (netsnmp_pdu **)
+            realloc(agentx_batch.pdus, size * sizeof(netsnmp_pdu *));
+
+        if (pdus == NULL)
+            return 0;
+        agentx_batch.pdus = pdus;
+        agentx_batch.size = size;
+    }
+    agentx_batch.pdus[agentx_batch.count++] = pdu;
+    return 1;
+}
+
+/*
+ * Drop the batch, unsent registrations and all.  Responses still due
+ * for it are ignored when they come in.
+ */
+static void
+agentx_register_batch_clear(void)
+{
+    unsigned int    generation = agentx_batch.generation;
+
+    while (agentx_batch.next < agentx_batch.count)
+        snmp_free_pdu(agentx_batch.pdus[agentx_batch.next++]);
+    SNMP_FREE(agentx_batch.pdus);
+    memset(&agentx_batch, 0, sizeof(agentx_batch));
+    agentx_batch.generation = generation + 1;
+}
+
+static void
+agentx_register_batch_finish(void)
+{
+    agentx_register_batch_callback *callback = agentx_batch.callback;
+    netsnmp_session *ss = agentx_batch.ss;
+    int             registered = agentx_batch.registered;
+    int             failed = agentx_batch.failed;
+    void           *magic = agentx_batch.magic;
+
+    agentx_register_batch_clear();
+
+    DEBUGMSGTL(("agentx/subagent",
+                "batch registration done: %d registered, %d failed\n",
+                registered, failed));
+    if (failed)
+        snmp_log(LOG_ERR, "AgentX batch registration: %d of %d failed\n",
+                 failed, registered + failed);
+    if (callback)
+        (*callback) (ss, registered, failed, magic);
+}
+
+static int agentx_register_batch_response(int, netsnmp_session *, int,
+                                          netsnmp_pdu *, void *);
+
+static void
+agentx_register_batch_run(void)
+{
+    netsnmp_pdu    *pdu;
+    struct agentx_register_batch_entry_s *entry;
+
+    while (agentx_batch.outstanding < AGENTX_REGISTER_BATCH_WINDOW &&
+           agentx_batch.next < agentx_batch.count) {
+        pdu = agentx_batch.pdus[agentx_batch.next];
+        agentx_batch.pdus[agentx_batch.next++] = NULL;
+        entry = SNMP_MALLOC_STRUCT(agentx_register_batch_entry_s);
+        if (entry) {
+            entry->generation = agentx_batch.generation;
+            entry->var = snmp_clone_varbind(pdu->variables);
+        }
+        if (entry && snmp_async_send(agentx_batch.ss, pdu,
+                                     agentx_register_batch_response,
+                                     entry)) {
+            agentx_batch.outstanding++;
+        } else {
+            snmp_log(LOG_ERR, "AgentX batch registration: sending failed\n");
+            if (entry) {
+                snmp_free_varbind(entry->var);
+                free(entry);
+            }
+            snmp_free_pdu(pdu);
+            agentx_batch.failed++;
+        }
+    }
+    if (agentx_batch.outstanding == 0)
+        agentx_register_batch_finish();
+}
+
+static int
+agentx_register_batch_response(int op, netsnmp_session * session,
+                               int reqid, netsnmp_pdu *pdu, void *magic)
+{
+    struct agentx_register_batch_entry_s *entry =
+        (struct agentx_register_batch_entry_s *) magic;
+    unsigned int    generation = entry->generation;
+    char            buf[SPRINT_MAX_LEN];
+
+    if (op == NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE &&
+        pdu->errstat != SNMP_ERR_NOERROR) {
+        buf[0] = '\0';
+        if (entry->var)
+            snprint_objid(buf, sizeof(buf), entry->var->name,
+                          entry->var->name_length);
+        snmp_log(LOG_ERR, "registering pdu failed: %ld! (%s)\n",
+                 pdu->errstat, buf);
+    }
+    snmp_free_varbind(entry->var);
+    free(entry);
+
+    if (generation != agentx_batch.generation || agentx_batch.ss == NULL) {
+        DEBUGMSGTL(("agentx/subagent",
+                    "response for a cleared registration batch\n"));
+        return 1;
+    }
+
+    agentx_batch.outstanding--;
+    if (op == NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE) {
+        if (pdu->errstat == SNMP_ERR_NOERROR)
+            agentx_batch.registered++;
+        else
+            agentx_batch.failed++;
+    } else {
+        /*
+         * Timed out, or the session is going away: don't send any more.
+         */
+        agentx_batch.failed += 1 + agentx_batch.count - agentx_batch.next;
+        while (agentx_batch.next < agentx_batch.count)
+            snmp_free_pdu(agentx_batch.pdus[agentx_batch.next++]);
+    }
+    agentx_register_batch_run();
+    return 1;
+}
+
+/*
+ * Forget any batch for a session to the master agent that is being
+ * closed.  Registrations not yet sent are dropped (a reattach registers
+ * everything again anyway), and no callback is made.
+ */
+void
+agentx_register_batch_reset(netsnmp_session * ss)
+{
+    if (agentx_batch.ss == NULL || agentx_batch.ss != ss)
+        return;
+
+    DEBUGMSGTL(("agentx/subagent",
+                "clearing batch registration: %d outstanding, %d unsent\n",
+                agentx_batch.outstanding,
+                (int) (agentx_batch.count - agentx_batch.next)));
+    agentx_register_batch_clear();
+}
+
+/*
+ * Start collecting registrations for the given session.  Returns 0 if
+ * another batch is still being collected or sent.
+ */
+int
+agentx_register_batch_begin(netsnmp_session * ss)
+{
+    if (ss == NULL || !IS_AGENTX_VERSION(ss->version) || agentx_batch.ss)
+        return 0;
+
+    DEBUGMSGTL(("agentx/subagent", "starting batch registration\n"));
+    agentx_batch.ss = ss;
+    agentx_batch.collecting = 1;
+    return 1;
+}
+
+/*
+ * Send the collected registrations.  callback (if not NULL) is called
+ * once all of them have been answered, possibly before this returns.
+ * Returns the number of registrations queued for sending.
+ */
+int
+agentx_register_batch_end(netsnmp_session * ss,
+                          agentx_register_batch_callback * callback,
+                          void *magic)
+{
+    int             count;
+
+    if (!agentx_batch.collecting || agentx_batch.ss != ss)
+        return 0;
+
+    count = agentx_batch.count;
+    DEBUGMSGTL(("agentx/subagent", "sending %d batched registrations\n",
+                count));
+    agentx_batch.collecting = 0;
+    agentx_batch.callback = callback;
+    agentx_batch.magic = magic;
+    if (count > 1)
+        qsort(agentx_batch.pdus, count, sizeof(netsnmp_pdu *),
+              agentx_register_batch_compare);
+    agentx_register_batch_run();
+    return count;
+}
+
+
         /*
          * AgentX PofE convenience functions
          */
@@ -203,6 +458,15 @@ agentx_register(netsnmp_session * ss, oid start[], size_t startlen,
         snmp_add_null_var(pdu, start, startlen);
     }
 
+    /*
+     * the master's answer to a batched registration is logged, if it
+     * is an error, when it comes in
+     */
+    if (agentx_register_batch_add(ss, pdu)) {
+        DEBUGMSGTL(("agentx/subagent", "queued for batch registration\n"));
+        return 1;
+    }
+
     if (agentx_synch_response(ss, pdu, &response) != STAT_SUCCESS) {
         DEBUGMSGTL(("agentx/subagent", "registering failed!\n"));
         return 0;
@@ -29,6 +29,16 @@ extern          "C" {
                                             size_t);
     int             agentx_send_ping(netsnmp_session *);
 
+    typedef void    (agentx_register_batch_callback) (netsnmp_session *,
+                                                      int registered,
+                                                      int failed,
+                                                      void *magic);
+    int             agentx_register_batch_begin(netsnmp_session *);
+    int             agentx_register_batch_end(netsnmp_session *,
+                                              agentx_register_batch_callback *,
+                                              void *);
+    void            agentx_register_batch_reset(netsnmp_session *);
+
 #define AGENTX_CLOSE_OTHER    1
 #define AGENTX_CLOSE_PARSE    2
 #define AGENTX_CLOSE_PROTOCOL 3
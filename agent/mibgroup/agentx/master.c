@@ -36,6 +36,16 @@
 #include <sys/socket.h>
 #endif
 #include <errno.h>
+#if TIME_WITH_SYS_TIME
+# include <sys/time.h>
+# include <time.h>
+#else
+# if HAVE_SYS_TIME_H
+#  include <sys/time.h>
+# else
+#  include <time.h>
+# endif
+#endif
 
 #if HAVE_UNISTD_H
 #include <unistd.h>
@@ -50,10 +60,12 @@
 #include "snmpd.h"
 #include "agentx/protocol.h"
 #include "agentx/master_admin.h"
+#include "agentx/master.h"
 
 netsnmp_feature_require(handler_mark_requests_as_delegated)
 netsnmp_feature_require(unix_socket_paths)
 netsnmp_feature_require(free_agent_snmp_session_by_session)
+netsnmp_feature_require(allocate_globalcacheid)
 
 void
 real_init_master(void)
@@ -200,6 +212,371 @@ real_init_master(void)
     DEBUGMSGTL(("agentx/master", "initializing...   DONE\n"));
 }
 
+
+        /*
+         * A request delegated to a subagent.  It is queued on the
+         * connection state (with the PDU still attached) whenever the
+         * agentxMaxOutstanding window for that subagent is full.
+         */
+struct agentx_master_pending_s {
+    netsnmp_session *ax_session;
+    netsnmp_delegated_cache *cache;
+    netsnmp_pdu    *pdu;
+    int             command;        /* AgentX PDU type sent */
+    struct timeval  sent;
+    agentx_master_pending *next;
+};
+
+int             agentx_got_response(int, netsnmp_session *, int,
+                                    netsnmp_pdu *, void *);
+
+agentx_master_state *
+agentx_master_get_state(netsnmp_session *session)
+{
+    agentx_master_state *state;
+
+    if (session->myvoid)
+        return (agentx_master_state *) session->myvoid;
+
+    state = SNMP_MALLOC_TYPEDEF(agentx_master_state);
+    if (state == NULL)
+        return NULL;
+    state->cacheid = netsnmp_allocate_globalcacheid();
+    session->myvoid = state;
+    return state;
+}
+
+static void
+_agentx_master_free_pending(agentx_master_pending *pending)
+{
+    if (pending->pdu)
+        snmp_free_pdu(pending->pdu);
+    netsnmp_free_delegated_cache(pending->cache);
+    free(pending);
+}
+
+void
+agentx_master_free_state(netsnmp_session *session)
+{
+    agentx_master_state *state = (agentx_master_state *) session->myvoid;
+    agentx_master_pending *pending;
+    netsnmp_delegated_cache *cache;
+    int             failed = 0;
+
+    if (state == NULL)
+        return;
+
+    /*
+     * Nothing still queued will ever be sent, so fail its requests
+     * rather than leave them waiting on the subagent.
+     */
+    while ((pending = state->queue) != NULL) {
+        state->queue = pending->next;
+        cache = netsnmp_handler_check_cache(pending->cache);
+        if (cache) {
+            netsnmp_handler_mark_requests_as_delegated(cache->requests,
+                                                   REQUEST_IS_NOT_DELEGATED);
+            netsnmp_set_request_error(cache->reqinfo, cache->requests,
+                                      SNMP_ERR_GENERR);
+            failed++;
+        }
+        _agentx_master_free_pending(pending);
+    }
+    SNMP_FREE(session->myvoid);
+
+    if (failed) {
+        DEBUGMSGTL(("agentx/master", "failed %d queued pdu(s) on session "
+                    "%8p\n", failed, session));
+        netsnmp_check_outstanding_agent_requests();
+    }
+}
+
+        /*
+         * Pick the timeout for the next request to this subagent.
+         * With agentxAdaptiveTimeout configured this follows the
+         * observed response times (RFC 6298 style), clamped to the
+         * configured bounds; otherwise it is simply agentxTimeout.
+         */
+static long
+_agentx_master_timeout(agentx_master_state *state, long dflt)
+{
+    long            tmin, tmax, timeout;
+
+    tmax = netsnmp_ds_get_int(NETSNMP_DS_APPLICATION_ID,
+                              NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MAX);
+    if (tmax <= 0 || state->srtt == 0)
+        return dflt;
+    tmin = netsnmp_ds_get_int(NETSNMP_DS_APPLICATION_ID,
+                              NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MIN);
+
+    timeout = state->srtt + 4 * state->rttvar;
+    if (timeout < tmin)
+        timeout = tmin;
+    if (timeout > tmax)
+        timeout = tmax;
+    return timeout;
+}
+
+static void
+_agentx_master_update_rtt(agentx_master_state *state,
+                          const struct timeval *sent)
+{
+    struct timeval  now;
+    long            rtt, delta;
+
+    gettimeofday(&now, NULL);
+    rtt = (now.tv_sec - sent->tv_sec) * 1000000L +
+        (now.tv_usec - sent->tv_usec);
+    if (rtt <= 0)
+        rtt = 1;
+
+    if (state->srtt == 0) {
+        state->srtt = rtt;
+        state->rttvar = rtt / 2;
+    } else {
+        delta = state->srtt - rtt;
+        if (delta < 0)
+            delta = -delta;
+        state->rttvar = (3 * state->rttvar + delta) / 4;
+        state->srtt = (7 * state->srtt + rtt) / 8;
+    }
+    DEBUGMSGTL(("agentx/master/rtt", "rtt %ld srtt %ld rttvar %ld\n",
+                rtt, state->srtt, state->rttvar));
+}
+
+        /*
+         * Hand a PDU to the subagent session.  On failure the requests
+         * it carried are failed, rather than left delegated forever.
+         */
+static int
+_agentx_master_transmit(netsnmp_session *ax_session, netsnmp_pdu *pdu,
+                        agentx_master_pending *pending)
+{
+    agentx_master_state *state = (agentx_master_state *) ax_session->myvoid;
+    long            timeout = ax_session->timeout;
+    int             result;
+
+    if (pending && state) {
+        gettimeofday(&pending->sent, NULL);
+        ax_session->timeout = _agentx_master_timeout(state, timeout);
+    }
+
+    DEBUGMSGTL(("agentx/master", "sending pdu (req=0x%x,trans=0x%x,sess=0x%x)\n",
+                (unsigned)pdu->reqid, (unsigned)pdu->transid, (unsigned)pdu->sessid));
+    result = snmp_async_send(ax_session, pdu, agentx_got_response,
+                             pending ? pending->cache : NULL);
+    ax_session->timeout = timeout;
+
+    if (result == 0) {
+        snmp_free_pdu(pdu);
+        if (pending) {
+            netsnmp_delegated_cache *cache = pending->cache;
+            if (netsnmp_handler_check_cache(cache)) {
+                netsnmp_handler_mark_requests_as_delegated(cache->requests,
+                                                   REQUEST_IS_NOT_DELEGATED);
+                netsnmp_set_request_error(cache->reqinfo, cache->requests,
+                                          SNMP_ERR_GENERR);
+            }
+            pending->pdu = NULL;
+            _agentx_master_free_pending(pending);
+        }
+    } else if (pending && state) {
+        state->outstanding++;
+    }
+    return result;
+}
+
+        /*
+         * A response slot has been freed: send queued requests, dropping
+         * any whose agent request has completed in the meantime.
+         */
+static void
+_agentx_master_run_queue(netsnmp_session *ax_session)
+{
+    agentx_master_state *state = (agentx_master_state *) ax_session->myvoid;
+    agentx_master_pending *pending;
+    netsnmp_pdu    *pdu;
+    int             max_outstanding =
+        netsnmp_ds_get_int(NETSNMP_DS_APPLICATION_ID,
+                           NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING);
+
+    while (state && state->queue &&
+           (max_outstanding <= 0 || state->outstanding < max_outstanding)) {
+        pending = state->queue;
+        state->queue = pending->next;
+        if (state->queue == NULL)
+            state->queue_end = NULL;
+        pending->next = NULL;
+
+        if (!netsnmp_handler_check_cache(pending->cache)) {
+            DEBUGMSGTL(("agentx/master", "dropping stale queued pdu\n"));
+            _agentx_master_free_pending(pending);
+            continue;
+        }
+        pdu = pending->pdu;
+        pending->pdu = NULL;
+        _agentx_master_transmit(ax_session, pdu, pending);
+        /*
+         * a failed send may have torn the session state down
+         */
+        state = (agentx_master_state *) ax_session->myvoid;
+    }
+}
+
+static int
+_agentx_master_send(netsnmp_session *ax_session, netsnmp_pdu *pdu,
+                    agentx_master_pending *pending)
+{
+    agentx_master_state *state = (agentx_master_state *) ax_session->myvoid;
+    int             max_outstanding =
+        netsnmp_ds_get_int(NETSNMP_DS_APPLICATION_ID,
+                           NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING);
+
+    /*
+     * keep the order: anything already queued goes first
+     */
+    if (pending && state && max_outstanding > 0 && state->queue) {
+        _agentx_master_run_queue(ax_session);
+        state = (agentx_master_state *) ax_session->myvoid;
+    }
+    if (pending && state && max_outstanding > 0 &&
+        (state->outstanding >= max_outstanding || state->queue)) {
+        DEBUGMSGTL(("agentx/master", "queueing pdu (req=0x%x), %d outstanding\n",
+                    (unsigned)pdu->reqid, state->outstanding));
+        pending->pdu = pdu;
+        if (state->queue_end)
+            state->queue_end->next = pending;
+        else
+            state->queue = pending;
+        state->queue_end = pending;
+        return 1;
+    }
+    return _agentx_master_transmit(ax_session, pdu, pending);
+}
+
+        /*
+         * The requests in the order their varbinds were put in an AgentX
+         * GetBulk: the *n non-repeaters, followed by the *r repeaters.
+         */
+static netsnmp_request_info **
+_agentx_master_bulk_order(netsnmp_request_info *requests, int *n, int *r)
+{
+    netsnmp_request_info **order, *request;
+    int             i = 0;
+
+    *n = *r = 0;
+    for (request = requests; request; request = request->next) {
+        if (request->repeat == 0)
+            (*n)++;
+        else
+            (*r)++;
+    }
+    order = (netsnmp_request_info **) calloc(*n + *r + 1, sizeof(*order));
+    if (order == NULL)
+        return NULL;
+    for (request = requests; request; request = request->next)
+        if (request->repeat == 0)
+            order[i++] = request;
+    for (request = requests; request; request = request->next)
+        if (request->repeat > 0)
+            order[i++] = request;
+    return order;
+}
+
+        /*
+         * Find the request answered by varbind index (counting from 1)
+         * of a subagent response
+         */
+static netsnmp_request_info *
+_agentx_master_request_at(agentx_master_pending *pending,
+                          netsnmp_request_info *requests, long index)
+{
+    netsnmp_request_info **order, *request = NULL;
+    int             n, r;
+
+    if (index < 1)
+        return NULL;
+    if (pending->command != AGENTX_MSG_GETBULK) {
+        for (request = requests; request && index > 1;
+             request = request->next, index--);
+        return request;
+    }
+
+    order = _agentx_master_bulk_order(requests, &n, &r);
+    if (order == NULL)
+        return NULL;
+    if (index <= n)
+        request = order[index - 1];
+    else if (r > 0)
+        request = order[n + (index - 1 - n) % r];
+    free(order);
+    return request;
+}
+
+        /*
+         * Store one GetBulk result and move the request on to its next
+         * repetition.  Returns 0 once the request can't take any more.
+         */
+static int
+_agentx_master_bulk_fill(netsnmp_request_info *request,
+                         netsnmp_variable_list *var)
+{
+    netsnmp_variable_list *vb = request->requestvb;
+    netsnmp_request_info *next;
+
+    if (var->type == SNMP_ENDOFMIBVIEW) {
+        /*
+         * nothing more from this subagent; carry on in the next subtree
+         */
+        vb->type = ASN_NULL;
+        return 0;
+    }
+    snmp_set_var_typed_value(vb, var->type, var->val.string, var->val_len);
+    snmp_set_var_objid(vb, var->name, var->name_length);
+
+    /*
+     * advance this request alone
+     */
+    next = request->next;
+    request->next = NULL;
+    netsnmp_bulk_to_next_fix_requests(request);
+    request->next = next;
+
+    return request->requestvb != vb;
+}
+
+        /*
+         * Spread the results of an AgentX GetBulk over the requests.
+         * Returns 0 if the response doesn't fit the request.
+         */
+static int
+_agentx_master_bulk_response(netsnmp_request_info *requests,
+                             netsnmp_variable_list *var)
+{
+    netsnmp_request_info **order;
+    int             n, r, i;
+
+    order = _agentx_master_bulk_order(requests, &n, &r);
+    if (order == NULL)
+        return 0;
+
+    for (i = 0; i < n; i++, var = var->next_variable) {
+        if (var == NULL) {
+            free(order);
+            return 0;
+        }
+        _agentx_master_bulk_fill(order[i], var);
+    }
+    while (var && r > 0) {
+        for (i = n; i < n + r && var; i++, var = var->next_variable) {
+            if (order[i] && !_agentx_master_bulk_fill(order[i], var))
+                order[i] = NULL;
+        }
+    }
+    free(order);
+    return 1;
+}
+
         /*
          * Handle the response from an AgentX subagent,
          *   merging the answers back into the original query
@@ -210,15 +587,31 @@ agentx_got_response(int operation,
                     int reqid, netsnmp_pdu *pdu, void *magic)
 {
     netsnmp_delegated_cache *cache = (netsnmp_delegated_cache *) magic;
-    int             i, ret;
-    netsnmp_request_info *requests, *request;
+    agentx_master_pending *pending = NULL;
+    agentx_master_state *state = (agentx_master_state *) session->myvoid;
+    int             ret;
+    netsnmp_request_info *requests, *request, *errreq;
     netsnmp_variable_list *var;
     netsnmp_session *ax_session;
 
+    if (cache) {
+        pending = (agentx_master_pending *) cache->localinfo;
+        if (state && state->outstanding > 0)
+            state->outstanding--;
+        if (state && operation == NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE)
+            _agentx_master_update_rtt(state, &pending->sent);
+        /*
+         * whatever became of this request, its slot is free again
+         */
+        _agentx_master_run_queue(session);
+    }
+
     cache = netsnmp_handler_check_cache(cache);
     if (!cache) {
         DEBUGMSGTL(("agentx/master", "response too late on session %8p\n",
                     session));
+        if (pending)
+            _agentx_master_free_pending(pending);
         return 0;
     }
     requests = cache->requests;
@@ -255,9 +648,9 @@ agentx_got_response(int operation,
             } else {
                 DEBUGMSGTL(("agentx/master", "NULL sess_pointer??\n"));
             }
-            ax_session = (netsnmp_session *) cache->localinfo;
+            ax_session = pending->ax_session;
             netsnmp_free_agent_snmp_session_by_session(ax_session, NULL);
-            netsnmp_free_delegated_cache(cache);
+            _agentx_master_free_pending(pending);
             return 0;
         }
 
@@ -275,7 +668,7 @@ agentx_got_response(int operation,
                                                    REQUEST_IS_NOT_DELEGATED);
         netsnmp_set_request_error(cache->reqinfo, requests,     /* XXXWWW: should be index=0 */
                                   SNMP_ERR_GENERR);
-        netsnmp_free_delegated_cache(cache);
+        _agentx_master_free_pending(pending);
         return 0;
 
     case NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE:
@@ -287,7 +680,7 @@ agentx_got_response(int operation,
     default:
         snmp_log(LOG_ERR, "Unknown operation %d in agentx_got_response\n",
                  operation);
-        netsnmp_free_delegated_cache(cache);
+        _agentx_master_free_pending(pending);
         return 0;
     }
 
@@ -329,9 +722,9 @@ agentx_got_response(int operation,
         }
 
         ret = 0;
-        for (request = requests, i = 1; request;
-             request = request->next, i++) {
-            if (i == pdu->errindex) {
+        errreq = _agentx_master_request_at(pending, requests, pdu->errindex);
+        for (request = requests; request; request = request->next) {
+            if (request == errreq) {
                 /*
                  * Mark this varbind as the one generating the error.
                  * Note that the AgentX errindex may not match the
@@ -350,9 +743,20 @@ agentx_got_response(int operation,
             netsnmp_set_request_error(cache->reqinfo, requests,
                                       SNMP_ERR_GENERR);
         }
-        netsnmp_free_delegated_cache(cache);
+        _agentx_master_free_pending(pending);
         DEBUGMSGTL(("agentx/master", "end error branch\n"));
         return 1;
+    } else if (pending->command == AGENTX_MSG_GETBULK) {
+        DEBUGMSGTL(("agentx/master",
+                    "agentx_got_response() getbulk results\n"));
+        if (!_agentx_master_bulk_response(requests, pdu->variables)) {
+            snmp_log(LOG_ERR,
+                     "response to agentx request illegal.  bailing out.\n");
+            netsnmp_set_request_error(cache->reqinfo, requests,
+                                      SNMP_ERR_GENERR);
+        }
+        netsnmp_handler_mark_requests_as_delegated(requests,
+                                                   REQUEST_IS_NOT_DELEGATED);
     } else if (cache->reqinfo->mode == MODE_GET ||
                cache->reqinfo->mode == MODE_GETNEXT ||
                cache->reqinfo->mode == MODE_GETBULK) {
@@ -411,10 +815,82 @@ agentx_got_response(int operation,
     }
     DEBUGMSGTL(("agentx/master",
                 "handle_agentx_response() finishing...\n"));
-    netsnmp_free_delegated_cache(cache);
+    _agentx_master_free_pending(pending);
     return 1;
 }
 
+/*
+ * Add the AgentX varbind (or search range) for one request to the PDU
+ */
+static void
+_agentx_master_add_request(netsnmp_agent_request_info *reqinfo,
+                           netsnmp_pdu *pdu, netsnmp_request_info *request)
+{
+    size_t nlen = request->requestvb->name_length;
+    oid   *nptr = request->requestvb->name;
+    
+    DEBUGMSGTL(("agentx/master","request for variable ("));
+    DEBUGMSGOID(("agentx/master", nptr, nlen));
+    DEBUGMSG(("agentx/master", ")\n"));
+    
+    /*
+     * create an agentx varbind out of the request
+     */
+
+    if (reqinfo->mode == MODE_GETNEXT || reqinfo->mode == MODE_GETBULK) {
+
+        if (snmp_oid_compare(nptr, nlen, request->subtree->start_a,
+                             request->subtree->start_len) < 0) {
+            DEBUGMSGTL(("agentx/master","inexact request preceeding region ("));
+            DEBUGMSGOID(("agentx/master", request->subtree->start_a,
+                         request->subtree->start_len));
+            DEBUGMSG(("agentx/master", ")\n"));
+            nptr = request->subtree->start_a;
+            nlen = request->subtree->start_len;
+            request->inclusive = 1;
+        }
+
+        if (request->inclusive) {
+            DEBUGMSGTL(("agentx/master", "INCLUSIVE varbind "));
+            DEBUGMSGOID(("agentx/master", nptr, nlen));
+            DEBUGMSG(("agentx/master", " scoped to "));
+            DEBUGMSGOID(("agentx/master", request->range_end,
+                         request->range_end_len));
+            DEBUGMSG(("agentx/master", "\n"));
+            snmp_pdu_add_variable(pdu, nptr, nlen, ASN_PRIV_INCL_RANGE,
+                                  (u_char *) request->range_end,
+                                  request->range_end_len *
+                                  sizeof(oid));
+            request->inclusive = 0;
+        } else {
+            DEBUGMSGTL(("agentx/master", "EXCLUSIVE varbind "));
+            DEBUGMSGOID(("agentx/master", nptr, nlen));
+            DEBUGMSG(("agentx/master", " scoped to "));
+            DEBUGMSGOID(("agentx/master", request->range_end,
+                         request->range_end_len));
+            DEBUGMSG(("agentx/master", "\n"));
+            snmp_pdu_add_variable(pdu, nptr, nlen, ASN_PRIV_EXCL_RANGE,
+                                  (u_char *) request->range_end,
+                                  request->range_end_len *
+                                  sizeof(oid));
+        }
+    } else {
+        snmp_pdu_add_variable(pdu, request->requestvb->name,
+                              request->requestvb->name_length,
+                              request->requestvb->type,
+                              request->requestvb->val.string,
+                              request->requestvb->val_len);
+    }
+
+    /*
+     * mark the request as delayed 
+     */
+    if (pdu->command != AGENTX_MSG_CLEANUPSET)
+        request->delegated = REQUEST_IS_DELEGATED;
+    else
+        request->delegated = REQUEST_IS_NOT_DELEGATED;
+}
+
 /*
  *
  * AgentX State diagram.  [mode] = internal mode it's mapped from:
@@ -437,8 +913,8 @@ agentx_master_handler(netsnmp_mib_handler *handler,
     netsnmp_session *ax_session = (netsnmp_session *) handler->myvoid;
     netsnmp_request_info *request = requests;
     netsnmp_pdu    *pdu;
-    void           *cb_data;
-    int             result;
+    agentx_master_pending *pending;
+    long            non_repeaters, max_repetitions;
 
     DEBUGMSGTL(("agentx/master",
                 "agentx master handler starting, mode = 0x%02x\n",
@@ -461,8 +937,28 @@ agentx_master_handler(netsnmp_mib_handler *handler,
         pdu = snmp_pdu_create(AGENTX_MSG_GETNEXT);
         break;
 
-    case MODE_GETBULK:         /* WWWXXX */
-        pdu = snmp_pdu_create(AGENTX_MSG_GETNEXT);
+    case MODE_GETBULK:
+        /*
+         * Pass the repetitions down to the subagent in one AgentX
+         * GetBulk.  Without any repeaters left, a GetNext does the job.
+         */
+        max_repetitions = 0;
+        non_repeaters = 0;
+        for (request = requests; request; request = request->next) {
+            if (request->repeat == 0)
+                non_repeaters++;
+            else if (request->repeat + 1 > max_repetitions)
+                max_repetitions = request->repeat + 1;
+        }
+        request = requests;
+        if (max_repetitions > 0) {
+            pdu = snmp_pdu_create(AGENTX_MSG_GETBULK);
+            if (pdu) {
+                pdu->non_repeaters = non_repeaters;
+                pdu->max_repetitions = max_repetitions;
+            }
+        } else
+            pdu = snmp_pdu_create(AGENTX_MSG_GETNEXT);
         break;
 
 #ifndef NETSNMP_NO_WRITE_SUPPORT
@@ -514,76 +1010,19 @@ agentx_master_handler(netsnmp_mib_handler *handler,
     if (ax_session->subsession->flags & AGENTX_MSG_FLAG_NETWORK_BYTE_ORDER)
         pdu->flags |= AGENTX_MSG_FLAG_NETWORK_BYTE_ORDER;
 
-    while (request) {
-
-        size_t nlen = request->requestvb->name_length;
-        oid   *nptr = request->requestvb->name;
-        
-        DEBUGMSGTL(("agentx/master","request for variable ("));
-        DEBUGMSGOID(("agentx/master", nptr, nlen));
-        DEBUGMSG(("agentx/master", ")\n"));
-        
-        /*
-         * loop through all the requests and create agentx ones out of them 
-         */
-
-        if (reqinfo->mode == MODE_GETNEXT || reqinfo->mode == MODE_GETBULK) {
-
-            if (snmp_oid_compare(nptr, nlen, request->subtree->start_a,
-                                 request->subtree->start_len) < 0) {
-                DEBUGMSGTL(("agentx/master","inexact request preceeding region ("));
-                DEBUGMSGOID(("agentx/master", request->subtree->start_a,
-                             request->subtree->start_len));
-                DEBUGMSG(("agentx/master", ")\n"));
-                nptr = request->subtree->start_a;
-                nlen = request->subtree->start_len;
-                request->inclusive = 1;
-            }
-
-            if (request->inclusive) {
-                DEBUGMSGTL(("agentx/master", "INCLUSIVE varbind "));
-                DEBUGMSGOID(("agentx/master", nptr, nlen));
-                DEBUGMSG(("agentx/master", " scoped to "));
-                DEBUGMSGOID(("agentx/master", request->range_end,
-                             request->range_end_len));
-                DEBUGMSG(("agentx/master", "\n"));
-                snmp_pdu_add_variable(pdu, nptr, nlen, ASN_PRIV_INCL_RANGE,
-                                      (u_char *) request->range_end,
-                                      request->range_end_len *
-                                      sizeof(oid));
-                request->inclusive = 0;
-            } else {
-                DEBUGMSGTL(("agentx/master", "EXCLUSIVE varbind "));
-                DEBUGMSGOID(("agentx/master", nptr, nlen));
-                DEBUGMSG(("agentx/master", " scoped to "));
-                DEBUGMSGOID(("agentx/master", request->range_end,
-                             request->range_end_len));
-                DEBUGMSG(("agentx/master", "\n"));
-                snmp_pdu_add_variable(pdu, nptr, nlen, ASN_PRIV_EXCL_RANGE,
-                                      (u_char *) request->range_end,
-                                      request->range_end_len *
-                                      sizeof(oid));
-            }
-        } else {
-            snmp_pdu_add_variable(pdu, request->requestvb->name,
-                                  request->requestvb->name_length,
-                                  request->requestvb->type,
-                                  request->requestvb->val.string,
-                                  request->requestvb->val_len);
-        }
-
+    if (pdu->command == AGENTX_MSG_GETBULK) {
         /*
-         * mark the request as delayed 
+         * the non-repeaters have to precede the repeaters
          */
-        if (pdu->command != AGENTX_MSG_CLEANUPSET)
-            request->delegated = REQUEST_IS_DELEGATED;
-        else
-            request->delegated = REQUEST_IS_NOT_DELEGATED;
-
-        /*
-         * next... 
-         */
-        request = request->next;
+        for (request = requests; request; request = request->next)
+            if (request->repeat == 0)
+                _agentx_master_add_request(reqinfo, pdu, request);
+        for (request = requests; request; request = request->next)
+            if (request->repeat > 0)
+                _agentx_master_add_request(reqinfo, pdu, request);
+    } else {
+        for (request = requests; request; request = request->next)
+            _agentx_master_add_request(reqinfo, pdu, request);
     }
 
     /*
@@ -591,22 +1030,30 @@ agentx_master_handler(netsnmp_mib_handler *handler,
      * back from the subagent. So we shouldn't allocate the
      * netsnmp_delegated_cache structure in this case.
      */
-    if (pdu->command != AGENTX_MSG_CLEANUPSET)
-        cb_data = netsnmp_create_delegated_cache(handler, reginfo,
-                                                 reqinfo, requests,
-                                                 (void *) ax_session);
-    else
-        cb_data = NULL;
+    if (pdu->command != AGENTX_MSG_CLEANUPSET) {
+        pending = SNMP_MALLOC_TYPEDEF(agentx_master_pending);
+        if (pending)
+            pending->cache = netsnmp_create_delegated_cache(handler, reginfo,
+                                                            reqinfo, requests,
+                                                            (void *) pending);
+        if (pending == NULL || pending->cache == NULL) {
+            SNMP_FREE(pending);
+            snmp_free_pdu(pdu);
+            netsnmp_handler_mark_requests_as_delegated(requests,
+                                               REQUEST_IS_NOT_DELEGATED);
+            netsnmp_set_request_error(reqinfo, requests, SNMP_ERR_GENERR);
+            return SNMP_ERR_NOERROR;
+        }
+        pending->ax_session = ax_session;
+        pending->command = pdu->command;
+    } else
+        pending = NULL;
 
     /*
-     * send the requests out.
+     * send the requests out (or queue them, if this subagent already
+     * has its fill of outstanding requests).
      */
-    DEBUGMSGTL(("agentx/master", "sending pdu (req=0x%x,trans=0x%x,sess=0x%x)\n",
-                (unsigned)pdu->reqid, (unsigned)pdu->transid, (unsigned)pdu->sessid));
-    result = snmp_async_send(ax_session, pdu, agentx_got_response, cb_data);
-    if (result == 0) {
-        snmp_free_pdu(pdu);
-    }
+    _agentx_master_send(ax_session, pdu, pending);
 
     return SNMP_ERR_NOERROR;
 }
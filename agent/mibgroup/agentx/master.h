@@ -7,8 +7,25 @@ config_require(agentx/protocol)
 config_require(agentx/master_admin)
 config_require(agentx/agentx_config)
 
+     /*
+      * Per-connection state for a subagent transport session, stored
+      * in the session's myvoid pointer.
+      */
+     typedef struct agentx_master_pending_s agentx_master_pending;
+
+     typedef struct agentx_master_state_s {
+         int             cacheid;       /* global cache id of its regs */
+         int             outstanding;   /* requests awaiting a response */
+         agentx_master_pending *queue;  /* requests waiting for a slot */
+         agentx_master_pending *queue_end;
+         long            srtt;          /* smoothed round trip (usec) */
+         long            rttvar;        /* round trip variation (usec) */
+     } agentx_master_state;
+
      void            init_master(void);
      void            real_init_master(void);
      Netsnmp_Node_Handler agentx_master_handler;
+     agentx_master_state *agentx_master_get_state(netsnmp_session *);
+     void            agentx_master_free_state(netsnmp_session *);
 
 #endif                          /* _AGENTX_MASTER_H */
@@ -146,7 +146,7 @@ close_agentx_session(netsnmp_session * session, int sessid)
         unregister_mibs_by_session(session);
         unregister_index_by_session(session);
         unregister_sysORTable_by_session(session);
-	SNMP_FREE(session->myvoid);
+        agentx_master_free_state(session);
         return AGENTX_ERR_NOERROR;
     }
 
@@ -190,6 +190,7 @@ register_agentx_list(netsnmp_session * session, netsnmp_pdu *pdu)
     oid             ubound = 0;
     u_long          flags = 0;
     netsnmp_handler_registration *reg;
+    agentx_master_state *state;
     int             rc = 0;
     int             cacheid;
 
@@ -213,14 +214,12 @@ register_agentx_list(netsnmp_session * session, netsnmp_pdu *pdu)
         flags = FULLY_QUALIFIED_INSTANCE;
     }
 
+    state = agentx_master_get_state(session);
+    if (state == NULL)
+        return AGENTX_ERR_PROCESSING_ERROR;
+    cacheid = state->cacheid;
+
     reg = netsnmp_create_handler_registration(buf, agentx_master_handler, pdu->variables->name, pdu->variables->name_length, HANDLER_CAN_RWRITE | HANDLER_CAN_GETBULK); /* fake it */
-    if (!session->myvoid) {
-        session->myvoid = malloc(sizeof(cacheid));
-        cacheid = netsnmp_allocate_globalcacheid();
-        *((int *) session->myvoid) = cacheid;
-    } else {
-        cacheid = *((int *) session->myvoid);
-    }
 
     reg->handler->myvoid = session;
     reg->global_cacheid = cacheid;
@@ -266,12 +266,13 @@ agentx_realloc_build_oid(u_char ** buf, size_t * buf_len, size_t * out_len,
     DEBUGINDENTLESS();
     DEBUGDUMPHEADER("send", "OID Segments");
 
+    /*
+     * Room for every sub-identifier was reserved above, so encode them
+     * in place rather than re-checking the buffer size for each one.
+     */
     for (i = 0; i < name_len; i++) {
-        if (!agentx_realloc_build_int(buf, buf_len, out_len, allow_realloc,
-                                      name[i], network_order)) {
-            DEBUGINDENTLESS();
-            return 0;
-        }
+        agentx_build_int(*buf + *out_len, name[i], network_order);
+        *out_len += 4;
     }
     DEBUGINDENTLESS();
 
@@ -577,6 +578,108 @@ agentx_realloc_build_varbind(u_char ** buf, size_t * buf_len,
     return 1;
 }
 
+/*
+ * Encoded sizes of the various AgentX fields, used to size the output
+ * buffer once up front instead of growing it piecemeal while building.
+ */
+static size_t
+agentx_oid_size(const oid * name, size_t name_len)
+{
+    if (name_len >= 5 && (name[0] == 1 && name[1] == 3 &&
+                          name[2] == 6 && name[3] == 1 &&
+                          name[4] > 0 && name[4] < 256)) {
+        name_len -= 5;
+    }
+    return 4 + (4 * name_len);
+}
+
+static size_t
+agentx_string_size(size_t string_len)
+{
+    return 4 + (4 * ((string_len + 3) / 4));
+}
+
+static size_t
+agentx_varbind_size(const netsnmp_variable_list * vp)
+{
+    size_t          len = 4 + agentx_oid_size(vp->name, vp->name_length);
+
+    switch (vp->type) {
+    case ASN_INTEGER:
+    case ASN_COUNTER:
+    case ASN_GAUGE:
+    case ASN_TIMETICKS:
+        return len + 4;
+#ifdef NETSNMP_WITH_OPAQUE_SPECIAL_TYPES
+    case ASN_OPAQUE_FLOAT:
+        return len + agentx_string_size(3 + sizeof(float));
+    case ASN_OPAQUE_DOUBLE:
+        return len + agentx_string_size(3 + sizeof(double));
+    case ASN_OPAQUE_I64:
+    case ASN_OPAQUE_U64:
+    case ASN_OPAQUE_COUNTER64:
+#endif
+    case ASN_OCTET_STR:
+    case ASN_IPADDRESS:
+    case ASN_OPAQUE:
+        return len + agentx_string_size(vp->val_len);
+    case ASN_OBJECT_ID:
+    case ASN_PRIV_EXCL_RANGE:
+    case ASN_PRIV_INCL_RANGE:
+        return len + agentx_oid_size(vp->val.objid,
+                                     vp->val_len / sizeof(oid));
+    case ASN_COUNTER64:
+        return len + 8;
+    default:
+        return len;
+    }
+}
+
+/*
+ * Returns the number of bytes needed to encode the given PDU.  This is
+ * only a sizing hint: the builders below still check (and if allowed,
+ * grow) the buffer, so an under-estimate costs a realloc, not an overrun.
+ */
+static size_t
+agentx_pdu_size(const netsnmp_pdu *pdu)
+{
+    const netsnmp_variable_list *vp;
+    size_t          len = 20;
+
+    if (pdu->flags & AGENTX_MSG_FLAG_NON_DEFAULT_CONTEXT)
+        len += agentx_string_size(pdu->community_len);
+
+    switch (pdu->command) {
+    case AGENTX_MSG_GETBULK:
+        len += 4;
+        /* Fallthrough */
+    case AGENTX_MSG_GET:
+    case AGENTX_MSG_GETNEXT:
+        for (vp = pdu->variables; vp != NULL; vp = vp->next_variable)
+            len += agentx_oid_size(vp->name, vp->name_length) +
+                agentx_oid_size(vp->val.objid, vp->val_len / sizeof(oid));
+        break;
+
+    case AGENTX_MSG_RESPONSE:
+        len += 8;
+        /* Fallthrough */
+    case AGENTX_MSG_INDEX_ALLOCATE:
+    case AGENTX_MSG_INDEX_DEALLOCATE:
+    case AGENTX_MSG_NOTIFY:
+    case AGENTX_MSG_TESTSET:
+        for (vp = pdu->variables; vp != NULL; vp = vp->next_variable)
+            len += agentx_varbind_size(vp);
+        break;
+
+    default:
+        /*
+         * Control PDUs are small; let the builders size these.
+         */
+        break;
+    }
+    return len;
+}
+
 int
 agentx_realloc_build_header(u_char ** buf, size_t * buf_len,
                             size_t * out_len, int allow_realloc,
@@ -704,6 +807,26 @@ _agentx_realloc_build(u_char ** buf, size_t * buf_len, size_t * out_len,
 		pdu->flags |= AGENTX_MSG_FLAG_NON_DEFAULT_CONTEXT;
 	}
 
+    /*
+     * Size the output buffer for the whole PDU in one go, rather than
+     * letting each field grow it (which degenerates into repeated copies
+     * of the packet built so far when there are many varbinds).
+     */
+    if (allow_realloc) {
+        size_t          needed = *out_len + agentx_pdu_size(pdu) + 1;
+
+        if (*buf_len < needed) {
+            u_char         *new_buf = (u_char *) realloc(*buf, needed);
+
+            if (new_buf == NULL) {
+                session->s_snmp_errno = SNMPERR_MALLOC;
+                return 0;
+            }
+            *buf = new_buf;
+            *buf_len = needed;
+        }
+    }
+
     /*
      * Build the header (and context if appropriate).  
      */
@@ -1540,6 +1663,33 @@ agentx_parse_header(netsnmp_pdu *pdu, u_char * data, size_t * length)
 }
 
 
+/*
+ * Append an empty varbind to the PDU, with its name pointing at the
+ * built-in storage so OIDs can be parsed straight into it.  *last caches
+ * the list tail, keeping long varbind lists linear to build.
+ */
+static netsnmp_variable_list *
+agentx_parse_new_var(netsnmp_pdu *pdu, netsnmp_variable_list **last)
+{
+    netsnmp_variable_list *vp;
+
+    vp = SNMP_MALLOC_TYPEDEF(netsnmp_variable_list);
+    if (vp == NULL)
+        return NULL;
+    vp->name = vp->name_loc;
+
+    if (*last == NULL) {
+        for (*last = pdu->variables; *last && (*last)->next_variable;
+             *last = (*last)->next_variable);
+    }
+    if (*last == NULL)
+        pdu->variables = vp;
+    else
+        (*last)->next_variable = vp;
+    *last = vp;
+    return vp;
+}
+
 int
 agentx_parse(netsnmp_session * session, netsnmp_pdu *pdu, u_char * data,
              size_t len)
@@ -1555,6 +1705,7 @@ agentx_parse(netsnmp_session * session, netsnmp_pdu *pdu, u_char * data,
     int             inc;        /* Inclusive SearchRange flag */
     int             type;       /* VarBind data type */
     size_t         *length = &len;
+    netsnmp_variable_list *vp, *last = NULL;
 
     if (pdu == NULL)
         return (0);
@@ -1743,8 +1894,14 @@ agentx_parse(netsnmp_session * session, netsnmp_pdu *pdu, u_char * data,
          */
         DEBUGDUMPHEADER("recv", "Search Range");
         while (*length > 0) {
+            vp = agentx_parse_new_var(pdu, &last);
+            if (vp == NULL) {
+                DEBUGINDENTLESS();
+                DEBUGINDENTLESS();
+                return SNMPERR_MALLOC;
+            }
             bufp = agentx_parse_oid(bufp, length, &inc,
-                                    oid_buffer, &oid_buf_len,
+                                    vp->name_loc, &oid_buf_len,
                                     pdu->flags &
                                     AGENTX_FLAGS_NETWORK_BYTE_ORDER);
             if (bufp == NULL) {
@@ -1752,6 +1909,7 @@ agentx_parse(netsnmp_session * session, netsnmp_pdu *pdu, u_char * data,
                 DEBUGINDENTLESS();
                 return SNMPERR_ASN_PARSE_ERR;
             }
+            vp->name_length = oid_buf_len;
             bufp = agentx_parse_oid(bufp, length, NULL,
                                     end_oid_buf, &end_oid_buf_len,
                                     pdu->flags &
@@ -1766,16 +1924,11 @@ agentx_parse(netsnmp_session * session, netsnmp_pdu *pdu, u_char * data,
              * 'agentx_parse_oid()' returns the number of sub_ids 
              */
 
-            if (inc) {
-                snmp_pdu_add_variable(pdu, oid_buffer, oid_buf_len,
-                                      ASN_PRIV_INCL_RANGE,
-                                      (u_char *) end_oid_buf,
-                                      end_oid_buf_len);
-            } else {
-                snmp_pdu_add_variable(pdu, oid_buffer, oid_buf_len,
-                                      ASN_PRIV_EXCL_RANGE,
-                                      (u_char *) end_oid_buf,
-                                      end_oid_buf_len);
+            vp->type = inc ? ASN_PRIV_INCL_RANGE : ASN_PRIV_EXCL_RANGE;
+            if (snmp_set_var_value(vp, end_oid_buf, end_oid_buf_len)) {
+                DEBUGINDENTLESS();
+                DEBUGINDENTLESS();
+                return SNMPERR_MALLOC;
             }
             oid_buf_len = MAX_OID_LEN;
             end_oid_buf_len = MAX_OID_LEN;
@@ -1820,8 +1973,14 @@ agentx_parse(netsnmp_session * session, netsnmp_pdu *pdu, u_char * data,
 
         DEBUGDUMPHEADER("recv", "VarBindList");
         while (*length > 0) {
+            vp = agentx_parse_new_var(pdu, &last);
+            if (vp == NULL) {
+                DEBUGINDENTLESS();
+                DEBUGINDENTLESS();
+                return SNMPERR_MALLOC;
+            }
             bufp = agentx_parse_varbind(bufp, length, &type,
-                                        oid_buffer, &oid_buf_len,
+                                        vp->name_loc, &oid_buf_len,
                                         buffer, &buf_len,
                                         pdu->flags &
                                         AGENTX_FLAGS_NETWORK_BYTE_ORDER);
@@ -1830,8 +1989,13 @@ agentx_parse(netsnmp_session * session, netsnmp_pdu *pdu, u_char * data,
                 DEBUGINDENTLESS();
                 return SNMPERR_ASN_PARSE_ERR;
             }
-            snmp_pdu_add_variable(pdu, oid_buffer, oid_buf_len,
-                                  (u_char) type, buffer, buf_len);
+            vp->name_length = oid_buf_len;
+            vp->type = (u_char) type;
+            if (snmp_set_var_value(vp, buffer, buf_len)) {
+                DEBUGINDENTLESS();
+                DEBUGINDENTLESS();
+                return SNMPERR_MALLOC;
+            }
 
             oid_buf_len = MAX_OID_LEN;
             buf_len = sizeof(buffer);
@@ -1900,125 +2064,176 @@ agentx_parse(netsnmp_session * session, netsnmp_pdu *pdu, u_char * data,
 
 #ifdef TESTING
 
-testit(netsnmp_pdu *pdu1)
+/*
+ * Stand-alone round-trip check and benchmark for the encoder/decoder:
+ *
+ *   cc -DTESTING -I$builddir/include -I$srcdir/include \
+ *      -I$srcdir/agent/mibgroup protocol.c -lnetsnmp
+ *   ./a.out [number-of-varbinds]
+ */
+static void
+testit(netsnmp_session * sess, netsnmp_pdu *pdu1)
 {
-    char            packet1[BUFSIZ];
-    char            packet2[BUFSIZ];
-    int             len1, len2;
-    netsnmp_pdu     pdu2;
-    netsnmp_session sess;
-
-    memset(&pdu2, 0, sizeof(netsnmp_pdu));
-    memset(packet1, 0, BUFSIZ);
-    memset(packet2, 0, BUFSIZ);
+    u_char         *packet1 = NULL, *packet2 = NULL;
+    size_t          buf_len1 = 0, buf_len2 = 0, len1 = 0, len2 = 0;
+    netsnmp_pdu    *pdu2;
 
     /*
      * Encode this into a "packet" 
      */
-    len1 = BUFSIZ;
-    if (agentx_build(&sess, pdu1, packet1, &len1) < 0) {
-        DEBUGMSGTL(("agentx", "First build failed\n"));
+    if (agentx_realloc_build(sess, pdu1, &packet1, &buf_len1, &len1) < 0) {
+        printf("First build failed\n");
         exit(1);
     }
 
-    DEBUGMSGTL(("agentx", "First build succeeded:\n"));
-    xdump(packet1, len1, "Ax1> ");
-
     /*
      * Unpack this into a PDU 
      */
-    len2 = len1;
-    if (agentx_parse(&pdu2, packet1, &len2, (u_char **) NULL) < 0) {
-        DEBUGMSGTL(("agentx", "First parse failed\n"));
+    pdu2 = SNMP_MALLOC_TYPEDEF(netsnmp_pdu);
+    if (agentx_parse(sess, pdu2, packet1, len1) != SNMP_ERR_NOERROR) {
+        printf("First parse failed\n");
         exit(1);
     }
-    DEBUGMSGTL(("agentx", "First parse succeeded:\n"));
-    if (len2 != 0)
-        DEBUGMSGTL(("agentx",
-                    "Warning - parsed packet has %d bytes left\n", len2));
 
     /*
      * Encode this into another "packet" 
      */
-    len2 = BUFSIZ;
-    if (agentx_build(&sess, &pdu2, packet2, &len2) < 0) {
-        DEBUGMSGTL(("agentx", "Second build failed\n"));
+    if (agentx_realloc_build(sess, pdu2, &packet2, &buf_len2, &len2) < 0) {
+        printf("Second build failed\n");
         exit(1);
     }
 
-    DEBUGMSGTL(("agentx", "Second build succeeded:\n"));
-    xdump(packet2, len2, "Ax2> ");
-
     /*
      * Compare the results 
      */
     if (len1 != len2) {
-        DEBUGMSGTL(("agentx",
-                    "Error: first build (%d) is different to second (%d)\n",
-                    len1, len2));
+        printf("Error: first build (%d) is different to second (%d)\n",
+               (int) len1, (int) len2);
         exit(1);
     }
     if (memcmp(packet1, packet2, len1) != 0) {
-        DEBUGMSGTL(("agentx",
-                    "Error: first build data is different to second\n"));
+        printf("Error: first build data is different to second\n");
         exit(1);
     }
 
-    DEBUGMSGTL(("agentx", "OK\n"));
+    printf("OK\n");
+    snmp_free_pdu(pdu2);
+    free(packet1);
+    free(packet2);
 }
 
+static double
+elapsed(struct timeval *start)
+{
+    struct timeval  now;
 
+    gettimeofday(&now, NULL);
+    return (now.tv_sec - start->tv_sec) +
+        (now.tv_usec - start->tv_usec) / 1000000.0;
+}
 
-main()
+int
+main(int argc, char **argv)
 {
-    netsnmp_pdu     pdu1;
-    oid             oid_buf[] = { 1, 3, 6, 1, 2, 1, 10 };
+    netsnmp_session sess;
+    netsnmp_pdu    *pdu1, *pdu2;
+    netsnmp_variable_list *vp = NULL;
+    oid             oid_buf[] = { 1, 3, 6, 1, 2, 1, 25, 6, 3, 1, 2, 0 };
     oid             oid_buf2[] = { 1, 3, 6, 1, 2, 1, 20 };
-    oid             null_oid[] = { 0, 0 };
-    char           *string = "Example string";
-    char           *context = "LUCS";
+    const char     *string = "Example string";
+    const char     *context = "LUCS";
+    u_char         *packet = NULL;
+    size_t          buf_len = 0, len = 0;
+    struct timeval  start;
+    double          t_build, t_parse;
+    int             count = 1000000, i;
 
+    if (argc > 1)
+        count = atoi(argv[1]);
+
+    memset(&sess, 0, sizeof(sess));
+    sess.version = AGENTX_VERSION_1;
 
     /*
      * Create an example AgentX pdu structure 
      */
-
-    memset(&pdu1, 0, sizeof(netsnmp_pdu));
-    pdu1.command = AGENTX_MSG_TESTSET;
-    pdu1.flags = 0;
-    pdu1.sessid = 16;
-    pdu1.transid = 24;
-    pdu1.reqid = 132;
-
-    pdu1.time = 10;
-    pdu1.non_repeaters = 3;
-    pdu1.max_repetitions = 32;
-    pdu1.priority = 5;
-    pdu1.range_subid = 0;
-
-    snmp_pdu_add_variable(&pdu1, oid_buf, sizeof(oid_buf) / sizeof(oid),
-                          ASN_OBJECT_ID, (char *) oid_buf2,
-                          sizeof(oid_buf2));
-    snmp_pdu_add_variable(&pdu1, oid_buf, sizeof(oid_buf) / sizeof(oid),
-                          ASN_INTEGER, (char *) &pdu1.reqid,
-                          sizeof(pdu1.reqid));
-    snmp_pdu_add_variable(&pdu1, oid_buf, sizeof(oid_buf) / sizeof(oid),
-                          ASN_OCTET_STR, (char *) string, strlen(string));
+    pdu1 = SNMP_MALLOC_TYPEDEF(netsnmp_pdu);
+    pdu1->command = AGENTX_MSG_TESTSET;
+    pdu1->sessid = 16;
+    pdu1->transid = 24;
+    pdu1->reqid = 132;
+
+    snmp_pdu_add_variable(pdu1, oid_buf, OID_LENGTH(oid_buf),
+                          ASN_OBJECT_ID, oid_buf2, sizeof(oid_buf2));
+    snmp_pdu_add_variable(pdu1, oid_buf, OID_LENGTH(oid_buf),
+                          ASN_INTEGER, &pdu1->reqid, sizeof(pdu1->reqid));
+    snmp_pdu_add_variable(pdu1, oid_buf, OID_LENGTH(oid_buf),
+                          ASN_OCTET_STR, string, strlen(string));
 
     printf("Test with non-network order.....\n");
-    testit(&pdu1);
+    testit(&sess, pdu1);
 
-    printf("\nTest with network order.....\n");
-    pdu1.flags |= AGENTX_FLAGS_NETWORK_BYTE_ORDER;
-    testit(&pdu1);
+    printf("Test with network order.....\n");
+    pdu1->flags |= AGENTX_FLAGS_NETWORK_BYTE_ORDER;
+    testit(&sess, pdu1);
 
-    pdu1.community = context;
-    pdu1.community_len = strlen(context);
-    pdu1.flags |= AGENTX_FLAGS_NON_DEFAULT_CONTEXT;
     printf("Test with non-default context.....\n");
-    testit(&pdu1);
+    pdu1->community = (u_char *) strdup(context);
+    pdu1->community_len = strlen(context);
+    pdu1->flags |= AGENTX_MSG_FLAG_NON_DEFAULT_CONTEXT;
+    testit(&sess, pdu1);
+    snmp_free_pdu(pdu1);
+
+    /*
+     * Round-trip a large response, such as a subagent answering a
+     * GetBulk over a big table.
+     */
+    printf("Round trip of %d varbinds.....\n", count);
+    pdu1 = SNMP_MALLOC_TYPEDEF(netsnmp_pdu);
+    pdu1->command = AGENTX_MSG_RESPONSE;
+    for (i = 0; i < count; i++) {
+        oid_buf[OID_LENGTH(oid_buf) - 1] = i;
+        if (i & 1)
+            vp = snmp_varlist_add_variable(vp ? &vp->next_variable :
+                                           &pdu1->variables,
+                                           oid_buf, OID_LENGTH(oid_buf),
+                                           ASN_OCTET_STR, string,
+                                           strlen(string));
+        else
+            vp = snmp_varlist_add_variable(vp ? &vp->next_variable :
+                                           &pdu1->variables,
+                                           oid_buf, OID_LENGTH(oid_buf),
+                                           ASN_INTEGER, &i, sizeof(i));
+    }
 
+    gettimeofday(&start, NULL);
+    if (agentx_realloc_build(&sess, pdu1, &packet, &buf_len, &len) < 0) {
+        printf("Build failed\n");
+        exit(1);
+    }
+    t_build = elapsed(&start);
 
+    gettimeofday(&start, NULL);
+    pdu2 = SNMP_MALLOC_TYPEDEF(netsnmp_pdu);
+    if (agentx_parse(&sess, pdu2, packet, len) != SNMP_ERR_NOERROR) {
+        printf("Parse failed\n");
+        exit(1);
+    }
+    t_parse = elapsed(&start);
+
+    for (i = 0, vp = pdu2->variables; vp; vp = vp->next_variable)
+        i++;
+    if (i != count) {
+        printf("Error: parsed %d varbinds, expected %d\n", i, count);
+        exit(1);
+    }
+
+    printf("  %d bytes, build %.3fs, parse %.3fs\n", (int) len,
+           t_build, t_parse);
+    snmp_free_pdu(pdu1);
+    snmp_free_pdu(pdu2);
+    free(packet);
+    return 0;
 }
 #endif
 
@@ -71,6 +71,7 @@ int             subagent_open_master_session(void);
 
 typedef struct _net_snmpsubagent_magic_s {
     int             original_command;
+    int             non_repeaters;
     netsnmp_session *session;
     netsnmp_variable_list *ovars;
 } ns_subagent_magic;
@@ -289,6 +290,7 @@ handle_agentx_packet(int operation, netsnmp_session * session, int reqid,
                             SNMPD_CALLBACK_INDEX_STOP, (void *) session);
         agentx_unregister_callbacks(session);
         remove_trap_session(session);
+        agentx_register_batch_reset(session);
         register_mib_detach();
         main_session = NULL;
         if (period != 0) {
@@ -357,10 +359,13 @@ handle_agentx_packet(int operation, netsnmp_session * session, int reqid,
 
     case AGENTX_MSG_GETBULK:
         /*
-         * WWWXXX 
+         * The whole bulk request is serviced by one pass through the
+         * local agent, and the results scoped in handle_subagent_response
          */
-        DEBUGMSGTL(("agentx/subagent", "  -> getbulk\n"));
+        DEBUGMSGTL(("agentx/subagent", "  -> getbulk (n=%ld, m=%ld)\n",
+                    pdu->non_repeaters, pdu->max_repetitions));
         pdu->command = SNMP_MSG_GETBULK;
+        smagic->non_repeaters = pdu->non_repeaters;
 
         /*
          * We have to save a copy of the original variable list here because
@@ -504,13 +509,54 @@ _invalid_op_and_magic(int op, ns_subagent_magic *smagic)
     return invalid;
 }
 
+/*
+ * Apply the search range of the original request u to the result v
+ */
+static void
+_subagent_scope_var(netsnmp_variable_list *u, netsnmp_variable_list *v)
+{
+    int             rc;
+
+    if (snmp_oid_compare
+        (u->val.objid, u->val_len / sizeof(oid), nullOid,
+         nullOidLen/sizeof(oid)) == 0) {
+        DEBUGMSGTL(("agentx/subagent", "unscoped var\n"));
+        return;
+    }
+
+    /*
+     * The master agent requested scoping for this variable.  
+     */
+    rc = snmp_oid_compare(v->name, v->name_length,
+                          u->val.objid,
+                          u->val_len / sizeof(oid));
+    DEBUGMSGTL(("agentx/subagent", "result "));
+    DEBUGMSGOID(("agentx/subagent", v->name, v->name_length));
+    DEBUGMSG(("agentx/subagent", " scope to "));
+    DEBUGMSGOID(("agentx/subagent",
+                 u->val.objid, u->val_len / sizeof(oid)));
+    DEBUGMSG(("agentx/subagent", " result %d\n", rc));
+
+    if (rc >= 0) {
+        /*
+         * The varbind is out of scope.  From RFC2741, p. 66: "If
+         * the subagent cannot locate an appropriate variable,
+         * v.name is set to the starting OID, and the VarBind is
+         * set to `endOfMibView'".  
+         */
+        snmp_set_var_objid(v, u->name, u->name_length);
+        snmp_set_var_typed_value(v, SNMP_ENDOFMIBVIEW, NULL, 0);
+        DEBUGMSGTL(("agentx/subagent",
+                    "scope violation -- return endOfMibView\n"));
+    }
+}
+
 int
 handle_subagent_response(int op, netsnmp_session * session, int reqid,
                          netsnmp_pdu *pdu, void *magic)
 {
     ns_subagent_magic *smagic = (ns_subagent_magic *) magic;
     netsnmp_variable_list *u = NULL, *v = NULL;
-    int             rc = 0;
 
     if (_invalid_op_and_magic(op, magic)) {
         return 1;
@@ -538,44 +584,33 @@ handle_subagent_response(int op, netsnmp_session * session, int reqid,
                     pdu->variables));
         for (u = smagic->ovars, v = pdu->variables; u != NULL && v != NULL;
              u = u->next_variable, v = v->next_variable) {
-            if (snmp_oid_compare
-                (u->val.objid, u->val_len / sizeof(oid), nullOid,
-                 nullOidLen/sizeof(oid)) != 0) {
-                /*
-                 * The master agent requested scoping for this variable.  
-                 */
-                rc = snmp_oid_compare(v->name, v->name_length,
-                                      u->val.objid,
-                                      u->val_len / sizeof(oid));
-                DEBUGMSGTL(("agentx/subagent", "result "));
-                DEBUGMSGOID(("agentx/subagent", v->name, v->name_length));
-                DEBUGMSG(("agentx/subagent", " scope to "));
-                DEBUGMSGOID(("agentx/subagent",
-                             u->val.objid, u->val_len / sizeof(oid)));
-                DEBUGMSG(("agentx/subagent", " result %d\n", rc));
-
-                if (rc >= 0) {
-                    /*
-                     * The varbind is out of scope.  From RFC2741, p. 66: "If
-                     * the subagent cannot locate an appropriate variable,
-                     * v.name is set to the starting OID, and the VarBind is
-                     * set to `endOfMibView'".  
-                     */
-                    snmp_set_var_objid(v, u->name, u->name_length);
-                    snmp_set_var_typed_value(v, SNMP_ENDOFMIBVIEW, NULL, 0);
-                    DEBUGMSGTL(("agentx/subagent",
-                                "scope violation -- return endOfMibView\n"));
-                }
-            } else {
-                DEBUGMSGTL(("agentx/subagent", "unscoped var\n"));
-            }
+            _subagent_scope_var(u, v);
         }
-    }
+    } else if (smagic->original_command == AGENTX_MSG_GETBULK) {
+        /*
+         * The results hold the non-repeaters followed by the repetitions
+         * of the repeaters interleaved, each scoped by the search range
+         * of the varbind it answers.
+         */
+        netsnmp_variable_list *repeaters;
+        int             i;
 
-    /*
-     * XXXJBPN: similar for GETBULK but the varbinds can get re-ordered I
-     * think which makes it er more difficult.  
-     */
+        DEBUGMSGTL(("agentx/subagent",
+                    "do getBulk scope processing %p %p\n", smagic->ovars,
+                    pdu->variables));
+        for (i = 0, u = smagic->ovars, v = pdu->variables;
+             i < smagic->non_repeaters && u != NULL && v != NULL;
+             i++, u = u->next_variable, v = v->next_variable) {
+            _subagent_scope_var(u, v);
+        }
+        for (repeaters = u; repeaters != NULL && v != NULL;
+             v = v->next_variable) {
+            _subagent_scope_var(u, v);
+            u = u->next_variable;
+            if (u == NULL)
+                u = repeaters;
+        }
+    }
 
     if (smagic->ovars != NULL) {
         snmp_free_varbind(smagic->ovars);
@@ -712,6 +747,7 @@ subagent_shutdown(int majorID, int minorID, void *serverarg, void *clientarg)
 	main_session = NULL;
 	return 0;
     }
+    agentx_register_batch_reset(thesession);
     agentx_close_session(thesession, AGENTX_CLOSE_SHUTDOWN);
     snmp_close(thesession);
     if (main_session != NULL) {
@@ -898,6 +934,35 @@ subagent_open_master_session(void)
     return 0;
 }
 
+/*
+ * Queue up the registrations made until subagent_register_batch_end() is
+ * called, and send them to the master agent in one go.  This is worth
+ * doing when registering many (e.g. per-row or per-instance) subtrees.
+ * Returns 0 if there's no master agent connection to batch for, in which
+ * case the registrations will be passed on when one is established.
+ */
+int
+subagent_register_batch_begin(void)
+{
+    if (main_session == NULL)
+        return 0;
+    return agentx_register_batch_begin(main_session);
+}
+
+/*
+ * Send the queued registrations.  The callback (which may be NULL) is
+ * called once the master agent has answered all of them, with the number
+ * that succeeded and failed.  Returns the number of registrations sent.
+ */
+int
+subagent_register_batch_end(agentx_register_batch_callback * callback,
+                            void *magic)
+{
+    if (main_session == NULL)
+        return 0;
+    return agentx_register_batch_end(main_session, callback, magic);
+}
+
 static void
 agentx_reopen_sysORTable(const struct sysORTable* data, void* v)
 {
@@ -929,9 +994,11 @@ agentx_reopen_session(unsigned int clientreg, void *clientarg)
         }
 
         /*
-         * Reregister all our nodes.  
+         * Reregister all our nodes, as a single batch.  
          */
+        agentx_register_batch_begin(main_session);
         register_mib_reattach();
+        agentx_register_batch_end(main_session, NULL, NULL);
 
         /*
          * Reregister all our sysOREntries
@@ -1030,6 +1097,7 @@ agentx_check_session(unsigned int clientreg, void *clientarg)
         snmp_alarm_unregister(clientreg);       /* delete ping alarm timer */
         snmp_call_callbacks(SNMP_CALLBACK_APPLICATION,
                             SNMPD_CALLBACK_INDEX_STOP, (void *) ss);
+        agentx_register_batch_reset(ss);
         register_mib_detach();
         if (main_session != NULL) {
             remove_trap_session(ss);
@@ -12,6 +12,10 @@ config_error(agentx/subagent depends on the Callback transport)
 #endif
 
      int             subagent_init(void);
+     int             subagent_register_batch_begin(void);
+     int             subagent_register_batch_end(void (*)(netsnmp_session *,
+                                                          int, int, void *),
+                                                 void *);
      int             handle_agentx_packet(int, netsnmp_session *, int,
                                           netsnmp_pdu *, void *);
      SNMPCallback    agentx_register_callback;
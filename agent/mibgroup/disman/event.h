@@ -5,6 +5,7 @@ config_add_mib(DISMAN-EVENT-MIB)
  */
 config_require(disman/event/mteScalars)
 config_require(disman/event/mteTrigger)
+config_require(disman/event/mteSample)
 config_require(disman/event/mteTriggerTable)
 config_require(disman/event/mteTriggerDeltaTable)
 config_require(disman/event/mteTriggerExistenceTable)
@@ -0,0 +1,547 @@
+/*
+ * DisMan Event MIB:
+ *     Scheduling of the triggers, and retrieval of the values
+ *     they monitor (shared between triggers with the same frequency)
+ */
+
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+#include "disman/event/mteTrigger.h"
+#include "disman/event/mteSample.h"
+
+static struct mteSampleGroup *_mteSample_groups = NULL;
+
+    /*
+     * A value (or subtree of values) retrieved for the current group run,
+     *   indexed by its OID.  A subtree that lies within another subtree
+     *   being walked is picked out of the results of that walk instead.
+     */
+struct mteSample {
+    netsnmp_index   idx;
+    oid             name[MAX_OID_LEN];
+    int             rc;
+    netsnmp_variable_list *vars;
+    struct mteSample *root;
+};
+#define MTE_SAMPLE_PENDING  -1          /* not (yet) retrieved */
+
+    /*
+     * The values retrieved using equivalent internal query sessions.
+     */
+struct mteSampleSet {
+    netsnmp_session   *session;
+    netsnmp_container *gets;
+    netsnmp_container *walks;
+    struct mteSampleSet *next;
+};
+
+static struct mteSampleSet *_mteSample_sets = NULL;
+
+    /* ===================================================
+     *
+     * Retrieving the monitored values for a group run
+     *
+     * =================================================== */
+
+static int
+_mteSample_same_session(netsnmp_session *s1, netsnmp_session *s2)
+{
+    if (s1 == s2)
+        return 1;
+    if (!s1 || !s2)
+        return 0;
+    if (s1->version       != s2->version       ||
+        s1->securityModel != s2->securityModel ||
+        s1->securityLevel != s2->securityLevel ||
+        s1->contextNameLen != s2->contextNameLen ||
+        (s1->contextNameLen &&
+         memcmp(s1->contextName, s2->contextName, s1->contextNameLen)))
+        return 0;
+    if (s1->version == SNMP_VERSION_3)
+        return (s1->securityNameLen == s2->securityNameLen &&
+                (!s1->securityNameLen ||
+                 !memcmp(s1->securityName, s2->securityName,
+                         s1->securityNameLen)));
+    return (s1->community_len == s2->community_len &&
+            (!s1->community_len ||
+             !memcmp(s1->community, s2->community, s1->community_len)));
+}
+
+static struct mteSampleSet *
+_mteSample_set(netsnmp_session *session, int create)
+{
+    struct mteSampleSet *set;
+
+    for (set = _mteSample_sets; set; set = set->next)
+        if (_mteSample_same_session(set->session, session))
+            return set;
+    if (!create)
+        return NULL;
+
+    set = SNMP_MALLOC_TYPEDEF(struct mteSampleSet);
+    if (!set)
+        return NULL;
+    set->gets  = netsnmp_container_find("mteSample:binary_array");
+    set->walks = netsnmp_container_find("mteSample:binary_array");
+    if (!set->gets || !set->walks) {
+        if (set->gets)
+            CONTAINER_FREE(set->gets);
+        if (set->walks)
+            CONTAINER_FREE(set->walks);
+        SNMP_FREE(set);
+        return NULL;
+    }
+    set->session = session;
+    set->next    = _mteSample_sets;
+    _mteSample_sets = set;
+    return set;
+}
+
+static struct mteSample *
+_mteSample_find(struct mteSampleSet *set, oid *name, size_t name_len, int wild)
+{
+    struct mteSample key;
+
+    key.idx.oids = name;
+    key.idx.len  = name_len;
+    return (struct mteSample *)CONTAINER_FIND(wild ? set->walks : set->gets,
+                                              &key);
+}
+
+static void
+_mteSample_add(struct mteSampleSet *set, oid *name, size_t name_len, int wild)
+{
+    struct mteSample *sample;
+
+    if (_mteSample_find(set, name, name_len, wild))
+        return;
+
+    /*
+     * If this fails, the trigger will just query the value itself
+     */
+    sample = SNMP_MALLOC_TYPEDEF(struct mteSample);
+    if (!sample)
+        return;
+    memcpy(sample->name, name, name_len * sizeof(oid));
+    sample->idx.oids = sample->name;
+    sample->idx.len  = name_len;
+    sample->rc       = MTE_SAMPLE_PENDING;
+    if (CONTAINER_INSERT(wild ? set->walks : set->gets, sample))
+        SNMP_FREE(sample);
+}
+
+    /*
+     * Note the values that this trigger will ask for when it runs
+     */
+static void
+_mteSample_want(struct mteTrigger *entry)
+{
+    struct mteSampleSet *set = _mteSample_set(entry->session, 1);
+
+    if (!set)
+        return;
+    _mteSample_add(set, entry->mteTriggerValueID,
+                        entry->mteTriggerValueID_len,
+                        entry->flags & MTE_TRIGGER_FLAG_VWILD);
+
+    if ((entry->flags & MTE_TRIGGER_FLAG_DELTA) &&
+        (entry->mteTriggerTest & (MTE_TRIGGER_BOOLEAN|MTE_TRIGGER_THRESHOLD))) {
+        _mteSample_add(set, _sysUpTime_instance, _sysUpTime_inst_len, 0);
+        if (!(entry->flags & MTE_TRIGGER_FLAG_SYSUPT))
+            _mteSample_add(set, entry->mteDeltaDiscontID,
+                                entry->mteDeltaDiscontID_len,
+                                entry->flags & MTE_TRIGGER_FLAG_DWILD);
+    }
+}
+
+struct mteSampleWalk {
+    netsnmp_session  *session;
+    struct mteSample *root;
+};
+
+    /*
+     * Walk each subtree in turn (in OID order), unless it lies
+     *   within the subtree walked before it.
+     */
+static void
+_mteSample_walk(void *data, void *context)
+{
+    struct mteSample     *sample = (struct mteSample *)data;
+    struct mteSampleWalk *walk   = (struct mteSampleWalk *)context;
+
+    if (walk->root &&
+        !snmp_oidtree_compare(walk->root->name, walk->root->idx.len,
+                              sample->name, sample->idx.len)) {
+        sample->root = walk->root;
+        return;
+    }
+    walk->root = sample;
+
+    sample->vars = SNMP_MALLOC_TYPEDEF(netsnmp_variable_list);
+    if (!sample->vars)
+        return;
+    snmp_set_var_objid(sample->vars, sample->name, sample->idx.len);
+    sample->rc = netsnmp_query_walk(sample->vars, walk->session);
+    DEBUGMSGTL(("disman:event:sample", "walked "));
+    DEBUGMSGOID(("disman:event:sample", sample->name, sample->idx.len));
+    DEBUGMSG(("disman:event:sample", ": %d\n", sample->rc));
+}
+
+struct mteSampleBatch {
+    netsnmp_session       *session;
+    netsnmp_variable_list *list, *last;
+    struct mteSample      *samples[MTE_SAMPLE_MAX_GET];
+    int                    count;
+};
+
+static void
+_mteSample_get_batch(struct mteSampleBatch *batch)
+{
+    netsnmp_variable_list *var;
+    int i, rc;
+
+    if (!batch->count)
+        return;
+    rc = netsnmp_query_get(batch->list, batch->session);
+
+    /*
+     * The results should line up with the request.  If they don't
+     *   (or the request failed), each trigger will try again itself.
+     * A value that failed is dropped from the request and retried
+     *   without it, which can leave its varbind still NULL.
+     */
+    for (i = 0, var = batch->list;
+         rc == SNMP_ERR_NOERROR && i < batch->count;
+         i++, var = var->next_variable) {
+        if (!var || var->type == ASN_NULL ||
+            snmp_oid_compare(var->name, var->name_length,
+                             batch->samples[i]->name,
+                             batch->samples[i]->idx.len))
+            rc = SNMP_ERR_GENERR;
+    }
+    DEBUGMSGTL(("disman:event:sample", "got %d values: %d\n",
+                batch->count, rc));
+    if (rc == SNMP_ERR_NOERROR) {
+        for (i = 0; i < batch->count; i++) {
+            var = batch->list;
+            batch->list = var->next_variable;
+            var->next_variable = NULL;
+            batch->samples[i]->vars = var;
+            batch->samples[i]->rc   = rc;
+        }
+    }
+    snmp_free_varbind(batch->list);
+    batch->list  = NULL;
+    batch->last  = NULL;
+    batch->count = 0;
+}
+
+static void
+_mteSample_get(void *data, void *context)
+{
+    struct mteSample      *sample = (struct mteSample *)data;
+    struct mteSampleBatch *batch  = (struct mteSampleBatch *)context;
+    netsnmp_variable_list *var;
+
+    var = SNMP_MALLOC_TYPEDEF(netsnmp_variable_list);
+    if (!var)
+        return;
+    snmp_set_var_objid(var, sample->name, sample->idx.len);
+    snmp_set_var_typed_value(var, ASN_NULL, NULL, 0);
+    if (batch->last)
+        batch->last->next_variable = var;
+    else
+        batch->list = var;
+    batch->last = var;
+    batch->samples[batch->count++] = sample;
+
+    if (batch->count == MTE_SAMPLE_MAX_GET)
+        _mteSample_get_batch(batch);
+}
+
+static void
+_mteSample_fetch(void)
+{
+    struct mteSampleSet  *set;
+    struct mteSampleWalk  walk;
+    struct mteSampleBatch batch;
+
+    for (set = _mteSample_sets; set; set = set->next) {
+        memset(&walk, 0, sizeof(walk));
+        walk.session = set->session;
+        CONTAINER_FOR_EACH(set->walks, _mteSample_walk, &walk);
+
+        memset(&batch, 0, sizeof(batch));
+        batch.session = set->session;
+        CONTAINER_FOR_EACH(set->gets, _mteSample_get, &batch);
+        _mteSample_get_batch(&batch);
+    }
+}
+
+static void
+_mteSample_free(void *data, void *context)
+{
+    struct mteSample *sample = (struct mteSample *)data;
+
+    snmp_free_varbind(sample->vars);
+    SNMP_FREE(sample);
+}
+
+static void
+_mteSample_clear(void)
+{
+    struct mteSampleSet *set;
+
+    while ((set = _mteSample_sets)) {
+        _mteSample_sets = set->next;
+        CONTAINER_CLEAR(set->gets,  _mteSample_free, NULL);
+        CONTAINER_CLEAR(set->walks, _mteSample_free, NULL);
+        CONTAINER_FREE(set->gets);
+        CONTAINER_FREE(set->walks);
+        SNMP_FREE(set);
+    }
+}
+
+    /*
+     * Pick the values of a subtree out of the walk of an enclosing one
+     *   (omitting the root of that subtree, as netsnmp_query_walk does).
+     */
+static void
+_mteSample_extract(struct mteSample *sample)
+{
+    struct mteSample      *root = sample->root;
+    netsnmp_variable_list *vp, *var, *last = NULL;
+    int cmp;
+
+    if (root->rc != SNMP_ERR_NOERROR)
+        return;
+    for (vp = root->vars; vp; vp = vp->next_variable) {
+        cmp = snmp_oidtree_compare(sample->name, sample->idx.len,
+                                   vp->name, vp->name_length);
+        if (cmp < 0)
+            break;
+        if (cmp > 0 || vp->name_length <= sample->idx.len)
+            continue;
+        var = SNMP_MALLOC_TYPEDEF(netsnmp_variable_list);
+        if (!var || snmp_clone_var(vp, var)) {
+            SNMP_FREE(var);
+            snmp_free_varbind(sample->vars);
+            sample->vars = NULL;
+            return;
+        }
+        if (last)
+            last->next_variable = var;
+        else
+            sample->vars = var;
+        last = var;
+    }
+    if (!sample->vars) {
+        /* nothing there - leave the query varbind as it was */
+        sample->vars = SNMP_MALLOC_TYPEDEF(netsnmp_variable_list);
+        if (!sample->vars)
+            return;
+        snmp_set_var_objid(sample->vars, sample->name, sample->idx.len);
+    }
+    sample->rc = SNMP_ERR_NOERROR;
+}
+
+    /*
+     * Retrieve a monitored value (or subtree of values) for a trigger,
+     *   in the same way as netsnmp_query_get/netsnmp_query_walk,
+     *   but from the values already retrieved for this group run
+     *   where possible.
+     */
+int
+mteSample_query(struct mteTrigger *entry,
+                oid *name, size_t name_len, int wild,
+                netsnmp_variable_list *var)
+{
+    struct mteSampleSet   *set;
+    struct mteSample      *sample = NULL;
+    netsnmp_variable_list *vp, *vtmp, *last;
+
+    set = _mteSample_set(entry->session, 0);
+    if (set)
+        sample = _mteSample_find(set, name, name_len, wild);
+    if (sample && sample->root && sample->rc == MTE_SAMPLE_PENDING)
+        _mteSample_extract(sample);
+
+    if (!sample || sample->rc == MTE_SAMPLE_PENDING) {
+        if (wild)
+            return netsnmp_query_walk(var, entry->session);
+        else
+            return netsnmp_query_get( var, entry->session);
+    }
+
+    if (snmp_clone_var(sample->vars, var))
+        return SNMP_ERR_GENERR;
+    last = var;
+    for (vp = sample->vars->next_variable; vp; vp = vp->next_variable) {
+        vtmp = SNMP_MALLOC_TYPEDEF(netsnmp_variable_list);
+        if (!vtmp || snmp_clone_var(vp, vtmp)) {
+            SNMP_FREE(vtmp);
+            return SNMP_ERR_GENERR;
+        }
+        last->next_variable = vtmp;
+        last = vtmp;
+    }
+    return sample->rc;
+}
+
+    /* ===================================================
+     *
+     * Scheduling the groups of triggers
+     *
+     * =================================================== */
+
+static int
+_mteSample_due(struct mteTrigger *entry, struct mteSampleGroup *group,
+               int first)
+{
+    if (entry->group != group)
+        return 0;
+    if (first && !(entry->flags & MTE_TRIGGER_FLAG_FIRST))
+        return 0;
+    return ((entry->flags & MTE_TRIGGER_FLAG_ENABLED) &&
+            (entry->flags & MTE_TRIGGER_FLAG_ACTIVE ) &&
+            (entry->flags & MTE_TRIGGER_FLAG_VALID  ));
+}
+
+static void
+_mteSample_free_group(struct mteSampleGroup *group)
+{
+    struct mteSampleGroup **gp;
+
+    for (gp = &_mteSample_groups; *gp; gp = &(*gp)->next)
+        if (*gp == group) {
+            *gp = group->next;
+            break;
+        }
+    if (group->alarm)
+        snmp_alarm_unregister(group->alarm);
+    if (group->startup)
+        snmp_alarm_unregister(group->startup);
+    SNMP_FREE(group);
+}
+
+    /*
+     * Run the triggers in this group (or just the newly enabled ones):
+     *   first retrieve everything they will need, then evaluate them.
+     */
+static void
+_mteSample_group_run(struct mteSampleGroup *group, int first)
+{
+    extern netsnmp_agent_session *netsnmp_processing_set;
+    struct mteTrigger *entry;
+    netsnmp_tdata_row *row, *next;
+
+    if (netsnmp_processing_set) {
+        /*
+         * netsnmp_handle_request will not be responsive to our efforts
+         *  to retrieve the requested MIB value(s), so skip this run.
+         *  (see mteTrigger_run)
+         */
+        DEBUGMSGTL(("disman:event:sample",
+                    "Skipping %lu second triggers while netsnmp_processing_set\n",
+                    group->frequency));
+        return;
+    }
+
+    DEBUGMSGTL(("disman:event:sample", "Sampling %lu second triggers%s\n",
+                group->frequency, first ? " (new)" : ""));
+    for (row = netsnmp_tdata_row_first(trigger_table_data);
+         row;
+         row = netsnmp_tdata_row_next(trigger_table_data, row)) {
+        entry = (struct mteTrigger *)row->data;
+        if (_mteSample_due(entry, group, first))
+            _mteSample_want(entry);
+    }
+    _mteSample_fetch();
+
+    group->running = 1;
+    for (row = netsnmp_tdata_row_first(trigger_table_data); row; row = next) {
+        next  = netsnmp_tdata_row_next(trigger_table_data, row);
+        entry = (struct mteTrigger *)row->data;
+        if (!_mteSample_due(entry, group, first))
+            continue;
+        entry->flags &= ~MTE_TRIGGER_FLAG_FIRST;
+        mteTrigger_run(0, entry);
+    }
+    group->running = 0;
+    _mteSample_clear();
+
+    /*
+     * The last of the triggers might have been disabled by an event
+     */
+    if (!group->count)
+        _mteSample_free_group(group);
+}
+
+static void
+_mteSample_run(unsigned int reg, void *clientarg)
+{
+    _mteSample_group_run((struct mteSampleGroup *)clientarg, 0);
+}
+
+static void
+_mteSample_startup(unsigned int reg, void *clientarg)
+{
+    struct mteSampleGroup *group = (struct mteSampleGroup *)clientarg;
+
+    group->startup = 0;
+    _mteSample_group_run(group, 1);
+}
+
+void
+mteSample_schedule(struct mteTrigger *entry)
+{
+    struct mteSampleGroup *group;
+
+    if (!entry)
+        return;
+    mteSample_unschedule(entry);
+    if (!entry->mteTriggerFrequency)
+        return;
+
+    for (group = _mteSample_groups; group; group = group->next)
+        if (group->frequency == entry->mteTriggerFrequency)
+            break;
+    if (!group) {
+        group = SNMP_MALLOC_TYPEDEF(struct mteSampleGroup);
+        if (!group) {
+            snmp_log(LOG_ERR, "failed to create mteTrigger sample group\n");
+            return;
+        }
+        group->frequency = entry->mteTriggerFrequency;
+        group->alarm = snmp_alarm_register(group->frequency, SA_REPEAT,
+                                           _mteSample_run, group);
+        group->next  = _mteSample_groups;
+        _mteSample_groups = group;
+    }
+    group->count++;
+    entry->group  = group;
+
+    /*
+     * Run new triggers as soon as possible, rather than
+     *  waiting for the next run of the whole group.
+     */
+    entry->flags |= MTE_TRIGGER_FLAG_FIRST;
+    if (!group->startup)
+        group->startup = snmp_alarm_register(0, 0, _mteSample_startup, group);
+}
+
+void
+mteSample_unschedule(struct mteTrigger *entry)
+{
+    struct mteSampleGroup *group;
+
+    if (!entry || !entry->group)
+        return;
+    group = entry->group;
+    entry->group  = NULL;
+    entry->flags &= ~MTE_TRIGGER_FLAG_FIRST;
+
+    if (--group->count == 0 && !group->running)
+        _mteSample_free_group(group);
+}
@@ -0,0 +1,30 @@
+#ifndef MTESAMPLE_H
+#define MTESAMPLE_H
+
+    /*
+     * Triggers are sampled in groups, one group per frequency.
+     *
+     * Each time a group runs, the values monitored by its triggers
+     * are retrieved first (walking each distinct subtree only once,
+     * and fetching the non-wildcarded instances a batch at a time),
+     * and all the tests are then evaluated against this snapshot.
+     */
+#define MTE_SAMPLE_MAX_GET  64    /* varbinds per internal GET request */
+
+struct mteSampleGroup {
+    u_long          frequency;
+    unsigned int    alarm;
+    unsigned int    startup;
+    int             count;      /* triggers in this group     */
+    int             running;    /* triggers being evaluated   */
+    struct mteSampleGroup *next;
+};
+
+void mteSample_schedule(  struct mteTrigger *entry);
+void mteSample_unschedule(struct mteTrigger *entry);
+
+int  mteSample_query(struct mteTrigger *entry,
+                     oid *name, size_t name_len, int wild,
+                     netsnmp_variable_list *var);
+
+#endif                          /* MTESAMPLE_H */
@@ -9,6 +9,7 @@
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 #include "disman/event/mteTrigger.h"
 #include "disman/event/mteEvent.h"
+#include "disman/event/mteSample.h"
 
 netsnmp_feature_child_of(disman_debugging, libnetsnmpmibs)
 netsnmp_feature_child_of(mtetrigger, libnetsnmpmibs)
@@ -246,11 +247,9 @@ mteTrigger_run( unsigned int reg, void *clientarg)
     }
     snmp_set_var_objid( var, entry->mteTriggerValueID,
                              entry->mteTriggerValueID_len );
-    if ( entry->flags & MTE_TRIGGER_FLAG_VWILD ) {
-        n = netsnmp_query_walk( var, entry->session );
-    } else {
-        n = netsnmp_query_get(  var, entry->session );
-    }
+    n = mteSample_query( entry, entry->mteTriggerValueID,
+                                entry->mteTriggerValueID_len,
+                                entry->flags & MTE_TRIGGER_FLAG_VWILD, var );
     if ( n != SNMP_ERR_NOERROR ) {
         DEBUGMSGTL(( "disman:event:trigger:monitor", "Trigger query (%s) failed: %d\n",
                            (( entry->flags & MTE_TRIGGER_FLAG_VWILD ) ? "walk" : "get"), n));
@@ -593,7 +592,8 @@ mteTrigger_run( unsigned int reg, void *clientarg)
             memset( &sysUT_var, 0, sizeof( netsnmp_variable_list ));
             snmp_set_var_objid( &sysUT_var, _sysUpTime_instance,
                                             _sysUpTime_inst_len );
-            netsnmp_query_get(  &sysUT_var, entry->session );
+            mteSample_query( entry, _sysUpTime_instance,
+                                    _sysUpTime_inst_len, 0, &sysUT_var );
 
             if (!(entry->flags & MTE_TRIGGER_FLAG_SYSUPT)) {
                 /*
@@ -616,11 +616,10 @@ mteTrigger_run( unsigned int reg, void *clientarg)
                 }
                 snmp_set_var_objid( dvar, entry->mteDeltaDiscontID,
                                           entry->mteDeltaDiscontID_len );
-                if ( entry->flags & MTE_TRIGGER_FLAG_DWILD ) {
-                    n = netsnmp_query_walk( dvar, entry->session );
-                } else {
-                    n = netsnmp_query_get(  dvar, entry->session );
-                }
+                n = mteSample_query( entry, entry->mteDeltaDiscontID,
+                                            entry->mteDeltaDiscontID_len,
+                                            entry->flags & MTE_TRIGGER_FLAG_DWILD,
+                                            dvar );
                 if ( n != SNMP_ERR_NOERROR ) {
                     _mteTrigger_failure( "failed to run mteTrigger delta query" );
                     snmp_free_varbind( dvar );
@@ -1135,22 +1134,11 @@ mteTrigger_enable( struct mteTrigger *entry )
     if (!entry)
         return;
 
-    if (entry->alarm) {
-        /* XXX - or explicitly call mteTrigger_disable ?? */
-        snmp_alarm_unregister( entry->alarm );
-        entry->alarm = 0;
-    }
-
-    if (entry->mteTriggerFrequency) {
-        /*
-         * register once to run ASAP, and another to run
-         * at the trigger frequency
-         */
-        snmp_alarm_register(0, 0, mteTrigger_run, entry );
-        entry->alarm = snmp_alarm_register(
-                           entry->mteTriggerFrequency, SA_REPEAT,
-                           mteTrigger_run, entry );
-    }
+    /*
+     * Join the group of triggers sampled at this frequency
+     *  (which will run this one ASAP, and then along with the rest)
+     */
+    mteSample_schedule( entry );
 }
 
 void
@@ -1159,11 +1147,8 @@ mteTrigger_disable( struct mteTrigger *entry )
     if (!entry)
         return;
 
-    if (entry->alarm) {
-        snmp_alarm_unregister( entry->alarm );
-        entry->alarm = 0;
-        /* XXX - perhaps release any previous results */
-    }
+    /* XXX - perhaps release any previous results */
+    mteSample_unschedule( entry );
 }
 
 long _mteTrigger_MaxCount = 0;
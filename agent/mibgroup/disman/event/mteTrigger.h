@@ -18,6 +18,7 @@ extern size_t _sysUpTime_inst_len;
 #define MTE_TRIGGER_FLAG_ACTIVE  0x0200  /* for mteTriggerEntryStatus      */
 #define MTE_TRIGGER_FLAG_FIXED   0x0400  /* for snmpd.conf persistence     */
 #define MTE_TRIGGER_FLAG_VALID   0x0800  /* for row creation/undo          */
+#define MTE_TRIGGER_FLAG_FIRST   0x1000  /* waiting for its first sample   */
 
 
     /*
@@ -162,7 +163,7 @@ struct mteTrigger {
      *  Additional fields for operation of the Trigger tables:
      *     monitoring...
      */
-    unsigned int    alarm;
+    struct mteSampleGroup *group;
     long            sysUpTime;
     netsnmp_variable_list *old_results;
     netsnmp_variable_list *old_deltaDs;
@@ -192,6 +193,7 @@ void               mteTrigger_removeEntry(netsnmp_tdata_row *row);
 netsnmp_tdata_row *mteTrigger_createEntry(const char *mteOwner,
                                           char *mteTriggerName, int fixed);
 void               mteTrigger_enable(    struct mteTrigger *entry );
+void               mteTrigger_run( unsigned int reg, void *clientarg );
 void               mteTrigger_disable(   struct mteTrigger *entry );
 
 long mteTrigger_getNumEntries(int max);
@@ -8,6 +8,7 @@
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 #include "disman/expr/expExpression.h"
 #include "disman/expr/expObject.h"
+#include "disman/expr/expValue.h"
 
 netsnmp_tdata *expr_table_data;
 
@@ -142,6 +143,7 @@ expExpression_removeEntry(netsnmp_tdata_row *row)
         netsnmp_tdata_remove_and_delete_row(expr_table_data, row);
     if (entry) {
         /* expExpression_disable( entry ) */
+        expValue_release( entry );
         SNMP_FREE(entry);
     }
 }
@@ -298,6 +300,12 @@ expExpression_getData( unsigned int reg, void *clientarg )
         /* XXX - may need to check whether owner/name still match */
         expObject_getData( entry, (struct expObject *)row->data);
     }
+
+    /*
+     * Any previous results are now out of date.
+     * (They'll be re-evaluated when next requested)
+     */
+    expValue_invalidate( entry );
 }
 
 
@@ -308,6 +316,8 @@ expExpression_enable( struct expExpression *entry )
     if (!entry)
         return;
 
+    expValue_compile( entry );
+
     if (entry->alarm) {
         /* or explicitly call expExpression_disable ?? */
         snmp_alarm_unregister( entry->alarm );
@@ -21,6 +21,9 @@
 #define EXP_STR2_LEN	255
 #define EXP_STR3_LEN	1024
 
+struct expProgram;
+struct expResults;
+
 /*
  * Data structure for an expression row.
  * Covers both expExpressionTable and expErrorTable
@@ -55,6 +58,8 @@ struct expExpression {
     unsigned int    alarm;
     netsnmp_session *session;
     netsnmp_variable_list *pvars;  /* expPrefix values */
+    struct expProgram *program;    /* compiled expExpression         */
+    struct expResults *results;    /* evaluated from current samples */
     long            sysUpTime;
     long            count;
     long            flags;
@@ -12,6 +12,7 @@
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 #include "utilities/iquery.h"
 #include "disman/expr/expExpression.h"
+#include "disman/expr/expValue.h"
 #include "disman/expr/expExpressionTable.h"
 
 netsnmp_feature_require(iquery)
@@ -296,9 +297,11 @@ expExpressionTable_handler(netsnmp_mib_handler *handler,
                 memcpy(entry->expExpression,
                        request->requestvb->val.string,
                        request->requestvb->val_len);
+                expValue_compile( entry );
                 break;
             case COLUMN_EXPEXPRESSIONVALUETYPE:
                 entry->expValueType = *request->requestvb->val.integer;
+                expValue_invalidate( entry );
                 break;
             case COLUMN_EXPEXPRESSIONCOMMENT:
                 memset(entry->expComment, 0, EXP_STR2_LEN+1);
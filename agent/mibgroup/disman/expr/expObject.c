@@ -220,7 +220,7 @@ _expObject_buildList( oid *root, size_t root_len, size_t prefix_len,
             /*
              * ... and set the OID using the template suffix
              */
-            for ( i=0; i <= vp1->name_length - prefix_len; i++)
+            for ( i=0; i < vp1->name_length - prefix_len; i++)
                 name[ root_len+i ] = vp1->name[ prefix_len+i ];
             snmp_set_var_objid( vp2, name, root_len+i );
         }
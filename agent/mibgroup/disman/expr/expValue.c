@@ -13,726 +13,906 @@
 #include <ctype.h>
 
 void _expValue_setError( struct expExpression *exp, int reason,
-                         oid *suffix, size_t suffix_len,
-                         netsnmp_variable_list *var);
+                         oid *suffix, size_t suffix_len, int pos );
 
+    /*
+     * An expression is compiled once (rather than being re-parsed
+     *   every time it is evaluated) into a list of instructions for
+     *   a simple stack machine.  Constants are converted, and object
+     *   parameters allocated to "slots", as part of this compilation.
+     */
+#define EXP_OP_INTEGER   1      /* push the integer 'arg'             */
+#define EXP_OP_CONST     2      /* push the (non-integer) constant    */
+#define EXP_OP_PARAM     3      /* push the value of parameter 'arg'  */
+#define EXP_OP_NEGATE    4      /* unary '-'                          */
+#define EXP_OP_NOT       5      /* unary '!'                          */
+#define EXP_OP_BITNEG    6      /* unary '~'                          */
+#define EXP_OP_BINARY    7      /* binary operator EXP_OPERATOR_'arg' */
+
+struct expInsn {
+    int             op;
+    long            arg;
+    int             pos;        /* (1-based) index into expExpression */
+};
+
+struct expProgram {
+    int             error;      /* EXPERRCODE_xxx if compilation failed */
+    int             errpos;
+    int             ninsns;
+    int             depth;      /* stack space needed to run this     */
+    int             nparams;
+    int             nconsts;
+    struct expInsn *insns;
+    long           *params;     /* expObjectIndex for each slot       */
+    int            *ppos;       /*  ... and where it is first used    */
+    netsnmp_variable_list **consts;
+};
+
+    /*
+     * The results of evaluating every instance of an expression,
+     *   sorted by instance, and kept until new samples are taken.
+     */
+struct expResults {
+    int             count;
+    netsnmp_variable_list  *list;
+    netsnmp_variable_list **vars;
+};
 
-#define ASN_PRIV_OPERATOR    (ASN_PRIVATE | 0x0f)
-#define ASN_PRIV_FUNCTION    (ASN_PRIVATE | 0x0e)
+    /*
+     * The value of a parameter for a single instance - either the
+     *   sampled varbind, or a number calculated from the samples
+     *   (for delta and changed values).
+     */
+struct expOperand {
+    netsnmp_variable_list *var;
+    long            n;
+    int             numeric;
+};
 
-int ops[128];   /* mapping from operator characters to numeric
-                   tokens (ordered by priority). */
+    /*
+     * Position within each of the lists of sampled values
+     *   for a (wildcarded) parameter object.
+     */
+struct expCursor {
+    struct expObject      *obj;
+    netsnmp_variable_list *val, *oval;    /* values  */
+    netsnmp_variable_list *dd,  *odd;     /* deltaDs */
+    netsnmp_variable_list *cond;          /* conditionals */
+};
+
+struct expCompile {
+    struct expProgram *prog;
+    const char     *expr;
+    const char     *cp;
+    int             max;        /* space allocated for the program   */
+    int             sp;
+};
 
 void
 init_expValue(void)
 {
-DEBUGMSGTL(("disman:expr:eval", "Init expValue"));
-        /* Single-character operators */
-    ops['+'] = EXP_OPERATOR_ADD;
-    ops['-'] = EXP_OPERATOR_SUBTRACT;
-    ops['*'] = EXP_OPERATOR_MULTIPLY;
-    ops['/'] = EXP_OPERATOR_DIVIDE;
-    ops['%'] = EXP_OPERATOR_REMAINDER;
-    ops['^'] = EXP_OPERATOR_BITXOR;
-    ops['~'] = EXP_OPERATOR_BITNEGATE;
-    ops['|'] = EXP_OPERATOR_BITOR;
-    ops['&'] = EXP_OPERATOR_BITAND;
-    ops['!'] = EXP_OPERATOR_NOT;
-    ops['<'] = EXP_OPERATOR_LESS;
-    ops['>'] = EXP_OPERATOR_GREAT;
-
-                                         /*
-                                          * Arbitrary offsets, chosen so
-                                          * the three blocks don't overlap.
-                                          */
-        /* "X=" operators */
-    ops['='+20] = EXP_OPERATOR_EQUAL;
-    ops['!'+20] = EXP_OPERATOR_NOTEQ;
-    ops['<'+20] = EXP_OPERATOR_LESSEQ;
-    ops['>'+20] = EXP_OPERATOR_GREATEQ;
-
-        /* "XX" operators */
-    ops['|'-30] = EXP_OPERATOR_OR;
-    ops['&'-30] = EXP_OPERATOR_AND;
-    ops['<'-30] = EXP_OPERATOR_LSHIFT;
-    ops['>'-30] = EXP_OPERATOR_RSHIFT;
+    DEBUGMSGTL(("disman:expr:eval", "Init expValue\n"));
 }
 
-    /*
-     * Insert the value of the specified object parameter,
-     * using the instance 'suffix' for wildcarded objects.
-     */
-netsnmp_variable_list *
-_expValue_evalParam( netsnmp_variable_list *expIdx, int param,
-                     oid *suffix, size_t suffix_len )
+
+/* =============================
+ *  Compiling an expression
+ * ============================= */
+
+static void
+_expCompile_error( struct expCompile *c, int reason, const char *where )
 {
-    netsnmp_variable_list *var = SNMP_MALLOC_TYPEDEF( netsnmp_variable_list );
-    struct expObject  *obj;
-    netsnmp_variable_list *val_var  = NULL, *oval_var = NULL;  /* values  */
-    netsnmp_variable_list *dd_var   = NULL,  *odd_var = NULL;  /* deltaDs */
-    netsnmp_variable_list *cond_var = NULL;               /* conditionals */
-    int n;
+    if ( c->prog->error )
+        return;
+    DEBUGMSGTL(("disman:expr:eval", "Compile error %d at '%s'\n",
+                                     reason, where));
+    c->prog->error  = reason;
+    c->prog->errpos = where - c->expr + 1;
+}
 
-    /*
-     * Retrieve the expObject entry for the requested parameter.
-     */
-    if ( !var || !expIdx || !expIdx->next_variable ||
-                 !expIdx->next_variable->next_variable )
-        return NULL;
+static void
+_expCompile_emit( struct expCompile *c, int op, long arg, const char *where )
+{
+    struct expInsn *insn;
 
-    *expIdx->next_variable->next_variable->val.integer = param;
-    obj = (struct expObject *)
-               netsnmp_tdata_row_entry(
-                   netsnmp_tdata_row_get_byidx( expObject_table_data, expIdx ));
-    if (!obj) {
-        /*
-         * No such parameter configured for this expression
-         */
-        snmp_set_var_typed_integer( var, ASN_INTEGER, EXPERRCODE_INDEX );
-        var->type = ASN_NULL;
-        return var;
+    if ( c->prog->ninsns >= c->max ) {
+        _expCompile_error( c, EXPERRCODE_RESOURCE, where );
+        return;
     }
-    if ( obj->expObjectSampleType != EXPSAMPLETYPE_ABSOLUTE &&
-         obj->old_vars == NULL ) {
-        /*
-         * Can't calculate delta values until the second pass
-         */
-        snmp_set_var_typed_integer( var, ASN_INTEGER, EXPERRCODE_RESOURCE );
-        var->type = ASN_NULL;
-        return var;
+    insn = &c->prog->insns[ c->prog->ninsns++ ];
+    insn->op  = op;
+    insn->arg = arg;
+    insn->pos = where - c->expr + 1;
+
+    switch ( op ) {
+    case EXP_OP_INTEGER:
+    case EXP_OP_CONST:
+    case EXP_OP_PARAM:
+        if ( ++c->sp > c->prog->depth )
+            c->prog->depth = c->sp;
+        break;
+    case EXP_OP_BINARY:
+        c->sp--;
+        break;
     }
+}
+
+static void
+_expCompile_skip( struct expCompile *c )
+{
+    while ( isspace( *c->cp & 0xFF ))
+        c->cp++;
+}
+
+static void
+_expCompile_const( struct expCompile *c, u_char type,
+                   const void *value, size_t len, const char *where )
+{
+    netsnmp_variable_list *var;
+
+    if ( c->prog->nconsts >= c->max ||
+        !(var = SNMP_MALLOC_TYPEDEF( netsnmp_variable_list ))) {
+        _expCompile_error( c, EXPERRCODE_RESOURCE, where );
+        return;
+    }
+    snmp_set_var_typed_value( var, type, (const u_char *)value, len );
+    c->prog->consts[ c->prog->nconsts ] = var;
+    _expCompile_emit( c, EXP_OP_CONST, c->prog->nconsts++, where );
+}
 
+static void
+_expCompile_param( struct expCompile *c, const char *where )
+{
+    struct expProgram *prog = c->prog;
+    char *end;
+    long  n;
+    int   i;
+
+    if ( !isdigit( c->cp[1] & 0xFF )) {
+        _expCompile_error( c, EXPERRCODE_SYNTAX, where );
+        return;
+    }
+    n = strtol( c->cp+1, &end, 10 );
+    c->cp = end;
 
     /*
-     * For a wildcarded object, search for the matching suffix.
+     * Each distinct object gets a single slot,
+     *   however often it's used in the expression.
      */
-    val_var = obj->vars;
-    if ( obj->flags & EXP_OBJ_FLAG_OWILD ) {
-        if ( !suffix ) {
-            /*
-             * If there's no suffix to match against, throw an error.
-             * An exact expression with a wildcarded object is invalid.
-             *   XXX - Or just use first entry?
-             */
-            snmp_set_var_typed_integer( var, ASN_INTEGER, EXPERRCODE_INDEX );
-            var->type = ASN_NULL;
-            return var;
-        }
-        /*
-         * Otherwise, we'll walk *all* wildcarded values in parallel.
-         * This relies on the various varbind lists being set up with
-         *   exactly the same entries.  A little extra preparation
-         *   during the data gathering simplifies things significantly!
-         */
-        if ( obj->expObjectSampleType != EXPSAMPLETYPE_ABSOLUTE )
-            oval_var = obj->old_vars;
-        if ( obj->flags & EXP_OBJ_FLAG_DWILD ) {
-            dd_var   = obj->dvars;
-            odd_var  = obj->old_dvars;
-        }
-        if ( obj->flags & EXP_OBJ_FLAG_CWILD )
-            cond_var = obj->cvars;
-       
-        n = obj->expObjectID_len;
-        while ( val_var ) {
-            if ( snmp_oid_compare( val_var->name+n, val_var->name_length-n,
-                                   suffix, suffix_len ))
-                break;
-            val_var = val_var->next_variable;
-            if (oval_var)
-                oval_var = oval_var->next_variable;
-            if (dd_var) {
-                dd_var   =  dd_var->next_variable;
-                odd_var  = odd_var->next_variable;
-            }
-            if (cond_var)
-                cond_var = cond_var->next_variable;
-        }
+    for ( i = 0; i < prog->nparams; i++ )
+        if ( prog->params[i] == n )
+            break;
+    if ( i == prog->nparams ) {
+        prog->params[i] = n;
+        prog->ppos[i]   = where - c->expr + 1;
+        prog->nparams++;
+    }
+    _expCompile_emit( c, EXP_OP_PARAM, i, where );
+}
 
+static void
+_expCompile_string( struct expCompile *c, const char *where )
+{
+    char   buf[ EXP_STR3_LEN+1 ];
+    size_t len = 0;
+    const char *cp;
+
+    for ( cp = c->cp+1; *cp && *cp != '"'; cp++ ) {
+        if ( *cp == '\\' && *(cp+1) == '"' )
+            cp++;
+        if ( len < EXP_STR3_LEN )
+            buf[ len++ ] = *cp;
     }
-    if (!val_var) {
-        /*
-         * No matching entry
-         */
-        snmp_set_var_typed_integer( var, ASN_INTEGER, EXPERRCODE_INDEX );
-        var->type = ASN_NULL;
-        return var;
+    if ( *cp != '"' ) {
+        DEBUGMSGTL(("disman:expr:eval", "Unterminated string\n"));
+        _expCompile_error( c, EXPERRCODE_SYNTAX, where );
+        return;
     }
-        /*
-         * Set up any non-wildcarded values - some
-         *   of which may be null. That's fine.
-         */
-    if (!oval_var)
-        oval_var = obj->old_vars;
-    if (!dd_var) {
-        dd_var   = obj->dvars;
-        odd_var  = obj->old_dvars;
+    c->cp = cp+1;
+    _expCompile_const( c, ASN_OCTET_STR, buf, len, where );
+}
+
+static void
+_expCompile_number( struct expCompile *c, const char *where )
+{
+    oid    oid_buf[ MAX_OID_LEN ];
+    size_t len = 0;
+    char  *end;
+    u_long n;
+
+    if ( *c->cp != '.' ) {
+        n = strtoul( c->cp, &end, 10 );
+        c->cp = end;
+        if ( *c->cp != '.' || !isdigit( c->cp[1] & 0xFF )) {
+            _expCompile_emit( c, EXP_OP_INTEGER, (long)n, where );
+            return;
+        }
+        oid_buf[ len++ ] = n;
+    } else if ( !isdigit( c->cp[1] & 0xFF )) {
+        _expCompile_error( c, EXPERRCODE_SYNTAX, where );
+        return;
     }
-    if (!cond_var)
-        cond_var = obj->cvars;
-    
 
     /*
-     * ... and return the appropriate value.
+     * An OID constant - either ".1.3.6..." or "1.3.6..."
      */
-    if (obj->expObjCond_len &&
-        (!cond_var || *cond_var->val.integer == 0)) {
-        /*
-         * expObjectConditional says no
-         */
-        snmp_set_var_typed_integer( var, ASN_INTEGER, EXPERRCODE_INDEX );
-        var->type = ASN_NULL;
-        return var;
+    while ( *c->cp == '.' && isdigit( c->cp[1] & 0xFF )) {
+        n = strtoul( c->cp+1, &end, 10 );
+        c->cp = end;
+        if ( len >= MAX_OID_LEN ) {
+            _expCompile_error( c, EXPERRCODE_SYNTAX, where );
+            return;
+        }
+        oid_buf[ len++ ] = n;
     }
-    if (dd_var && odd_var &&
-        *dd_var->val.integer != *odd_var->val.integer) {
-        /*
-         * expObjectDeltaD says no
-         */
-        snmp_set_var_typed_integer( var, ASN_INTEGER, EXPERRCODE_INDEX );
-        var->type = ASN_NULL;
-        return var;
+    _expCompile_const( c, ASN_OBJECT_ID, oid_buf, len*sizeof(oid), where );
+}
+
+static void _expCompile_expr( struct expCompile *c, int min );
+
+static void
+_expCompile_operand( struct expCompile *c )
+{
+    const char *start;
+    int first;
+
+    _expCompile_skip( c );
+    start = c->cp;
+
+    switch ( *c->cp ) {
+    case '-':
+    case '!':
+    case '~':
+        c->cp++;
+        first = c->prog->ninsns;
+        _expCompile_operand( c );
+        if ( c->prog->error )
+            return;
+        if ( *start == '-' && c->prog->ninsns == first+1 &&
+             c->prog->insns[ first ].op == EXP_OP_INTEGER ) {
+            /* Negative constant */
+            c->prog->insns[ first ].arg = -c->prog->insns[ first ].arg;
+            c->prog->insns[ first ].pos = start - c->expr + 1;
+        } else
+            _expCompile_emit( c, ( *start == '-' ) ? EXP_OP_NEGATE :
+                                 ( *start == '!' ) ? EXP_OP_NOT :
+                                                     EXP_OP_BITNEG, 0, start );
+        break;
+
+    case '(':
+        c->cp++;
+        _expCompile_expr( c, 1 );
+        if ( c->prog->error )
+            return;
+        _expCompile_skip( c );
+        if ( *c->cp != ')' ) {
+            DEBUGMSGTL(("disman:expr:eval", "Unbalanced parenthesis\n"));
+            _expCompile_error( c, EXPERRCODE_PARENTHESIS, start );
+            return;
+        }
+        c->cp++;
+        break;
+
+    case '$':
+        _expCompile_param( c, start );
+        break;
+
+    case '"':
+        _expCompile_string( c, start );
+        break;
+
+    default:
+        if ( *c->cp == '.' || isdigit( *c->cp & 0xFF ))
+            _expCompile_number( c, start );
+        else if ( isalpha( *c->cp & 0xFF )) {
+            /*
+             * None of the standard functions are supported (yet)
+             */
+            DEBUGMSGTL(("disman:expr:eval", "Unsupported function '%s'\n",
+                                             c->cp));
+            _expCompile_error( c, EXPERRCODE_FUNCTION, start );
+        } else
+            _expCompile_error( c, EXPERRCODE_SYNTAX, start );
+        break;
     }
+}
 
     /*
-     * XXX - May need to check sysUpTime discontinuities
-     *            (unless this is handled earlier....)
+     * Recognise a binary operator (returning EXP_OPERATOR_xxx)
      */
-    switch ( obj->expObjectSampleType ) {
-    case EXPSAMPLETYPE_ABSOLUTE:
-        snmp_clone_var( val_var, var );
+static int
+_expCompile_operator( const char *cp, int *len )
+{
+    *len = 1;
+    switch ( *cp ) {
+    case '+':  return EXP_OPERATOR_ADD;
+    case '-':  return EXP_OPERATOR_SUBTRACT;
+    case '*':  return EXP_OPERATOR_MULTIPLY;
+    case '/':  return EXP_OPERATOR_DIVIDE;
+    case '%':  return EXP_OPERATOR_REMAINDER;
+    case '^':  return EXP_OPERATOR_BITXOR;
+    case '&':
+        if ( cp[1] != '&' )
+            return EXP_OPERATOR_BITAND;
+        *len = 2;
+        return EXP_OPERATOR_AND;
+    case '|':
+        if ( cp[1] != '|' )
+            return EXP_OPERATOR_BITOR;
+        *len = 2;
+        return EXP_OPERATOR_OR;
+    case '<':
+        if ( cp[1] == '<' ) { *len = 2; return EXP_OPERATOR_LSHIFT; }
+        if ( cp[1] == '=' ) { *len = 2; return EXP_OPERATOR_LESSEQ; }
+        return EXP_OPERATOR_LESS;
+    case '>':
+        if ( cp[1] == '>' ) { *len = 2; return EXP_OPERATOR_RSHIFT; }
+        if ( cp[1] == '=' ) { *len = 2; return EXP_OPERATOR_GREATEQ; }
+        return EXP_OPERATOR_GREAT;
+    case '=':
+        if ( cp[1] == '=' ) { *len = 2; return EXP_OPERATOR_EQUAL; }
         break;
-    case EXPSAMPLETYPE_DELTA:
-        snmp_set_var_typed_integer( var, ASN_INTEGER /* or UNSIGNED? */,
-                              *val_var->val.integer - *oval_var->val.integer );
+    case '!':
+        if ( cp[1] == '=' ) { *len = 2; return EXP_OPERATOR_NOTEQ; }
         break;
-    case EXPSAMPLETYPE_CHANGED:
-        if ( val_var->val_len != oval_var->val_len )
-            n = 1;
-        else if (memcmp( val_var->val.string, oval_var->val.string,
-                                               val_var->val_len ) != 0 )
-            n = 1;
-        else
-            n = 0;
-        snmp_set_var_typed_integer( var, ASN_UNSIGNED, n );
     }
-    return var;
+    return 0;
 }
 
-
     /*
-     * Utility routine to parse (and skip over) an integer constant
+     * Operator priorities, as for C
      */
-int
-_expParse_integer( char *start, char **end ) {
-    int n;
-    char *cp;
-
-    n = atoi(start);
-    for (cp=start; *cp; cp++)
-        if (!isdigit(*cp))
-            break;
-    *end = cp;
-    return n;
-}
-
-netsnmp_variable_list *
-_expValue_evalOperator(netsnmp_variable_list *left, 
-                       netsnmp_variable_list *op, 
-                       netsnmp_variable_list *right) {
-    int n;
-
-    switch( *op->val.integer ) {
-    case EXP_OPERATOR_ADD:
-        n = *left->val.integer + *right->val.integer; break;
-    case EXP_OPERATOR_SUBTRACT:
-        n = *left->val.integer - *right->val.integer; break;
+static int
+_expCompile_priority( int op )
+{
+    switch ( op ) {
     case EXP_OPERATOR_MULTIPLY:
-        n = *left->val.integer * *right->val.integer; break;
     case EXP_OPERATOR_DIVIDE:
-        n = *left->val.integer / *right->val.integer; break;
-    case EXP_OPERATOR_REMAINDER:
-        n = *left->val.integer % *right->val.integer; break;
-    case EXP_OPERATOR_BITXOR:
-        n = *left->val.integer ^ *right->val.integer; break;
-    case EXP_OPERATOR_BITNEGATE:
-        n = 99; /* *left->val.integer ~ *right->val.integer; */ break;
-    case EXP_OPERATOR_BITOR:
-        n = *left->val.integer | *right->val.integer; break;
-    case EXP_OPERATOR_BITAND:
-        n = *left->val.integer & *right->val.integer; break;
-    case EXP_OPERATOR_NOT:
-        n = 99; /* *left->val.integer ! *right->val.integer; */ break;
+    case EXP_OPERATOR_REMAINDER: return 10;
+    case EXP_OPERATOR_ADD:
+    case EXP_OPERATOR_SUBTRACT:  return 9;
+    case EXP_OPERATOR_LSHIFT:
+    case EXP_OPERATOR_RSHIFT:    return 8;
     case EXP_OPERATOR_LESS:
-        n = *left->val.integer < *right->val.integer; break;
+    case EXP_OPERATOR_LESSEQ:
     case EXP_OPERATOR_GREAT:
-        n = *left->val.integer > *right->val.integer; break;
+    case EXP_OPERATOR_GREATEQ:   return 7;
     case EXP_OPERATOR_EQUAL:
-        n = *left->val.integer == *right->val.integer; break;
-    case EXP_OPERATOR_NOTEQ:
-        n = *left->val.integer != *right->val.integer; break;
-    case EXP_OPERATOR_LESSEQ:
-        n = *left->val.integer <= *right->val.integer; break;
-    case EXP_OPERATOR_GREATEQ:
-        n = *left->val.integer >= *right->val.integer; break;
-    case EXP_OPERATOR_OR:
-        n = *left->val.integer || *right->val.integer; break;
-    case EXP_OPERATOR_AND:
-        n = *left->val.integer && *right->val.integer; break;
-    case EXP_OPERATOR_LSHIFT:
-        n = *left->val.integer << *right->val.integer; break;
-    case EXP_OPERATOR_RSHIFT:
-        n = *left->val.integer >> *right->val.integer; break;
-        break;
-    default:
-        left->next_variable = NULL;
-        snmp_free_var(left);
-        right->next_variable = NULL;
-        snmp_free_var(right);
-
-        snmp_set_var_typed_integer( op, ASN_INTEGER, EXPERRCODE_OPERATOR );
-        op->type = ASN_NULL;
-        return op;
-    }
-
-    /* XXX */
-    left->next_variable = NULL;
-    snmp_free_var(left);
-    op->next_variable = NULL;
-    snmp_free_var(op);
-    snmp_set_var_typed_integer( right, ASN_INTEGER, n );
-    return right;
+    case EXP_OPERATOR_NOTEQ:     return 6;
+    case EXP_OPERATOR_BITAND:    return 5;
+    case EXP_OPERATOR_BITXOR:    return 4;
+    case EXP_OPERATOR_BITOR:     return 3;
+    case EXP_OPERATOR_AND:       return 2;
+    case EXP_OPERATOR_OR:        return 1;
+    }
+    return 0;
 }
 
-netsnmp_variable_list *
-_expValue_evalFunction(netsnmp_variable_list *func) {
-    netsnmp_variable_list *params = func->next_variable;
-    /* XXX */
-    params->next_variable = NULL;
-    snmp_free_var(params);
-    snmp_set_var_typed_integer( func, ASN_INTEGER, 99 );
-    return func;
+    /*
+     * Compile a (sub-)expression, consisting of operands
+     *   separated by operators of priority 'min' or higher.
+     */
+static void
+_expCompile_expr( struct expCompile *c, int min )
+{
+    const char *where;
+    int op, len, prio;
+
+    _expCompile_operand( c );
+    while ( !c->prog->error ) {
+        _expCompile_skip( c );
+        if ( *c->cp == '\0' || *c->cp == ')' )
+            return;
+        where = c->cp;
+        op    = _expCompile_operator( where, &len );
+        if ( !op ) {
+            DEBUGMSGTL(("disman:expr:eval", "Unrecognised operator '%c'\n",
+                                             *where));
+            _expCompile_error( c, EXPERRCODE_OPERATOR, where );
+            return;
+        }
+        prio = _expCompile_priority( op );
+        if ( prio < min )
+            return;
+        c->cp += len;
+        _expCompile_expr( c, prio+1 );   /* left associative */
+        if ( c->prog->error )
+            return;
+        _expCompile_emit( c, EXP_OP_BINARY, op, where );
+    }
 }
 
-netsnmp_variable_list *_expValue_evalExpr2(netsnmp_variable_list *exprAlDente);
-netsnmp_variable_list *
-_expValue_evalExpr(  netsnmp_variable_list *expIdx,
-                     char *exprRaw, char **exprEnd,
-                     oid *suffix, size_t suffix_len )
+static void
+_expValue_freeProgram( struct expProgram *prog )
 {
-    netsnmp_variable_list *exprAlDente = NULL;
-    netsnmp_variable_list *vtail = NULL;
-    char *cp1, *cp2;
-    netsnmp_variable_list *var = NULL;
-    int   i, n;
-    int   neg = 0;
-    oid   oid_buf[MAX_OID_LEN];
-
-    DEBUGMSGTL(("disman:expr:eval1", "Evaluating '%s'\n", exprRaw));
-    if (!expIdx || !exprRaw)
+    int i;
+
+    if ( !prog )
+        return;
+    for ( i = 0; i < prog->nconsts; i++ )
+        snmp_free_var( prog->consts[i] );
+    SNMP_FREE( prog->consts );
+    SNMP_FREE( prog->insns  );
+    SNMP_FREE( prog->params );
+    SNMP_FREE( prog->ppos   );
+    SNMP_FREE( prog );
+}
+
+static struct expProgram *
+_expValue_compile( const char *expr )
+{
+    struct expCompile  c;
+    struct expProgram *prog;
+    int i;
+
+    prog = SNMP_MALLOC_TYPEDEF( struct expProgram );
+    if ( !prog )
         return NULL;
 
     /*
-     * The expression is evaluated in two stages.
-     * First, we simplify ("parboil") the raw expression,
-     *   tokenizing it into a sequence of varbind values, inserting
-     *   object parameters, and (recursively) evaluating any
-     *   parenthesised sub-expressions or function arguments.
+     * Every instruction, constant or parameter
+     *   uses up at least one character of the expression.
      */
+    memset( &c, 0, sizeof(c));
+    c.prog = prog;
+    c.expr = expr;
+    c.cp   = expr;
+    c.max  = strlen( expr )+1;
+    prog->insns  = (struct expInsn *)calloc( c.max, sizeof(struct expInsn));
+    prog->params = (long *)calloc( c.max, sizeof(long));
+    prog->ppos   = (int  *)calloc( c.max, sizeof(int));
+    prog->consts = (netsnmp_variable_list **)
+                       calloc( c.max, sizeof(netsnmp_variable_list *));
+    if ( !prog->insns || !prog->params || !prog->ppos || !prog->consts ) {
+        _expValue_freeProgram( prog );
+        return NULL;
+    }
 
-    for (cp1=exprRaw; cp1 && *cp1; ) {
-        switch (*cp1) {
-        case '$':
-            /*
-             * Locate the appropriate instance of the specified
-             * parameter, and insert the corresponding value.
-             */
-            n   = _expParse_integer( cp1+1, &cp1 );
-            var = _expValue_evalParam( expIdx, n, suffix, suffix_len );
-            if ( var && var->type == ASN_NULL ) {
-                DEBUGMSGTL(("disman:expr:eval", "Invalid parameter '%d'\n", n));
-                /* Note position of failure in expression */
-                var->data = (void *)(cp1 - exprRaw);
-                snmp_free_var(exprAlDente);
-                return var;
-            } else {
-                if (vtail)
-                   vtail->next_variable = var;
-                else
-                   exprAlDente = var;
-                vtail = var;
-                var   = NULL;
-            }
-            break;
-        case '(':
-            /*
-             * Recursively evaluate the sub-expression
-             */
-            var = _expValue_evalExpr( expIdx, cp1+1, &cp2,
-                                      suffix, suffix_len );
-            if ( var && var->type == ASN_NULL ) {
-                /* Adjust position of failure */
-                var->data = (void *)(cp1 - exprRaw + (int)var->data);
-                return var;
-            } else if (*cp2 != ')') {
-                snmp_free_var(exprAlDente);
-                DEBUGMSGTL(("disman:expr:eval", "Unbalanced parenthesis\n"));
-                snmp_set_var_typed_integer( var, ASN_INTEGER,
-                                            EXPERRCODE_PARENTHESIS );
-                var->type = ASN_NULL;
-                var->data = (void *)(cp2 - exprRaw);
-                return var;
-            } else {
-                if (vtail)
-                   vtail->next_variable = var;
-                else
-                   exprAlDente = var;
-                vtail = var;
-                var   = NULL;
-                cp1   = cp2+1;   /* Skip to end of sub-expression */
-            }
-            break;
-        case ')':
-        case ',':
-            /*
-             * End of current (sub-)expression
-             * Note the end-position, and evaluate
-             *  the parboiled list of tokens.
-             */
-            *exprEnd = cp1;
-            var = _expValue_evalExpr2( exprAlDente );
-            snmp_free_var(exprAlDente);
-            return var;
-
-            /* === Constants === */
-        case '.':   /* OID */
-            i = 0;
-            memset( oid_buf, 0, sizeof(oid_buf));
-            while ( cp1 && *cp1 == '.' ) {
-                n = _expParse_integer( cp1+1, &cp2 );
-OID:
-                oid_buf[i++] = n;
-                cp1 = cp2;
-            }
-            var = snmp_varlist_add_variable( &exprAlDente, NULL, 0,
-                                             ASN_OBJECT_ID,
-                                             (u_char*)oid_buf, i*sizeof(oid));
-            break;
-DIGIT:
-        case '0':
-        case '1':
-        case '2':
-        case '3':
-        case '4':
-        case '5':
-        case '6':
-        case '7':
-        case '8':
-        case '9':
-            n = _expParse_integer( cp1, &cp2 );
-            if ( cp2 && *cp2 == '.' ) {
-                i = 0;
-                memset( oid_buf, 0, sizeof(oid_buf));
-                goto OID;
-            }
-            if ( neg )
-                n = -n;
-            var = snmp_varlist_add_variable( &exprAlDente, NULL, 0,
-                                             ASN_INTEGER,
-                                             (u_char*)&n, sizeof(n));
-            vtail = var;
-            var   = NULL;
-            neg   = 0;
-            cp1   = cp2;
-            break;
+    _expCompile_expr( &c, 1 );
+    if ( !prog->error && *c.cp != '\0' ) {
+        /* Only a stray ')' can stop the top-level expression early */
+        DEBUGMSGTL(("disman:expr:eval", "Unbalanced parenthesis\n"));
+        _expCompile_error( &c, EXPERRCODE_PARENTHESIS, c.cp );
+    }
 
-        case '"':   /* String Constant */
-            for ( cp2 = cp1+1; *cp2; cp2++ ) {
-                if ( *cp2 == '"' )
-                    break;
-                if ( *cp2 == '\\' && *(cp2+1) == '"' )
-                    cp2++;
-            }
-            if ( *cp2 != '"' ) {
-                /*
-                 * Unterminated string
-                 */
-                DEBUGMSGTL(("disman:expr:eval", "Unterminated string\n"));
-                snmp_set_var_typed_integer( var, ASN_INTEGER,
-                                            EXPERRCODE_SYNTAX );
-                var->type = ASN_NULL;
-                var->data = (void *)(cp2 - exprRaw);
-                return var;
+    /*
+     * Non-integer constants can only be used on their own
+     */
+    if ( !prog->error && prog->ninsns > 1 ) {
+        for ( i = 0; i < prog->ninsns; i++ ) {
+            if ( prog->insns[i].op == EXP_OP_CONST ) {
+                prog->error  = EXPERRCODE_TYPE;
+                prog->errpos = prog->insns[i].pos;
+                break;
             }
-            n = cp2 - cp1;  
-            var = snmp_varlist_add_variable( &exprAlDente, NULL, 0,
-                                             ASN_OCTET_STR,
-                                             (u_char*)cp1+1, n);
-            vtail = var;
-            var   = NULL;
-            break;
+        }
+    }
 
+    DEBUGIF(("disman:expr:eval")) {
+        DEBUGMSGTL(("disman:expr:eval", "Compiled '%s' (%d insns, %d params)",
+                                         expr, prog->ninsns, prog->nparams));
+        for ( i = 0; i < prog->ninsns; i++ )
+            DEBUGMSG(("disman:expr:eval", " %d/%ld",
+                       prog->insns[i].op, prog->insns[i].arg));
+        DEBUGMSG(("disman:expr:eval", "\n"));
+    }
+    return prog;
+}
 
-            /* === Operators === */
-        case '-':
-            /*
-             * Could be a unary minus....
-             */
-            if (!vtail || vtail->type == ASN_PRIV_OPERATOR) {
-                neg = 1;
-                goto DIGIT;
-            }
-            /* 
-             * ... or a (single-character) binary operator.
-             */
-            /* Fallthrough */
-        case '+':
-        case '*':
-        case '/':
-        case '%':
-        case '^':
-        case '~':
-            if ( !vtail ) {
-                /*
-                 * Can't start an expression with a binary operator
-                 */
-                DEBUGMSGTL(("disman:expr:eval", "Initial binary operator\n"));
-                snmp_set_var_typed_integer( var, ASN_INTEGER,
-                                            EXPERRCODE_SYNTAX );
-                var->type = ASN_NULL;
-                var->data = (void *)(cp1 - exprRaw);
-                return var;
-            }
-            n = ops[ *cp1 & 0xFF ];
-            DEBUGMSGTL(("disman:expr:eval", "Binary operator %c (%d)\n", *cp1, n));
-            var = snmp_varlist_add_variable( &exprAlDente, NULL, 0,
-                                             ASN_INTEGER,
-                                             (u_char*)&n, sizeof(n));
-            var->type = ASN_PRIV_OPERATOR;
-            vtail = var;
-            cp1++;
-            break;
 
-            /* 
-             * Multi-character binary operators
-             */
-        case '&':
-        case '|':
-        case '!':
-        case '>':
-        case '<':
-        case '=':
-            if ( !vtail ) {
-                /*
-                 * Can't start an expression with a binary operator
-                 */
-                DEBUGMSGTL(("disman:expr:eval", "Initial binary operator\n"));
-                snmp_set_var_typed_integer( var, ASN_INTEGER,
-                                            EXPERRCODE_SYNTAX );
-                var->type = ASN_NULL;
-                var->data = (void *)(cp1 - exprRaw);
-                return var;
-            }
-            if ( *(cp1+1) == '=' )
-                n = ops[ *cp1++ + 20];
-            else if ( *(cp1+1) == *cp1 )
-                n = ops[ *cp1++ - 30];
-            else
-                n = ops[ *cp1 & 0xFF ];
-            var = snmp_varlist_add_variable( &exprAlDente, NULL, 0,
-                                             ASN_INTEGER,
-                                             (u_char*)&n, sizeof(n));
-            var->type = ASN_PRIV_OPERATOR;
-            vtail = var;
-            cp1++;
-            break;
+/* =============================
+ *  Evaluating an expression
+ * ============================= */
 
-            /* === Functions === */
-        case 'a':    /* average/arraySection */
-        case 'c':    /* counter32/counter64  */
-        case 'e':    /*    exists            */
-        case 'm':    /* maximum/minimum      */
-        case 'o':    /* oidBegins/Ends/Contains    */
-        case 's':    /* sum / string{B,E,C}  */
-            var = snmp_varlist_add_variable( &exprAlDente, NULL, 0,
-                                             ASN_OCTET_STR,
-                                             (u_char*)cp1, 3 );
-                                                   /* XXX */
-            var->type = ASN_PRIV_FUNCTION;
-            vtail = var;
-            while (*cp1 >= 'a' && *cp1 <= 'z')
-              cp1++;
-            break;
+    /*
+     * Retrieve the numeric value of a sampled varbind
+     */
+static int
+_expValue_number( netsnmp_variable_list *var, long *n )
+{
+    u_int ip;
 
-        default:
-            if (isalpha( *cp1 )) {
-                /*
-                 * Unrecognised function call ?
-                 */
-                DEBUGMSGTL(("disman:expr:eval", "Unrecognised function '%s'\n", cp1));
-                snmp_set_var_typed_integer( var, ASN_INTEGER,
-                                            EXPERRCODE_FUNCTION );
-                var->type = ASN_NULL;
-                var->data = (void *)(cp1 - exprRaw);
-                return var;
-            }
-            else if (!isspace( *cp1 )) {
-                /*
-                 * Unrecognised operator ?
-                 */
-                DEBUGMSGTL(("disman:expr:eval", "Unrecognised operator '%c'\n", *cp1));
-                snmp_set_var_typed_integer( var, ASN_INTEGER,
-                                            EXPERRCODE_OPERATOR );
-                var->type = ASN_NULL;
-                var->data = (void *)(cp1 - exprRaw);
-                return var;
-            }
-            cp1++;
+    switch ( var->type ) {
+    case ASN_INTEGER:
+    case ASN_COUNTER:
+    case ASN_GAUGE:
+    case ASN_TIMETICKS:
+    case ASN_UINTEGER:
+        *n = *var->val.integer;
+        return 1;
+    case ASN_COUNTER64:
+#if SIZEOF_LONG > 4
+        *n = (long)((var->val.counter64->high << 32) |
+                     var->val.counter64->low);
+#else
+        *n = (long)var->val.counter64->low;
+#endif
+        return 1;
+    case ASN_IPADDRESS:
+        if ( var->val_len != 4 )
+            return 0;
+        memcpy( &ip, var->val.string, 4 );
+        *n = ip;
+        return 1;
+    }
+    return 0;
+}
+
+static int
+_expValue_missing( netsnmp_variable_list *var )
+{
+    switch ( var->type ) {
+    case 0:
+    case ASN_NULL:
+    case SNMP_NOSUCHOBJECT:
+    case SNMP_NOSUCHINSTANCE:
+    case SNMP_ENDOFMIBVIEW:
+        return 1;
+    }
+    return 0;
+}
+
+    /*
+     * Move a cursor along a list of sampled values (in the same order
+     *   as the instances of the expression), to the entry for the
+     *   specified instance, returning NULL if there isn't one.
+     */
+static netsnmp_variable_list *
+_expValue_seek( netsnmp_variable_list **cursor, size_t root_len,
+                oid *suffix, size_t suffix_len )
+{
+    netsnmp_variable_list *vp;
+    int res = 1;
+
+    for ( vp = *cursor; vp; vp = vp->next_variable ) {
+        if ( vp->name_length < root_len )
+            continue;
+        res = snmp_oid_compare( vp->name        + root_len,
+                                vp->name_length - root_len,
+                                suffix, suffix_len );
+        if ( res >= 0 )
             break;
-        }
     }
+    *cursor = vp;
+    return ( vp && res == 0 ) ? vp : NULL;
+}
 
     /*
-     * ... then we evaluate the resulting simplified ("al dente")
-     *   expression, in the usual manner.
+     * Determine the value of a parameter object
+     *   for the specified instance.
      */
-    *exprEnd = cp1;
-    var = _expValue_evalExpr2( exprAlDente );
-    DEBUGMSGTL(( "disman:expr:eval1", "Evaluated to "));
-    DEBUGMSGVAR(("disman:expr:eval1", var));
-    DEBUGMSG((   "disman:expr:eval1", "\n"));
-/*  snmp_free_var(exprAlDente); XXX - Crashes */
-    return var;
+static int
+_expValue_evalParam( struct expCursor *c, struct expOperand *op,
+                     oid *suffix, size_t suffix_len )
+{
+    struct expObject      *obj = c->obj;
+    netsnmp_variable_list *val_var,  *oval_var = NULL;  /* values  */
+    netsnmp_variable_list *dd_var,   *odd_var;          /* deltaDs */
+    netsnmp_variable_list *cond_var;               /* conditionals */
+    long n, o;
+
+    if ( !obj )
+        return EXPERRCODE_INDEX;     /* No such parameter */
+    if ( obj->expObjectSampleType != EXPSAMPLETYPE_ABSOLUTE &&
+         obj->old_vars == NULL )
+        return EXPERRCODE_RESOURCE;  /* No delta until the second pass */
+
+    if ( obj->flags & EXP_OBJ_FLAG_OWILD ) {
+        /*
+         * An exact expression with a wildcarded object is invalid.
+         */
+        if ( !suffix )
+            return EXPERRCODE_INDEX;
+        val_var  = _expValue_seek( &c->val, obj->expObjectID_len,
+                                   suffix, suffix_len );
+        if ( obj->expObjectSampleType != EXPSAMPLETYPE_ABSOLUTE )
+            oval_var = _expValue_seek( &c->oval, obj->expObjectID_len,
+                                       suffix, suffix_len );
+    } else {
+        val_var  = obj->vars;
+        oval_var = obj->old_vars;
+    }
+    if (( obj->flags & EXP_OBJ_FLAG_DWILD ) && suffix ) {
+        dd_var   = _expValue_seek( &c->dd,  obj->expObjDeltaD_len,
+                                   suffix, suffix_len );
+        odd_var  = _expValue_seek( &c->odd, obj->expObjDeltaD_len,
+                                   suffix, suffix_len );
+    } else {
+        dd_var   = obj->dvars;
+        odd_var  = obj->old_dvars;
+    }
+    if (( obj->flags & EXP_OBJ_FLAG_CWILD ) && suffix )
+        cond_var = _expValue_seek( &c->cond, obj->expObjCond_len,
+                                   suffix, suffix_len );
+    else
+        cond_var = obj->cvars;
+
+    if ( !val_var || _expValue_missing( val_var ))
+        return EXPERRCODE_INDEX;     /* No matching entry */
+    if ( obj->expObjCond_len &&
+        (!cond_var || !_expValue_number( cond_var, &n ) || n == 0 ))
+        return EXPERRCODE_INDEX;     /* expObjectConditional says no */
+    if ( dd_var && odd_var &&
+         _expValue_number( dd_var,  &n ) &&
+         _expValue_number( odd_var, &o ) && n != o )
+        return EXPERRCODE_INDEX;     /* expObjectDeltaD says no */
+
+    switch ( obj->expObjectSampleType ) {
+    case EXPSAMPLETYPE_DELTA:
+        if ( !oval_var || _expValue_missing( oval_var ))
+            return EXPERRCODE_INDEX;
+        if ( !_expValue_number( val_var,  &n ) ||
+             !_expValue_number( oval_var, &o ))
+            return EXPERRCODE_TYPE;
+        op->var     = NULL;
+        op->n       = ( val_var->type == ASN_COUNTER ) ?
+                          (long)(u_int)( n - o ) : n - o;
+        op->numeric = 1;
+        break;
+    case EXPSAMPLETYPE_CHANGED:
+        if ( !oval_var || _expValue_missing( oval_var ))
+            return EXPERRCODE_INDEX;
+        op->var     = NULL;
+        op->n       = ( val_var->type    != oval_var->type    ||
+                        val_var->val_len != oval_var->val_len ||
+                        memcmp( val_var->val.string, oval_var->val.string,
+                                val_var->val_len ) != 0 );
+        op->numeric = 1;
+        break;
+    default:
+        op->var     = val_var;
+        op->numeric = _expValue_number( val_var, &op->n );
+        break;
+    }
+    return 0;
 }
 
-netsnmp_variable_list *
-_expValue_evalExpr2( netsnmp_variable_list *exprAlD )
+    /*
+     * Run a compiled expression, using the parameter values
+     *   already retrieved for a particular instance.
+     */
+static int
+_expValue_run( struct expProgram *prog, struct expOperand *params,
+               long *stack, long *result, int *pos )
 {
-    netsnmp_variable_list *stack = NULL;
-    netsnmp_variable_list *lval, *rval, *op;
-    netsnmp_variable_list *vp, *vp1  = NULL;
-
-    DEBUGIF(( "disman:expr:eval2")) {
-        for (vp = exprAlD; vp; vp=vp->next_variable) {
-            if ( vp->type == ASN_PRIV_OPERATOR )
-                DEBUGMSGTL(( "disman:expr:eval2", "Operator %ld\n",
-                                                  *vp->val.integer));
-            else if ( vp->type == ASN_PRIV_FUNCTION )
-                DEBUGMSGTL(( "disman:expr:eval2", "Function %s\n",
-                                                   vp->val.string));
-            else {
-                DEBUGMSGTL(( "disman:expr:eval2", "Operand "));
-                DEBUGMSGVAR(("disman:expr:eval2", vp));
-                DEBUGMSG((   "disman:expr:eval2", "\n"));
+    struct expInsn *insn;
+    long l, r;
+    int  sp = 0;
+    int  i;
+
+    for ( i = 0; i < prog->ninsns; i++ ) {
+        insn = &prog->insns[i];
+        switch ( insn->op ) {
+        case EXP_OP_INTEGER:
+            stack[ sp++ ] = insn->arg;
+            continue;
+        case EXP_OP_PARAM:
+            if ( !params[ insn->arg ].numeric ) {
+                *pos = insn->pos;
+                return EXPERRCODE_TYPE;
             }
+            stack[ sp++ ] = params[ insn->arg ].n;
+            continue;
+        case EXP_OP_NEGATE:
+            stack[ sp-1 ] = (long)( 0 - (u_long)stack[ sp-1 ] );
+            continue;
+        case EXP_OP_NOT:
+            stack[ sp-1 ] = !stack[ sp-1 ];
+            continue;
+        case EXP_OP_BITNEG:
+            stack[ sp-1 ] = ~stack[ sp-1 ];
+            continue;
+        case EXP_OP_BINARY:
+            break;
+        default:
+            *pos = insn->pos;
+            return EXPERRCODE_TYPE;
         }
-    }
-    
-    for (vp = exprAlD; vp; vp=vp1) {
-        vp1 = vp->next_variable;
-        if ( vp->type == ASN_PRIV_OPERATOR ) {
-            /* Must *always* follow a value */
-            if ( !stack || stack->type == ASN_PRIV_OPERATOR ) {
-                snmp_set_var_typed_integer( vp, ASN_INTEGER,
-                                            EXPERRCODE_SYNTAX );
-                vp->type = ASN_NULL;
-                snmp_free_var( stack );
-                return vp;
-            }
-            /*
-             * Evaluate any higher priority operators
-             *  already on the stack....
-             */
-            while ( stack->next_variable &&
-                    stack->next_variable->type == ASN_PRIV_OPERATOR &&
-                  (*stack->next_variable->val.integer > *vp->val.integer)) {
-                 rval = stack;
-                 op   = stack->next_variable;
-                 lval = op->next_variable;
-                 stack = lval->next_variable;
-
-                 rval = _expValue_evalOperator( lval, op, rval );
-                 rval->next_variable = stack;
-                 stack = rval;
-            }
-            /*
-             * ... and then push this operator onto the stack.
-             */
-            vp->next_variable = stack;
-            stack = vp;
-        } else if ( vp->type == ASN_PRIV_FUNCTION ) {
-            /* Must be first, or follow an operator */
-            if ( stack && stack->type != ASN_PRIV_OPERATOR ) {
-                snmp_set_var_typed_integer( vp, ASN_INTEGER,
-                                            EXPERRCODE_SYNTAX );
-                vp->type = ASN_NULL;
-                snmp_free_var( stack );
-                return vp;
-            }
-            /*
-             * Evaluate this function (consuming the
-             *   appropriate parameters from the token 
-             *   list), and push the result onto the stack.
-             */
-            vp = _expValue_evalFunction( vp );
-            vp1 = vp->next_variable;
-            vp->next_variable = stack;
-            stack = vp;
-        } else {
-            /* Must be first, or follow an operator */
-            if ( stack && stack->type != ASN_PRIV_OPERATOR ) {
-                snmp_set_var_typed_integer( vp, ASN_INTEGER,
-                                            EXPERRCODE_SYNTAX );
-                vp->type = ASN_NULL;
-                snmp_free_var( stack );
-                return vp;
+
+        r = stack[ --sp ];
+        l = stack[ sp-1 ];
+        switch ( insn->arg ) {
+        case EXP_OPERATOR_ADD:
+            l = (long)( (u_long)l + (u_long)r );  break;
+        case EXP_OPERATOR_SUBTRACT:
+            l = (long)( (u_long)l - (u_long)r );  break;
+        case EXP_OPERATOR_MULTIPLY:
+            l = (long)( (u_long)l * (u_long)r );  break;
+        case EXP_OPERATOR_DIVIDE:
+        case EXP_OPERATOR_REMAINDER:
+            if ( r == 0 ) {
+                *pos = insn->pos;
+                return EXPERRCODE_DIVZERO;
             }
-            /*
-             * Push this value onto the stack
-             */
-            vp->next_variable = stack;
-            stack = vp;
+            if ( r == -1 )   /* avoid overflow trapping */
+                l = ( insn->arg == EXP_OPERATOR_DIVIDE ) ?
+                        (long)( 0 - (u_long)l ) : 0;
+            else
+                l = ( insn->arg == EXP_OPERATOR_DIVIDE ) ? l / r : l % r;
+            break;
+        case EXP_OPERATOR_BITXOR:  l = l ^ r;   break;
+        case EXP_OPERATOR_BITOR:   l = l | r;   break;
+        case EXP_OPERATOR_BITAND:  l = l & r;   break;
+        case EXP_OPERATOR_OR:      l = l || r;  break;
+        case EXP_OPERATOR_AND:     l = l && r;  break;
+        case EXP_OPERATOR_EQUAL:   l = l == r;  break;
+        case EXP_OPERATOR_NOTEQ:   l = l != r;  break;
+        case EXP_OPERATOR_LESS:    l = l <  r;  break;
+        case EXP_OPERATOR_LESSEQ:  l = l <= r;  break;
+        case EXP_OPERATOR_GREAT:   l = l >  r;  break;
+        case EXP_OPERATOR_GREATEQ: l = l >= r;  break;
+        case EXP_OPERATOR_LSHIFT:
+            l = ( r < 0 || r >= (long)(8*sizeof(long))) ? 0 :
+                    (long)( (u_long)l << r );
+            break;
+        case EXP_OPERATOR_RSHIFT:
+            l = ( r < 0 || r >= (long)(8*sizeof(long))) ? ( l < 0 ? -1 : 0 ) :
+                    l >> r;
+            break;
+        default:
+            *pos = insn->pos;
+            return EXPERRCODE_OPERATOR;
         }
+        stack[ sp-1 ] = l;
     }
+    *result = stack[0];
+    return 0;
+}
 
     /*
-     * Now evaluate whatever's left on the stack
-     *   and return the final result.
+     * Convert the result of an expression to the requested type
      */
-    while ( stack && stack->next_variable ) {
-        rval = stack;
-        op   = stack->next_variable;
-        lval = op->next_variable;
-        stack = lval->next_variable;
+static int
+_expValue_setResult( struct expExpression *exp, netsnmp_variable_list *var,
+                     struct expOperand *op )
+{
+    struct counter64 c64;
 
-        rval = _expValue_evalOperator( lval, op, rval );
-        rval->next_variable = stack;
-        stack = rval;
+    switch ( exp->expValueType ) {
+    case EXPVALTYPE_STRING:
+        if ( !op->var || op->var->type != ASN_OCTET_STR )
+            return EXPERRCODE_TYPE;
+        snmp_set_var_typed_value( var, ASN_OCTET_STR,
+                                  op->var->val.string, op->var->val_len );
+        break;
+    case EXPVALTYPE_OID:
+        if ( !op->var || op->var->type != ASN_OBJECT_ID )
+            return EXPERRCODE_TYPE;
+        snmp_set_var_typed_value( var, ASN_OBJECT_ID,
+                        (u_char *)op->var->val.objid, op->var->val_len );
+        break;
+    case EXPVALTYPE_COUNTER64:
+        if ( !op->numeric )
+            return EXPERRCODE_TYPE;
+#if SIZEOF_LONG > 4
+        c64.high = ((u_long)op->n >> 32) & 0xffffffff;
+#else
+        c64.high = 0;
+#endif
+        c64.low  = (u_long)op->n & 0xffffffff;
+        snmp_set_var_typed_value( var, ASN_COUNTER64,
+                                  (u_char *)&c64, sizeof(c64));
+        break;
+    default:
+        if ( !op->numeric )
+            return EXPERRCODE_TYPE;
+        snmp_set_var_typed_integer( var, ASN_INTEGER, op->n );
+        break;
     }
-    return stack;
+    return 0;
 }
 
-/* =============
- *  Main API 
- * ============= */
-netsnmp_variable_list *
-expValue_evaluateExpression( struct expExpression *exp,
-                             oid *suffix, size_t suffix_len )
+static netsnmp_variable_list *
+_expValue_evalInstance( struct expExpression *exp, struct expCursor *cursors,
+                        struct expOperand *params, long *stack,
+                        oid *suffix, size_t suffix_len )
 {
-    char exprRaw[     EXP_STR3_LEN+1 ];
+    struct expProgram     *prog = exp->program;
+    struct expOperand      result, *op;
     netsnmp_variable_list *var;
-    netsnmp_variable_list owner_var, name_var, param_var;
-    long n;
-    char *cp;
+    int i, rc, pos = 0;
 
-    if (!exp)
+    for ( i = 0; i < prog->nparams; i++ ) {
+        rc = _expValue_evalParam( &cursors[i], &params[i],
+                                  suffix, suffix_len );
+        if ( rc ) {
+            _expValue_setError( exp, rc, suffix, suffix_len, prog->ppos[i] );
+            return NULL;
+        }
+    }
+
+    if ( prog->ninsns == 1 && prog->insns[0].op == EXP_OP_PARAM )
+        op = &params[ prog->insns[0].arg ];
+    else if ( prog->ninsns == 1 && prog->insns[0].op == EXP_OP_CONST ) {
+        op = &result;
+        op->var     = prog->consts[ prog->insns[0].arg ];
+        op->numeric = _expValue_number( op->var, &op->n );
+    } else {
+        op = &result;
+        op->var     = NULL;
+        op->numeric = 1;
+        rc = _expValue_run( prog, params, stack, &op->n, &pos );
+        if ( rc ) {
+            _expValue_setError( exp, rc, suffix, suffix_len, pos );
+            return NULL;
+        }
+    }
+
+    var = SNMP_MALLOC_TYPEDEF( netsnmp_variable_list );
+    if ( !var ) {
+        _expValue_setError( exp, EXPERRCODE_RESOURCE, suffix, suffix_len, 0 );
+        return NULL;
+    }
+    snmp_set_var_objid( var, suffix, suffix_len );
+    rc = _expValue_setResult( exp, var, op );
+    if ( rc ) {
+        snmp_free_var( var );
+        _expValue_setError( exp, rc, suffix, suffix_len, 0 );
         return NULL;
+    }
+    return var;
+}
+
+static int
+_expValue_compare( const void *a, const void *b )
+{
+    const netsnmp_variable_list *v1 = *(netsnmp_variable_list * const *)a;
+    const netsnmp_variable_list *v2 = *(netsnmp_variable_list * const *)b;
+
+    return snmp_oid_compare( v1->name, v1->name_length,
+                             v2->name, v2->name_length );
+}
 
     /*
-     * Set up a varbind list containing the various index values
-     *   (including a placeholder for expObjectIndex).
+     * Evaluate all instances of an expression in one pass,
+     *   walking the samples for each parameter in parallel.
      *
-     * This saves having to construct the same index list repeatedly
+     * This relies on the various varbind lists being in the same
+     *   order as the expExpressionPrefix instances (which is how
+     *   expObject_getData sets them up).
+     */
+static void
+_expValue_evaluateAll( struct expExpression *exp )
+{
+    struct expProgram     *prog;
+    struct expResults     *res;
+    struct expCursor      *cursors;
+    struct expOperand     *params;
+    struct expObject      *obj;
+    netsnmp_variable_list  owner_var, name_var, param_var;
+    netsnmp_variable_list *vp, *var, *tail = NULL;
+    long  *stack;
+    size_t plen = exp->expPrefix_len;
+    int    i, sorted = 1;
+
+    if ( !exp->program )
+        expValue_compile( exp );
+    prog = exp->program;
+    if ( !prog )
+        return;
+
+    res = SNMP_MALLOC_TYPEDEF( struct expResults );
+    if ( !res )
+        return;
+    exp->results = res;
+    if ( prog->error ) {
+        _expValue_setError( exp, prog->error, NULL, 0, prog->errpos );
+        return;
+    }
+
+    cursors = (struct expCursor  *)calloc( prog->nparams+1,
+                                           sizeof(struct expCursor));
+    params  = (struct expOperand *)calloc( prog->nparams+1,
+                                           sizeof(struct expOperand));
+    stack   = (long *)calloc( prog->depth+1, sizeof(long));
+    if ( !cursors || !params || !stack ) {
+        _expValue_setError( exp, EXPERRCODE_RESOURCE, NULL, 0, 0 );
+        goto done;
+    }
+
+    /*
+     * Look up the expObject entries for the various
+     *   parameters, once for the whole set of instances.
      */
     memset(&owner_var, 0, sizeof(netsnmp_variable_list));
     memset(&name_var,  0, sizeof(netsnmp_variable_list));
@@ -741,68 +921,212 @@ expValue_evaluateExpression( struct expExpression *exp,
                   (u_char*)exp->expOwner, strlen(exp->expOwner));
     snmp_set_var_typed_value( &name_var,  ASN_OCTET_STR,
                   (u_char*)exp->expName,  strlen(exp->expName));
-    n = 99; /* dummy value */
-    snmp_set_var_typed_value( &param_var, ASN_INTEGER,
-                             (u_char*)&n, sizeof(long));
+    snmp_set_var_typed_integer( &param_var, ASN_INTEGER, 0 );
     owner_var.next_variable = &name_var;
     name_var.next_variable  = &param_var;
 
+    for ( i = 0; i < prog->nparams; i++ ) {
+        *param_var.val.integer = prog->params[i];
+        obj = (struct expObject *)
+                  netsnmp_tdata_row_entry(
+                      netsnmp_tdata_row_get_byidx( expObject_table_data,
+                                                   &owner_var ));
+        cursors[i].obj = obj;
+        if ( obj ) {
+            cursors[i].val  = obj->vars;
+            cursors[i].oval = obj->old_vars;
+            cursors[i].dd   = obj->dvars;
+            cursors[i].odd  = obj->old_dvars;
+            cursors[i].cond = obj->cvars;
+        }
+    }
+
+    if ( !plen ) {
+        res->list = _expValue_evalInstance( exp, cursors, params, stack,
+                                            NULL, 0 );
+        res->count = res->list ? 1 : 0;
+    } else {
+        for ( vp = exp->pvars; vp; vp = vp->next_variable ) {
+            /*
+             * Skip anything that isn't an instance of the prefix object
+             *  (including an empty walk, which leaves the list untouched)
+             */
+            if ( vp->name_length <= plen || _expValue_missing( vp ) ||
+                 memcmp( vp->name, exp->expPrefix, plen*sizeof(oid)) != 0 )
+                continue;
+            var = _expValue_evalInstance( exp, cursors, params, stack,
+                                          vp->name        + plen,
+                                          vp->name_length - plen );
+            if ( !var )
+                continue;
+            if ( tail ) {
+                if ( _expValue_compare( &tail, &var ) >= 0 )
+                    sorted = 0;
+                tail->next_variable = var;
+            } else
+                res->list = var;
+            tail = var;
+            res->count++;
+        }
+    }
+
     /*
-     * Make a working copy of the expression, and evaluate it.
+     * Index the results, for looking up individual instances
      */
-    memset(exprRaw, 0,                  sizeof(exprRaw));
-    memcpy(exprRaw, exp->expExpression, sizeof(exprRaw));
+    if ( res->count ) {
+        res->vars = (netsnmp_variable_list **)
+                        calloc( res->count, sizeof(netsnmp_variable_list *));
+        if ( !res->vars ) {
+            snmp_free_varbind( res->list );
+            res->list  = NULL;
+            res->count = 0;
+            _expValue_setError( exp, EXPERRCODE_RESOURCE, NULL, 0, 0 );
+            goto done;
+        }
+        for ( i = 0, vp = res->list; vp; vp = vp->next_variable )
+            res->vars[ i++ ] = vp;
+        if ( !sorted )
+            qsort( res->vars, res->count, sizeof(netsnmp_variable_list *),
+                   _expValue_compare );
+    }
+    DEBUGMSGTL(("disman:expr:eval", "Evaluated (%s, %s): %d instances\n",
+                 exp->expOwner, exp->expName, res->count));
+
+done:
+    exp->count = res->count;
+    free( cursors );
+    free( params  );
+    free( stack   );
+}
 
-    var = _expValue_evalExpr( &owner_var, exprRaw, &cp, suffix, suffix_len );
     /*
-     * Check for any problems, and record the appropriate error
+     * Locate the first result for an instance no less than 'suffix'
      */
-    if (!cp || *cp != '\0') {
-        /*
-         * When we had finished, there was a lot
-         * of bricks^Wcharacters left over....
-         */
-        _expValue_setError( exp, EXPERRCODE_SYNTAX, suffix, suffix_len, NULL );
-        return NULL;
+static int
+_expValue_search( struct expResults *res, oid *suffix, size_t suffix_len,
+                  int *exact )
+{
+    int lo = 0, hi = res->count, mid, cmp;
+
+    *exact = 0;
+    while ( lo < hi ) {
+        mid = (lo + hi) / 2;
+        cmp = snmp_oid_compare( res->vars[mid]->name,
+                                res->vars[mid]->name_length,
+                                suffix, suffix_len );
+        if ( cmp < 0 )
+            lo = mid+1;
+        else {
+            if ( cmp == 0 )
+                *exact = 1;
+            hi = mid;
+        }
     }
-    if (!var) {
-        /* Shouldn't happen */
-        _expValue_setError( exp, EXPERRCODE_RESOURCE, suffix, suffix_len, NULL );
+    return lo;
+}
+
+/* =============
+ *  Main API
+ * ============= */
+
+    /*
+     * (Re-)compile an expression, discarding any previous results
+     */
+void
+expValue_compile( struct expExpression *exp )
+{
+    if (!exp)
+        return;
+    expValue_release( exp );
+    exp->program = _expValue_compile( exp->expExpression );
+}
+
+    /*
+     * Discard the results of evaluating an expression
+     *   (typically because new samples have been taken)
+     */
+void
+expValue_invalidate( struct expExpression *exp )
+{
+    if (!exp || !exp->results)
+        return;
+    snmp_free_varbind( exp->results->list );
+    SNMP_FREE( exp->results->vars );
+    SNMP_FREE( exp->results );
+}
+
+void
+expValue_release( struct expExpression *exp )
+{
+    if (!exp)
+        return;
+    expValue_invalidate( exp );
+    _expValue_freeProgram( exp->program );
+    exp->program = NULL;
+}
+
+    /*
+     * Return the value of the given instance of an expression.
+     *   The result remains valid until the next set of samples
+     *   is retrieved, and should not be released by the caller.
+     */
+netsnmp_variable_list *
+expValue_evaluateExpression( struct expExpression *exp,
+                             oid *suffix, size_t suffix_len )
+{
+    int i, exact;
+
+    if (!exp)
         return NULL;
-    }
-    if (var->type == ASN_NULL) {
-        /*
-         * Error explicitly reported from the evaluation routines.
-         */
-        _expValue_setError( exp, *(var->val.integer), suffix, suffix_len, var );
+    if (!exp->results)
+        _expValue_evaluateAll( exp );
+    if (!exp->results)
         return NULL;
-    }
-    if (0 /* COMPARE var->type WITH exp->expValueType */ ) {
-        /*
-         * XXX - Check to see whether the returned type (ASN_XXX)
-         *       is compatible with the requested type (an enum)
-         */
 
-        /* If not, throw an error */
-        _expValue_setError( exp, EXPERRCODE_TYPE, suffix, suffix_len, var );
+    i = _expValue_search( exp->results, suffix, suffix_len, &exact );
+    return exact ? exp->results->vars[i] : NULL;
+}
+
+    /*
+     * Return the value of the first instance of an expression
+     *   following 'suffix' (with the instance as the varbind name),
+     *   or NULL if there are no more instances.
+     */
+netsnmp_variable_list *
+expValue_nextInstance( struct expExpression *exp,
+                       oid *suffix, size_t suffix_len )
+{
+    int i, exact;
+
+    if (!exp)
         return NULL;
-    }
-    return var;
+    if (!exp->results)
+        _expValue_evaluateAll( exp );
+    if (!exp->results)
+        return NULL;
+
+    i = _expValue_search( exp->results, suffix, suffix_len, &exact );
+    if ( exact )
+        i++;
+    return ( i < exp->results->count ) ? exp->results->vars[i] : NULL;
 }
 
 void
 _expValue_setError( struct expExpression *exp, int reason,
-                    oid *suffix, size_t suffix_len,
-                    netsnmp_variable_list *var)
+                    oid *suffix, size_t suffix_len, int pos )
 {
     if (!exp)
         return;
     exp->expErrorCount++;
  /* exp->expErrorTime  = NOW; */
-    exp->expErrorIndex = ( var && var->data ? (int)var->data : 0 );
+    exp->expErrorIndex = pos;
     exp->expErrorCode  = reason;
     memset( exp->expErrorInstance, 0, sizeof(exp->expErrorInstance));
-    memcpy( exp->expErrorInstance, suffix, suffix_len * sizeof(oid));
+    if ( suffix_len > MAX_OID_LEN )
+        suffix_len = MAX_OID_LEN;
+    if ( suffix )
+        memcpy( exp->expErrorInstance, suffix, suffix_len * sizeof(oid));
+    else
+        suffix_len = 0;
     exp->expErrorInst_len = suffix_len;
-    snmp_free_var( var );
 }
@@ -5,8 +5,14 @@
 #include "disman/expr/expExpression.h"
 
 void              init_expValue(void);
+void              expValue_compile(   struct expExpression *exp );
+void              expValue_invalidate(struct expExpression *exp );
+void              expValue_release(   struct expExpression *exp );
 netsnmp_variable_list *
 expValue_evaluateExpression( struct expExpression *exp,
                              oid *suffix, size_t suffix_len );
+netsnmp_variable_list *
+expValue_nextInstance(       struct expExpression *exp,
+                             oid *suffix, size_t suffix_len );
 
 #endif                          /* EXPVALUE_H */
@@ -49,8 +49,9 @@ expValueTable_getEntry(netsnmp_variable_list * indexes,
                        int mode, unsigned int colnum)
 {
     struct expExpression  *exp;
-    netsnmp_variable_list *res, *vp, *vp2;
+    netsnmp_variable_list *res, *vp;
     oid nullInstance[] = {0, 0, 0};
+    oid instance[ MAX_OID_LEN ];
     int  plen;
     size_t len;
     unsigned int type = colnum-1; /* column object subIDs and type
@@ -101,6 +102,9 @@ expValueTable_getEntry(netsnmp_variable_list * indexes,
         }
 NEXT_EXP:
         exp = expExpression_getNextEntry( exp->expOwner, exp->expName );
+        /* ... starting from the first instance of this one */
+        snmp_set_var_typed_value( indexes->next_variable->next_variable,
+                                  ASN_PRIV_IMPLIED_OBJECT_ID, NULL, 0 );
         DEBUGMSGTL(( "disman:expr:val", "using next entry (%p)\n", exp ));
     }
     if (!exp) {
@@ -159,7 +163,7 @@ NEXT_EXP:
         if ( vp->val_len > 0 && vp->val.objid[0] != 0 ) {
             DEBUGMSGTL(( "disman:expr:val",
                          "non-zero next instance (%" NETSNMP_PRIo "d)\n", vp->val.objid[0]));
-            return NULL;        /* All valid instances start with .0 */
+            goto NEXT_EXP;      /* All valid instances start with .0 */
         }
         plen = exp->expPrefix_len;
         if (plen == 0 ) {
@@ -172,7 +176,7 @@ NEXT_EXP:
                 (vp->val_len == 2*sizeof(oid) &&
                       vp->val.objid[1] != 0)) {
                 DEBUGMSGTL(( "disman:expr:val", "invalid scalar next instance\n"));
-                return NULL;        /* Invalid instance */
+                goto NEXT_EXP;      /* Too late - try the next expression */
             }
      
             /*
@@ -188,51 +192,43 @@ NEXT_EXP:
                        (u_char*)nullInstance, 3*sizeof(oid));
             res = expValue_evaluateExpression( exp, NULL, 0 );
             DEBUGMSGTL(( "disman:expr:val", "scalar next returned (%p)\n", res));
+            if ( !res )
+                goto NEXT_EXP;
         } else {
             /*
              * Now comes the interesting case - finding the
              *   appropriate instance of a wildcarded expression.
              */
             if ( vp->val_len == 0 ) {
-                 if ( !exp->pvars ) {
-                     DEBUGMSGTL(( "disman:expr:val", "no instances\n"));
-                     goto NEXT_EXP;
-                 }
                  DEBUGMSGTL(( "disman:expr:val", "using first instance\n"));
-                 vp2 = exp->pvars;
+                 res = expValue_nextInstance( exp, NULL, 0 );
             } else {
                  /*
-                  * Search the list of instances for the (first) greater one
-                  *   XXX - This comparison relies on the OID of the prefix
-                  *         object being the same length as the wildcarded
-                  *         parameter objects.  It ain't necessarily so.
+                  * Skip the leading '.0', and find the
+                  *   first instance following the rest.
                   */
-                 for ( vp2 = exp->pvars; vp2; vp2 = vp2->next_variable ) {
-                     if ( snmp_oid_compare( vp2->name        + plen,
-                                            vp2->name_length - plen,
-                                            vp->name,
-                                            vp->name_length) < 0 ) {
-                         DEBUGMSGTL(( "disman:expr:val", "next instance "));
-                         DEBUGMSGOID(("disman:expr:val",  vp2->name, vp2->name_length ));
-                         DEBUGMSG((   "disman:expr:val", "\n"));
-                         break;
-                     }
-                 }
-                 if (!vp2) {
-                     DEBUGMSGTL(( "disman:expr:val", "no next instance\n"));
-                     goto NEXT_EXP;
-                 }
+                 res = expValue_nextInstance( exp, vp->val.objid+1,
+                                              vp->val_len/sizeof(oid)-1 );
             }
+            if ( !res ) {
+                 DEBUGMSGTL(( "disman:expr:val", "no next instance\n"));
+                 goto NEXT_EXP;
+            }
+            DEBUGMSGTL(( "disman:expr:val", "next instance "));
+            DEBUGMSGOID(("disman:expr:val",  res->name, res->name_length ));
+            DEBUGMSG((   "disman:expr:val", "\n"));
+
             snmp_set_var_typed_value( indexes, ASN_OCTET_STR,
                        (u_char*)exp->expOwner, strlen(exp->expOwner));
             snmp_set_var_typed_value( indexes->next_variable, ASN_OCTET_STR,
                        (u_char*)exp->expName,  strlen(exp->expName));
-            if (vp2) {
-                len = vp2->name_length - exp->expPrefix_len;
-                snmp_set_var_typed_value( vp, ASN_PRIV_IMPLIED_OBJECT_ID,
-                      (u_char*)(vp2->name+exp->expPrefix_len), len);
-            }
-            res = expValue_evaluateExpression( exp, vp->val.objid+1, len-1);
+            len = res->name_length;
+            if ( len > MAX_OID_LEN-1 )
+                len = MAX_OID_LEN-1;
+            instance[0] = 0;
+            memcpy( instance+1, res->name, len*sizeof(oid));
+            snmp_set_var_typed_value( vp, ASN_PRIV_IMPLIED_OBJECT_ID,
+                       (u_char*)instance, (len+1)*sizeof(oid));
             DEBUGMSGTL(( "disman:expr:val", "w/card next returned (%p)\n", res));
         }
     }
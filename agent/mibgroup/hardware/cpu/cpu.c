@@ -4,6 +4,8 @@
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 #include <net-snmp/agent/hardware/cpu.h>
 
+#include "util_funcs/sampler.h"
+
 netsnmp_feature_child_of(hardware_cpu, libnetsnmpmibs)
 
 netsnmp_feature_child_of(hardware_cpu_copy_stats, hardware_cpu)
@@ -12,10 +14,11 @@ netsnmp_feature_child_of(hardware_cpu_get_cache, hardware_cpu)
 netsnmp_feature_child_of(hardware_cpu_get_byName, hardware_cpu)
 
 extern NetsnmpCacheLoad netsnmp_cpu_arch_load;
-static void _cpu_update_stats( unsigned int, void* );
+static void _cpu_update_stats( const struct timeval *, void* );
 
-static int _cpuAutoUpdate =  5;
+static int _cpuAutoUpdate =  1;     /* sampled with util_funcs/sampler */
 static int _cpuHistoryLen;
+static int _cpuHistoryPos;
 int  cpu_num = 0;
 
 static netsnmp_cpu_info *_cpu_head  = NULL;
@@ -28,22 +31,14 @@ void init_cpu( void ) {
      * If we're sampling the CPU statistics automatically,
      *   then arrange for this to be triggered regularly,
      *   keeping sufficient samples to cover the last minute.
-     * If the system-specific code has already initialised
-     *   the list of CPU entries, then retrieve the first set
-     *   of stats immediately.
-     * Otherwise, wait until the regular sampling kicks in.
+     *   (The first sample is taken once the config has been read)
      *
      * If we're not sampling these statistics regularly,
      *   create a suitable cache handler instead.
      */
-    if ( _cpuAutoUpdate ) {
-         
-        _cpuHistoryLen = 60/_cpuAutoUpdate;
-        snmp_alarm_register( _cpuAutoUpdate, SA_REPEAT, _cpu_update_stats,
-                             NULL );
-        if ( _cpu_head )
-            _cpu_update_stats( 0, NULL );
-    } else
+    if ( _cpuAutoUpdate )
+        netsnmp_sampler_register( "cpu", _cpu_update_stats, NULL );
+    else
         _cpu_cache = netsnmp_cache_create( 5, netsnmp_cpu_arch_load, NULL,
                                               nsCPU, OID_LENGTH(nsCPU));
 }
@@ -173,52 +168,84 @@ int netsnmp_cpu_load( void ) {
 }
 #endif /* NETSNMP_FEATURE_REMOVE_HARDWARE_CPU_LOAD */
 
+    /*
+     * The oldest sample held for a CPU, or NULL if there isn't one yet.
+     *   Once the ring has filled, that's the one the next sample replaces.
+     */
+struct netsnmp_cpu_history *
+netsnmp_cpu_get_history( netsnmp_cpu_info *cpu ) {
+    int i, n;
+
+    if ( !cpu || !cpu->history )
+        return NULL;
+    for ( n=0; n<_cpuHistoryLen; n++ ) {
+        i = (_cpuHistoryPos + n) % _cpuHistoryLen;
+        if ( cpu->history[i].time_hist )
+            return &cpu->history[i];
+    }
+    return NULL;
+}
+
+    /*
+     * Work out the rates from the latest sample and the oldest
+     *   one held, i.e. over the last minute (or since the agent
+     *   started, if it hasn't been running that long).
+     */
+static void
+_cpu_calculate_rates( netsnmp_cpu_info *cpu, unsigned long long now ) {
+    struct netsnmp_cpu_history *old = netsnmp_cpu_get_history( cpu );
+    struct netsnmp_cpu_rates   *r   = &cpu->rates;
+    unsigned long long msec;
+
+    memset( r, 0, sizeof(*r));
+    if ( !old || old->time_hist >= now )
+        return;
+    msec = now - old->time_hist;
+
+    r->valid = 1;
+    r->total = cpu->total_ticks - old->total_hist;
+    if ( r->total ) {
+        r->user = (cpu->user_ticks - old->user_hist)*100 / r->total;
+        r->sys  = (cpu->sys_ticks  - old->sys_hist) *100 / r->total;
+        r->idle = (cpu->idle_ticks - old->idle_hist)*100 / r->total;
+    }
+    r->ctx   = (cpu->nCtxSwitches - old->ctx_hist)  *1000 / msec;
+    r->intr  = (cpu->nInterrupts  - old->intr_hist) *1000 / msec;
+    r->swpi  = (cpu->swapIn       - old->swpi_hist) *1000 / msec;
+    r->swpo  = (cpu->swapOut      - old->swpo_hist) *1000 / msec;
+    r->pagei = (cpu->pageIn       - old->pagei_hist)*1000 / msec;
+    r->pageo = (cpu->pageOut      - old->pageo_hist)*1000 / msec;
+}
+
     /*
      * Call the system-specific load routine regularly,
      * keeping track of the relevant earlier results.
      */
 static void
-_cpu_update_stats( unsigned int reg, void* magic ) {
+_cpu_update_stats( const struct timeval *tv, void* magic ) {
     netsnmp_cpu_info *cpu;
-    int i;
+    struct netsnmp_cpu_history *h;
+    unsigned long long now;
+    int len;
 
-    for ( cpu=_cpu_head; cpu; cpu=cpu->next ) {
-        if ( !cpu->history ) {
-            /*
-             * First time through, we need to create buffers
-             * for the historical stats
-             */
-            cpu->history  = (struct netsnmp_cpu_history *)calloc( _cpuHistoryLen, sizeof(struct netsnmp_cpu_history));
-        } else {
-            /*
-             * Otherwise, rotate these values - in descending order
-             *   with the earliest (relevant) statistics in entry 0.
-             * This means that the code to calculate the rolling averages
-             *   is independent of the number of historical samples saved.
-             */
-            for (i=0; i<_cpuHistoryLen-2; i++) {
-                cpu->history[i] = cpu->history[i+1];
-            }
-            cpu->history[i].user_hist  = cpu->user_ticks;
-            cpu->history[i].sys_hist   = cpu->sys_ticks;
-            cpu->history[i].idle_hist  = cpu->idle_ticks;
-            cpu->history[i].nice_hist  = cpu->nice_ticks;
-            cpu->history[i].total_hist = cpu->total_ticks;
-
-            cpu->history[i].ctx_hist   = cpu->nCtxSwitches;
-            cpu->history[i].intr_hist  = cpu->nInterrupts;
-            cpu->history[i].swpi_hist  = cpu->swapIn;
-            cpu->history[i].swpo_hist  = cpu->swapOut;
-            cpu->history[i].pagei_hist = cpu->pageIn;
-            cpu->history[i].pageo_hist = cpu->pageOut;
-        }
+    /*
+     * Enough samples to cover the last minute.
+     *   If the sampling interval has changed, start again.
+     */
+    len = 60/netsnmp_sampler_interval();
+    if ( len != _cpuHistoryLen ) {
+        for ( cpu=_cpu_head; cpu; cpu=cpu->next )
+            SNMP_FREE( cpu->history );
+        _cpuHistoryLen = len;
+        _cpuHistoryPos = 0;
     }
 
     /*
-     * Now call the system-specific load routine, to
+     * Call the system-specific load routine, to
      * retrieve the latest set of data.
      */
     netsnmp_cpu_arch_load( NULL, NULL );
+    now = (unsigned long long)tv->tv_sec * 1000 + tv->tv_usec / 1000;
     for ( cpu=_cpu_head; cpu; cpu=cpu->next ) {
         cpu->total_ticks = cpu->user_ticks +
                            cpu->nice_ticks +
@@ -231,7 +258,35 @@ _cpu_update_stats( unsigned int reg, void* magic ) {
                            cpu->steal_ticks +
                            cpu->guest_ticks +
                            cpu->guestnice_ticks;
+
+        _cpu_calculate_rates( cpu, now );
+
+        /*
+         * ... and keep this sample, in place of the oldest one.
+         *   (Buffers for the historical stats are created the
+         *    first time through)
+         */
+        if ( !cpu->history ) {
+            cpu->history = (struct netsnmp_cpu_history *)calloc( _cpuHistoryLen, sizeof(struct netsnmp_cpu_history));
+            if ( !cpu->history )
+                continue;
+        }
+        h = &cpu->history[_cpuHistoryPos];
+        h->user_hist  = cpu->user_ticks;
+        h->sys_hist   = cpu->sys_ticks;
+        h->idle_hist  = cpu->idle_ticks;
+        h->nice_hist  = cpu->nice_ticks;
+        h->total_hist = cpu->total_ticks;
+
+        h->ctx_hist   = cpu->nCtxSwitches;
+        h->intr_hist  = cpu->nInterrupts;
+        h->swpi_hist  = cpu->swapIn;
+        h->swpo_hist  = cpu->swapOut;
+        h->pagei_hist = cpu->pageIn;
+        h->pageo_hist = cpu->pageOut;
+        h->time_hist  = now;
     }
+    _cpuHistoryPos = (_cpuHistoryPos + 1) % _cpuHistoryLen;
 }
 
 #ifndef NETSNMP_FEATURE_REMOVE_HARDWARE_CPU_COPY_STATS
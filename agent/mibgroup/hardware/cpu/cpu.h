@@ -1,2 +1,4 @@
+config_require(util_funcs/sampler)
+
 void init_cpu(void);
 void shutdown_cpu(void);
@@ -25,6 +25,24 @@
 #if HAVE_SYS_STATVFS_H
 #include <sys/statvfs.h>
 #endif
+#include <errno.h>
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_SYS_WAIT_H
+#include <sys/wait.h>
+#endif
+#include <signal.h>
+#if HAVE_SYS_POLL_H
+#include <sys/poll.h>
+#endif
+
+#if defined(HAVE_FORK) && defined(HAVE_POLL) && defined(HAVE_SYS_POLL_H)
+#define _NETSNMP_FSYS_PROBE 1
+#endif
 
 #ifdef solaris2
 #define _NETSNMP_GETMNTENT_TWO_ARGS 1
@@ -146,14 +164,378 @@ _fsys_type( char *typename )
        return NETSNMP_FS_TYPE_IGNORE;
 }
 
+/*
+ * what statfs found: from statfs itself, or sent back by a helper
+ */
+struct _fsys_stat {
+    int                 error;          /* errno, or 0 */
+    unsigned long long  units;
+    unsigned long long  blocks;
+    unsigned long long  bfree;
+    unsigned long long  bavail;
+    unsigned long long  files;
+    unsigned long long  ffree;
+};
+
+/*
+ * the mounts found by the last look at the mount table, in its order
+ */
+static netsnmp_fsys_info **_fsys_mounts      = NULL;
+static int                 _fsys_mount_count = 0;
+static int                 _fsys_mount_max   = 0;
+
+static void
+_fsys_statfs( const char *path, struct _fsys_stat *st )
+{
+    struct NSFS_STATFS stat_buf;
+
+    memset( st, 0, sizeof(*st));
+#ifdef irix6
+    if ( NSFS_STATFS( path, &stat_buf, sizeof(struct statfs), 0) < 0 )
+#else
+    if ( NSFS_STATFS( path, &stat_buf ) < 0 )
+#endif
+    {
+        st->error = errno ? errno : EIO;
+        return;
+    }
+    st->units  = stat_buf.NSFS_SIZE;
+    st->blocks = stat_buf.f_blocks;
+    st->bfree  = stat_buf.f_bfree;
+    st->bavail = stat_buf.f_bavail;
+    st->files  = stat_buf.f_files;
+    st->ffree  = stat_buf.f_ffree;
+}
+
+static void
+_fsys_set( netsnmp_fsys_info *entry, const struct _fsys_stat *st )
+{
+    char tmpbuf[1024];
+
+    if ( st->error ) {
+        snprintf( tmpbuf, sizeof(tmpbuf), "Cannot statfs %s\n", entry->path );
+        errno = st->error;
+        snmp_log_perror( tmpbuf );
+        return;
+    }
+    entry->units =  st->units;
+    entry->size  =  st->blocks;
+    entry->used  = (st->blocks - st->bfree);
+    entry->avail =  st->bavail;
+    entry->inums_total = st->files;
+    entry->inums_avail = st->ffree;
+    netsnmp_fsys_calculate32(entry);
+}
+
+#ifdef _NETSNMP_FSYS_PROBE
+/*
+ * statfs of a hung NFS or FUSE mount blocks until the kernel gives up,
+ * so it is left to a helper process, with a deadline for each mount.
+ * A helper that overruns one is left to finish that mount on its own,
+ * and a new one carries on with the rest.  Until the old helper
+ * answers, the mount keeps its last values, flagged with
+ * NETSNMP_FS_FLAG_STALE, and isn't tried again.
+ */
+static int _fsys_stat_timeout = 2;      /* seconds; 0 stats in the agent */
+
+typedef struct _fsys_helper_s {
+    pid_t                  pid;
+    int                    req;         /* '\0' terminated paths to it */
+    int                    resp;        /* a struct _fsys_stat for each */
+    netsnmp_fsys_info     *entry;       /* the mount a slow one is on */
+    struct _fsys_helper_s *next;
+} _fsys_helper;
+
+static _fsys_helper  _fsys_prober = { -1, -1, -1, NULL, NULL };
+static _fsys_helper *_fsys_slow   = NULL;  /* and ones to reap */
+
+static void
+_fsys_parse_timeout( const char *token, char *line )
+{
+    int timeout = atoi( line );
+
+    if ( timeout < 0 ) {
+        config_perror( "fsysStatTimeout must not be negative" );
+        return;
+    }
+    _fsys_stat_timeout = timeout;
+}
+
+/*
+ * the helper: statfs each path that arrives, until the agent goes away
+ */
+static void
+_fsys_helper_run( int in, int out )
+{
+    struct _fsys_stat st;
+    char  path[SNMP_MAXPATH+1];
+    FILE *fp;
+    int   c, fd;
+    size_t len;
+
+    for ( fd = getdtablesize() - 1; fd > 2; --fd )
+        if ( fd != in && fd != out )
+            (void) close( fd );
+    fp = fdopen( in, "r" );
+    if ( !fp )
+        _exit( 1 );
+
+    for ( ;; ) {
+        len = 0;
+        while (( c = getc( fp )) != EOF && c != '\0' )
+            if ( len < sizeof(path) - 1 )
+                path[len++] = c;
+        if ( c == EOF )
+            _exit( 0 );
+        path[len] = '\0';
+        _fsys_statfs( path, &st );
+        if ( write( out, &st, sizeof(st)) != sizeof(st))
+            _exit( 1 );
+    }
+}
+
+static int
+_fsys_prober_start( void )
+{
+    int   req[2], resp[2];
+    pid_t pid;
+
+    if ( pipe( req ) < 0 )
+        return -1;
+    if ( pipe( resp ) < 0 ) {
+        close( req[0] );
+        close( req[1] );
+        return -1;
+    }
+    pid = fork();
+    if ( pid == 0 )
+        _fsys_helper_run( req[0], resp[1] );    /* doesn't return */
+    close( req[0] );
+    close( resp[1] );
+    if ( pid < 0 ) {
+        close( req[1] );
+        close( resp[0] );
+        return -1;
+    }
+    fcntl( req[1],  F_SETFD, FD_CLOEXEC );
+    fcntl( resp[0], F_SETFD, FD_CLOEXEC );
+    fcntl( req[1],  F_SETFL, fcntl( req[1], F_GETFL ) | O_NONBLOCK );
+
+    DEBUGMSGTL(("fsys:probe", "started statfs helper %d\n", (int)pid));
+    _fsys_prober.pid  = pid;
+    _fsys_prober.req  = req[1];
+    _fsys_prober.resp = resp[0];
+    return 0;
+}
+
+/*
+ * hand the helper over to the slow list: for entry, if it is stuck on
+ * that mount, or just to be reaped
+ */
+static void
+_fsys_prober_release( netsnmp_fsys_info *entry )
+{
+    _fsys_helper *h;
+
+    if ( _fsys_prober.pid < 0 )
+        return;
+
+    close( _fsys_prober.req );      /* it exits after its statfs */
+    h = SNMP_MALLOC_TYPEDEF( _fsys_helper );
+    if ( !h ) {
+        kill( _fsys_prober.pid, SIGKILL );
+        close( _fsys_prober.resp );
+    } else {
+        *h = _fsys_prober;
+        h->req   = -1;
+        h->entry = entry;
+        h->next  = _fsys_slow;
+        _fsys_slow = h;
+        if ( !entry ) {
+            close( h->resp );
+            h->resp = -1;
+        }
+    }
+    _fsys_prober.pid  = -1;
+    _fsys_prober.req  = -1;
+    _fsys_prober.resp = -1;
+}
+
+/*
+ * take the answers of the helpers that were stuck, and reap the ones
+ * that have finished
+ */
+static void
+_fsys_slow_check( void )
+{
+    struct _fsys_stat st;
+    struct pollfd     pfd;
+    _fsys_helper     *h, **prev = &_fsys_slow;
+
+    while (( h = *prev ) != NULL ) {
+        if ( h->entry ) {
+            pfd.fd      = h->resp;
+            pfd.events  = POLLIN;
+            pfd.revents = 0;
+            if ( poll( &pfd, 1, 0 ) <= 0 ) {
+                prev = &h->next;
+                continue;
+            }
+            if ( read( h->resp, &st, sizeof(st)) == sizeof(st)) {
+                DEBUGMSGTL(("fsys:probe", "%s answered\n", h->entry->path));
+                _fsys_set( h->entry, &st );
+            }
+            h->entry->flags &= ~NETSNMP_FS_FLAG_STALE;
+            h->entry = NULL;
+            close( h->resp );
+            h->resp = -1;
+            kill( h->pid, SIGKILL );    /* it may have more queued */
+        }
+        if ( waitpid( h->pid, NULL, WNOHANG ) != 0 ) {
+            *prev = h->next;
+            free( h );
+        } else
+            prev = &h->next;
+    }
+}
+
+/*
+ * statfs the n mounts in list through the helper
+ */
+static void
+_fsys_probe( netsnmp_fsys_info **list, int n )
+{
+    struct _fsys_stat st;
+    struct pollfd     pfd[2];
+    struct timeval    now, deadline, left;
+    int               sent = 0, done = 0, npfd, rc, timeout, i, j;
+    size_t            len;
+
+    gettimeofday( &deadline, NULL );
+    deadline.tv_sec += _fsys_stat_timeout;
+    while ( done < n ) {
+        if ( _fsys_prober.pid < 0 ) {
+            if ( _fsys_prober_start() < 0 ) {
+                NETSNMP_LOGONCE((LOG_WARNING,
+                    "fsys: no statfs helper, calling statfs in the agent\n"));
+                for ( ; done < n; done++ ) {
+                    _fsys_statfs( list[done]->path, &st );
+                    _fsys_set( list[done], &st );
+                }
+                return;
+            }
+            sent = done;
+            gettimeofday( &deadline, NULL );
+            deadline.tv_sec += _fsys_stat_timeout;
+        }
+
+        pfd[0].fd     = _fsys_prober.resp;
+        pfd[0].events = POLLIN;
+        pfd[1].fd     = _fsys_prober.req;
+        pfd[1].events = POLLOUT;
+        npfd = ( sent < n ) ? 2 : 1;
+        gettimeofday( &now, NULL );
+        NETSNMP_TIMERSUB( &deadline, &now, &left );
+        timeout = ( left.tv_sec < 0 ) ? 0 :
+                  left.tv_sec * 1000 + left.tv_usec / 1000;
+        rc = poll( pfd, npfd, timeout );
+        if ( rc < 0 ) {
+            if ( errno == EINTR )
+                continue;
+            snmp_log_perror( "fsys: poll" );
+            _fsys_prober_release( NULL );
+            return;
+        }
+        if ( rc == 0 ) {
+            /*
+             * list[done] overran its deadline
+             */
+            snmp_log( LOG_WARNING,
+                      "statfs %s took more than %d seconds, using its last values\n",
+                      list[done]->path, _fsys_stat_timeout );
+            list[done]->flags |= NETSNMP_FS_FLAG_STALE;
+            _fsys_prober_release( list[done] );
+            /*
+             * the same path can be mounted more than once: don't wait
+             * for it again
+             */
+            for ( i = j = done + 1; i < n; i++ )
+                if ( list[i] != list[done] )
+                    list[j++] = list[i];
+            n = j;
+            done++;
+            continue;
+        }
+
+        if ( npfd > 1 && ( pfd[1].revents & (POLLOUT|POLLERR|POLLHUP))) {
+            len = strlen( list[sent]->path ) + 1;
+            if ( write( _fsys_prober.req, list[sent]->path, len ) == (ssize_t)len )
+                sent++;
+            else if ( errno != EAGAIN )
+                pfd[0].revents |= POLLHUP;      /* gone: handled below */
+        }
+        if ( pfd[0].revents & (POLLIN|POLLERR|POLLHUP)) {
+            if ( read( _fsys_prober.resp, &st, sizeof(st)) == sizeof(st)) {
+                _fsys_set( list[done++], &st );
+                gettimeofday( &deadline, NULL );
+                deadline.tv_sec += _fsys_stat_timeout;
+            } else {
+                /*
+                 * the helper died, on list[done] presumably: skip that one
+                 */
+                snmp_log( LOG_ERR, "fsys: statfs helper died on %s\n",
+                          list[done]->path );
+                _fsys_prober_release( NULL );
+                done++;
+            }
+        }
+    }
+}
+#endif /* _NETSNMP_FSYS_PROBE */
+
+/*
+ * whether the mount table may have changed since it was last read
+ */
+static int
+_fsys_mounts_changed( void )
+{
+#if defined(linux) && defined(_NETSNMP_FSYS_PROBE)
+    /*
+     * the kernel flags a change with POLLPRI
+     */
+    static int    fd = -1;
+    struct pollfd pfd;
+
+    if ( fd < 0 ) {
+        fd = open( "/proc/self/mountinfo", O_RDONLY );
+        if ( fd >= 0 )
+            fcntl( fd, F_SETFD, FD_CLOEXEC );
+        return 1;
+    }
+    pfd.fd      = fd;
+    pfd.events  = POLLPRI;
+    pfd.revents = 0;
+    return ( poll( &pfd, 1, 0 ) != 0 );
+#else
+    return 1;
+#endif
+}
+
 void
 netsnmp_fsys_arch_init( void )
 {
+#ifdef _NETSNMP_FSYS_PROBE
+    snmpd_register_config_handler( "fsysStatTimeout", _fsys_parse_timeout,
+                                   NULL, "seconds" );
+#endif
     return;
 }
 
-void
-netsnmp_fsys_arch_load( void )
+/*
+ * read the mount table into _fsys_mounts
+ */
+static void
+_fsys_read_mounts( void )
 {
     FILE              *fp=NULL;
 #ifdef _NETSNMP_GETMNTENT_TWO_ARGS
@@ -162,8 +544,8 @@ netsnmp_fsys_arch_load( void )
 #else
     struct mntent     *m;
 #endif
-    struct NSFS_STATFS stat_buf;
-    netsnmp_fsys_info *entry;
+    netsnmp_fsys_info *entry, **old = _fsys_mounts;
+    int                old_count = _fsys_mount_count;
     char               tmpbuf[1024];
 
     /*
@@ -175,6 +557,8 @@ netsnmp_fsys_arch_load( void )
         snmp_log_perror( tmpbuf );
         return;
     }
+    _fsys_mounts = NULL;
+    _fsys_mount_count = _fsys_mount_max = 0;
 
     /*
      * ... and insert this into the filesystem container.
@@ -186,7 +570,14 @@ netsnmp_fsys_arch_load( void )
           ((m = getmntent(fp)) != NULL )
 #endif
     {
-        entry = netsnmp_fsys_by_path( m->NSFS_PATH, NETSNMP_FS_FIND_CREATE );
+        /*
+         * mostly, the mounts are where they were last time
+         */
+        if ( _fsys_mount_count < old_count &&
+             !strcmp( old[_fsys_mount_count]->path, m->NSFS_PATH ))
+            entry = old[_fsys_mount_count];
+        else
+            entry = netsnmp_fsys_by_path( m->NSFS_PATH, NETSNMP_FS_FIND_CREATE );
         if (!entry) {
             continue;
         }
@@ -196,8 +587,6 @@ netsnmp_fsys_arch_load( void )
         strncpy( entry->device, m->NSFS_DEV,     sizeof( entry->device ));
         entry->device[sizeof(entry->device)-1] = '\0';
         entry->type   = _fsys_type(  m->NSFS_TYPE );
-        if (!(entry->type & _NETSNMP_FS_TYPE_SKIP_BIT))
-            entry->flags |= NETSNMP_FS_FLAG_ACTIVE;
 
         if ( _fsys_remote( entry->device, entry->type ))
             entry->flags |= NETSNMP_FS_FLAG_REMOTE;
@@ -219,6 +608,53 @@ netsnmp_fsys_arch_load( void )
          *  XXX - identify removeable disks
          */
 
+        if ( _fsys_mount_count == _fsys_mount_max ) {
+            netsnmp_fsys_info **p;
+            int max = _fsys_mount_max ? 2 * _fsys_mount_max : 64;
+
+            p = realloc( _fsys_mounts, max * sizeof(*p));
+            if ( !p ) {
+                snmp_log( LOG_ERR, "fsys: out of memory for the mount table\n" );
+                break;
+            }
+            _fsys_mounts    = p;
+            _fsys_mount_max = max;
+        }
+        _fsys_mounts[_fsys_mount_count++] = entry;
+    }
+    fclose( fp );
+    free( old );
+}
+
+void
+netsnmp_fsys_arch_load( void )
+{
+    netsnmp_fsys_info *entry, **list;
+    struct _fsys_stat  st;
+    int                i, n = 0;
+
+    /*
+     * Only read the mount table again if it changed
+     */
+    if ( !_fsys_mounts || _fsys_mounts_changed())
+        _fsys_read_mounts();
+
+    list = malloc(( _fsys_mount_count + 1 ) * sizeof(*list));
+    if ( !list ) {
+        snmp_log( LOG_ERR, "fsys: out of memory\n" );
+        return;
+    }
+#ifdef _NETSNMP_FSYS_PROBE
+    _fsys_slow_check();
+    if ( !_fsys_stat_timeout )
+        _fsys_prober_release( NULL );
+#endif
+
+    for ( i = 0; i < _fsys_mount_count; i++ ) {
+        entry = _fsys_mounts[i];
+        if (!(entry->type & _NETSNMP_FS_TYPE_SKIP_BIT))
+            entry->flags |= NETSNMP_FS_FLAG_ACTIVE;
+
         /*
          *  Optionally skip retrieving statistics for remote mounts
          */
@@ -227,24 +663,23 @@ netsnmp_fsys_arch_load( void )
                                    NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES))
             continue;
 
-#ifdef irix6
-        if ( NSFS_STATFS( entry->path, &stat_buf, sizeof(struct statfs), 0) < 0 )
-#else
-        if ( NSFS_STATFS( entry->path, &stat_buf ) < 0 )
-#endif
-        {
-            snprintf( tmpbuf, sizeof(tmpbuf), "Cannot statfs %s\n", entry->path );
-            snmp_log_perror( tmpbuf );
+        /*
+         *  ... and mounts that a helper is still stuck on
+         */
+        if ( entry->flags & NETSNMP_FS_FLAG_STALE )
             continue;
-        }
-        entry->units =  stat_buf.NSFS_SIZE;
-        entry->size  =  stat_buf.f_blocks;
-        entry->used  = (stat_buf.f_blocks - stat_buf.f_bfree);
-        entry->avail =  stat_buf.f_bavail;
-        entry->inums_total = stat_buf.f_files;
-        entry->inums_avail = stat_buf.f_ffree;
-        netsnmp_fsys_calculate32(entry);
+        list[n++] = entry;
     }
-    fclose( fp );
-}
 
+#ifdef _NETSNMP_FSYS_PROBE
+    if ( _fsys_stat_timeout ) {
+        _fsys_probe( list, n );
+        n = 0;
+    }
+#endif
+    for ( i = 0; i < n; i++ ) {
+        _fsys_statfs( list[i]->path, &st );
+        _fsys_set( list[i], &st );
+    }
+    free( list );
+}
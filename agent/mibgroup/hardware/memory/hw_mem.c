@@ -5,6 +5,8 @@
 
 #include <net-snmp/net-snmp-features.h>
 
+#include "util_funcs/sampler.h"
+
 netsnmp_feature_child_of(hardware_memory, netsnmp_unused)
 
 netsnmp_feature_child_of(memory_get_cache, hardware_memory)
@@ -14,10 +16,27 @@ extern NetsnmpCacheLoad netsnmp_mem_arch_load;
 netsnmp_memory_info *_mem_head  = NULL;
 netsnmp_cache       *_mem_cache = NULL;
 
+static void _mem_update_stats( const struct timeval *, void* );
+
 void init_hw_mem( void ) {
     oid nsMemory[] = { 1, 3, 6, 1, 4, 1, 8072, 1, 31 };
     _mem_cache = netsnmp_cache_create( 5, netsnmp_mem_arch_load, NULL,
                                           nsMemory, OID_LENGTH(nsMemory));
+    netsnmp_sampler_register( "memory", _mem_update_stats, NULL );
+}
+
+    /*
+     * Reload the memory statistics with the other system statistics,
+     *   so that requests are answered from the cache.  It only expires
+     *   on its own if the sampler falls behind.
+     */
+static void
+_mem_update_stats( const struct timeval *now, void* magic ) {
+    if ( !_mem_cache )
+        return;
+    _mem_cache->timeout = netsnmp_sampler_interval() + 1;
+    _mem_cache->expired = 1;
+    netsnmp_cache_check_and_reload( _mem_cache );
 }
 
 
@@ -1 +1,3 @@
+config_require(util_funcs/sampler)
+
 void init_hw_mem(void);
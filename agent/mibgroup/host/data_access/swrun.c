@@ -14,6 +14,7 @@
 
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 #include <net-snmp/data_access/swrun.h>
+#include "host/data_access/swrun.h"
 
 netsnmp_feature_child_of(software_running, libnetsnmpmibs)
 
@@ -28,6 +29,12 @@ static int _swrun_init = 0;
        int _swrun_max  = 0;
 static netsnmp_cache     *swrun_cache     = NULL;
 static netsnmp_container *swrun_container = NULL;
+#ifdef NETSNMP_ACCESS_SWRUN_HAVE_INCREMENTAL
+/*
+ * "swrun_incremental no" reads every process from scratch on each load
+ */
+static int _swrun_incremental = 1;
+#endif
 
 netsnmp_container * netsnmp_swrun_container(void);
 netsnmp_cache     * netsnmp_swrun_cache    (void);
@@ -37,6 +44,11 @@ netsnmp_cache     * netsnmp_swrun_cache    (void);
  */
 static void _swrun_entry_release(netsnmp_swrun_entry * entry,
                                             void *unused);
+#ifdef NETSNMP_ACCESS_SWRUN_HAVE_INCREMENTAL
+static void _parse_swrun_incremental(const char *token, char *line);
+static int  _swrun_incremental_config(int majorID, int minorID,
+                                      void *serverarg, void *clientarg);
+#endif
 
 /**---------------------------------------------------------------------*/
 /*
@@ -65,6 +77,14 @@ init_swrun(void)
     (void)netsnmp_swrun_container();
     netsnmp_arch_swrun_init();
     (void) netsnmp_swrun_cache();
+
+#ifdef NETSNMP_ACCESS_SWRUN_HAVE_INCREMENTAL
+    snmpd_register_config_handler("swrun_incremental",
+                                  _parse_swrun_incremental, NULL, "yes|no");
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY,
+                           SNMP_CALLBACK_POST_READ_CONFIG,
+                           _swrun_incremental_config, NULL);
+#endif
 }
 
 void
@@ -120,7 +140,13 @@ swrun_count_processes_by_name( char *name )
 static int
 _cache_load( netsnmp_cache *cache,  void *magic )
 {
-    netsnmp_swrun_container_load( swrun_container, 0 );
+    u_int flags = 0;
+
+#ifdef NETSNMP_ACCESS_SWRUN_HAVE_INCREMENTAL
+    if (_swrun_incremental)
+        flags |= NETSNMP_SWRUN_INCREMENTAL;
+#endif
+    netsnmp_swrun_container_load( swrun_container, flags );
     return 0;
 }
 
@@ -151,6 +177,41 @@ netsnmp_swrun_cache(void)
 }
 
 
+#ifdef NETSNMP_ACCESS_SWRUN_HAVE_INCREMENTAL
+static void
+_parse_swrun_incremental(const char *token, char *line)
+{
+    int             use = netsnmp_ds_parse_boolean(line);
+
+    if (use >= 0)
+        _swrun_incremental = use;
+}
+
+/*
+ * an incremental load updates the entries of the last one, so they
+ * have to stay in the container between loads.
+ */
+static int
+_swrun_incremental_config(int majorID, int minorID, void *serverarg,
+                          void *clientarg)
+{
+    const u_int     keep = NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD |
+                           NETSNMP_CACHE_DONT_AUTO_RELEASE;
+
+    if (NULL == swrun_cache)
+        return SNMP_ERR_NOERROR;
+
+    DEBUGMSGTL(("swrun:access", "incremental loads %s\n",
+                _swrun_incremental ? "on" : "off"));
+    if (_swrun_incremental)
+        swrun_cache->flags |= keep;
+    else
+        swrun_cache->flags &= ~keep;
+
+    return SNMP_ERR_NOERROR;
+}
+#endif /* NETSNMP_ACCESS_SWRUN_HAVE_INCREMENTAL */
+
 /**---------------------------------------------------------------------*/
 /*
  * container functions
@@ -184,6 +245,8 @@ netsnmp_swrun_container(void)
  *                  pass NULL to have the function create one.
  * @param load_flags flags to modify behaviour. Examples:
  *                   NETSNMP_SWRUN_ALL_OR_NONE
+ *                   NETSNMP_SWRUN_INCREMENTAL: the container holds the
+ *                   result of the last load, which is updated in place
  *
  * @retval NULL  error
  * @retval !NULL pointer to container
@@ -17,6 +17,9 @@
 #include <sys/types.h>
 #endif
 
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
 #ifdef HAVE_DIRENT_H
 #include <dirent.h>
 #endif
@@ -42,17 +45,167 @@ netsnmp_arch_swrun_init(void)
     return;
 }
 
+/*
+ * read a /proc/{pid}/ file with a single read, leaving two '\0's after
+ * what was read
+ */
+static int
+_swrun_read(int pid, const char *file, char *buf, size_t len)
+{
+    char path[64];
+    int  fd, n;
+
+    snprintf(path, sizeof(path), "/proc/%d/%s", pid, file);
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;      /* process probably went away */
+    n = read(fd, buf, len - 2);
+    close(fd);
+    if (n < 0)
+        return -1;
+    buf[n] = buf[n + 1] = '\0';
+    return n;
+}
+
+/*
+ * the columns that change: from /proc/{pid}/stat
+ *   PID (COMM) STATUS  {xxx}*10  UTIME STIME  {xxx}*6 STARTTIME {xxx} RSS
+ * COMM may hold spaces and parentheses, so parse from the last ')'.
+ * Returns COMM, cut out of buf.
+ */
+static char *
+_swrun_parse_stat(char *buf, netsnmp_swrun_entry *entry, u_long *start)
+{
+    char          *comm, *cp, state;
+    unsigned long  utime, stime;
+    long           rss;
+
+    comm = strchr(buf, '(');
+    cp = strrchr(buf, ')');
+    if (NULL == comm || NULL == cp || cp < comm)
+        return NULL;
+    *cp = '\0';
+    if (sscanf(cp + 2, "%c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu"
+               " %*d %*d %*d %*d %*d %*d %lu %*u %ld",
+               &state, &utime, &stime, start, &rss) != 5)
+        return NULL;
+
+    switch (state) {
+    case 'R':  entry->hrSWRunStatus = HRSWRUNSTATUS_RUNNING;
+               break;
+    case 'S':  entry->hrSWRunStatus = HRSWRUNSTATUS_RUNNABLE;
+               break;
+    case 'D':
+    case 'T':  entry->hrSWRunStatus = HRSWRUNSTATUS_NOTRUNNABLE;
+               break;
+    case 'Z':
+    default:   entry->hrSWRunStatus = HRSWRUNSTATUS_INVALID;
+               break;
+    }
+    entry->hrSWRunPerfCPU = utime + stime;
+    entry->hrSWRunPerfMem = rss * (getpagesize() / 1024);   /* in kB */
+
+    return comm + 1;
+}
+
+/*
+ * the columns that don't change while the process runs the same
+ * program: from /proc/{pid}/status and /proc/{pid}/cmdline
+ */
+static int
+_swrun_load_static(int pid, netsnmp_swrun_entry *entry)
+{
+    char   buf[BUFSIZ], *cp;
+    size_t len;
+
+    /*
+     *   Name:  process name
+     */
+    if (_swrun_read(pid, "status", buf, sizeof(buf)) <= 0)
+        return -1;
+    cp = strchr(buf, ':');
+    if (NULL == cp)
+        return -1;
+    while (isspace(*(++cp)))	/* Skip ':' and following spaces */
+        ;
+    len = strcspn(cp, "\n");
+    if (len > sizeof(entry->hrSWRunName) - 1)
+        len = sizeof(entry->hrSWRunName) - 1;
+    memcpy(entry->hrSWRunName, cp, len);
+    entry->hrSWRunName[len] = '\0';
+    entry->hrSWRunName_len = len;
+
+    /*
+     *  Command Line:
+     *     argv[0] '\0' argv[1] '\0' ....
+     *  Kernel threads and zombies have none, and aren't listed.
+     */
+    if (_swrun_read(pid, "cmdline", buf, sizeof(buf)) <= 0)
+        return -1;
+
+    /*
+     *     argv[0]   is hrSWRunPath
+     */
+    len = strlen(buf);
+    cp = buf + len + 1;
+    if (len > sizeof(entry->hrSWRunPath) - 1)
+        len = sizeof(entry->hrSWRunPath) - 1;
+    memcpy(entry->hrSWRunPath, buf, len);
+    entry->hrSWRunPath[len] = '\0';
+    entry->hrSWRunPath_len = len;
+
+    /*
+     * Stitch together argv[1..] to construct hrSWRunParameters
+     */
+    len = 0;
+    if (*cp) {
+        char *end = cp;
+
+        while ( 1 ) {
+            while (*end)
+                end++;
+            if ( '\0' == *(end+1))
+                break;      /* '\0''\0' => End of command line */
+            *end = ' ';
+        }
+        len = end - cp;
+        if (len > sizeof(entry->hrSWRunParameters) - 1)
+            len = sizeof(entry->hrSWRunParameters) - 1;
+        memcpy(entry->hrSWRunParameters, cp, len);
+    }
+    entry->hrSWRunParameters[len] = '\0';
+    entry->hrSWRunParameters_len = len;
+
+    /*
+     * XXX - No information regarding system processes vs applications
+     */
+    entry->hrSWRunType = HRSWRUNTYPE_APPLICATION;
+
+    return 0;
+}
+
 /* ---------------------------------------------------------------------
  */
+/*
+ * With NETSNMP_SWRUN_INCREMENTAL, the container holds the processes of
+ * the last load. A process that is still there, started at the same
+ * time and with the same name, only has its stat file read again; new
+ * processes are read in full, and the ones that have gone are removed.
+ */
 int
 netsnmp_arch_swrun_container_load( netsnmp_container *container, u_int flags)
 {
+    static u_int         generation = 0;
     DIR                 *procdir = NULL;
     struct dirent       *procentry_p;
-    FILE                *fp;
-    int                  pid, i;
-    char                 buf[BUFSIZ], buf2[BUFSIZ], *cp;
-    netsnmp_swrun_entry *entry;
+    int                  pid, rc = 0;
+    size_t               i, new_count = 0, new_max = 0, gone = 0;
+    char                 buf[BUFSIZ], *comm;
+    u_long               start;
+    netsnmp_swrun_entry *entry, tmp, **new_entries = NULL;
+    netsnmp_index        index;
+    oid                  index_oid;
+    netsnmp_iterator    *it;
     
     procdir = opendir("/proc");
     if ( NULL == procdir ) {
@@ -60,159 +213,111 @@ netsnmp_arch_swrun_container_load( netsnmp_container *container, u_int flags)
         return -1;
     }
 
+    ++generation;
+    index.len = 1;
+    index.oids = &index_oid;
+
     /*
-     * Walk through the list of processes in the /proc tree
+     * Walk through the list of processes in the /proc tree.  New entries
+     * are only inserted afterwards, which keeps the container sorted
+     * for the lookups.
      */
     while ( NULL != (procentry_p = readdir( procdir ))) {
         pid = atoi( procentry_p->d_name );
         if ( 0 == pid )
             continue;   /* Presumably '.' or '..' */
 
-        entry = netsnmp_swrun_entry_create(pid);
-        if (NULL == entry)
-            continue;   /* error already logged by function */
-
-        /*
-         * Now extract the interesting information
-         *   from the various /proc{PID}/ interface files
-         */
-
-        /*
-         *   Name:  process name
-         */
-        snprintf( buf2, BUFSIZ, "/proc/%d/status", pid );
-        fp = fopen( buf2, "r" );
-        if (!fp) {
-            netsnmp_swrun_entry_free(entry);
-            continue; /* file (process) probably went away */
-	}
-        memset(buf, 0, sizeof(buf));
-        if (fgets( buf, BUFSIZ-1, fp ) == NULL) {
-            fclose(fp);
-            netsnmp_swrun_entry_free(entry);
+        if (_swrun_read(pid, "stat", buf, sizeof(buf)) <= 0)
+            continue;   /* process probably went away */
+        memset(&tmp, 0, sizeof(tmp));
+        comm = _swrun_parse_stat(buf, &tmp, &start);
+        if (NULL == comm)
             continue;
-        }
-        fclose(fp);
-
-        for ( cp = buf; *cp != ':'; cp++ )
-            ;
-        while (isspace(*(++cp)))	/* Skip ':' and following spaces */
-            ;
-        entry->hrSWRunName_len = snprintf(entry->hrSWRunName,
-                                   sizeof(entry->hrSWRunName)-1, "%s", cp);
-        if ( '\n' == entry->hrSWRunName[ entry->hrSWRunName_len-1 ]) {
-            entry->hrSWRunName[ entry->hrSWRunName_len-1 ] = '\0';
-            entry->hrSWRunName_len--;           /* Stamp on trailing newline */
-        }
 
-        /*
-         *  Command Line:
-         *     argv[0] '\0' argv[1] '\0' ....
-         */
-        snprintf( buf2, BUFSIZ, "/proc/%d/cmdline", pid );
-        fp = fopen( buf2, "r" );
-        if (!fp) {
-            netsnmp_swrun_entry_free(entry);
-            continue; /* file (process) probably went away */
-	}
-        memset(buf, 0, sizeof(buf));
-        if ((cp = fgets( buf, BUFSIZ-1, fp )) == NULL) {
-            fclose(fp);
-            netsnmp_swrun_entry_free(entry);
+        entry = NULL;
+        if (flags & NETSNMP_SWRUN_INCREMENTAL) {
+            index_oid = pid;
+            entry = (netsnmp_swrun_entry *)CONTAINER_FIND(container, &index);
+        }
+        if (entry && entry->start_time == start &&
+            0 == strcmp(entry->hrSWRunName, comm)) {
+            entry->hrSWRunStatus  = tmp.hrSWRunStatus;
+            entry->hrSWRunPerfCPU = tmp.hrSWRunPerfCPU;
+            entry->hrSWRunPerfMem = tmp.hrSWRunPerfMem;
+            entry->generation = generation;
             continue;
         }
-        fclose(fp);
 
-        if ( cp ) {
-            /*
-             *     argv[0]   is hrSWRunPath
-             */ 
-            entry->hrSWRunPath_len = snprintf(entry->hrSWRunPath,
-                                       sizeof(entry->hrSWRunPath)-1, "%s", buf);
+        if (entry) {
             /*
-             * Stitch together argv[1..] to construct hrSWRunParameters
+             * the pid was reused, or the process exec()ed another program
              */
-            cp = buf + entry->hrSWRunPath_len+1;
-            while ( 1 ) {
-                while (*cp)
-                    cp++;
-                if ( '\0' == *(cp+1))
-                    break;      /* '\0''\0' => End of command line */
-                *cp = ' ';
-            }
-            entry->hrSWRunParameters_len
-                = sprintf(entry->hrSWRunParameters, "%.*s",
-                          (int)sizeof(entry->hrSWRunParameters) - 1,
-                          buf + entry->hrSWRunPath_len + 1);
+            if (_swrun_load_static(pid, entry) < 0)
+                continue;   /* removed below */
         } else {
-            memcpy(entry->hrSWRunPath, entry->hrSWRunName, entry->hrSWRunName_len);
-            entry->hrSWRunPath_len       = entry->hrSWRunName_len;
-            entry->hrSWRunParameters_len = 0;
-        }
- 
-        /*
-         * XXX - No information regarding system processes vs applications
-         */
-        entry->hrSWRunType = HRSWRUNTYPE_APPLICATION;
-
-        /*
-         *   {xxx} {xxx} STATUS  {xxx}*10  UTIME STIME  {xxx}*8 RSS
-         */
-        snprintf( buf, BUFSIZ, "/proc/%d/stat", pid );
-        fp = fopen( buf, "r" );
-        if (!fp) {
-            netsnmp_swrun_entry_free(entry);
-            continue; /* file (process) probably went away */
-	}
-        if (fgets( buf, BUFSIZ-1, fp ) == NULL) {
-            fclose(fp);
-            netsnmp_swrun_entry_free(entry);
-            continue;
-        }
-        fclose(fp);
-
-        cp = buf;
-        while ( ' ' != *(cp++))    /* Skip first field */
-            ;
-        while ( ' ' != *(cp++))    /* Skip second field */
-            ;
-        
-        switch (*cp) {
-        case 'R':  entry->hrSWRunStatus = HRSWRUNSTATUS_RUNNING;
-                   break;
-        case 'S':  entry->hrSWRunStatus = HRSWRUNSTATUS_RUNNABLE;
-                   break;
-        case 'D':
-        case 'T':  entry->hrSWRunStatus = HRSWRUNSTATUS_NOTRUNNABLE;
-                   break;
-        case 'Z':
-        default:   entry->hrSWRunStatus = HRSWRUNSTATUS_INVALID;
-                   break;
-        }
-        for (i=10; i; i--) {   /* Skip STATUS + 10 fields */
-            while (' ' != *(cp++))
-                ;
-            cp++;
-        }
-        entry->hrSWRunPerfCPU  = atoi( cp );   /*  utime */
-        while ( ' ' != *(cp++))
-            ;
-        cp++;				   /* Skip utime */
-        entry->hrSWRunPerfCPU += atoi( cp );   /* +stime */
-
-        for (i=8; i; i--) {   /* Skip stime + 8 fields */
-            while (' ' != *(cp++))
-                ;
-            cp++;
+            entry = netsnmp_swrun_entry_create(pid);
+            if (NULL == entry)
+                continue;   /* error already logged by function */
+            if (_swrun_load_static(pid, entry) < 0) {
+                netsnmp_swrun_entry_free(entry);
+                continue;
+            }
+            if (new_count == new_max) {
+                netsnmp_swrun_entry **p;
+
+                new_max = new_max ? 2 * new_max : 256;
+                p = realloc(new_entries, new_max * sizeof(*new_entries));
+                if (NULL == p) {
+                    snmp_log(LOG_ERR, "could not allocate swrun entries\n");
+                    netsnmp_swrun_entry_free(entry);
+                    rc = -1;
+                    break;
+                }
+                new_entries = p;
+            }
+            new_entries[new_count++] = entry;
         }
-        entry->hrSWRunPerfMem  = atoi( cp );   /*  rss */
-        entry->hrSWRunPerfMem *= (getpagesize()/1024);  /* in kB */
-        CONTAINER_INSERT(container, entry);
+        entry->hrSWRunStatus  = tmp.hrSWRunStatus;
+        entry->hrSWRunPerfCPU = tmp.hrSWRunPerfCPU;
+        entry->hrSWRunPerfMem = tmp.hrSWRunPerfMem;
+        entry->start_time = start;
+        entry->generation = generation;
     }
     closedir( procdir );
 
-    DEBUGMSGTL(("swrun:load:arch"," loaded %" NETSNMP_PRIz "d entries\n",
-                CONTAINER_SIZE(container)));
+    /*
+     * drop the processes that have gone
+     */
+    if ((flags & NETSNMP_SWRUN_INCREMENTAL) && CONTAINER_SIZE(container)) {
+        netsnmp_swrun_entry **old_entries;
 
-    return 0;
+        old_entries = malloc(CONTAINER_SIZE(container) * sizeof(*old_entries));
+        it = old_entries ? CONTAINER_ITERATOR(container) : NULL;
+        if (NULL == it) {
+            snmp_log(LOG_ERR, "could not remove old swrun entries\n");
+            rc = -1;
+        } else {
+            for (entry = (netsnmp_swrun_entry *)ITERATOR_FIRST(it); entry;
+                 entry = (netsnmp_swrun_entry *)ITERATOR_NEXT(it))
+                if (entry->generation != generation)
+                    old_entries[gone++] = entry;
+            ITERATOR_RELEASE(it);
+            for (i = 0; i < gone; i++) {
+                CONTAINER_REMOVE(container, old_entries[i]);
+                netsnmp_swrun_entry_free(old_entries[i]);
+            }
+        }
+        free(old_entries);
+    }
+
+    for (i = 0; i < new_count; i++)
+        if (CONTAINER_INSERT(container, new_entries[i]) != 0)
+            netsnmp_swrun_entry_free(new_entries[i]);
+    free(new_entries);
+
+    DEBUGMSGTL(("swrun:load:arch"," loaded %" NETSNMP_PRIz "d entries"
+                " (%" NETSNMP_PRIz "d new, %" NETSNMP_PRIz "d gone)\n",
+                CONTAINER_SIZE(container), new_count, gone));
+
+    return rc;
 }
@@ -164,7 +164,6 @@ var_hrproc(struct variable * vp,
            int exact, size_t * var_len, WriteMethod ** write_method)
 {
     int             proc_idx;
-    unsigned long long value;
     netsnmp_cpu_info *cpu;
 
     proc_idx =
@@ -178,13 +177,10 @@ var_hrproc(struct variable * vp,
         return (u_char *) nullOid;
     case HRPROC_LOAD:
         cpu = netsnmp_cpu_get_byIdx( proc_idx & HRDEV_TYPE_MASK, 0 );
-        if ( !cpu || !cpu->history || !cpu->history[0].total_hist ||
-           ( cpu->history[0].total_hist == cpu->total_ticks ))
+        if ( !cpu || !cpu->rates.valid || !cpu->rates.total )
             return NULL;
 
-        value = (cpu->idle_ticks  - cpu->history[0].idle_hist)*100;
-        value /= (cpu->total_ticks - cpu->history[0].total_hist);
-        long_return = 100 - value;
+        long_return = 100 - cpu->rates.idle;
         if (long_return < 0)
             long_return = 0;
         return (u_char *) & long_return;
@@ -61,6 +61,12 @@ extern int
 netsnmp_arch_set_admin_status(netsnmp_interface_entry * entry,
                               int ifAdminStatus);
 extern int netsnmp_arch_interface_index_find(const char*name);
+#ifdef NETSNMP_ACCESS_INTERFACE_HAVE_CHANGES
+extern int
+netsnmp_arch_interface_changes_start(NetsnmpAccessInterfaceChange *hook,
+                                     void *ctx);
+extern void netsnmp_arch_interface_changes_stop(void);
+#endif
 #endif
 
 
@@ -211,6 +217,38 @@ netsnmp_access_interface_index_find(const char *name)
 }
 #endif
 
+/**
+ * report interface changes to a hook as they happen
+ *
+ * @retval  0 : success
+ * @retval -1 : not available on this platform, or error
+ */
+int
+netsnmp_access_interface_changes_start(NetsnmpAccessInterfaceChange *hook,
+                                       void *ctx)
+{
+    DEBUGMSGTL(("access:interface:changes", "start\n"));
+    netsnmp_assert(1 == _access_interface_init);
+
+    if (NULL == hook)
+        return -1;
+#ifdef NETSNMP_ACCESS_INTERFACE_HAVE_CHANGES
+    return netsnmp_arch_interface_changes_start(hook, ctx);
+#else
+    return -1;
+#endif
+}
+
+void
+netsnmp_access_interface_changes_stop(void)
+{
+    DEBUGMSGTL(("access:interface:changes", "stop\n"));
+
+#ifdef NETSNMP_ACCESS_INTERFACE_HAVE_CHANGES
+    netsnmp_arch_interface_changes_stop();
+#endif
+}
+
 /**---------------------------------------------------------------------*/
 /*
  * ifentry functions
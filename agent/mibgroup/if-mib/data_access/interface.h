@@ -35,6 +35,9 @@ config_exclude(mibII/interfaces)
     config_require(util_funcs)
     config_require(if-mib/data_access/interface_linux)
     config_require(if-mib/data_access/interface_ioctl)
+#   if defined( HAVE_LINUX_RTNETLINK_H )
+#       define NETSNMP_ACCESS_INTERFACE_HAVE_CHANGES 1
+#   endif
 
 #   elif defined( openbsd3 ) || \
          defined( freebsd4 ) || defined( freebsd5 ) || defined( freebsd6 ) || \
@@ -53,6 +53,7 @@ typedef __u8 u8;           /* ditto */
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <errno.h>
 
 #include <linux/sockios.h>
 #include <linux/if_ether.h>
@@ -69,14 +70,17 @@ typedef __u8 u8;           /* ditto */
 #define SIOCGMIIREG 0x8948
 #endif
 
-#ifdef NETSNMP_ENABLE_IPV6
 #if defined(HAVE_LINUX_RTNETLINK_H)
+#include <linux/netlink.h>
 #include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+#include <linux/neighbour.h>
+#ifdef NETSNMP_ENABLE_IPV6
 #ifdef RTMGRP_IPV6_PREFIX
 #define SUPPORT_PREFIX_FLAGS 1
 #endif  /* RTMGRP_IPV6_PREFIX */
-#endif  /* HAVE_LINUX_RTNETLINK_H */
 #endif  /* NETSNMP_ENABLE_IPV6 */
+#endif  /* HAVE_LINUX_RTNETLINK_H */
 unsigned long long
 netsnmp_linux_interface_get_if_speed(int fd, const char *name,
         unsigned long long defaultspeed);
@@ -105,6 +109,45 @@ netsnmp_prefix_listen_info list_info;
 int netsnmp_prefix_listen(void);
 #endif
 
+/*
+ * "interface_netlink no" forces the /proc/net/dev loader
+ */
+static int interface_use_netlink = 1;
+
+/*
+ * ifSpeed cache.
+ *
+ * ETHTOOL_GSET (and the MII probe behind it) is the most expensive per
+ * interface call made while loading the table, so its result is reused
+ * until the interface goes up or down, is renamed, or the value is more
+ * than IF_SPEED_CACHE_TIMEOUT seconds old.
+ */
+#define IF_SPEED_CACHE_TIMEOUT 60
+
+typedef struct _if_speed_cache {
+    oid                 index;
+    u_int               state;          /* IFF_UP/IFF_RUNNING when probed */
+    u_int               generation;     /* last load that used it */
+    time_t              loaded;
+    unsigned long long  speed;
+    char                name[IF_NAMESIZE];
+} if_speed_cache;
+
+static if_speed_cache *speed_cache = NULL;
+static size_t   speed_cache_count = 0;  /* entries in use */
+static size_t   speed_cache_sorted = 0; /* leading entries sorted by index */
+static size_t   speed_cache_size = 0;   /* entries allocated */
+static u_int    speed_cache_generation = 0;
+
+static void
+_parse_interface_netlink(const char *token, char *line)
+{
+    int             use = netsnmp_ds_parse_boolean(line);
+
+    if (use >= 0)
+        interface_use_netlink = use;
+}
+
 
 void
 netsnmp_arch_interface_init(void)
@@ -144,6 +187,10 @@ netsnmp_arch_interface_init(void)
     netsnmp_prefix_listen();
 #endif
 
+    snmpd_register_config_handler("interface_netlink",
+                                  _parse_interface_netlink, NULL,
+                                  "yes|no");
+
 #ifdef HAVE_PCI_LOOKUP_NAME
     pci_access = pci_alloc();
     if (pci_access)
@@ -411,6 +458,58 @@ _arch_interface_flags_v6_get(netsnmp_interface_entry *entry)
 }
 #endif /* NETSNMP_ENABLE_IPV6 */
 
+/**
+ * @internal
+ * store the counters of an interface, wherever they were read from
+ */
+static void
+_arch_interface_stats_set(netsnmp_interface_entry *entry,
+                          uint64_t rec_oct, uint64_t rec_pkt,
+                          uint64_t rec_err, uint64_t rec_drop,
+                          uint64_t rec_mcast, uint64_t snd_oct,
+                          uint64_t snd_pkt, uint64_t snd_err,
+                          uint64_t snd_drop, uint64_t coll)
+{
+    entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_ACTIVE;
+    
+    /*
+     * linux previous to 1.3.~13 may miss transmitted loopback pkts: 
+     */
+    if (!strcmp(entry->name, "lo") && rec_pkt > 0 && !snd_pkt)
+        snd_pkt = rec_pkt;
+    
+    /*
+     * subtract out multicast packets from rec_pkt before
+     * we store it as unicast counter.
+     */
+    entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_CALCULATE_UCAST;
+    entry->stats.ibytes.low = rec_oct & 0xffffffff;
+    entry->stats.iall.low = rec_pkt & 0xffffffff;
+    entry->stats.imcast.low = rec_mcast & 0xffffffff;
+    entry->stats.obytes.low = snd_oct & 0xffffffff;
+    entry->stats.oucast.low = snd_pkt & 0xffffffff;
+    entry->stats.ibytes.high = rec_oct >> 32;
+    entry->stats.iall.high = rec_pkt >> 32;
+    entry->stats.imcast.high = rec_mcast >> 32;
+    entry->stats.obytes.high = snd_oct >> 32;
+    entry->stats.oucast.high = snd_pkt >> 32;
+    entry->stats.ierrors   = rec_err;
+    entry->stats.idiscards = rec_drop;
+    entry->stats.oerrors   = snd_err;
+    entry->stats.odiscards = snd_drop;
+    entry->stats.collisions = coll;
+    
+    /*
+     * calculated stats.
+     *
+     *  we have imcast, but not ibcast.
+     */
+    entry->stats.inucast = entry->stats.imcast.low +
+        entry->stats.ibcast.low;
+    entry->stats.onucast = entry->stats.omcast.low +
+        entry->stats.obcast.low;
+}
+
 /**
  * @internal
  */
@@ -504,60 +603,237 @@ _parse_stats(netsnmp_interface_entry *entry, char *stats, int expected)
                  expected, scan_count);
         return scan_count;
     }
-    entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_ACTIVE;
-    
+    _arch_interface_stats_set(entry, rec_oct, rec_pkt, rec_err, rec_drop,
+                              rec_mcast, snd_oct, snd_pkt, snd_err, snd_drop,
+                              coll);
+
+    return 0;
+}
+
+static int
+_speed_cache_compare(const void *lhs, const void *rhs)
+{
+    const if_speed_cache *l = (const if_speed_cache *) lhs;
+    const if_speed_cache *r = (const if_speed_cache *) rhs;
+
+    return (l->index < r->index) ? -1 : (l->index > r->index);
+}
+
+/**
+ * @internal
+ * get the speed of an interface, from the speed cache if possible
+ */
+static unsigned long long
+_arch_interface_speed_get(int fd, netsnmp_interface_entry *entry,
+                          unsigned long long defaultspeed)
+{
+    if_speed_cache  key, *sc;
+    u_int           state = entry->os_flags & (IFF_UP | IFF_RUNNING);
+    time_t          now = time(NULL);
+
+    key.index = entry->index;
+    sc = (if_speed_cache *) bsearch(&key, speed_cache, speed_cache_sorted,
+                                    sizeof(*sc), _speed_cache_compare);
+    if ((NULL != sc) && (sc->state == state) &&
+        (0 == strncmp(sc->name, entry->name, sizeof(sc->name))) &&
+        (sc->loaded <= now) && (now - sc->loaded < IF_SPEED_CACHE_TIMEOUT)) {
+        sc->generation = speed_cache_generation;
+        return sc->speed;
+    }
+
+    if (NULL == sc) {
+        if (speed_cache_count == speed_cache_size) {
+            size_t          size = speed_cache_size ? 2 * speed_cache_size : 64;
+            if_speed_cache *tmp;
+
+            tmp = (if_speed_cache *) realloc(speed_cache, size * sizeof(*tmp));
+            if (NULL == tmp)
+                return netsnmp_linux_interface_get_if_speed(fd, entry->name,
+                                                            defaultspeed);
+            speed_cache = tmp;
+            speed_cache_size = size;
+        }
+        sc = &speed_cache[speed_cache_count++];
+        sc->index = entry->index;
+    }
+
+    strlcpy(sc->name, entry->name, sizeof(sc->name));
+    sc->state = state;
+    sc->loaded = now;
+    sc->generation = speed_cache_generation;
+    sc->speed = netsnmp_linux_interface_get_if_speed(fd, entry->name,
+                                                     defaultspeed);
+    DEBUGMSGTL(("access:interface:speed", "%s: %llu\n", entry->name,
+                sc->speed));
+
+    return sc->speed;
+}
+
+/**
+ * @internal
+ * forget interfaces the last load didn't see, and sort the speed cache
+ * for the next one
+ */
+static void
+_speed_cache_sweep(void)
+{
+    size_t          i, count = 0;
+
+    for (i = 0; i < speed_cache_count; ++i)
+        if (speed_cache[i].generation == speed_cache_generation)
+            speed_cache[count++] = speed_cache[i];
+
+    if (count)
+        qsort(speed_cache, count, sizeof(*speed_cache), _speed_cache_compare);
+    speed_cache_count = speed_cache_sorted = count;
+    ++speed_cache_generation;
+}
+
+/**
+ * @internal
+ * fill in the parts of an entry which don't depend on where the
+ * basic interface data came from.
+ *
+ * name, index, physaddr, flags and mtu must already be set.
+ */
+static void
+_arch_interface_entry_setup(int fd, netsnmp_interface_entry *entry)
+{
     /*
-     * linux previous to 1.3.~13 may miss transmitted loopback pkts: 
+     * physaddr should have set type. make some guesses (based
+     * on name) if not.
      */
-    if (!strcmp(entry->name, "lo") && rec_pkt > 0 && !snd_pkt)
-        snd_pkt = rec_pkt;
-    
+    if(0 == entry->type) {
+        typedef struct _match_if {
+           int             mi_type;
+           const char     *mi_name;
+        }              *pmatch_if, match_if;
+
+        static match_if lmatch_if[] = {
+            {IANAIFTYPE_SOFTWARELOOPBACK, "lo"},
+            {IANAIFTYPE_ETHERNETCSMACD, "eth"},
+            {IANAIFTYPE_ETHERNETCSMACD, "vmnet"},
+            {IANAIFTYPE_ISO88025TOKENRING, "tr"},
+            {IANAIFTYPE_FASTETHER, "feth"},
+            {IANAIFTYPE_GIGABITETHERNET,"gig"},
+            {IANAIFTYPE_PPP, "ppp"},
+            {IANAIFTYPE_SLIP, "sl"},
+            {IANAIFTYPE_TUNNEL, "sit"},
+            {IANAIFTYPE_BASICISDN, "ippp"},
+            {IANAIFTYPE_PROPVIRTUAL, "bond"}, /* Bonding driver find fastest slave */
+            {IANAIFTYPE_PROPVIRTUAL, "vad"},  /* ANS driver - ?speed? */
+            {0, NULL}                  /* end of list */
+        };
+
+        int             len;
+        register pmatch_if pm;
+
+        for (pm = lmatch_if; pm->mi_name; pm++) {
+            len = strlen(pm->mi_name);
+            if (0 == strncmp(entry->name, pm->mi_name, len)) {
+                entry->type = pm->mi_type;
+                break;
+            }
+        }
+        if(NULL == pm->mi_name)
+            entry->type = IANAIFTYPE_OTHER;
+    }
+
     /*
-     * subtract out multicast packets from rec_pkt before
-     * we store it as unicast counter.
+     * interface identifier is specified based on physaddr and type
      */
-    entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_CALCULATE_UCAST;
-    entry->stats.ibytes.low = rec_oct & 0xffffffff;
-    entry->stats.iall.low = rec_pkt & 0xffffffff;
-    entry->stats.imcast.low = rec_mcast & 0xffffffff;
-    entry->stats.obytes.low = snd_oct & 0xffffffff;
-    entry->stats.oucast.low = snd_pkt & 0xffffffff;
-#ifdef SCNuMAX   /* XXX - should be flag for 64-bit variables */
-    entry->stats.ibytes.high = rec_oct >> 32;
-    entry->stats.iall.high = rec_pkt >> 32;
-    entry->stats.imcast.high = rec_mcast >> 32;
-    entry->stats.obytes.high = snd_oct >> 32;
-    entry->stats.oucast.high = snd_pkt >> 32;
+    switch (entry->type) {
+    case IANAIFTYPE_ETHERNETCSMACD:
+    case IANAIFTYPE_ETHERNET3MBIT:
+    case IANAIFTYPE_FASTETHER:
+    case IANAIFTYPE_FASTETHERFX:
+    case IANAIFTYPE_GIGABITETHERNET:
+    case IANAIFTYPE_FDDI:
+    case IANAIFTYPE_ISO88025TOKENRING:
+        if (NULL != entry->paddr && ETH_ALEN != entry->paddr_len)
+            break;
+
+        entry->v6_if_id_len = entry->paddr_len + 2;
+        memcpy(entry->v6_if_id, entry->paddr, 3);
+        memcpy(entry->v6_if_id + 5, entry->paddr + 3, 3);
+        entry->v6_if_id[0] ^= 2;
+        entry->v6_if_id[3] = 0xFF;
+        entry->v6_if_id[4] = 0xFE;
+
+        entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_V6_IFID;
+        break;
+
+    case IANAIFTYPE_SOFTWARELOOPBACK:
+        entry->v6_if_id_len = 0;
+        entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_V6_IFID;
+        break;
+    }
+
+    if (IANAIFTYPE_ETHERNETCSMACD == entry->type) {
+        unsigned long long speed;
+        unsigned long long defaultspeed = NOMINAL_LINK_SPEED;
+        if (!(entry->os_flags & IFF_RUNNING)) {
+            /*
+             * use speed 0 if the if speed cannot be determined *and* the
+             * interface is down
+             */
+            defaultspeed = 0;
+        }
+        speed = _arch_interface_speed_get(fd, entry, defaultspeed);
+        if (speed > 0xffffffffL) {
+            entry->speed = 0xffffffff;
+        } else
+            entry->speed = speed;
+        entry->speed_high = speed / 1000000LL;
+    }
+#ifdef APPLIED_PATCH_836390   /* xxx-rks ifspeed fixes */
+    else if (IANAIFTYPE_PROPVIRTUAL == entry->type)
+        entry->speed = _get_bonded_if_speed(entry);
 #endif
-    entry->stats.ierrors   = rec_err;
-    entry->stats.idiscards = rec_drop;
-    entry->stats.oerrors   = snd_err;
-    entry->stats.odiscards = snd_drop;
-    entry->stats.collisions = coll;
-    
+    else
+        netsnmp_access_interface_entry_guess_speed(entry);
+
     /*
-     * calculated stats.
-     *
-     *  we have imcast, but not ibcast.
+     * Zero speed means link problem.
+     * - i'm not sure this is always true...
      */
-    entry->stats.inucast = entry->stats.imcast.low +
-        entry->stats.ibcast.low;
-    entry->stats.onucast = entry->stats.omcast.low +
-        entry->stats.obcast.low;
-    
-    return 0;
+    if((entry->speed == 0) && (entry->os_flags & IFF_UP)) {
+        entry->os_flags &= ~IFF_RUNNING;
+    }
+
+    /*
+     * check for promiscuous mode.
+     *  NOTE: there are 2 ways to set promiscuous mode in Linux
+     *  (kernels later than 2.2.something) - using ioctls and
+     *  using setsockopt. The ioctl method tested here does not
+     *  detect if an interface was set using setsockopt. google
+     *  on IFF_PROMISC and linux to see lots of arguments about it.
+     */
+    if(entry->os_flags & IFF_PROMISC) {
+        entry->promiscuous = 1; /* boolean */
+    }
+
+    /*
+     * hardcoded max packet size
+     * (see ip_frag_reasm: if(len > 65535) goto out_oversize;)
+     */
+    entry->reasm_max_v4 = entry->reasm_max_v6 = 65535;
+    entry->ns_flags |=
+        NETSNMP_INTERFACE_FLAGS_HAS_V4_REASMMAX |
+        NETSNMP_INTERFACE_FLAGS_HAS_V6_REASMMAX;
+
+    netsnmp_access_interface_entry_overrides(entry);
 }
 
 /*
+ * load interfaces from /proc/net/dev, using ioctls for everything else
  *
  * @retval  0 success
- * @retval -1 no container specified
  * @retval -2 could not open /proc/net/dev
  * @retval -3 could not create entry (probably malloc)
  */
-int
-netsnmp_arch_interface_container_load(netsnmp_container* container,
-                                      u_int load_flags)
+static int
+_arch_interface_proc_load(netsnmp_container* container, u_int load_flags)
 {
     FILE           *devin;
     char            line[256];
@@ -568,14 +844,6 @@ netsnmp_arch_interface_container_load(netsnmp_container* container,
     netsnmp_container *addr_container;
 #endif
 
-    DEBUGMSGTL(("access:interface:container:arch", "load (flags %x)\n",
-                load_flags));
-
-    if (NULL == container) {
-        snmp_log(LOG_ERR, "no container specified/found for interface\n");
-        return -1;
-    }
-
     if (!(devin = fopen("/proc/net/dev", "r"))) {
         DEBUGMSGTL(("access:interface",
                     "Failed to load Interface Table (linux1)\n"));
@@ -589,6 +857,7 @@ netsnmp_arch_interface_container_load(netsnmp_container* container,
     fd = socket(AF_INET, SOCK_DGRAM, 0);
     if(fd < 0) {
         snmp_log(LOG_ERR, "could not create socket\n");
+        fclose(devin);
         return -2;
     }
 
@@ -710,135 +979,11 @@ netsnmp_arch_interface_container_load(netsnmp_container* container,
          */
         netsnmp_access_interface_ioctl_physaddr_get(fd, entry);
 
-        /*
-         * physaddr should have set type. make some guesses (based
-         * on name) if not.
-         */
-        if(0 == entry->type) {
-            typedef struct _match_if {
-               int             mi_type;
-               const char     *mi_name;
-            }              *pmatch_if, match_if;
-            
-            static match_if lmatch_if[] = {
-                {IANAIFTYPE_SOFTWARELOOPBACK, "lo"},
-                {IANAIFTYPE_ETHERNETCSMACD, "eth"},
-                {IANAIFTYPE_ETHERNETCSMACD, "vmnet"},
-                {IANAIFTYPE_ISO88025TOKENRING, "tr"},
-                {IANAIFTYPE_FASTETHER, "feth"},
-                {IANAIFTYPE_GIGABITETHERNET,"gig"},
-                {IANAIFTYPE_PPP, "ppp"},
-                {IANAIFTYPE_SLIP, "sl"},
-                {IANAIFTYPE_TUNNEL, "sit"},
-                {IANAIFTYPE_BASICISDN, "ippp"},
-                {IANAIFTYPE_PROPVIRTUAL, "bond"}, /* Bonding driver find fastest slave */
-                {IANAIFTYPE_PROPVIRTUAL, "vad"},  /* ANS driver - ?speed? */
-                {0, NULL}                  /* end of list */
-            };
-
-            int             len;
-            register pmatch_if pm;
-            
-            for (pm = lmatch_if; pm->mi_name; pm++) {
-                len = strlen(pm->mi_name);
-                if (0 == strncmp(entry->name, pm->mi_name, len)) {
-                    entry->type = pm->mi_type;
-                    break;
-                }
-            }
-            if(NULL == pm->mi_name)
-                entry->type = IANAIFTYPE_OTHER;
-        }
-
-        /*
-         * interface identifier is specified based on physaddr and type
-         */
-        switch (entry->type) {
-        case IANAIFTYPE_ETHERNETCSMACD:
-        case IANAIFTYPE_ETHERNET3MBIT:
-        case IANAIFTYPE_FASTETHER:
-        case IANAIFTYPE_FASTETHERFX:
-        case IANAIFTYPE_GIGABITETHERNET:
-        case IANAIFTYPE_FDDI:
-        case IANAIFTYPE_ISO88025TOKENRING:
-            if (NULL != entry->paddr && ETH_ALEN != entry->paddr_len)
-                break;
-
-            entry->v6_if_id_len = entry->paddr_len + 2;
-            memcpy(entry->v6_if_id, entry->paddr, 3);
-            memcpy(entry->v6_if_id + 5, entry->paddr + 3, 3);
-            entry->v6_if_id[0] ^= 2;
-            entry->v6_if_id[3] = 0xFF;
-            entry->v6_if_id[4] = 0xFE;
-
-            entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_V6_IFID;
-            break;
-
-        case IANAIFTYPE_SOFTWARELOOPBACK:
-            entry->v6_if_id_len = 0;
-            entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_V6_IFID;
-            break;
-        }
-
-        if (IANAIFTYPE_ETHERNETCSMACD == entry->type) {
-            unsigned long long speed;
-            unsigned long long defaultspeed = NOMINAL_LINK_SPEED;
-            if (!(entry->os_flags & IFF_RUNNING)) {
-                /*
-                 * use speed 0 if the if speed cannot be determined *and* the
-                 * interface is down
-                 */
-                defaultspeed = 0;
-            }
-            speed = netsnmp_linux_interface_get_if_speed(fd,
-                    entry->name, defaultspeed);
-            if (speed > 0xffffffffL) {
-                entry->speed = 0xffffffff;
-            } else
-                entry->speed = speed;
-            entry->speed_high = speed / 1000000LL;
-        }
-#ifdef APPLIED_PATCH_836390   /* xxx-rks ifspeed fixes */
-        else if (IANAIFTYPE_PROPVIRTUAL == entry->type)
-            entry->speed = _get_bonded_if_speed(entry);
-#endif
-        else
-            netsnmp_access_interface_entry_guess_speed(entry);
-        
         netsnmp_access_interface_ioctl_flags_get(fd, entry);
 
         netsnmp_access_interface_ioctl_mtu_get(fd, entry);
 
-        /*
-         * Zero speed means link problem.
-         * - i'm not sure this is always true...
-         */
-        if((entry->speed == 0) && (entry->os_flags & IFF_UP)) {
-            entry->os_flags &= ~IFF_RUNNING;
-        }
-
-        /*
-         * check for promiscuous mode.
-         *  NOTE: there are 2 ways to set promiscuous mode in Linux
-         *  (kernels later than 2.2.something) - using ioctls and
-         *  using setsockopt. The ioctl method tested here does not
-         *  detect if an interface was set using setsockopt. google
-         *  on IFF_PROMISC and linux to see lots of arguments about it.
-         */
-        if(entry->os_flags & IFF_PROMISC) {
-            entry->promiscuous = 1; /* boolean */
-        }
-
-        /*
-         * hardcoded max packet size
-         * (see ip_frag_reasm: if(len > 65535) goto out_oversize;)
-         */
-        entry->reasm_max_v4 = entry->reasm_max_v6 = 65535;
-        entry->ns_flags |= 
-            NETSNMP_INTERFACE_FLAGS_HAS_V4_REASMMAX |
-            NETSNMP_INTERFACE_FLAGS_HAS_V6_REASMMAX;
-
-        netsnmp_access_interface_entry_overrides(entry);
+        _arch_interface_entry_setup(fd, entry);
 
         if (! (load_flags & NETSNMP_ACCESS_INTERFACE_LOAD_NO_STATS))
             _parse_stats(entry, stats, scan_expected);
@@ -864,6 +1009,792 @@ netsnmp_arch_interface_container_load(netsnmp_container* container,
     return 0;
 }
 
+#ifdef HAVE_LINUX_RTNETLINK_H
+/*
+ * netlink loader.
+ *
+ * Three NETLINK_ROUTE dumps replace the per interface work of the /proc
+ * loader: RTM_GETADDR tells which interfaces have ipv4/ipv6 addresses,
+ * RTM_GETNEIGHTBL has the per interface neighbour timers, and
+ * RTM_GETLINK has everything else, including 64 bit counters.  Only
+ * ifSpeed still needs an ioctl, and that is cached.
+ */
+
+/*
+ * the first entry of IFLA_INET6_CONF (DEVCONF_FORWARDING in linux/ipv6.h)
+ */
+#define IF_NL_INET6_CONF_FORWARDING 0
+
+/*
+ * what the address and neighbour table dumps found for an ifIndex
+ */
+typedef struct _if_nl_info {
+    int             index;
+    u_int           flags;          /* NETSNMP_INTERFACE_FLAGS_HAS_xxx */
+    u_int           retransmit_v4;  /* milliseconds */
+    u_int           retransmit_v6;  /* milliseconds */
+    u_int           reachable_time; /* ipv6 / milliseconds */
+} if_nl_info;
+
+typedef struct _if_nl_load {
+    netsnmp_container *container;
+    u_int           load_flags;
+    int             fd;             /* for ioctls */
+    if_nl_info     *info;
+    size_t          info_count;
+    size_t          info_size;
+    int             rc;
+} if_nl_load;
+
+typedef int (_if_nl_dump_cb)(struct nlmsghdr *h, if_nl_load *load);
+
+/*
+ * what the last successful load found, for link change notifications
+ */
+static if_nl_info *_nl_info_last = NULL;
+static size_t   _nl_info_last_count = 0;
+
+/*
+ * link change notifications
+ */
+static int      _nl_changes_fd = -1;
+static NetsnmpAccessInterfaceChange *_nl_changes_hook = NULL;
+static void    *_nl_changes_ctx = NULL;
+
+/**
+ * @internal
+ * send a NETLINK_ROUTE dump request, and pass each reply to a callback
+ *
+ * @retval  0 : success
+ * @retval -1 : netlink error, or the callback gave up
+ */
+static int
+_nl_dump(int nlfd, int type, size_t hdrlen, _if_nl_dump_cb *cb,
+         if_nl_load *load)
+{
+    static __u32    seq = 0;
+    union {
+        struct nlmsghdr n;
+        char            buf[32768];
+    } u;
+    struct nlmsghdr *h;
+    int             len;
+
+    memset(&u.n, 0, NLMSG_SPACE(hdrlen));
+    u.n.nlmsg_len = NLMSG_LENGTH(hdrlen);
+    u.n.nlmsg_type = type;
+    u.n.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    u.n.nlmsg_seq = ++seq;
+    ((struct rtgenmsg *) NLMSG_DATA(&u.n))->rtgen_family = AF_UNSPEC;
+
+    if (send(nlfd, &u.n, u.n.nlmsg_len, 0) < 0) {
+        DEBUGMSGTL(("access:interface:netlink", "send %d failed: %s\n",
+                    type, strerror(errno)));
+        return -1;
+    }
+
+    for (;;) {
+        len = recv(nlfd, u.buf, sizeof(u.buf), MSG_TRUNC);
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            DEBUGMSGTL(("access:interface:netlink", "recv %d failed: %s\n",
+                        type, strerror(errno)));
+            return -1;
+        }
+        if (len == 0 || len > (int) sizeof(u.buf)) {
+            DEBUGMSGTL(("access:interface:netlink",
+                        "bad reply length %d to %d\n", len, type));
+            return -1;
+        }
+
+        for (h = &u.n; NLMSG_OK(h, len); h = NLMSG_NEXT(h, len)) {
+            if (h->nlmsg_seq != seq)
+                continue;
+            if (h->nlmsg_type == NLMSG_DONE)
+                return 0;
+            if (h->nlmsg_type == NLMSG_ERROR) {
+                DEBUGMSGTL(("access:interface:netlink",
+                            "dump %d failed\n", type));
+                return -1;
+            }
+#ifdef NLM_F_DUMP_INTR
+            if (h->nlmsg_flags & NLM_F_DUMP_INTR)
+                DEBUGMSGTL(("access:interface:netlink",
+                            "dump %d interrupted by a change\n", type));
+#endif
+            if (cb(h, load) < 0)
+                return -1;
+        }
+    }
+}
+
+/**
+ * @internal
+ * remember something about an ifIndex
+ */
+static if_nl_info *
+_nl_info_add(if_nl_load *load, int index)
+{
+    if_nl_info     *info;
+
+    if (load->info_count == load->info_size) {
+        size_t          size = load->info_size ? 2 * load->info_size : 256;
+
+        info = (if_nl_info *) realloc(load->info, size * sizeof(*info));
+        if (NULL == info)
+            return NULL;
+        load->info = info;
+        load->info_size = size;
+    }
+
+    info = &load->info[load->info_count++];
+    memset(info, 0, sizeof(*info));
+    info->index = index;
+
+    return info;
+}
+
+static int
+_nl_info_compare(const void *lhs, const void *rhs)
+{
+    const if_nl_info *l = (const if_nl_info *) lhs;
+    const if_nl_info *r = (const if_nl_info *) rhs;
+
+    return (l->index < r->index) ? -1 : (l->index > r->index);
+}
+
+/**
+ * @internal
+ * sort what the dumps found by ifIndex, and merge it into one record
+ * per interface
+ */
+static void
+_nl_info_merge(if_nl_load *load)
+{
+    size_t          i, count = 0;
+    if_nl_info     *to, *from;
+
+    if (0 == load->info_count)
+        return;
+
+    qsort(load->info, load->info_count, sizeof(*load->info),
+          _nl_info_compare);
+
+    for (i = 1; i < load->info_count; ++i) {
+        to = &load->info[count];
+        from = &load->info[i];
+        if (to->index != from->index) {
+            load->info[++count] = *from;
+            continue;
+        }
+        to->flags |= from->flags;
+        if (from->flags & NETSNMP_INTERFACE_FLAGS_HAS_V4_RETRANSMIT)
+            to->retransmit_v4 = from->retransmit_v4;
+        if (from->flags & NETSNMP_INTERFACE_FLAGS_HAS_V6_RETRANSMIT)
+            to->retransmit_v6 = from->retransmit_v6;
+        if (from->flags & NETSNMP_INTERFACE_FLAGS_HAS_V6_REACHABLE)
+            to->reachable_time = from->reachable_time;
+    }
+    load->info_count = count + 1;
+}
+
+static int
+_nl_addr_cb(struct nlmsghdr *h, if_nl_load *load)
+{
+    struct ifaddrmsg *ifa = (struct ifaddrmsg *) NLMSG_DATA(h);
+    if_nl_info     *info;
+    u_int           flags;
+
+    if (h->nlmsg_type != RTM_NEWADDR ||
+        h->nlmsg_len < NLMSG_LENGTH(sizeof(*ifa)))
+        return 0;
+
+    if (AF_INET == ifa->ifa_family)
+        flags = NETSNMP_INTERFACE_FLAGS_HAS_IPV4;
+#ifdef NETSNMP_ENABLE_IPV6
+    else if (AF_INET6 == ifa->ifa_family)
+        flags = NETSNMP_INTERFACE_FLAGS_HAS_IPV6;
+#endif
+    else
+        return 0;
+
+    /*
+     * addresses of an interface usually arrive together
+     */
+    if (load->info_count &&
+        load->info[load->info_count - 1].index == (int) ifa->ifa_index)
+        info = &load->info[load->info_count - 1];
+    else if (NULL == (info = _nl_info_add(load, ifa->ifa_index)))
+        return -1;
+    info->flags |= flags;
+
+    return 0;
+}
+
+static int
+_nl_neightbl_cb(struct nlmsghdr *h, if_nl_load *load)
+{
+    struct ndtmsg  *ndtm = (struct ndtmsg *) NLMSG_DATA(h);
+    struct rtattr  *tb[NDTPA_MAX + 1], *rta;
+    if_nl_info     *info;
+    __u64           msec;
+    int             len;
+
+    if (h->nlmsg_type != RTM_NEWNEIGHTBL)
+        return 0;
+    if (AF_INET != ndtm->ndtm_family
+#ifdef NETSNMP_ENABLE_IPV6
+        && AF_INET6 != ndtm->ndtm_family
+#endif
+        )
+        return 0;
+
+    /*
+     * find the NDTA_PARMS attribute ...
+     */
+    len = h->nlmsg_len - NLMSG_LENGTH(sizeof(*ndtm));
+    rta = (struct rtattr *) (((char *) ndtm) + NLMSG_ALIGN(sizeof(*ndtm)));
+    while (RTA_OK(rta, len) && rta->rta_type != NDTA_PARMS)
+        rta = RTA_NEXT(rta, len);
+    if (!RTA_OK(rta, len))
+        return 0;
+
+    /*
+     * ... and the timers in it. The table defaults have no ifindex.
+     */
+    memset(tb, 0, sizeof(tb));
+    len = RTA_PAYLOAD(rta);
+    for (rta = (struct rtattr *) RTA_DATA(rta); RTA_OK(rta, len);
+         rta = RTA_NEXT(rta, len))
+        if (rta->rta_type <= NDTPA_MAX)
+            tb[rta->rta_type] = rta;
+    if (NULL == tb[NDTPA_IFINDEX])
+        return 0;
+
+    info = _nl_info_add(load, *(__u32 *) RTA_DATA(tb[NDTPA_IFINDEX]));
+    if (NULL == info)
+        return -1;
+
+    if (tb[NDTPA_RETRANS_TIME]) {
+        memcpy(&msec, RTA_DATA(tb[NDTPA_RETRANS_TIME]), sizeof(msec));
+        if (AF_INET == ndtm->ndtm_family) {
+            info->retransmit_v4 = msec;
+            info->flags |= NETSNMP_INTERFACE_FLAGS_HAS_V4_RETRANSMIT;
+        } else {
+            info->retransmit_v6 = msec;
+            info->flags |= NETSNMP_INTERFACE_FLAGS_HAS_V6_RETRANSMIT;
+        }
+    }
+    if (tb[NDTPA_BASE_REACHABLE_TIME] && AF_INET6 == ndtm->ndtm_family) {
+        memcpy(&msec, RTA_DATA(tb[NDTPA_BASE_REACHABLE_TIME]), sizeof(msec));
+        info->reachable_time = msec;
+        info->flags |= NETSNMP_INTERFACE_FLAGS_HAS_V6_REACHABLE;
+    }
+
+    return 0;
+}
+
+/**
+ * @internal
+ * build an interface entry from an RTM_NEWLINK message
+ *
+ * @retval  1 : *entryp is a new entry
+ * @retval  0 : message skipped
+ * @retval -1 : could not create entry (load->rc is set)
+ */
+static int
+_nl_link_entry(struct nlmsghdr *h, if_nl_load *load,
+               netsnmp_interface_entry **entryp)
+{
+    struct ifinfomsg *ifi = (struct ifinfomsg *) NLMSG_DATA(h);
+    struct rtattr  *tb[IFLA_MAX + 1], *rta;
+    netsnmp_interface_entry *entry;
+    if_nl_info      key, *info;
+    u_int           flags = 0, len;
+    int             rtalen;
+
+    /*
+     * bridge port messages are AF_BRIDGE, and only carry part of the
+     * link
+     */
+    if (h->nlmsg_type != RTM_NEWLINK ||
+        h->nlmsg_len < NLMSG_LENGTH(sizeof(*ifi)) ||
+        ifi->ifi_family != AF_UNSPEC)
+        return 0;
+
+    memset(tb, 0, sizeof(tb));
+    rtalen = h->nlmsg_len - NLMSG_LENGTH(sizeof(*ifi));
+    for (rta = IFLA_RTA(ifi); RTA_OK(rta, rtalen); rta = RTA_NEXT(rta, rtalen))
+        if (rta->rta_type <= IFLA_MAX)
+            tb[rta->rta_type] = rta;
+    if (NULL == tb[IFLA_IFNAME])
+        return 0;
+
+    DEBUGMSGTL(("9:access:ifcontainer", "processing '%s'\n",
+                (char *) RTA_DATA(tb[IFLA_IFNAME])));
+
+    key.index = ifi->ifi_index;
+    info = (if_nl_info *) bsearch(&key, load->info, load->info_count,
+                                  sizeof(key), _nl_info_compare);
+    if (NULL != info)
+        flags = info->flags & (NETSNMP_INTERFACE_FLAGS_HAS_IPV4 |
+                               NETSNMP_INTERFACE_FLAGS_HAS_IPV6);
+
+    /*
+     * do we only want one address type?
+     */
+    if (((load->load_flags & NETSNMP_ACCESS_INTERFACE_LOAD_IP4_ONLY) &&
+         ((flags & NETSNMP_INTERFACE_FLAGS_HAS_IPV4) == 0)) ||
+        ((load->load_flags & NETSNMP_ACCESS_INTERFACE_LOAD_IP6_ONLY) &&
+         ((flags & NETSNMP_INTERFACE_FLAGS_HAS_IPV6) == 0))) {
+        DEBUGMSGTL(("9:access:ifcontainer",
+                    "interface '%s' excluded by ip version\n",
+                    (char *) RTA_DATA(tb[IFLA_IFNAME])));
+        return 0;
+    }
+
+    entry = netsnmp_access_interface_entry_create(RTA_DATA(tb[IFLA_IFNAME]),
+                                                  ifi->ifi_index);
+    if (NULL == entry) {
+        load->rc = -3;
+        return -1;
+    }
+    entry->ns_flags = flags; /* initial flags; we'll set more later */
+
+#ifdef HAVE_PCI_LOOKUP_NAME
+    _arch_interface_description_get(entry);
+#endif
+
+    /*
+     * keep the view SIOCGIFHWADDR gives: always IFHWADDRLEN bytes,
+     * zero filled or truncated as needed.
+     */
+    entry->paddr = (char *) calloc(1, IFHWADDRLEN);
+    if (NULL != entry->paddr) {
+        entry->paddr_len = IFHWADDRLEN;
+        if (NULL != tb[IFLA_ADDRESS]) {
+            len = RTA_PAYLOAD(tb[IFLA_ADDRESS]);
+            memcpy(entry->paddr, RTA_DATA(tb[IFLA_ADDRESS]),
+                   len < IFHWADDRLEN ? len : IFHWADDRLEN);
+        }
+    }
+    entry->type = netsnmp_access_interface_ioctl_arphrd_to_type(ifi->ifi_type);
+
+    /*
+     * SIOCGIFFLAGS only has the low 16 bits of the device flags
+     */
+    entry->os_flags = ifi->ifi_flags & 0xffff;
+    entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_IF_FLAGS;
+    if (entry->os_flags & IFF_UP) {
+        entry->admin_status = IFADMINSTATUS_UP;
+        if (entry->os_flags & IFF_RUNNING)
+            entry->oper_status = IFOPERSTATUS_UP;
+        else
+            entry->oper_status = IFOPERSTATUS_DOWN;
+    } else {
+        entry->admin_status = IFADMINSTATUS_DOWN;
+        entry->oper_status = IFOPERSTATUS_DOWN;
+    }
+    entry->connector_present = (entry->os_flags & IFF_LOOPBACK) ? 0 : 1;
+
+    if (NULL != tb[IFLA_MTU])
+        entry->mtu = *(__u32 *) RTA_DATA(tb[IFLA_MTU]);
+
+    _arch_interface_entry_setup(load->fd, entry);
+
+    if (! (load->load_flags & NETSNMP_ACCESS_INTERFACE_LOAD_NO_STATS)) {
+        if (NULL != tb[IFLA_STATS64]) {
+            struct rtnl_link_stats64 st;
+
+            memset(&st, 0, sizeof(st));
+            len = RTA_PAYLOAD(tb[IFLA_STATS64]);
+            memcpy(&st, RTA_DATA(tb[IFLA_STATS64]),
+                   len < sizeof(st) ? len : sizeof(st));
+            entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_HIGH_BYTES |
+                NETSNMP_INTERFACE_FLAGS_HAS_HIGH_PACKETS;
+            _arch_interface_stats_set(entry, st.rx_bytes, st.rx_packets,
+                                      st.rx_errors,
+                                      st.rx_dropped + st.rx_missed_errors,
+                                      st.multicast, st.tx_bytes,
+                                      st.tx_packets, st.tx_errors,
+                                      st.tx_dropped, st.collisions);
+        } else if (NULL != tb[IFLA_STATS]) {
+            struct rtnl_link_stats st;
+
+            memset(&st, 0, sizeof(st));
+            len = RTA_PAYLOAD(tb[IFLA_STATS]);
+            memcpy(&st, RTA_DATA(tb[IFLA_STATS]),
+                   len < sizeof(st) ? len : sizeof(st));
+            _arch_interface_stats_set(entry, st.rx_bytes, st.rx_packets,
+                                      st.rx_errors,
+                                      st.rx_dropped + st.rx_missed_errors,
+                                      st.multicast, st.tx_bytes,
+                                      st.tx_packets, st.tx_errors,
+                                      st.tx_dropped, st.collisions);
+        }
+        if (entry->ns_flags & NETSNMP_INTERFACE_FLAGS_ACTIVE)
+            entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_BYTES |
+                NETSNMP_INTERFACE_FLAGS_HAS_DROPS |
+                NETSNMP_INTERFACE_FLAGS_HAS_MCAST_PKTS |
+                NETSNMP_INTERFACE_FLAGS_HAS_HIGH_SPEED;
+    }
+
+    if (flags & NETSNMP_INTERFACE_FLAGS_HAS_IPV4) {
+        if (info->flags & NETSNMP_INTERFACE_FLAGS_HAS_V4_RETRANSMIT) {
+            entry->retransmit_v4 = info->retransmit_v4;
+            entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_V4_RETRANSMIT;
+        } else
+            _arch_interface_flags_v4_get(entry);
+    }
+
+#ifdef NETSNMP_ENABLE_IPV6
+    if (flags & NETSNMP_INTERFACE_FLAGS_HAS_IPV6) {
+        int             forwarding_v6 = -1;
+
+        if (NULL != tb[IFLA_AF_SPEC]) {
+            struct rtattr  *af, *conf;
+            int             aflen = RTA_PAYLOAD(tb[IFLA_AF_SPEC]), clen;
+
+            for (af = (struct rtattr *) RTA_DATA(tb[IFLA_AF_SPEC]);
+                 RTA_OK(af, aflen); af = RTA_NEXT(af, aflen)) {
+                if (af->rta_type != AF_INET6)
+                    continue;
+                clen = RTA_PAYLOAD(af);
+                for (conf = (struct rtattr *) RTA_DATA(af); RTA_OK(conf, clen);
+                     conf = RTA_NEXT(conf, clen))
+                    if (conf->rta_type == IFLA_INET6_CONF &&
+                        RTA_PAYLOAD(conf) >= sizeof(__s32) *
+                        (IF_NL_INET6_CONF_FORWARDING + 1))
+                        forwarding_v6 = ((__s32 *) RTA_DATA(conf))
+                            [IF_NL_INET6_CONF_FORWARDING];
+            }
+        }
+        if ((forwarding_v6 >= 0) &&
+            (info->flags & NETSNMP_INTERFACE_FLAGS_HAS_V6_RETRANSMIT) &&
+            (info->flags & NETSNMP_INTERFACE_FLAGS_HAS_V6_REACHABLE)) {
+            entry->forwarding_v6 = forwarding_v6;
+            entry->retransmit_v6 = info->retransmit_v6;
+            entry->reachable_time = info->reachable_time;
+            entry->ns_flags |= NETSNMP_INTERFACE_FLAGS_HAS_V6_FORWARDING |
+                NETSNMP_INTERFACE_FLAGS_HAS_V6_RETRANSMIT |
+                NETSNMP_INTERFACE_FLAGS_HAS_V6_REACHABLE;
+        } else
+            _arch_interface_flags_v6_get(entry);
+    }
+#endif /* NETSNMP_ENABLE_IPV6 */
+
+    *entryp = entry;
+    return 1;
+}
+
+static int
+_nl_link_cb(struct nlmsghdr *h, if_nl_load *load)
+{
+    netsnmp_interface_entry *entry;
+    int             rc;
+
+    rc = _nl_link_entry(h, load, &entry);
+    if (rc <= 0)
+        return rc;
+
+    /*
+     * add to container
+     */
+    CONTAINER_INSERT(load->container, entry);
+
+    return 0;
+}
+
+static void
+_nl_entry_release(netsnmp_interface_entry *entry, void *unused)
+{
+    netsnmp_access_interface_entry_free(entry);
+}
+
+/*
+ * load interfaces using NETLINK_ROUTE dumps
+ *
+ * @retval  0 success
+ * @retval -2 netlink isn't usable (the container is left empty)
+ * @retval -3 could not create entry (probably malloc)
+ */
+static int
+_arch_interface_netlink_load(netsnmp_container* container, u_int load_flags)
+{
+    if_nl_load      load;
+    int             nlfd;
+
+    nlfd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+    if (nlfd < 0) {
+        DEBUGMSGTL(("access:interface:netlink", "socket failed: %s\n",
+                    strerror(errno)));
+        return -2;
+    }
+
+    memset(&load, 0, sizeof(load));
+    load.container = container;
+    load.load_flags = load_flags;
+    load.rc = -2;
+
+    /*
+     * create socket for ioctls
+     */
+    load.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (load.fd < 0) {
+        snmp_log(LOG_ERR, "could not create socket\n");
+        close(nlfd);
+        return -2;
+    }
+
+    /*
+     * missing neighbour timers are read from /proc/sys instead, so
+     * only the address and link dumps have to work.
+     */
+    if (_nl_dump(nlfd, RTM_GETADDR, sizeof(struct ifaddrmsg),
+                 _nl_addr_cb, &load) < 0)
+        goto out;
+    if (_nl_dump(nlfd, RTM_GETNEIGHTBL, sizeof(struct ndtmsg),
+                 _nl_neightbl_cb, &load) < 0)
+        DEBUGMSGTL(("access:interface:netlink",
+                    "no neighbour tables, using /proc/sys\n"));
+    _nl_info_merge(&load);
+
+    if (_nl_dump(nlfd, RTM_GETLINK, sizeof(struct ifinfomsg),
+                 _nl_link_cb, &load) < 0) {
+        CONTAINER_CLEAR(container,
+                        (netsnmp_container_obj_func *) _nl_entry_release,
+                        NULL);
+        goto out;
+    }
+    load.rc = 0;
+
+    free(_nl_info_last);
+    _nl_info_last = load.info;
+    _nl_info_last_count = load.info_count;
+    load.info = NULL;
+
+  out:
+    free(load.info);
+    close(load.fd);
+    close(nlfd);
+    return load.rc;
+}
+
+/**
+ * @internal
+ * read RTNLGRP_LINK notifications, and pass them on to the hook
+ */
+static void
+_nl_changes_read(int nlfd, void *unused)
+{
+    union {
+        struct nlmsghdr n;
+        char            buf[32768];
+    } u;
+    struct sockaddr_nl sa;
+    socklen_t       salen;
+    struct nlmsghdr *h;
+    struct ifinfomsg *ifi;
+    struct rtattr  *rta;
+    netsnmp_interface_entry *entry;
+    if_nl_load      load;
+    int             len, rtalen;
+
+    /*
+     * address and neighbour table changes aren't subscribed to; use
+     * what the last load found.
+     */
+    memset(&load, 0, sizeof(load));
+    load.info = _nl_info_last;
+    load.info_count = _nl_info_last_count;
+    load.fd = -1;
+
+    for (;;) {
+        salen = sizeof(sa);
+        len = recvfrom(nlfd, u.buf, sizeof(u.buf), MSG_DONTWAIT,
+                       (struct sockaddr *) &sa, &salen);
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == ENOBUFS) {
+                /*
+                 * the socket overran, and changes were lost
+                 */
+                DEBUGMSGTL(("access:interface:netlink",
+                            "link notifications lost\n"));
+                _nl_changes_hook(NETSNMP_ACCESS_INTERFACE_CHANGE_RESYNC,
+                                 NULL, _nl_changes_ctx);
+                /*
+                 * in case the hook reloaded, which replaces the info
+                 */
+                load.info = _nl_info_last;
+                load.info_count = _nl_info_last_count;
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                DEBUGMSGTL(("access:interface:netlink",
+                            "link notification recv failed: %s\n",
+                            strerror(errno)));
+            break;
+        }
+        if (sa.nl_pid != 0)
+            continue;               /* only the kernel is believed */
+
+        for (h = &u.n; NLMSG_OK(h, len); h = NLMSG_NEXT(h, len)) {
+            if (h->nlmsg_type == RTM_NEWLINK) {
+                if (load.fd < 0)
+                    load.fd = socket(AF_INET, SOCK_DGRAM, 0);
+                if (_nl_link_entry(h, &load, &entry) > 0) {
+                    DEBUGMSGTL(("access:interface:netlink",
+                                "link %s changed\n", entry->name));
+                    _nl_changes_hook(NETSNMP_ACCESS_INTERFACE_CHANGE_UPDATE,
+                                     entry, _nl_changes_ctx);
+                }
+                continue;
+            }
+
+            ifi = (struct ifinfomsg *) NLMSG_DATA(h);
+            if (h->nlmsg_type != RTM_DELLINK ||
+                h->nlmsg_len < NLMSG_LENGTH(sizeof(*ifi)) ||
+                ifi->ifi_family != AF_UNSPEC)
+                continue;
+            rtalen = h->nlmsg_len - NLMSG_LENGTH(sizeof(*ifi));
+            for (rta = IFLA_RTA(ifi); RTA_OK(rta, rtalen);
+                 rta = RTA_NEXT(rta, rtalen))
+                if (rta->rta_type == IFLA_IFNAME)
+                    break;
+            if (!RTA_OK(rta, rtalen))
+                continue;
+            entry = netsnmp_access_interface_entry_create(RTA_DATA(rta),
+                                                          ifi->ifi_index);
+            if (NULL == entry)
+                continue;
+            DEBUGMSGTL(("access:interface:netlink",
+                        "link %s removed\n", entry->name));
+            _nl_changes_hook(NETSNMP_ACCESS_INTERFACE_CHANGE_DELETE,
+                             entry, _nl_changes_ctx);
+        }
+    }
+
+    if (load.fd >= 0)
+        close(load.fd);
+}
+
+/*
+ * subscribe to RTNLGRP_LINK
+ *
+ * @retval  0 success
+ * @retval -1 netlink isn't usable, or isn't the interface loader
+ */
+int
+netsnmp_arch_interface_changes_start(NetsnmpAccessInterfaceChange *hook,
+                                     void *ctx)
+{
+    struct sockaddr_nl sa;
+    int             fd, rcvbuf = 262144;
+
+    /*
+     * notifications have to look like what the loader returns
+     */
+    if (!interface_use_netlink) {
+        snmp_log(LOG_WARNING, "interface change notifications need "
+                 "\"interface_netlink yes\"\n");
+        return -1;
+    }
+
+    _nl_changes_hook = hook;
+    _nl_changes_ctx = ctx;
+    if (_nl_changes_fd >= 0)
+        return 0;
+
+    fd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+    if (fd < 0) {
+        snmp_log(LOG_ERR, "interface changes: netlink socket create "
+                 "error\n");
+        return -1;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+    sa.nl_groups = RTMGRP_LINK;
+    if (bind(fd, (struct sockaddr *) &sa, sizeof(sa)) < 0) {
+        snmp_log(LOG_ERR, "interface changes: netlink bind failed\n");
+        close(fd);
+        return -1;
+    }
+
+    /*
+     * a burst of changes shouldn't overrun the socket before the
+     * agent gets to read it; losing changes costs a full reload.
+     */
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) < 0)
+        DEBUGMSGTL(("access:interface:netlink", "SO_RCVBUF failed: %s\n",
+                    strerror(errno)));
+
+    if (register_readfd(fd, _nl_changes_read, NULL) != 0) {
+        snmp_log(LOG_ERR, "interface changes: error registering netlink "
+                 "socket\n");
+        close(fd);
+        return -1;
+    }
+    _nl_changes_fd = fd;
+
+    DEBUGMSGTL(("access:interface:netlink", "watching link changes\n"));
+    return 0;
+}
+
+void
+netsnmp_arch_interface_changes_stop(void)
+{
+    if (_nl_changes_fd < 0)
+        return;
+
+    unregister_readfd(_nl_changes_fd);
+    close(_nl_changes_fd);
+    _nl_changes_fd = -1;
+    _nl_changes_hook = NULL;
+    _nl_changes_ctx = NULL;
+}
+#endif /* HAVE_LINUX_RTNETLINK_H */
+
+/*
+ *
+ * @retval  0 success
+ * @retval -1 no container specified
+ * @retval -2 could not open /proc/net/dev
+ * @retval -3 could not create entry (probably malloc)
+ */
+int
+netsnmp_arch_interface_container_load(netsnmp_container* container,
+                                      u_int load_flags)
+{
+    int             rc = -2;
+
+    DEBUGMSGTL(("access:interface:container:arch", "load (flags %x)\n",
+                load_flags));
+
+    if (NULL == container) {
+        snmp_log(LOG_ERR, "no container specified/found for interface\n");
+        return -1;
+    }
+
+#ifdef HAVE_LINUX_RTNETLINK_H
+    if (interface_use_netlink) {
+        rc = _arch_interface_netlink_load(container, load_flags);
+        if (-2 == rc)
+            NETSNMP_LOGONCE((LOG_WARNING, "netlink interface dump failed, "
+                             "falling back to /proc/net/dev\n"));
+    }
+#endif
+    if (-2 == rc)
+        rc = _arch_interface_proc_load(container, load_flags);
+
+    _speed_cache_sweep();
+
+    return rc;
+}
+
 #ifndef NETSNMP_FEATURE_REMOVE_INTERFACE_ARCH_SET_ADMIN_STATUS
 int
 netsnmp_arch_set_admin_status(netsnmp_interface_entry * entry,
@@ -49,10 +49,25 @@ static int fadeout = IFTABLE_REMOVE_MISSING_AFTER;
  * Value of interface_replace_old config option
  */
 static int replace_old = 0;
+/*
+ * Value of interface_events config option, and whether the
+ * notifications are running
+ */
+static int events = 0;
+static int events_started = 0;
+
+static netsnmp_cache *ifTable_cache = NULL;
 
 static void
 _delete_missing_interface(ifTable_rowreq_ctx *rowreq_ctx,
                           netsnmp_container *container);
+static void
+_add_new_interface(netsnmp_interface_entry *ifentry,
+                   netsnmp_container *container);
+static void
+_update_interface_entry(ifTable_rowreq_ctx * rowreq_ctx,
+                        netsnmp_interface_entry *ifentry,
+                        cd_container *cdc);
 
 /** @ingroup interface 
  * @defgroup data_access data_access: Routines to access data
@@ -81,24 +96,126 @@ parse_interface_fadeout(const char *token, char *line)
     fadeout = atoi(line);
 }
 static void
-parse_interface_replace_old(const char *token, char *line)
+parse_interface_yes_no(const char *token, char *line, int *value)
 {
     if (strcmp(line, "yes") == 0
             || strcmp(line, "y") == 0
             || strcmp(line, "true") == 0
             || strcmp(line, "1") == 0) {
-        replace_old = 1;
+        *value = 1;
         return;
     }
     if (strcmp(line, "no") == 0
             || strcmp(line, "n") == 0
             || strcmp(line, "false") == 0
             || strcmp(line, "0") == 0) {
-        replace_old = 0;
+        *value = 0;
         return;
     }
-    snmp_log(LOG_ERR, "Invalid value of interface_replace_old parameter: '%s'\n",
-            line);
+    snmp_log(LOG_ERR, "Invalid value of %s parameter: '%s'\n",
+            token, line);
+}
+static void
+parse_interface_replace_old(const char *token, char *line)
+{
+    parse_interface_yes_no(token, line, &replace_old);
+}
+static void
+parse_interface_events(const char *token, char *line)
+{
+    parse_interface_yes_no(token, line, &events);
+}
+
+/**
+ * apply an interface change notification to the container in place
+ */
+static void
+_interface_change(int change, netsnmp_interface_entry *ifentry, void *ctx)
+{
+    ifTable_rowreq_ctx *rowreq_ctx;
+    netsnmp_container *container;
+    cd_container cdc;
+
+    DEBUGMSGTL(("ifTable:access", "interface change %d\n", change));
+
+    if ((NULL == ifTable_cache) || !ifTable_cache->valid) {
+        /*
+         * nothing to update; the next load will see the change.
+         */
+        if (NULL != ifentry)
+            netsnmp_access_interface_entry_free(ifentry);
+        return;
+    }
+
+    if (NETSNMP_ACCESS_INTERFACE_CHANGE_RESYNC == change) {
+        /*
+         * reload when the table is next used: we're called in the
+         * middle of reading the notifications, and a reload now
+         * would replace the interface information they are read with.
+         */
+        ifTable_cache->expired = 1;
+        return;
+    }
+
+    /*
+     * both containers use the same index.
+     */
+    container = (netsnmp_container *) ifTable_cache->magic;
+    rowreq_ctx = (ifTable_rowreq_ctx*)CONTAINER_FIND(container, ifentry);
+    if (NULL == rowreq_ctx) {
+        if (NETSNMP_ACCESS_INTERFACE_CHANGE_UPDATE == change)
+            _add_new_interface(ifentry, container);
+        else
+            netsnmp_access_interface_entry_free(ifentry);
+        return;
+    }
+
+    cdc.current = NULL;
+    cdc.deleted = NULL;
+    _update_interface_entry(rowreq_ctx,
+                            (NETSNMP_ACCESS_INTERFACE_CHANGE_UPDATE == change) ?
+                            ifentry : NULL, &cdc);
+    netsnmp_access_interface_entry_free(ifentry);
+
+    if (NULL != cdc.deleted) {
+       CONTAINER_FOR_EACH(cdc.deleted,
+                          (netsnmp_container_obj_func *) _delete_missing_interface,
+                          container);
+       CONTAINER_FREE(cdc.deleted);
+    }
+}
+
+/**
+ * start or stop interface change notifications after reading the
+ * config. While they run, oper status changes and new and removed
+ * interfaces are applied as they happen, and the container is only
+ * reloaded (for the counters) when a request finds it expired.
+ */
+static int
+_interface_events_config(int majorID, int minorID, void *serverarg,
+                         void *clientarg)
+{
+    if (NULL == ifTable_cache)
+        return SNMP_ERR_NOERROR;
+
+    if (events && !events_started) {
+        if (netsnmp_access_interface_changes_start(_interface_change,
+                                                   NULL) != 0) {
+            snmp_log(LOG_WARNING, "interface change notifications are not "
+                     "available, polling ifTable\n");
+            return SNMP_ERR_NOERROR;
+        }
+        events_started = 1;
+        if (0 != ifTable_cache->timer_id)
+            netsnmp_cache_timer_stop(ifTable_cache);
+    } else if (!events && events_started) {
+        netsnmp_access_interface_changes_stop();
+        events_started = 0;
+        if (0 == ifTable_cache->timer_id)
+            netsnmp_cache_timer_start(ifTable_cache);
+    }
+
+    return SNMP_ERR_NOERROR;
 }
 
 /**
@@ -125,6 +242,11 @@ ifTable_init_data(ifTable_registration * ifTable_reg)
             "interface_fadeout seconds");
     snmpd_register_config_handler("interface_replace_old",
             parse_interface_replace_old, NULL, "interface_replace_old yes|no");
+    snmpd_register_config_handler("interface_events",
+            parse_interface_events, NULL, "interface_events yes|no");
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY,
+                           SNMP_CALLBACK_POST_READ_CONFIG,
+                           _interface_events_config, NULL);
 
     return MFD_SUCCESS;
 }                               /* ifTable_init_data */
@@ -197,6 +319,7 @@ ifTable_container_init(netsnmp_container **container_ptr_ptr,
      * At 100 Mbps it is ~5 minutes, and at 1 Gbps, ~34 seconds.
      */
     cache->timeout = IFTABLE_CACHE_TIMEOUT;     /* seconds */
+    ifTable_cache = cache;
 
     /*
      * don't release resources
@@ -306,23 +429,16 @@ send_linkUpDownNotifications(oid *notification_oid, size_t notification_oid_len,
 }
 
 /**
- * check entry for update
+ * update entry from fresh interface data (NULL if it has gone missing)
  *
  */
 static void
-_check_interface_entry_for_updates(ifTable_rowreq_ctx * rowreq_ctx,
-                                   cd_container *cdc)
+_update_interface_entry(ifTable_rowreq_ctx * rowreq_ctx,
+                        netsnmp_interface_entry *ifentry,
+                        cd_container *cdc)
 {
     char            oper_changed = 0;
     int lastchanged = rowreq_ctx->data.ifLastChange;
-    netsnmp_container *ifcontainer = cdc->current;
-
-    /*
-     * check for matching entry. We can do this directly, since
-     * both containers use the same index.
-     */
-    netsnmp_interface_entry *ifentry =
-        (netsnmp_interface_entry*)CONTAINER_FIND(ifcontainer, rowreq_ctx);
 
 #ifdef USING_IP_MIB_IPV4INTERFACETABLE_IPV4INTERFACETABLE_MODULE
     /*
@@ -408,12 +524,6 @@ _check_interface_entry_for_updates(ifTable_rowreq_ctx * rowreq_ctx,
             oper_changed = 1;
         netsnmp_access_interface_entry_copy(rowreq_ctx->data.ifentry,
                                             ifentry);
-
-        /*
-         * remove entry from temporary ifcontainer
-         */
-        CONTAINER_REMOVE(ifcontainer, ifentry);
-        netsnmp_access_interface_entry_free(ifentry);
     }
 
     /*
@@ -444,6 +554,32 @@ _check_interface_entry_for_updates(ifTable_rowreq_ctx * rowreq_ctx,
         rowreq_ctx->data.ifLastChange = lastchanged;
 }
 
+/**
+ * check entry for update
+ *
+ */
+static void
+_check_interface_entry_for_updates(ifTable_rowreq_ctx * rowreq_ctx,
+                                   cd_container *cdc)
+{
+    /*
+     * check for matching entry. We can do this directly, since
+     * both containers use the same index.
+     */
+    netsnmp_interface_entry *ifentry =
+        (netsnmp_interface_entry*)CONTAINER_FIND(cdc->current, rowreq_ctx);
+
+    _update_interface_entry(rowreq_ctx, ifentry, cdc);
+
+    if (NULL != ifentry) {
+        /*
+         * remove entry from temporary ifcontainer
+         */
+        CONTAINER_REMOVE(cdc->current, ifentry);
+        netsnmp_access_interface_entry_free(ifentry);
+    }
+}
+
 /**
  * Remove all old interfaces with the same name as the newly added one.
  */
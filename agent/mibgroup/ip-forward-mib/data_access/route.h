@@ -22,6 +22,9 @@ config_require(ip-forward-mib/data_access/route_common)
 #if defined( linux )
 config_require(ip-forward-mib/data_access/route_linux)
 config_require(ip-forward-mib/data_access/route_ioctl)
+#   if defined( HAVE_LINUX_RTNETLINK_H )
+#       define NETSNMP_ACCESS_ROUTE_HAVE_CHANGES 1
+#   endif
 #else
 config_error(the route data access library is not available in this environment.)
 #endif
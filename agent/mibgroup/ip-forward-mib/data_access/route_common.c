@@ -10,6 +10,8 @@
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 #include <net-snmp/data_access/route.h>
 
+#include "ip-forward-mib/data_access/route.h"
+
 /**---------------------------------------------------------------------*/
 /*
  * local static prototypes
@@ -29,6 +31,11 @@ extern int
 netsnmp_arch_route_create(netsnmp_route_entry *entry);
 extern int
 netsnmp_arch_route_delete(netsnmp_route_entry *entry);
+#ifdef NETSNMP_ACCESS_ROUTE_HAVE_CHANGES
+extern int
+netsnmp_arch_route_changes_start(NetsnmpAccessRouteChange *hook, void *ctx);
+extern void netsnmp_arch_route_changes_stop(void);
+#endif
 
 
 /**---------------------------------------------------------------------*/
@@ -89,6 +96,37 @@ netsnmp_access_route_container_free(netsnmp_container *container, u_int free_fla
         CONTAINER_FREE(container);
 }
 
+/**
+ * report route changes to a hook as they happen
+ *
+ * @retval  0 : success
+ * @retval -1 : not available on this platform, or error
+ */
+int
+netsnmp_access_route_changes_start(NetsnmpAccessRouteChange *hook,
+                                   void *ctx)
+{
+    DEBUGMSGTL(("access:route:changes", "start\n"));
+
+    if (NULL == hook)
+        return -1;
+#ifdef NETSNMP_ACCESS_ROUTE_HAVE_CHANGES
+    return netsnmp_arch_route_changes_start(hook, ctx);
+#else
+    return -1;
+#endif
+}
+
+void
+netsnmp_access_route_changes_stop(void)
+{
+    DEBUGMSGTL(("access:route:changes", "stop\n"));
+
+#ifdef NETSNMP_ACCESS_ROUTE_HAVE_CHANGES
+    netsnmp_arch_route_changes_stop();
+#endif
+}
+
 /**---------------------------------------------------------------------*/
 /*
  * ifentry functions
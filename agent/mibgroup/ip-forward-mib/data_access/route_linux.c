@@ -12,10 +12,40 @@
 #include <net-snmp/data_access/route.h>
 #include <net-snmp/data_access/ipaddress.h>
 
+#include "ip-forward-mib/data_access/route.h"
 #include "ip-forward-mib/data_access/route_ioctl.h"
+#include "ip-forward-mib/data_access/route_linux.h"
 #include "ip-forward-mib/inetCidrRouteTable/inetCidrRouteTable_constants.h"
 #include "if-mib/data_access/interface_ioctl.h"
 
+#include <errno.h>
+#ifdef HAVE_LINUX_RTNETLINK_H
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#endif
+
+/*
+ * "route_netlink no" forces the /proc/net/route and /proc/net/ipv6_route
+ * loaders
+ */
+static int route_use_netlink = 1;
+
+static void
+_parse_route_netlink(const char *token, char *line)
+{
+    int             use = netsnmp_ds_parse_boolean(line);
+
+    if (use >= 0)
+        route_use_netlink = use;
+}
+
+void
+init_route_linux(void)
+{
+    snmpd_register_config_handler("route_netlink", _parse_route_netlink,
+                                  NULL, "yes|no");
+}
+
 static int
 _type_from_flags(unsigned int flags)
 {
@@ -349,6 +379,521 @@ _load_ipv6(netsnmp_container* container, u_long *index )
 }
 #endif
 
+#ifdef HAVE_LINUX_RTNETLINK_H
+/*
+ * NETLINK_ROUTE loader. Unlike /proc/net/route, which only lists the
+ * main table, a RTM_GETROUTE dump covers every table (policy routing,
+ * VRFs), and it is binary, so large tables load much faster.
+ *
+ * Only routes that forward or reject traffic are loaded; local,
+ * broadcast, multicast and anycast routes (the local table, mostly)
+ * and cloned ones are left out. A route with several next hops becomes
+ * one entry per next hop. NETSNMP_ACCESS_ROUTE_LOAD_MAIN_TABLE_ONLY
+ * limits the load to the main table, for tables (like ipCidrRouteTable)
+ * whose index can't tell the routing tables apart.
+ *
+ * inetCidrRoutePolicy is { 0 table ifIndex }, with table 0 for the main
+ * table, except for ipv4 routes in the main table, which keep what the
+ * /proc loader used: { 0 0 ifIndex } without a next hop and { 0 0 } with
+ * one. Entries built from a notification thus have the same index as
+ * the entry the dump returned for the route.
+ */
+
+typedef int (_route_nl_cb)(netsnmp_route_entry *entry, void *ctx);
+
+typedef struct _route_nl_load {
+    netsnmp_container *container;
+    u_long         *index;
+    u_int           table;      /* only load this table, if not 0 */
+} route_nl_load;
+
+/*
+ * route change notifications
+ */
+static int      _nl_changes_fd = -1;
+static NetsnmpAccessRouteChange *_nl_changes_hook = NULL;
+static void    *_nl_changes_ctx = NULL;
+
+static int
+_type_from_rtm(const struct rtmsg *rtm, int has_gateway)
+{
+    switch (rtm->rtm_type) {
+    case RTN_UNICAST:
+        return has_gateway ? INETCIDRROUTETYPE_REMOTE :
+            INETCIDRROUTETYPE_LOCAL;
+    case RTN_BLACKHOLE:
+        return INETCIDRROUTETYPE_BLACKHOLE;
+    case RTN_UNREACHABLE:
+    case RTN_PROHIBIT:
+        return INETCIDRROUTETYPE_REJECT;
+    default:
+        return 0; /* doesn't forward traffic */
+    }
+}
+
+static int
+_proto_from_rtm(const struct rtmsg *rtm)
+{
+    switch (rtm->rtm_protocol) {
+    case RTPROT_KERNEL:
+    case RTPROT_BOOT:
+        return IANAIPROUTEPROTOCOL_LOCAL;
+    case RTPROT_STATIC:
+        return IANAIPROUTEPROTOCOL_NETMGMT;
+    case RTPROT_REDIRECT:
+    case RTPROT_RA:
+        return IANAIPROUTEPROTOCOL_ICMP;
+#ifdef RTPROT_BGP
+    case RTPROT_BGP:
+        return IANAIPROUTEPROTOCOL_BGP;
+    case RTPROT_ISIS:
+        return IANAIPROUTEPROTOCOL_ISIS;
+    case RTPROT_OSPF:
+        return IANAIPROUTEPROTOCOL_OSPF;
+    case RTPROT_RIP:
+        return IANAIPROUTEPROTOCOL_RIP;
+    case RTPROT_EIGRP:
+        return IANAIPROUTEPROTOCOL_CISCOEIGRP;
+#endif
+    default:
+        return IANAIPROUTEPROTOCOL_OTHER;
+    }
+}
+
+/**
+ * @internal
+ * build the entry for one next hop of a route
+ */
+static netsnmp_route_entry *
+_nl_route_entry(const struct rtmsg *rtm, struct rtattr **tb, u_int table,
+                int if_index, const struct rtattr *gateway)
+{
+    netsnmp_route_entry *entry;
+    int             addr_len = (AF_INET == rtm->rtm_family) ? 4 : 16;
+    int             has_gateway;
+
+    has_gateway = (NULL != gateway) && (RTA_PAYLOAD(gateway) >= addr_len);
+
+    entry = netsnmp_access_route_entry_create();
+    if (NULL == entry)
+        return NULL;
+
+    entry->if_index = if_index;
+
+    entry->rt_dest_type = entry->rt_nexthop_type =
+        (4 == addr_len) ? INETADDRESSTYPE_IPV4 : INETADDRESSTYPE_IPV6;
+    entry->rt_dest_len = entry->rt_nexthop_len = addr_len;
+    if (tb[RTA_DST] && RTA_PAYLOAD(tb[RTA_DST]) >= addr_len)
+        memcpy(entry->rt_dest, RTA_DATA(tb[RTA_DST]), addr_len);
+    if (has_gateway)
+        memcpy(entry->rt_nexthop, RTA_DATA(gateway), addr_len);
+    entry->rt_pfx_len = rtm->rtm_dst_len;
+
+#ifdef USING_IP_FORWARD_MIB_IPCIDRROUTETABLE_IPCIDRROUTETABLE_MODULE
+    if (4 == addr_len)
+        entry->rt_mask = htonl(rtm->rtm_dst_len ?
+                               0xffffffffU << (32 - rtm->rtm_dst_len) : 0);
+#endif
+
+    entry->rt_metric1 = tb[RTA_PRIORITY] ?
+        *(uint32_t *) RTA_DATA(tb[RTA_PRIORITY]) : 0;
+
+#ifdef USING_IP_FORWARD_MIB_INETCIDRROUTETABLE_INETCIDRROUTETABLE_MODULE
+    if ((4 != addr_len) || (RT_TABLE_MAIN != table) || !has_gateway) {
+        entry->rt_policy = calloc(3, sizeof(oid));
+        if (NULL == entry->rt_policy) {
+            netsnmp_access_route_entry_free(entry);
+            return NULL;
+        }
+        entry->rt_policy[1] = (RT_TABLE_MAIN == table) ? 0 : table;
+        entry->rt_policy[2] = entry->if_index;
+        entry->rt_policy_len = sizeof(oid)*3;
+    }
+#endif
+
+    entry->rt_type = _type_from_rtm(rtm, has_gateway);
+    entry->rt_proto = _proto_from_rtm(rtm);
+
+    return entry;
+}
+
+/**
+ * @internal
+ * pass the entries for a RTM_NEWROUTE or RTM_DELROUTE message to cb,
+ * if the route is in table_only (or table_only is 0)
+ *
+ * @retval  0 : success, or the route was skipped
+ * @retval -1 : out of memory, or cb gave up
+ */
+static int
+_nl_route_msg(struct nlmsghdr *h, u_int table_only, _route_nl_cb *cb,
+              void *ctx)
+{
+    struct rtmsg   *rtm = (struct rtmsg *) NLMSG_DATA(h);
+    struct rtattr  *tb[RTA_MAX + 1], *rta;
+    struct rtnexthop *nh;
+    netsnmp_route_entry *entry;
+    u_int           table;
+    int             len, nhlen;
+
+    if (h->nlmsg_len < NLMSG_LENGTH(sizeof(*rtm)))
+        return 0;
+    if ((AF_INET != rtm->rtm_family)
+#ifdef NETSNMP_ENABLE_IPV6
+        && (AF_INET6 != rtm->rtm_family)
+#endif
+        )
+        return 0;
+    if ((rtm->rtm_flags & RTM_F_CLONED) ||
+        (0 == _type_from_rtm(rtm, 0)))
+        return 0;
+
+    memset(tb, 0, sizeof(tb));
+    len = RTM_PAYLOAD(h);
+    for (rta = RTM_RTA(rtm); RTA_OK(rta, len); rta = RTA_NEXT(rta, len))
+        if (rta->rta_type <= RTA_MAX)
+            tb[rta->rta_type] = rta;
+
+    table = rtm->rtm_table;
+    if (tb[RTA_TABLE] && RTA_PAYLOAD(tb[RTA_TABLE]) >= sizeof(uint32_t))
+        table = *(uint32_t *) RTA_DATA(tb[RTA_TABLE]);
+    if (table_only && (table != table_only))
+        return 0;
+
+    if (NULL == tb[RTA_MULTIPATH]) {
+        entry = _nl_route_entry(rtm, tb, table,
+                                tb[RTA_OIF] ?
+                                *(int *) RTA_DATA(tb[RTA_OIF]) : 0,
+                                tb[RTA_GATEWAY]);
+        if (NULL == entry)
+            return -1;
+        return cb(entry, ctx);
+    }
+
+    nh = (struct rtnexthop *) RTA_DATA(tb[RTA_MULTIPATH]);
+    len = RTA_PAYLOAD(tb[RTA_MULTIPATH]);
+    while (len >= (int) sizeof(*nh) && nh->rtnh_len >= sizeof(*nh) &&
+           nh->rtnh_len <= len) {
+        nhlen = nh->rtnh_len - sizeof(*nh);
+        for (rta = RTNH_DATA(nh); RTA_OK(rta, nhlen);
+             rta = RTA_NEXT(rta, nhlen))
+            if (RTA_GATEWAY == rta->rta_type)
+                break;
+        entry = _nl_route_entry(rtm, tb, table, nh->rtnh_ifindex,
+                                RTA_OK(rta, nhlen) ? rta : NULL);
+        if ((NULL == entry) || (cb(entry, ctx) < 0))
+            return -1;
+        len -= RTNH_ALIGN(nh->rtnh_len);
+        nh = RTNH_NEXT(nh);
+    }
+    return 0;
+}
+
+static int
+_nl_load_entry(netsnmp_route_entry *entry, void *ctx)
+{
+    route_nl_load  *load = (route_nl_load *) ctx;
+
+    entry->ns_rt_index = ++(*load->index);
+    if (CONTAINER_INSERT(load->container, entry) < 0) {
+        DEBUGMSGTL(("access:route:container", "error with route_entry: "
+                    "insert into container failed.\n"));
+        netsnmp_access_route_entry_free(entry);
+    }
+    return 0;
+}
+
+/**
+ * @internal
+ * dump the routes of one family, in all tables
+ *
+ * @retval  0 : success
+ * @retval -1 : netlink error, or out of memory
+ */
+static int
+_nl_route_dump(int nlfd, int family, route_nl_load *load)
+{
+    static __u32    seq = 0;
+    union {
+        struct nlmsghdr n;
+        char            buf[32768];
+    } u;
+    struct nlmsghdr *h;
+    int             len;
+
+    memset(&u.n, 0, NLMSG_SPACE(sizeof(struct rtmsg)));
+    u.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+    u.n.nlmsg_type = RTM_GETROUTE;
+    u.n.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    u.n.nlmsg_seq = ++seq;
+    ((struct rtmsg *) NLMSG_DATA(&u.n))->rtm_family = family;
+
+    if (send(nlfd, &u.n, u.n.nlmsg_len, 0) < 0) {
+        DEBUGMSGTL(("access:route:netlink", "send failed: %s\n",
+                    strerror(errno)));
+        return -1;
+    }
+
+    for (;;) {
+        len = recv(nlfd, u.buf, sizeof(u.buf), MSG_TRUNC);
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            DEBUGMSGTL(("access:route:netlink", "recv failed: %s\n",
+                        strerror(errno)));
+            return -1;
+        }
+        if (len == 0 || len > (int) sizeof(u.buf)) {
+            DEBUGMSGTL(("access:route:netlink", "bad reply length %d\n",
+                        len));
+            return -1;
+        }
+
+        for (h = &u.n; NLMSG_OK(h, len); h = NLMSG_NEXT(h, len)) {
+            if (h->nlmsg_seq != seq)
+                continue;
+            if (h->nlmsg_type == NLMSG_DONE)
+                return 0;
+            if (h->nlmsg_type == NLMSG_ERROR) {
+                DEBUGMSGTL(("access:route:netlink",
+                            "dump of family %d failed\n", family));
+                return -1;
+            }
+#ifdef NLM_F_DUMP_INTR
+            if (h->nlmsg_flags & NLM_F_DUMP_INTR)
+                DEBUGMSGTL(("access:route:netlink",
+                            "dump interrupted by a change\n"));
+#endif
+            if (h->nlmsg_type == RTM_NEWROUTE &&
+                _nl_route_msg(h, load->table, _nl_load_entry, load) < 0)
+                return -1;
+        }
+    }
+}
+
+/*
+ * load routes using NETLINK_ROUTE dumps
+ *
+ * @retval  0 success
+ * @retval -2 netlink isn't usable (the container is left empty)
+ */
+static int
+_load_netlink(netsnmp_container* container, u_int load_flags,
+              u_long *index)
+{
+    route_nl_load   load;
+    int             nlfd;
+
+    DEBUGMSGTL(("access:route:container",
+                "route_container_arch_load netlink\n"));
+
+    nlfd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+    if (nlfd < 0) {
+        DEBUGMSGTL(("access:route:netlink", "socket failed: %s\n",
+                    strerror(errno)));
+        return -2;
+    }
+
+    load.container = container;
+    load.index = index;
+    load.table = (load_flags & NETSNMP_ACCESS_ROUTE_LOAD_MAIN_TABLE_ONLY) ?
+        RT_TABLE_MAIN : 0;
+
+    if (_nl_route_dump(nlfd, AF_INET, &load) < 0) {
+        netsnmp_access_route_container_free(container,
+                                  NETSNMP_ACCESS_ROUTE_FREE_KEEP_CONTAINER);
+        close(nlfd);
+        return -2;
+    }
+
+#ifdef NETSNMP_ENABLE_IPV6
+    /*
+     * the ipv6 module might not be loaded, so carry on without it.
+     */
+    if (!(load_flags & NETSNMP_ACCESS_ROUTE_LOAD_IPV4_ONLY) &&
+        _nl_route_dump(nlfd, AF_INET6, &load) < 0)
+        DEBUGMSGTL(("access:route:netlink", "no ipv6 routes\n"));
+#endif
+
+    close(nlfd);
+    return 0;
+}
+
+static int
+_nl_change_entry(netsnmp_route_entry *entry, void *ctx)
+{
+    int            *change = (int *) ctx;
+
+    _nl_changes_hook(*change, entry, _nl_changes_ctx);
+
+    /*
+     * the other next hops of a replacing route are added to the first
+     */
+    if (NETSNMP_ACCESS_ROUTE_CHANGE_REPLACE == *change)
+        *change = NETSNMP_ACCESS_ROUTE_CHANGE_UPDATE;
+    return 0;
+}
+
+/**
+ * @internal
+ * read RTNLGRP_IPV4_ROUTE and RTNLGRP_IPV6_ROUTE notifications, and
+ * pass them on to the hook
+ */
+static void
+_nl_changes_read(int nlfd, void *unused)
+{
+    union {
+        struct nlmsghdr n;
+        char            buf[32768];
+    } u;
+    struct sockaddr_nl sa;
+    socklen_t       salen;
+    struct nlmsghdr *h;
+    struct ifinfomsg *ifi;
+    int             len, change;
+
+    for (;;) {
+        salen = sizeof(sa);
+        len = recvfrom(nlfd, u.buf, sizeof(u.buf), MSG_DONTWAIT,
+                       (struct sockaddr *) &sa, &salen);
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == ENOBUFS) {
+                /*
+                 * the socket overran, and changes were lost
+                 */
+                DEBUGMSGTL(("access:route:netlink",
+                            "route notifications lost\n"));
+                _nl_changes_hook(NETSNMP_ACCESS_ROUTE_CHANGE_RESYNC,
+                                 NULL, _nl_changes_ctx);
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                DEBUGMSGTL(("access:route:netlink",
+                            "route notification recv failed: %s\n",
+                            strerror(errno)));
+            break;
+        }
+        if (sa.nl_pid != 0)
+            continue;               /* only the kernel is believed */
+
+        for (h = &u.n; NLMSG_OK(h, len); h = NLMSG_NEXT(h, len)) {
+            switch (h->nlmsg_type) {
+            case RTM_NEWROUTE:
+                change = (h->nlmsg_flags & NLM_F_REPLACE) ?
+                    NETSNMP_ACCESS_ROUTE_CHANGE_REPLACE :
+                    NETSNMP_ACCESS_ROUTE_CHANGE_UPDATE;
+                _nl_route_msg(h, 0, _nl_change_entry, &change);
+                break;
+
+            case RTM_DELROUTE:
+                change = NETSNMP_ACCESS_ROUTE_CHANGE_DELETE;
+                _nl_route_msg(h, 0, _nl_change_entry, &change);
+                break;
+
+            case RTM_NEWLINK:
+            case RTM_DELLINK:
+                /*
+                 * the kernel flushes the routes through an interface
+                 * that goes down without telling anyone.
+                 */
+                ifi = (struct ifinfomsg *) NLMSG_DATA(h);
+                if (h->nlmsg_len < NLMSG_LENGTH(sizeof(*ifi)))
+                    break;
+                if ((RTM_DELLINK == h->nlmsg_type) ||
+                    ((ifi->ifi_change & IFF_UP) &&
+                     !(ifi->ifi_flags & IFF_UP))) {
+                    DEBUGMSGTL(("access:route:netlink",
+                                "interface %d went down\n",
+                                ifi->ifi_index));
+                    _nl_changes_hook(NETSNMP_ACCESS_ROUTE_CHANGE_RESYNC,
+                                     NULL, _nl_changes_ctx);
+                }
+                break;
+            }
+        }
+    }
+}
+
+/*
+ * subscribe to RTNLGRP_IPV4_ROUTE and RTNLGRP_IPV6_ROUTE
+ *
+ * @retval  0 success
+ * @retval -1 netlink isn't usable, or isn't the route loader
+ */
+int
+netsnmp_arch_route_changes_start(NetsnmpAccessRouteChange *hook, void *ctx)
+{
+    struct sockaddr_nl sa;
+    int             fd, rcvbuf = 262144;
+
+    /*
+     * notifications have to look like what the loader returns
+     */
+    if (!route_use_netlink) {
+        snmp_log(LOG_WARNING, "route change notifications need "
+                 "\"route_netlink yes\"\n");
+        return -1;
+    }
+
+    _nl_changes_hook = hook;
+    _nl_changes_ctx = ctx;
+    if (_nl_changes_fd >= 0)
+        return 0;
+
+    fd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE);
+    if (fd < 0) {
+        snmp_log(LOG_ERR, "route changes: netlink socket create error\n");
+        return -1;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+    sa.nl_groups = RTMGRP_IPV4_ROUTE | RTMGRP_LINK;
+#ifdef NETSNMP_ENABLE_IPV6
+    sa.nl_groups |= RTMGRP_IPV6_ROUTE;
+#endif
+    if (bind(fd, (struct sockaddr *) &sa, sizeof(sa)) < 0) {
+        snmp_log(LOG_ERR, "route changes: netlink bind failed\n");
+        close(fd);
+        return -1;
+    }
+
+    /*
+     * a burst of changes shouldn't overrun the socket before the
+     * agent gets to read it; losing changes costs a full reload.
+     */
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) < 0)
+        DEBUGMSGTL(("access:route:netlink", "SO_RCVBUF failed: %s\n",
+                    strerror(errno)));
+
+    if (register_readfd(fd, _nl_changes_read, NULL) != 0) {
+        snmp_log(LOG_ERR, "route changes: error registering netlink "
+                 "socket\n");
+        close(fd);
+        return -1;
+    }
+    _nl_changes_fd = fd;
+
+    DEBUGMSGTL(("access:route:netlink", "watching route changes\n"));
+    return 0;
+}
+
+void
+netsnmp_arch_route_changes_stop(void)
+{
+    if (_nl_changes_fd < 0)
+        return;
+
+    unregister_readfd(_nl_changes_fd);
+    close(_nl_changes_fd);
+    _nl_changes_fd = -1;
+    _nl_changes_hook = NULL;
+    _nl_changes_ctx = NULL;
+}
+#endif /* HAVE_LINUX_RTNETLINK_H */
+
 /** arch specific load
  * @internal
  *
@@ -371,6 +916,16 @@ netsnmp_access_route_container_arch_load(netsnmp_container* container,
         return -1;
     }
 
+#ifdef HAVE_LINUX_RTNETLINK_H
+    if (route_use_netlink) {
+        rc = _load_netlink(container, load_flags, &count);
+        if (0 == rc)
+            return rc;
+        NETSNMP_LOGONCE((LOG_WARNING, "netlink route dump failed, "
+                         "falling back to /proc/net/route\n"));
+    }
+#endif
+
     rc = _load_ipv4(container, &count);
     
 #ifdef NETSNMP_ENABLE_IPV6
@@ -0,0 +1,5 @@
+/*
+ * internal header, not for distribution
+ */
+
+void init_route_linux(void);
@@ -19,6 +19,14 @@
 
 #include "inetCidrRouteTable_data_access.h"
 
+/*
+ * "route_events yes" keeps the container up to date with route change
+ * notifications, instead of reloading it when the cache times out.
+ */
+static int      events = 0;
+static int      events_started = 0;
+static int      synchronized = 0;   /* container matches the kernel */
+
 /** @ingroup interface 
  * @addtogroup data_access data_access: Routines to access data
  *
@@ -40,6 +48,232 @@
  * OID: .1.3.6.1.2.1.4.24.7, length: 9
  */
 
+static void
+_parse_route_events(const char *token, char *line)
+{
+    int             use = netsnmp_ds_parse_boolean(line);
+
+    if (use >= 0)
+        events = use;
+}
+
+static void
+_release_route_row(inetCidrRouteTable_rowreq_ctx *rowreq_ctx, void *unused)
+{
+    inetCidrRouteTable_release_rowreq_ctx(rowreq_ctx);
+}
+
+/**
+ * the routing table a row came from; the loader puts it in the policy
+ */
+static oid
+_route_table(const netsnmp_route_entry *route_entry)
+{
+    if ((NULL == route_entry->rt_policy) ||
+        (route_entry->rt_policy_len < 2 * sizeof(oid)))
+        return 0;
+    return route_entry->rt_policy[1];
+}
+
+/**
+ * remove a row. Several routes may have the same index (they differ
+ * in metric, say), and the container may give up another row with
+ * that index instead; then the data is swapped, so that it's the
+ * route in rowreq_ctx that goes.
+ */
+static void
+_remove_route_row(netsnmp_container *container,
+                  inetCidrRouteTable_rowreq_ctx *rowreq_ctx)
+{
+    inetCidrRouteTable_rowreq_ctx *removed = NULL;
+    netsnmp_route_entry *data;
+
+    netsnmp_binary_array_remove(container, rowreq_ctx, (void **) &removed);
+    if (NULL == removed)
+        return;
+    if (removed != rowreq_ctx) {
+        data = removed->data;
+        removed->data = rowreq_ctx->data;
+        rowreq_ctx->data = data;
+    }
+    inetCidrRouteTable_release_rowreq_ctx(removed);
+}
+
+/**
+ * find the row for the route in rowreq_ctx, which isn't in the
+ * container: the one with the same index and metric.
+ */
+static inetCidrRouteTable_rowreq_ctx *
+_find_route_row(netsnmp_container *container,
+                inetCidrRouteTable_rowreq_ctx *rowreq_ctx)
+{
+    inetCidrRouteTable_rowreq_ctx *row, *found = NULL;
+    netsnmp_void_array *rows;
+    size_t          i;
+
+    rows = CONTAINER_GET_SUBSET(container, rowreq_ctx);
+    if (NULL == rows)
+        return NULL;
+    for (i = 0; i < rows->size && NULL == found; ++i) {
+        row = (inetCidrRouteTable_rowreq_ctx *) rows->array[i];
+        if (row->data->rt_metric1 == rowreq_ctx->data->rt_metric1)
+            found = row;
+    }
+    free(rows->array);
+    free(rows);
+    return found;
+}
+
+/**
+ * remove the routes a replacing route takes the place of: those to the
+ * same destination and prefix length, in the same table and with the
+ * same metric.
+ */
+static void
+_remove_replaced_routes(netsnmp_container *container,
+                        inetCidrRouteTable_rowreq_ctx *rowreq_ctx)
+{
+    inetCidrRouteTable_rowreq_ctx *row;
+    netsnmp_void_array *rows;
+    netsnmp_index   prefix;
+    size_t          i;
+
+    /*
+     * the index starts with type, length, address and prefix length
+     */
+    prefix.oids = rowreq_ctx->oid_idx.oids;
+    prefix.len = 3 + rowreq_ctx->data->rt_dest_len;
+
+    /*
+     * removing a row can release another one with the same index, so
+     * look the rows up again after each.
+     */
+    do {
+        rows = CONTAINER_GET_SUBSET(container, &prefix);
+        if (NULL == rows)
+            return;
+        for (i = 0, row = NULL; i < rows->size && NULL == row; ++i) {
+            row = (inetCidrRouteTable_rowreq_ctx *) rows->array[i];
+            if ((_route_table(row->data) != _route_table(rowreq_ctx->data)) ||
+                (row->data->rt_metric1 != rowreq_ctx->data->rt_metric1))
+                row = NULL;
+        }
+        free(rows->array);
+        free(rows);
+        if (NULL != row)
+            _remove_route_row(container, row);
+    } while (NULL != row);
+}
+
+/**
+ * apply a route change notification to the container in place
+ */
+static void
+_route_change(int change, netsnmp_route_entry *route_entry, void *ctx)
+{
+    netsnmp_cache  *cache = inetCidrRouteTable_get_cache();
+    netsnmp_container *container;
+    inetCidrRouteTable_rowreq_ctx *rowreq_ctx, *old;
+
+    DEBUGMSGTL(("inetCidrRouteTable:access", "route change %d\n", change));
+
+    if ((NULL == cache) || !cache->valid || !synchronized) {
+        /*
+         * nothing to update; the next load will see the change.
+         */
+        if (NULL != route_entry)
+            netsnmp_access_route_entry_free(route_entry);
+        return;
+    }
+
+    if (NETSNMP_ACCESS_ROUTE_CHANGE_RESYNC == change) {
+        /*
+         * reload when the table is next used, rather than once for
+         * every burst of lost changes while routes flap.
+         */
+        synchronized = 0;
+        cache->expired = 1;
+        return;
+    }
+
+    container = (netsnmp_container *) cache->magic;
+    rowreq_ctx = inetCidrRouteTable_allocate_rowreq_ctx(route_entry, NULL);
+    if ((NULL == rowreq_ctx) ||
+        (MFD_SUCCESS != inetCidrRouteTable_indexes_set
+         (rowreq_ctx, route_entry->rt_dest_type,
+          (char *) route_entry->rt_dest, route_entry->rt_dest_len,
+          route_entry->rt_pfx_len,
+          route_entry->rt_policy, route_entry->rt_policy_len,
+          route_entry->rt_nexthop_type,
+          (char *) route_entry->rt_nexthop, route_entry->rt_nexthop_len))) {
+        if (rowreq_ctx) {
+            snmp_log(LOG_ERR, "error setting index while updating "
+                     "inetCidrRoute cache.\n");
+            inetCidrRouteTable_release_rowreq_ctx(rowreq_ctx);
+        } else
+            netsnmp_access_route_entry_free(route_entry);
+        return;
+    }
+
+    if (NETSNMP_ACCESS_ROUTE_CHANGE_REPLACE == change)
+        _remove_replaced_routes(container, rowreq_ctx);
+
+    old = _find_route_row(container, rowreq_ctx);
+    if (NETSNMP_ACCESS_ROUTE_CHANGE_DELETE == change) {
+        if (NULL != old)
+            _remove_route_row(container, old);
+        inetCidrRouteTable_release_rowreq_ctx(rowreq_ctx);
+    } else if (NULL != old) {
+        /*
+         * the route is already there; swap in the new data, and free
+         * the old data with the context we used to find the row.
+         */
+        rowreq_ctx->data = old->data;
+        old->data = route_entry;
+        inetCidrRouteTable_release_rowreq_ctx(rowreq_ctx);
+    } else {
+        rowreq_ctx->row_status = ROWSTATUS_ACTIVE;
+        CONTAINER_INSERT(container, rowreq_ctx);
+    }
+}
+
+/**
+ * start or stop route change notifications after reading the config.
+ * While they run, the container is loaded once and then kept up to
+ * date in place; it is only loaded again after changes were lost.
+ */
+static int
+_route_events_config(int majorID, int minorID, void *serverarg,
+                     void *clientarg)
+{
+    netsnmp_cache  *cache = inetCidrRouteTable_get_cache();
+
+    if (NULL == cache)
+        return SNMP_ERR_NOERROR;
+
+    if (events && !events_started) {
+        if (netsnmp_access_route_changes_start(_route_change, NULL) != 0) {
+            snmp_log(LOG_WARNING, "route change notifications are not "
+                     "available, polling inetCidrRouteTable\n");
+            return SNMP_ERR_NOERROR;
+        }
+        events_started = 1;
+        cache->flags |= NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD |
+            NETSNMP_CACHE_DONT_AUTO_RELEASE;
+    } else if (!events && events_started) {
+        netsnmp_access_route_changes_stop();
+        events_started = 0;
+        cache->flags &= ~(NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD |
+                          NETSNMP_CACHE_DONT_AUTO_RELEASE);
+    } else
+        return SNMP_ERR_NOERROR;
+
+    synchronized = 0;
+    cache->expired = 1;
+
+    return SNMP_ERR_NOERROR;
+}
+
 /**
  * initialization for inetCidrRouteTable data access
  *
@@ -62,6 +296,11 @@ inetCidrRouteTable_init_data(inetCidrRouteTable_registration *
     /*
      * TODO:303:o: Initialize inetCidrRouteTable data.
      */
+    snmpd_register_config_handler("route_events", _parse_route_events,
+                                  NULL, "yes|no");
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY,
+                           SNMP_CALLBACK_POST_READ_CONFIG,
+                           _route_events_config, NULL);
 
     return MFD_SUCCESS;
 }                               /* inetCidrRouteTable_init_data */
@@ -259,6 +498,19 @@ inetCidrRouteTable_container_load(netsnmp_container *container)
      *
      * we use the netsnmp data access api to get the data
      */
+    if (events_started) {
+        if (synchronized)
+            return MFD_SUCCESS; /* kept up to date by _route_change */
+
+        /*
+         * the cache doesn't free the container before a load while
+         * notifications run; drop what the last load left.
+         */
+        CONTAINER_CLEAR(container,
+                        (netsnmp_container_obj_func *) _release_route_row,
+                        NULL);
+    }
+
     route_container =
         netsnmp_access_route_container_load(NULL,
                                             NETSNMP_ACCESS_ROUTE_LOAD_NOFLAGS);
@@ -285,6 +537,9 @@ inetCidrRouteTable_container_load(netsnmp_container *container)
     DEBUGMSGT(("verbose:inetCidrRouteTable:inetCidrRouteTable_cache_load",
                "%d records\n", (int)CONTAINER_SIZE(container)));
 
+    if (events_started)
+        synchronized = 1;
+
     return MFD_SUCCESS;
 }                               /* inetCidrRouteTable_container_load */
 
@@ -309,6 +564,7 @@ inetCidrRouteTable_container_free(netsnmp_container *container)
     /*
      * TODO:380:M: Free inetCidrRouteTable container data.
      */
+    synchronized = 0;
 }                               /* inetCidrRouteTable_container_free */
 
 /**
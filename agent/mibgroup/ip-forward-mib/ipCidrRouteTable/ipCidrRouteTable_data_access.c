@@ -159,7 +159,15 @@ _snarf_route_entry(netsnmp_route_entry *route_entry,
          (rowreq_ctx, *((u_long *) route_entry->rt_dest),
           route_entry->rt_mask, route_entry->rt_tos,
           *((u_long *) route_entry->rt_nexthop)))) {
-        CONTAINER_INSERT(container, rowreq_ctx);
+        /*
+         * the container takes duplicate keys, so this only fails when
+         * it can't grow; don't leak the row when it does
+         */
+        if (CONTAINER_INSERT(container, rowreq_ctx) < 0) {
+            snmp_log(LOG_ERR, "ipCidrRouteTable: could not insert route\n");
+            ipCidrRouteTable_release_rowreq_ctx(rowreq_ctx);
+            return;
+        }
         rowreq_ctx->ipCidrRouteStatus = ROWSTATUS_ACTIVE;
     } else {
         if (rowreq_ctx) {
@@ -247,9 +255,14 @@ ipCidrRouteTable_container_load(netsnmp_container *container)
      * set the index(es) [and data, optionally] and insert into
      * the container.
      */
+    /*
+     * the index has no room for the routing table, so stick to the main
+     * one, which is all /proc/net/route ever showed
+     */
     route_container =
         netsnmp_access_route_container_load(NULL,
-                                            NETSNMP_ACCESS_ROUTE_LOAD_IPV4_ONLY);
+                                  NETSNMP_ACCESS_ROUTE_LOAD_IPV4_ONLY |
+                                  NETSNMP_ACCESS_ROUTE_LOAD_MAIN_TABLE_ONLY);
 
     if (NULL == route_container)
         return MFD_RESOURCE_UNAVAILABLE;        /* msg already logged */
@@ -20,6 +20,7 @@
 config_require(ip-mib/data_access/systemstats_common)
 #if defined( linux )
 config_require(ip-mib/data_access/systemstats_linux)
+config_require(util_funcs/netstats)
 #elif defined( solaris2 )
 config_require(ip-mib/data_access/systemstats_solaris2)
 #else
@@ -32,6 +32,9 @@ static void _entry_release(netsnmp_systemstats_entry * entry, void *unused);
 extern int
 netsnmp_access_systemstats_container_arch_load(netsnmp_container* container,
                                              u_int load_flags);
+extern int
+netsnmp_access_systemstats_entry_arch_load(netsnmp_systemstats_entry *entry,
+                                           u_int load_flags);
 extern void
 netsnmp_access_systemstats_arch_init(void);
 
@@ -142,6 +145,23 @@ netsnmp_access_systemstats_container_free(netsnmp_container *container, u_int fr
 /*
  * entry functions
  */
+/**
+ * load the statistics of an entry from a NETSNMP_ACCESS_SYSTEMSTATS_LOAD_INDEXES
+ * container load
+ *
+ * @retval  0 : success
+ * @retval <0 : error (the entry's statistics are unchanged)
+ */
+int
+netsnmp_access_systemstats_entry_load(netsnmp_systemstats_entry *entry,
+                                      u_int load_flags)
+{
+    DEBUGMSGTL(("access:systemstats:entry", "load %" NETSNMP_PRIo "u.%"
+                NETSNMP_PRIo "u\n", entry->index[0], entry->index[1]));
+
+    return netsnmp_access_systemstats_entry_arch_load(entry, load_flags);
+}
+
 /**
  */
 netsnmp_systemstats_entry *
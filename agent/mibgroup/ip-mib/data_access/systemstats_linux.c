@@ -11,14 +11,18 @@
 #include <net-snmp/data_access/systemstats.h>
 
 #include "../ipSystemStatsTable/ipSystemStatsTable.h"
+#include "util_funcs/netstats.h"
 
 #include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <dirent.h>
 #include <ctype.h>
+#include <errno.h>
+#include <stddef.h>
+#include <net/if.h>
 
 static int _systemstats_v4(netsnmp_container* container, u_int load_flags);
-static int _additional_systemstats_v4(netsnmp_systemstats_entry* entry,
-                                      u_int load_flags);
 
 #if defined (NETSNMP_ENABLE_IPV6)
 static int _systemstats_v6(netsnmp_container* container, u_int load_flags);
@@ -89,19 +93,127 @@ netsnmp_access_systemstats_container_arch_load(netsnmp_container* container,
 #endif
 }
 
+/*
+ * How the kernel's counters map onto the ipSystemStatsTable and
+ * ipIfStatsTable columns.  The names are those in the netstats
+ * snapshot, without the group prefix.
+ */
+struct systemstats_field {
+    const char     *name;
+    int             column;
+    size_t          offset;     /* in netsnmp_ipstats */
+    int             hc;         /* a U64 rather than a u_long */
+};
+#define NFIELDS(f)      (sizeof(f) / sizeof((f)[0]))
+#define FIELD(n, c, f)  { n, IPSYSTEMSTATSTABLE_##c, offsetof(netsnmp_ipstats, f), 0 }
+#define HCFIELD(n, c, f) { n, IPSYSTEMSTATSTABLE_##c, offsetof(netsnmp_ipstats, f), 1 }
+
+/* "Ip" in /proc/net/snmp */
+static const struct systemstats_field ip_fields[] = {
+    HCFIELD("InReceives",      HCINRECEIVES,       HCInReceives),
+    FIELD(  "InHdrErrors",     INHDRERRORS,        InHdrErrors),
+    FIELD(  "InAddrErrors",    INADDRERRORS,       InAddrErrors),
+    HCFIELD("ForwDatagrams",   HCOUTFORWDATAGRAMS, HCOutForwDatagrams),
+    FIELD(  "InUnknownProtos", INUNKNOWNPROTOS,    InUnknownProtos),
+    FIELD(  "InDiscards",      INDISCARDS,         InDiscards),
+    HCFIELD("InDelivers",      HCINDELIVERS,       HCInDelivers),
+    HCFIELD("OutRequests",     HCOUTREQUESTS,      HCOutRequests),
+    HCFIELD("OutDiscards",     HCOUTDISCARDS,      HCOutDiscards),
+    HCFIELD("OutNoRoutes",     HCOUTNOROUTES,      HCOutNoRoutes),
+    FIELD(  "ReasmReqds",      REASMREQDS,         ReasmReqds),
+    FIELD(  "ReasmOKs",        REASMOKS,           ReasmOKs),
+    FIELD(  "ReasmFails",      REASMFAILS,         ReasmFails),
+    HCFIELD("FragOKs",         HCOUTFRAGOKS,       HCOutFragOKs),
+    HCFIELD("FragFails",       HCOUTFRAGFAILS,     HCOutFragFails),
+    HCFIELD("FragCreates",     HCOUTFRAGCREATES,   HCOutFragCreates),
+};
+
+/* "IpExt" in /proc/net/netstat, from linux 2.6.22 */
+static const struct systemstats_field ipext_fields[] = {
+    HCFIELD("InNoRoutes",      HCINNOROUTES,       HCInNoRoutes),
+    FIELD(  "InTruncatedPkts", INTRUNCATEDPKTS,    InTruncatedPkts),
+    HCFIELD("InMcastPkts",     HCINMCASTPKTS,      HCInMcastPkts),
+    HCFIELD("OutMcastPkts",    HCOUTMCASTPKTS,     HCOutMcastPkts),
+    HCFIELD("InBcastPkts",     HCINBCASTPKTS,      HCInBcastPkts),
+    HCFIELD("OutBcastPkts",    HCOUTBCASTPKTS,     HCOutBcastPkts),
+};
+
+#if defined (NETSNMP_ENABLE_IPV6)
+/* "Ip6" in /proc/net/snmp6 and the /proc/net/dev_snmp6 files */
+static const struct systemstats_field ip6_fields[] = {
+    HCFIELD("InReceives",       HCINRECEIVES,       HCInReceives),
+    FIELD(  "InHdrErrors",      INHDRERRORS,        InHdrErrors),
+    HCFIELD("InNoRoutes",       HCINNOROUTES,       HCInNoRoutes),
+    FIELD(  "InAddrErrors",     INADDRERRORS,       InAddrErrors),
+    FIELD(  "InUnknownProtos",  INUNKNOWNPROTOS,    InUnknownProtos),
+    FIELD(  "InTruncatedPkts",  INTRUNCATEDPKTS,    InTruncatedPkts),
+    FIELD(  "InDiscards",       INDISCARDS,         InDiscards),
+    HCFIELD("InDelivers",       HCINDELIVERS,       HCInDelivers),
+    HCFIELD("InOctets",         HCINOCTETS,         HCInOctets),
+    HCFIELD("InMcastPkts",      HCINMCASTPKTS,      HCInMcastPkts),
+    HCFIELD("InMcastOctets",    HCINMCASTOCTETS,    HCInMcastOctets),
+    HCFIELD("OutForwDatagrams", HCOUTFORWDATAGRAMS, HCOutForwDatagrams),
+    HCFIELD("OutRequests",      HCOUTREQUESTS,      HCOutRequests),
+    HCFIELD("OutDiscards",      HCOUTDISCARDS,      HCOutDiscards),
+    HCFIELD("OutNoRoutes",      HCOUTNOROUTES,      HCOutNoRoutes),
+    HCFIELD("OutOctets",        HCOUTOCTETS,        HCOutOctets),
+    HCFIELD("OutMcastPkts",     HCOUTMCASTPKTS,     HCOutMcastPkts),
+    HCFIELD("OutMcastOctets",   HCOUTMCASTOCTETS,   HCOutMcastOctets),
+    FIELD(  "ReasmReqds",       REASMREQDS,         ReasmReqds),
+    FIELD(  "ReasmOKs",         REASMOKS,           ReasmOKs),
+    FIELD(  "ReasmFails",       REASMFAILS,         ReasmFails),
+    HCFIELD("FragOKs",          HCOUTFRAGOKS,       HCOutFragOKs),
+    HCFIELD("FragFails",        HCOUTFRAGFAILS,     HCOutFragFails),
+    HCFIELD("FragCreates",      HCOUTFRAGCREATES,   HCOutFragCreates),
+};
+#endif
+
+static void
+_systemstats_set(netsnmp_ipstats *stats, const struct systemstats_field *f,
+                 unsigned long long value)
+{
+    if (f->hc) {
+        U64 *c = (U64 *) ((char *) stats + f->offset);
+
+        c->low = value & 0xffffffff;
+        c->high = value >> 32;
+    } else
+        *(u_long *) ((char *) stats + f->offset) = value;
+    stats->columnAvail[f->column] = 1;
+}
+
+/*
+ * copy the counters of one group of the netstats snapshot into an entry
+ *
+ * @retval the number of columns set
+ */
+static int
+_systemstats_fill(netsnmp_systemstats_entry *entry,
+                  const netsnmp_netstats *stats, const char *group,
+                  const struct systemstats_field *fields, int nfields)
+{
+    unsigned long long value;
+    int             i, found = 0;
+
+    for (i = 0; i < nfields; i++) {
+        if (netsnmp_netstats_value(stats, group, fields[i].name, &value) < 0)
+            continue;
+        _systemstats_set(&entry->stats, &fields[i], value);
+        found++;
+    }
+    DEBUGMSGTL(("access:systemstats", "  %s: %d of %d columns\n", group,
+                found, nfields));
+    return found;
+}
+
 /*
  * Based on load_flags, load ipSystemStatsTable or ipIfStatsTable for ipv4 entries. 
  */
 static int
 _systemstats_v4(netsnmp_container* container, u_int load_flags)
 {
-    FILE           *devin;
-    char            line[1024];
+    const netsnmp_netstats *stats;
     netsnmp_systemstats_entry *entry = NULL;
-    int             scan_count;
-    char           *stats, *start = line;
-    int             len;
-    unsigned long long scan_vals[19];
 
     DEBUGMSGTL(("access:systemstats:container:arch", "load v4 (flags %x)\n",
                 load_flags));
@@ -113,411 +225,88 @@ _systemstats_v4(netsnmp_container* container, u_int load_flags)
         return 0;
     }
 
-    if (!(devin = fopen("/proc/net/snmp", "r"))) {
+    if (!(stats = netsnmp_netstats_get())) {
         DEBUGMSGTL(("access:systemstats",
                     "Failed to load Systemstats Table (linux1)\n"));
-        NETSNMP_LOGONCE((LOG_ERR, "cannot open /proc/net/snmp ...\n"));
         return -2;
     }
-
-    /*
-     * skip header, but make sure it's the length we expect...
-     */
-    fgets(line, sizeof(line), devin);
-    len = strlen(line);
-    if (224 != len) {
-        fclose(devin);
-        snmp_log(LOG_ERR, "unexpected header length in /proc/net/snmp."
-                 " %d != 224\n", len);
+    if (!netsnmp_netstats_group_find(stats, "Ip")) {
+        NETSNMP_LOGONCE((LOG_ERR, "no Ip statistics in /proc/net/snmp\n"));
         return -4;
     }
 
-    /*
-     * This file provides the statistics for each systemstats.
-     * Read in each line in turn, isolate the systemstats name
-     *   and retrieve (or create) the corresponding data structure.
-     */
-    start = fgets(line, sizeof(line), devin);
-    fclose(devin);
-    if (start) {
-
-        len = strlen(line);
-        if (line[len - 1] == '\n')
-            line[len - 1] = '\0';
-
-        while (*start && *start == ' ')
-            start++;
-
-        if ((!*start) || ((stats = strrchr(start, ':')) == NULL)) {
-            snmp_log(LOG_ERR,
-                     "systemstats data format error 1, line ==|%s|\n", line);
-            return -4;
-        }
-
-        DEBUGMSGTL(("access:systemstats", "processing '%s'\n", start));
-
-        *stats++ = 0; /* null terminate name */
-        while (*stats == ' ') /* skip spaces before stats */
-            stats++;
-
-        entry = netsnmp_access_systemstats_entry_create(1, 0,
-                    "ipSystemStatsTable.ipv4");
-        if(NULL == entry) {
-            netsnmp_access_systemstats_container_free(container,
-                                                      NETSNMP_ACCESS_SYSTEMSTATS_FREE_NOFLAGS);
-            return -3;
-        }
-
-        /*
-         * OK - we've now got (or created) the data structure for
-         *      this systemstats, including any "static" information.
-         * Now parse the rest of the line (i.e. starting from 'stats')
-         *      to extract the relevant statistics, and populate
-         *      data structure accordingly.
-         */
-
-        memset(scan_vals, 0x0, sizeof(scan_vals));
-        scan_count = sscanf(stats,
-                            "%llu %llu %llu %llu %llu %llu %llu %llu %llu %llu"
-                            "%llu %llu %llu %llu %llu %llu %llu %llu %llu",
-                            &scan_vals[0],&scan_vals[1],&scan_vals[2],
-                            &scan_vals[3],&scan_vals[4],&scan_vals[5],
-                            &scan_vals[6],&scan_vals[7],&scan_vals[8],
-                            &scan_vals[9],&scan_vals[10],&scan_vals[11],
-                            &scan_vals[12],&scan_vals[13],&scan_vals[14],
-                            &scan_vals[15],&scan_vals[16],&scan_vals[17],
-                            &scan_vals[18]);
-        DEBUGMSGTL(("access:systemstats", "  read %d values\n", scan_count));
-
-        if(scan_count != 19) {
-            snmp_log(LOG_ERR,
-                     "error scanning systemstats data (expected %d, got %d)\n",
-                     19, scan_count);
-            netsnmp_access_systemstats_entry_free(entry);
-            return -4;
-        }
-        /* entry->stats. = scan_vals[0]; / * Forwarding */
-        /* entry->stats. = scan_vals[1]; / * DefaultTTL */
-        entry->stats.HCInReceives.low = scan_vals[2] & 0xffffffff;
-        entry->stats.HCInReceives.high = scan_vals[2] >> 32;
-        entry->stats.InHdrErrors = scan_vals[3];
-        entry->stats.InAddrErrors = scan_vals[4];
-        entry->stats.HCOutForwDatagrams.low = scan_vals[5] & 0xffffffff;
-        entry->stats.HCOutForwDatagrams.high = scan_vals[5] >> 32;
-        entry->stats.InUnknownProtos = scan_vals[6];
-        entry->stats.InDiscards = scan_vals[7];
-        entry->stats.HCInDelivers.low = scan_vals[8] & 0xffffffff;
-        entry->stats.HCInDelivers.high = scan_vals[8] >> 32;
-        entry->stats.HCOutRequests.low = scan_vals[9] & 0xffffffff;
-        entry->stats.HCOutRequests.high = scan_vals[9] >> 32;
-        entry->stats.HCOutDiscards.low = scan_vals[10] & 0xffffffff;;
-        entry->stats.HCOutDiscards.high = scan_vals[10] >> 32;
-        entry->stats.HCOutNoRoutes.low = scan_vals[11] & 0xffffffff;;
-        entry->stats.HCOutNoRoutes.high = scan_vals[11] >> 32;
-        /* entry->stats. = scan_vals[12]; / * ReasmTimeout */
-        entry->stats.ReasmReqds = scan_vals[13];
-        entry->stats.ReasmOKs = scan_vals[14];
-        entry->stats.ReasmFails = scan_vals[15];
-        entry->stats.HCOutFragOKs.low = scan_vals[16] & 0xffffffff;;
-        entry->stats.HCOutFragOKs.high = scan_vals[16] >> 32;
-        entry->stats.HCOutFragFails.low = scan_vals[17] & 0xffffffff;;
-        entry->stats.HCOutFragFails.high = scan_vals[17] >> 32;
-        entry->stats.HCOutFragCreates.low = scan_vals[18] & 0xffffffff;;
-        entry->stats.HCOutFragCreates.high = scan_vals[18] >> 32;
-
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCINRECEIVES] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_INHDRERRORS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_INADDRERRORS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTFORWDATAGRAMS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_INUNKNOWNPROTOS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_INDISCARDS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCINDELIVERS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTREQUESTS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTDISCARDS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTNOROUTES] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_REASMREQDS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_REASMOKS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_REASMFAILS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTFRAGOKS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTFRAGFAILS] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTFRAGCREATES] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_DISCONTINUITYTIME] = 1;
-        entry->stats.columnAvail[IPSYSTEMSTATSTABLE_REFRESHRATE] = 1;
-
-        /*
-         * load addtional statistics defined by RFC 4293
-         * As these are supported linux 2.6.22 or later, it is no problem
-         * if loading them are failed.
-         */
-        _additional_systemstats_v4(entry, load_flags);
-
-        /*
-         * add to container
-         */
-        if (CONTAINER_INSERT(container, entry) < 0)
-        {
-            DEBUGMSGTL(("access:systemstats:container","error with systemstats_entry: insert into container failed.\n"));
-            netsnmp_access_systemstats_entry_free(entry);
-        }
+    entry = netsnmp_access_systemstats_entry_create(1, 0,
+                "ipSystemStatsTable.ipv4");
+    if(NULL == entry) {
+        netsnmp_access_systemstats_container_free(container,
+                                                  NETSNMP_ACCESS_SYSTEMSTATS_FREE_NOFLAGS);
+        return -3;
     }
 
-    return 0;
-}
-    
-#define IP_EXT_HEAD "IpExt:"
-static int
-_additional_systemstats_v4(netsnmp_systemstats_entry* entry,
-                           u_int load_flags)
-{
-    FILE           *devin;
-    char            line[1024];
-    int             scan_count;
-    unsigned long long scan_vals[6];
-    int             retval = 0;
-
-    DEBUGMSGTL(("access:systemstats:container:arch",
-                "load addtional v4 (flags %u)\n", load_flags));
+    _systemstats_fill(entry, stats, "Ip", ip_fields, NFIELDS(ip_fields));
+    entry->stats.columnAvail[IPSYSTEMSTATSTABLE_DISCONTINUITYTIME] = 1;
+    entry->stats.columnAvail[IPSYSTEMSTATSTABLE_REFRESHRATE] = 1;
 
-    if (!(devin = fopen("/proc/net/netstat", "r"))) {
-        DEBUGMSGTL(("access:systemstats",
-                    "cannot open /proc/net/netstat\n"));
-        NETSNMP_LOGONCE((LOG_ERR,"cannot open /proc/net/netstat\n"));
-        return -2;
-    }
+    /*
+     * load addtional statistics defined by RFC 4293
+     * As these are supported linux 2.6.22 or later, it is no problem
+     * if they are missing.
+     */
+    _systemstats_fill(entry, stats, "IpExt", ipext_fields,
+                      NFIELDS(ipext_fields));
 
     /*
-     * Get header and stat lines
+     * add to container
      */
-    while (fgets(line, sizeof(line), devin)) {
-        if (strncmp(IP_EXT_HEAD, line, sizeof(IP_EXT_HEAD) - 1) == 0) {
-            /* next line should includes IPv4 addtional statistics */
-            if ((fgets(line, sizeof(line), devin)) == NULL) {
-                retval = -4;
-                break;
-            }
-            if (strncmp(IP_EXT_HEAD, line, sizeof(IP_EXT_HEAD) - 1) != 0) {
-                retval = -4;
-                break;
-            }
-
-            memset(scan_vals, 0x0, sizeof(scan_vals));
-            scan_count = sscanf(line,
-                                "%*s"   /* ignore `IpExt:' */
-                                "%llu %llu %llu %llu %llu %llu",
-                                &scan_vals[0], &scan_vals[1], &scan_vals[2],
-                                &scan_vals[3], &scan_vals[4], &scan_vals[5]);
-            if (scan_count < 6) {
-                snmp_log(LOG_ERR,
-                        "error scanning addtional systemstats data"
-                        "(minimum expected %d, got %d)\n",
-                        6, scan_count);
-                retval = -4;
-                break;
-            }
-
-            entry->stats.HCInNoRoutes.low    = scan_vals[0] & 0xffffffff;
-            entry->stats.HCInNoRoutes.high   = scan_vals[0] >> 32;
-            entry->stats.InTruncatedPkts     = scan_vals[1];
-            entry->stats.HCInMcastPkts.low   = scan_vals[2] & 0xffffffff;
-            entry->stats.HCInMcastPkts.high  = scan_vals[2] >> 32;
-            entry->stats.HCOutMcastPkts.low  = scan_vals[3] & 0xffffffff;
-            entry->stats.HCOutMcastPkts.high = scan_vals[3] >> 32;
-            entry->stats.HCInBcastPkts.low   = scan_vals[4] & 0xffffffff;
-            entry->stats.HCInBcastPkts.high  = scan_vals[4] >> 32;
-            entry->stats.HCOutBcastPkts.low  = scan_vals[5] & 0xffffffff;
-            entry->stats.HCOutBcastPkts.high = scan_vals[5] >> 32;
-
-            entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCINNOROUTES] = 1;
-            entry->stats.columnAvail[IPSYSTEMSTATSTABLE_INTRUNCATEDPKTS] = 1;
-            entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCINMCASTPKTS] = 1;
-            entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTMCASTPKTS] = 1;
-            entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCINBCASTPKTS] = 1;
-            entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTBCASTPKTS] = 1;
-        }
+    if (CONTAINER_INSERT(container, entry) < 0)
+    {
+        DEBUGMSGTL(("access:systemstats:container","error with systemstats_entry: insert into container failed.\n"));
+        netsnmp_access_systemstats_entry_free(entry);
     }
 
-    fclose(devin);
-
-    if (retval < 0)
-        DEBUGMSGTL(("access:systemstats",
-                    "/proc/net/netstat does not include addtional stats\n"));
-
-    return retval;
+    return 0;
 }
-   
+
 #if defined (NETSNMP_ENABLE_IPV6)
 
 /*
- * Load one /proc/net/snmp6 - like file (e.g. /proc/net/dev_snmp6)
+ * Load one /proc/net/dev_snmp6 file, which is like /proc/net/snmp6
  */ 
 static int 
 _systemstats_v6_load_file(netsnmp_systemstats_entry *entry, FILE *devin)
 {
     char            line[1024];
-    char           *stats, *start = line;
-    int             len, rc;
-    int             scan_count;
-    uintmax_t       scan_val;
+    char           *stats;
+    int             len, i;
 
     /*
-     * Read in each line in turn, isolate the systemstats name
-     *   and retrieve (or create) the corresponding data structure.
+     * Read in each line in turn: "Ip6InReceives   123"
      */
-    rc = 0;
-    while (1) {
-        start = fgets(line, sizeof(line), devin);
-        if (NULL == start)
-            break;
-
+    while (fgets(line, sizeof(line), devin)) {
         len = strlen(line);
         if (line[len - 1] == '\n')
             line[len - 1] = '\0';
 
-        if (('I' != line[0]) || ('6' != line[2]))
+        if (strncmp(line, "Ip6", 3))
             continue;
 
-        stats = strrchr(line, ' ');
+        stats = strpbrk(line, " \t");
         if (NULL == stats) {
             snmp_log(LOG_ERR,
                      "systemstats data format error 1, line ==|%s|\n", line);
             continue;
         }
+        *stats++ = '\0';
 
-        DEBUGMSGTL(("access:systemstats", "processing '%s'\n", line));
-
-        /*
-         * OK - we've now got (or created) the data structure for
-         *      this systemstats, including any "static" information.
-         * Now parse the rest of the line (i.e. starting from 'stats')
-         *      to extract the relevant statistics, and populate
-         *      data structure accordingly.
-         */
-        scan_val = atoll(stats);
-
-        rc = 0;
-        if ('I' == line[3]) { /* In */
-            if ('A' == line[5]) {
-                entry->stats.InAddrErrors = scan_val;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_INADDRERRORS] = 1;
-            } else if ('D' == line[5]) {
-                if ('e' == line[6]) {
-                    entry->stats.HCInDelivers.low = scan_val  & 0xffffffff;
-                    entry->stats.HCInDelivers.high = scan_val >> 32;
-                    entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCINDELIVERS] = 1;
-                } else if ('i' == line[6]) {
-                    entry->stats.InDiscards = scan_val;
-                    entry->stats.columnAvail[IPSYSTEMSTATSTABLE_INDISCARDS] = 1;
-                } else
-                    rc = 1;
-            } else if ('H' == line[5]) {
-                entry->stats.InHdrErrors = scan_val;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_INHDRERRORS] = 1;
-            } else if ('M' == line[5]) {
-                if ('P' == line[10]) {
-                    entry->stats.HCInMcastPkts.low = scan_val  & 0xffffffff;
-                    entry->stats.HCInMcastPkts.high = scan_val >> 32;
-                    entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCINMCASTPKTS] = 1;
-                } else if ('O' == line[10]) {
-                    entry->stats.HCInMcastOctets.low = scan_val  & 0xffffffff;
-                    entry->stats.HCInMcastOctets.high = scan_val >> 32;
-                    entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCINMCASTOCTETS] = 1;
-                } else
-                    rc = 1;
-            } else if ('N' == line[5]) {
-                entry->stats.HCInNoRoutes.low = scan_val & 0xffffffff;
-                entry->stats.HCInNoRoutes.high = scan_val >> 32;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCINNOROUTES] = 1;
-            } else if ('R' == line[5]) {
-                entry->stats.HCInReceives.low = scan_val & 0xffffffff;
-                entry->stats.HCInReceives.high = scan_val >> 32;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCINRECEIVES] = 1;
-            } else if ('T' == line[5]) {
-                if ('r' == line[6]) {
-                    entry->stats.InTruncatedPkts = scan_val  & 0xffffffff;
-                    entry->stats.columnAvail[IPSYSTEMSTATSTABLE_INTRUNCATEDPKTS] = 1;
-                } else if ('o' == line[6])
-                    ; /* TooBig isn't in the MIB, so ignore it */
-                else
-                    rc = 1;
-            } else if ('U' == line[5]) {
-                entry->stats.InUnknownProtos = scan_val;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_INUNKNOWNPROTOS] = 1;
-            } else if ('O' == line[5]) {
-                entry->stats.HCInOctets.low = scan_val & 0xffffffff;
-                entry->stats.HCInOctets.high = scan_val  >> 32;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCINOCTETS] = 1;
-            } else
-                rc = 1;
-        } else if ('O' == line[3]) { /* Out */
-            if ('D' == line[6]) {
-                entry->stats.HCOutDiscards.low = scan_val & 0xffffffff;
-                entry->stats.HCOutDiscards.high = scan_val >> 32;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTDISCARDS] = 1;
-            } else if ('F' == line[6]) {
-                entry->stats.HCOutForwDatagrams.low = scan_val & 0xffffffff;
-                entry->stats.HCOutForwDatagrams.high = scan_val >> 32;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTFORWDATAGRAMS] = 1;
-            } else if ('M' == line[6]) {
-                if ('P' == line[11]) {
-                    entry->stats.HCOutMcastPkts.low = scan_val & 0xffffffff;
-                    entry->stats.HCOutMcastPkts.high = scan_val >> 32;
-                    entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTMCASTPKTS] = 1;
-                } else if ('O' == line[11]) {
-                    entry->stats.HCOutMcastOctets.low = scan_val & 0xffffffff;
-                    entry->stats.HCOutMcastOctets.high = scan_val >> 32;
-                    entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTMCASTOCTETS] = 1;
-                } else
-                    rc = -1;
-            } else if ('N' == line[6]) {
-                entry->stats.HCOutNoRoutes.low = scan_val & 0xffffffff;
-                entry->stats.HCOutNoRoutes.high = scan_val >> 32;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTNOROUTES] = 1;
-            } else if ('R' == line[6]) {
-                entry->stats.HCOutRequests.low = scan_val & 0xffffffff;
-                entry->stats.HCOutRequests.high = scan_val >> 32;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTREQUESTS] = 1;
-            } else if ('O' == line[6]) {
-                entry->stats.HCOutOctets.low = scan_val & 0xffffffff;
-                entry->stats.HCOutOctets.high = scan_val >> 32;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTOCTETS] = 1;
-            } else
-                rc = 1;
-        } else if ('R' == line[3]) { /* Reasm */
-            if ('F' == line[8]) {
-                entry->stats.ReasmFails = scan_val;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_REASMFAILS] = 1;
-            } else if ('O' == line[8]) {
-                entry->stats.ReasmOKs = scan_val;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_REASMOKS] = 1;
-            } else if ('R' == line[8]) {
-                entry->stats.ReasmReqds = scan_val;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_REASMREQDS] = 1;
-            } else if ('T' == line[8]) {
-                ; /* no mib entry for reasm timeout */
-            } else
-                rc = 1;
-        } else if ('F' == line[3]) { /* Frag */
-            if ('C' == line[7]) {
-                entry->stats.HCOutFragCreates.low = scan_val & 0xffffffff;
-                entry->stats.HCOutFragCreates.high = scan_val >> 32;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTFRAGCREATES] = 1;
-            } else if ('O' == line[7]) {
-                entry->stats.HCOutFragOKs.low = scan_val & 0xffffffff;
-                entry->stats.HCOutFragOKs.high = scan_val >> 32;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTFRAGOKS] = 1;
-            } else if ('F' == line[7]) {
-                entry->stats.HCOutFragFails.low = scan_val & 0xffffffff;
-                entry->stats.HCOutFragFails.high = scan_val >> 32;
-                entry->stats.columnAvail[IPSYSTEMSTATSTABLE_HCOUTFRAGFAILS] = 1;
-            } else
-                rc = 1;
-        } else
-            rc = 1;
-        
-        if (rc)
+        for (i = 0; i < (int) NFIELDS(ip6_fields); i++)
+            if (!strcmp(line + 3, ip6_fields[i].name))
+                break;
+        if (i == NFIELDS(ip6_fields)) {
             DEBUGMSGTL(("access:systemstats", "unknown stat %s\n", line));
-        else
-            ++scan_count;
+            continue;
+        }
+        _systemstats_set(&entry->stats, &ip6_fields[i],
+                         strtoull(stats, NULL, 10));
     }
     /*
      * Let DiscontinuityTime and RefreshRate active
@@ -525,7 +314,7 @@ _systemstats_v6_load_file(netsnmp_systemstats_entry *entry, FILE *devin)
     entry->stats.columnAvail[IPSYSTEMSTATSTABLE_DISCONTINUITYTIME] = 1;
     entry->stats.columnAvail[IPSYSTEMSTATSTABLE_REFRESHRATE] = 1;
 
-    return rc;
+    return 0;
 }
 
 /*
@@ -534,63 +323,128 @@ _systemstats_v6_load_file(netsnmp_systemstats_entry *entry, FILE *devin)
 static int 
 _systemstats_v6_load_systemstats(netsnmp_container* container, u_int load_flags)
 {
-    FILE *devin;
+    const netsnmp_netstats *stats;
     netsnmp_systemstats_entry *entry = NULL;
-    const char     *filename = "/proc/net/snmp6";
-    int rc = 0;
-    
-    entry = netsnmp_access_systemstats_entry_create(2, 0,
-            "ipSystemStatsTable.ipv6");
-    if(NULL == entry)
-        return -3;
     
     /*
-     * try to open file. If we can't, that's ok - maybe the module hasn't
-     * been loaded yet.
+     * If there are no Ip6 statistics, that's ok - maybe the module
+     * hasn't been loaded yet.
      */
-    if (!(devin = fopen(filename, "r"))) {
+    stats = netsnmp_netstats_get();
+    if (!netsnmp_netstats_group_find(stats, "Ip6")) {
         DEBUGMSGTL(("access:systemstats",
                     "Failed to load Systemstats Table (linux1)\n"));
-        NETSNMP_LOGONCE((LOG_ERR, "cannot open %s ...\n", filename));
-        free(entry);
+        NETSNMP_LOGONCE((LOG_ERR, "no Ip6 statistics in /proc/net/snmp6\n"));
         return 0;
     }
-    
-    rc = _systemstats_v6_load_file(entry, devin);
 
-    fclose(devin);
+    entry = netsnmp_access_systemstats_entry_create(2, 0,
+            "ipSystemStatsTable.ipv6");
+    if(NULL == entry)
+        return -3;
+
+    _systemstats_fill(entry, stats, "Ip6", ip6_fields, NFIELDS(ip6_fields));
+    entry->stats.columnAvail[IPSYSTEMSTATSTABLE_DISCONTINUITYTIME] = 1;
+    entry->stats.columnAvail[IPSYSTEMSTATSTABLE_REFRESHRATE] = 1;
 
     /*
      * add to container
      */
-        if (CONTAINER_INSERT(container, entry) < 0)
-        {
-            DEBUGMSGTL(("access:systemstats:container","error with systemstats_entry: insert into container failed.\n"));
-            netsnmp_access_systemstats_entry_free(entry);
-        }
-
+    if (CONTAINER_INSERT(container, entry) < 0)
+    {
+        DEBUGMSGTL(("access:systemstats:container","error with systemstats_entry: insert into container failed.\n"));
+        netsnmp_access_systemstats_entry_free(entry);
+    }
 
-    return rc;
+    return 0;
 }
 
 #define DEV_SNMP6_DIRNAME   "/proc/net/dev_snmp6"
 #define IFINDEX_LINE        "ifIndex"
 #define DEV_FILENAME_LEN    64
 
+/*
+ * Open one /proc/net/dev_snmp6 file, and find the interface index.  If
+ * a stat file name is made of digits, the name is interface index.  If
+ * it is an interface name, the file includes a line labeled ifIndex.
+ */
+static FILE *
+_systemstats_v6_open_dev(const char *name, oid *if_index)
+{
+    char            dev_filename[DEV_FILENAME_LEN];
+    char            line[1024];
+    char           *scan_str;
+    FILE           *devin;
+
+    if (snprintf(dev_filename, DEV_FILENAME_LEN, "%s/%s", DEV_SNMP6_DIRNAME,
+                 name) >= DEV_FILENAME_LEN) {
+        snmp_log(LOG_ERR, "Interface name %s is too long\n", name);
+        return NULL;
+    }
+    if (NULL == (devin = fopen(dev_filename, "r"))) {
+        DEBUGMSGTL(("access:ifstats", "Failed to open %s\n", dev_filename));
+        return NULL;
+    }
+
+    if (isdigit((unsigned char) name[0])) {
+        *if_index = strtoul(name, NULL, 0);
+        return devin;
+    }
+
+    if (NULL == fgets(line, sizeof(line), devin)) {
+        snmp_log(LOG_ERR, "%s doesn't include any lines\n", dev_filename);
+    } else if (0 != strncmp(line, IFINDEX_LINE, 7)) {
+        snmp_log(LOG_ERR, "%s doesn't include ifIndex line", dev_filename);
+    } else if (NULL == (scan_str = strrchr(line, ' '))) {
+        snmp_log(LOG_ERR, "%s is wrong format", dev_filename);
+    } else {
+        *if_index = strtoul(scan_str, NULL, 0);
+        return devin;
+    }
+    fclose(devin);
+    return NULL;
+}
+
+/*
+ * The interface index of a /proc/net/dev_snmp6 file, without opening
+ * it, or 0 if the interface has gone.
+ */
+static oid
+_systemstats_v6_dev_index(int sd, const char *name)
+{
+    struct ifreq    ifr;
+
+    if (isdigit((unsigned char) name[0]))
+        return strtoul(name, NULL, 0);
+
+    if (sd < 0 || strlen(name) >= sizeof(ifr.ifr_name))
+        return 0;
+    memset(&ifr, 0, sizeof(ifr));
+    strcpy(ifr.ifr_name, name);
+    if (ioctl(sd, SIOCGIFINDEX, &ifr) < 0) {
+        DEBUGMSGTL(("access:ifstats", "no index for %s: %s\n", name,
+                    strerror(errno)));
+        return 0;
+    }
+    return ifr.ifr_ifindex;
+}
+
 /*
  * load ipIfStatsTable for ipv6 entries
+ *
+ * With NETSNMP_ACCESS_SYSTEMSTATS_LOAD_INDEXES, only the directory is
+ * read: each entry's file is left for
+ * netsnmp_access_systemstats_entry_arch_load, when (and if) the entry
+ * is asked for.
  */
 static int 
 _systemstats_v6_load_ifstats(netsnmp_container* container, u_int load_flags)
 {
     DIR            *dev_snmp6_dir;
     struct dirent  *dev_snmp6_entry;
-    char           dev_filename[DEV_FILENAME_LEN];
-    FILE           *devin;
-    char           line[1024];
-    char           *start = line;
-    char           *scan_str;
-    uintmax_t       scan_val;
+    FILE           *devin = NULL;
+    oid             if_index;
+    int             sd = -1;
     netsnmp_systemstats_entry *entry = NULL;
             
     /*
@@ -602,6 +456,8 @@ _systemstats_v6_load_ifstats(netsnmp_container* container, u_int load_flags)
         "Failed to load IPv6 IfStats Table (linux)\n"));
         return 0;
     }
+    if (load_flags & NETSNMP_ACCESS_SYSTEMSTATS_LOAD_INDEXES)
+        sd = socket(AF_INET6, SOCK_DGRAM, 0);
     
     /*
      * Read each per interface statistics proc file
@@ -610,63 +466,72 @@ _systemstats_v6_load_ifstats(netsnmp_container* container, u_int load_flags)
         if (dev_snmp6_entry->d_name[0] == '.')
             continue;
     
-        if (snprintf(dev_filename, DEV_FILENAME_LEN, "%s/%s", DEV_SNMP6_DIRNAME,
-                dev_snmp6_entry->d_name) > DEV_FILENAME_LEN) {
-            snmp_log(LOG_ERR, "Interface name %s is too long\n",
-                    dev_snmp6_entry->d_name);
-            continue;
-        }
-        if (NULL == (devin = fopen(dev_filename, "r"))) {
-            snmp_log(LOG_ERR, "Failed to open %s\n", dev_filename);
-            continue;
-        }
-    
-        /*
-         * If a stat file name is made of digits, the name is interface index.
-         * If it is an interface name, the file includes a line labeled ifIndex.
-         */
-        if (isdigit(dev_snmp6_entry->d_name[0])) {
-            scan_val = strtoull(dev_snmp6_entry->d_name, NULL, 0);
-        } else {
-            if (NULL == (start = fgets(line, sizeof(line), devin))) {
-                snmp_log(LOG_ERR, "%s doesn't include any lines\n",
-                        dev_filename);
-                fclose(devin);
-                continue;
-            }
-    
-            if (0 != strncmp(start, IFINDEX_LINE, 7)) {
-                snmp_log(LOG_ERR, "%s doesn't include ifIndex line",
-                        dev_filename);
-                fclose(devin);
+        if (load_flags & NETSNMP_ACCESS_SYSTEMSTATS_LOAD_INDEXES) {
+            if_index = _systemstats_v6_dev_index(sd, dev_snmp6_entry->d_name);
+            if (0 == if_index)
                 continue;
-            }
-
-            scan_str = strrchr(line, ' ');
-            if (NULL == scan_str) {
-                snmp_log(LOG_ERR, "%s is wrong format", dev_filename);
-                fclose(devin);
+        } else {
+            devin = _systemstats_v6_open_dev(dev_snmp6_entry->d_name,
+                                             &if_index);
+            if (NULL == devin)
                 continue;
-            }
-            scan_val = strtoull(scan_str, NULL, 0);
         }
-        
-        entry = netsnmp_access_systemstats_entry_create(2, scan_val,
+
+        entry = netsnmp_access_systemstats_entry_create(2, if_index,
                 "ipIfStatsTable.ipv6");
         if(NULL == entry) {
-            fclose(devin);
+            if (devin)
+                fclose(devin);
+            if (sd >= 0)
+                close(sd);
             closedir(dev_snmp6_dir);
             return -3;
         }
         
-        _systemstats_v6_load_file(entry, devin);
-        CONTAINER_INSERT(container, entry);
-        fclose(devin);
+        if (devin) {
+            _systemstats_v6_load_file(entry, devin);
+            fclose(devin);
+            devin = NULL;
+        }
+        if (CONTAINER_INSERT(container, entry) < 0)
+            netsnmp_access_systemstats_entry_free(entry);
     }
+    if (sd >= 0)
+        close(sd);
     closedir(dev_snmp6_dir);
     return 0;
 }
 
+/*
+ * load the statistics of one ipIfStatsTable entry
+ */
+static int
+_systemstats_v6_load_dev(netsnmp_systemstats_entry *entry)
+{
+    char            name[IF_NAMESIZE];
+    oid             if_index = 0;
+    FILE           *devin = NULL;
+
+    if (if_indextoname(entry->index[1], name))
+        devin = _systemstats_v6_open_dev(name, &if_index);
+    if (NULL == devin) {
+        snprintf(name, sizeof(name), "%" NETSNMP_PRIo "u", entry->index[1]);
+        devin = _systemstats_v6_open_dev(name, &if_index);
+    }
+    if (NULL == devin)
+        return -2;
+    if (if_index != entry->index[1]) {
+        /* renamed since we looked it up */
+        fclose(devin);
+        return -2;
+    }
+
+    memset(&entry->stats, 0, sizeof(entry->stats));
+    _systemstats_v6_load_file(entry, devin);
+    fclose(devin);
+    return 0;
+}
+
 /*
  * Based on load_flags, load ipSystemStatsTable or ipIfStatsTable for ipv6 entries. 
  */
@@ -687,3 +552,23 @@ _systemstats_v6(netsnmp_container* container, u_int load_flags)
     }
 }
 #endif /* NETSNMP_ENABLE_IPV6 */
+
+/*
+ * load the statistics of one entry of a NETSNMP_ACCESS_SYSTEMSTATS_LOAD_INDEXES
+ * container load
+ *
+ * @retval  0 success
+ * @retval -1 not supported
+ * @retval -2 could not open file
+ */
+int
+netsnmp_access_systemstats_entry_arch_load(netsnmp_systemstats_entry *entry,
+                                           u_int load_flags)
+{
+#if defined (NETSNMP_ENABLE_IPV6)
+    if ((load_flags & NETSNMP_ACCESS_SYSTEMSTATS_LOAD_IFTABLE) &&
+        2 == entry->index[0])
+        return _systemstats_v6_load_dev(entry);
+#endif
+    return -1;
+}
@@ -46,6 +46,13 @@ netsnmp_access_systemstats_container_arch_load(netsnmp_container* container,
     return (0);
 }
 
+int
+netsnmp_access_systemstats_entry_arch_load(netsnmp_systemstats_entry *entry,
+                                           u_int load_flags)
+{
+    return -1; /* we do not support ipIfStatsTable yet */
+}
+
 /*
  * @retval 0 success 
  * @retval <0 error
@@ -333,6 +333,28 @@ inetNetToMediaTable_container_load(netsnmp_container *container)
     return MFD_SUCCESS;
 }                               /* inetNetToMediaTable_container_load */
 
+/**
+ * load the part of the data that a request needs
+ *
+ * @param container container to which items should be inserted
+ * @param range     the row at an index, or the first row after one
+ *
+ * @retval MFD_SKIP    : load the whole table instead
+ *
+ *  The arp access keeps the container in step with the kernel's
+ *  neighbour table (netlink notifications, where there are any), and
+ *  only reads the whole table when it has lost track. A load of a
+ *  single row would throw that copy away, so this always declines.
+ */
+int
+inetNetToMediaTable_container_load_range(netsnmp_container *container,
+                                         const netsnmp_cache_range *range)
+{
+    DEBUGMSGTL(("verbose:inetNetToMediaTable:inetNetToMediaTable_container_load_range", "called\n"));
+
+    return MFD_SKIP;
+}                               /* inetNetToMediaTable_container_load_range */
+
 /**
  * container clean up
  *
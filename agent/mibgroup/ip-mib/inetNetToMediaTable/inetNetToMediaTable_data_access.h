@@ -56,6 +56,11 @@ extern          "C" {
 
     int             inetNetToMediaTable_container_load(netsnmp_container
                                                        *container);
+    int             inetNetToMediaTable_container_load_range(netsnmp_container
+                                                             *container,
+                                                             const
+                                                             netsnmp_cache_range
+                                                             *range);
     void            inetNetToMediaTable_container_free(netsnmp_container
                                                        *container);
 
@@ -53,6 +53,7 @@ netsnmp_feature_require(row_merge)
 netsnmp_feature_require(baby_steps)
 netsnmp_feature_require(table_container_row_insert)
 netsnmp_feature_require(check_all_requests_error)
+netsnmp_feature_require(cache_hint_range)
 
 
 netsnmp_feature_child_of(inetNetToMediaTable_container_size, inetNetToMediaTable_external_access)
@@ -1844,6 +1845,9 @@ static void     _container_free(netsnmp_container *container);
 static int
 _cache_load(netsnmp_cache * cache, void *vmagic)
 {
+    netsnmp_cache_range range;
+    int             rc;
+
     DEBUGTRACE;
 
     if ((NULL == cache) || (NULL == cache->magic)) {
@@ -1857,8 +1861,19 @@ _cache_load(netsnmp_cache * cache, void *vmagic)
     netsnmp_assert((0 == cache->valid) || (1 == cache->expired));
 
     /*
-     * call user code
+     * call user code, for the one row a request needs if it can
      */
+    if (netsnmp_cache_hint_range(cache, &range)) {
+        rc = inetNetToMediaTable_container_load_range((netsnmp_container *)
+                                                      cache->magic, &range);
+        if (MFD_SUCCESS == rc) {
+            cache->flags |= NETSNMP_CACHE_PARTIAL_LOAD;
+            return rc;
+        }
+        if (MFD_SKIP != rc)
+            return rc;
+    }
+
     return inetNetToMediaTable_container_load((netsnmp_container *) cache->
                                               magic);
 }                               /* _cache_load */
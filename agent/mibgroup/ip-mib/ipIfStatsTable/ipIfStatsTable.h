@@ -138,6 +138,7 @@ config_require(ip-mib/ipIfStatsTable/ipIfStatsTable_data_get)
         char            known_missing;
         uint32_t        ipIfStatsDiscontinuityTime;
         uint32_t        ipIfStatsRefreshRate;
+        u_long          stats_loaded;   /* agent uptime, 0 if never */
 
         /*
          * storage for future expansion
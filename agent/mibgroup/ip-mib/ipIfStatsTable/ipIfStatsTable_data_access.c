@@ -152,6 +152,9 @@ ipIfStatsTable_container_init(netsnmp_container ** container_ptr_ptr,
 
 /**
  * check entry for update
+ *
+ * The container is loaded with just the indexes; each row's statistics
+ * are loaded by ipIfStatsTable_row_prep, when it is asked for.
  */
 static void
 _check_for_updates(ipIfStatsTable_rowreq_ctx * rowreq_ctx,
@@ -179,16 +182,12 @@ _check_for_updates(ipIfStatsTable_rowreq_ctx * rowreq_ctx,
                     "updating existing entry\n"));
 
         /*
-         * Check for changes & update
-         */
-        netsnmp_access_systemstats_entry_update(rowreq_ctx->data,
-                                            ifstats_entry);
-
-        /*
-         * set discontinuity if previously missing.
+         * set discontinuity if previously missing, and reload the
+         * statistics next time the row is asked for.
          */
         if (1 == rowreq_ctx->known_missing) {
             rowreq_ctx->known_missing = 0;
+            rowreq_ctx->stats_loaded = 0;
             rowreq_ctx->ipIfStatsDiscontinuityTime =
                 netsnmp_get_agent_uptime();
             ipIfStatsTable_lastChange_set(netsnmp_get_agent_uptime());
@@ -315,7 +314,9 @@ ipIfStatsTable_container_load(netsnmp_container * container)
 
     netsnmp_assert(NULL != container);
 
-    stats = netsnmp_access_systemstats_container_load(NULL, NETSNMP_ACCESS_SYSTEMSTATS_LOAD_IFTABLE);
+    stats = netsnmp_access_systemstats_container_load(NULL,
+                NETSNMP_ACCESS_SYSTEMSTATS_LOAD_IFTABLE |
+                NETSNMP_ACCESS_SYSTEMSTATS_LOAD_INDEXES);
     if (NULL == stats)
         return MFD_RESOURCE_UNAVAILABLE;        /* msg already logged */
 
@@ -393,16 +394,38 @@ ipIfStatsTable_container_free(netsnmp_container * container)
 int
 ipIfStatsTable_row_prep(ipIfStatsTable_rowreq_ctx * rowreq_ctx)
 {
+    netsnmp_systemstats_entry *ifstats_entry;
+    u_long          now;
+
     DEBUGMSGTL(("verbose:ipIfStatsTable:ipIfStatsTable_row_prep",
                 "called\n"));
 
     netsnmp_assert(NULL != rowreq_ctx);
 
     /*
-     * TODO:390:o: Prepare row for request.
-     * If populating row data was delayed, this is the place to
-     * fill in the row for this request.
+     * the container only has the indexes; load this row's statistics
+     * if they are older than the refresh rate.
      */
+    now = netsnmp_get_agent_uptime();
+    if (rowreq_ctx->stats_loaded &&
+        now - rowreq_ctx->stats_loaded < (u_long) ipis_cache_refresh * 100)
+        return MFD_SUCCESS;
+
+    ifstats_entry =
+        netsnmp_access_systemstats_entry_create(rowreq_ctx->data->index[0],
+                                                rowreq_ctx->data->index[1],
+                                                rowreq_ctx->data->tableName);
+    if (NULL == ifstats_entry)
+        return MFD_SUCCESS;     /* keep the old statistics */
+    if (netsnmp_access_systemstats_entry_load(ifstats_entry,
+                NETSNMP_ACCESS_SYSTEMSTATS_LOAD_IFTABLE) == 0) {
+        netsnmp_access_systemstats_entry_update(rowreq_ctx->data,
+                                                ifstats_entry);
+        rowreq_ctx->stats_loaded = now ? now : 1;
+    } else
+        DEBUGMSGTL(("ipIfStatsTable:access", "no statistics for %"
+                    NETSNMP_PRIo "u\n", rowreq_ctx->data->index[1]));
+    netsnmp_access_systemstats_entry_free(ifstats_entry);
 
     return MFD_SUCCESS;
 }                               /* ipIfStatsTable_row_prep */
@@ -16,7 +16,9 @@
 #include <sys/param.h>
 #endif
 #include <errno.h>
+#include <stddef.h>
 
+#include "util_funcs/netstats.h"
 #include "kernel_linux.h"
 
 struct ip_mib   cached_ip_mib;
@@ -28,191 +30,274 @@ struct tcp_mib  cached_tcp_mib;
 struct udp_mib  cached_udp_mib;
 struct udp6_mib  cached_udp6_mib;
 
-#define IP_STATS_LINE	"Ip: %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu"
-#define ICMP_STATS_LINE	"Icmp: %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu"
-#define ICMP_MSG_STATS_LINE "IcmpMsg: "
-#define TCP_STATS_LINE	"Tcp: %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu"
-#define UDP_STATS_LINE	"Udp: %lu %lu %lu %lu"
-#define IP6_STATS_LINE   "Ip6"
-#define ICMP6_STATS_LINE "Icmp6"
-#define UDP6_STATS_LINE "Udp6"
-
-#define IP_STATS_PREFIX_LEN	4
-#define ICMP_STATS_PREFIX_LEN	6
-#define ICMP_MSG_STATS_PREFIX_LEN 9
-#define TCP_STATS_PREFIX_LEN	5
-#define UDP_STATS_PREFIX_LEN	5
-#define IP6_STATS_PREFIX_LEN	3
-#define ICMP6_STATS_PREFIX_LEN	5
-#define UDP6_STATS_PREFIX_LEN   4
-
 netsnmp_feature_child_of(linux_ip6_stat_all, libnetsnmpmibs)
 
 netsnmp_feature_child_of(linux_read_ip6_stat, linux_ip6_stat_all)
 
-int
-decode_icmp_msg(char *line, char *data, struct icmp4_msg_mib *msg)
+/*
+ * The counters are all taken from the shared netstats snapshot, by the
+ * names the kernel gives them.
+ */
+struct kernel_linux_field {
+    const char     *name;
+    size_t          offset;
+};
+#define NFIELDS(f)        (sizeof(f) / sizeof((f)[0]))
+
+#define IP_FIELD(f, n)    { n, offsetof(struct ip_mib, f) }
+static const struct kernel_linux_field ip_fields[] = {
+    IP_FIELD(ipForwarding,      "Forwarding"),
+    IP_FIELD(ipDefaultTTL,      "DefaultTTL"),
+    IP_FIELD(ipInReceives,      "InReceives"),
+    IP_FIELD(ipInHdrErrors,     "InHdrErrors"),
+    IP_FIELD(ipInAddrErrors,    "InAddrErrors"),
+    IP_FIELD(ipForwDatagrams,   "ForwDatagrams"),
+    IP_FIELD(ipInUnknownProtos, "InUnknownProtos"),
+    IP_FIELD(ipInDiscards,      "InDiscards"),
+    IP_FIELD(ipInDelivers,      "InDelivers"),
+    IP_FIELD(ipOutRequests,     "OutRequests"),
+    IP_FIELD(ipOutDiscards,     "OutDiscards"),
+    IP_FIELD(ipOutNoRoutes,     "OutNoRoutes"),
+    IP_FIELD(ipReasmTimeout,    "ReasmTimeout"),
+    IP_FIELD(ipReasmReqds,      "ReasmReqds"),
+    IP_FIELD(ipReasmOKs,        "ReasmOKs"),
+    IP_FIELD(ipReasmFails,      "ReasmFails"),
+    IP_FIELD(ipFragOKs,         "FragOKs"),
+    IP_FIELD(ipFragFails,       "FragFails"),
+    IP_FIELD(ipFragCreates,     "FragCreates"),
+};
+
+#define ICMP_FIELD(f, n)  { n, offsetof(struct icmp_mib, f) }
+static const struct kernel_linux_field icmp_fields[] = {
+    ICMP_FIELD(icmpInMsgs,           "InMsgs"),
+    ICMP_FIELD(icmpInErrors,         "InErrors"),
+    ICMP_FIELD(icmpInDestUnreachs,   "InDestUnreachs"),
+    ICMP_FIELD(icmpInTimeExcds,      "InTimeExcds"),
+    ICMP_FIELD(icmpInParmProbs,      "InParmProbs"),
+    ICMP_FIELD(icmpInSrcQuenchs,     "InSrcQuenchs"),
+    ICMP_FIELD(icmpInRedirects,      "InRedirects"),
+    ICMP_FIELD(icmpInEchos,          "InEchos"),
+    ICMP_FIELD(icmpInEchoReps,       "InEchoReps"),
+    ICMP_FIELD(icmpInTimestamps,     "InTimestamps"),
+    ICMP_FIELD(icmpInTimestampReps,  "InTimestampReps"),
+    ICMP_FIELD(icmpInAddrMasks,      "InAddrMasks"),
+    ICMP_FIELD(icmpInAddrMaskReps,   "InAddrMaskReps"),
+    ICMP_FIELD(icmpOutMsgs,          "OutMsgs"),
+    ICMP_FIELD(icmpOutErrors,        "OutErrors"),
+    ICMP_FIELD(icmpOutDestUnreachs,  "OutDestUnreachs"),
+    ICMP_FIELD(icmpOutTimeExcds,     "OutTimeExcds"),
+    ICMP_FIELD(icmpOutParmProbs,     "OutParmProbs"),
+    ICMP_FIELD(icmpOutSrcQuenchs,    "OutSrcQuenchs"),
+    ICMP_FIELD(icmpOutRedirects,     "OutRedirects"),
+    ICMP_FIELD(icmpOutEchos,         "OutEchos"),
+    ICMP_FIELD(icmpOutEchoReps,      "OutEchoReps"),
+    ICMP_FIELD(icmpOutTimestamps,    "OutTimestamps"),
+    ICMP_FIELD(icmpOutTimestampReps, "OutTimestampReps"),
+    ICMP_FIELD(icmpOutAddrMasks,     "OutAddrMasks"),
+    ICMP_FIELD(icmpOutAddrMaskReps,  "OutAddrMaskReps"),
+};
+
+#define TCP_FIELD(f, n)   { n, offsetof(struct tcp_mib, f) }
+static const struct kernel_linux_field tcp_fields[] = {
+    TCP_FIELD(tcpRtoAlgorithm, "RtoAlgorithm"),
+    TCP_FIELD(tcpRtoMin,       "RtoMin"),
+    TCP_FIELD(tcpRtoMax,       "RtoMax"),
+    TCP_FIELD(tcpMaxConn,      "MaxConn"),
+    TCP_FIELD(tcpActiveOpens,  "ActiveOpens"),
+    TCP_FIELD(tcpPassiveOpens, "PassiveOpens"),
+    TCP_FIELD(tcpAttemptFails, "AttemptFails"),
+    TCP_FIELD(tcpEstabResets,  "EstabResets"),
+    TCP_FIELD(tcpCurrEstab,    "CurrEstab"),
+    TCP_FIELD(tcpInSegs,       "InSegs"),
+    TCP_FIELD(tcpOutSegs,      "OutSegs"),
+    TCP_FIELD(tcpRetransSegs,  "RetransSegs"),
+};
+
+#define UDP_FIELD(f, n)   { n, offsetof(struct udp_mib, f) }
+static const struct kernel_linux_field udp_fields[] = {
+    UDP_FIELD(udpInDatagrams,  "InDatagrams"),
+    UDP_FIELD(udpNoPorts,      "NoPorts"),
+    UDP_FIELD(udpInErrors,     "InErrors"),
+    UDP_FIELD(udpOutDatagrams, "OutDatagrams"),
+};
+
+#ifdef NETSNMP_ENABLE_IPV6
+#define IP6_FIELD(f, n)   { n, offsetof(struct ip6_mib, f) }
+static const struct kernel_linux_field ip6_fields[] = {
+    IP6_FIELD(ip6InReceives,       "InReceives"),
+    IP6_FIELD(ip6InHdrErrors,      "InHdrErrors"),
+    IP6_FIELD(ip6InTooBigErrors,   "InTooBigErrors"),
+    IP6_FIELD(ip6InNoRoutes,       "InNoRoutes"),
+    IP6_FIELD(ip6InAddrErrors,     "InAddrErrors"),
+    IP6_FIELD(ip6InUnknownProtos,  "InUnknownProtos"),
+    IP6_FIELD(ip6InTruncatedPkts,  "InTruncatedPkts"),
+    IP6_FIELD(ip6InDiscards,       "InDiscards"),
+    IP6_FIELD(ip6InDelivers,       "InDelivers"),
+    IP6_FIELD(ip6OutForwDatagrams, "OutForwDatagrams"),
+    IP6_FIELD(ip6OutRequests,      "OutRequests"),
+    IP6_FIELD(ip6OutDiscards,      "OutDiscards"),
+    IP6_FIELD(ip6OutNoRoutes,      "OutNoRoutes"),
+    IP6_FIELD(ip6ReasmTimeout,     "ReasmTimeout"),
+    IP6_FIELD(ip6ReasmReqds,       "ReasmReqds"),
+    IP6_FIELD(ip6ReasmOKs,         "ReasmOKs"),
+    IP6_FIELD(ip6ReasmFails,       "ReasmFails"),
+    IP6_FIELD(ip6FragOKs,          "FragOKs"),
+    IP6_FIELD(ip6FragFails,        "FragFails"),
+    IP6_FIELD(ip6FragCreates,      "FragCreates"),
+    IP6_FIELD(ip6InMcastPkts,      "InMcastPkts"),
+    IP6_FIELD(ip6OutMcastPkts,     "OutMcastPkts"),
+};
+
+#define ICMP6_FIELD(f, n) { n, offsetof(struct icmp6_mib, f) }
+static const struct kernel_linux_field icmp6_fields[] = {
+    ICMP6_FIELD(icmp6InMsgs,                    "InMsgs"),
+    ICMP6_FIELD(icmp6InErrors,                  "InErrors"),
+    ICMP6_FIELD(icmp6InDestUnreachs,            "InDestUnreachs"),
+    ICMP6_FIELD(icmp6InPktTooBigs,              "InPktTooBigs"),
+    ICMP6_FIELD(icmp6InTimeExcds,               "InTimeExcds"),
+    ICMP6_FIELD(icmp6InParmProblems,            "InParmProblems"),
+    ICMP6_FIELD(icmp6InEchos,                   "InEchos"),
+    ICMP6_FIELD(icmp6InEchoReplies,             "InEchoReplies"),
+    ICMP6_FIELD(icmp6InGroupMembQueries,        "InGroupMembQueries"),
+    ICMP6_FIELD(icmp6InGroupMembResponses,      "InGroupMembResponses"),
+    ICMP6_FIELD(icmp6InGroupMembReductions,     "InGroupMembReductions"),
+    ICMP6_FIELD(icmp6InRouterSolicits,          "InRouterSolicits"),
+    ICMP6_FIELD(icmp6InRouterAdvertisements,    "InRouterAdvertisements"),
+    ICMP6_FIELD(icmp6InNeighborSolicits,        "InNeighborSolicits"),
+    ICMP6_FIELD(icmp6InNeighborAdvertisements,  "InNeighborAdvertisements"),
+    ICMP6_FIELD(icmp6InRedirects,               "InRedirects"),
+    ICMP6_FIELD(icmp6OutMsgs,                   "OutMsgs"),
+    ICMP6_FIELD(icmp6OutDestUnreachs,           "OutDestUnreachs"),
+    ICMP6_FIELD(icmp6OutPktTooBigs,             "OutPktTooBigs"),
+    ICMP6_FIELD(icmp6OutTimeExcds,              "OutTimeExcds"),
+    ICMP6_FIELD(icmp6OutParmProblems,           "OutParmProblems"),
+    ICMP6_FIELD(icmp6OutEchoReplies,            "OutEchoReplies"),
+    ICMP6_FIELD(icmp6OutRouterSolicits,         "OutRouterSolicits"),
+    ICMP6_FIELD(icmp6OutNeighborSolicits,       "OutNeighborSolicits"),
+    ICMP6_FIELD(icmp6OutNeighborAdvertisements, "OutNeighborAdvertisements"),
+    ICMP6_FIELD(icmp6OutRedirects,              "OutRedirects"),
+    ICMP6_FIELD(icmp6OutGroupMembResponses,     "OutGroupMembResponses"),
+    ICMP6_FIELD(icmp6OutGroupMembReductions,    "OutGroupMembReductions"),
+};
+
+#define UDP6_FIELD(f, n)  { n, offsetof(struct udp6_mib, f) }
+static const struct kernel_linux_field udp6_fields[] = {
+    UDP6_FIELD(udp6InDatagrams,  "InDatagrams"),
+    UDP6_FIELD(udp6NoPorts,      "NoPorts"),
+    UDP6_FIELD(udp6InErrors,     "InErrors"),
+    UDP6_FIELD(udp6OutDatagrams, "OutDatagrams"),
+};
+#endif /* NETSNMP_ENABLE_IPV6 */
+
+/*
+ * the generation of the snapshot the cached v4 statistics came from,
+ * and whether it had IcmpMsg counters
+ */
+static unsigned int cached_generation = 0;
+static int      cached_icmp_msg_valid = 0;
+
+/*
+ * copy a group's counters into a mib structure (of unsigned longs)
+ */
+static int
+_kernel_linux_fill(const netsnmp_netstats *stats, const char *group,
+                   const struct kernel_linux_field *fields, int nfields,
+                   void *mib)
 {
-    char *token, *saveptr, *lineptr, *saveptr1, *dataptr, *delim = NULL;
-    char line_cpy[1024];
-    char data_cpy[1024];
-    long index;
+    unsigned long long value;
+    int             i, found = 0;
 
-    if(data == NULL)
-        return -1;
+    for (i = 0; i < nfields; i++) {
+        if (netsnmp_netstats_value(stats, group, fields[i].name, &value) < 0)
+            continue;
+        *(unsigned long *) ((char *) mib + fields[i].offset) = value;
+        found++;
+    }
+    DEBUGMSGTL(("mibII/kernel_linux", "%s: %d of %d counters\n", group,
+                found, nfields));
+    return found;
+}
 
-    /*
-     * Since we are using strtok, there is a possiblity of the orginal data
-     * getting modified. So we take a local copy for this purpose even though
-     * its expensive.
-     */
-    strncpy(line_cpy, line, sizeof(line_cpy));
-    strncpy(data_cpy, data, sizeof(data_cpy));
-
-    lineptr = line_cpy;
-    dataptr = data_cpy;
-    saveptr1 = NULL;
-    while (1) {
-        if(NULL == (token = strtok_r(lineptr, " ", &saveptr)))
-            break;
-        lineptr = NULL;
-        errno = 0;
-        if (0 == strncmp(strsep(&token, "e"), "OutTyp", 6)) {
-            index = strtol(token, &delim, 0);
-            if (ERANGE == errno) {
-                continue;
-            } else if (index > LONG_MAX) {
-                continue;
-            } else if (index < LONG_MIN) {
-                continue;
-            }
-            if (NULL == (token = strtok_r(dataptr, " ", &saveptr1)))
-                break;
-            dataptr = NULL;
-            msg->vals[index].OutType = atoi(token);
-        } else {
-            index = strtol(token, &delim, 0);
-            if (ERANGE == errno) {
-                continue;
-            } else if (index > LONG_MAX) {
-                continue;
-            } else if (index < LONG_MIN) {
-                continue;
-            }
-            if(NULL == (token = strtok_r(dataptr, " ", &saveptr1)))
-                break;
-            dataptr = NULL;
-            msg->vals[index].InType = atoi(token);
-        }
+/*
+ * the IcmpMsg (and Icmp6) per-type counters are called InTypeN and
+ * OutTypeN
+ */
+static int
+_kernel_linux_msg_fill(const netsnmp_netstats *stats, const char *group,
+                       struct icmp_msg_mib *vals)
+{
+    const netsnmp_netstats_group *g;
+    const char     *name;
+    char           *end;
+    long            type;
+    int             i, found = 0;
+
+    g = netsnmp_netstats_group_find(stats, group);
+    if (!g)
+        return 0;
+    for (i = g->first; i < g->first + g->count; i++) {
+        name = stats->names[i];
+        if (!strncmp(name, "InType", 6))
+            type = strtol(name + 6, &end, 10);
+        else if (!strncmp(name, "OutType", 7))
+            type = strtol(name + 7, &end, 10);
+        else
+            continue;
+        if (*end || type < 0 || type >= 255)
+            continue;
+        if (name[0] == 'I')
+            vals[type].InType = stats->values[i];
+        else
+            vals[type].OutType = stats->values[i];
+        found++;
     }
-    return 0;
+    return found;
 }
 
 int
 linux_read_mibII_stats(void)
 {
-    FILE           *in = fopen("/proc/net/snmp", "r");
-    char            line[1024], data[1024];
-    int ret = 0;
-    if (!in) {
-        DEBUGMSGTL(("mibII/kernel_linux","Unable to open /proc/net/snmp"));
+    const netsnmp_netstats *stats = netsnmp_netstats_get();
+    unsigned long long value;
+
+    if (!stats) {
+        DEBUGMSGTL(("mibII/kernel_linux","Unable to read the statistics\n"));
         return -1;
     }
-
-
-    memset(line, '\0', sizeof(line));
-    memset(data, '\0', sizeof(data));
-    while (line == fgets(line, sizeof(line), in)) {
-        if (!strncmp(line, IP_STATS_LINE, IP_STATS_PREFIX_LEN)) {
-            sscanf(line, IP_STATS_LINE,
-                   &cached_ip_mib.ipForwarding,
-                   &cached_ip_mib.ipDefaultTTL,
-                   &cached_ip_mib.ipInReceives,
-                   &cached_ip_mib.ipInHdrErrors,
-                   &cached_ip_mib.ipInAddrErrors,
-                   &cached_ip_mib.ipForwDatagrams,
-                   &cached_ip_mib.ipInUnknownProtos,
-                   &cached_ip_mib.ipInDiscards,
-                   &cached_ip_mib.ipInDelivers,
-                   &cached_ip_mib.ipOutRequests,
-                   &cached_ip_mib.ipOutDiscards,
-                   &cached_ip_mib.ipOutNoRoutes,
-                   &cached_ip_mib.ipReasmTimeout,
-                   &cached_ip_mib.ipReasmReqds,
-                   &cached_ip_mib.ipReasmOKs,
-                   &cached_ip_mib.ipReasmFails,
-                   &cached_ip_mib.ipFragOKs,
-                   &cached_ip_mib.ipFragFails,
-                   &cached_ip_mib.ipFragCreates);
-            cached_ip_mib.ipRoutingDiscards = 0;        /* XXX */
-        } else if (!strncmp(line, ICMP_STATS_LINE, ICMP_STATS_PREFIX_LEN)) {
-            sscanf(line, ICMP_STATS_LINE,
-                   &cached_icmp_mib.icmpInMsgs,
-                   &cached_icmp_mib.icmpInErrors,
-                   &cached_icmp_mib.icmpInDestUnreachs,
-                   &cached_icmp_mib.icmpInTimeExcds,
-                   &cached_icmp_mib.icmpInParmProbs,
-                   &cached_icmp_mib.icmpInSrcQuenchs,
-                   &cached_icmp_mib.icmpInRedirects,
-                   &cached_icmp_mib.icmpInEchos,
-                   &cached_icmp_mib.icmpInEchoReps,
-                   &cached_icmp_mib.icmpInTimestamps,
-                   &cached_icmp_mib.icmpInTimestampReps,
-                   &cached_icmp_mib.icmpInAddrMasks,
-                   &cached_icmp_mib.icmpInAddrMaskReps,
-                   &cached_icmp_mib.icmpOutMsgs,
-                   &cached_icmp_mib.icmpOutErrors,
-                   &cached_icmp_mib.icmpOutDestUnreachs,
-                   &cached_icmp_mib.icmpOutTimeExcds,
-                   &cached_icmp_mib.icmpOutParmProbs,
-                   &cached_icmp_mib.icmpOutSrcQuenchs,
-                   &cached_icmp_mib.icmpOutRedirects,
-                   &cached_icmp_mib.icmpOutEchos,
-                   &cached_icmp_mib.icmpOutEchoReps,
-                   &cached_icmp_mib.icmpOutTimestamps,
-                   &cached_icmp_mib.icmpOutTimestampReps,
-                   &cached_icmp_mib.icmpOutAddrMasks,
-                   &cached_icmp_mib.icmpOutAddrMaskReps);
-        } else if (!strncmp(line, ICMP_MSG_STATS_LINE, ICMP_MSG_STATS_PREFIX_LEN)) {
-            /*
-             * Note: We have to do this differently from other stats as the
-             * counters to this stats are dynamic. So we will not know the
-             * number of counters at a given time.
-             */
-            fgets(data, sizeof(data), in);
-            if(decode_icmp_msg(line + ICMP_MSG_STATS_PREFIX_LEN,
-                        data + ICMP_MSG_STATS_PREFIX_LEN,
-                        &cached_icmp4_msg_mib) < 0) {
-                continue;
-            }
-            ret = 1;
-        } else if (!strncmp(line, TCP_STATS_LINE, TCP_STATS_PREFIX_LEN)) {
-            int             ret = sscanf(line, TCP_STATS_LINE,
-                                         &cached_tcp_mib.tcpRtoAlgorithm,
-                                         &cached_tcp_mib.tcpRtoMin,
-                                         &cached_tcp_mib.tcpRtoMax,
-                                         &cached_tcp_mib.tcpMaxConn,
-                                         &cached_tcp_mib.tcpActiveOpens,
-                                         &cached_tcp_mib.tcpPassiveOpens,
-                                         &cached_tcp_mib.tcpAttemptFails,
-                                         &cached_tcp_mib.tcpEstabResets,
-                                         &cached_tcp_mib.tcpCurrEstab,
-                                         &cached_tcp_mib.tcpInSegs,
-                                         &cached_tcp_mib.tcpOutSegs,
-                                         &cached_tcp_mib.tcpRetransSegs,
-                                         &cached_tcp_mib.tcpInErrs,
-                                         &cached_tcp_mib.tcpOutRsts);
-            cached_tcp_mib.tcpInErrsValid = (ret > 12) ? 1 : 0;
-            cached_tcp_mib.tcpOutRstsValid = (ret > 13) ? 1 : 0;
-        } else if (!strncmp(line, UDP_STATS_LINE, UDP_STATS_PREFIX_LEN)) {
-            sscanf(line, UDP_STATS_LINE,
-                   &cached_udp_mib.udpInDatagrams,
-                   &cached_udp_mib.udpNoPorts,
-                   &cached_udp_mib.udpInErrors,
-                   &cached_udp_mib.udpOutDatagrams);
-        }
+    if (stats->generation == cached_generation)
+        return cached_icmp_msg_valid;
+    cached_generation = stats->generation;
+
+    memset(&cached_ip_mib, 0, sizeof(cached_ip_mib));
+    memset(&cached_icmp_mib, 0, sizeof(cached_icmp_mib));
+    memset(&cached_icmp4_msg_mib, 0, sizeof(cached_icmp4_msg_mib));
+    memset(&cached_tcp_mib, 0, sizeof(cached_tcp_mib));
+    memset(&cached_udp_mib, 0, sizeof(cached_udp_mib));
+
+    _kernel_linux_fill(stats, "Ip", ip_fields, NFIELDS(ip_fields),
+                       &cached_ip_mib);
+    cached_ip_mib.ipRoutingDiscards = 0;        /* XXX */
+    _kernel_linux_fill(stats, "Icmp", icmp_fields, NFIELDS(icmp_fields),
+                       &cached_icmp_mib);
+    /*
+     * Note: the number of IcmpMsg counters varies, as the kernel only
+     * lists the types it has seen.
+     */
+    cached_icmp_msg_valid =
+        netsnmp_netstats_group_find(stats, "IcmpMsg") != NULL;
+    _kernel_linux_msg_fill(stats, "IcmpMsg", cached_icmp4_msg_mib.vals);
+    _kernel_linux_fill(stats, "Tcp", tcp_fields, NFIELDS(tcp_fields),
+                       &cached_tcp_mib);
+    if (netsnmp_netstats_value(stats, "Tcp", "InErrs", &value) == 0) {
+        cached_tcp_mib.tcpInErrs = value;
+        cached_tcp_mib.tcpInErrsValid = 1;
     }
-    fclose(in);
+    if (netsnmp_netstats_value(stats, "Tcp", "OutRsts", &value) == 0) {
+        cached_tcp_mib.tcpOutRsts = value;
+        cached_tcp_mib.tcpOutRstsValid = 1;
+    }
+    _kernel_linux_fill(stats, "Udp", udp_fields, NFIELDS(udp_fields),
+                       &cached_udp_mib);
 
     /*
      * Tweak illegal values:
@@ -230,7 +315,7 @@ linux_read_mibII_stats(void)
     if (!cached_tcp_mib.tcpRtoAlgorithm)
         cached_tcp_mib.tcpRtoAlgorithm = 1;
 
-    return ret;
+    return cached_icmp_msg_valid;
 }
 
 int
@@ -246,107 +331,21 @@ linux_read_ip_stat(struct ip_mib *ipstat)
 #ifndef NETSNMP_FEATURE_REMOVE_LINUX_READ_IP6_STAT
 int linux_read_ip6_stat( struct ip6_mib *ip6stat)
 {
-#ifdef NETSNMP_ENABLE_IPV6
-    FILE           *in;
-    char            line[1024];
-    unsigned long   stats;
-    char           *endp;
-    int             match;
-#endif
-
     memset((char *) ip6stat, (0), sizeof(*ip6stat));
 
 #ifdef NETSNMP_ENABLE_IPV6
-    DEBUGMSGTL(("mibII/kernel_linux/ip6stats",
-                "Reading /proc/net/snmp6 stats\n"));
-    if (NULL == (in = fopen("/proc/net/snmp6", "r"))) {
-        DEBUGMSGTL(("mibII/kernel_linux/ip6stats",
-                    "Failed to open /proc/net/snmp6\n"));
-        return -1;
-    }
-
-    while (NULL != fgets(line, sizeof(line), in)) {
-        if (0 != strncmp(line, IP6_STATS_LINE, IP6_STATS_PREFIX_LEN))
-            continue;
-
-        if (1 != sscanf(line, "%*s %lu", &stats))
-            continue;
-
-        endp = strchr(line, ' ');
-        *endp = '\0';
-        DEBUGMSGTL(("mibII/kernel_linux/ip6stats", "Find tag: %s\n", line));
-
-        match = 1;
-        if (0 == strncmp(line + 3, "In", 2)) {  /* In */
-            if (0 == strcmp(line + 5, "AddrErrors")) {
-                cached_ip6_mib.ip6InAddrErrors = stats;
-            } else if (0 == strcmp(line + 5, "Delivers")) {
-                cached_ip6_mib.ip6InDelivers = stats;
-            } else if (0 == strcmp(line + 5, "Discards")) {
-                cached_ip6_mib.ip6InDiscards = stats;
-            } else if (0 == strcmp(line + 5, "HdrErrors")) {
-                cached_ip6_mib.ip6InHdrErrors = stats;
-            } else if (0 == strcmp(line + 5, "McastPkts")) {
-                cached_ip6_mib.ip6InMcastPkts = stats;
-            } else if (0 == strcmp(line + 5, "NoRoutes")) {
-                cached_ip6_mib.ip6InNoRoutes = stats;
-            } else if (0 == strcmp(line + 5, "Receives")) {
-                cached_ip6_mib.ip6InReceives = stats;
-            } else if (0 == strcmp(line + 5, "TruncatedPkts")) {
-                cached_ip6_mib.ip6InTruncatedPkts = stats;
-            } else if (0 == strcmp(line + 5, "TooBigErrors")) {
-                cached_ip6_mib.ip6InTooBigErrors = stats;
-            } else if (0 == strcmp(line + 5, "UnknownProtos")) {
-                cached_ip6_mib.ip6InUnknownProtos = stats;
-            } else {
-                match = 0;
-            }
-        } else if (0 == strncmp(line + 3, "Out", 3)) {  /* Out */
-            if (0 == strcmp(line + 6, "Discards")) {
-                cached_ip6_mib.ip6OutDiscards = stats;
-            } else if (0 == strcmp(line + 6, "ForwDatagrams")) {
-                cached_ip6_mib.ip6OutForwDatagrams = stats;
-            } else if (0 == strcmp(line + 6, "McastPkts")) {
-                cached_ip6_mib.ip6OutMcastPkts = stats;
-            } else if (0 == strcmp(line + 6, "NoRoutes")) {
-                cached_ip6_mib.ip6OutNoRoutes = stats;
-            } else if (0 == strcmp(line + 6, "Requests")) {
-                cached_ip6_mib.ip6OutRequests = stats;
-            } else {
-                match = 0;
-            }
-        } else if (0 == strncmp(line + 3, "Reasm", 5)) {  /* Reasm */
-            if (0 == strcmp(line + 8, "Fails")) {
-                cached_ip6_mib.ip6ReasmFails = stats;
-            } else if (0 == strcmp(line + 8, "OKs")) {
-                cached_ip6_mib.ip6ReasmOKs = stats;
-            } else if (0 == strcmp(line + 8, "Reqds")) {
-                cached_ip6_mib.ip6ReasmReqds = stats;
-            } else if (0 == strcmp(line + 8, "Timeout")) {
-                cached_ip6_mib.ip6ReasmTimeout = stats;
-            } else {
-                match = 0;
-            }
-        } else if (0 == strncmp(line + 3, "Frag", 4)) {  /* Frag */
-            if (0 == strcmp(line + 7, "Creates")) {
-                cached_ip6_mib.ip6FragCreates = stats;
-            } else if (0 == strcmp(line + 7, "Fails")) {
-                cached_ip6_mib.ip6FragFails = stats;
-            } else if (0 == strcmp(line + 7, "OKs")) {
-                cached_ip6_mib.ip6FragOKs = stats;
-            } else {
-                match = 0;
-            }
-        } else {
-            match = 0;
-        }
+    {
+        const netsnmp_netstats *stats = netsnmp_netstats_get();
 
-        if(!match)
+        if (!stats || !netsnmp_netstats_group_find(stats, "Ip6")) {
             DEBUGMSGTL(("mibII/kernel_linux/ip6stats",
-                        "%s is an unknown tag\n", line));
+                        "No Ip6 statistics\n"));
+            return -1;
+        }
+        memset(&cached_ip6_mib, 0, sizeof(cached_ip6_mib));
+        _kernel_linux_fill(stats, "Ip6", ip6_fields, NFIELDS(ip6_fields),
+                           &cached_ip6_mib);
     }
-
-    fclose(in);
 #endif
 
     memcpy((char *) ip6stat, (char *) &cached_ip6_mib, sizeof(*ip6stat));
@@ -391,128 +390,26 @@ linux_read_icmp6_parse(struct icmp6_mib *icmp6stat,
                        struct icmp6_msg_mib *icmp6msgstat,
                        int *support)
 {
-#ifdef NETSNMP_ENABLE_IPV6
-    FILE           *in;
-    char            line[1024];
-    char            name[255];
-    unsigned long   stats;
-    char           *endp, *vals;
-    int             match;
-#endif
-
     memset(icmp6stat, 0, sizeof(*icmp6stat));
     if (NULL != icmp6msgstat)
         memset(icmp6msgstat, 0, sizeof(*icmp6msgstat));
 
 #ifdef NETSNMP_ENABLE_IPV6
-    DEBUGMSGTL(("mibII/kernel_linux/icmp6stats",
-                "Reading /proc/net/snmp6 stats\n"));
-    if (NULL == (in = fopen("/proc/net/snmp6", "r"))) {
-        DEBUGMSGTL(("mibII/kernel_linux/icmp6stats",
-                    "Failed to open /proc/net/snmp6\n"));
-        return -1;
-    }
-
-    while (NULL != fgets(line, sizeof(line), in)) {
-        if (0 != strncmp(line, ICMP6_STATS_LINE, ICMP6_STATS_PREFIX_LEN))
-            continue;
-
-        if (2 != sscanf(line, "%s %lu", name, &stats))
-            continue;
-
-        endp = strchr(line, ' ');
-        *endp = '\0';
-        DEBUGMSGTL(("mibII/kernel_linux/icmp6stats", "Find tag: %s\n", line));
-
-        vals = name;
-        if (NULL != icmp6msgstat) {
-            if (0 == strncmp(name, "Icmp6OutType", 12)) {
-                strsep(&vals, "e");
-                icmp6msgstat->vals[atoi(vals)].OutType = stats;
-                *support = 1;
-                continue;
-            } else if (0 == strncmp(name, "Icmp6InType", 11)) {
-                strsep(&vals, "e");
-                icmp6msgstat->vals[atoi(vals)].InType = stats;
-                *support = 1;
-                continue;
-            }
-        }
+    {
+        const netsnmp_netstats *stats = netsnmp_netstats_get();
 
-        match = 1;
-        if (0 == strncmp(line + 5, "In", 2)) {  /* In */
-            if (0 == strcmp(line + 7, "DestUnreachs")) {
-                cached_icmp6_mib.icmp6InDestUnreachs = stats;
-            } else if (0 == strcmp(line + 7, "Echos")) {
-                cached_icmp6_mib.icmp6InEchos = stats;
-            } else if (0 == strcmp(line + 7, "EchoReplies")) {
-                cached_icmp6_mib.icmp6InEchoReplies = stats;
-            } else if (0 == strcmp(line + 7, "Errors")) {
-                cached_icmp6_mib.icmp6InErrors = stats;
-            } else if (0 == strcmp(line + 7, "GroupMembQueries")) {
-                cached_icmp6_mib.icmp6InGroupMembQueries = stats;
-            } else if (0 == strcmp(line + 7, "GroupMembReductions")) {
-                cached_icmp6_mib.icmp6InGroupMembReductions = stats;
-            } else if (0 == strcmp(line + 7, "GroupMembResponses")) {
-                cached_icmp6_mib.icmp6InGroupMembResponses = stats;
-            } else if (0 == strcmp(line + 7, "Msgs")) {
-                cached_icmp6_mib.icmp6InMsgs = stats;
-            } else if (0 == strcmp(line + 7, "NeighborAdvertisements")) {
-                cached_icmp6_mib.icmp6InNeighborAdvertisements = stats;
-            } else if (0 == strcmp(line + 7, "NeighborSolicits")) {
-                cached_icmp6_mib.icmp6InNeighborSolicits = stats;
-            } else if (0 == strcmp(line + 7, "PktTooBigs")) {
-                cached_icmp6_mib.icmp6InPktTooBigs = stats;
-            } else if (0 == strcmp(line + 7, "ParmProblems")) {
-                cached_icmp6_mib.icmp6InParmProblems = stats;
-            } else if (0 == strcmp(line + 7, "Redirects")) {
-                cached_icmp6_mib.icmp6InRedirects = stats;
-            } else if (0 == strcmp(line + 7, "RouterAdvertisements")) {
-                cached_icmp6_mib.icmp6InRouterAdvertisements = stats;
-            } else if (0 == strcmp(line + 7, "RouterSolicits")) {
-                cached_icmp6_mib.icmp6InRouterSolicits = stats;
-            } else if (0 == strcmp(line + 7, "TimeExcds")) {
-                cached_icmp6_mib.icmp6InTimeExcds = stats;
-            } else {
-                match = 0;
-            }
-        } else if (0 == strncmp(line + 5, "Out", 3)) {  /* Out */
-            if (0 == strcmp(line + 8, "DestUnreachs")) {
-                cached_icmp6_mib.icmp6OutDestUnreachs = stats;
-            } else if (0 == strcmp(line + 8, "EchoReplies")) {
-                cached_icmp6_mib.icmp6OutEchoReplies = stats;
-            } else if (0 == strcmp(line + 8, "GroupMembReductions")) {
-                cached_icmp6_mib.icmp6OutGroupMembReductions = stats;
-            } else if (0 == strcmp(line + 8, "GroupMembResponses")) {
-                cached_icmp6_mib.icmp6OutGroupMembResponses = stats;
-            } else if (0 == strcmp(line + 8, "Msgs")) {
-                cached_icmp6_mib.icmp6OutMsgs = stats;
-            } else if (0 == strcmp(line + 8, "NeighborAdvertisements")) {
-                cached_icmp6_mib.icmp6OutNeighborAdvertisements = stats;
-            } else if (0 == strcmp(line + 8, "NeighborSolicits")) {
-                cached_icmp6_mib.icmp6OutNeighborSolicits = stats;
-            } else if (0 == strcmp(line + 8, "PktTooBigs")) {
-                cached_icmp6_mib.icmp6OutPktTooBigs = stats;
-            } else if (0 == strcmp(line + 8, "ParmProblems")) {
-                cached_icmp6_mib.icmp6OutParmProblems = stats;
-            } else if (0 == strcmp(line + 8, "Redirects")) {
-                cached_icmp6_mib.icmp6OutRedirects = stats;
-            } else if (0 == strcmp(line + 8, "RouterSolicits")) {
-                cached_icmp6_mib.icmp6OutRouterSolicits = stats;
-            } else if (0 == strcmp(line + 8, "TimeExcds")) {
-                cached_icmp6_mib.icmp6OutTimeExcds = stats;
-            } else {
-                match = 0;
-            }
-        } else {
-            match = 0;
-        }
-        if(!match)
+        if (!stats || !netsnmp_netstats_group_find(stats, "Icmp6")) {
             DEBUGMSGTL(("mibII/kernel_linux/icmp6stats",
-                        "%s is an unknown tag\n", line));
+                        "No Icmp6 statistics\n"));
+            return -1;
+        }
+        memset(&cached_icmp6_mib, 0, sizeof(cached_icmp6_mib));
+        _kernel_linux_fill(stats, "Icmp6", icmp6_fields,
+                           NFIELDS(icmp6_fields), &cached_icmp6_mib);
+        if (NULL != icmp6msgstat &&
+            _kernel_linux_msg_fill(stats, "Icmp6", icmp6msgstat->vals))
+            *support = 1;
     }
-
-    fclose(in);
 #endif
 
     memcpy((char *) icmp6stat, (char *) &cached_icmp6_mib,
@@ -556,71 +453,46 @@ linux_read_udp_stat(struct udp_mib *udpstat)
     memset((char *) udpstat, (0), sizeof(*udpstat));
     if (linux_read_mibII_stats() == -1)
         return -1;
+    memcpy((char *) udpstat, (char *) &cached_udp_mib, sizeof(*udpstat));
 
 #ifdef NETSNMP_ENABLE_IPV6
     {
         struct udp6_mib udp6stat;
         memset(&udp6stat, 0, sizeof(udp6stat));
 
+        /*
+         * add these to the copy: cached_udp_mib is reused for as long
+         * as the snapshot is
+         */
         if (linux_read_udp6_stat(&udp6stat) == 0) {
-            cached_udp_mib.udpOutDatagrams += udp6stat.udp6OutDatagrams;
-            cached_udp_mib.udpNoPorts      += udp6stat.udp6NoPorts;
-            cached_udp_mib.udpInDatagrams  += udp6stat.udp6InDatagrams;
-            cached_udp_mib.udpInErrors     += udp6stat.udp6InErrors;
+            udpstat->udpOutDatagrams += udp6stat.udp6OutDatagrams;
+            udpstat->udpNoPorts      += udp6stat.udp6NoPorts;
+            udpstat->udpInDatagrams  += udp6stat.udp6InDatagrams;
+            udpstat->udpInErrors     += udp6stat.udp6InErrors;
         }
     }
 #endif
-    memcpy((char *) udpstat, (char *) &cached_udp_mib, sizeof(*udpstat));
     return 0;
 }
 
 int
 linux_read_udp6_stat(struct udp6_mib *udp6stat)
 {
-#ifdef NETSNMP_ENABLE_IPV6
-    FILE           *in;
-    char            line[1024];
-    unsigned long   stats;
-    char           *endp;
-#endif
-
     memset(udp6stat, 0, sizeof(*udp6stat));
 
 #ifdef NETSNMP_ENABLE_IPV6
-    DEBUGMSGTL(("mibII/kernel_linux/udp6stats",
-                "Reading /proc/net/snmp6 stats\n"));
-    if (NULL == (in = fopen("/proc/net/snmp6", "r"))) {
-        DEBUGMSGTL(("mibII/kernel_linux/udp6stats",
-                    "Failed to open /proc/net/snmp6\n"));
-       return -1;
-    }
-
-    while (NULL != fgets(line, sizeof(line), in)) {
-        if (0 != strncmp(line, UDP6_STATS_LINE, UDP6_STATS_PREFIX_LEN))
-            continue;
-
-        if (1 != sscanf(line, "%*s %lu", &stats))
-            continue;
+    {
+        const netsnmp_netstats *stats = netsnmp_netstats_get();
 
-        endp = strchr(line, ' ');
-        *endp = '\0';
-        DEBUGMSGTL(("mibII/kernel_linux/udp6stats", "Find tag: %s\n", line));
-
-        if (0 == strcmp(line + 4, "OutDatagrams")) {
-            cached_udp6_mib.udp6OutDatagrams = stats;
-        } else if (0 == strcmp(line + 4, "NoPorts")) {
-            cached_udp6_mib.udp6NoPorts = stats;
-        } else if (0 == strcmp(line + 4, "InDatagrams")) {
-            cached_udp6_mib.udp6InDatagrams = stats;
-        } else if (0 == strcmp(line + 4, "InErrors")) {
-            cached_udp6_mib.udp6InErrors = stats;
-        } else {
+        if (!stats || !netsnmp_netstats_group_find(stats, "Udp6")) {
             DEBUGMSGTL(("mibII/kernel_linux/udp6stats",
-                        "%s is an unknown tag\n", line));
+                        "No Udp6 statistics\n"));
+            return -1;
         }
+        memset(&cached_udp6_mib, 0, sizeof(cached_udp6_mib));
+        _kernel_linux_fill(stats, "Udp6", udp6_fields,
+                           NFIELDS(udp6_fields), &cached_udp6_mib);
     }
-
-    fclose(in);
 #endif
 
     memcpy((char *) udp6stat, (char *) &cached_udp6_mib, sizeof(*udp6stat));
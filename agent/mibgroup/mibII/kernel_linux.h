@@ -6,6 +6,8 @@
 #ifndef _MIBGROUP_KERNEL_LINUX_H
 #define _MIBGROUP_KERNEL_LINUX_H
 
+config_require(util_funcs/netstats)
+
 struct ip_mib {
     unsigned long   ipForwarding;
     unsigned long   ipDefaultTTL;
@@ -15,15 +15,11 @@
 #include <net-snmp/agent/ds_agent.h>
 #include <net-snmp/agent/instance.h>
 #include <net-snmp/agent/table.h>
-#include <net-snmp/agent/table_data.h>
-#include <net-snmp/agent/table_dataset.h>
 #include "net-snmp/agent/sysORTable.h"
 #include "notification_log.h"
 
 netsnmp_feature_require(register_ulong_instance_context)
 netsnmp_feature_require(register_read_only_counter32_instance_context)
-netsnmp_feature_require(delete_table_data_set)
-netsnmp_feature_require(table_dataset)
 netsnmp_feature_require(date_n_time)
 
 /*
@@ -62,87 +58,117 @@ static u_long   num_deleted = 0;
 static u_long   max_logged = 1000;      /* goes against the mib default of infinite */
 static u_long   max_age = 1440; /* 1440 = 24 hours, which is the mib default */
 
-static netsnmp_table_data_set *nlmLogTable;
-static netsnmp_table_data_set *nlmLogVarTable;
+/*
+ * The log is kept in a ring of entries, oldest first, so that logging
+ * a notification and bumping the oldest one are both constant time.
+ * The ring grows as needed, up to nlmConfigGlobalEntryLimit entries.
+ *
+ * Each entry is a single allocation, holding the nlmLogTable columns,
+ * the entry's nlmLogVariableTable rows, and then all the OIDs and
+ * strings these refer to.  nlmLogIndex values are handed out in
+ * sequence, so an entry's place in the ring is its nlmLogIndex less
+ * that of the oldest entry.
+ */
+struct nlm_var {
+    u_long          index;              /* nlmLogVariableIndex */
+    oid            *name;
+    size_t          name_len;
+    u_char          type;
+    u_char          column;             /* column holding the value */
+    long            valtype;            /* nlmLogVariableValueType */
+    union {
+        long            integer;
+        struct counter64 c64;
+    } num;                              /* numeric values */
+    u_char         *val;
+    size_t          val_len;
+};
+
+struct nlm_entry {
+    u_long          index;              /* nlmLogIndex */
+    u_long          time;
+    u_char          date[11];
+    size_t          date_len;
+    u_char         *engine_id;
+    size_t          engine_id_len;
+    u_char          taddress[6];
+    size_t          taddress_len;       /* 0 if not known */
+    oid            *tdomain;            /* NULL if not known */
+    size_t          tdomain_len;
+    u_char         *context_engine_id;
+    size_t          context_engine_id_len;
+    u_char         *context_name;
+    size_t          context_name_len;
+    oid            *notification_id;    /* NULL if not known */
+    size_t          notification_id_len;
+    int             nvars;
+    struct nlm_var *vars;
+};
+
+#define NLM_LOG_MIN_SIZE 16
+
+static struct nlm_entry **nlm_log;
+static size_t   nlm_log_size;           /* slots allocated */
+static size_t   nlm_log_first;          /* slot of the oldest entry */
+static size_t   nlm_log_count;
+
+#define NLM_LOG_ENTRY(i) nlm_log[(nlm_log_first + (i)) % nlm_log_size]
+
+/* the nlmLogName index of every row: "default" */
+static const oid nlm_log_name[] =
+    { 7, 'd', 'e', 'f', 'a', 'u', 'l', 't' };
+#define NLM_LOG_NAME_LEN OID_LENGTH(nlm_log_name)
 
 static oid nlm_module_oid[] = { SNMP_OID_MIB2, 92 }; /* NOTIFICATION-LOG-MIB::notificationLogMIB */
 
 static void
 netsnmp_notif_log_remove_oldest(int count)
 {
-    netsnmp_table_row *deleterow, *tmprow, *deletevarrow;
-    
     DEBUGMSGTL(("notification_log", "deleting %d log entry(s)\n", count));
 
-    deleterow = netsnmp_table_data_set_get_first_row(nlmLogTable);
-    for (; count && deleterow; deleterow = tmprow, --count) {
-        /*
-         * delete contained varbinds
-         * xxx-rks: note that this assumes that only the default
-         * log is used (ie for the first nlmLogTable row, the
-         * first nlmLogVarTable rows will be the right ones).
-         * the right thing to do would be to do a find based on
-         * the nlmLogTable oid.
-         */
-        DEBUGMSGTL(("9:notification_log", "  deleting notification\n"));
-        DEBUGIF("9:notification_log") {
-            DEBUGMSGTL(("9:notification_log",
-                        " base oid:"));
-            DEBUGMSGOID(("9:notification_log", deleterow->index_oid,
-                         deleterow->index_oid_len));
-            DEBUGMSG(("9:notification_log", "\n"));
-        }
-        deletevarrow = netsnmp_table_data_set_get_first_row(nlmLogVarTable);
-        for (; deletevarrow; deletevarrow = tmprow) {
-
-            tmprow = netsnmp_table_data_set_get_next_row(nlmLogVarTable,
-                                                          deletevarrow);
-            
-            DEBUGIF("9:notification_log") {
-                DEBUGMSGTL(("9:notification_log",
-                            "         :"));
-                DEBUGMSGOID(("9:notification_log", deletevarrow->index_oid,
-                             deletevarrow->index_oid_len));
-                DEBUGMSG(("9:notification_log", "\n"));
-            }
-            if ((deleterow->index_oid_len == deletevarrow->index_oid_len - 1) &&
-                snmp_oid_compare(deleterow->index_oid,
-                                 deleterow->index_oid_len,
-                                 deletevarrow->index_oid,
-                                 deleterow->index_oid_len) == 0) {
-                DEBUGMSGTL(("9:notification_log", "    deleting varbind\n"));
-                netsnmp_table_dataset_remove_and_delete_row(nlmLogVarTable,
-                                                             deletevarrow);
-            }
-            else
-                break;
-        }
-        
-        /*
-         * delete the master row 
-         */
-        tmprow = netsnmp_table_data_set_get_next_row(nlmLogTable, deleterow);
-        netsnmp_table_dataset_remove_and_delete_row(nlmLogTable,
-                                                     deleterow);
+    for (; count && nlm_log_count; --count) {
+        free(NLM_LOG_ENTRY(0));
+        NLM_LOG_ENTRY(0) = NULL;
+        nlm_log_first = (nlm_log_first + 1) % nlm_log_size;
+        nlm_log_count--;
         num_deleted++;
     }
     /** should have deleted all of them */
     netsnmp_assert(0 == count);
 }
 
+/*
+ * make room for one more entry, keeping the oldest in the first slot
+ */
+static int
+nlm_log_grow(void)
+{
+    struct nlm_entry **log;
+    size_t          size, i;
+
+    size = nlm_log_size * 2;
+    if (max_logged > nlm_log_size && size > max_logged)
+        size = max_logged;
+    log = (struct nlm_entry **) malloc(size * sizeof(*log));
+    if (NULL == log)
+        return -1;
+    for (i = 0; i < nlm_log_count; i++)
+        log[i] = NLM_LOG_ENTRY(i);
+    free(nlm_log);
+    nlm_log = log;
+    nlm_log_size = size;
+    nlm_log_first = 0;
+    return 0;
+}
+
 static void
 check_log_size(unsigned int clientreg, void *clientarg)
 {
-    netsnmp_table_row *row;
-    netsnmp_table_data_set_storage *data;
     u_long          count = 0;
     struct timeval  now;
     u_long          uptime;
 
-    gettimeofday(&now, NULL);
-    uptime = netsnmp_timeval_uptime(&now);
-
-    if (!nlmLogTable || !nlmLogTable->table )  {
+    if (!nlm_log) {
         DEBUGMSGTL(("notification_log", "missing log table\n"));
         return;
     }
@@ -150,7 +176,7 @@ check_log_size(unsigned int clientreg, void *clientarg)
     /*
      * check max allowed count
      */
-    count = netsnmp_table_set_num_rows(nlmLogTable);
+    count = nlm_log_count;
     DEBUGMSGTL(("notification_log",
                 "logged notifications %lu; max %lu\n",
                     count, max_logged));
@@ -162,22 +188,15 @@ check_log_size(unsigned int clientreg, void *clientarg)
     }
 
     /*
-     * check max age 
+     * check max age: the oldest entries are the first ones
      */
     if (0 == max_age)
         return;
-    count = 0;
-    for (row = netsnmp_table_data_set_get_first_row(nlmLogTable);
-         row;
-         row = netsnmp_table_data_set_get_next_row(nlmLogTable, row)) {
-
-        data = (netsnmp_table_data_set_storage *) row->data;
-        data = netsnmp_table_data_set_find_column(data, COLUMN_NLMLOGTIME);
-
-        if (uptime < ((u_long)(*(data->data.integer) + max_age * 100 * 60)))
+    gettimeofday(&now, NULL);
+    uptime = netsnmp_timeval_uptime(&now);
+    for (count = 0; count < nlm_log_count; ++count)
+        if (uptime < NLM_LOG_ENTRY(count)->time + max_age * 100 * 60)
             break;
-        ++count;
-    }
 
     if (count) {
         DEBUGMSGTL(("notification_log", "removing %lu expired notifications\n",
@@ -186,6 +205,311 @@ check_log_size(unsigned int clientreg, void *clientarg)
     }
 }
 
+/*
+ * Compare the nlmLogName part of an index with that of the rows:
+ * negative if the index sorts before them all, positive if after,
+ * and 0 if it matches (or is cut short).
+ */
+static int
+nlm_log_name_cmp(const oid *idx, size_t len)
+{
+    size_t          i;
+
+    for (i = 0; i < len && i < NLM_LOG_NAME_LEN; i++)
+        if (idx[i] != nlm_log_name[i])
+            return idx[i] < nlm_log_name[i] ? -1 : 1;
+    return 0;
+}
+
+/*
+ * the position of the first entry with an nlmLogIndex of at least index
+ * (an entry is only numbered once it is stored, so there are no gaps)
+ */
+static size_t
+nlm_log_position(oid index)
+{
+    u_long          first;
+
+    if (!nlm_log_count)
+        return 0;
+    first = NLM_LOG_ENTRY(0)->index;
+    if (index <= first)
+        return 0;
+    if (index - first >= nlm_log_count)
+        return nlm_log_count;
+    return index - first;
+}
+
+/*
+ * the position of an entry's first variable with an
+ * nlmLogVariableIndex of at least index (there may be gaps)
+ */
+static int
+nlm_var_position(const struct nlm_entry *entry, oid index)
+{
+    int             lo = 0, hi = entry->nvars, mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (entry->vars[mid].index < index)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void
+nlm_log_set_oid(netsnmp_variable_list *vb,
+                netsnmp_handler_registration *reginfo, int column,
+                const struct nlm_entry *entry, const struct nlm_var *var)
+{
+    oid             name[MAX_OID_LEN];
+    size_t          len = reginfo->rootoid_len;
+
+    memcpy(name, reginfo->rootoid, len * sizeof(oid));
+    name[len++] = 1;
+    name[len++] = column;
+    memcpy(name + len, nlm_log_name, sizeof(nlm_log_name));
+    len += NLM_LOG_NAME_LEN;
+    name[len++] = entry->index;
+    if (var)
+        name[len++] = var->index;
+    snmp_set_var_objid(vb, name, len);
+}
+
+/*
+ * fill in a column of an nlmLogTable row, if the entry has it
+ */
+static int
+nlm_log_set_column(netsnmp_variable_list *vb,
+                   const struct nlm_entry *entry, int column)
+{
+    switch (column) {
+    case COLUMN_NLMLOGTIME:
+        snmp_set_var_typed_value(vb, ASN_TIMETICKS, &entry->time,
+                                 sizeof(entry->time));
+        break;
+    case COLUMN_NLMLOGDATEANDTIME:
+        snmp_set_var_typed_value(vb, ASN_OCTET_STR, entry->date,
+                                 entry->date_len);
+        break;
+    case COLUMN_NLMLOGENGINEID:
+        snmp_set_var_typed_value(vb, ASN_OCTET_STR, entry->engine_id,
+                                 entry->engine_id_len);
+        break;
+    case COLUMN_NLMLOGENGINETADDRESS:
+        if (!entry->taddress_len)
+            return 0;
+        snmp_set_var_typed_value(vb, ASN_OCTET_STR, entry->taddress,
+                                 entry->taddress_len);
+        break;
+    case COLUMN_NLMLOGENGINETDOMAIN:
+        if (!entry->tdomain)
+            return 0;
+        snmp_set_var_typed_value(vb, ASN_OBJECT_ID, entry->tdomain,
+                                 entry->tdomain_len * sizeof(oid));
+        break;
+    case COLUMN_NLMLOGCONTEXTENGINEID:
+        snmp_set_var_typed_value(vb, ASN_OCTET_STR,
+                                 entry->context_engine_id,
+                                 entry->context_engine_id_len);
+        break;
+    case COLUMN_NLMLOGCONTEXTNAME:
+        snmp_set_var_typed_value(vb, ASN_OCTET_STR, entry->context_name,
+                                 entry->context_name_len);
+        break;
+    case COLUMN_NLMLOGNOTIFICATIONID:
+        if (!entry->notification_id)
+            return 0;
+        snmp_set_var_typed_value(vb, ASN_OBJECT_ID, entry->notification_id,
+                                 entry->notification_id_len * sizeof(oid));
+        break;
+    default:
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * fill in a column of an nlmLogVariableTable row: each variable has
+ * only the one value column matching its type
+ */
+static int
+nlm_var_set_column(netsnmp_variable_list *vb,
+                   const struct nlm_var *var, int column)
+{
+    if (column == COLUMN_NLMLOGVARIABLEID)
+        snmp_set_var_typed_value(vb, ASN_OBJECT_ID, var->name,
+                                 var->name_len * sizeof(oid));
+    else if (column == COLUMN_NLMLOGVARIABLEVALUETYPE)
+        snmp_set_var_typed_value(vb, ASN_INTEGER, &var->valtype,
+                                 sizeof(var->valtype));
+    else if (column == var->column)
+        snmp_set_var_typed_value(vb, var->type, var->val, var->val_len);
+    else
+        return 0;
+    return 1;
+}
+
+static int
+nlmLogTable_handler(netsnmp_mib_handler *handler,
+                    netsnmp_handler_registration *reginfo,
+                    netsnmp_agent_request_info *reqinfo,
+                    netsnmp_request_info *requests)
+{
+    netsnmp_request_info *request;
+    netsnmp_table_request_info *table_info;
+    const oid      *idx;
+    size_t          len, i;
+    int             column, c;
+
+    for (request = requests; request; request = request->next) {
+        if (request->processed)
+            continue;
+        table_info = netsnmp_extract_table_info(request);
+        idx = table_info->index_oid;
+        len = table_info->index_oid_len;
+
+        switch (reqinfo->mode) {
+        case MODE_GET:
+            if (len == NLM_LOG_NAME_LEN + 1 && !nlm_log_name_cmp(idx, len)) {
+                i = nlm_log_position(idx[NLM_LOG_NAME_LEN]);
+                if (i < nlm_log_count &&
+                    NLM_LOG_ENTRY(i)->index == idx[NLM_LOG_NAME_LEN] &&
+                    nlm_log_set_column(request->requestvb, NLM_LOG_ENTRY(i),
+                                       table_info->colnum))
+                    break;
+            }
+            netsnmp_set_request_error(reqinfo, request, SNMP_NOSUCHINSTANCE);
+            break;
+
+        case MODE_GETNEXT:
+            /*
+             * find the first entry after the index
+             */
+            c = nlm_log_name_cmp(idx, len);
+            if (c < 0 || (c == 0 && len <= NLM_LOG_NAME_LEN))
+                i = 0;
+            else if (c > 0)
+                i = nlm_log_count;
+            else {
+                i = nlm_log_position(idx[NLM_LOG_NAME_LEN]);
+                if (i < nlm_log_count &&
+                    NLM_LOG_ENTRY(i)->index == idx[NLM_LOG_NAME_LEN])
+                    i++;
+            }
+
+            /*
+             * then on to the next column, skipping entries without a
+             * value in it.  With nothing left, the request is passed
+             * on to whatever follows the table.
+             */
+            for (column = table_info->colnum;
+                 column <= COLUMN_NLMLOGNOTIFICATIONID; column++, i = 0) {
+                for (; i < nlm_log_count; i++)
+                    if (nlm_log_set_column(request->requestvb,
+                                           NLM_LOG_ENTRY(i), column))
+                        break;
+                if (i < nlm_log_count) {
+                    nlm_log_set_oid(request->requestvb, reginfo, column,
+                                    NLM_LOG_ENTRY(i), NULL);
+                    break;
+                }
+            }
+            break;
+        }
+    }
+    return SNMP_ERR_NOERROR;
+}
+
+static int
+nlmLogVariableTable_handler(netsnmp_mib_handler *handler,
+                            netsnmp_handler_registration *reginfo,
+                            netsnmp_agent_request_info *reqinfo,
+                            netsnmp_request_info *requests)
+{
+    netsnmp_request_info *request;
+    netsnmp_table_request_info *table_info;
+    struct nlm_entry *entry;
+    const oid      *idx;
+    size_t          len, i;
+    int             column, c, j;
+
+    for (request = requests; request; request = request->next) {
+        if (request->processed)
+            continue;
+        table_info = netsnmp_extract_table_info(request);
+        idx = table_info->index_oid;
+        len = table_info->index_oid_len;
+
+        switch (reqinfo->mode) {
+        case MODE_GET:
+            if (len == NLM_LOG_NAME_LEN + 2 && !nlm_log_name_cmp(idx, len)) {
+                i = nlm_log_position(idx[NLM_LOG_NAME_LEN]);
+                if (i < nlm_log_count &&
+                    NLM_LOG_ENTRY(i)->index == idx[NLM_LOG_NAME_LEN]) {
+                    entry = NLM_LOG_ENTRY(i);
+                    j = nlm_var_position(entry, idx[NLM_LOG_NAME_LEN + 1]);
+                    if (j < entry->nvars &&
+                        entry->vars[j].index == idx[NLM_LOG_NAME_LEN + 1] &&
+                        nlm_var_set_column(request->requestvb,
+                                           &entry->vars[j],
+                                           table_info->colnum))
+                        break;
+                }
+            }
+            netsnmp_set_request_error(reqinfo, request, SNMP_NOSUCHINSTANCE);
+            break;
+
+        case MODE_GETNEXT:
+            /*
+             * find the first variable after the index
+             */
+            j = 0;
+            c = nlm_log_name_cmp(idx, len);
+            if (c < 0 || (c == 0 && len <= NLM_LOG_NAME_LEN))
+                i = 0;
+            else if (c > 0)
+                i = nlm_log_count;
+            else {
+                i = nlm_log_position(idx[NLM_LOG_NAME_LEN]);
+                if (i < nlm_log_count && len > NLM_LOG_NAME_LEN + 1 &&
+                    NLM_LOG_ENTRY(i)->index == idx[NLM_LOG_NAME_LEN]) {
+                    entry = NLM_LOG_ENTRY(i);
+                    j = nlm_var_position(entry, idx[NLM_LOG_NAME_LEN + 1]);
+                    if (j < entry->nvars &&
+                        entry->vars[j].index == idx[NLM_LOG_NAME_LEN + 1])
+                        j++;
+                }
+            }
+
+            /*
+             * then on to the next column, as for nlmLogTable
+             */
+            for (column = table_info->colnum, entry = NULL;
+                 column <= COLUMN_NLMLOGVARIABLEOPAQUEVAL;
+                 column++, i = 0, j = 0) {
+                for (; i < nlm_log_count; i++, j = 0) {
+                    entry = NLM_LOG_ENTRY(i);
+                    for (; j < entry->nvars; j++)
+                        if (nlm_var_set_column(request->requestvb,
+                                               &entry->vars[j], column))
+                            break;
+                    if (j < entry->nvars)
+                        break;
+                }
+                if (i < nlm_log_count) {
+                    nlm_log_set_oid(request->requestvb, reginfo, column,
+                                    entry, &entry->vars[j]);
+                    break;
+                }
+            }
+            break;
+        }
+    }
+    return SNMP_ERR_NOERROR;
+}
 
 /** Initialize the nlmLogVariableTable table by defining its contents and how it's structured */
 static void
@@ -195,153 +519,29 @@ initialize_table_nlmLogVariableTable(const char * context)
         { 1, 3, 6, 1, 2, 1, 92, 1, 3, 2 };
     size_t          nlmLogVariableTable_oid_len =
         OID_LENGTH(nlmLogVariableTable_oid);
-    netsnmp_table_data_set *table_set;
+    netsnmp_table_registration_info *table_info;
     netsnmp_handler_registration *reginfo;
 
-    /*
-     * create the table structure itself 
-     */
-    table_set = netsnmp_create_table_data_set("nlmLogVariableTable");
-    nlmLogVarTable = table_set;
-    nlmLogVarTable->table->store_indexes = 1;
-
-    /***************************************************
-     * Adding indexes
-     */
-    /*
-     * declaring the nlmLogName index
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding index nlmLogName of type ASN_OCTET_STR to table nlmLogVariableTable\n"));
-    netsnmp_table_dataset_add_index(table_set, ASN_OCTET_STR);
-    /*
-     * declaring the nlmLogIndex index
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding index nlmLogIndex of type ASN_UNSIGNED to table nlmLogVariableTable\n"));
-    netsnmp_table_dataset_add_index(table_set, ASN_UNSIGNED);
-    /*
-     * declaring the nlmLogVariableIndex index
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding index nlmLogVariableIndex of type ASN_UNSIGNED to table nlmLogVariableTable\n"));
-    netsnmp_table_dataset_add_index(table_set, ASN_UNSIGNED);
-
-    /*
-     * adding column nlmLogVariableID of type ASN_OBJECT_ID and access of
-     * ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding column nlmLogVariableID (#2) of type ASN_OBJECT_ID to table nlmLogVariableTable\n"));
-    netsnmp_table_set_add_default_row(table_set, COLUMN_NLMLOGVARIABLEID,
-                                      ASN_OBJECT_ID, 0, NULL, 0);
-    /*
-     * adding column nlmLogVariableValueType of type ASN_INTEGER and
-     * access of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding column nlmLogVariableValueType (#3) of type ASN_INTEGER to table nlmLogVariableTable\n"));
-    netsnmp_table_set_add_default_row(table_set,
-                                      COLUMN_NLMLOGVARIABLEVALUETYPE,
-                                      ASN_INTEGER, 0, NULL, 0);
-    /*
-     * adding column nlmLogVariableCounter32Val of type ASN_COUNTER and
-     * access of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding column nlmLogVariableCounter32Val (#4) of type ASN_COUNTER to table nlmLogVariableTable\n"));
-    netsnmp_table_set_add_default_row(table_set,
-                                      COLUMN_NLMLOGVARIABLECOUNTER32VAL,
-                                      ASN_COUNTER, 0, NULL, 0);
-    /*
-     * adding column nlmLogVariableUnsigned32Val of type ASN_UNSIGNED and
-     * access of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding column nlmLogVariableUnsigned32Val (#5) of type ASN_UNSIGNED to table nlmLogVariableTable\n"));
-    netsnmp_table_set_add_default_row(table_set,
-                                      COLUMN_NLMLOGVARIABLEUNSIGNED32VAL,
-                                      ASN_UNSIGNED, 0, NULL, 0);
-    /*
-     * adding column nlmLogVariableTimeTicksVal of type ASN_TIMETICKS and
-     * access of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding column nlmLogVariableTimeTicksVal (#6) of type ASN_TIMETICKS to table nlmLogVariableTable\n"));
-    netsnmp_table_set_add_default_row(table_set,
-                                      COLUMN_NLMLOGVARIABLETIMETICKSVAL,
-                                      ASN_TIMETICKS, 0, NULL, 0);
-    /*
-     * adding column nlmLogVariableInteger32Val of type ASN_INTEGER and
-     * access of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding column nlmLogVariableInteger32Val (#7) of type ASN_INTEGER to table nlmLogVariableTable\n"));
-    netsnmp_table_set_add_default_row(table_set,
-                                      COLUMN_NLMLOGVARIABLEINTEGER32VAL,
-                                      ASN_INTEGER, 0, NULL, 0);
-    /*
-     * adding column nlmLogVariableOctetStringVal of type ASN_OCTET_STR
-     * and access of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding column nlmLogVariableOctetStringVal (#8) of type ASN_OCTET_STR to table nlmLogVariableTable\n"));
-    netsnmp_table_set_add_default_row(table_set,
-                                      COLUMN_NLMLOGVARIABLEOCTETSTRINGVAL,
-                                      ASN_OCTET_STR, 0, NULL, 0);
-    /*
-     * adding column nlmLogVariableIpAddressVal of type ASN_IPADDRESS and
-     * access of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding column nlmLogVariableIpAddressVal (#9) of type ASN_IPADDRESS to table nlmLogVariableTable\n"));
-    netsnmp_table_set_add_default_row(table_set,
-                                      COLUMN_NLMLOGVARIABLEIPADDRESSVAL,
-                                      ASN_IPADDRESS, 0, NULL, 0);
-    /*
-     * adding column nlmLogVariableOidVal of type ASN_OBJECT_ID and access 
-     * of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding column nlmLogVariableOidVal (#10) of type ASN_OBJECT_ID to table nlmLogVariableTable\n"));
-    netsnmp_table_set_add_default_row(table_set,
-                                      COLUMN_NLMLOGVARIABLEOIDVAL,
-                                      ASN_OBJECT_ID, 0, NULL, 0);
-    /*
-     * adding column nlmLogVariableCounter64Val of type ASN_COUNTER64 and
-     * access of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding column nlmLogVariableCounter64Val (#11) of type ASN_COUNTER64 to table nlmLogVariableTable\n"));
-    netsnmp_table_set_add_default_row(table_set,
-                                      COLUMN_NLMLOGVARIABLECOUNTER64VAL,
-                                      ASN_COUNTER64, 0, NULL, 0);
-    /*
-     * adding column nlmLogVariableOpaqueVal of type ASN_OPAQUE and access 
-     * of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogVariableTable",
-                "adding column nlmLogVariableOpaqueVal (#12) of type ASN_OPAQUE to table nlmLogVariableTable\n"));
-    netsnmp_table_set_add_default_row(table_set,
-                                      COLUMN_NLMLOGVARIABLEOPAQUEVAL,
-                                      ASN_OPAQUE, 0, NULL, 0);
+    table_info = SNMP_MALLOC_TYPEDEF(netsnmp_table_registration_info);
+    if (NULL == table_info)
+        return;
+    netsnmp_table_helper_add_indexes(table_info,
+                                     ASN_OCTET_STR, /* nlmLogName */
+                                     ASN_UNSIGNED,  /* nlmLogIndex */
+                                     ASN_UNSIGNED,  /* nlmLogVariableIndex */
+                                     0);
+    table_info->min_column = COLUMN_NLMLOGVARIABLEID;
+    table_info->max_column = COLUMN_NLMLOGVARIABLEOPAQUEVAL;
 
-    /*
-     * registering the table with the master agent 
-     */
-    /*
-     * note: if you don't need a subhandler to deal with any aspects of
-     * the request, change nlmLogVariableTable_handler to "NULL" 
-     */
     reginfo =
         netsnmp_create_handler_registration ("nlmLogVariableTable",
-                                             NULL,
+                                             nlmLogVariableTable_handler,
                                              nlmLogVariableTable_oid,
                                              nlmLogVariableTable_oid_len,
-                                             HANDLER_CAN_RWRITE);
+                                             HANDLER_CAN_RONLY);
     if (NULL != context)
         reginfo->contextName = strdup(context);
-    netsnmp_register_table_data_set(reginfo, table_set, NULL);
+    netsnmp_register_table(reginfo, table_info);
 }
 
 /** Initialize the nlmLogTable table by defining its contents and how it's structured */
@@ -350,113 +550,37 @@ initialize_table_nlmLogTable(const char * context)
 {
     static oid      nlmLogTable_oid[] = { 1, 3, 6, 1, 2, 1, 92, 1, 3, 1 };
     size_t          nlmLogTable_oid_len = OID_LENGTH(nlmLogTable_oid);
+    netsnmp_table_registration_info *table_info;
     netsnmp_handler_registration *reginfo;
 
-    /*
-     * create the table structure itself 
-     */
-    nlmLogTable = netsnmp_create_table_data_set("nlmLogTable");
-
-    /***************************************************
-     * Adding indexes
-     */
-    /*
-     * declaring the nlmLogIndex index
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogTable",
-                "adding index nlmLogName of type ASN_OCTET_STR to table nlmLogTable\n"));
-    netsnmp_table_dataset_add_index(nlmLogTable, ASN_OCTET_STR);
-
-    DEBUGMSGTL(("initialize_table_nlmLogTable",
-                "adding index nlmLogIndex of type ASN_UNSIGNED to table nlmLogTable\n"));
-    netsnmp_table_dataset_add_index(nlmLogTable, ASN_UNSIGNED);
+    if (NULL == nlm_log) {
+        nlm_log = (struct nlm_entry **)
+            malloc(NLM_LOG_MIN_SIZE * sizeof(*nlm_log));
+        if (NULL == nlm_log)
+            return;
+        nlm_log_size = NLM_LOG_MIN_SIZE;
+        nlm_log_first = nlm_log_count = 0;
+    }
 
-    /*
-     * adding column nlmLogTime of type ASN_TIMETICKS and access of
-     * ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogTable",
-                "adding column nlmLogTime (#2) of type ASN_TIMETICKS to table nlmLogTable\n"));
-    netsnmp_table_set_add_default_row(nlmLogTable, COLUMN_NLMLOGTIME,
-                                      ASN_TIMETICKS, 0, NULL, 0);
-    /*
-     * adding column nlmLogDateAndTime of type ASN_OCTET_STR and access of 
-     * ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogTable",
-                "adding column nlmLogDateAndTime (#3) of type ASN_OCTET_STR to table nlmLogTable\n"));
-    netsnmp_table_set_add_default_row(nlmLogTable,
-                                      COLUMN_NLMLOGDATEANDTIME,
-                                      ASN_OCTET_STR, 0, NULL, 0);
-    /*
-     * adding column nlmLogEngineID of type ASN_OCTET_STR and access of
-     * ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogTable",
-                "adding column nlmLogEngineID (#4) of type ASN_OCTET_STR to table nlmLogTable\n"));
-    netsnmp_table_set_add_default_row(nlmLogTable, COLUMN_NLMLOGENGINEID,
-                                      ASN_OCTET_STR, 0, NULL, 0);
-    /*
-     * adding column nlmLogEngineTAddress of type ASN_OCTET_STR and access 
-     * of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogTable",
-                "adding column nlmLogEngineTAddress (#5) of type ASN_OCTET_STR to table nlmLogTable\n"));
-    netsnmp_table_set_add_default_row(nlmLogTable,
-                                      COLUMN_NLMLOGENGINETADDRESS,
-                                      ASN_OCTET_STR, 0, NULL, 0);
-    /*
-     * adding column nlmLogEngineTDomain of type ASN_OBJECT_ID and access
-     * of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogTable",
-                "adding column nlmLogEngineTDomain (#6) of type ASN_OBJECT_ID to table nlmLogTable\n"));
-    netsnmp_table_set_add_default_row(nlmLogTable,
-                                      COLUMN_NLMLOGENGINETDOMAIN,
-                                      ASN_OBJECT_ID, 0, NULL, 0);
-    /*
-     * adding column nlmLogContextEngineID of type ASN_OCTET_STR and
-     * access of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogTable",
-                "adding column nlmLogContextEngineID (#7) of type ASN_OCTET_STR to table nlmLogTable\n"));
-    netsnmp_table_set_add_default_row(nlmLogTable,
-                                      COLUMN_NLMLOGCONTEXTENGINEID,
-                                      ASN_OCTET_STR, 0, NULL, 0);
-    /*
-     * adding column nlmLogContextName of type ASN_OCTET_STR and access of 
-     * ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogTable",
-                "adding column nlmLogContextName (#8) of type ASN_OCTET_STR to table nlmLogTable\n"));
-    netsnmp_table_set_add_default_row(nlmLogTable,
-                                      COLUMN_NLMLOGCONTEXTNAME,
-                                      ASN_OCTET_STR, 0, NULL, 0);
-    /*
-     * adding column nlmLogNotificationID of type ASN_OBJECT_ID and access 
-     * of ReadOnly 
-     */
-    DEBUGMSGTL(("initialize_table_nlmLogTable",
-                "adding column nlmLogNotificationID (#9) of type ASN_OBJECT_ID to table nlmLogTable\n"));
-    netsnmp_table_set_add_default_row(nlmLogTable,
-                                      COLUMN_NLMLOGNOTIFICATIONID,
-                                      ASN_OBJECT_ID, 0, NULL, 0);
+    table_info = SNMP_MALLOC_TYPEDEF(netsnmp_table_registration_info);
+    if (NULL == table_info)
+        return;
+    netsnmp_table_helper_add_indexes(table_info,
+                                     ASN_OCTET_STR, /* nlmLogName */
+                                     ASN_UNSIGNED,  /* nlmLogIndex */
+                                     0);
+    table_info->min_column = COLUMN_NLMLOGTIME;
+    table_info->max_column = COLUMN_NLMLOGNOTIFICATIONID;
 
-    /*
-     * registering the table with the master agent 
-     */
-    /*
-     * note: if you don't need a subhandler to deal with any aspects of
-     * the request, change nlmLogTable_handler to "NULL" 
-     */
     reginfo =
-        netsnmp_create_handler_registration("nlmLogTable", NULL,
+        netsnmp_create_handler_registration("nlmLogTable",
+                                            nlmLogTable_handler,
                                             nlmLogTable_oid,
                                             nlmLogTable_oid_len,
-                                            HANDLER_CAN_RWRITE);
+                                            HANDLER_CAN_RONLY);
     if (NULL != context)
         reginfo->contextName = strdup(context);
-    netsnmp_register_table_data_set(reginfo, nlmLogTable, NULL);
+    netsnmp_register_table(reginfo, table_info);
 
     /*
      * hmm...  5 minutes seems like a reasonable time to check for out
@@ -570,18 +694,87 @@ shutdown_notification_log(void)
 {
     max_logged = 0;
     check_log_size(0, NULL);
-    netsnmp_delete_table_data_set(nlmLogTable);
-    nlmLogTable = NULL;
+    free(nlm_log);
+    nlm_log = NULL;
+    nlm_log_size = 0;
 
     UNREGISTER_SYSOR_ENTRY(nlm_module_oid);
 }
 
+/*
+ * the column and nlmLogVariableValueType for a variable's value,
+ * or 0 if it can't be logged
+ */
+static int
+nlm_var_column(u_char type, long *valtype)
+{
+    switch (type) {
+    case ASN_OBJECT_ID:
+        *valtype = 7;
+        return COLUMN_NLMLOGVARIABLEOIDVAL;
+    case ASN_INTEGER:
+        *valtype = 4;
+        return COLUMN_NLMLOGVARIABLEINTEGER32VAL;
+    case ASN_UNSIGNED:
+        *valtype = 2;
+        return COLUMN_NLMLOGVARIABLEUNSIGNED32VAL;
+    case ASN_COUNTER:
+        *valtype = 1;
+        return COLUMN_NLMLOGVARIABLECOUNTER32VAL;
+    case ASN_TIMETICKS:
+        *valtype = 3;
+        return COLUMN_NLMLOGVARIABLETIMETICKSVAL;
+    case ASN_OCTET_STR:
+        *valtype = 6;
+        return COLUMN_NLMLOGVARIABLEOCTETSTRINGVAL;
+    case ASN_IPADDRESS:
+        *valtype = 5;
+        return COLUMN_NLMLOGVARIABLEIPADDRESSVAL;
+    case ASN_COUNTER64:
+        *valtype = 8;
+        return COLUMN_NLMLOGVARIABLECOUNTER64VAL;
+    case ASN_OPAQUE:
+        *valtype = 9;
+        return COLUMN_NLMLOGVARIABLEOPAQUEVAL;
+    default:
+        return 0;
+    }
+}
+
+/* values kept in struct nlm_var itself, rather than after the entry */
+#define NLM_VAR_IS_NUMERIC(type) \
+    ((type) == ASN_INTEGER || (type) == ASN_UNSIGNED || \
+     (type) == ASN_COUNTER || (type) == ASN_TIMETICKS || \
+     (type) == ASN_COUNTER64)
+
+static oid *
+nlm_copy_oids(oid **op, const oid *name, size_t len)
+{
+    oid            *copy = *op;
+
+    if (len)
+        memcpy(copy, name, len * sizeof(oid));
+    *op += len;
+    return copy;
+}
+
+static u_char *
+nlm_copy_bytes(u_char **bp, const u_char *data, size_t len)
+{
+    u_char         *copy = *bp;
+
+    if (len)
+        memcpy(copy, data, len);
+    *bp += len;
+    return copy;
+}
+
 void
 log_notification(netsnmp_pdu *pdu, netsnmp_transport *transport)
 {
-    long            tmpl;
     struct timeval  now;
-    netsnmp_table_row *row;
+    struct nlm_entry *entry;
+    struct nlm_var *var;
 
     static u_long   default_num = 0;
 
@@ -593,181 +786,163 @@ log_notification(netsnmp_pdu *pdu, netsnmp_transport *transport)
     time_t          timetnow;
 
     u_long          vbcount = 0;
-    u_long          tmpul;
-    int             col;
+    long            valtype;
+    int             col, nvars;
+    size_t          noids, nbytes;
+    oid            *op;
+    u_char         *bp;
     netsnmp_pdu    *orig_pdu = pdu;
 
-    if (!nlmLogVarTable
+    if (!nlm_log
         || netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
                                   NETSNMP_DS_APP_DONT_LOG)) {
         return;
     }
 
     DEBUGMSGTL(("notification_log", "logging something\n"));
-    row = netsnmp_create_table_data_row();
 
     ++num_received;
-    default_num++;
+
+    if (pdu->command == SNMP_MSG_TRAP)
+	pdu = convert_v1pdu_to_v2(orig_pdu);
+    if (!pdu)
+        return;
 
     /*
-     * indexes to the table 
+     * size everything up, for a single allocation
      */
-    netsnmp_table_row_add_index(row, ASN_OCTET_STR, "default",
-                                strlen("default"));
-    netsnmp_table_row_add_index(row, ASN_UNSIGNED, &default_num,
-                                sizeof(default_num));
+    nvars = 0;
+    noids = transport ? transport->domain_length : 0;
+    nbytes = orig_pdu->securityEngineIDLen + orig_pdu->contextEngineIDLen +
+        orig_pdu->contextNameLen;
+    for (vptr = pdu->variables; vptr; vptr = vptr->next_variable) {
+        if (snmp_oid_compare(snmptrapoid, snmptrapoid_len,
+                             vptr->name, vptr->name_length) == 0) {
+            noids += vptr->val_len / sizeof(oid);
+            continue;
+        }
+        if (!nlm_var_column(vptr->type, &valtype))
+            continue;
+        nvars++;
+        noids += vptr->name_length;
+        if (vptr->type == ASN_OBJECT_ID)
+            noids += vptr->val_len / sizeof(oid);
+        else if (!NLM_VAR_IS_NUMERIC(vptr->type))
+            nbytes += vptr->val_len;
+    }
+
+    entry = (struct nlm_entry *)
+        calloc(1, sizeof(*entry) + nvars * sizeof(*var) +
+               noids * sizeof(oid) + nbytes);
+    if (NULL == entry) {
+        snmp_log(LOG_ERR, "notification_log: no memory for the log entry\n");
+        goto done;
+    }
+    var = entry->vars = (struct nlm_var *) (entry + 1);
+    op = (oid *) (var + nvars);
+    bp = (u_char *) (op + noids);
 
     /*
      * add the data 
      */
     gettimeofday(&now, NULL);
-    tmpl = netsnmp_timeval_uptime(&now);
-    netsnmp_set_row_column(row, COLUMN_NLMLOGTIME, ASN_TIMETICKS,
-                           &tmpl, sizeof(tmpl));
+    entry->time = netsnmp_timeval_uptime(&now);
     time(&timetnow);
     logdate = date_n_time(&timetnow, &logdate_size);
-    netsnmp_set_row_column(row, COLUMN_NLMLOGDATEANDTIME, ASN_OCTET_STR,
-                           logdate, logdate_size);
-    netsnmp_set_row_column(row, COLUMN_NLMLOGENGINEID, ASN_OCTET_STR,
-                           pdu->securityEngineID,
-                           pdu->securityEngineIDLen);
+    if (logdate_size > sizeof(entry->date))
+        logdate_size = sizeof(entry->date);
+    memcpy(entry->date, logdate, logdate_size);
+    entry->date_len = logdate_size;
+    entry->engine_id = nlm_copy_bytes(&bp, orig_pdu->securityEngineID,
+                                      orig_pdu->securityEngineIDLen);
+    entry->engine_id_len = orig_pdu->securityEngineIDLen;
     if (transport && transport->domain == netsnmpUDPDomain) {
         /*
          * check for the udp domain 
          */
         struct sockaddr_in *addr =
-            (struct sockaddr_in *) pdu->transport_data;
+            (struct sockaddr_in *) orig_pdu->transport_data;
         if (addr) {
-            char            buf[sizeof(in_addr_t) +
-                                sizeof(addr->sin_port)];
             in_addr_t       locaddr = htonl(addr->sin_addr.s_addr);
             u_short         portnum = htons(addr->sin_port);
-            memcpy(buf, &locaddr, sizeof(in_addr_t));
-            memcpy(buf + sizeof(in_addr_t), &portnum,
+            memcpy(entry->taddress, &locaddr, sizeof(in_addr_t));
+            memcpy(entry->taddress + sizeof(in_addr_t), &portnum,
                    sizeof(addr->sin_port));
-            netsnmp_set_row_column(row, COLUMN_NLMLOGENGINETADDRESS,
-                                   ASN_OCTET_STR, buf,
-                                   sizeof(in_addr_t) +
-                                   sizeof(addr->sin_port));
+            entry->taddress_len = sizeof(in_addr_t) + sizeof(addr->sin_port);
         }
     }
-    if (transport)
-        netsnmp_set_row_column(row, COLUMN_NLMLOGENGINETDOMAIN,
-                               ASN_OBJECT_ID,
-                               transport->domain,
-                               sizeof(oid) * transport->domain_length);
-    netsnmp_set_row_column(row, COLUMN_NLMLOGCONTEXTENGINEID,
-                           ASN_OCTET_STR, pdu->contextEngineID,
-                           pdu->contextEngineIDLen);
-    netsnmp_set_row_column(row, COLUMN_NLMLOGCONTEXTNAME, ASN_OCTET_STR,
-                           pdu->contextName, pdu->contextNameLen);
+    if (transport) {
+        entry->tdomain = nlm_copy_oids(&op, transport->domain,
+                                       transport->domain_length);
+        entry->tdomain_len = transport->domain_length;
+    }
+    entry->context_engine_id = nlm_copy_bytes(&bp, orig_pdu->contextEngineID,
+                                              orig_pdu->contextEngineIDLen);
+    entry->context_engine_id_len = orig_pdu->contextEngineIDLen;
+    entry->context_name = nlm_copy_bytes(&bp,
+                                         (u_char *) orig_pdu->contextName,
+                                         orig_pdu->contextNameLen);
+    entry->context_name_len = orig_pdu->contextNameLen;
 
-    if (pdu->command == SNMP_MSG_TRAP)
-	pdu = convert_v1pdu_to_v2(orig_pdu);
     for (vptr = pdu->variables; vptr; vptr = vptr->next_variable) {
         if (snmp_oid_compare(snmptrapoid, snmptrapoid_len,
                              vptr->name, vptr->name_length) == 0) {
-            netsnmp_set_row_column(row, COLUMN_NLMLOGNOTIFICATIONID,
-                                   ASN_OBJECT_ID, vptr->val.string,
-                                   vptr->val_len);
-        } else {
-            netsnmp_table_row *myrow;
-            myrow = netsnmp_create_table_data_row();
-
-            /*
-             * indexes to the table 
-             */
-            netsnmp_table_row_add_index(myrow, ASN_OCTET_STR, "default",
-                                        strlen("default"));
-            netsnmp_table_row_add_index(myrow, ASN_UNSIGNED, &default_num,
-                                        sizeof(default_num));
-            vbcount++;
-            netsnmp_table_row_add_index(myrow, ASN_UNSIGNED, &vbcount,
-                                        sizeof(vbcount));
-
-            /*
-             * OID 
-             */
-            netsnmp_set_row_column(myrow, COLUMN_NLMLOGVARIABLEID,
-                                   ASN_OBJECT_ID, vptr->name,
-                                   vptr->name_length * sizeof(oid));
+            entry->notification_id =
+                nlm_copy_oids(&op, vptr->val.objid,
+                              vptr->val_len / sizeof(oid));
+            entry->notification_id_len = vptr->val_len / sizeof(oid);
+            continue;
+        }
 
+        vbcount++;
+        col = nlm_var_column(vptr->type, &valtype);
+        if (!col) {
             /*
-             * value 
+             * unsupported 
              */
-            switch (vptr->type) {
-            case ASN_OBJECT_ID:
-                tmpul = 7;
-                col = COLUMN_NLMLOGVARIABLEOIDVAL;
-                break;
-
-            case ASN_INTEGER:
-                tmpul = 4;
-                col = COLUMN_NLMLOGVARIABLEINTEGER32VAL;
-                break;
-
-            case ASN_UNSIGNED:
-                tmpul = 2;
-                col = COLUMN_NLMLOGVARIABLEUNSIGNED32VAL;
-                break;
-
-            case ASN_COUNTER:
-                tmpul = 1;
-                col = COLUMN_NLMLOGVARIABLECOUNTER32VAL;
-                break;
-
-            case ASN_TIMETICKS:
-                tmpul = 3;
-                col = COLUMN_NLMLOGVARIABLETIMETICKSVAL;
-                break;
-
-            case ASN_OCTET_STR:
-                tmpul = 6;
-                col = COLUMN_NLMLOGVARIABLEOCTETSTRINGVAL;
-                break;
-
-            case ASN_IPADDRESS:
-                tmpul = 5;
-                col = COLUMN_NLMLOGVARIABLEIPADDRESSVAL;
-                break;
-
-            case ASN_COUNTER64:
-                tmpul = 8;
-                col = COLUMN_NLMLOGVARIABLECOUNTER64VAL;
-                break;
-
-            case ASN_OPAQUE:
-                tmpul = 9;
-                col = COLUMN_NLMLOGVARIABLEOPAQUEVAL;
-                break;
-
-            default:
-                /*
-                 * unsupported 
-                 */
-                DEBUGMSGTL(("notification_log",
-                            "skipping type %d\n", vptr->type));
-                (void)netsnmp_table_dataset_delete_row(myrow);
-                continue;
-            }
-            netsnmp_set_row_column(myrow, COLUMN_NLMLOGVARIABLEVALUETYPE,
-                                   ASN_INTEGER, & tmpul,
-                                   sizeof(tmpul));
-            netsnmp_set_row_column(myrow, col, vptr->type,
-                                   vptr->val.string, vptr->val_len);
             DEBUGMSGTL(("notification_log",
-                        "adding a row to the variables table\n"));
-            netsnmp_table_dataset_add_row(nlmLogVarTable, myrow);
+                        "skipping type %d\n", vptr->type));
+            continue;
         }
+        var->index = vbcount;
+        var->name = nlm_copy_oids(&op, vptr->name, vptr->name_length);
+        var->name_len = vptr->name_length;
+        var->type = vptr->type;
+        var->column = col;
+        var->valtype = valtype;
+        if (vptr->type == ASN_OBJECT_ID) {
+            var->val_len = vptr->val_len / sizeof(oid) * sizeof(oid);
+            var->val = (u_char *) nlm_copy_oids(&op, vptr->val.objid,
+                                                vptr->val_len / sizeof(oid));
+        } else if (NLM_VAR_IS_NUMERIC(vptr->type)) {
+            var->val_len = SNMP_MIN(vptr->val_len, sizeof(var->num));
+            memcpy(&var->num, vptr->val.string, var->val_len);
+            var->val = (u_char *) &var->num;
+        } else {
+            var->val_len = vptr->val_len;
+            var->val = nlm_copy_bytes(&bp, vptr->val.string, vptr->val_len);
+        }
+        var++;
     }
-
-    if (pdu != orig_pdu)
-        snmp_free_pdu( pdu );
+    entry->nvars = nvars;
 
     /*
-     * store the row 
+     * store the entry, bumping the oldest one if the log is full
      */
-    netsnmp_table_dataset_add_row(nlmLogTable, row);
+    if (max_logged && nlm_log_count >= max_logged)
+        netsnmp_notif_log_remove_oldest(nlm_log_count - max_logged + 1);
+    if (nlm_log_count == nlm_log_size && nlm_log_grow() < 0) {
+        snmp_log(LOG_ERR, "notification_log: no memory to log the entry\n");
+        free(entry);
+        goto done;
+    }
+    entry->index = ++default_num;
+    NLM_LOG_ENTRY(nlm_log_count) = entry;
+    nlm_log_count++;
+
+  done:
+    if (pdu != orig_pdu)
+        snmp_free_pdu( pdu );
 
     check_log_size(0, NULL);
     DEBUGMSGTL(("notification_log", "done logging something\n"));
@@ -21,6 +21,8 @@ config_require(tcp-mib/data_access/tcpConn_common)
 #if defined( linux )
 config_require(tcp-mib/data_access/tcpConn_linux)
 config_require(util_funcs/get_pid_from_inode)
+config_require(util_funcs/inet_diag)
+#   define NETSNMP_ACCESS_TCPCONN_HAVE_FILTER 1
 #elif defined( solaris2 )
 config_require(tcp-mib/data_access/tcpConn_solaris2)
 #elif defined(freebsd4) || defined(dragonfly)
@@ -10,6 +10,7 @@
 #include <net-snmp/data_access/tcpConn.h>
 
 #include "tcp-mib/tcpConnectionTable/tcpConnectionTable_constants.h"
+#include "tcp-mib/data_access/tcpConn.h"
 #include "tcp-mib/data_access/tcpConn_private.h"
 
 /**---------------------------------------------------------------------*/
@@ -62,6 +63,13 @@ netsnmp_access_tcpconn_container_init(u_int flags)
     }
     container1->container_name = strdup("tcpConnTable");
 
+    /*
+     * entries are indexed in load order, so there are no duplicates to
+     * look for. checking for them sorts the array on every insert.
+     */
+    netsnmp_binary_array_options_set(container1, 1,
+                                     CONTAINER_KEY_ALLOW_DUPLICATES);
+
     return container1;
 }
 
@@ -93,6 +101,47 @@ netsnmp_access_tcpconn_container_load(netsnmp_container* container, u_int load_f
     return container;
 }
 
+/**
+ * load only the connection that filter describes
+ *
+ * @retval NULL  error, or the arch can't filter; load them all instead
+ * @retval !NULL pointer to container
+ */
+netsnmp_container*
+netsnmp_access_tcpconn_container_load_filter(netsnmp_container* container,
+                                             u_int load_flags,
+                                             netsnmp_tcpconn_filter *filter)
+{
+#ifdef NETSNMP_ACCESS_TCPCONN_HAVE_FILTER
+    int rc;
+
+    DEBUGMSGTL(("access:tcpconn:container", "load filtered\n"));
+
+    if (NULL == filter || (NULL == filter->exact &&
+                           (NULL == filter->after || NULL == filter->index)))
+        return NULL;
+
+    if (NULL == container)
+        container = netsnmp_access_tcpconn_container_init(load_flags);
+    if (NULL == container) {
+        snmp_log(LOG_ERR, "no container specified/found for access_tcpconn\n");
+        return NULL;
+    }
+
+    rc = netsnmp_arch_tcpconn_container_load_filter(container, load_flags,
+                                                    filter);
+    if (0 != rc) {
+        netsnmp_access_tcpconn_container_free(container,
+                                                NETSNMP_ACCESS_TCPCONN_FREE_NOFLAGS);
+        container = NULL;
+    }
+
+    return container;
+#else
+    return NULL;
+#endif
+}
+
 void
 netsnmp_access_tcpconn_container_free(netsnmp_container *container, u_int free_flags)
 {
@@ -10,14 +10,46 @@
 #include <net-snmp/data_access/tcpConn.h>
 
 #include "tcp-mib/tcpConnectionTable/tcpConnectionTable_constants.h"
+#include "tcp-mib/data_access/tcpConn.h"
 #include "tcp-mib/data_access/tcpConn_private.h"
 #include "mibgroup/util_funcs/get_pid_from_inode.h"
+#include "mibgroup/util_funcs/inet_diag.h"
+
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+#include <linux/inet_diag.h>
+#endif
+
 static int
 linux_states[12] = { 1, 5, 3, 4, 6, 7, 11, 1, 8, 9, 2, 10 };
 
-static int _load4(netsnmp_container *container, u_int flags);
+/*
+ * sock_diag state filters: every kernel tcp state from TCP_ESTABLISHED (1)
+ * up to TCP_NEW_SYN_RECV (12), i.e. what /proc/net/tcp shows, and
+ * TCP_LISTEN (10).
+ */
+#define TCPCONN_DIAG_STATES_ALL    0x1ffe
+#define TCPCONN_DIAG_STATE_LISTEN  (1 << 10)
+
+/*
+ * one load. Without a filter, every connection goes into the container.
+ * With one, only the best match so far is kept, and its owner is looked
+ * up when the load is done.
+ */
+typedef struct tcpconn_load_s {
+    netsnmp_container      *container;
+    u_int                   flags;
+    netsnmp_tcpconn_filter *filter;
+    netsnmp_tcpconn_entry  *best;
+    unsigned long long      best_inode;
+    netsnmp_index           best_index;
+    oid                     best_oids[MAX_OID_LEN];
+} tcpconn_load;
+
+static int _load_diag(tcpconn_load *load, int family);
+static int _get_diag(tcpconn_load *load, int family);
+static int _load4(tcpconn_load *load);
 #if defined (NETSNMP_ENABLE_IPV6)
-static int _load6(netsnmp_container *container, u_int flags);
+static int _load6(tcpconn_load *load);
 #endif
 
 /*
@@ -75,11 +107,41 @@ netsnmp_arch_tcpconn_entry_delete(netsnmp_tcpconn_entry *entry)
  * @retval  0 no errors
  * @retval !0 errors
  */
+static int
+_load_all(tcpconn_load *load)
+{
+    int rc;
+
+    /*
+     * sock_diag first; /proc/net/tcp if it isn't available
+     */
+    rc = _load_diag(load, AF_INET);
+    if (-2 == rc)
+        rc = _load4(load);
+
+#if defined (NETSNMP_ENABLE_IPV6)
+    if((0 != rc) || (load->flags & NETSNMP_ACCESS_TCPCONN_LOAD_IPV4_ONLY))
+        return rc;
+
+    /*
+     * load ipv6. ipv6 module might not be loaded,
+     * so ignore -2 err (file not found)
+     */
+    rc = _load_diag(load, AF_INET6);
+    if (-2 == rc)
+        rc = _load6(load);
+    if (-2 == rc)
+        rc = 0;
+#endif
+
+    return rc;
+}
+
 int
 netsnmp_arch_tcpconn_container_load(netsnmp_container *container,
                                     u_int load_flags )
 {
-    int rc = 0;
+    tcpconn_load    load;
 
     DEBUGMSGTL(("access:tcpconn:container",
                 "tcpconn_container_arch_load (flags %x)\n", load_flags));
@@ -92,22 +154,225 @@ netsnmp_arch_tcpconn_container_load(netsnmp_container *container,
         return -1;
     }
 
-    rc = _load4(container, load_flags);
+    memset(&load, 0, sizeof(load));
+    load.container = container;
+    load.flags = load_flags;
+
+    return _load_all(&load);
+}
+
+/**
+ *
+ * @retval  0 no errors
+ * @retval !0 errors
+ */
+int
+netsnmp_arch_tcpconn_container_load_filter(netsnmp_container *container,
+                                           u_int load_flags,
+                                           netsnmp_tcpconn_filter *filter)
+{
+    tcpconn_load    load;
+    int             rc, family;
+
+    DEBUGMSGTL(("access:tcpconn:container",
+                "tcpconn_container_arch_load_filter (flags %x)\n",
+                load_flags));
 
+    memset(&load, 0, sizeof(load));
+    load.container = container;
+    load.flags = load_flags;
+    load.filter = filter;
+
+    if (NULL == filter->exact)
+        rc = _load_all(&load);
+    else {
+        /*
+         * ask the kernel for the one connection; scan them all if it
+         * can't say
+         */
+        family = 4 == filter->exact->loc_addr_len ? AF_INET : AF_INET6;
+        rc = _get_diag(&load, family);
+        if (-2 == rc)
+            rc = _load_diag(&load, family);
+        if (-2 == rc && AF_INET == family)
+            rc = _load4(&load);
 #if defined (NETSNMP_ENABLE_IPV6)
-    if((0 != rc) || (load_flags & NETSNMP_ACCESS_TCPCONN_LOAD_IPV4_ONLY))
-        return rc;
+        else if (-2 == rc)
+            rc = _load6(&load);
+#endif
+    }
+
+    if (load.best) {
+        if (0 == rc) {
+            load.best->pid = netsnmp_get_pid_from_inode_find(load.best_inode);
+            load.best->arbitrary_index = 1;
+            CONTAINER_INSERT(container, load.best);
+        } else
+            netsnmp_access_tcpconn_entry_free(load.best);
+    }
+
+    return rc;
+}
+
+static int
+_same_conn(const netsnmp_tcpconn_entry *a, const netsnmp_tcpconn_entry *b)
+{
+    return a->loc_port == b->loc_port && a->rmt_port == b->rmt_port &&
+        a->loc_addr_len == b->loc_addr_len &&
+        a->rmt_addr_len == b->rmt_addr_len &&
+        0 == memcmp(a->loc_addr, b->loc_addr, a->loc_addr_len) &&
+        0 == memcmp(a->rmt_addr, b->rmt_addr, a->rmt_addr_len);
+}
+
+/*
+ * add a new entry to the container, or with a filter, keep it if it's a
+ * better match than the one so far.
+ */
+static void
+_add_entry(tcpconn_load *load, netsnmp_tcpconn_entry *entry,
+           unsigned long long inode)
+{
+    netsnmp_tcpconn_filter *filter = load->filter;
+    oid             oids[MAX_OID_LEN];
+    netsnmp_index   index;
+
+    if (NULL == filter) {
+        entry->pid = netsnmp_get_pid_from_inode(inode);
+        entry->arbitrary_index = CONTAINER_SIZE(load->container) + 1;
+        CONTAINER_INSERT(load->container, entry);
+        return;
+    }
+
+    if (filter->exact) {
+        if (load->best || !_same_conn(entry, filter->exact)) {
+            netsnmp_access_tcpconn_entry_free(entry);
+            return;
+        }
+    } else {
+        index.oids = oids;
+        index.len = MAX_OID_LEN;
+        if (0 != filter->index(entry, &index) ||
+            snmp_oid_compare(index.oids, index.len, filter->after->oids,
+                             filter->after->len) <= 0 ||
+            (load->best &&
+             snmp_oid_compare(index.oids, index.len,
+                              load->best_index.oids,
+                              load->best_index.len) >= 0)) {
+            netsnmp_access_tcpconn_entry_free(entry);
+            return;
+        }
+        memcpy(load->best_oids, oids, index.len * sizeof(oid));
+        load->best_index.oids = load->best_oids;
+        load->best_index.len = index.len;
+    }
+
+    if (load->best)
+        netsnmp_access_tcpconn_entry_free(load->best);
+    load->best = entry;
+    load->best_inode = inode;
+}
+
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+static int
+_diag_entry(const struct inet_diag_msg *msg, void *ctx)
+{
+    tcpconn_load   *load = (tcpconn_load *) ctx;
+    netsnmp_tcpconn_entry *entry;
+    size_t          addr_len;
+    u_int           state;
+
+    if (AF_INET == msg->idiag_family)
+        addr_len = 4;
+    else if (AF_INET6 == msg->idiag_family)
+        addr_len = 16;
+    else
+        return 0;
 
     /*
-     * load ipv6. ipv6 module might not be loaded,
-     * so ignore -2 err (file not found)
+     * dumps are filtered by the kernel, lookups aren't
      */
-    rc = _load6(container, load_flags);
-    if (-2 == rc)
-        rc = 0;
+    state = msg->idiag_state < 12 ? linux_states[msg->idiag_state] : 2;
+    if (TCPCONNECTIONSTATE_LISTEN == state ?
+        (load->flags & NETSNMP_ACCESS_TCPCONN_LOAD_NOLISTEN) :
+        (load->flags & NETSNMP_ACCESS_TCPCONN_LOAD_ONLYLISTEN))
+        return 0;
+
+    entry = netsnmp_access_tcpconn_entry_create();
+    if (NULL == entry)
+        return -1;
+
+    entry->loc_port = ntohs(msg->id.idiag_sport);
+    entry->rmt_port = ntohs(msg->id.idiag_dport);
+    entry->tcpConnState = state;
+
+    /** already in network order */
+    memcpy(entry->loc_addr, msg->id.idiag_src, addr_len);
+    entry->loc_addr_len = addr_len;
+    memcpy(entry->rmt_addr, msg->id.idiag_dst, addr_len);
+    entry->rmt_addr_len = addr_len;
+
+    _add_entry(load, entry, msg->idiag_inode);
+
+    return 0;
+}
+#endif /* HAVE_LINUX_SOCK_DIAG_H */
+
+/**
+ * load one address family through sock_diag, with the listen state
+ * filter done by the kernel.
+ *
+ * @retval  0 no errors
+ * @retval -2 sock_diag not available
+ * @retval !0 errors
+ */
+static int
+_load_diag(tcpconn_load *load, int family)
+{
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+    unsigned int    states = TCPCONN_DIAG_STATES_ALL;
+
+    if (load->flags & NETSNMP_ACCESS_TCPCONN_LOAD_NOLISTEN)
+        states &= ~TCPCONN_DIAG_STATE_LISTEN;
+    else if (load->flags & NETSNMP_ACCESS_TCPCONN_LOAD_ONLYLISTEN)
+        states = TCPCONN_DIAG_STATE_LISTEN;
+
+    return netsnmp_inet_diag_dump(family, IPPROTO_TCP, states,
+                                  _diag_entry, load);
+#else
+    return -2;
 #endif
+}
 
-    return rc;
+/**
+ * look up the connection in the load's filter through sock_diag
+ *
+ * @retval  0 no errors, whether it was found or not
+ * @retval -2 sock_diag not available, or not sure
+ * @retval !0 errors
+ */
+static int
+_get_diag(tcpconn_load *load, int family)
+{
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+    const netsnmp_tcpconn_entry *exact = load->filter->exact;
+    struct inet_diag_sockid id;
+
+    if (exact->loc_addr_len > sizeof(id.idiag_src) ||
+        exact->rmt_addr_len > sizeof(id.idiag_dst))
+        return -2;
+
+    memset(&id, 0, sizeof(id));
+    id.idiag_sport = htons(exact->loc_port);
+    id.idiag_dport = htons(exact->rmt_port);
+    memcpy(id.idiag_src, exact->loc_addr, exact->loc_addr_len);
+    memcpy(id.idiag_dst, exact->rmt_addr, exact->rmt_addr_len);
+    id.idiag_cookie[0] = INET_DIAG_NOCOOKIE;
+    id.idiag_cookie[1] = INET_DIAG_NOCOOKIE;
+
+    return netsnmp_inet_diag_get(family, IPPROTO_TCP, &id, _diag_entry, load);
+#else
+    return -2;
+#endif
 }
 
 /**
@@ -116,13 +381,14 @@ netsnmp_arch_tcpconn_container_load(netsnmp_container *container,
  * @retval !0 errors
  */
 static int
-_load4(netsnmp_container *container, u_int load_flags)
+_load4(tcpconn_load *load)
 {
     int             rc = 0;
     FILE           *in;
     char            line[160];
+    u_int           load_flags = load->flags;
     
-    netsnmp_assert(NULL != container);
+    netsnmp_assert(NULL != load->container);
 
 #define PROCFILE "/proc/net/tcp"
     if (!(in = fopen(PROCFILE, "r"))) {
@@ -185,7 +451,6 @@ _load4(netsnmp_container *container, u_int load_flags)
         entry->loc_port = (unsigned short) local_port;
         entry->rmt_port = (unsigned short) remote_port;
         entry->tcpConnState = state;
-        entry->pid = netsnmp_get_pid_from_inode(inode);
 
         /** the addr string may need work */
         buf_len = strlen(local_addr);
@@ -236,8 +501,7 @@ _load4(netsnmp_container *container, u_int load_flags)
         /*
          * add entry to container
          */
-        entry->arbitrary_index = CONTAINER_SIZE(container) + 1;
-        CONTAINER_INSERT(container, entry);
+        _add_entry(load, entry, inode);
     }
 
     fclose(in);
@@ -255,14 +519,15 @@ _load4(netsnmp_container *container, u_int load_flags)
  * @retval !0 errors
  */
 static int
-_load6(netsnmp_container *container, u_int load_flags)
+_load6(tcpconn_load *load)
 {
     int             rc = 0;
     FILE           *in;
     char            line[180];
     static int      log_open_err = 1;
+    u_int           load_flags = load->flags;
 
-    netsnmp_assert(NULL != container);
+    netsnmp_assert(NULL != load->container);
 
 #undef PROCFILE
 #define PROCFILE "/proc/net/tcp6"
@@ -338,7 +603,6 @@ _load6(netsnmp_container *container, u_int load_flags)
         entry->loc_port = (unsigned short) local_port;
         entry->rmt_port = (unsigned short) remote_port;
         entry->tcpConnState = state;
-        entry->pid = netsnmp_get_pid_from_inode(inode);
 
         /** the addr string may need work */
         buf_len = strlen(local_addr);
@@ -389,8 +653,7 @@ _load6(netsnmp_container *container, u_int load_flags)
         /*
          * add entry to container
          */
-        entry->arbitrary_index = CONTAINER_SIZE(container) + 1;
-        CONTAINER_INSERT(container, entry);
+        _add_entry(load, entry, inode);
     }
 
     fclose(in);
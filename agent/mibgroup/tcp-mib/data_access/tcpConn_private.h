@@ -1,4 +1,8 @@
 int netsnmp_arch_tcpconn_container_load(netsnmp_container *, u_int);
+#ifdef NETSNMP_ACCESS_TCPCONN_HAVE_FILTER
+int netsnmp_arch_tcpconn_container_load_filter(netsnmp_container *, u_int,
+                                               netsnmp_tcpconn_filter *);
+#endif
 int netsnmp_arch_tcpconn_entry_init(netsnmp_tcpconn_entry *);
 void netsnmp_arch_tcpconn_entry_cleanup(netsnmp_tcpconn_entry *);
 int netsnmp_arch_tcpconn_entry_delete(netsnmp_tcpconn_entry *);
@@ -270,6 +270,119 @@ tcpConnectionTable_container_load(netsnmp_container *container)
     return MFD_SUCCESS;
 }                               /* tcpConnectionTable_container_load */
 
+/*
+ * index a connection the way _add_connection() does
+ */
+static int
+_connection_index(netsnmp_tcpconn_entry *entry, netsnmp_index *index)
+{
+    tcpConnectionTable_mib_index tbl_idx;
+
+    memset(&tbl_idx, 0, sizeof(tbl_idx));
+    if (MFD_SUCCESS !=
+        tcpConnectionTable_indexes_set_tbl_idx(&tbl_idx,
+                                               entry->loc_addr_len,
+                                               entry->loc_addr,
+                                               entry->loc_addr_len,
+                                               entry->loc_port,
+                                               entry->rmt_addr_len,
+                                               entry->rmt_addr,
+                                               entry->rmt_addr_len,
+                                               entry->rmt_port))
+        return -1;
+
+    return tcpConnectionTable_index_to_oid(index, &tbl_idx);
+}
+
+/**
+ * load the part of the data that a request needs
+ *
+ * @param container container to which items should be inserted
+ * @param range     the row at an index, or the first row after one
+ *
+ * @retval MFD_SUCCESS : the container has the row, or there is no row
+ *                       at the index
+ * @retval MFD_SKIP    : load the whole table instead
+ *
+ *  Called instead of tcpConnectionTable_container_load() when a request
+ *  only needs one row (see netsnmp_cache_hint_range()). Only the kernel's
+ *  answer for that connection is fetched, or, for the row after an index,
+ *  the connections are compared without creating rows for them.
+ */
+int
+tcpConnectionTable_container_load_range(netsnmp_container *container,
+                                        const netsnmp_cache_range *range)
+{
+    netsnmp_container *raw_data;
+    netsnmp_tcpconn_filter filter;
+    netsnmp_tcpconn_entry exact;
+    tcpConnectionTable_mib_index tbl_idx;
+    netsnmp_index   index;
+
+    DEBUGMSGTL(("verbose:tcpConnectionTable:tcpConnectionTable_container_load_range", "called\n"));
+
+    memset(&filter, 0, sizeof(filter));
+    if (range->exact) {
+        /*
+         * an index that doesn't parse, or with addresses of different
+         * types, has no row
+         */
+        memset(&tbl_idx, 0, sizeof(tbl_idx));
+        index = range->index;
+        if (SNMP_ERR_NOERROR !=
+            tcpConnectionTable_index_from_oid(&index, &tbl_idx) ||
+            tbl_idx.tcpConnectionLocalAddressType !=
+            tbl_idx.tcpConnectionRemAddressType ||
+            tbl_idx.tcpConnectionLocalAddress_len !=
+            tbl_idx.tcpConnectionRemAddress_len ||
+            tbl_idx.tcpConnectionLocalPort > 0xffff ||
+            tbl_idx.tcpConnectionRemPort > 0xffff)
+            return MFD_SUCCESS;
+        if ((INETADDRESSTYPE_IPV4 == tbl_idx.tcpConnectionLocalAddressType &&
+             4 != tbl_idx.tcpConnectionLocalAddress_len) ||
+            (INETADDRESSTYPE_IPV6 == tbl_idx.tcpConnectionLocalAddressType &&
+             16 != tbl_idx.tcpConnectionLocalAddress_len))
+            return MFD_SUCCESS;
+        if (INETADDRESSTYPE_IPV4 != tbl_idx.tcpConnectionLocalAddressType &&
+            INETADDRESSTYPE_IPV6 != tbl_idx.tcpConnectionLocalAddressType)
+            return MFD_SKIP;
+
+        memset(&exact, 0, sizeof(exact));
+        memcpy(exact.loc_addr, tbl_idx.tcpConnectionLocalAddress,
+               tbl_idx.tcpConnectionLocalAddress_len);
+        exact.loc_addr_len = tbl_idx.tcpConnectionLocalAddress_len;
+        exact.loc_port = tbl_idx.tcpConnectionLocalPort;
+        memcpy(exact.rmt_addr, tbl_idx.tcpConnectionRemAddress,
+               tbl_idx.tcpConnectionRemAddress_len);
+        exact.rmt_addr_len = tbl_idx.tcpConnectionRemAddress_len;
+        exact.rmt_port = tbl_idx.tcpConnectionRemPort;
+        filter.exact = &exact;
+    } else {
+        filter.after = &range->index;
+        filter.index = _connection_index;
+    }
+
+    raw_data =
+        netsnmp_access_tcpconn_container_load_filter(NULL,
+                                                     NETSNMP_ACCESS_TCPCONN_LOAD_NOLISTEN,
+                                                     &filter);
+    if (NULL == raw_data)
+        return MFD_SKIP;
+
+    CONTAINER_FOR_EACH(raw_data, (netsnmp_container_obj_func *)
+                       _add_connection, container);
+    netsnmp_access_tcpconn_container_free(raw_data,
+                                          NETSNMP_ACCESS_TCPCONN_FREE_DONT_CLEAR);
+
+    /*
+     * nothing after the index: the next row is in the next column
+     */
+    if (!range->exact && 0 == CONTAINER_SIZE(container))
+        return MFD_SKIP;
+
+    return MFD_SUCCESS;
+}
+
 /**
  * container clean up
  *
@@ -70,6 +70,11 @@ extern          "C" {
 
     int             tcpConnectionTable_container_load(netsnmp_container
                                                       *container);
+    int             tcpConnectionTable_container_load_range(netsnmp_container
+                                                            *container,
+                                                            const
+                                                            netsnmp_cache_range
+                                                            *range);
     void            tcpConnectionTable_container_free(netsnmp_container
                                                       *container);
 
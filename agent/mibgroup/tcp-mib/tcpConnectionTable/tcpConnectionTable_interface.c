@@ -52,6 +52,7 @@ netsnmp_feature_child_of(tcpConnectionTable_external_access, libnetsnmpmibs)
 netsnmp_feature_require(row_merge)
 netsnmp_feature_require(baby_steps)
 netsnmp_feature_require(check_all_requests_error)
+netsnmp_feature_require(cache_hint_range)
 
 
 netsnmp_feature_child_of(tcpConnectionTable_container_size, tcpConnectionTable_external_access)
@@ -1651,6 +1652,9 @@ static void     _container_free(netsnmp_container *container);
 static int
 _cache_load(netsnmp_cache * cache, void *vmagic)
 {
+    netsnmp_cache_range range;
+    int             rc;
+
     DEBUGMSGTL(("internal:tcpConnectionTable:_cache_load", "called\n"));
 
     if ((NULL == cache) || (NULL == cache->magic)) {
@@ -1663,8 +1667,19 @@ _cache_load(netsnmp_cache * cache, void *vmagic)
     netsnmp_assert((0 == cache->valid) || (1 == cache->expired));
 
     /*
-     * call user code
-     */
+     * call user code, for the one row a request needs if it can
+     */
+    if (netsnmp_cache_hint_range(cache, &range)) {
+        rc = tcpConnectionTable_container_load_range((netsnmp_container *)
+                                                     cache->magic, &range);
+        if (MFD_SUCCESS == rc) {
+            cache->flags |= NETSNMP_CACHE_PARTIAL_LOAD;
+            return rc;
+        }
+        if (MFD_SKIP != rc)
+            return rc;
+    }
+
     return tcpConnectionTable_container_load((netsnmp_container *) cache->
                                              magic);
 }                               /* _cache_load */
@@ -1772,6 +1787,10 @@ _tcpConnectionTable_container_init(tcpConnectionTable_interface_ctx *
         return;
     }
 
+    /* set allow duplicates this makes insert O(1) */
+    netsnmp_binary_array_options_set(if_ctx->container, 1,
+                                     CONTAINER_KEY_ALLOW_DUPLICATES);
+
     if (NULL != if_ctx->cache)
         if_ctx->cache->magic = (void *) if_ctx->container;
 }                               /* _tcpConnectionTable_container_init */
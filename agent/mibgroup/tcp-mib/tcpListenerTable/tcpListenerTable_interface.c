@@ -958,6 +958,10 @@ _tcpListenerTable_container_init(tcpListenerTable_interface_ctx * if_ctx)
         return;
     }
 
+    /* set allow duplicates this makes insert O(1) */
+    netsnmp_binary_array_options_set(if_ctx->container, 1,
+                                     CONTAINER_KEY_ALLOW_DUPLICATES);
+
     if (NULL != if_ctx->cache)
         if_ctx->cache->magic = (void *) if_ctx->container;
 }                               /* _tcpListenerTable_container_init */
@@ -190,7 +190,7 @@ disk_parse_config(const char *token, char *cptr)
   if ( entry ) {
       entry->minspace   = minspace;
       entry->minpercent = minpercent;
-      entry->flags     |= ~NETSNMP_FS_FLAG_UCD;
+      entry->flags     |= NETSNMP_FS_FLAG_UCD;
       disks[numdisks++] = entry;
   }
 }
@@ -230,7 +230,7 @@ disk_parse_config_all(const char *token, char *cptr)
               continue;
           entry->minspace   = -1;
           entry->minpercent = minpercent;
-          entry->flags     &= NETSNMP_FS_FLAG_UCD;
+          entry->flags     |= NETSNMP_FS_FLAG_UCD;
           /*
            * Ensure there is space for the new entry
            */
@@ -305,8 +305,16 @@ var_extensible_disk(struct variable *vp,
     unsigned long long val;
     static long     long_ret;
     static char     errmsg[300];
-
-    netsnmp_fsys_load( NULL, NULL );  /* Update the fsys H/W module */
+    netsnmp_cache  *cache;
+
+    /*
+     * Update the fsys H/W module, unless it is recent enough
+     */
+    cache = netsnmp_fsys_get_cache();
+    if ( cache )
+        netsnmp_cache_check_and_reload( cache );
+    else
+        netsnmp_fsys_load( NULL, NULL );
 
 tryAgain:
     if (header_simple_table
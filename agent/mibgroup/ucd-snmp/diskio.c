@@ -31,6 +31,7 @@
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 
 #include "util_funcs/header_simple_table.h"
+#include "util_funcs/sampler.h"
 
 /*
  * include our .h file 
@@ -93,8 +94,7 @@ static int ps_numdisks;			/* number of disks in system, may change while running
 #endif
 
 #if defined (linux)
-#define DISKIO_SAMPLE_INTERVAL 5
-void devla_getstats(unsigned int regno, void * dummy);
+static void devla_getstats(const struct timeval *now, void *dummy);
 #endif /* linux */
 
 #if defined (darwin)
@@ -224,12 +224,20 @@ init_diskio(void)
     ps_disk = NULL;
 #endif
 
-#if defined (freebsd4) || defined(freebsd5) || defined(linux)
+#if defined (freebsd4) || defined(freebsd5)
     devla_getstats(0, NULL);
     /* collect LA data regularly */
     snmp_alarm_register(DISKIO_SAMPLE_INTERVAL, SA_REPEAT, devla_getstats, NULL);
 #endif
 
+#ifdef linux
+    /*
+     * sample the disks regularly, with the cpu and memory statistics,
+     * for the load averages; requests are answered from the samples
+     */
+    netsnmp_sampler_register("diskio", devla_getstats, NULL);
+#endif
+
 
 #ifdef linux
     char *app = netsnmp_ds_get_string(NETSNMP_DS_LIBRARY_ID,
@@ -889,14 +897,11 @@ typedef struct linux_diskio
     unsigned long  running;
     unsigned long  use;
     unsigned long  aveq;
-} linux_diskio;
 
-/* disk load averages */
-typedef struct linux_diskio_la
-{
-    unsigned long use_prev;
+    /* disk load averages, carried over from one sample to the next */
+    unsigned long  use_prev;
     double la1, la5, la15;
-} linux_diskio_la;
+} linux_diskio;
 
 typedef struct linux_diskio_header
 {
@@ -905,57 +910,58 @@ typedef struct linux_diskio_header
     int alloc;
 } linux_diskio_header;
 
-typedef struct linux_diskio_la_header
-{
-    linux_diskio_la * indices;   
-    int length;
-} linux_diskio_la_header;
+/*
+ * the disks of the last sample, and the one before it
+ */
+static linux_diskio_header head, prev;
 
-static linux_diskio_header head;
-static linux_diskio_la_header la_head;
+/*
+ * when the disks were last sampled; 0 if they aren't
+ */
+static struct timeval sample_time;
 
-void devla_getstats(unsigned int regno, void * dummy) {
+static int _diskio_load(void);
 
-    static double expon1, expon5, expon15;
+static void
+devla_getstats(const struct timeval *now, void *dummy)
+{
+    double expon1, expon5, expon15, interval;
     double busy_time, busy_percent;
     int idx;
 
-    if (getstats() == 1) {
+    if (_diskio_load() == 1) {
         ERROR_MSG("can't do diskio getstats()\n");
         return;
     }
 
-    if (!la_head.length) {
-        la_head.indices = (linux_diskio_la *) malloc(head.length * sizeof(linux_diskio_la));
-        for (idx=0; idx<head.length; idx++) {
-            la_head.indices[idx].la1 = la_head.indices[idx].la5 = la_head.indices[idx].la15 = 0.; 
-            la_head.indices[idx].use_prev = head.indices[idx].use;
-        }
-        la_head.length = head.length;
-        expon1 = exp(-(((double)DISKIO_SAMPLE_INTERVAL) / ((double)60)));
-        expon5 = exp(-(((double)DISKIO_SAMPLE_INTERVAL) / ((double)300)));
-        expon15 = exp(-(((double)DISKIO_SAMPLE_INTERVAL) / ((double)900)));
-    }
-    else if (head.length - la_head.length) {
-        la_head.indices = (linux_diskio_la *) realloc(la_head.indices, head.length * sizeof(linux_diskio_la));
-        for (idx=la_head.length; idx<head.length; idx++) {
-            la_head.indices[idx].la1 = la_head.indices[idx].la5 = la_head.indices[idx].la15 = 0.; 
-            la_head.indices[idx].use_prev = head.indices[idx].use;
-        }
-        la_head.length = head.length;
-    }
+    /*
+     * the load averages decay over the time since the last sample,
+     * which is only roughly sampleInterval
+     */
+    interval = 0;
+    if (sample_time.tv_sec)
+        interval = (now->tv_sec - sample_time.tv_sec) +
+                   (now->tv_usec - sample_time.tv_usec) / 1000000.;
+    sample_time = *now;
+    if (interval <= 0)
+        return;
+    expon1 = exp(-interval / 60.);
+    expon5 = exp(-interval / 300.);
+    expon15 = exp(-interval / 900.);
 
     for (idx=0; idx<head.length; idx++) {
-        busy_time = head.indices[idx].use - la_head.indices[idx].use_prev;
-        busy_percent = busy_time * 100. / ((double) DISKIO_SAMPLE_INTERVAL) / 1000.;
-        la_head.indices[idx].la1 = la_head.indices[idx].la1 * expon1 + busy_percent * (1. - expon1);
-        la_head.indices[idx].la5 = la_head.indices[idx].la5 * expon5 + busy_percent * (1. - expon5);
-        la_head.indices[idx].la15 = la_head.indices[idx].la15 * expon15 + busy_percent * (1. - expon15);
+        linux_diskio *d = &head.indices[idx];
+
+        busy_time = d->use - d->use_prev;
+        busy_percent = busy_time * 100. / interval / 1000.;
+        d->la1 = d->la1 * expon1 + busy_percent * (1. - expon1);
+        d->la5 = d->la5 * expon5 + busy_percent * (1. - expon5);
+        d->la15 = d->la15 * expon15 + busy_percent * (1. - expon15);
         /*
           fprintf(stderr, "(%d) update la1=%f la5=%f la15=%f\n",
-          idx, la_head.indices[idx].la1, la_head.indices[idx].la5, la_head.indices[idx].la15);   
+          idx, d->la1, d->la5, d->la15);
         */
-        la_head.indices[idx].use_prev = head.indices[idx].use;
+        d->use_prev = d->use;
     }
 }
 
@@ -976,25 +982,119 @@ int is_excluded(const char *name)
     return 0;
 }
 
+/*
+ * carry a disk's load averages over from the previous load.  The disks
+ * are mostly listed in the same order each time.
+ */
+static void
+_diskio_carry(linux_diskio *d, int idx)
+{
+    linux_diskio *p = NULL;
+    int i;
+
+    if (idx < prev.length && !strcmp(prev.indices[idx].name, d->name))
+        p = &prev.indices[idx];
+    else
+        for (i = 0; i < prev.length; i++)
+            if (!strcmp(prev.indices[i].name, d->name)) {
+                p = &prev.indices[i];
+                break;
+            }
+    if (p) {
+        d->use_prev = p->use_prev;
+        d->la1 = p->la1;
+        d->la5 = p->la5;
+        d->la15 = p->la15;
+    } else
+        d->use_prev = d->use;
+}
+
+/*
+ * parse a /proc/diskstats line: the device numbers and name, and 4 or
+ * (since 2.6.25 for partitions) 11 or more counters
+ */
+static int
+_diskio_parse(char *buffer, linux_diskio *d)
+{
+    unsigned long v[11];
+    char *cp, *end, *name;
+    int n;
+
+    d->major = strtol(buffer, &cp, 10);
+    d->minor = strtol(cp, &cp, 10);
+    while (*cp == ' ')
+        cp++;
+    name = cp;
+    while (*cp && *cp != ' ' && *cp != '\n')
+        cp++;
+    if (cp == name || cp - name >= (int)sizeof(d->name))
+        return -1;
+    memcpy(d->name, name, cp - name);
+    d->name[cp - name] = '\0';
+
+    for (n = 0; n < 11; n++) {
+        v[n] = strtoul(cp, &end, 10);
+        if (end == cp)
+            break;
+        cp = end;
+    }
+    if (n >= 11) {
+        d->rio = v[0];  d->rmerge = v[1]; d->rsect = v[2]; d->ruse = v[3];
+        d->wio = v[4];  d->wmerge = v[5]; d->wsect = v[6]; d->wuse = v[7];
+        d->running = v[8]; d->use = v[9]; d->aveq = v[10];
+    } else if (n >= 4) {
+        d->rio = v[0];  d->rsect = v[1];
+        d->wio = v[2];  d->wsect = v[3];
+    } else
+        return -1;
+    return 0;
+}
+
 static int
 getstats(void)
 {
-    FILE* parts;
     time_t now;
     
+    /*
+     * while the disks are being sampled, requests are answered from the
+     * last sample
+     */
     now = time(NULL);
+    if (sample_time.tv_sec &&
+        sample_time.tv_sec + netsnmp_sampler_interval() + 1 > now)
+        return 0;
     if (cache_time + CACHE_TIMEOUT > now) {
         return 0;
     }
+    return _diskio_load();
+}
+
+static int
+_diskio_load(void)
+{
+    FILE* parts;
+    linux_diskio_header tmp;
 
+    /*
+     * load into the spare array, and keep the last one to carry the
+     * load averages over from
+     */
+    tmp = prev;
+    prev = head;
+    head = tmp;
     if (!head.indices) {
 	head.alloc = DISK_INCR;
 	head.indices = (linux_diskio *)malloc(head.alloc*sizeof(linux_diskio));
+	if (!head.indices) {
+	    head.alloc = 0;
+	    tmp = prev;
+	    prev = head;
+	    head = tmp;
+	    return 1;
+	}
     }
     head.length  = 0;
 
-    memset(head.indices, 0, head.alloc*sizeof(linux_diskio));
-
     /* Is this a 2.6 kernel? */
     parts = fopen("/proc/diskstats", "r");
     if (parts) {
@@ -1002,22 +1102,18 @@ getstats(void)
 	while (fgets(buffer, sizeof(buffer), parts)) {
 	    linux_diskio* pTemp;
 	    if (head.length == head.alloc) {
+		pTemp = (linux_diskio *)realloc(head.indices, (head.alloc + DISK_INCR)*sizeof(linux_diskio));
+		if (!pTemp)
+		    break;
+		head.indices = pTemp;
 		head.alloc += DISK_INCR;
-		head.indices = (linux_diskio *)realloc(head.indices, head.alloc*sizeof(linux_diskio));
 	    }
 	    pTemp = &head.indices[head.length];
-	    sscanf (buffer, "%d %d", &pTemp->major, &pTemp->minor);
- 	    if (sscanf (buffer, "%d %d %s %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu\n",
-		    &pTemp->major, &pTemp->minor, pTemp->name,
-		    &pTemp->rio, &pTemp->rmerge, &pTemp->rsect, &pTemp->ruse,
-		    &pTemp->wio, &pTemp->wmerge, &pTemp->wsect, &pTemp->wuse,
- 		    &pTemp->running, &pTemp->use, &pTemp->aveq) != 14)
-		sscanf (buffer, "%d %d %s %lu %lu %lu %lu\n",
-		    &pTemp->major, &pTemp->minor, pTemp->name,
-		    &pTemp->rio, &pTemp->rsect,
-		    &pTemp->wio, &pTemp->wsect);
-            if (!is_excluded(pTemp->name))
-	        head.length++;
+	    memset(pTemp, 0, sizeof(*pTemp));
+	    if (_diskio_parse(buffer, pTemp) < 0 || is_excluded(pTemp->name))
+	        continue;
+	    _diskio_carry(pTemp, head.length);
+	    head.length++;
 	}
     }
     else {
@@ -1040,12 +1136,16 @@ getstats(void)
 	    linux_diskio* pTemp;
 
 	    if (head.length == head.alloc) {
+		pTemp = (linux_diskio *)realloc(head.indices, (head.alloc + DISK_INCR)*sizeof(linux_diskio));
+		if (!pTemp)
+		    break;
+		head.indices = pTemp;
 		head.alloc += DISK_INCR;
-		head.indices = (linux_diskio *)realloc(head.indices, head.alloc*sizeof(linux_diskio));
 	    }
 	    pTemp = &head.indices[head.length];
+	    memset(pTemp, 0, sizeof(*pTemp));
 
-	    rc = fscanf (parts, "%d %d %lu %s %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu\n",
+	    rc = fscanf (parts, "%d %d %lu %255s %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu\n",
 		    &pTemp->major, &pTemp->minor, &pTemp->blocks, pTemp->name,
 		    &pTemp->rio, &pTemp->rmerge, &pTemp->rsect, &pTemp->ruse,
 		    &pTemp->wio, &pTemp->wmerge, &pTemp->wsect, &pTemp->wuse,
@@ -1055,13 +1155,15 @@ getstats(void)
                fclose(parts);
                return 1;
             }
-            if (!is_excluded(pTemp->name))
+            if (!is_excluded(pTemp->name)) {
+	        _diskio_carry(pTemp, head.length);
 	        head.length++;
+	    }
 	}
     }
 
     fclose(parts);
-    cache_time = now;
+    cache_time = time(NULL);
     return 0;
 }
 
@@ -1111,13 +1213,13 @@ var_diskio(struct variable * vp,
       long_ret = head.indices[indx].wio & 0xffffffff;
       return (u_char *) & long_ret;
     case DISKIO_LA1:
-      long_ret = la_head.indices[indx].la1;
+      long_ret = head.indices[indx].la1;
       return (u_char *) & long_ret;
     case DISKIO_LA5:
-      long_ret = la_head.indices[indx].la5;
+      long_ret = head.indices[indx].la5;
       return (u_char *) & long_ret;
     case DISKIO_LA15:
-      long_ret = la_head.indices[indx].la15;
+      long_ret = head.indices[indx].la15;
       return (u_char *) & long_ret;
     case DISKIO_NREADX:
       *var_len = sizeof(struct counter64);
@@ -2,6 +2,7 @@
 #define _MIBGROUP_DISKIO_H
 
 config_require(util_funcs/header_simple_table)
+config_require(util_funcs/sampler)
 config_add_mib(UCD-DISKIO-MIB)
 
     /*
@@ -15,9 +15,17 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <regex.h>
 #include <time.h>
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif
 
 #include <net-snmp/net-snmp-includes.h>
 #include <net-snmp/agent/net-snmp-agent-includes.h>
@@ -77,271 +85,715 @@ logmatch_update_filename(const char * pattern, char * currentFilename)
     }
 }
 
+struct logmatchfile;
+
 struct logmatchstat {
     char            filenamePattern[256];
     char            filename[256];
     char            regEx[256];
     char            name[256];
-    FILE           *logfile;
     long            currentFilePosition;
     unsigned long   globalMatchCounter;
     unsigned long   currentMatchCounter;
     unsigned long   matchCounter;
     regex_t         regexBuffer;
     int             myRegexError;
-    int             virgin;
     int             thisIndex;
     int             frequency;
+    int             combined;   /* part of the file's combined regex */
+    int             anyChanges; /* position file needs updating      */
+    struct logmatchfile *file;
+    struct logmatchstat *nextInFile;
+};
+
+/*
+ * ------------------------------------------------
+ *  All the logmatch entries monitoring the same
+ *  file share one of these: the file is kept open,
+ *  read in large blocks from where the last pass
+ *  stopped, and each line is matched against all
+ *  the entries' patterns together.
+ *
+ *  The combined regex is the alternation of the
+ *  entries' patterns, so that the (usual) lines
+ *  which none of them match only need one regexec.
+ *
+ *  Where inotify is available the file and its
+ *  directory are watched, and the file is read as
+ *  soon as it is written to (or replaced); the
+ *  cycle time then only matters for noticing a
+ *  new file name.
+ *
+ *  A file that has been replaced is kept open and
+ *  read on, as its writer may not have moved on to
+ *  the new one yet, until the new one is written
+ *  to or a cycle time has gone by.
+ * ------------------------------------------------
+ */
+struct logmatchfile {
+    char            filenamePattern[256];
+    char            filename[256];
+    int             fd;
+    dev_t           dev;
+    ino_t           ino;
+    long            position;   /* end of the last line read */
+    int             oldFd;      /* the file this one replaced, ... */
+    long            oldPosition;
+    time_t          oldSince;   /* ... and when it was replaced   */
+    time_t          filenameChecked;
+    int             virgin;
+    int             frequency;
+    unsigned int    alarm;
+    struct logmatchstat *entries;
+    regex_t         combinedRegex;
+    int             combinedCount;
+    int             combinedStale;
+    int             wd;         /* inotify watch on the file         */
+    int             dirWd;      /* ... and on the directory it is in */
+    int             dirty;
+    struct logmatchfile *next;
 };
 
 #define MAXLOGMATCH   250
+#define LOGMATCH_BLOCK  65536   /* bytes read from a log file at a time */
 
 static struct logmatchstat logmatchTable[MAXLOGMATCH];
 static int                 logmatchCount = 0;
+static struct logmatchfile *logmatchFiles = NULL;
+static int                 logmatchInotifyFd = -1;
 
 /***************************************************************
 *                                                              *
-* updateLogmatch                                               *
-* this function is called back by snmpd alarms                 *
+* logmatch_combinable                                          *
+* can this regex be one alternative of a combined regex ?      *
+* (not if it has back-references, which would be renumbered,   *
+* or unbalanced parentheses, which would change the grouping)  *
 *                                                              *
 ***************************************************************/
 
-static void
-updateLogmatch(int iindex)
+static int
+logmatch_combinable(const char *re)
 {
+    const char     *cp;
+    char            close;
+    int             depth = 0;
+
+    for (cp = re; *cp; cp++) {
+        switch (*cp) {
+        case '\\':
+            if (isdigit((unsigned char) cp[1]))
+                return 0;
+            if (cp[1])
+                cp++;
+            break;
+        case '[':
+            cp++;
+            if (*cp == '^')
+                cp++;
+            if (*cp == ']')
+                cp++;
+            for (; *cp && *cp != ']'; cp++) {
+                if (*cp == '[' &&
+                    (cp[1] == ':' || cp[1] == '.' || cp[1] == '=')) {
+                    close = cp[1];
+                    for (cp += 2; *cp && !(*cp == close && cp[1] == ']');
+                         cp++)
+                        ;
+                    if (!*cp)
+                        return 0;
+                    cp++;
+                }
+            }
+            if (!*cp)
+                return 0;
+            break;
+        case '(':
+            depth++;
+            break;
+        case ')':
+            if (--depth < 0)
+                return 0;
+            break;
+        }
+    }
+    return depth == 0;
+}
 
-    regmatch_t      myMatch;
-    int             matchResultCode;
-    char            inbuf[1024];
-    char            perfilename[1024];
-    FILE           *perfile;
-    unsigned long   pos, ccounter, counter;
-    int             result;
-    int             toobig;
-    int             anyChanges = FALSE;
-    struct stat     sb;
-    char            lastFilename[256];
+static void
+logmatch_compile_combined(struct logmatchfile *lf)
+{
+    struct logmatchstat *lm;
+    char           *buf, *cp;
+    size_t          len = 1;
+    int             count = 0;
+
+    if (lf->combinedCount)
+        regfree(&lf->combinedRegex);
+    lf->combinedCount = 0;
+    lf->combinedStale = 0;
+
+    for (lm = lf->entries; lm; lm = lm->nextInFile) {
+        lm->combined = (lm->myRegexError == 0 &&
+                        logmatch_combinable(lm->regEx));
+        if (lm->combined) {
+            len += strlen(lm->regEx) + 3;
+            count++;
+        }
+    }
 
     /*
-     * ------------------------------------ 
-     * we can never be sure if this is the  
-     * last time we are being called here,  
-     * so we always update a persistent     
-     * data file with our current file      
-     * position                             
-     * ------------------------------------ 
+     * with a single pattern, the pattern itself is as quick
      */
+    if (count < 2 || (buf = (char *) malloc(len)) == NULL) {
+        for (lm = lf->entries; lm; lm = lm->nextInFile)
+            lm->combined = 0;
+        return;
+    }
 
-    snprintf(perfilename, sizeof(perfilename), "%s/snmpd_logmatch_%s.pos",
-             get_persistent_directory(), logmatchTable[iindex].name);
+    cp = buf;
+    for (lm = lf->entries; lm; lm = lm->nextInFile) {
+        if (!lm->combined)
+            continue;
+        cp += sprintf(cp, "%s(%s)", cp == buf ? "" : "|", lm->regEx);
+    }
 
-    if (logmatchTable[iindex].virgin) {
+    if (regcomp(&lf->combinedRegex, buf, REG_EXTENDED | REG_NOSUB) == 0) {
+        lf->combinedCount = count;
+    } else {
+        for (lm = lf->entries; lm; lm = lm->nextInFile)
+            lm->combined = 0;
+    }
+    DEBUGMSGTL(("ucd-snmp/logmatch", "%s: %d of the patterns combined\n",
+                lf->filename, lf->combinedCount));
+    free(buf);
+}
+
+/***************************************************************
+*                                                              *
+* logmatch_match                                               *
+* match one line against all the patterns for this file        *
+*                                                              *
+***************************************************************/
+
+static void
+logmatch_match(struct logmatchfile *lf, const char *line, long start)
+{
+    struct logmatchstat *lm;
+    int             combinedMatch = 1;
+
+    if (lf->combinedCount)
+        combinedMatch =
+            (regexec(&lf->combinedRegex, line, 0, NULL, REG_NOTEOL) == 0);
+
+    for (lm = lf->entries; lm; lm = lm->nextInFile) {
+        if (lm->myRegexError != 0 || (lm->combined && !combinedMatch))
+            continue;
 
         /*
-         * ------------------------------------ 
-         * this is the first time we are being  
-         * called; let's try to find an old     
-         * file position stored in a persistent 
-         * data file and restore it             
-         * ------------------------------------ 
+         * this entry's restored position may be further on
          */
+        if (start < lm->currentFilePosition)
+            continue;
+
+        if (regexec(&lm->regexBuffer, line, 0, NULL, REG_NOTEOL) == 0) {
+            lm->globalMatchCounter++;
+            lm->currentMatchCounter++;
+            lm->matchCounter++;
+            lm->anyChanges = TRUE;
+        }
+    }
+}
 
-        if ((perfile = fopen(perfilename, "r"))) {
+/***************************************************************
+*                                                              *
+* logmatch_read                                                *
+* read whatever was added to the file open on fd since the     *
+* last pass, which got up to *position (an incomplete last     *
+* line is left for the next pass, unless the file is finished  *
+* with)                                                        *
+*                                                              *
+***************************************************************/
 
+static void
+logmatch_read(struct logmatchfile *lf, int fd, long *position, int finished)
+{
+    static char     buf[LOGMATCH_BLOCK + 1];
+    size_t          len = 0;
+    ssize_t         got;
+    char           *line, *eol, saved;
+    long            start;
+
+    if (fd < 0)
+        return;
+
+    for (;;) {
+        got = pread(fd, buf + len, LOGMATCH_BLOCK - len, *position + len);
+        if (got <= 0) {
+            if (got < 0 && errno == EINTR)
+                continue;
+            break;
+        }
+        len += got;
+
+        line = buf;
+        start = *position;
+        while ((eol = memchr(line, '\n', buf + len - line)) != NULL) {
+            saved = eol[1];
+            eol[1] = '\0';
+            logmatch_match(lf, line, start);
+            eol[1] = saved;
+            start += eol + 1 - line;
+            line = eol + 1;
+        }
+
+        if (line == buf && len == LOGMATCH_BLOCK) {
             /*
-             * ------------------------------------ 
-             * the persistent data file exists so   
-             * let's read it out                    
-             * ------------------------------------ 
+             * a line longer than the buffer: match it in pieces
              */
+            buf[len] = '\0';
+            logmatch_match(lf, buf, start);
+            start += len;
+            line = buf + len;
+        }
 
+        len = buf + len - line;
+        if (len)
+            memmove(buf, line, len);
+        *position = start;
+    }
 
-            pos = counter = ccounter = 0;
-
-            if (fscanf(perfile, "%lu %lu %lu %s",
-                       &pos, &ccounter, &counter, lastFilename)) {
-
+    if (finished && len) {
+        buf[len] = '\0';
+        logmatch_match(lf, buf, *position);
+        *position += len;
+    }
+}
 
-                /*
-                 * ------------------------------------ 
-                 * the data could be read; now let's    
-                 * try to open the  logfile to be       
-                 * scanned                              
-                 * ------------------------------------ 
-                 */
+/***************************************************************
+*                                                              *
+* inotify watches                                              *
+*                                                              *
+***************************************************************/
 
-                if (logmatch_update_filename(logmatchTable[iindex].filenamePattern,
-                                             lastFilename) == 0) {
-
-                    /*
-                     * ---------------------------------
-                     * the filename is still the same as 
-                     * the one stored in the persistent
-                     * data file.
-                     * ---------------------------------
-                     */
-
-                    if ((logmatchTable[iindex].logfile =
-                        fopen(logmatchTable[iindex].filename, "r"))) {
-
-
-                        /*
-                         * ------------------------------------ 
-                         * the log file could be opened; now    
-                         * let's try to set the pointer         
-                         * ------------------------------------ 
-                         */
-
-                        if (!fseek
-                            (logmatchTable[iindex].logfile, pos, SEEK_SET)) {
-
-
-                            /*
-                             * ------------------------------------ 
-                             * the pointer could be set - this is   
-                             * the most that we can do: if the      
-                             * pointer is smaller than the file     
-                             * size we must assume that the pointer 
-                             * still points to where it read the    
-                             * file last time; let's restore the    
-                             * data                                 
-                             * ------------------------------------ 
-                             */
-
-                            logmatchTable[iindex].currentFilePosition = pos;
-                            logmatchTable[iindex].currentMatchCounter =
-                                ccounter;
-                        }
-
-                        fclose(logmatchTable[iindex].logfile);
-                    }
-                }
-                logmatchTable[iindex].globalMatchCounter = counter;
-            }
+#ifdef HAVE_SYS_INOTIFY_H
+static void     logmatch_inotify_read(int fd, void *data);
 
-            fclose(perfile);
-        }
+static void
+logmatch_unwatch(struct logmatchfile *lf, int *wdp)
+{
+    struct logmatchfile *other;
+    int             wd = *wdp;
 
-        logmatchTable[iindex].virgin = FALSE;
-    }
+    *wdp = -1;
+    if (wd < 0)
+        return;
 
     /*
-     * -------------------------------------------
-     * check if a new input file needs to be opened
-     * if yes, reset counter and position
-     * -------------------------------------------
+     * watches on the same inode share a descriptor
      */
+    for (other = logmatchFiles; other; other = other->next)
+        if (other->wd == wd || other->dirWd == wd)
+            return;
+    inotify_rm_watch(logmatchInotifyFd, wd);
+}
 
-    if (logmatch_update_filename(logmatchTable[iindex].filenamePattern,
-                                 logmatchTable[iindex].filename) == 1) {
-        logmatchTable[iindex].currentFilePosition = 0; 
-        logmatchTable[iindex].currentMatchCounter = 0;
+static void
+logmatch_watch(struct logmatchfile *lf)
+{
+    char            dirname[256];
+    char           *slash;
+
+    if (logmatchInotifyFd < 0) {
+        logmatchInotifyFd = inotify_init();
+        if (logmatchInotifyFd < 0) {
+            DEBUGMSGTL(("ucd-snmp/logmatch", "no inotify: %s\n",
+                        strerror(errno)));
+            return;
+        }
+        fcntl(logmatchInotifyFd, F_SETFL,
+              fcntl(logmatchInotifyFd, F_GETFL) | O_NONBLOCK);
+        if (register_readfd(logmatchInotifyFd, logmatch_inotify_read,
+                            NULL) != FD_REGISTERED_OK) {
+            close(logmatchInotifyFd);
+            logmatchInotifyFd = -1;
+            return;
+        }
     }
 
+    logmatch_unwatch(lf, &lf->wd);
+    if (lf->fd >= 0)
+        lf->wd = inotify_add_watch(logmatchInotifyFd, lf->filename,
+                                   IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF |
+                                   IN_DELETE_SELF);
+
+    logmatch_unwatch(lf, &lf->dirWd);
+    strlcpy(dirname, lf->filename, sizeof(dirname));
+    slash = strrchr(dirname, '/');
+    if (slash == dirname)
+        slash[1] = '\0';
+    else if (slash)
+        *slash = '\0';
+    else
+        strcpy(dirname, ".");
+    lf->dirWd = inotify_add_watch(logmatchInotifyFd, dirname,
+                                  IN_CREATE | IN_MOVED_TO);
+
+    DEBUGMSGTL(("ucd-snmp/logmatch", "watching %s (%d, %d)\n",
+                lf->filename, lf->wd, lf->dirWd));
+}
+#endif                          /* HAVE_SYS_INOTIFY_H */
 
+/***************************************************************
+*                                                              *
+* logmatch_open / logmatch_close_old                           *
+*                                                              *
+***************************************************************/
+
+static void
+logmatch_reset(struct logmatchfile *lf)
+{
+    struct logmatchstat *lm;
+
+    lf->position = 0;
+    for (lm = lf->entries; lm; lm = lm->nextInFile) {
+        lm->currentFilePosition = 0;
+        lm->currentMatchCounter = 0;
+        lm->anyChanges = TRUE;
+    }
+}
+
+/*
+ * read the rest of the file that was replaced, and close it
+ */
+static void
+logmatch_close_old(struct logmatchfile *lf)
+{
+    if (lf->oldFd < 0)
+        return;
+    logmatch_read(lf, lf->oldFd, &lf->oldPosition, TRUE);
+    close(lf->oldFd);
+    lf->oldFd = -1;
+#ifdef HAVE_SYS_INOTIFY_H
     /*
-     * ------------------------------------ 
-     * now the pointer and the counter are  
-     * set either zero or reset to old      
-     * value; now let's try to read some    
-     * data                                 
-     * ------------------------------------ 
+     * until the new file is opened, the watch is still the old one's
      */
+    if (lf->fd < 0)
+        logmatch_unwatch(lf, &lf->wd);
+#endif
+}
 
-    if (stat(logmatchTable[iindex].filename, &sb) == 0) {
-
-        if (logmatchTable[iindex].currentFilePosition > sb.st_size) {
-            toobig = TRUE;
-        } else {
-            toobig = FALSE;
-        }
+static void
+logmatch_open(struct logmatchfile *lf)
+{
+    struct stat     sb;
 
-        if ((logmatchTable[iindex].logfile =
-            fopen(logmatchTable[iindex].filename, "r"))) {
+    lf->fd = open(lf->filename, O_RDONLY);
+    if (lf->fd < 0)
+        return;
+#ifdef FD_CLOEXEC
+    fcntl(lf->fd, F_SETFD, FD_CLOEXEC);
+#endif
+    if (fstat(lf->fd, &sb) == 0) {
+        lf->dev = sb.st_dev;
+        lf->ino = sb.st_ino;
+    }
+#ifdef HAVE_SYS_INOTIFY_H
+    logmatch_watch(lf);
+#endif
+}
 
-            result =
-                fseek(logmatchTable[iindex].logfile,
-                      logmatchTable[iindex].currentFilePosition, SEEK_SET);
+/***************************************************************
+*                                                              *
+* logmatch_restore                                             *
+* the first time round, restore each entry's file position     *
+* and counters from its persistent data file                   *
+*                                                              *
+***************************************************************/
 
-            if (result || toobig || (errno == EINVAL)
-                || feof(logmatchTable[iindex].logfile)) {
+static void
+logmatch_restore(struct logmatchfile *lf)
+{
+    struct logmatchstat *lm;
+    char            perfilename[1024];
+    char            lastFilename[256];
+    FILE           *perfile;
+    unsigned long   pos, ccounter, counter;
+    long            first = -1;
 
+    for (lm = lf->entries; lm; lm = lm->nextInFile) {
+        snprintf(perfilename, sizeof(perfilename),
+                 "%s/snmpd_logmatch_%s.pos",
+                 get_persistent_directory(), lm->name);
 
+        pos = counter = ccounter = 0;
+        if ((perfile = fopen(perfilename, "r"))) {
+            if (fscanf(perfile, "%lu %lu %lu %255s",
+                       &pos, &ccounter, &counter, lastFilename) == 4 &&
+                logmatch_update_filename(lf->filenamePattern,
+                                         lastFilename) == 0) {
                 /*
-                 * ------------------------------------ 
-                 * when we are here that means we       
-                 * could't set the file position maybe  
-                 * the file was rotated; let's reset    
-                 * the filepointer, but not the counter 
-                 * ------------------------------------ 
+                 * the filename is still the one stored in the
+                 * persistent data file, so carry on from where it
+                 * was read to last time (if the file is shorter
+                 * now, it will be read from the start)
                  */
+                lm->currentFilePosition = pos;
+                lm->currentMatchCounter = ccounter;
+            } else
+                pos = 0;
+            lm->globalMatchCounter = counter;
+            fclose(perfile);
+        }
+        if (first < 0 || (long) pos < first)
+            first = pos;
+    }
 
+    /*
+     * read on from the first of the entries' positions
+     */
+    lf->position = first < 0 ? 0 : first;
+    lf->virgin = FALSE;
+}
 
-                logmatchTable[iindex].currentFilePosition = 0;
-                logmatchTable[iindex].currentMatchCounter = 0;
-                fseek(logmatchTable[iindex].logfile, 0, SEEK_SET);
-                anyChanges = TRUE;
-            }
-
-            while (fgets
-                   (inbuf, sizeof(inbuf), logmatchTable[iindex].logfile)) {
-
-                matchResultCode =
-                    regexec(&(logmatchTable[iindex].regexBuffer),
-                            inbuf, 0, &myMatch, REG_NOTEOL);
+static void
+logmatch_save(struct logmatchfile *lf)
+{
+    struct logmatchstat *lm;
+    char            perfilename[1024];
+    FILE           *perfile;
 
-                if (matchResultCode == 0) {
-                    logmatchTable[iindex].globalMatchCounter++;
-                    logmatchTable[iindex].currentMatchCounter++;
-                    logmatchTable[iindex].matchCounter++;
-                    anyChanges = TRUE;
-                }
-            }
+    for (lm = lf->entries; lm; lm = lm->nextInFile) {
+        if (lm->currentFilePosition < lf->position)
+            lm->currentFilePosition = lf->position;
 
-            logmatchTable[iindex].currentFilePosition =
-                ftell(logmatchTable[iindex].logfile);
-            fclose(logmatchTable[iindex].logfile);
+        /*
+         * ------------------------------------
+         * we never know if this is the last
+         * time we are being called, so save
+         * the position in a file
+         * ------------------------------------
+         */
+        if (!lm->anyChanges)
+            continue;
+        lm->anyChanges = FALSE;
+
+        snprintf(perfilename, sizeof(perfilename),
+                 "%s/snmpd_logmatch_%s.pos",
+                 get_persistent_directory(), lm->name);
+        if ((perfile = fopen(perfilename, "w"))) {
+            fprintf(perfile, "%lu %lu %lu %s\n",
+                    lm->currentFilePosition,
+                    lm->currentMatchCounter,
+                    lm->globalMatchCounter, lf->filename);
+            fclose(perfile);
         }
     }
+}
 
+/***************************************************************
+*                                                              *
+* updateLogmatch                                               *
+* read what has been added to the file since the last pass,    *
+* following it if it was rotated (replaced by a new file) or   *
+* truncated                                                    *
+*                                                              *
+***************************************************************/
+
+static void
+updateLogmatch(struct logmatchfile *lf)
+{
+    struct logmatchstat *lm;
+    struct stat     sb;
+    time_t          now;
+    long            size = 0;
+    int             replaced = FALSE;
+
+    if (lf->combinedStale)
+        logmatch_compile_combined(lf);
+
+    if (lf->virgin)
+        logmatch_restore(lf);
 
     /*
-     * ------------------------------------ 
-     * at this point we can be safe that    
-     * our current file position is         
-     * straightened out o.k. - we never     
-     * know if this is the last time we are 
-     * being called so save the position    
-     * in a file                            
-     * ------------------------------------ 
+     * the filename can only change from one second to the next
      */
+    now = time(NULL);
+    if (now != lf->filenameChecked) {
+        lf->filenameChecked = now;
+        if (logmatch_update_filename(lf->filenamePattern, lf->filename)) {
+            replaced = TRUE;
+            for (lm = lf->entries; lm; lm = lm->nextInFile)
+                strcpy(lm->filename, lf->filename);
+        }
+    }
 
-    if (anyChanges && (perfile = fopen(perfilename, "w"))) {
-
+    if (lf->fd >= 0 && !replaced &&
+        (stat(lf->filename, &sb) != 0 ||
+         sb.st_dev != lf->dev || sb.st_ino != lf->ino))
+        replaced = TRUE;
 
+    if (lf->fd >= 0 && replaced) {
         /*
-         * ------------------------------------ 
-         * o.k. lets write out our variable     
-         * ------------------------------------ 
+         * a rename (by logrotate, say) is seen before the writer has
+         * been told to reopen its log, so keep reading the old file
+         * for a while rather than losing what is still written to it
+         * (its watch stays until the new file's takes its place)
          */
+        DEBUGMSGTL(("ucd-snmp/logmatch", "%s has been replaced\n",
+                    lf->filename));
+        logmatch_close_old(lf);
+        lf->oldFd = lf->fd;
+        lf->oldPosition = lf->position;
+        lf->oldSince = now;
+        lf->fd = -1;
+        logmatch_reset(lf);
+    } else if (replaced) {
+        logmatch_reset(lf);
+    }
 
-        fprintf(perfile, "%lu %lu %lu %s\n",
-                logmatchTable[iindex].currentFilePosition,
-                logmatchTable[iindex].currentMatchCounter,
-                logmatchTable[iindex].globalMatchCounter,
-                logmatchTable[iindex].filename);
+    if (lf->fd < 0)
+        logmatch_open(lf);
 
-        fclose(perfile);
+    if (lf->fd >= 0 && fstat(lf->fd, &sb) == 0) {
+        size = sb.st_size;
+        if (size < lf->position) {
+            /*
+             * the file was truncated (or is not the one the restored
+             * position was for); read it again from the start
+             */
+            logmatch_reset(lf);
+        }
     }
 
-}
+    /*
+     * the old file is done with once its writer has moved on to the
+     * new one, or has had a cycle time to do so
+     */
+    if (lf->oldFd >= 0) {
+        if (size > 0 || now - lf->oldSince >= SNMP_MAX(lf->frequency, 1))
+            logmatch_close_old(lf);
+        else
+            logmatch_read(lf, lf->oldFd, &lf->oldPosition, FALSE);
+    }
 
+    logmatch_read(lf, lf->fd, &lf->position, FALSE);
+    logmatch_save(lf);
+}
 
 static void
 updateLogmatch_Scheduled(unsigned int registrationNumber,
-                         struct logmatchstat *logmatchtable)
+                         struct logmatchfile *lf)
+{
+    updateLogmatch(lf);
+}
+
+#ifdef HAVE_SYS_INOTIFY_H
+static void
+logmatch_inotify_read(int fd, void *data)
+{
+    union {
+        struct inotify_event ev;
+        char            buf[4096];
+    } events;
+    struct inotify_event *ev;
+    struct logmatchfile *lf;
+    const char     *base;
+    ssize_t         len;
+    char           *cp;
+
+    while ((len = read(fd, events.buf, sizeof(events.buf))) > 0) {
+        for (cp = events.buf; cp < events.buf + len;
+             cp += sizeof(struct inotify_event) + ev->len) {
+            ev = (struct inotify_event *) cp;
+            for (lf = logmatchFiles; lf; lf = lf->next) {
+                if (ev->mask & IN_Q_OVERFLOW) {
+                    lf->dirty = TRUE;
+                } else if (ev->wd == lf->wd) {
+                    if (ev->mask & IN_IGNORED)
+                        lf->wd = -1;
+                    else
+                        lf->dirty = TRUE;
+                } else if (ev->wd == lf->dirWd) {
+                    if (ev->mask & IN_IGNORED) {
+                        lf->dirWd = -1;
+                        continue;
+                    }
+                    base = strrchr(lf->filename, '/');
+                    base = base ? base + 1 : lf->filename;
+                    if (ev->len && !strcmp(ev->name, base))
+                        lf->dirty = TRUE;
+                }
+            }
+        }
+    }
+
+    /*
+     * each file is read once for all the events about it
+     */
+    for (lf = logmatchFiles; lf; lf = lf->next) {
+        if (lf->dirty) {
+            lf->dirty = FALSE;
+            updateLogmatch(lf);
+        }
+    }
+}
+#endif                          /* HAVE_SYS_INOTIFY_H */
+
+/***************************************************************
+*                                                              *
+* logmatch_find_file                                           *
+* the file (shared by all the entries for it) to add an        *
+* entry to                                                     *
+*                                                              *
+***************************************************************/
+
+static struct logmatchfile *
+logmatch_find_file(struct logmatchstat *logmatch)
 {
-    updateLogmatch(logmatchtable->thisIndex);
+    struct logmatchfile *lf, **lfp;
+    struct logmatchstat **lmp;
+
+    for (lf = logmatchFiles; lf; lf = lf->next)
+        if (!strcmp(lf->filenamePattern, logmatch->filenamePattern))
+            break;
+
+    if (!lf) {
+        lf = SNMP_MALLOC_TYPEDEF(struct logmatchfile);
+        if (!lf)
+            return NULL;
+        strcpy(lf->filenamePattern, logmatch->filenamePattern);
+        strcpy(lf->filename, logmatch->filename);
+        lf->fd = -1;
+        lf->oldFd = -1;
+        lf->wd = -1;
+        lf->dirWd = -1;
+        lf->virgin = TRUE;
+        lf->filenameChecked = time(NULL);
+        for (lfp = &logmatchFiles; *lfp; lfp = &(*lfp)->next)
+            ;
+        *lfp = lf;
+    }
+
+    for (lmp = &lf->entries; *lmp; lmp = &(*lmp)->nextInFile)
+        ;
+    *lmp = logmatch;
+    logmatch->nextInFile = NULL;
+    logmatch->file = lf;
+    lf->combinedStale = TRUE;
+
+    /*
+     * the file is read as often as the most frequent of its entries
+     */
+    if (logmatch->frequency > 0 &&
+        (lf->frequency <= 0 || logmatch->frequency < lf->frequency)) {
+        if (lf->alarm)
+            snmp_alarm_unregister(lf->alarm);
+        lf->frequency = logmatch->frequency;
+        lf->alarm = snmp_alarm_register(lf->frequency, SA_REPEAT,
+                                        (SNMPAlarmCallback *)
+                                        updateLogmatch_Scheduled, lf);
+    }
+    return lf;
 }
 
 /***************************************************************
@@ -373,8 +825,8 @@ logmatch_parse_config(const char *token, char *cptr)
         logmatchTable[logmatchCount].globalMatchCounter = 0;
         logmatchTable[logmatchCount].currentMatchCounter = 0;
         logmatchTable[logmatchCount].matchCounter = 0;
-        logmatchTable[logmatchCount].virgin = TRUE;
         logmatchTable[logmatchCount].currentFilePosition = 0;
+        logmatchTable[logmatchCount].anyChanges = FALSE;
 
 
         /*
@@ -437,13 +889,11 @@ logmatch_parse_config(const char *token, char *cptr)
                     logmatchTable[logmatchCount].regEx,
                     REG_EXTENDED | REG_NOSUB);
 
-        if (logmatchTable[logmatchCount].frequency > 0) {
-            snmp_alarm_register(logmatchTable[logmatchCount].frequency,
-                                SA_REPEAT,
-                                (SNMPAlarmCallback *)
-                                updateLogmatch_Scheduled,
-                                &(logmatchTable[logmatchCount])
-                );
+        if (!logmatch_find_file(&logmatchTable[logmatchCount])) {
+            snmp_log(LOG_ERR, "logmatch_parse_config: out of memory\n");
+            if (logmatchTable[logmatchCount].myRegexError == 0)
+                regfree(&(logmatchTable[logmatchCount].regexBuffer));
+            return;
         }
 
         logmatchCount++;
@@ -460,20 +910,42 @@ logmatch_parse_config(const char *token, char *cptr)
 static void
 logmatch_free_config(void)
 {
+    struct logmatchfile *lf;
     int             i;
 
     /*
      * ------------------------------------
-     * the only memory we have allocated
-     * is the memory allocated by regcomp
+     * free the compiled regular expressions,
+     * and close (and stop watching) the files
      * ------------------------------------
      */
 
     for (i = 0; i < logmatchCount; i++) {
-
-        regfree(&(logmatchTable[i].regexBuffer));
+        if (logmatchTable[i].myRegexError == 0)
+            regfree(&(logmatchTable[i].regexBuffer));
     }
     logmatchCount = 0;
+
+    while ((lf = logmatchFiles)) {
+        logmatchFiles = lf->next;
+        if (lf->alarm)
+            snmp_alarm_unregister(lf->alarm);
+        if (lf->combinedCount)
+            regfree(&lf->combinedRegex);
+        if (lf->fd >= 0)
+            close(lf->fd);
+        if (lf->oldFd >= 0)
+            close(lf->oldFd);
+        free(lf);
+    }
+
+#ifdef HAVE_SYS_INOTIFY_H
+    if (logmatchInotifyFd >= 0) {
+        unregister_readfd(logmatchInotifyFd);
+        close(logmatchInotifyFd);
+        logmatchInotifyFd = -1;
+    }
+#endif
 }
 
 
@@ -520,16 +992,18 @@ var_logmatch_table(struct variable *vp,
     }
 
 
+    if (vp->magic == LOGMATCH_INFO) {
+        long_ret = MAXLOGMATCH;
+        return (u_char *) & long_ret;
+    }
+
     iindex = name[*length - 1] - 1;
     logmatch = &logmatchTable[iindex];
 
     if (logmatch->myRegexError == 0)
-        updateLogmatch(iindex);
+        updateLogmatch(logmatch->file);
 
     switch (vp->magic) {
-    case LOGMATCH_INFO:
-        long_ret = MAXLOGMATCH;
-        return (u_char *) & long_ret;
 
     case LOGMATCH_INDEX:
         long_ret = iindex + 1;
@@ -10,10 +10,15 @@
 #else
 #include <strings.h>
 #endif
-
-#include "pass_common.h"
+#if HAVE_NETINET_IN_H
+#include <netinet/in.h>
+#endif
 
 #include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+
+#include "pass_common.h"
+#include "util_funcs.h"
 
 int
 netsnmp_internal_asc2bin(char *p)
@@ -104,3 +109,167 @@ netsnmp_internal_pass_str_to_errno(const char *buf)
 
     return SNMP_ERR_NOERROR;
 }
+
+/*
+ * Convert a helper's answer, the type in buf and the value in buf2, to
+ * the value to return and its type (in vp->type).  The value points at
+ * static storage, or into buf2; NULL if the type isn't known.
+ */
+unsigned char *
+netsnmp_internal_pass_parse(char *buf, char *buf2, size_t *var_len,
+                            struct variable *vp)
+{
+    static long     long_ret;
+    static in_addr_t addr_ret;
+    static oid      objid[MAX_OID_LEN];
+    static struct counter64 c64;
+    int             newlen;
+
+    /*
+     * buf contains the return type, and buf2 contains the data 
+     */
+    if (!strncasecmp(buf, "string", 6)) {
+        buf2[strlen(buf2) - 1] = 0; /* zap the linefeed */
+        *var_len = strlen(buf2);
+        vp->type = ASN_OCTET_STR;
+        return ((unsigned char *) buf2);
+    }
+#ifdef NETSNMP_WITH_OPAQUE_SPECIAL_TYPES
+    else if (!strncasecmp(buf, "integer64", 9)) {
+        uint64_t v64 = strtoull(buf2, NULL, 10);
+        c64.high = (unsigned long)(v64 >> 32);
+        c64.low  = (unsigned long)(v64 & 0xffffffff);
+        *var_len = sizeof(c64);
+        vp->type = ASN_INTEGER64;
+        return ((unsigned char *) &c64);
+    }
+#endif
+    else if (!strncasecmp(buf, "integer", 7)) {
+        *var_len = sizeof(long_ret);
+        long_ret = strtol(buf2, NULL, 10);
+        vp->type = ASN_INTEGER;
+        return ((unsigned char *) &long_ret);
+    } else if (!strncasecmp(buf, "unsigned", 8)) {
+        *var_len = sizeof(long_ret);
+        long_ret = strtoul(buf2, NULL, 10);
+        vp->type = ASN_UNSIGNED;
+        return ((unsigned char *) &long_ret);
+    } else if (!strncasecmp(buf, "counter64", 9)) {
+        uint64_t v64 = strtoull(buf2, NULL, 10);
+        c64.high = (unsigned long)(v64 >> 32);
+        c64.low  = (unsigned long)(v64 & 0xffffffff);
+        *var_len = sizeof(c64);
+        vp->type = ASN_COUNTER64;
+        return ((unsigned char *) &c64);
+    } else if (!strncasecmp(buf, "counter", 7)) {
+        *var_len = sizeof(long_ret);
+        long_ret = strtoul(buf2, NULL, 10);
+        vp->type = ASN_COUNTER;
+        return ((unsigned char *) &long_ret);
+    } else if (!strncasecmp(buf, "octet", 5)) {
+        *var_len = netsnmp_internal_asc2bin(buf2);
+        vp->type = ASN_OCTET_STR;
+        return ((unsigned char *) buf2);
+    } else if (!strncasecmp(buf, "opaque", 6)) {
+        *var_len = netsnmp_internal_asc2bin(buf2);
+        vp->type = ASN_OPAQUE;
+        return ((unsigned char *) buf2);
+    } else if (!strncasecmp(buf, "gauge", 5)) {
+        *var_len = sizeof(long_ret);
+        long_ret = strtoul(buf2, NULL, 10);
+        vp->type = ASN_GAUGE;
+        return ((unsigned char *) &long_ret);
+    } else if (!strncasecmp(buf, "objectid", 8)) {
+        newlen = parse_miboid(buf2, objid);
+        *var_len = newlen * sizeof(oid);
+        vp->type = ASN_OBJECT_ID;
+        return ((unsigned char *) objid);
+    } else if (!strncasecmp(buf, "timetick", 8)) {
+        *var_len = sizeof(long_ret);
+        long_ret = strtoul(buf2, NULL, 10);
+        vp->type = ASN_TIMETICKS;
+        return ((unsigned char *) &long_ret);
+    } else if (!strncasecmp(buf, "ipaddress", 9)) {
+        newlen = parse_miboid(buf2, objid);
+        if (newlen != 4) {
+            snmp_log(LOG_ERR, "invalid ipaddress returned:  %s\n", buf2);
+            *var_len = 0;
+            return (NULL);
+        }
+        addr_ret =
+            (objid[0] << (8 * 3)) + (objid[1] << (8 * 2)) +
+            (objid[2] << 8) + objid[3];
+        addr_ret = htonl(addr_ret);
+        *var_len = sizeof(addr_ret);
+        vp->type = ASN_IPADDRESS;
+        return ((unsigned char *) &addr_ret);
+    }
+    *var_len = 0;
+    return (NULL);
+}
+
+/*
+ * Format a value being SET as "type value\n", for the helper.
+ *
+ * @return the length of the text in buf
+ */
+int
+netsnmp_internal_pass_set_format(char *buf, size_t buf_len,
+                                 u_char *var_val, u_char var_val_type,
+                                 size_t var_val_len)
+{
+    char            buf2[3 * SNMP_MAXBUF];     /* room for the hex */
+    long            tmp;
+    unsigned long   utmp;
+
+    buf[0] = 0;
+    switch (var_val_type) {
+    case ASN_INTEGER:
+    case ASN_COUNTER:
+    case ASN_GAUGE:
+    case ASN_TIMETICKS:
+        tmp = *((long *) var_val);
+        switch (var_val_type) {
+        case ASN_INTEGER:
+            snprintf(buf, buf_len, "integer %d\n", (int) tmp);
+            break;
+        case ASN_COUNTER:
+            snprintf(buf, buf_len, "counter %d\n", (int) tmp);
+            break;
+        case ASN_GAUGE:
+            snprintf(buf, buf_len, "gauge %d\n", (int) tmp);
+            break;
+        case ASN_TIMETICKS:
+            snprintf(buf, buf_len, "timeticks %d\n", (int) tmp);
+            break;
+        }
+        break;
+    case ASN_IPADDRESS:
+        utmp = *((u_long *) var_val);
+        utmp = ntohl(utmp);
+        snprintf(buf, buf_len, "ipaddress %d.%d.%d.%d\n",
+                 (int) ((utmp & 0xff000000) >> (8 * 3)),
+                 (int) ((utmp & 0xff0000) >> (8 * 2)),
+                 (int) ((utmp & 0xff00) >> (8)),
+                 (int) ((utmp & 0xff)));
+        break;
+    case ASN_OCTET_STR:
+        if (var_val_len > SNMP_MAXBUF - 1)
+            var_val_len = SNMP_MAXBUF - 1;
+        memcpy(buf2, var_val, var_val_len);
+        if (var_val_len == 0)
+            snprintf(buf, buf_len, "string \"\"\n");
+        else if (netsnmp_internal_bin2asc(buf2, var_val_len) ==
+                 (int) var_val_len)
+            snprintf(buf, buf_len, "string \"%s\"\n", buf2);
+        else
+            snprintf(buf, buf_len, "octet \"%s\"\n", buf2);
+        break;
+    case ASN_OBJECT_ID:
+        sprint_mib_oid(buf2, (oid *) var_val, var_val_len/sizeof(oid));
+        snprintf(buf, buf_len, "objectid \"%s\"\n", buf2);
+        break;
+    }
+    buf[buf_len - 1] = 0;
+    return strlen(buf);
+}
@@ -9,5 +9,12 @@
 int netsnmp_internal_asc2bin(char *p);
 int netsnmp_internal_bin2asc(char *p, size_t n);
 int netsnmp_internal_pass_str_to_errno(const char *buf);
+unsigned char *netsnmp_internal_pass_parse(char *buf, char *buf2,
+                                           size_t *var_len,
+                                           struct variable *vp);
+int netsnmp_internal_pass_set_format(char *buf, size_t buf_len,
+                                     u_char *var_val,
+                                     u_char var_val_type,
+                                     size_t var_val_len);
 
 #endif /* !NETSNMP_AGENT_MIBGROUP_PASS_COMMON_H */
@@ -5,6 +5,7 @@
 #define _MIBGROUP_PASS_PERSIST_H
 
 config_require(ucd-snmp/pass_common)
+config_require(ucd-snmp/pass_pool)
 config_require(util_funcs)
 config_require(utilities/execute)
 
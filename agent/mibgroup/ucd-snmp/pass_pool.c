@@ -0,0 +1,1092 @@
+/*
+ * pass_pool.c:  subtrees answered by a pool of long running pass helpers.
+ *
+ * The helpers speak the pass_persist protocol, over a pipe pair each.
+ * A request is written to an idle helper and the agent goes back to its
+ * main loop; the answer is collected through register_readfd() and the
+ * varbinds, which were delegated meanwhile, are filled in from it.
+ * Each helper has one request at a time, and the others wait in the
+ * pool's queue.
+ *
+ * A helper may list extensions after its "PONG", which let a GET of
+ * many varbinds, or a GETBULK, be answered in one exchange rather than
+ * one for each varbind (or repetition):
+ *
+ *   getmulti   "getmulti\nN\nOID1\n...OIDN\n" is answered with N
+ *              answers, in order, each as for "get" (three lines, or
+ *              NONE)
+ *   getbulk    "getbulk\nN\nOID\n" is answered with up to N answers,
+ *              each as for "getnext" of the one before, ending early
+ *              with NONE if the helper runs out
+ */
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-features.h>
+
+#if HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#if HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <ctype.h>
+#include <sys/types.h>
+#if HAVE_SYS_WAIT_H
+# include <sys/wait.h>
+#endif
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#include <signal.h>
+#include <errno.h>
+
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+
+#include "struct.h"
+#include "pass_common.h"
+#include "pass_pool.h"
+#include "util_funcs.h"
+
+netsnmp_feature_require(parse_miboid)
+
+/*
+ * the requests that may wait for each helper, before new ones are
+ * turned away
+ */
+#define PASS_POOL_QUEUE         256
+/*
+ * the most varbinds asked for in one getmulti, or repetitions in one
+ * getbulk
+ */
+#define PASS_POOL_MAX_BATCH     100
+/*
+ * how long to wait before starting a helper again, after one failed to
+ * start (in 1/100ths of a second)
+ */
+#define PASS_POOL_RETRY         500
+
+/*
+ * the shape of the answer to a request: a number of answers, each of
+ * three lines (or NONE), or of one line for STATUS
+ */
+#define PASS_ANSWER_STATUS      0x01
+#define PASS_ANSWER_UPTO        0x02    /* NONE ends them all */
+
+/*
+ * the varbinds a request is for (consecutive ones, in the agent's list)
+ */
+struct pass_batch {
+    netsnmp_delegated_cache *cache;
+    int             n;
+    netsnmp_request_info *requests[1];
+};
+
+struct pass_pool_req {
+    char           *text;
+    int             answers;
+    int             flags;
+    struct pass_batch *batch;
+    struct pass_pool_req *next;
+};
+
+#define PASS_WORKER_DOWN        0
+#define PASS_WORKER_STARTING    1       /* waiting for the PONG */
+#define PASS_WORKER_IDLE        2
+#define PASS_WORKER_BUSY        3
+
+struct pass_worker {
+    struct pass_pool *pool;
+    int             state;
+    int             fdIn, fdOut;
+    netsnmp_pid_t   pid;
+    struct pass_pool_req *req;
+    unsigned int    timer;
+
+    /*
+     * the answer so far, where its lines start, and how far through it
+     * we've looked
+     */
+    char           *buf;
+    size_t          len, max, scanned;
+    size_t         *line;
+    int             nlines, lines_max;
+    int             answers, in_answer, done;
+};
+
+#define PASS_POOL_GETMULTI      0x01
+#define PASS_POOL_GETBULK       0x02
+
+struct pass_pool {
+    char           *token;
+    char           *command;
+    oid             miboid[MIBMAX];
+    size_t          miblen;
+    netsnmp_handler_registration *reginfo;
+    int             timeout;
+    int             nworkers;
+    struct pass_worker *workers;
+    int             extensions;         /* as offered in the PONG */
+
+    struct pass_pool_req *head, *tail;
+    int             queued;
+    u_long          retry_after;        /* agent uptime */
+    struct pass_pool *next;
+};
+
+static struct pass_pool *pass_pools = NULL;
+
+static void     _pass_batch_answer(struct pass_batch *b, char **lines,
+                                   int nlines);
+
+static void
+_pass_req_fail(struct pass_pool_req *req)
+{
+    _pass_batch_answer(req->batch, NULL, 0);
+    free(req->text);
+    free(req);
+}
+
+#if HAVE_EXECV && HAVE_FORK
+static void     _pass_pool_dispatch(struct pass_pool *pool);
+static int      _pass_pool_alive(struct pass_pool *pool);
+
+static void
+_pass_worker_reset(struct pass_worker *w)
+{
+    w->len = w->scanned = 0;
+    w->nlines = w->answers = w->in_answer = w->done = 0;
+}
+
+static void
+_pass_worker_stop(struct pass_worker *w)
+{
+    if (w->timer) {
+        snmp_alarm_unregister(w->timer);
+        w->timer = 0;
+    }
+    if (w->fdIn >= 0) {
+        unregister_readfd(w->fdIn);
+        close(w->fdIn);
+        w->fdIn = -1;
+    }
+    if (w->fdOut >= 0) {
+        close(w->fdOut);
+        w->fdOut = -1;
+    }
+    if (w->pid != NETSNMP_NO_SUCH_PROCESS) {
+        kill(w->pid, SIGKILL);
+        waitpid(w->pid, NULL, 0);
+        w->pid = NETSNMP_NO_SUCH_PROCESS;
+    }
+    w->state = PASS_WORKER_DOWN;
+    _pass_worker_reset(w);
+}
+
+/*
+ * the helper is gone, or is no use any more: fail its request, and
+ * start another one if there is work waiting
+ */
+static void
+_pass_worker_failed(struct pass_worker *w, const char *why)
+{
+    struct pass_pool *pool = w->pool;
+    struct pass_pool_req *req = w->req;
+
+    snmp_log(LOG_WARNING, "%s: '%s' (pid %d) %s; it will be restarted\n",
+             pool->token, pool->command, (int) w->pid, why);
+    if (w->state == PASS_WORKER_STARTING)
+        pool->retry_after = netsnmp_get_agent_uptime() + PASS_POOL_RETRY;
+    w->req = NULL;
+    _pass_worker_stop(w);
+    if (req)
+        _pass_req_fail(req);
+    _pass_pool_dispatch(pool);
+
+    /*
+     * if no helper could be started, nothing will take the waiting
+     * requests
+     */
+    if (!_pass_pool_alive(pool)) {
+        while ((req = pool->head)) {
+            pool->head = req->next;
+            _pass_req_fail(req);
+        }
+        pool->tail = NULL;
+        pool->queued = 0;
+    }
+}
+
+static void
+_pass_worker_timeout(unsigned int reg, void *clientarg)
+{
+    struct pass_worker *w = (struct pass_worker *) clientarg;
+    char            why[64];
+
+    w->timer = 0;
+    snprintf(why, sizeof(why), "didn't answer within %d seconds",
+             w->pool->timeout);
+    _pass_worker_failed(w, why);
+}
+
+static int
+_pass_worker_write(struct pass_worker *w, const char *text)
+{
+    size_t          len = strlen(text), done = 0;
+    ssize_t         n;
+
+    /*
+     * SIGPIPE is ignored by the agent, so a helper that has gone away
+     * shows up as EPIPE here
+     */
+    while (done < len) {
+        n = write(w->fdOut, text + done, len - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        done += n;
+    }
+    if (w->pool->timeout > 0)
+        w->timer = snmp_alarm_register(w->pool->timeout, 0,
+                                       _pass_worker_timeout, w);
+    return 0;
+}
+
+/*
+ * look through what has arrived since last time, for the ends of lines
+ * and of answers
+ *
+ * @retval  1 : all of the answer is there
+ * @retval  0 : not yet
+ * @retval -1 : the helper wrote more than the answer
+ */
+static int
+_pass_worker_scan(struct pass_worker *w)
+{
+    int             answers, flags;
+    char           *p, *nl;
+
+    if (w->state == PASS_WORKER_STARTING) {
+        answers = 1;
+        flags = PASS_ANSWER_STATUS;
+    } else {
+        answers = w->req->answers;
+        flags = w->req->flags;
+    }
+
+    while (!w->done &&
+           (nl = memchr(w->buf + w->scanned, '\n', w->len - w->scanned))) {
+        if (w->nlines == w->lines_max) {
+            int             max = w->lines_max ? 2 * w->lines_max : 16;
+            size_t         *line;
+
+            line = (size_t *) realloc(w->line, max * sizeof(size_t));
+            if (!line)
+                return -1;
+            w->line = line;
+            w->lines_max = max;
+        }
+        p = w->buf + w->scanned;
+        w->line[w->nlines++] = w->scanned;
+        w->scanned = nl + 1 - w->buf;
+
+        if (w->in_answer) {
+            if (--w->in_answer == 0)
+                w->answers++;
+        } else if (flags & PASS_ANSWER_STATUS) {
+            w->answers++;
+        } else if (!strncmp(p, "NONE", 4)) {
+            w->answers++;
+            if (flags & PASS_ANSWER_UPTO)
+                w->done = 1;
+        } else
+            w->in_answer = 2;
+        if (w->answers == answers)
+            w->done = 1;
+    }
+    if (!w->done)
+        return 0;
+    return (w->scanned == w->len) ? 1 : -1;
+}
+
+static void
+_pass_worker_read(int fd, void *clientarg)
+{
+    struct pass_worker *w = (struct pass_worker *) clientarg;
+    struct pass_pool *pool = w->pool;
+    struct pass_pool_req *req;
+    char          **lines, *text, *q;
+    size_t          n;
+    ssize_t         got;
+    int             i, nlines, rc;
+
+    if (w->max - w->len < SNMP_MAXBUF) {
+        size_t          max = w->max ? 2 * w->max : 4 * SNMP_MAXBUF;
+        char           *buf = (char *) realloc(w->buf, max);
+
+        if (!buf) {
+            _pass_worker_failed(w, "couldn't be read from");
+            return;
+        }
+        w->buf = buf;
+        w->max = max;
+    }
+    got = read(fd, w->buf + w->len, w->max - w->len);
+    if (got < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+        return;
+    if (got <= 0) {
+        _pass_worker_failed(w, "exited");
+        return;
+    }
+    w->len += got;
+    if (w->state != PASS_WORKER_STARTING && w->state != PASS_WORKER_BUSY) {
+        _pass_worker_failed(w, "wrote when it wasn't asked");
+        return;
+    }
+
+    rc = _pass_worker_scan(w);
+    if (rc == 0) {
+        if (w->len - w->scanned > SNMP_MAXBUF)
+            _pass_worker_failed(w, "answered with too long a line");
+        return;
+    }
+    if (rc < 0) {
+        _pass_worker_failed(w, "answered more than it was asked");
+        return;
+    }
+    if (w->timer) {
+        snmp_alarm_unregister(w->timer);
+        w->timer = 0;
+    }
+
+    if (w->state == PASS_WORKER_STARTING) {
+        if (strncmp(w->buf, "PONG", 4)) {
+            _pass_worker_failed(w, "didn't answer PING");
+            return;
+        }
+        w->buf[w->len - 1] = '\0';
+        pool->extensions = 0;
+        for (q = strtok(w->buf + 4, " \t\r"); q; q = strtok(NULL, " \t\r")) {
+            if (!strcmp(q, "getmulti"))
+                pool->extensions |= PASS_POOL_GETMULTI;
+            else if (!strcmp(q, "getbulk"))
+                pool->extensions |= PASS_POOL_GETBULK;
+        }
+        DEBUGMSGTL(("ucd-snmp/pass_pool", "'%s' (pid %d) is up%s%s\n",
+                    pool->command, (int) w->pid,
+                    (pool->extensions & PASS_POOL_GETMULTI) ?
+                    ", with getmulti" : "",
+                    (pool->extensions & PASS_POOL_GETBULK) ?
+                    ", with getbulk" : ""));
+        _pass_worker_reset(w);
+        w->state = PASS_WORKER_IDLE;
+        _pass_pool_dispatch(pool);
+        return;
+    }
+
+    /*
+     * copy the lines out NUL terminated, so the helper can be given its
+     * next request before the answer is used
+     */
+    nlines = w->nlines;
+    text = (char *) malloc(w->len + nlines);
+    lines = (char **) malloc(nlines * sizeof(char *));
+    if (!text || !lines) {
+        free(text);
+        free(lines);
+        _pass_worker_failed(w, "couldn't be read from");
+        return;
+    }
+    for (i = 0, q = text; i < nlines; i++) {
+        n = ((i + 1 < nlines) ? w->line[i + 1] : w->len) - w->line[i];
+        memcpy(q, w->buf + w->line[i], n);
+        lines[i] = q;
+        q += n;
+        *q++ = '\0';
+    }
+    _pass_worker_reset(w);
+    req = w->req;
+    w->req = NULL;
+    w->state = PASS_WORKER_IDLE;
+    _pass_pool_dispatch(pool);
+
+    _pass_batch_answer(req->batch, lines, nlines);
+    free(req->text);
+    free(req);
+    free(lines);
+    free(text);
+}
+
+static int
+_pass_worker_start(struct pass_worker *w)
+{
+    struct pass_pool *pool = w->pool;
+    int             fdIn, fdOut;
+    netsnmp_pid_t   pid;
+
+    if (!get_exec_pipes(pool->command, &fdIn, &fdOut, &pid) ||
+        pid == NETSNMP_NO_SUCH_PROCESS) {
+        snmp_log(LOG_ERR, "%s: couldn't start '%s'\n", pool->token,
+                 pool->command);
+        pool->retry_after = netsnmp_get_agent_uptime() + PASS_POOL_RETRY;
+        return -1;
+    }
+    DEBUGMSGTL(("ucd-snmp/pass_pool", "started '%s' (pid %d)\n",
+                pool->command, (int) pid));
+    w->pid = pid;
+    w->fdIn = fdIn;
+    w->fdOut = fdOut;
+    _pass_worker_reset(w);
+    w->state = PASS_WORKER_STARTING;
+    fcntl(fdIn, F_SETFL, fcntl(fdIn, F_GETFL) | O_NONBLOCK);
+    if (register_readfd(fdIn, _pass_worker_read, w) != FD_REGISTERED_OK) {
+        _pass_worker_stop(w);
+        return -1;
+    }
+    if (_pass_worker_write(w, "PING\n") < 0) {
+        _pass_worker_stop(w);
+        pool->retry_after = netsnmp_get_agent_uptime() + PASS_POOL_RETRY;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * hand queued requests to idle helpers, and start helpers if there
+ * are more requests than helpers that will soon be able to take them
+ */
+static void
+_pass_pool_dispatch(struct pass_pool *pool)
+{
+    struct pass_worker *w;
+    struct pass_pool_req *req;
+    int             i, starting, running;
+
+    while (pool->head) {
+        starting = running = 0;
+        for (i = 0, w = NULL; i < pool->nworkers; i++) {
+            switch (pool->workers[i].state) {
+            case PASS_WORKER_IDLE:
+                if (!w)
+                    w = &pool->workers[i];
+                break;
+            case PASS_WORKER_STARTING:
+                starting++;
+                break;
+            case PASS_WORKER_BUSY:
+                running++;
+                break;
+            }
+        }
+
+        if (w) {
+            req = pool->head;
+            pool->head = req->next;
+            if (!pool->head)
+                pool->tail = NULL;
+            pool->queued--;
+            req->next = NULL;
+            DEBUGMSGTL(("ucd-snmp/pass_pool", "pid %d: %s", (int) w->pid,
+                        req->text));
+            w->req = req;
+            w->state = PASS_WORKER_BUSY;
+            if (_pass_worker_write(w, req->text) < 0)
+                _pass_worker_failed(w, "couldn't be written to");
+            continue;
+        }
+
+        if (starting < pool->queued &&
+            starting + running < pool->nworkers &&
+            netsnmp_get_agent_uptime() >= pool->retry_after) {
+            for (i = 0; i < pool->nworkers; i++)
+                if (pool->workers[i].state == PASS_WORKER_DOWN)
+                    break;
+            if (_pass_worker_start(&pool->workers[i]) == 0)
+                continue;
+        }
+        break;
+    }
+}
+
+/*
+ * whether any helper is up, or on its way up
+ */
+static int
+_pass_pool_alive(struct pass_pool *pool)
+{
+    int             i;
+
+    for (i = 0; i < pool->nworkers; i++)
+        if (pool->workers[i].state != PASS_WORKER_DOWN)
+            return 1;
+    return 0;
+}
+
+static struct pass_pool *
+_pass_pool_create(const char *token, const char *command, int workers,
+                  int timeout)
+{
+    struct pass_pool *pool;
+    int             i;
+
+    pool = SNMP_MALLOC_STRUCT(pass_pool);
+    if (!pool)
+        return NULL;
+    pool->token = strdup(token);
+    pool->command = strdup(command);
+    pool->workers = (struct pass_worker *)
+        calloc(workers, sizeof(struct pass_worker));
+    if (!pool->token || !pool->command || !pool->workers) {
+        free(pool->token);
+        free(pool->command);
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    pool->nworkers = workers;
+    pool->timeout = timeout;
+    for (i = 0; i < workers; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].fdIn = pool->workers[i].fdOut = -1;
+        pool->workers[i].pid = NETSNMP_NO_SUCH_PROCESS;
+    }
+    return pool;
+}
+
+/*
+ * Queue a request.
+ *
+ * @retval  1 : the batch has been answered already (a helper failed
+ *               with it), and mustn't be touched
+ * @retval  0 : queued; the batch will be answered
+ * @retval -1 : the queue is full
+ * @retval -2 : no helper could be started
+ */
+static int
+_pass_pool_send(struct pass_pool *pool, char *text, int answers, int flags,
+                struct pass_batch *b)
+{
+    struct pass_pool_req *req;
+
+    if (pool->queued >= PASS_POOL_QUEUE * pool->nworkers) {
+        DEBUGMSGTL(("ucd-snmp/pass_pool", "'%s': queue full\n",
+                    pool->command));
+        return -1;
+    }
+    req = SNMP_MALLOC_STRUCT(pass_pool_req);
+    if (!req)
+        return -1;
+    req->text = text;
+    req->answers = answers;
+    req->flags = flags;
+    req->batch = b;
+
+    if (pool->tail)
+        pool->tail->next = req;
+    else
+        pool->head = req;
+    pool->tail = req;
+    pool->queued++;
+    _pass_pool_dispatch(pool);
+    if (_pass_pool_alive(pool))
+        return 0;
+
+    /*
+     * there's no helper to run it.  If it is still queued, take it back
+     * (the queue was emptied when the last helper failed, so it is the
+     * only one there); if not, a helper was given it and failed, and
+     * has answered the batch already
+     */
+    if (pool->head != req)
+        return 1;
+    pool->head = pool->tail = NULL;
+    pool->queued = 0;
+    free(req);
+    return -2;
+}
+
+#else /* !(HAVE_EXECV && HAVE_FORK) */
+
+static void
+_pass_worker_stop(struct pass_worker *w)
+{
+}
+
+static struct pass_pool *
+_pass_pool_create(const char *token, const char *command, int workers,
+                  int timeout)
+{
+    return NULL;
+}
+
+static int
+_pass_pool_send(struct pass_pool *pool, char *text, int answers, int flags,
+                struct pass_batch *b)
+{
+    return -2;
+}
+#endif /* !(HAVE_EXECV && HAVE_FORK) */
+
+/*
+ * stop the helpers, answering (with nothing) any requests still out
+ */
+static void
+_pass_pool_free(struct pass_pool *pool)
+{
+    struct pass_pool_req *req;
+    int             i;
+
+    for (i = 0; i < pool->nworkers; i++) {
+        req = pool->workers[i].req;
+        pool->workers[i].req = NULL;
+        _pass_worker_stop(&pool->workers[i]);
+        if (req)
+            _pass_req_fail(req);
+        free(pool->workers[i].buf);
+        free(pool->workers[i].line);
+    }
+    while ((req = pool->head)) {
+        pool->head = req->next;
+        _pass_req_fail(req);
+    }
+    free(pool->workers);
+    free(pool->command);
+    free(pool->token);
+    free(pool);
+}
+
+/*
+ * parse the answer starting at lines[*i], and step *i past it
+ *
+ * @return the value, or NULL for NONE (or rubbish)
+ */
+static u_char *
+_pass_parse_answer(char **lines, int nlines, int *i, oid *name,
+                   size_t *name_len, u_char *type, size_t *val_len)
+{
+    struct variable vp;
+    u_char         *val;
+    int             len;
+
+    if (*i >= nlines)
+        return NULL;
+    if (!strncmp(lines[*i], "NONE", 4) || *i + 3 > nlines) {
+        (*i)++;
+        return NULL;
+    }
+    len = parse_miboid(lines[*i], name);
+    val = netsnmp_internal_pass_parse(lines[*i + 1], lines[*i + 2],
+                                      val_len, &vp);
+    *i += 3;
+    if (len <= 0 || !val)
+        return NULL;
+    *name_len = len;
+    *type = vp.type;
+    return val;
+}
+
+/*
+ * whether a getnext answer is one the agent can use: inside our
+ * subtree, and beyond what was asked for
+ */
+static int
+_pass_next_ok(struct pass_pool *pool, netsnmp_variable_list *var,
+              oid *name, size_t name_len)
+{
+    return snmp_oidtree_compare(name, name_len, pool->miboid,
+                                pool->miblen) == 0 &&
+        snmp_oid_compare(name, name_len, var->name, var->name_length) > 0;
+}
+
+/*
+ * fill in the varbinds of a batch from the helper's answer (or as best
+ * we can without one, if nlines is 0)
+ */
+static void
+_pass_batch_answer(struct pass_batch *b, char **lines, int nlines)
+{
+    netsnmp_delegated_cache *cache;
+    netsnmp_request_info *request, *next;
+    netsnmp_variable_list *var;
+    struct pass_pool *pool;
+    oid             name[MAX_OID_LEN];
+    size_t          name_len, val_len;
+    u_char          type, *val;
+    int             i, l = 0;
+
+    cache = netsnmp_handler_check_cache(b->cache);
+    if (!cache) {
+        DEBUGMSGTL(("ucd-snmp/pass_pool", "pass request no longer valid\n"));
+        netsnmp_free_delegated_cache(b->cache);
+        free(b);
+        return;
+    }
+    pool = (struct pass_pool *) cache->localinfo;
+    for (i = 0; i < b->n; i++)
+        b->requests[i]->delegated = 0;
+    request = b->requests[0];
+
+    switch (cache->reqinfo->mode) {
+#ifndef NETSNMP_NO_WRITE_SUPPORT
+    case MODE_SET_ACTION:
+        i = nlines ? netsnmp_internal_pass_str_to_errno(lines[0])
+            : SNMP_ERR_NOTWRITABLE;
+        DEBUGMSGTL(("ucd-snmp/pass_pool", "set returned: %s",
+                    nlines ? lines[0] : "nothing\n"));
+        if (i != SNMP_ERR_NOERROR)
+            netsnmp_set_request_error(cache->reqinfo, request, i);
+        break;
+#endif /* !NETSNMP_NO_WRITE_SUPPORT */
+
+    case MODE_GET:
+        /*
+         * a varbind without an answer is left for the agent to turn
+         * into noSuchObject, as for a plain pass
+         */
+        for (i = 0; i < b->n; i++) {
+            val = _pass_parse_answer(lines, nlines, &l, name, &name_len,
+                                     &type, &val_len);
+            if (val)
+                snmp_set_var_typed_value(b->requests[i]->requestvb, type,
+                                         val, val_len);
+        }
+        break;
+
+    case MODE_GETNEXT:
+    case MODE_GETBULK:
+        /*
+         * without a usable answer, the agent goes on to the next
+         * subtree
+         */
+        var = request->requestvb;
+        val = _pass_parse_answer(lines, nlines, &l, name, &name_len,
+                                 &type, &val_len);
+        if (!val || !_pass_next_ok(pool, var, name, name_len)) {
+            snmp_set_var_typed_value(var, ASN_NULL, NULL, 0);
+            if (cache->reqinfo->mode == MODE_GETNEXT)
+                break;
+        } else {
+            snmp_set_var_objid(var, name, name_len);
+            snmp_set_var_typed_value(var, type, val, val_len);
+            if (cache->reqinfo->mode == MODE_GETNEXT)
+                break;
+
+            /*
+             * the rest of a getbulk answer goes in the following
+             * repetitions, for as long as it stays short of the next
+             * subtree
+             */
+            while (request->repeat > 0 && var->next_variable &&
+                   (val = _pass_parse_answer(lines, nlines, &l, name,
+                                             &name_len, &type, &val_len)) &&
+                   _pass_next_ok(pool, var, name, name_len) &&
+                   (!request->range_end_len ||
+                    snmp_oid_compare(name, name_len, request->range_end,
+                                     request->range_end_len) < 0)) {
+                request->repeat--;
+                var = request->requestvb = var->next_variable;
+                if (2 == request->inclusive)
+                    request->inclusive = 0;
+                snmp_set_var_objid(var, name, name_len);
+                snmp_set_var_typed_value(var, type, val, val_len);
+            }
+        }
+
+        /*
+         * and the agent asks again, from the last answer, for any
+         * repetitions still wanted
+         */
+        next = request->next;
+        request->next = NULL;
+        netsnmp_bulk_to_next_fix_requests(request);
+        request->next = next;
+        break;
+    }
+
+    netsnmp_free_delegated_cache(cache);
+    free(b);
+}
+
+/*
+ * delegate the next n varbinds (that haven't been answered already)
+ * from *requests, and step *requests past them
+ */
+static struct pass_batch *
+_pass_batch_create(netsnmp_mib_handler *handler,
+                   netsnmp_handler_registration *reginfo,
+                   netsnmp_agent_request_info *reqinfo,
+                   netsnmp_request_info **requests, int n)
+{
+    netsnmp_request_info *request;
+    struct pass_batch *b;
+    int             i;
+
+    b = (struct pass_batch *)
+        malloc(sizeof(*b) + (n - 1) * sizeof(netsnmp_request_info *));
+    for (i = 0, request = *requests; i < n; request = request->next) {
+        if (request->processed)
+            continue;
+        if (b)
+            b->requests[i] = request;
+        else
+            netsnmp_set_request_error(reqinfo, request, SNMP_ERR_GENERR);
+        i++;
+    }
+    *requests = request;
+    if (!b)
+        return NULL;
+    b->n = n;
+
+    b->cache = netsnmp_create_delegated_cache(handler, reginfo, reqinfo,
+                                              b->requests[0],
+                                              handler->myvoid);
+    if (!b->cache) {
+        for (i = 0; i < n; i++)
+            netsnmp_set_request_error(reqinfo, b->requests[i],
+                                      SNMP_ERR_GENERR);
+        free(b);
+        return NULL;
+    }
+    for (i = 0; i < n; i++)
+        b->requests[i]->delegated = 1;
+    return b;
+}
+
+/*
+ * the request to the helper for a batch
+ */
+static char *
+_pass_batch_text(struct pass_pool *pool, int mode, struct pass_batch *b,
+                 int *answers, int *flags)
+{
+    char            line[2 * SNMP_MAXBUF], oidbuf[SNMP_MAXBUF];
+    u_char         *text = NULL;
+    size_t          text_len = 0, out_len = 0;
+    netsnmp_variable_list *var;
+    int             i, ok = 1;
+
+    *answers = b->n;
+    *flags = 0;
+    if (b->n > 1) {
+        snprintf(line, sizeof(line), "getmulti\n%d\n", b->n);
+        ok = snmp_cstrcat(&text, &text_len, &out_len, 1, line);
+    }
+    for (i = 0; ok && i < b->n; i++) {
+        var = b->requests[i]->requestvb;
+        if (pool->miblen >= var->name_length ||
+            snmp_oidtree_compare(var->name, var->name_length,
+                                 pool->miboid, pool->miblen) < 0)
+            sprint_mib_oid(oidbuf, pool->miboid, pool->miblen);
+        else
+            sprint_mib_oid(oidbuf, var->name, var->name_length);
+
+        switch (mode) {
+        case MODE_GET:
+            snprintf(line, sizeof(line), "%s%s\n",
+                     (b->n > 1) ? "" : "get\n", oidbuf);
+            break;
+        case MODE_GETBULK:
+            if (pool->extensions & PASS_POOL_GETBULK) {
+                *answers = SNMP_MIN(b->requests[i]->repeat + 1,
+                                    PASS_POOL_MAX_BATCH);
+                *flags = PASS_ANSWER_UPTO;
+                snprintf(line, sizeof(line), "getbulk\n%d\n%s\n",
+                         *answers, oidbuf);
+                break;
+            }
+            /* FALL THROUGH */
+        case MODE_GETNEXT:
+            snprintf(line, sizeof(line), "getnext\n%s\n", oidbuf);
+            break;
+#ifndef NETSNMP_NO_WRITE_SUPPORT
+        case MODE_SET_ACTION:
+            snprintf(line, sizeof(line), "set\n%s\n", oidbuf);
+            netsnmp_internal_pass_set_format(line + strlen(line),
+                                             sizeof(line) - strlen(line),
+                                             var->val.string, var->type,
+                                             var->val_len);
+            *flags = PASS_ANSWER_STATUS;
+            break;
+#endif /* !NETSNMP_NO_WRITE_SUPPORT */
+        }
+        ok = snmp_cstrcat(&text, &text_len, &out_len, 1, line);
+    }
+    if (!ok) {
+        SNMP_FREE(text);
+        return NULL;
+    }
+    return (char *) text;
+}
+
+static void
+_pass_batch_send(struct pass_pool *pool,
+                 netsnmp_agent_request_info *reqinfo, struct pass_batch *b)
+{
+    char           *text;
+    int             i, answers, flags, rc = -1;
+
+    text = _pass_batch_text(pool, reqinfo->mode, b, &answers, &flags);
+    if (text) {
+        rc = _pass_pool_send(pool, text, answers, flags, b);
+        if (rc >= 0)
+            return;
+        free(text);
+    }
+
+    /*
+     * a getnext goes on past a helper that can't be run, as for a
+     * plain pass; but a full queue is an error, rather than a silent
+     * gap in a walk
+     */
+    for (i = 0; i < b->n; i++) {
+        b->requests[i]->delegated = 0;
+        if (rc == -1 || (reqinfo->mode != MODE_GETNEXT &&
+                         reqinfo->mode != MODE_GETBULK))
+            netsnmp_set_request_error(reqinfo, b->requests[i],
+                                      SNMP_ERR_GENERR);
+    }
+    netsnmp_free_delegated_cache(b->cache);
+    free(b);
+}
+
+static int
+_pass_pool_handler(netsnmp_mib_handler *handler,
+                   netsnmp_handler_registration *reginfo,
+                   netsnmp_agent_request_info *reqinfo,
+                   netsnmp_request_info *requests)
+{
+    struct pass_pool *pool = (struct pass_pool *) handler->myvoid;
+    netsnmp_request_info *request;
+    struct pass_batch *b;
+    int             count, chunk, n;
+
+    switch (reqinfo->mode) {
+    case MODE_GET:
+    case MODE_GETNEXT:
+    case MODE_GETBULK:
+#ifndef NETSNMP_NO_WRITE_SUPPORT
+    case MODE_SET_ACTION:
+#endif /* !NETSNMP_NO_WRITE_SUPPORT */
+        break;
+    default:
+        return SNMP_ERR_NOERROR;
+    }
+
+    for (count = 0, request = requests; request; request = request->next)
+        if (!request->processed)
+            count++;
+
+    /*
+     * the varbinds of a GET are shared out between the helpers in a
+     * getmulti each, if they have it; otherwise each varbind is a
+     * request of its own, so they can be answered by different helpers
+     * at once
+     */
+    chunk = 1;
+    if (reqinfo->mode == MODE_GET &&
+        (pool->extensions & PASS_POOL_GETMULTI)) {
+        chunk = (count + pool->nworkers - 1) / pool->nworkers;
+        if (chunk > PASS_POOL_MAX_BATCH)
+            chunk = PASS_POOL_MAX_BATCH;
+    }
+
+    for (request = requests; count > 0; count -= n) {
+        n = SNMP_MIN(chunk, count);
+        b = _pass_batch_create(handler, reginfo, reqinfo, &request, n);
+        if (b)
+            _pass_batch_send(pool, reqinfo, b);
+    }
+    return SNMP_ERR_NOERROR;
+}
+
+void
+netsnmp_pass_pool_parse_config(const char *token, char *cptr,
+                               long priority, int workers, int timeout)
+{
+    struct pass_pool *pool, **pp;
+    netsnmp_handler_registration *reginfo;
+    oid             miboid[MIBMAX];
+    size_t          miblen;
+    char            command[STRMAX];
+    char           *tcptr;
+
+    /*
+     * MIB
+     */
+    if (*cptr == '.')
+        cptr++;
+    if (!isdigit((unsigned char)(*cptr))) {
+        config_perror("second token is not a OID");
+        return;
+    }
+    miblen = parse_miboid(cptr, miboid);
+    while (isdigit((unsigned char)(*cptr)) || *cptr == '.')
+        cptr++;
+
+    /*
+     * path
+     */
+    cptr = skip_white(cptr);
+    if (cptr == NULL) {
+        config_perror("No command specified on pass line");
+        return;
+    }
+    for (tcptr = cptr; *tcptr != 0 && *tcptr != '#' && *tcptr != ';';
+         tcptr++);
+    if (tcptr - cptr >= (int) sizeof(command))
+        tcptr = cptr + sizeof(command) - 1;
+    memcpy(command, cptr, tcptr - cptr);
+    command[tcptr - cptr] = 0;
+
+    pool = _pass_pool_create(token, command, workers, timeout);
+    if (!pool) {
+        config_perror("pass helper pools are not supported here");
+        return;
+    }
+    memcpy(pool->miboid, miboid, miblen * sizeof(oid));
+    pool->miblen = miblen;
+
+    reginfo = netsnmp_create_handler_registration(token, _pass_pool_handler,
+                                                  miboid, miblen,
+                                                  HANDLER_CAN_RWRITE |
+                                                  HANDLER_CAN_GETBULK);
+    if (!reginfo) {
+        _pass_pool_free(pool);
+        return;
+    }
+    reginfo->priority = priority;
+    reginfo->handler->myvoid = pool;
+    if (netsnmp_register_handler(reginfo) != MIB_REGISTERED_OK) {
+        config_perror("couldn't register the pass subtree");
+        _pass_pool_free(pool);
+        return;
+    }
+    pool->reginfo = reginfo;
+
+    for (pp = &pass_pools; *pp; pp = &(*pp)->next)
+        ;
+    *pp = pool;
+}
+
+void
+netsnmp_pass_pool_free_config(const char *token)
+{
+    struct pass_pool *pool, **pp;
+    netsnmp_handler_registration *reginfo;
+
+    for (pp = &pass_pools; (pool = *pp); ) {
+        if (strcmp(pool->token, token)) {
+            pp = &pool->next;
+            continue;
+        }
+        *pp = pool->next;
+        reginfo = pool->reginfo;
+        _pass_pool_free(pool);
+        netsnmp_unregister_handler(reginfo);
+    }
+}
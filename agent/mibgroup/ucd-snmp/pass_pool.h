@@ -0,0 +1,38 @@
+#ifndef NETSNMP_AGENT_MIBGROUP_PASS_POOL_H
+#define NETSNMP_AGENT_MIBGROUP_PASS_POOL_H
+
+/*
+ * This is an internal header file. The functions declared here might change
+ * or disappear at any time
+ */
+
+config_require(util_funcs)
+
+/*
+ * Subtrees answered by a pool of long running pass helpers, which are fed
+ * their requests with the pass_persist protocol ("PING", "get", "getnext",
+ * "set", and "getmulti" and "getbulk" if the helper offers them) without
+ * the agent waiting for the answers.
+ *
+ * Helpers are started when there is work for them, and started again if
+ * they exit.  A helper that doesn't answer within the timeout is killed.
+ * Requests wait for a free helper in a queue of limited length.
+ */
+#define PASS_POOL_MAX_WORKERS   64
+#define PASS_POOL_TIMEOUT       5
+
+/*
+ * Register the subtree of a "pass -w" or "pass_persist -w" line (cptr
+ * being what follows the options: the OID and the command).
+ */
+void netsnmp_pass_pool_parse_config(const char *token, char *cptr,
+                                    long priority, int workers,
+                                    int timeout);
+
+/*
+ * Unregister the subtrees registered for token, and stop their helpers.
+ * Any requests still out are answered (with nothing) first.
+ */
+void netsnmp_pass_pool_free_config(const char *token);
+
+#endif /* !NETSNMP_AGENT_MIBGROUP_PASS_POOL_H */
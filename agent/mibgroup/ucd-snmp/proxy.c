@@ -22,12 +22,41 @@
 #include <net-snmp/net-snmp-includes.h>
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 
+#include <net-snmp/agent/table_iterator.h>
+
 #include "proxy.h"
 
 netsnmp_feature_require(handler_mark_requests_as_delegated)
 netsnmp_feature_require(request_set_error_idx)
 
 static struct simple_proxy *proxies = NULL;
+static u_long   proxy_count = 0;
+
+/*
+ * A request sent to a proxied agent, and the requests of ours waiting
+ * for its answer: one, or more if identical GETs (or GETNEXTs) came in
+ * while it was outstanding.  With -Ct, the answer is kept for a while
+ * afterwards, for any more of them.
+ */
+struct proxy_request {
+    struct simple_proxy *sp;
+    int             session;            /* index into sp->sessions */
+    int             mode;
+    netsnmp_variable_list *vars;        /* as sent, for GET and GETNEXT */
+    u_char         *community;
+    size_t          community_len;
+    netsnmp_delegated_cache **waiters;
+    int             nwaiters, max_waiters;
+    netsnmp_pdu    *response;
+    u_long          answered;           /* agent uptime */
+    struct proxy_request *next;
+};
+
+/*
+ * the most answers kept for each proxy line
+ */
+#define PROXY_MAX_ANSWERS 256
+#define PROXY_MAX_SESSIONS 64
 
 oid             testoid[] = { 1, 3, 6, 1, 4, 1, 2021, 8888, 1 };
 
@@ -37,6 +66,8 @@ oid             testoid[] = { 1, 3, 6, 1, 4, 1, 2021, 8888, 1 };
 #define MAX_ARGS 128
 
 char           *context_string;
+static int      proxy_nsessions;
+static u_long   proxy_ttl;
 
 static void
 proxyOptProc(int argc, char *const *argv, int opt)
@@ -57,6 +88,27 @@ proxyOptProc(int argc, char *const *argv, int opt)
                 netsnmp_ds_set_boolean(NETSNMP_DS_LIBRARY_ID,
                                        NETSNMP_DS_LIB_IGNORE_NO_COMMUNITY, 1);
                 break;
+            case 's':
+                optind++;
+                if (optind < argc) {
+                    proxy_nsessions = atoi(argv[optind - 1]);
+                    if (proxy_nsessions < 1 ||
+                        proxy_nsessions > PROXY_MAX_SESSIONS) {
+                        config_perror("number of sessions out of range");
+                        proxy_nsessions = 1;
+                    }
+                } else {
+                    config_perror("No number of sessions passed to -Cs");
+                }
+                break;
+            case 't':
+                optind++;
+                if (optind < argc) {
+                    proxy_ttl = (u_long) (atof(argv[optind - 1]) * 100);
+                } else {
+                    config_perror("No time to keep answers passed to -Ct");
+                }
+                break;
             default:
                 config_perror("unknown argument passed to -C");
                 break;
@@ -71,6 +123,165 @@ proxyOptProc(int argc, char *const *argv, int opt)
     }
 }
 
+static int      proxy_answer(int operation, struct simple_proxy *sp,
+                             netsnmp_agent_request_info *reqinfo,
+                             netsnmp_request_info *requests,
+                             netsnmp_pdu *pdu);
+
+static void
+proxy_request_free(struct proxy_request *preq)
+{
+    if (preq->vars)
+        snmp_free_varbind(preq->vars);
+    if (preq->response)
+        snmp_free_pdu(preq->response);
+    SNMP_FREE(preq->community);
+    SNMP_FREE(preq->waiters);
+    free(preq);
+}
+
+static void
+proxy_free_answers(struct proxy_request **answers)
+{
+    struct proxy_request *preq;
+
+    while ((preq = *answers)) {
+        *answers = preq->next;
+        proxy_request_free(preq);
+    }
+}
+
+/*
+ * forget the answers that are too old to use (which, with the newest
+ * first, are all those after the first one that is), or too many
+ */
+static void
+proxy_expire_answers(struct simple_proxy *sp)
+{
+    struct proxy_request **pp;
+    u_long          now = netsnmp_get_agent_uptime();
+    int             n = 0;
+
+    for (pp = &sp->answers; *pp; pp = &(*pp)->next)
+        if (now - (*pp)->answered >= sp->ttl || ++n > PROXY_MAX_ANSWERS)
+            break;
+    proxy_free_answers(pp);
+}
+
+/*
+ * whether a request would be sent exactly as preq was
+ */
+static int
+proxy_request_matches(struct proxy_request *preq, int mode,
+                      netsnmp_variable_list *vars,
+                      netsnmp_session *session)
+{
+    netsnmp_variable_list *a, *b;
+
+    if (preq->mode != mode || preq->community_len != session->community_len)
+        return 0;
+    if (preq->community_len &&
+        memcmp(preq->community, session->community, preq->community_len))
+        return 0;
+    for (a = preq->vars, b = vars; a && b;
+         a = a->next_variable, b = b->next_variable)
+        if (snmp_oid_compare(a->name, a->name_length,
+                             b->name, b->name_length))
+            return 0;
+    return a == b;
+}
+
+/*
+ * an answer to this request kept from a moment ago, or one on its way
+ */
+static struct proxy_request *
+proxy_find_request(struct simple_proxy *sp, int mode,
+                   netsnmp_variable_list *vars, netsnmp_session *session)
+{
+    struct proxy_request *preq;
+
+    if (sp->ttl) {
+        proxy_expire_answers(sp);
+        for (preq = sp->answers; preq; preq = preq->next)
+            if (proxy_request_matches(preq, mode, vars, session))
+                return preq;
+    }
+    for (preq = sp->inflight; preq; preq = preq->next)
+        if (proxy_request_matches(preq, mode, vars, session))
+            return preq;
+    return NULL;
+}
+
+static int
+proxy_request_add_waiter(struct proxy_request *preq,
+                         netsnmp_delegated_cache *cache)
+{
+    if (preq->nwaiters == preq->max_waiters) {
+        int             max = preq->max_waiters ? 2 * preq->max_waiters : 4;
+        netsnmp_delegated_cache **w;
+
+        w = (netsnmp_delegated_cache **)
+            realloc(preq->waiters, max * sizeof(netsnmp_delegated_cache *));
+        if (!w)
+            return -1;
+        preq->waiters = w;
+        preq->max_waiters = max;
+    }
+    preq->waiters[preq->nwaiters++] = cache;
+    return 0;
+}
+
+/*
+ * the session with the fewest requests outstanding
+ */
+static int
+proxy_pick_session(struct simple_proxy *sp)
+{
+    int             i, best = 0;
+
+    for (i = 1; i < sp->nsessions; i++)
+        if (sp->outstanding[i] < sp->outstanding[best])
+            best = i;
+    return best;
+}
+
+/*
+ * the answer from the proxied agent, for each request waiting for it
+ */
+static int
+proxy_got_responses(int operation, netsnmp_session * sess, int reqid,
+                    netsnmp_pdu *pdu, void *cb_data)
+{
+    struct proxy_request *preq = (struct proxy_request *) cb_data;
+    struct proxy_request **pp;
+    struct simple_proxy *sp = preq->sp;
+    int             i;
+
+    for (pp = &sp->inflight; *pp; pp = &(*pp)->next)
+        if (*pp == preq) {
+            *pp = preq->next;
+            break;
+        }
+    sp->outstanding[preq->session]--;
+
+    DEBUGMSGTL(("proxy", "answer for %d request(s)\n", preq->nwaiters));
+    for (i = 0; i < preq->nwaiters; i++)
+        proxy_got_response(operation, sess, reqid, pdu, preq->waiters[i]);
+
+    if (sp->ttl && preq->vars &&
+        operation == NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE &&
+        pdu->errstat == SNMP_ERR_NOERROR &&
+        (preq->response = snmp_clone_pdu(pdu)) != NULL) {
+        preq->answered = netsnmp_get_agent_uptime();
+        preq->nwaiters = 0;
+        preq->next = sp->answers;
+        sp->answers = preq;
+        proxy_expire_answers(sp);
+    } else
+        proxy_request_free(preq);
+    return 1;
+}
+
 void
 proxy_parse_config(const char *token, char *line)
 {
@@ -81,11 +292,13 @@ proxy_parse_config(const char *token, char *line)
     netsnmp_session session, *ss;
     struct simple_proxy *newp, **listpp;
     char            args[MAX_ARGS][SPRINT_MAX_LEN], *argv[MAX_ARGS];
-    int             argn, arg;
+    int             argn, arg, i;
     char           *cp;
     netsnmp_handler_registration *reg;
 
     context_string = NULL;
+    proxy_nsessions = 1;
+    proxy_ttl = 0;
 
     DEBUGMSGTL(("proxy_config", "entering\n"));
 
@@ -152,6 +365,28 @@ proxy_parse_config(const char *token, char *line)
     newp = (struct simple_proxy *) calloc(1, sizeof(struct simple_proxy));
 
     newp->sess = ss;
+    newp->sessions = (netsnmp_session **)
+        calloc(proxy_nsessions, sizeof(netsnmp_session *));
+    newp->outstanding = (int *) calloc(proxy_nsessions, sizeof(int));
+    if (!newp->sessions || !newp->outstanding) {
+        snmp_close(ss);
+        SNMP_FREE(newp->sessions);
+        SNMP_FREE(newp->outstanding);
+        free(newp);
+        return;
+    }
+    newp->sessions[0] = ss;
+    for (i = 1; i < proxy_nsessions; i++) {
+        newp->sessions[i] = snmp_open(&session);
+        if (!newp->sessions[i]) {
+            snmp_sess_perror("proxy", &session);
+            break;
+        }
+    }
+    newp->nsessions = i;
+    newp->ttl = proxy_ttl;
+    newp->index = ++proxy_count;
+
     DEBUGMSGTL(("proxy_init", "name = %s\n", args[arg]));
     newp->name_len = MAX_OID_LEN;
     if (!snmp_parse_oid(args[arg++], newp->name, &newp->name_len)) {
@@ -219,6 +454,7 @@ void
 proxy_free_config(void)
 {
     struct simple_proxy *rm;
+    int             i;
 
     DEBUGMSGTL(("proxy_free_config", "Free config\n"));
     while (proxies) {
@@ -231,11 +467,20 @@ proxy_free_config(void)
         unregister_mib_context(rm->name, rm->name_len,
                                DEFAULT_MIB_PRIORITY, 0, 0,
                                rm->context);
+        /*
+         * closing the sessions answers (with a timeout) anything still
+         * outstanding
+         */
+        for (i = 0; i < rm->nsessions; i++)
+            snmp_close(rm->sessions[i]);
+        proxy_free_answers(&rm->answers);
+        SNMP_FREE(rm->sessions);
+        SNMP_FREE(rm->outstanding);
         SNMP_FREE(rm->variables);
         SNMP_FREE(rm->context);
-        snmp_close(rm->sess);
         SNMP_FREE(rm);
     }
+    proxy_count = 0;
 }
 
 /*
@@ -247,16 +492,8 @@ proxy_free_config(void)
 int
 proxy_fill_in_session(netsnmp_mib_handler *handler,
                       netsnmp_agent_request_info *reqinfo,
-                      void **configured)
+                      netsnmp_session *session, void **configured)
 {
-    netsnmp_session *session;
-    struct simple_proxy *sp;
-
-    sp = (struct simple_proxy *) handler->myvoid;
-    if (!sp) {
-        return 0;
-    }
-    session = sp->sess;
     if (!session) {
         return 0;
     }
@@ -323,12 +560,132 @@ proxy_free_filled_in_session_args(netsnmp_session *session, void **configured)
     *configured = NULL;
 }
 
+/*
+ * NET-SNMP-AGENT-MIB::nsProxyTable, a row for each proxy line
+ */
+#define COLUMN_NSPROXYCONTEXTNAME       2
+#define COLUMN_NSPROXYREGISTRATIONPOINT 3
+#define COLUMN_NSPROXYREQUESTS          4
+#define COLUMN_NSPROXYCOALESCED         5
+#define COLUMN_NSPROXYCACHEHITS         6
+
+static netsnmp_variable_list *
+nsProxyTable_get_next_data_point(void **my_loop_context,
+                                 void **my_data_context,
+                                 netsnmp_variable_list *put_index_data,
+                                 netsnmp_iterator_info *mydata)
+{
+    struct simple_proxy *sp = (struct simple_proxy *) *my_loop_context;
+
+    if (!sp)
+        return NULL;
+    snmp_set_var_typed_integer(put_index_data, ASN_UNSIGNED, sp->index);
+    *my_data_context = sp;
+    *my_loop_context = sp->next;
+    return put_index_data;
+}
+
+static netsnmp_variable_list *
+nsProxyTable_get_first_data_point(void **my_loop_context,
+                                  void **my_data_context,
+                                  netsnmp_variable_list *put_index_data,
+                                  netsnmp_iterator_info *mydata)
+{
+    *my_loop_context = proxies;
+    return nsProxyTable_get_next_data_point(my_loop_context, my_data_context,
+                                            put_index_data, mydata);
+}
+
+static int
+nsProxyTable_handler(netsnmp_mib_handler *handler,
+                     netsnmp_handler_registration *reginfo,
+                     netsnmp_agent_request_info *reqinfo,
+                     netsnmp_request_info *requests)
+{
+    netsnmp_request_info *request;
+    netsnmp_table_request_info *table_info;
+    netsnmp_variable_list *var;
+    struct simple_proxy *sp;
+
+    if (reqinfo->mode != MODE_GET)
+        return SNMP_ERR_NOERROR;
+
+    for (request = requests; request; request = request->next) {
+        if (request->processed)
+            continue;
+        var = request->requestvb;
+        sp = (struct simple_proxy *) netsnmp_extract_iterator_context(request);
+        table_info = netsnmp_extract_table_info(request);
+        if (!sp || !table_info) {
+            netsnmp_set_request_error(reqinfo, request, SNMP_NOSUCHINSTANCE);
+            continue;
+        }
+
+        switch (table_info->colnum) {
+        case COLUMN_NSPROXYCONTEXTNAME:
+            snmp_set_var_typed_value(var, ASN_OCTET_STR, sp->context,
+                                     sp->context ? strlen(sp->context) : 0);
+            break;
+        case COLUMN_NSPROXYREGISTRATIONPOINT:
+            snmp_set_var_typed_value(var, ASN_OBJECT_ID, sp->name,
+                                     sp->name_len * sizeof(oid));
+            break;
+        case COLUMN_NSPROXYREQUESTS:
+            snmp_set_var_typed_integer(var, ASN_COUNTER, sp->sent);
+            break;
+        case COLUMN_NSPROXYCOALESCED:
+            snmp_set_var_typed_integer(var, ASN_COUNTER, sp->coalesced);
+            break;
+        case COLUMN_NSPROXYCACHEHITS:
+            snmp_set_var_typed_integer(var, ASN_COUNTER, sp->cache_hits);
+            break;
+        default:
+            netsnmp_set_request_error(reqinfo, request, SNMP_NOSUCHOBJECT);
+            break;
+        }
+    }
+    return SNMP_ERR_NOERROR;
+}
+
+static void
+register_nsProxyTable(void)
+{
+    const oid       nsProxyTable_oid[] = { 1, 3, 6, 1, 4, 1, 8072, 1, 8, 2 };
+    netsnmp_table_registration_info *table_info;
+    netsnmp_handler_registration *reg;
+    netsnmp_iterator_info *iinfo;
+
+    table_info = SNMP_MALLOC_TYPEDEF(netsnmp_table_registration_info);
+    iinfo = SNMP_MALLOC_TYPEDEF(netsnmp_iterator_info);
+    reg = netsnmp_create_handler_registration("nsProxyTable",
+                                              nsProxyTable_handler,
+                                              nsProxyTable_oid,
+                                              OID_LENGTH(nsProxyTable_oid),
+                                              HANDLER_CAN_RONLY);
+    if (!reg || !table_info || !iinfo) {
+        if (reg)
+            netsnmp_handler_registration_free(reg);
+        SNMP_FREE(table_info);
+        SNMP_FREE(iinfo);
+        return;
+    }
+
+    netsnmp_table_helper_add_index(table_info, ASN_UNSIGNED);
+    table_info->min_column = COLUMN_NSPROXYCONTEXTNAME;
+    table_info->max_column = COLUMN_NSPROXYCACHEHITS;
+    iinfo->get_first_data_point = nsProxyTable_get_first_data_point;
+    iinfo->get_next_data_point = nsProxyTable_get_next_data_point;
+    iinfo->table_reginfo = table_info;
+    netsnmp_register_table_iterator2(reg, iinfo);
+}
+
 void
 init_proxy(void)
 {
     snmpd_register_config_handler("proxy", proxy_parse_config,
                                   proxy_free_config,
                                   "[snmpcmd args] host oid [remoteoid]");
+    register_nsProxyTable();
 }
 
 void
@@ -350,6 +707,10 @@ proxy_handler(netsnmp_mib_handler *handler,
     size_t          ourlength;
     netsnmp_request_info *request = requests;
     u_char         *configured = NULL;
+    netsnmp_session *ss;
+    netsnmp_delegated_cache *cache;
+    struct proxy_request *preq;
+    int             i;
 
     DEBUGMSGTL(("proxy", "proxy handler starting, mode = %d\n",
                 reqinfo->mode));
@@ -468,57 +829,115 @@ proxy_handler(netsnmp_mib_handler *handler,
     /*
      * Customize session parameters based on request information
      */
-    if (!proxy_fill_in_session(handler, reqinfo, (void **)&configured)) {
+    i = proxy_pick_session(sp);
+    ss = sp->sessions[i];
+    if (!proxy_fill_in_session(handler, reqinfo, ss, (void **)&configured)) {
         netsnmp_set_request_error(reqinfo, requests, SNMP_ERR_GENERR);
         if (pdu)
             snmp_free_pdu(pdu);
         return SNMP_ERR_NOERROR;
     }
 
+    /*
+     * the same GET may have been answered only a moment ago, or be
+     * outstanding already
+     */
+    preq = NULL;
+    if (reqinfo->mode == MODE_GET || reqinfo->mode == MODE_GETNEXT)
+        preq = proxy_find_request(sp, reqinfo->mode, pdu->variables, ss);
+    if (preq && preq->response) {
+        DEBUGMSGTL(("proxy", "answering from a recent response\n"));
+        sp->cache_hits++;
+        netsnmp_handler_mark_requests_as_delegated(requests,
+                                                   REQUEST_IS_NOT_DELEGATED);
+        proxy_answer(NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE, sp, reqinfo,
+                     requests, preq->response);
+        snmp_free_pdu(pdu);
+        proxy_free_filled_in_session_args(ss, (void **)&configured);
+        return SNMP_ERR_NOERROR;
+    }
+
+    cache = netsnmp_create_delegated_cache(handler, reginfo, reqinfo,
+                                           requests, (void *) sp);
+    if (!cache) {
+        netsnmp_handler_mark_requests_as_delegated(requests,
+                                                   REQUEST_IS_NOT_DELEGATED);
+        netsnmp_set_request_error(reqinfo, requests, SNMP_ERR_GENERR);
+        snmp_free_pdu(pdu);
+        proxy_free_filled_in_session_args(ss, (void **)&configured);
+        return SNMP_ERR_NOERROR;
+    }
+    if (preq && proxy_request_add_waiter(preq, cache) == 0) {
+        DEBUGMSGTL(("proxy", "joining an outstanding request\n"));
+        sp->coalesced++;
+        snmp_free_pdu(pdu);
+        proxy_free_filled_in_session_args(ss, (void **)&configured);
+        return SNMP_ERR_NOERROR;
+    }
+
+    preq = SNMP_MALLOC_STRUCT(proxy_request);
+    if (preq) {
+        preq->sp = sp;
+        preq->session = i;
+        preq->mode = reqinfo->mode;
+        if ((reqinfo->mode == MODE_GET || reqinfo->mode == MODE_GETNEXT) &&
+            (preq->vars = snmp_clone_varbind(pdu->variables)) != NULL &&
+            ss->community_len) {
+            if (memdup(&preq->community, ss->community,
+                       ss->community_len) == SNMPERR_SUCCESS)
+                preq->community_len = ss->community_len;
+        }
+        if (preq->vars && preq->community_len != ss->community_len) {
+            snmp_free_varbind(preq->vars);
+            preq->vars = NULL;
+        }
+        if (proxy_request_add_waiter(preq, cache) < 0) {
+            proxy_request_free(preq);
+            preq = NULL;
+        }
+    }
+
     /*
      * send the request out 
      */
     DEBUGMSGTL(("proxy", "sending pdu\n"));
-    snmp_async_send(sp->sess, pdu, proxy_got_response,
-                    netsnmp_create_delegated_cache(handler, reginfo,
-                                                   reqinfo, requests,
-                                                   (void *) sp));
+    if (!preq || !snmp_async_send(ss, pdu, proxy_got_responses, preq)) {
+        if (preq)
+            proxy_request_free(preq);
+        snmp_free_pdu(pdu);
+        netsnmp_handler_mark_requests_as_delegated(requests,
+                                                   REQUEST_IS_NOT_DELEGATED);
+        netsnmp_set_request_error(reqinfo, requests, SNMP_ERR_GENERR);
+        netsnmp_free_delegated_cache(cache);
+    } else {
+        sp->sent++;
+        sp->outstanding[i]++;
+        if (preq->vars) {
+            preq->next = sp->inflight;
+            sp->inflight = preq;
+        }
+    }
 
     /* Free any special parameters generated on the session */
-    proxy_free_filled_in_session_args(sp->sess, (void **)&configured);
+    proxy_free_filled_in_session_args(ss, (void **)&configured);
 
     return SNMP_ERR_NOERROR;
 }
 
-int
-proxy_got_response(int operation, netsnmp_session * sess, int reqid,
-                   netsnmp_pdu *pdu, void *cb_data)
+/*
+ * update our requests from the proxied agent's response
+ */
+static int
+proxy_answer(int operation, struct simple_proxy *sp,
+             netsnmp_agent_request_info *reqinfo,
+             netsnmp_request_info *requests, netsnmp_pdu *pdu)
 {
-    netsnmp_delegated_cache *cache = (netsnmp_delegated_cache *) cb_data;
-    netsnmp_request_info  *requests, *request = NULL;
+    netsnmp_request_info  *request = NULL;
     netsnmp_variable_list *vars,     *var     = NULL;
 
-    struct simple_proxy *sp;
     oid             myname[MAX_OID_LEN];
     size_t          myname_len = MAX_OID_LEN;
 
-    cache = netsnmp_handler_check_cache(cache);
-
-    if (!cache) {
-        DEBUGMSGTL(("proxy", "a proxy request was no longer valid.\n"));
-        return SNMP_ERR_NOERROR;
-    }
-
-    requests = cache->requests;
-
-
-    sp = (struct simple_proxy *) cache->localinfo;
-
-    if (!sp) {
-        DEBUGMSGTL(("proxy", "a proxy request was no longer valid.\n"));
-        return SNMP_ERR_NOERROR;
-    }
-
     switch (operation) {
     case NETSNMP_CALLBACK_OP_TIMED_OUT:
         /*
@@ -529,12 +948,11 @@ proxy_got_response(int operation, netsnmp_session * sess, int reqid,
 
         netsnmp_handler_mark_requests_as_delegated(requests,
                                                    REQUEST_IS_NOT_DELEGATED);
-        if(cache->reqinfo->mode != MODE_GETNEXT) {
+        if(reqinfo->mode != MODE_GETNEXT) {
             DEBUGMSGTL(("proxy", "  ignoring timeout\n"));
-            netsnmp_set_request_error(cache->reqinfo, requests, /* XXXWWW: should be index = 0 */
+            netsnmp_set_request_error(reqinfo, requests, /* XXXWWW: should be index = 0 */
                                       SNMP_ERR_GENERR);
         }
-        netsnmp_free_delegated_cache(cache);
         return 0;
 
     case NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE:
@@ -554,14 +972,14 @@ proxy_got_response(int operation, netsnmp_session * sess, int reqid,
              * as an exercise to the reader...
              */
             DEBUGMSGTL(("proxy", "got error response (%ld)\n", pdu->errstat));
-            if((cache->reqinfo->mode == MODE_GETNEXT) &&
+            if((reqinfo->mode == MODE_GETNEXT) &&
                (SNMP_ERR_NOSUCHNAME == pdu->errstat)) {
                 DEBUGMSGTL(("proxy", "  ignoring error response\n"));
                 netsnmp_handler_mark_requests_as_delegated(requests,
                                                            REQUEST_IS_NOT_DELEGATED);
             }
 #ifndef NETSNMP_NO_WRITE_SUPPORT
-	    else if (cache->reqinfo->mode == MODE_SET_ACTION) {
+	    else if (reqinfo->mode == MODE_SET_ACTION) {
 		/*
 		 * In order for netsnmp_wrap_up_request to consider the
 		 * SET request complete,
@@ -647,11 +1065,8 @@ proxy_got_response(int operation, netsnmp_session * sess, int reqid,
                     if (myname_len > MAX_OID_LEN) {
                         snmp_log(LOG_WARNING,
                                  "proxy OID return length too long.\n");
-                        netsnmp_set_request_error(cache->reqinfo, requests,
+                        netsnmp_set_request_error(reqinfo, requests,
                                                   SNMP_ERR_GENERR);
-                        if (pdu)
-                            snmp_free_pdu(pdu);
-                        netsnmp_free_delegated_cache(cache);
                         return 1;
                     }
 
@@ -674,16 +1089,14 @@ proxy_got_response(int operation, netsnmp_session * sess, int reqid,
              * ack, this is bad.  The # of varbinds don't match and
              * there is no way to fix the problem 
              */
-            if (pdu)
-                snmp_free_pdu(pdu);
             snmp_log(LOG_ERR,
                      "response to proxy request illegal.  We're screwed.\n");
-            netsnmp_set_request_error(cache->reqinfo, requests,
+            netsnmp_set_request_error(reqinfo, requests,
                                       SNMP_ERR_GENERR);
         }
 
         /* fix bulk_to_next operations */
-        if (cache->reqinfo->mode == MODE_GETBULK)
+        if (reqinfo->mode == MODE_GETBULK)
             netsnmp_bulk_to_next_fix_requests(requests);
         
         /*
@@ -699,6 +1112,32 @@ proxy_got_response(int operation, netsnmp_session * sess, int reqid,
 	break;
     }
 
-    netsnmp_free_delegated_cache(cache);
     return 1;
 }
+
+int
+proxy_got_response(int operation, netsnmp_session * sess, int reqid,
+                   netsnmp_pdu *pdu, void *cb_data)
+{
+    netsnmp_delegated_cache *cache = (netsnmp_delegated_cache *) cb_data;
+    struct simple_proxy *sp;
+    int             rc;
+
+    cache = netsnmp_handler_check_cache(cache);
+
+    if (!cache) {
+        DEBUGMSGTL(("proxy", "a proxy request was no longer valid.\n"));
+        return SNMP_ERR_NOERROR;
+    }
+
+    sp = (struct simple_proxy *) cache->localinfo;
+
+    if (!sp) {
+        DEBUGMSGTL(("proxy", "a proxy request was no longer valid.\n"));
+        return SNMP_ERR_NOERROR;
+    }
+
+    rc = proxy_answer(operation, sp, cache->reqinfo, cache->requests, pdu);
+    netsnmp_free_delegated_cache(cache);
+    return rc;
+}
@@ -1,6 +1,8 @@
 #ifndef UCD_SNMP_PROXY_H
 #define UCD_SNMP_PROXY_H
 
+struct proxy_request;
+
 struct simple_proxy {
     struct variable2 *variables;
     oid             name[MAX_OID_LEN];
@@ -10,6 +12,29 @@ struct simple_proxy {
     char           *context;
     netsnmp_session *sess;
     struct simple_proxy *next;
+
+    /*
+     * more sessions to the same agent (sess is the first of them), and
+     * how many requests each has outstanding
+     */
+    netsnmp_session **sessions;
+    int            *outstanding;
+    int             nsessions;
+
+    /*
+     * GETs and GETNEXTs sent and not yet answered, which identical
+     * requests join rather than being sent again; and answers kept for
+     * ttl (in 1/100ths of a second) to be used again
+     */
+    struct proxy_request *inflight;
+    struct proxy_request *answers;
+    u_long          ttl;
+
+    /*
+     * for nsProxyTable
+     */
+    u_long          index;
+    u_long          sent, coalesced, cache_hits;
 };
 
 int             proxy_got_response(int, netsnmp_session *, int,
@@ -137,38 +137,26 @@ vmstat_handler(netsnmp_mib_handler          *handler,
          *        a)  It matches the definition of the MIB objects
          *
          *   Note that this value will only be reported once the agent
-         *     has a full minute's history collected.
+         *     has taken two samples.
          */
         case CPUUSER:
-             if ( info->history && info->history[0].total_hist ) {
-                 value  = (info->user_ticks  - info->history[0].user_hist)*100;
-                 if ( info->total_ticks - info->history[0].total_hist)
-                     value /= (info->total_ticks - info->history[0].total_hist);
-                 else
-                     value = 0;    /* or skip this entry */
+             if ( info->rates.valid ) {
+                 value  = info->rates.user;
                  snmp_set_var_typed_integer(requests->requestvb,
                                             ASN_INTEGER, value & 0x7fffffff);
              }
              break;
         case CPUSYSTEM:
-             if ( info->history && info->history[0].total_hist ) {
+             if ( info->rates.valid ) {
                      /* or sys2_ticks ??? */
-                 value  = (info->sys_ticks  - info->history[0].sys_hist)*100;
-                 if ( info->total_ticks - info->history[0].total_hist)
-                     value /= (info->total_ticks - info->history[0].total_hist);
-                 else
-                     value = 0;    /* or skip this entry */
+                 value  = info->rates.sys;
                  snmp_set_var_typed_integer(requests->requestvb,
                                             ASN_INTEGER, value & 0x7fffffff);
              }
              break;
         case CPUIDLE:
-             if ( info->history && info->history[0].total_hist ) {
-                 value  = (info->idle_ticks  - info->history[0].idle_hist)*100;
-                 if ( info->total_ticks - info->history[0].total_hist)
-                     value /= (info->total_ticks - info->history[0].total_hist);
-                 else
-                     value = 0;    /* or skip this entry */
+             if ( info->rates.valid ) {
+                 value  = info->rates.idle;
                  snmp_set_var_typed_integer(requests->requestvb,
                                             ASN_INTEGER, value & 0x7fffffff);
              }
@@ -187,15 +175,15 @@ vmstat_handler(netsnmp_mib_handler          *handler,
                                         info->nCtxSwitches & 0xffffffff);
              break;
         case SYSINTERRUPTS:
-             if ( info->history && info->history[0].total_hist ) {
-                 value  = (info->nInterrupts - info->history[0].intr_hist)/60;
+             if ( info->rates.valid ) {
+                 value  = info->rates.intr;
                  snmp_set_var_typed_integer(requests->requestvb,
                                             ASN_INTEGER, value & 0x7fffffff);
              }
              break;
         case SYSCONTEXT:
-             if ( info->history && info->history[0].total_hist ) {
-                 value  = (info->nCtxSwitches - info->history[0].ctx_hist)/60;
+             if ( info->rates.valid ) {
+                 value  = info->rates.ctx;
                  snmp_set_var_typed_integer(requests->requestvb,
                                             ASN_INTEGER, value & 0x7fffffff);
              }
@@ -213,16 +201,16 @@ vmstat_handler(netsnmp_mib_handler          *handler,
                                         info->swapOut & 0xffffffff);
              break;
         case SWAPIN:
-             if ( info->history && info->history[0].total_hist ) {
-                 value  = (info->swapIn - info->history[0].swpi_hist)/60;
+             if ( info->rates.valid ) {
+                 value  = info->rates.swpi;
                  /* ??? value *= PAGE_SIZE;  */
                  snmp_set_var_typed_integer(requests->requestvb,
                                             ASN_INTEGER, value & 0x7fffffff);
              }
              break;
         case SWAPOUT:
-             if ( info->history && info->history[0].total_hist ) {
-                 value  = (info->swapOut - info->history[0].swpo_hist)/60;
+             if ( info->rates.valid ) {
+                 value  = info->rates.swpo;
                  /* ??? value *= PAGE_SIZE;  */
                  snmp_set_var_typed_integer(requests->requestvb,
                                             ASN_INTEGER, value & 0x7fffffff);
@@ -241,15 +229,15 @@ vmstat_handler(netsnmp_mib_handler          *handler,
                                         info->pageIn & 0xffffffff);
              break;
         case IOSENT:
-             if ( info->history && info->history[0].total_hist ) {
-                 value  = (info->pageOut - info->history[0].pageo_hist)/60;
+             if ( info->rates.valid ) {
+                 value  = info->rates.pageo;
                  snmp_set_var_typed_integer(requests->requestvb,
                                             ASN_INTEGER, value & 0x7fffffff);
              }
              break;
         case IORECEIVE:
-             if ( info->history && info->history[0].total_hist ) {
-                 value  = (info->pageIn - info->history[0].pagei_hist)/60;
+             if ( info->rates.valid ) {
+                 value  = info->rates.pagei;
                  snmp_set_var_typed_integer(requests->requestvb,
                                             ASN_INTEGER, value & 0x7fffffff);
              }
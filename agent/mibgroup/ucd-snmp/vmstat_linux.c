@@ -394,8 +394,10 @@ vmstat(int iindex)
     double          ddiv2;
 
     netsnmp_cpu_info *cpu;
+    struct netsnmp_cpu_history *hist;
     netsnmp_cpu_load();
     cpu = netsnmp_cpu_get_byIdx( -1, 0 );
+    hist = netsnmp_cpu_get_history( cpu );
 
     duse = cpu->user_ticks + cpu->nice_ticks;
     dsys = cpu->sys_ticks;
@@ -411,11 +413,11 @@ vmstat(int iindex)
     ddiv2 = ddiv + cpu->wait_ticks
                  + cpu->intrpt_ticks
                  + cpu->sirq_ticks;
-    if (cpu->history) {
-        duse  -= (cpu->history[0].user_hist + cpu->history[0].nice_hist);
-        dsys  -=  cpu->history[0].sys_hist;
-        didl  -=  cpu->history[0].idle_hist;
-        ddiv2 -=  cpu->history[0].total_hist;
+    if (hist) {
+        duse  -= (hist->user_hist + hist->nice_hist);
+        dsys  -=  hist->sys_hist;
+        didl  -=  hist->idle_hist;
+        ddiv2 -=  hist->total_hist;
     }
     if (!ddiv) ddiv=1;   /* Protect against division-by-0 */
  
@@ -21,6 +21,8 @@ config_require(udp-mib/data_access/udp_endpoint_common)
 #if defined( linux )
 config_require(udp-mib/data_access/udp_endpoint_linux)
 config_require(util_funcs/get_pid_from_inode)
+config_require(util_funcs/inet_diag)
+#   define NETSNMP_ACCESS_UDP_ENDPOINT_HAVE_FILTER 1
 #elif defined( solaris2 )
 config_require(udp-mib/data_access/udp_endpoint_solaris2)
 #elif defined(freebsd4) || defined(dragonfly)
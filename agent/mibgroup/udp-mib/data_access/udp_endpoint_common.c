@@ -12,6 +12,7 @@
 #include <net-snmp/data_access/ipaddress.h>
 #include <net-snmp/data_access/udp_endpoint.h>
 
+#include "udp-mib/data_access/udp_endpoint.h"
 #include "udp_endpoint_private.h"
 
 netsnmp_feature_child_of(udp_endpoint_common, libnetsnmpmibs)
@@ -50,6 +51,13 @@ netsnmp_access_udp_endpoint_container_init(u_int flags)
     if (NULL == container)
         return NULL;
 
+    /*
+     * entries are indexed in load order, so there are no duplicates to
+     * look for. checking for them sorts the array on every insert.
+     */
+    netsnmp_binary_array_options_set(container, 1,
+                                     CONTAINER_KEY_ALLOW_DUPLICATES);
+
     return container;
 }
 
@@ -88,6 +96,47 @@ netsnmp_access_udp_endpoint_container_load(netsnmp_container* container,
     return container;
 }
 
+/**
+ * load only the endpoint that filter describes
+ *
+ * @retval NULL  error, or the arch can't filter; load them all instead
+ * @retval !NULL pointer to container
+ */
+netsnmp_container*
+netsnmp_access_udp_endpoint_container_load_filter(netsnmp_container* container,
+                                                  u_int load_flags,
+                                                  netsnmp_udp_endpoint_filter *filter)
+{
+#ifdef NETSNMP_ACCESS_UDP_ENDPOINT_HAVE_FILTER
+    int rc;
+
+    DEBUGMSGTL(("access:udp_endpoint:container", "load filtered\n"));
+
+    if (NULL == filter || (NULL == filter->exact &&
+                           (NULL == filter->after || NULL == filter->index)))
+        return NULL;
+
+    if (NULL == container)
+        container = netsnmp_access_udp_endpoint_container_init(0);
+    if (NULL == container) {
+        snmp_log(LOG_ERR,
+                 "no container specified/found for access_udp_endpoint\n");
+        return NULL;
+    }
+
+    rc = netsnmp_arch_udp_endpoint_container_load_filter(container,
+                                                         load_flags, filter);
+    if (0 != rc) {
+        netsnmp_access_udp_endpoint_container_free(container, 0);
+        container = NULL;
+    }
+
+    return container;
+#else
+    return NULL;
+#endif
+}
+
 void
 netsnmp_access_udp_endpoint_container_free(netsnmp_container *container,
                                            u_int free_flags)
@@ -15,18 +15,47 @@
 #include <net-snmp/data_access/udp_endpoint.h>
 
 #include "udp-mib/udpEndpointTable/udpEndpointTable_constants.h"
+#include "udp-mib/data_access/udp_endpoint.h"
 #include "mibgroup/util_funcs/get_pid_from_inode.h"
+#include "mibgroup/util_funcs/inet_diag.h"
 #include "udp_endpoint_private.h"
 
 #include <fcntl.h>
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+#include <linux/inet_diag.h>
+#endif
 
 netsnmp_feature_require(text_utils)
+netsnmp_feature_require(udp_endpoint_entry_create)
 netsnmp_feature_child_of(udp_endpoint_all, libnetsnmpmibs)
 netsnmp_feature_child_of(udp_endpoint_writable, udp_endpoint_all)
 
-static int _load4(netsnmp_container *container, u_int flags);
+/*
+ * every kernel socket state, as in /proc/net/udp
+ */
+#define UDP_ENDPOINT_DIAG_STATES_ALL    0x1ffe
+
+/*
+ * one load. Without a filter, every endpoint goes into the container.
+ * With one, only the best match so far is kept, and its owner is looked
+ * up when the load is done.
+ */
+typedef struct udp_endpoint_load_s {
+    netsnmp_container           *container;
+    netsnmp_udp_endpoint_filter *filter;
+    netsnmp_udp_endpoint_entry  *best;
+    unsigned long long           best_inode;
+    netsnmp_index                best_index;
+    oid                          best_oids[MAX_OID_LEN];
+    int                          seen;
+    uintptr_t                    sl;
+} udp_endpoint_load;
+
+static int _load_diag(udp_endpoint_load *load, int family);
+static int _get_diag(udp_endpoint_load *load, int family);
+static int _load4(udp_endpoint_load *load);
 #if defined (NETSNMP_ENABLE_IPV6)
-static int _load6(netsnmp_container *container, u_int flags);
+static int _load6(udp_endpoint_load *load);
 #endif
 
 /*
@@ -85,33 +114,268 @@ netsnmp_arch_udp_endpoint_delete(netsnmp_udp_endpoint_entry *entry)
  * @retval  0 no errors
  * @retval !0 errors
  */
+static int
+_load_all(udp_endpoint_load *load)
+{
+    int rc = 0;
+
+    /*
+     * sock_diag first; /proc/net/udp if it isn't available
+     */
+    rc = _load_diag(load, AF_INET);
+    if (-2 == rc)
+        rc = _load4(load);
+    if (rc < 0)
+        return rc;
+
+#if defined (NETSNMP_ENABLE_IPV6)
+    rc = _load_diag(load, AF_INET6);
+    if (-2 == rc)
+        rc = _load6(load);
+    if (rc < 0)
+        return rc;
+#endif
+
+    return 0;
+}
+
 int
 netsnmp_arch_udp_endpoint_container_load(netsnmp_container *container,
                                     u_int load_flags )
 {
+    udp_endpoint_load load;
     int rc = 0;
 
     /* Setup the pid_from_inode table, and fill it.*/
     netsnmp_get_pid_from_inode_init();
 
-    rc = _load4(container, load_flags);
+    memset(&load, 0, sizeof(load));
+    load.container = container;
+
+    rc = _load_all(&load);
     if(rc < 0) {
         u_int flags = NETSNMP_ACCESS_UDP_ENDPOINT_FREE_KEEP_CONTAINER;
         netsnmp_access_udp_endpoint_container_free(container, flags);
         return rc;
     }
 
+    return 0;
+}
+
+/**
+ *
+ * @retval  0 no errors
+ * @retval !0 errors
+ */
+int
+netsnmp_arch_udp_endpoint_container_load_filter(netsnmp_container *container,
+                                                u_int load_flags,
+                                                netsnmp_udp_endpoint_filter *filter)
+{
+    udp_endpoint_load load;
+    int             rc, family;
+
+    memset(&load, 0, sizeof(load));
+    load.container = container;
+    load.filter = filter;
+
+    if (NULL == filter->exact)
+        rc = _load_all(&load);
+    else {
+        /*
+         * ask the kernel for the one endpoint; scan them all if it can't
+         * say, or answers with another one of several that share the
+         * addresses and ports
+         */
+        family = 4 == filter->exact->loc_addr_len ? AF_INET : AF_INET6;
+        rc = _get_diag(&load, family);
+        if (-2 == rc)
+            rc = _load_diag(&load, family);
+        if (-2 == rc && AF_INET == family)
+            rc = _load4(&load);
 #if defined (NETSNMP_ENABLE_IPV6)
-    rc = _load6(container, load_flags);
-    if(rc < 0) {
-        u_int flags = NETSNMP_ACCESS_UDP_ENDPOINT_FREE_KEEP_CONTAINER;
-        netsnmp_access_udp_endpoint_container_free(container, flags);
-        return rc;
-    }
+        else if (-2 == rc)
+            rc = _load6(&load);
 #endif
+    }
+
+    if (load.best) {
+        if (0 == rc) {
+            load.best->pid = netsnmp_get_pid_from_inode_find(load.best_inode);
+            CONTAINER_INSERT(container, load.best);
+        } else
+            netsnmp_access_udp_endpoint_entry_free(load.best);
+    }
+
+    return rc < 0 ? rc : 0;
+}
+
+static int
+_same_endpoint(const netsnmp_udp_endpoint_entry *a,
+               const netsnmp_udp_endpoint_entry *b)
+{
+    return a->loc_port == b->loc_port && a->rmt_port == b->rmt_port &&
+        a->loc_addr_len == b->loc_addr_len &&
+        a->rmt_addr_len == b->rmt_addr_len &&
+        0 == memcmp(a->loc_addr, b->loc_addr, a->loc_addr_len) &&
+        0 == memcmp(a->rmt_addr, b->rmt_addr, a->rmt_addr_len);
+}
+
+/*
+ * add a new entry to the container, or with a filter, keep it if it's a
+ * better match than the one so far.
+ */
+static void
+_add_entry(udp_endpoint_load *load, netsnmp_udp_endpoint_entry *ep,
+           unsigned long long inode)
+{
+    netsnmp_udp_endpoint_filter *filter = load->filter;
+    oid             oids[MAX_OID_LEN];
+    netsnmp_index   index;
+
+    if (NULL == filter) {
+        ep->pid = netsnmp_get_pid_from_inode(inode);
+        CONTAINER_INSERT(load->container, ep);
+        return;
+    }
+
+    ++load->seen;
+    if (filter->exact) {
+        if (load->best || !_same_endpoint(ep, filter->exact) ||
+            ep->instance != filter->exact->instance) {
+            netsnmp_access_udp_endpoint_entry_free(ep);
+            return;
+        }
+    } else {
+        index.oids = oids;
+        index.len = MAX_OID_LEN;
+        if (0 != filter->index(ep, &index) ||
+            snmp_oid_compare(index.oids, index.len, filter->after->oids,
+                             filter->after->len) <= 0 ||
+            (load->best &&
+             snmp_oid_compare(index.oids, index.len,
+                              load->best_index.oids,
+                              load->best_index.len) >= 0)) {
+            netsnmp_access_udp_endpoint_entry_free(ep);
+            return;
+        }
+        memcpy(load->best_oids, oids, index.len * sizeof(oid));
+        load->best_index.oids = load->best_oids;
+        load->best_index.len = index.len;
+    }
+
+    if (load->best)
+        netsnmp_access_udp_endpoint_entry_free(load->best);
+    load->best = ep;
+    load->best_inode = inode;
+}
+
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+static int
+_diag_entry(const struct inet_diag_msg *msg, void *ctx)
+{
+    udp_endpoint_load *load = (udp_endpoint_load *) ctx;
+    netsnmp_udp_endpoint_entry *ep;
+    size_t          addr_len;
+
+    if (AF_INET == msg->idiag_family)
+        addr_len = 4;
+    else if (AF_INET6 == msg->idiag_family)
+        addr_len = 16;
+    else
+        return 0;
+
+    ep = netsnmp_access_udp_endpoint_entry_create();
+    if (NULL == ep)
+        return -1;
+
+    /** already in network order */
+    memcpy(ep->loc_addr, msg->id.idiag_src, addr_len);
+    ep->loc_addr_len = addr_len;
+    ep->loc_port = ntohs(msg->id.idiag_sport);
+    memcpy(ep->rmt_addr, msg->id.idiag_dst, addr_len);
+    ep->rmt_addr_len = addr_len;
+    ep->rmt_port = ntohs(msg->id.idiag_dport);
+    ep->state = msg->idiag_state;
+
+    /*
+     * Use inode as instance value.
+     */
+    ep->instance = (u_int)msg->idiag_inode;
+
+    /*
+     * numbered in the order the dumps return them, from 1 (the /proc
+     * lines count from 0), ipv6 after ipv4
+     */
+    ep->index = CONTAINER_SIZE(load->container) + 1;
+    _add_entry(load, ep, msg->idiag_inode);
 
     return 0;
 }
+#endif /* HAVE_LINUX_SOCK_DIAG_H */
+
+/**
+ * load one address family through sock_diag
+ *
+ * @retval  0 no errors
+ * @retval -2 sock_diag not available
+ * @retval !0 errors
+ */
+static int
+_load_diag(udp_endpoint_load *load, int family)
+{
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+    if (NULL == load->container)
+        return -1;
+
+    return netsnmp_inet_diag_dump(family, IPPROTO_UDP,
+                                  UDP_ENDPOINT_DIAG_STATES_ALL,
+                                  _diag_entry, load);
+#else
+    return -2;
+#endif
+}
+
+/**
+ * look up the endpoint in the load's filter through sock_diag
+ *
+ * @retval  0 no errors, whether it was found or not
+ * @retval -2 sock_diag not available, or not sure
+ * @retval !0 errors
+ */
+static int
+_get_diag(udp_endpoint_load *load, int family)
+{
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+    const netsnmp_udp_endpoint_entry *exact = load->filter->exact;
+    struct inet_diag_sockid id;
+    int             rc;
+
+    if (exact->loc_addr_len > sizeof(id.idiag_src) ||
+        exact->rmt_addr_len > sizeof(id.idiag_dst))
+        return -2;
+
+    /*
+     * udp_diag looks the socket up as the receiver of a datagram from
+     * src to dst, so the remote end goes in src
+     */
+    memset(&id, 0, sizeof(id));
+    id.idiag_sport = htons(exact->rmt_port);
+    id.idiag_dport = htons(exact->loc_port);
+    memcpy(id.idiag_src, exact->rmt_addr, exact->rmt_addr_len);
+    memcpy(id.idiag_dst, exact->loc_addr, exact->loc_addr_len);
+    id.idiag_cookie[0] = INET_DIAG_NOCOOKIE;
+    id.idiag_cookie[1] = INET_DIAG_NOCOOKIE;
+
+    load->seen = 0;
+    rc = netsnmp_inet_diag_get(family, IPPROTO_UDP, &id, _diag_entry, load);
+    if (0 == rc && load->seen && NULL == load->best)
+        rc = -2;
+    return rc;
+#else
+    return -2;
+#endif
+}
 
 /**
  * @internal
@@ -121,6 +385,7 @@ static int
 _process_line_udp_ep(netsnmp_line_info *line_info, void *mem,
                      struct netsnmp_line_process_info_s* lpi)
 {
+    udp_endpoint_load    *load = (udp_endpoint_load *)lpi->user_context;
     netsnmp_udp_endpoint_entry *ep = (netsnmp_udp_endpoint_entry *)mem;
     char                 *ptr, *sep;
     u_char               *u_ptr;
@@ -232,17 +497,16 @@ _process_line_udp_ep(netsnmp_line_info *line_info, void *mem,
     inode = strtoull(ptr, &ptr, 0);
     ep->instance = (u_int)inode;
 
-    /*
-     * get the pid also
-     */
-    ep->pid = netsnmp_get_pid_from_inode(inode);
-
-    ep->index = (uintptr_t)(lpi->user_context);
-    lpi->user_context = (void*)((char*)(lpi->user_context) + 1);
+    ep->index = load->sl++;
 
     ep->oid_index.oids = &ep->index;
     ep->oid_index.len = 1;
 
+    /*
+     * the pid is looked up as the entry is added
+     */
+    _add_entry(load, ep, inode);
+
     return PMLP_RC_MEMORY_USED;
 }
 
@@ -252,10 +516,11 @@ _process_line_udp_ep(netsnmp_line_info *line_info, void *mem,
  * @retval !0 errors
  */
 static int
-_load4(netsnmp_container *container, u_int load_flags)
+_load4(udp_endpoint_load *load)
 {
     netsnmp_file              *fp;
     netsnmp_line_process_info  lpi;
+    netsnmp_container         *container = load->container;
 
     if (NULL == container)
         return -1;
@@ -270,7 +535,9 @@ _load4(netsnmp_container *container, u_int load_flags)
     memset(&lpi, 0x0, sizeof(lpi));
     lpi.mem_size = sizeof(netsnmp_udp_endpoint_entry);
     lpi.process = _process_line_udp_ep;
-    lpi.user_context = (void*)0;
+    lpi.flags = PMLP_FLAG_NO_CONTAINER;
+    lpi.user_context = load;
+    load->sl = 0;
 
     container = netsnmp_file_text_parse(fp, container, PM_USER_FUNCTION,
                                         0, &lpi);
@@ -285,10 +552,11 @@ _load4(netsnmp_container *container, u_int load_flags)
  * @retval !0 errors
  */
 static int
-_load6(netsnmp_container *container, u_int load_flags)
+_load6(udp_endpoint_load *load)
 {
     netsnmp_file              *fp;
     netsnmp_line_process_info  lpi;
+    netsnmp_container         *container = load->container;
 
     if (NULL == container)
         return -1;
@@ -303,7 +571,9 @@ _load6(netsnmp_container *container, u_int load_flags)
     memset(&lpi, 0x0, sizeof(lpi));
     lpi.mem_size = sizeof(netsnmp_udp_endpoint_entry);
     lpi.process = _process_line_udp_ep;
-    lpi.user_context = (void*)CONTAINER_SIZE(container);
+    lpi.flags = PMLP_FLAG_NO_CONTAINER;
+    lpi.user_context = load;
+    load->sl = CONTAINER_SIZE(container);
 
     container = netsnmp_file_text_parse(fp, container, PM_USER_FUNCTION,
                                         0, &lpi);
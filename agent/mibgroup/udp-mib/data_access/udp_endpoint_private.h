@@ -1,5 +1,10 @@
 int netsnmp_arch_udp_endpoint_init(void);
 int netsnmp_arch_udp_endpoint_container_load(netsnmp_container *, u_int);
+#ifdef NETSNMP_ACCESS_UDP_ENDPOINT_HAVE_FILTER
+int netsnmp_arch_udp_endpoint_container_load_filter(netsnmp_container *,
+                                                    u_int,
+                                                    netsnmp_udp_endpoint_filter *);
+#endif
 int netsnmp_arch_udp_endpoint_entry_init(netsnmp_udp_endpoint_entry *);
 void netsnmp_arch_udp_endpoint_entry_cleanup(netsnmp_udp_endpoint_entry *);
 int netsnmp_arch_udp_endpoint_entry_delete(netsnmp_udp_endpoint_entry *);
@@ -300,6 +300,143 @@ udpEndpointTable_container_load(netsnmp_container *container)
     return MFD_SUCCESS;
 }                               /* udpEndpointTable_container_load */
 
+/*
+ * index an endpoint the way udpEndpointTable_container_load() does
+ */
+static int
+_endpoint_index(netsnmp_udp_endpoint_entry *ep, netsnmp_index *index)
+{
+    udpEndpointTable_mib_index tbl_idx;
+
+    memset(&tbl_idx, 0, sizeof(tbl_idx));
+    if (MFD_SUCCESS !=
+        udpEndpointTable_indexes_set_tbl_idx(&tbl_idx,
+                                             _address_type_from_len(ep->loc_addr_len),
+                                             (char *) ep->loc_addr,
+                                             ep->loc_addr_len,
+                                             ep->loc_port,
+                                             _address_type_from_len(ep->rmt_addr_len),
+                                             (char *) ep->rmt_addr,
+                                             ep->rmt_addr_len,
+                                             ep->rmt_port,
+                                             ep->instance,
+                                             ep->pid))
+        return -1;
+
+    return udpEndpointTable_index_to_oid(index, &tbl_idx);
+}
+
+/**
+ * load the part of the data that a request needs
+ *
+ * @param container container to which items should be inserted
+ * @param range     the row at an index, or the first row after one
+ *
+ * @retval MFD_SUCCESS : the container has the row, or there is no row
+ *                       at the index
+ * @retval MFD_SKIP    : load the whole table instead
+ *
+ *  Called instead of udpEndpointTable_container_load() when a request
+ *  only needs one row (see netsnmp_cache_hint_range()).
+ */
+int
+udpEndpointTable_container_load_range(netsnmp_container *container,
+                                      const netsnmp_cache_range *range)
+{
+    udpEndpointTable_rowreq_ctx *rowreq_ctx;
+    netsnmp_container *ep_c;
+    netsnmp_udp_endpoint_filter filter;
+    netsnmp_udp_endpoint_entry exact, *ep;
+    udpEndpointTable_mib_index tbl_idx;
+    netsnmp_index   index;
+
+    DEBUGMSGTL(("verbose:udpEndpointTable:udpEndpointTable_container_load_range", "called\n"));
+
+    memset(&filter, 0, sizeof(filter));
+    if (range->exact) {
+        /*
+         * an index that doesn't parse, or with addresses of different
+         * types, has no row
+         */
+        memset(&tbl_idx, 0, sizeof(tbl_idx));
+        index = range->index;
+        if (SNMP_ERR_NOERROR !=
+            udpEndpointTable_index_from_oid(&index, &tbl_idx) ||
+            tbl_idx.udpEndpointLocalAddressType !=
+            tbl_idx.udpEndpointRemoteAddressType ||
+            tbl_idx.udpEndpointLocalAddress_len !=
+            tbl_idx.udpEndpointRemoteAddress_len ||
+            tbl_idx.udpEndpointLocalPort > 0xffff ||
+            tbl_idx.udpEndpointRemotePort > 0xffff)
+            return MFD_SUCCESS;
+        if ((INETADDRESSTYPE_IPV4 == tbl_idx.udpEndpointLocalAddressType &&
+             4 != tbl_idx.udpEndpointLocalAddress_len) ||
+            (INETADDRESSTYPE_IPV6 == tbl_idx.udpEndpointLocalAddressType &&
+             16 != tbl_idx.udpEndpointLocalAddress_len))
+            return MFD_SUCCESS;
+        if (INETADDRESSTYPE_IPV4 != tbl_idx.udpEndpointLocalAddressType &&
+            INETADDRESSTYPE_IPV6 != tbl_idx.udpEndpointLocalAddressType)
+            return MFD_SKIP;
+
+        memset(&exact, 0, sizeof(exact));
+        memcpy(exact.loc_addr, tbl_idx.udpEndpointLocalAddress,
+               tbl_idx.udpEndpointLocalAddress_len);
+        exact.loc_addr_len = tbl_idx.udpEndpointLocalAddress_len;
+        exact.loc_port = tbl_idx.udpEndpointLocalPort;
+        memcpy(exact.rmt_addr, tbl_idx.udpEndpointRemoteAddress,
+               tbl_idx.udpEndpointRemoteAddress_len);
+        exact.rmt_addr_len = tbl_idx.udpEndpointRemoteAddress_len;
+        exact.rmt_port = tbl_idx.udpEndpointRemotePort;
+        exact.instance = tbl_idx.udpEndpointInstance;
+        filter.exact = &exact;
+    } else {
+        filter.after = &range->index;
+        filter.index = _endpoint_index;
+    }
+
+    ep_c = netsnmp_access_udp_endpoint_container_load_filter(NULL, 0,
+                                                             &filter);
+    if (NULL == ep_c)
+        return MFD_SKIP;
+
+    ep = (netsnmp_udp_endpoint_entry *) CONTAINER_FIRST(ep_c);
+    if (ep) {
+        rowreq_ctx = udpEndpointTable_allocate_rowreq_ctx();
+        if (NULL == rowreq_ctx) {
+            snmp_log(LOG_ERR, "memory allocation failed\n");
+            netsnmp_access_udp_endpoint_container_free(ep_c, 0);
+            return MFD_RESOURCE_UNAVAILABLE;
+        }
+        if (MFD_SUCCESS !=
+            udpEndpointTable_indexes_set(rowreq_ctx,
+                                         _address_type_from_len(ep->loc_addr_len),
+                                         (char *) ep->loc_addr,
+                                         ep->loc_addr_len,
+                                         ep->loc_port,
+                                         _address_type_from_len(ep->rmt_addr_len),
+                                         (char *) ep->rmt_addr,
+                                         ep->rmt_addr_len,
+                                         ep->rmt_port,
+                                         ep->instance,
+                                         ep->pid)) {
+            snmp_log(LOG_ERR,
+                     "error setting index while loading "
+                     "udpEndpointTable data.\n");
+            udpEndpointTable_release_rowreq_ctx(rowreq_ctx);
+        } else
+            CONTAINER_INSERT(container, rowreq_ctx);
+    }
+    netsnmp_access_udp_endpoint_container_free(ep_c, 0);
+
+    /*
+     * nothing after the index: the next row is in the next column
+     */
+    if (!range->exact && 0 == CONTAINER_SIZE(container))
+        return MFD_SKIP;
+
+    return MFD_SUCCESS;
+}
+
 /**
  * container clean up
  *
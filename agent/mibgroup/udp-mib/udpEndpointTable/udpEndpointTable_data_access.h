@@ -54,6 +54,11 @@ extern          "C" {
 
     int             udpEndpointTable_container_load(netsnmp_container
                                                     *container);
+    int             udpEndpointTable_container_load_range(netsnmp_container
+                                                          *container,
+                                                          const
+                                                          netsnmp_cache_range
+                                                          *range);
     void            udpEndpointTable_container_free(netsnmp_container
                                                     *container);
 
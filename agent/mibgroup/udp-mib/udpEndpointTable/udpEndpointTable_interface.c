@@ -52,6 +52,7 @@ netsnmp_feature_child_of(udpEndpointTable_external_access, libnetsnmpmibs)
 netsnmp_feature_require(row_merge)
 netsnmp_feature_require(baby_steps)
 netsnmp_feature_require(check_all_requests_error)
+netsnmp_feature_require(cache_hint_range)
 
 
 netsnmp_feature_child_of(udpEndpointTable_container_size, udpEndpointTable_external_access)
@@ -931,6 +932,9 @@ static void     _container_free(netsnmp_container *container);
 static int
 _cache_load(netsnmp_cache * cache, void *vmagic)
 {
+    netsnmp_cache_range range;
+    int             rc;
+
     DEBUGMSGTL(("internal:udpEndpointTable:_cache_load", "called\n"));
 
     if ((NULL == cache) || (NULL == cache->magic)) {
@@ -943,8 +947,19 @@ _cache_load(netsnmp_cache * cache, void *vmagic)
     netsnmp_assert((0 == cache->valid) || (1 == cache->expired));
 
     /*
-     * call user code
+     * call user code, for the one row a request needs if it can
      */
+    if (netsnmp_cache_hint_range(cache, &range)) {
+        rc = udpEndpointTable_container_load_range((netsnmp_container *)
+                                                   cache->magic, &range);
+        if (MFD_SUCCESS == rc) {
+            cache->flags |= NETSNMP_CACHE_PARTIAL_LOAD;
+            return rc;
+        }
+        if (MFD_SKIP != rc)
+            return rc;
+    }
+
     return udpEndpointTable_container_load((netsnmp_container *) cache->
                                            magic);
 }                               /* _cache_load */
@@ -1048,6 +1063,10 @@ _udpEndpointTable_container_init(udpEndpointTable_interface_ctx * if_ctx)
     }
     if_ctx->container->container_name = strdup("udpEndpointTable");
 
+    /* set allow duplicates this makes insert O(1) */
+    netsnmp_binary_array_options_set(if_ctx->container, 1,
+                                     CONTAINER_KEY_ALLOW_DUPLICATES);
+
     if (NULL != if_ctx->cache)
         if_ctx->cache->magic = (void *) if_ctx->container;
 }                               /* _udpEndpointTable_container_init */
@@ -31,8 +31,10 @@ typedef struct {
 
 #define INODE_PID_TABLE_MAX_COLLISIONS 1000
 #define INODE_PID_TABLE_LENGTH 20000
-#define INODE_PID_TABLE_SIZE (INODE_PID_TABLE_LENGTH * sizeof (inode_pid_ent_t))
-static inode_pid_ent_t  inode_pid_table[INODE_PID_TABLE_LENGTH];
+/* The table is doubled whenever it gets half full.*/
+static inode_pid_ent_t *inode_pid_table;
+static size_t           inode_pid_table_length;
+static size_t           inode_pid_table_count;
 
 static uint32_t
 _hash(uint64_t key)
@@ -50,23 +52,60 @@ static void
 _clear(void)
 {
     /* Clear the inode/pid hash table.*/
-    memset(inode_pid_table, 0, INODE_PID_TABLE_SIZE);
+    if (inode_pid_table)
+        memset(inode_pid_table, 0,
+               inode_pid_table_length * sizeof(inode_pid_ent_t));
+    inode_pid_table_count = 0;
+}
+
+static void _set(ino64_t inode, pid_t pid);
+
+static int
+_grow(void)
+{
+    inode_pid_ent_t *old = inode_pid_table;
+    size_t          old_length = inode_pid_table_length, i;
+    size_t          length = old_length ? 2 * old_length :
+                                          INODE_PID_TABLE_LENGTH;
+
+    inode_pid_table = calloc(length, sizeof(inode_pid_ent_t));
+    if (!inode_pid_table) {
+        inode_pid_table = old;
+        return -1;
+    }
+    inode_pid_table_length = length;
+    inode_pid_table_count = 0;
+
+    /* Rehash the old entries into the new table.*/
+    for (i = 0; i < old_length; i++)
+        if (old[i].inode != 0)
+            _set(old[i].inode, old[i].pid);
+    free(old);
+    return 0;
 }
 
 static void
 _set(ino64_t inode, pid_t pid)
 {
-    uint32_t        hash = _hash(inode);
+    uint32_t        hash;
     uint32_t        i;
     inode_pid_ent_t *entry;
 
+    if (2 * inode_pid_table_count >= inode_pid_table_length &&
+        _grow() < 0 && inode_pid_table == NULL)
+        return;
+
+    hash = _hash(inode);
+
     /* We will try for a maximum number of collisions.*/
     for (i = 0; i < INODE_PID_TABLE_MAX_COLLISIONS; i++) {
-        entry = &inode_pid_table[(hash + i) % INODE_PID_TABLE_LENGTH];
+        entry = &inode_pid_table[(hash + i) % inode_pid_table_length];
 
         /* Check if this entry is empty, or the actual inode we were looking for.*/
         /* The second part should never happen, but it is here for completeness.*/
         if (entry->inode == 0 || entry->inode == inode) {
+            if (entry->inode == 0)
+                inode_pid_table_count++;
             entry->inode = inode;
             entry->pid = pid;
             return;
@@ -83,9 +122,12 @@ static pid_t _get(ino64_t inode)
     uint32_t        i;
     inode_pid_ent_t *entry;
 
+    if (!inode_pid_table)
+        return 0;
+
     /* We will try for a maximum number of collisions.*/
     for (i = 0; i < INODE_PID_TABLE_MAX_COLLISIONS; i++) {
-        entry = &inode_pid_table[(hash + i) % INODE_PID_TABLE_LENGTH];
+        entry = &inode_pid_table[(hash + i) % inode_pid_table_length];
 
         /* Check if this entry is empty, or the actual inode we were looking for.*/
         /* If the entry is empty it means the inode is not in the table and we*/
@@ -99,8 +141,10 @@ static pid_t _get(ino64_t inode)
     return 0;
 }
 
-void
-netsnmp_get_pid_from_inode_init(void)
+/* Walk all the open file descriptors, and add the sockets to the table.*/
+/* If want is set, only look for that inode, and return its pid.*/
+static pid_t
+_scan(ino64_t want)
 {
     DIR            *procdirs = NULL, *piddirs = NULL;
     char            path_name[PATH_MAX + 1];
@@ -110,12 +154,10 @@ netsnmp_get_pid_from_inode_init(void)
     pid_t           pid = 0;
     ino64_t         temp_inode;
 
-    _clear();
-
     /* walk over all directories in /proc*/
     if (!(procdirs = opendir(PROC_PATH))) {
         NETSNMP_LOGONCE((LOG_ERR, "snmpd: cannot open /proc\n"));
-        return;
+        return 0;
     }
 
     while ((procinfo = readdir(procdirs)) != NULL) {
@@ -169,13 +211,27 @@ netsnmp_get_pid_from_inode_init(void)
             /* Add the inode/pid combination to our hash table.*/
             if (temp_inode != 0) {
                 pid = strtoul(procinfo->d_name, NULL, 0);
-                _set(temp_inode, pid);
+                if (want == 0)
+                    _set(temp_inode, pid);
+                else if (temp_inode == want) {
+                    closedir(piddirs);
+                    closedir(procdirs);
+                    return pid;
+                }
             }
         }
         closedir(piddirs);
     }
     if (procdirs)
         closedir(procdirs);
+    return 0;
+}
+
+void
+netsnmp_get_pid_from_inode_init(void)
+{
+    _clear();
+    _scan(0);
 }
 
 pid_t
@@ -184,3 +240,12 @@ netsnmp_get_pid_from_inode(ino64_t inode)
     return _get(inode);
 }
 
+/* Look for a single inode, without filling the table. This is cheaper*/
+/* than netsnmp_get_pid_from_inode_init() when only a few are needed.*/
+pid_t
+netsnmp_get_pid_from_inode_find(ino64_t inode)
+{
+    if (inode == 0)
+        return 0;
+    return _scan(inode);
+}
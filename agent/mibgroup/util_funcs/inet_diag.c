@@ -0,0 +1,177 @@
+/*
+ * util_funcs/inet_diag.c:  dump the kernel's tcp and udp socket tables
+ * through NETLINK_SOCK_DIAG on linux.
+ *
+ * The kernel filters the sockets by state and sends them in binary,
+ * which is a lot cheaper than formatting and parsing /proc/net/tcp and
+ * friends on hosts with many sockets.
+ */
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+
+#include <errno.h>
+#if HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#endif
+
+#include "inet_diag.h"
+
+/*
+ * "inet_diag no" makes the callers read /proc instead
+ */
+static int      inet_diag_enabled = 1;
+
+static void
+_parse_inet_diag(const char *token, char *line)
+{
+    int             use = netsnmp_ds_parse_boolean(line);
+
+    if (use >= 0)
+        inet_diag_enabled = use;
+}
+
+void
+init_inet_diag(void)
+{
+    snmpd_register_config_handler("inet_diag", _parse_inet_diag, NULL,
+                                  "yes|no");
+}
+
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+/*
+ * protocols (as 1 << IPPROTO_*) that sock_diag has answered for. Only
+ * then does "no such file or directory" from a lookup mean that there
+ * is no such socket, rather than no diag module for the protocol.
+ */
+static unsigned int inet_diag_works = 0;
+
+static int
+_inet_diag_request(int family, int protocol, unsigned int states,
+                   const struct inet_diag_sockid *id,
+                   netsnmp_inet_diag_cb *cb, void *ctx)
+{
+    static __u32    seq = 0;
+    struct {
+        struct nlmsghdr n;
+        struct inet_diag_req_v2 r;
+    } req;
+    union {
+        struct nlmsghdr n;
+        char            buf[32768];
+    } u;
+    struct nlmsghdr *h;
+    int             fd, len, rc = -2;
+
+    if (!inet_diag_enabled)
+        return -2;
+
+    fd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_SOCK_DIAG);
+    if (fd < 0) {
+        DEBUGMSGTL(("inet_diag", "socket failed: %s\n", strerror(errno)));
+        return -2;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.n.nlmsg_len = sizeof(req);
+    req.n.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    req.n.nlmsg_flags = NLM_F_REQUEST;
+    req.n.nlmsg_seq = ++seq;
+    req.r.sdiag_family = family;
+    req.r.sdiag_protocol = protocol;
+    req.r.idiag_states = states;
+    if (id)
+        req.r.id = *id;
+    else
+        req.n.nlmsg_flags |= NLM_F_DUMP;
+
+    if (send(fd, &req, req.n.nlmsg_len, 0) < 0) {
+        DEBUGMSGTL(("inet_diag", "send failed: %s\n", strerror(errno)));
+        goto out;
+    }
+
+    /*
+     * until the first socket arrives, an error means that there is no
+     * diag module for the protocol (udp_diag isn't always loaded), and
+     * the caller should fall back to /proc.
+     */
+    for (;;) {
+        len = recv(fd, u.buf, sizeof(u.buf), MSG_TRUNC);
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            DEBUGMSGTL(("inet_diag", "recv failed: %s\n", strerror(errno)));
+            goto out;
+        }
+        if (len == 0 || len > (int) sizeof(u.buf)) {
+            DEBUGMSGTL(("inet_diag", "bad reply length %d\n", len));
+            goto out;
+        }
+
+        for (h = &u.n; NLMSG_OK(h, len); h = NLMSG_NEXT(h, len)) {
+            if (h->nlmsg_seq != seq)
+                continue;
+            if (h->nlmsg_type == NLMSG_DONE) {
+                inet_diag_works |= 1U << protocol;
+                rc = 0;
+                goto out;
+            }
+            if (h->nlmsg_type == NLMSG_ERROR) {
+                const struct nlmsgerr *err =
+                    (const struct nlmsgerr *) NLMSG_DATA(h);
+
+                DEBUGMSGTL(("inet_diag", "request for %d/%d failed: %d\n",
+                            family, protocol, err->error));
+                if (id && -ENOENT == err->error &&
+                    (inet_diag_works & (1U << protocol)))
+                    rc = 0;
+                goto out;
+            }
+            if (h->nlmsg_type != SOCK_DIAG_BY_FAMILY ||
+                h->nlmsg_len < NLMSG_LENGTH(sizeof(struct inet_diag_msg)))
+                continue;
+            rc = -1;
+            if (cb((const struct inet_diag_msg *) NLMSG_DATA(h), ctx) < 0)
+                goto out;
+            if (id) {
+                /** a lookup has a single answer, and no NLMSG_DONE */
+                inet_diag_works |= 1U << protocol;
+                rc = 0;
+                goto out;
+            }
+        }
+    }
+
+  out:
+    close(fd);
+    return rc;
+}
+#endif /* HAVE_LINUX_SOCK_DIAG_H */
+
+int
+netsnmp_inet_diag_dump(int family, int protocol, unsigned int states,
+                       netsnmp_inet_diag_cb *cb, void *ctx)
+{
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+    return _inet_diag_request(family, protocol, states, NULL, cb, ctx);
+#else
+    return -2;
+#endif
+}
+
+int
+netsnmp_inet_diag_get(int family, int protocol,
+                      const struct inet_diag_sockid *id,
+                      netsnmp_inet_diag_cb *cb, void *ctx)
+{
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+    return _inet_diag_request(family, protocol, 0, id, cb, ctx);
+#else
+    return -2;
+#endif
+}
@@ -0,0 +1,49 @@
+/*
+ * util_funcs/inet_diag.h:  dump the kernel's tcp and udp socket tables
+ * through NETLINK_SOCK_DIAG on linux.
+ */
+#ifndef NETSNMP_MIBGROUP_UTIL_FUNCS_INET_DIAG_H
+#define NETSNMP_MIBGROUP_UTIL_FUNCS_INET_DIAG_H
+
+#ifndef linux
+config_error(inet_diag is only supported on linux)
+#endif
+
+/*
+ * called for each socket in a dump. A negative return value stops the
+ * dump.
+ */
+struct inet_diag_msg;
+struct inet_diag_sockid;
+typedef int (netsnmp_inet_diag_cb)(const struct inet_diag_msg *msg,
+                                   void *ctx);
+
+void init_inet_diag(void);
+
+/*
+ * dump the sockets of a family (AF_INET, AF_INET6) and protocol
+ * (IPPROTO_TCP, IPPROTO_UDP) whose state is in states, a bit mask of
+ * (1 << kernel tcp state).
+ *
+ * @retval  0 : success
+ * @retval -1 : the dump failed part of the way, or the callback stopped it
+ * @retval -2 : sock_diag isn't available; nothing was passed to cb
+ */
+int netsnmp_inet_diag_dump(int family, int protocol, unsigned int states,
+                           netsnmp_inet_diag_cb *cb, void *ctx);
+
+/*
+ * look up the one socket with the addresses and ports in id (in network
+ * order, with idiag_cookie set to INET_DIAG_NOCOOKIE), and pass it to cb.
+ * The kernel may answer with a socket that only matches partially (a
+ * listener, say), so cb has to check.
+ *
+ * @retval  0 : success, or there is no such socket
+ * @retval -1 : the lookup failed
+ * @retval -2 : sock_diag isn't available, or can't tell; use a dump
+ */
+int netsnmp_inet_diag_get(int family, int protocol,
+                          const struct inet_diag_sockid *id,
+                          netsnmp_inet_diag_cb *cb, void *ctx);
+
+#endif /* NETSNMP_MIBGROUP_UTIL_FUNCS_INET_DIAG_H */
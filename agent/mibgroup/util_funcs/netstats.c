@@ -0,0 +1,197 @@
+/*
+ * util_funcs/netstats.c:  a shared snapshot of the kernel's protocol
+ * statistics.
+ *
+ * The mibII ip, icmp, tcp and udp groups and ipSystemStatsTable used to
+ * read and parse the kernel's statistics each for themselves, so a walk
+ * of mib-2 read the same files over and over.  They now all take their
+ * counters from one snapshot, which is read (by the arch loader) at most
+ * once every "netstatsInterval" seconds.
+ */
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+
+#include "util_funcs/MIB_STATS_CACHE_TIMEOUT.h"
+#include "netstats.h"
+
+#ifndef MIB_STATS_CACHE_TIMEOUT
+#define MIB_STATS_CACHE_TIMEOUT	5
+#endif
+
+static netsnmp_netstats  netstats;
+static netsnmp_cache    *netstats_cache = NULL;
+static int               netstats_interval = MIB_STATS_CACHE_TIMEOUT;
+
+static int
+_netstats_load(netsnmp_cache *cache, void *magic)
+{
+    int             i;
+
+    netstats.ngroups = 0;
+    netstats.nvalues = 0;
+    netstats.text_len = 0;
+    if (netsnmp_netstats_arch_load(&netstats) < 0) {
+        DEBUGMSGTL(("netstats", "load failed\n"));
+        return -1;
+    }
+
+    /*
+     * the names can only be pointed at now the text has stopped moving
+     */
+    for (i = 0; i < netstats.nvalues; i++)
+        netstats.names[i] = netstats.text + netstats.name_off[i];
+    netstats.generation++;
+    netstats.loaded = time(NULL);
+    DEBUGMSGTL(("netstats", "loaded %d counters in %d groups (%u)\n",
+                netstats.nvalues, netstats.ngroups, netstats.generation));
+    return 0;
+}
+
+static void
+_parse_interval(const char *token, char *line)
+{
+    int             interval = atoi(line);
+
+    if (interval < 0) {
+        config_perror("netstatsInterval can't be negative");
+        return;
+    }
+    netstats_interval = interval;
+    if (netstats_cache)
+        netstats_cache->timeout = interval ? interval : -1;
+}
+
+static void
+_free_interval(void)
+{
+    netstats_interval = MIB_STATS_CACHE_TIMEOUT;
+    if (netstats_cache)
+        netstats_cache->timeout = netstats_interval;
+}
+
+void
+init_netstats(void)
+{
+    netstats_cache = netsnmp_cache_create(netstats_interval, _netstats_load,
+                                          NULL, NULL, 0);
+    if (netstats_cache)
+        netstats_cache->flags |= NETSNMP_CACHE_DONT_FREE_EXPIRED;
+    snmpd_register_config_handler("netstatsInterval", _parse_interval,
+                                  _free_interval, "seconds");
+}
+
+const netsnmp_netstats *
+netsnmp_netstats_get(void)
+{
+    if (!netstats_cache)
+        return NULL;
+    netsnmp_cache_check_and_reload(netstats_cache);
+    return netstats_cache->valid ? &netstats : NULL;
+}
+
+const netsnmp_netstats_group *
+netsnmp_netstats_group_find(const netsnmp_netstats *stats, const char *group)
+{
+    int             i;
+
+    if (!stats)
+        return NULL;
+    for (i = 0; i < stats->ngroups; i++)
+        if (!strcmp(stats->groups[i].name, group))
+            return &stats->groups[i];
+    return NULL;
+}
+
+int
+netsnmp_netstats_value(const netsnmp_netstats *stats, const char *group,
+                       const char *name, unsigned long long *value)
+{
+    const netsnmp_netstats_group *g;
+    int             i;
+
+    g = netsnmp_netstats_group_find(stats, group);
+    if (!g)
+        return -1;
+    for (i = g->first; i < g->first + g->count; i++)
+        if (!strcmp(stats->names[i], name)) {
+            *value = stats->values[i];
+            return 0;
+        }
+    return -1;
+}
+
+int
+netsnmp_netstats_add_group(netsnmp_netstats *stats, const char *group,
+                           size_t len)
+{
+    netsnmp_netstats_group *g;
+
+    if (len >= sizeof(g->name))
+        return -1;
+    if (stats->ngroups == stats->groups_max) {
+        int             n = stats->groups_max ? 2 * stats->groups_max : 16;
+
+        g = (netsnmp_netstats_group *) realloc(stats->groups, n * sizeof(*g));
+        if (!g)
+            return -1;
+        stats->groups = g;
+        stats->groups_max = n;
+    }
+    g = &stats->groups[stats->ngroups++];
+    memcpy(g->name, group, len);
+    g->name[len] = '\0';
+    g->first = stats->nvalues;
+    g->count = 0;
+    return 0;
+}
+
+int
+netsnmp_netstats_add(netsnmp_netstats *stats, const char *name, size_t len,
+                     unsigned long long value)
+{
+    if (!stats->ngroups)
+        return -1;
+
+    if (stats->nvalues == stats->values_max) {
+        int             n = stats->values_max ? 2 * stats->values_max : 256;
+        const char    **names;
+        unsigned long long *values;
+        size_t         *off;
+
+        names = (const char **) realloc(stats->names, n * sizeof(*names));
+        if (names)
+            stats->names = names;
+        values = (unsigned long long *) realloc(stats->values,
+                                                n * sizeof(*values));
+        if (values)
+            stats->values = values;
+        off = (size_t *) realloc(stats->name_off, n * sizeof(*off));
+        if (off)
+            stats->name_off = off;
+        if (!names || !values || !off)
+            return -1;
+        stats->values_max = n;
+    }
+
+    if (stats->text_len + len + 1 > stats->text_max) {
+        size_t          n = stats->text_max ? 2 * stats->text_max : 8192;
+        char           *text;
+
+        while (n < stats->text_len + len + 1)
+            n *= 2;
+        text = (char *) realloc(stats->text, n);
+        if (!text)
+            return -1;
+        stats->text = text;
+        stats->text_max = n;
+    }
+
+    memcpy(stats->text + stats->text_len, name, len);
+    stats->text[stats->text_len + len] = '\0';
+    stats->name_off[stats->nvalues] = stats->text_len;
+    stats->text_len += len + 1;
+    stats->values[stats->nvalues++] = value;
+    stats->groups[stats->ngroups - 1].count++;
+    return 0;
+}
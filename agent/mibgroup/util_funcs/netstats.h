@@ -0,0 +1,95 @@
+/*
+ * util_funcs/netstats.h:  a shared snapshot of the kernel's protocol
+ * statistics (the ip, icmp, tcp and udp counters), read once per
+ * interval for all the modules that report them.
+ */
+#ifndef NETSNMP_MIBGROUP_UTIL_FUNCS_NETSTATS_H
+#define NETSNMP_MIBGROUP_UTIL_FUNCS_NETSTATS_H
+
+#if defined( linux )
+config_require(util_funcs/netstats_linux)
+#else
+config_error(the netstats snapshot is not available in this environment.)
+#endif
+
+/*
+ * The counters are kept in groups, named as the kernel names them
+ * ("Ip", "IpExt", "Icmp", "IcmpMsg", "Tcp", "Udp", "Ip6", "Icmp6",
+ * "Udp6" ...), each holding the counter names without the group prefix
+ * ("InReceives") and their values.  A group's counters are
+ * names[first] to names[first + count - 1], and likewise for values.
+ */
+typedef struct netsnmp_netstats_group_s {
+    char            name[16];
+    int             first;
+    int             count;
+} netsnmp_netstats_group;
+
+typedef struct netsnmp_netstats_s {
+    /*
+     * bumped on every reload, so users can tell whether they have
+     * already picked up this snapshot
+     */
+    unsigned int    generation;
+    time_t          loaded;
+
+    int             ngroups;
+    netsnmp_netstats_group *groups;
+
+    int             nvalues;
+    const char    **names;
+    unsigned long long *values;
+
+    /** private: kept from one load to the next */
+    int             groups_max;
+    int             values_max;
+    size_t         *name_off;
+    char           *text;
+    size_t          text_len;
+    size_t          text_max;
+} netsnmp_netstats;
+
+void init_netstats(void);
+
+/*
+ * the current snapshot, reloaded first if it is older than the
+ * "netstatsInterval", or NULL if the statistics couldn't be read at all
+ */
+const netsnmp_netstats *netsnmp_netstats_get(void);
+
+/*
+ * the (first) group with this name, or NULL
+ */
+const netsnmp_netstats_group *
+netsnmp_netstats_group_find(const netsnmp_netstats *stats,
+                            const char *group);
+
+/*
+ * look up one counter.
+ *
+ * @retval  0 : found; *value is set
+ * @retval -1 : there is no such group or counter
+ */
+int netsnmp_netstats_value(const netsnmp_netstats *stats,
+                           const char *group, const char *name,
+                           unsigned long long *value);
+
+/*
+ * for the arch loader: add a group, and a counter to the last group
+ * added.  The names are copied, and needn't be NUL terminated.
+ */
+int  netsnmp_netstats_add_group(netsnmp_netstats *stats,
+                                const char *group, size_t len);
+int  netsnmp_netstats_add(netsnmp_netstats *stats, const char *name,
+                          size_t len, unsigned long long value);
+
+/*
+ * the arch loader, which adds all the groups and counters there are to
+ * an empty snapshot.
+ *
+ * @retval  0 : success
+ * @retval -1 : nothing could be read
+ */
+int netsnmp_netstats_arch_load(netsnmp_netstats *stats);
+
+#endif /* NETSNMP_MIBGROUP_UTIL_FUNCS_NETSTATS_H */
@@ -0,0 +1,195 @@
+/*
+ * util_funcs/netstats_linux.c:  load the netstats snapshot from
+ * /proc/net/snmp, /proc/net/netstat and /proc/net/snmp6.
+ *
+ * The counters are matched up with the names in the header lines (or on
+ * the same line, in snmp6), rather than by position, so counters that
+ * newer kernels add don't upset the older ones.
+ */
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <ctype.h>
+
+#include "netstats.h"
+
+static char    *buf = NULL;
+static size_t   buf_max = 0;
+
+/*
+ * read all of a /proc file into buf, NUL terminated
+ */
+static ssize_t
+_netstats_read(const char *path)
+{
+    size_t          len = 0;
+    ssize_t         n;
+    int             fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        DEBUGMSGTL(("netstats:arch", "cannot open %s: %s\n", path,
+                    strerror(errno)));
+        return -1;
+    }
+    for (;;) {
+        if (len + 1 >= buf_max) {
+            size_t          max = buf_max ? 2 * buf_max : 16384;
+            char           *b = (char *) realloc(buf, max);
+
+            if (!b) {
+                close(fd);
+                return -1;
+            }
+            buf = b;
+            buf_max = max;
+        }
+        n = read(fd, buf + len, buf_max - len - 1);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        len += n;
+    }
+    close(fd);
+    if (n < 0)
+        return -1;
+    buf[len] = '\0';
+    return len;
+}
+
+static char *
+_next_line(char *p)
+{
+    p = strchr(p, '\n');
+    return p ? p + 1 : NULL;
+}
+
+/*
+ * /proc/net/snmp and /proc/net/netstat have pairs of lines, the names
+ * and then the values:
+ *
+ *   Udp: InDatagrams NoPorts InErrors OutDatagrams ...
+ *   Udp: 1491094 122 0 1466178 ...
+ */
+static int
+_netstats_load_pairs(netsnmp_netstats *stats, const char *path)
+{
+    char           *names, *values, *n, *v, *eol, *end;
+    size_t          glen, nlen;
+    unsigned long long val;
+
+    if (_netstats_read(path) < 0)
+        return -1;
+
+    for (names = buf; names && *names; names = _next_line(values)) {
+        values = _next_line(names);
+        if (!values)
+            break;
+        n = strchr(names, ':');
+        eol = strchr(names, '\n');
+        if (!n || (eol && n > eol)) {
+            values = names;
+            continue;
+        }
+        glen = n - names;
+        if (strncmp(values, names, glen + 1)) {
+            DEBUGMSGTL(("netstats:arch", "%s: no values for %.*s\n", path,
+                        (int) glen, names));
+            values = names;
+            continue;
+        }
+        if (netsnmp_netstats_add_group(stats, names, glen) < 0)
+            return -1;
+
+        n++;
+        v = values + glen + 1;
+        for (;;) {
+            while (*n == ' ')
+                n++;
+            while (*v == ' ')
+                v++;
+            if (*n == '\n' || *n == '\0' || *v == '\n' || *v == '\0')
+                break;
+            for (nlen = 0; n[nlen] && !isspace((unsigned char) n[nlen]);
+                 nlen++)
+                ;
+            /* a few values (Tcp MaxConn) can be -1 */
+            if (*v == '-')
+                val = (unsigned long long) strtoll(v, &end, 10);
+            else
+                val = strtoull(v, &end, 10);
+            if (end == v)
+                break;
+            if (netsnmp_netstats_add(stats, n, nlen, val) < 0)
+                return -1;
+            n += nlen;
+            v = end;
+        }
+    }
+    return 0;
+}
+
+/*
+ * /proc/net/snmp6 has a name and a value on each line, with the
+ * group name ("Ip6", "Icmp6", "Udp6", "UdpLite6") as a prefix:
+ *
+ *   Ip6InReceives                   	3
+ */
+static int
+_netstats_load_snmp6(netsnmp_netstats *stats, const char *path)
+{
+    const netsnmp_netstats_group *g = NULL;
+    char           *line, *six, *v, *end;
+    size_t          glen, nlen;
+    unsigned long long val;
+
+    if (_netstats_read(path) < 0)
+        return -1;
+
+    for (line = buf; line && *line; line = _next_line(line)) {
+        six = strchr(line, '6');
+        v = strpbrk(line, " \t\n");
+        if (!six || !v || six > v || *v == '\n')
+            continue;
+        glen = six + 1 - line;
+        nlen = v - six - 1;
+        if (glen >= sizeof(g->name))
+            continue;
+        val = strtoull(v, &end, 10);
+        if (end == v)
+            continue;
+        if (!g || strncmp(g->name, line, glen) || g->name[glen]) {
+            if (netsnmp_netstats_add_group(stats, line, glen) < 0)
+                return -1;
+            g = &stats->groups[stats->ngroups - 1];
+        }
+        if (netsnmp_netstats_add(stats, six + 1, nlen, val) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+int
+netsnmp_netstats_arch_load(netsnmp_netstats *stats)
+{
+    int             rc;
+
+    rc = _netstats_load_pairs(stats, "/proc/net/snmp");
+    if (rc < 0) {
+        NETSNMP_LOGONCE((LOG_ERR, "cannot read /proc/net/snmp\n"));
+        return rc;
+    }
+    /*
+     * these are missing from older (or ipv6-less) kernels
+     */
+    _netstats_load_pairs(stats, "/proc/net/netstat");
+    _netstats_load_snmp6(stats, "/proc/net/snmp6");
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * util_funcs/sampler.c:  sample the system statistics at a fixed
+ * interval, for the modules that work out rates and averages from them.
+ *
+ * The cpu, memory and diskio modules used to run an alarm each, and
+ * mostly parsed /proc again for every request.  They now register here,
+ * and are all sampled on the same tick, with the same timestamp, so the
+ * requests can be answered from the last sample.
+ */
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+
+#include "sampler.h"
+
+#define SAMPLER_DEFAULT_INTERVAL 5
+
+typedef struct sampler_s {
+    const char         *name;
+    netsnmp_sampler_cb *cb;
+    void               *ctx;
+    struct sampler_s   *next;
+} sampler;
+
+static sampler      *samplers = NULL;
+static int           sample_interval = SAMPLER_DEFAULT_INTERVAL;
+static unsigned int  sample_alarm = 0;
+
+static void
+_sample(unsigned int reg, void *clientarg)
+{
+    struct timeval  now;
+    sampler        *s;
+
+    gettimeofday(&now, NULL);
+    for (s = samplers; s; s = s->next) {
+        DEBUGMSGTL(("sampler", "sampling %s\n", s->name));
+        s->cb(&now, s->ctx);
+    }
+}
+
+static void
+_parse_interval(const char *token, char *line)
+{
+    int             interval = atoi(line);
+
+    if (interval < 1 || interval > 60) {
+        config_perror("sampleInterval must be between 1 and 60 seconds");
+        return;
+    }
+    sample_interval = interval;
+}
+
+static void
+_free_interval(void)
+{
+    sample_interval = SAMPLER_DEFAULT_INTERVAL;
+}
+
+/*
+ * (re)start the alarm with the configured interval, and take a first
+ * sample straight away
+ */
+static int
+_sampler_start(int majorID, int minorID, void *serverarg, void *clientarg)
+{
+    if (sample_alarm)
+        snmp_alarm_unregister(sample_alarm);
+    sample_alarm = 0;
+    if (!samplers)
+        return 0;
+
+    DEBUGMSGTL(("sampler", "sampling every %d seconds\n", sample_interval));
+    sample_alarm = snmp_alarm_register(sample_interval, SA_REPEAT,
+                                       _sample, NULL);
+    if (!sample_alarm)
+        snmp_log(LOG_ERR, "sampler: could not register alarm\n");
+    _sample(0, NULL);
+    return 0;
+}
+
+void
+init_sampler(void)
+{
+    snmpd_register_config_handler("sampleInterval", _parse_interval,
+                                  _free_interval, "seconds");
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY,
+                           SNMP_CALLBACK_POST_READ_CONFIG,
+                           _sampler_start, NULL);
+}
+
+int
+netsnmp_sampler_register(const char *name, netsnmp_sampler_cb *cb,
+                         void *ctx)
+{
+    sampler        *s, **last;
+
+    s = SNMP_MALLOC_TYPEDEF(sampler);
+    if (!s)
+        return -1;
+    s->name = name;
+    s->cb = cb;
+    s->ctx = ctx;
+    for (last = &samplers; *last; last = &(*last)->next)
+        ;
+    *last = s;
+    return 0;
+}
+
+int
+netsnmp_sampler_interval(void)
+{
+    return sample_interval;
+}
@@ -0,0 +1,28 @@
+/*
+ * util_funcs/sampler.h:  sample the system statistics at a fixed
+ * interval, for the modules that work out rates and averages from them.
+ */
+#ifndef NETSNMP_MIBGROUP_UTIL_FUNCS_SAMPLER_H
+#define NETSNMP_MIBGROUP_UTIL_FUNCS_SAMPLER_H
+
+/*
+ * called at each sample, with the time it was taken
+ */
+typedef void (netsnmp_sampler_cb)(const struct timeval *now, void *ctx);
+
+void init_sampler(void);
+
+/*
+ * take a sample with cb every "sampleInterval" seconds, starting once
+ * the configuration has been read.  The samplers run in the order they
+ * were registered.
+ */
+int  netsnmp_sampler_register(const char *name, netsnmp_sampler_cb *cb,
+                              void *ctx);
+
+/*
+ * the interval between samples, in seconds
+ */
+int  netsnmp_sampler_interval(void);
+
+#endif /* NETSNMP_MIBGROUP_UTIL_FUNCS_SAMPLER_H */
@@ -28,6 +28,7 @@
 #if HAVE_SYS_SELECT_H
 #include <sys/select.h>
 #endif
+#include <signal.h>
 
 #include <errno.h>
 
@@ -36,6 +37,7 @@
 #include <ucd-snmp/errormib.h>
 
 #include "struct.h"
+#include "execute.h"
 
 #define setPerrorstatus(x) snmp_log_perror(x)
 
@@ -405,3 +407,380 @@ run_exec_command( char *command, char *input,
     return run_shell_command( command, input, output, out_len );
 #endif
 }
+
+
+/*
+ * Commands run in the background, from the agent's main loop.
+ *
+ * The output is collected through register_readfd(), and the callback
+ * is given the result once the command has exited, or has been killed
+ * after its timeout.  At most exec_max_jobs commands run at once; the
+ * others wait their turn in exec_queue.
+ */
+struct netsnmp_exec_job_s {
+    char           *command;
+    char           *input;
+    int             shell;
+    int             timeout;
+    int             max_output;
+    netsnmp_exec_callback *callback;
+    void           *ctx;
+
+    pid_t           pid;
+    int             fd;
+    int             killed;
+    char           *output;
+    int             out_len;
+    int             out_max;
+    unsigned int    timer;          /* the timeout */
+    unsigned int    poll;           /* waiting for the child to exit */
+    long            poll_ms;
+    struct netsnmp_exec_job_s *next;
+};
+
+static netsnmp_exec_job *exec_running = NULL;
+static netsnmp_exec_job *exec_queue = NULL;
+static int      exec_num_running = 0;
+static int      exec_max_jobs = 4;
+
+static void     _exec_start_queued(void);
+
+void
+netsnmp_exec_set_max_jobs(int max_jobs)
+{
+    exec_max_jobs = (max_jobs > 0) ? max_jobs : 1;
+    _exec_start_queued();
+}
+
+static void
+_exec_job_free(netsnmp_exec_job *job)
+{
+    if (job->timer)
+        snmp_alarm_unregister(job->timer);
+    if (job->poll)
+        snmp_alarm_unregister(job->poll);
+    SNMP_FREE(job->command);
+    SNMP_FREE(job->input);
+    SNMP_FREE(job->output);
+    free(job);
+}
+
+static void
+_exec_unlink(netsnmp_exec_job **list, netsnmp_exec_job *job)
+{
+    for (; *list; list = &(*list)->next)
+        if (*list == job) {
+            *list = job->next;
+            job->next = NULL;
+            return;
+        }
+}
+
+#if HAVE_EXECV && HAVE_FORK
+static void     _exec_reap(netsnmp_exec_job *job);
+
+static void
+_exec_kill(netsnmp_exec_job *job)
+{
+    /*
+     * the child leads its own process group, which takes care of
+     * anything a shell command started as well
+     */
+    kill(-job->pid, SIGKILL);
+    kill(job->pid, SIGKILL);
+    job->killed = 1;
+}
+
+static void
+_exec_finish(netsnmp_exec_job *job, int status)
+{
+    int             result;
+
+    _exec_unlink(&exec_running, job);
+    exec_num_running--;
+
+    if (job->killed || status == -1)
+        result = -1;
+    else if (job->shell)
+        result = status;        /* as run_shell_command */
+    else
+        result = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    if (job->output)
+        job->output[job->out_len] = '\0';
+    DEBUGMSGTL(("run:async", "child %d finished: %d, %d bytes\n",
+                (int) job->pid, result, job->out_len));
+
+    job->callback(job->ctx, result, job->output, job->out_len);
+    _exec_job_free(job);
+    _exec_start_queued();
+}
+
+static void
+_exec_poll(unsigned int reg, void *clientarg)
+{
+    netsnmp_exec_job *job = (netsnmp_exec_job *) clientarg;
+
+    job->poll = 0;
+    _exec_reap(job);
+}
+
+/*
+ * The child has closed its output; it has usually exited by now too,
+ * but if not, look again a little later.
+ */
+static void
+_exec_reap(netsnmp_exec_job *job)
+{
+    struct timeval  tv;
+    int             status, rc;
+
+    rc = waitpid(job->pid, &status, WNOHANG);
+    if (rc == 0) {
+        job->poll_ms = job->poll_ms ? SNMP_MIN(2 * job->poll_ms, 1000) : 10;
+        tv.tv_sec = job->poll_ms / 1000;
+        tv.tv_usec = (job->poll_ms % 1000) * 1000;
+        job->poll = snmp_alarm_register_hr(tv, 0, _exec_poll, job);
+        if (job->poll)
+            return;
+        rc = waitpid(job->pid, &status, 0);
+    }
+    if (rc < 0) {
+        snmp_log_perror("waitpid");
+        status = -1;
+    }
+    _exec_finish(job, status);
+}
+
+static void
+_exec_read(int fd, void *clientarg)
+{
+    netsnmp_exec_job *job = (netsnmp_exec_job *) clientarg;
+    char            discard[4096];
+    ssize_t         n;
+
+    for (;;) {
+        if (job->out_len + 1 >= job->out_max &&
+            job->out_max < job->max_output) {
+            int             max = job->out_max ? 2 * job->out_max : 4096;
+            char           *p;
+
+            max = SNMP_MIN(max, job->max_output);
+            p = (char *) realloc(job->output, max);
+            if (p) {
+                job->output = p;
+                job->out_max = max;
+            }
+        }
+        if (job->out_len + 1 < job->out_max)
+            n = read(fd, job->output + job->out_len,
+                     job->out_max - job->out_len - 1);
+        else
+            n = read(fd, discard, sizeof(discard));     /* full */
+        if (n > 0) {
+            if (job->out_len + 1 < job->out_max)
+                job->out_len += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        break;                  /* EOF, or an error */
+    }
+
+    unregister_readfd(fd);
+    close(fd);
+    job->fd = -1;
+    _exec_reap(job);
+}
+
+static void
+_exec_timeout(unsigned int reg, void *clientarg)
+{
+    netsnmp_exec_job *job = (netsnmp_exec_job *) clientarg;
+
+    job->timer = 0;
+    snmp_log(LOG_WARNING, "command '%s' timed out after %d seconds\n",
+             job->command, job->timeout);
+    _exec_kill(job);
+}
+
+static int
+_exec_fork(netsnmp_exec_job *job)
+{
+    int             ipipe[2], opipe[2];
+    int             i, argc;
+    char          **argv;
+
+    if (pipe(ipipe) < 0) {
+        snmp_log_perror("pipe");
+        return -1;
+    }
+    if (pipe(opipe) < 0) {
+        snmp_log_perror("pipe");
+        close(ipipe[0]);
+        close(ipipe[1]);
+        return -1;
+    }
+
+    DEBUGMSGTL(("run:async", "running '%s'\n", job->command));
+    job->pid = fork();
+    if (job->pid == 0) {
+        /*
+         * Child process: stdin and stdout/err are the pipes
+         */
+        dup2(ipipe[0], 0);
+        dup2(opipe[1], 1);
+        dup2(opipe[1], 2);
+        for (i = getdtablesize()-1; i>2; i--)
+            close(i);
+        setpgid(0, 0);
+        if (job->shell) {
+            execl("/bin/sh", "sh", "-c", job->command, (char *) NULL);
+            perror("/bin/sh");
+        } else {
+            argv = tokenize_exec_command(job->command, &argc);
+            execv(argv[0], argv);
+            perror(argv[0]);
+        }
+        _exit(1);
+    }
+
+    close(ipipe[0]);
+    close(opipe[1]);
+    if (job->pid < 0) {
+        snmp_log_perror("fork");
+        close(ipipe[1]);
+        close(opipe[0]);
+        return -1;
+    }
+
+    /*
+     * the input is a DisplayString at most, so it fits in the pipe
+     */
+    if (job->input)
+        if (write(ipipe[1], job->input, strlen(job->input)) < 0)
+            DEBUGMSGTL(("run:async", "write to child: %s\n",
+                        strerror(errno)));
+    close(ipipe[1]);
+
+    job->fd = opipe[0];
+    fcntl(job->fd, F_SETFL, fcntl(job->fd, F_GETFL) | O_NONBLOCK);
+    if (register_readfd(job->fd, _exec_read, job) != FD_REGISTERED_OK) {
+        close(job->fd);
+        job->fd = -1;
+        _exec_kill(job);
+        waitpid(job->pid, NULL, 0);
+        return -1;
+    }
+    if (job->timeout > 0)
+        job->timer = snmp_alarm_register(job->timeout, 0, _exec_timeout, job);
+
+    job->next = exec_running;
+    exec_running = job;
+    exec_num_running++;
+    return 0;
+}
+
+static void
+_exec_start_queued(void)
+{
+    netsnmp_exec_job *job;
+
+    while (exec_queue && exec_num_running < exec_max_jobs) {
+        job = exec_queue;
+        exec_queue = job->next;
+        job->next = NULL;
+        if (_exec_fork(job) < 0) {
+            job->callback(job->ctx, -1, NULL, 0);
+            _exec_job_free(job);
+        }
+    }
+}
+
+netsnmp_exec_job *
+netsnmp_exec_start(const char *command, const char *input, int shell,
+                   int timeout, int max_output,
+                   netsnmp_exec_callback *callback, void *ctx)
+{
+    netsnmp_exec_job *job, **jp;
+
+    if (!command || !callback)
+        return NULL;
+    job = SNMP_MALLOC_TYPEDEF(netsnmp_exec_job);
+    if (!job)
+        return NULL;
+    job->command = strdup(command);
+    job->input = input ? strdup(input) : NULL;
+    job->shell = shell;
+    job->timeout = timeout;
+    job->max_output = (max_output > 0) ? max_output : NETSNMP_MAXCACHESIZE;
+    job->callback = callback;
+    job->ctx = ctx;
+    job->fd = -1;
+    if (!job->command || (input && !job->input)) {
+        _exec_job_free(job);
+        return NULL;
+    }
+
+    if (exec_num_running < exec_max_jobs) {
+        if (_exec_fork(job) < 0) {
+            _exec_job_free(job);
+            return NULL;
+        }
+    } else {
+        DEBUGMSGTL(("run:async", "queueing '%s'\n", command));
+        for (jp = &exec_queue; *jp; jp = &(*jp)->next)
+            ;
+        *jp = job;
+    }
+    return job;
+}
+
+void
+netsnmp_exec_cancel(netsnmp_exec_job *job)
+{
+    netsnmp_exec_job *j;
+
+    if (!job)
+        return;
+    for (j = exec_running; j && j != job; j = j->next)
+        ;
+    if (j) {
+        DEBUGMSGTL(("run:async", "cancelling child %d\n", (int) job->pid));
+        if (job->fd >= 0) {
+            unregister_readfd(job->fd);
+            close(job->fd);
+        }
+        _exec_kill(job);
+        waitpid(job->pid, NULL, 0);
+        _exec_unlink(&exec_running, job);
+        exec_num_running--;
+    } else
+        _exec_unlink(&exec_queue, job);
+    _exec_job_free(job);
+    _exec_start_queued();
+}
+
+#else /* HAVE_EXECV && HAVE_FORK */
+
+static void
+_exec_start_queued(void)
+{
+}
+
+netsnmp_exec_job *
+netsnmp_exec_start(const char *command, const char *input, int shell,
+                   int timeout, int max_output,
+                   netsnmp_exec_callback *callback, void *ctx)
+{
+    NETSNMP_LOGONCE((LOG_WARNING,
+                     "background commands are not supported here\n"));
+    return NULL;
+}
+
+void
+netsnmp_exec_cancel(netsnmp_exec_job *job)
+{
+}
+#endif /* HAVE_EXECV && HAVE_FORK */
@@ -8,4 +8,25 @@ int run_shell_command(char *command, char *input,
 int run_exec_command( char *command, char *input,
                       char *output,  int  *out_len);
 
+/*
+ * Run a command in the background.  The callback is called from the
+ * agent's main loop once the command has finished, with its result
+ * (as run_exec_command, or run_shell_command if shell is set; -1 if it
+ * couldn't be run or was killed after timeout seconds) and its output.
+ * The job (and the output) is freed when the callback returns.
+ *
+ * Returns NULL if the command couldn't be started; the callback is not
+ * called then.
+ */
+typedef struct netsnmp_exec_job_s netsnmp_exec_job;
+typedef void (netsnmp_exec_callback)(void *ctx, int result,
+                                     char *output, int out_len);
+
+netsnmp_exec_job *netsnmp_exec_start(const char *command, const char *input,
+                                     int shell, int timeout, int max_output,
+                                     netsnmp_exec_callback *callback,
+                                     void *ctx);
+void netsnmp_exec_cancel(netsnmp_exec_job *job);
+void netsnmp_exec_set_max_jobs(int max_jobs);
+
 #endif /* _MIBGROUP_EXECUTE_H */
@@ -50,6 +50,16 @@ netsnmp_parse_iqueryVersion(const char *token, char *line)
     }
 }
 
+void
+netsnmp_parse_iqueryDirect(const char *token, char *line)
+{
+    int direct;
+
+    if ((direct = netsnmp_ds_parse_boolean(line)) >= 0)
+        netsnmp_ds_set_boolean(NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_IQUERY_NO_DIRECT, !direct);
+}
+
   /*
    * Set up a default session for running internal queries.
    * This needs to be done before the config files are read,
@@ -107,6 +117,9 @@ void init_iquery(void){
     snmpd_register_config_handler("iquerySecLevel",
                                    netsnmp_parse_iquerySecLevel, NULL,
                                    "noAuthNoPriv | authNoPriv | authPriv");
+    snmpd_register_config_handler("iqueryDirect",
+                                   netsnmp_parse_iqueryDirect, NULL,
+                                   "yes | no");
 
     /*
      * Set defaults
@@ -122,6 +135,11 @@ void init_iquery(void){
     snmp_register_callback(SNMP_CALLBACK_LIBRARY, 
                            SNMP_CALLBACK_POST_READ_CONFIG,
                            _tweak_default_iquery_session, NULL);
+
+    /*
+     * Run internal queries within the agent (see "iqueryDirect")
+     */
+    netsnmp_query_set_direct_handler(netsnmp_agent_direct_query);
 }
 
     /**************************
@@ -199,7 +217,8 @@ netsnmp_session *netsnmp_iquery_session(char* secName,   int   version,
             ss->community_len = strlen(secName);
         }
         ss->myvoid = netsnmp_check_outstanding_agent_requests;
-        ss->flags |= SNMP_FLAGS_RESP_CALLBACK | SNMP_FLAGS_DONT_PROBE;
+        ss->flags |= SNMP_FLAGS_RESP_CALLBACK | SNMP_FLAGS_DONT_PROBE |
+                     SNMP_FLAGS_IQUERY;
     }
 #endif
 
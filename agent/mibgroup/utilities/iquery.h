@@ -9,6 +9,12 @@ config_error(utilities/iquery depends on the Callback transport)
 
 void init_iquery(void);
 
+/*
+ * Queries on these sessions are run within the agent (unless
+ * "iqueryDirect no" is configured).  A caller can add
+ * SNMP_FLAGS_IQUERY_NOVACM to the session flags to skip access control.
+ */
+
 netsnmp_session *netsnmp_iquery_user_session(      char* secName);
 netsnmp_session *netsnmp_iquery_community_session( char* community, int version );
 netsnmp_session *netsnmp_iquery_pdu_session(netsnmp_pdu* pdu);
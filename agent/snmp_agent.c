@@ -225,6 +225,20 @@ netsnmp_agent_session *netsnmp_processing_set = NULL;
 netsnmp_agent_session *agent_delegated_list = NULL;
 netsnmp_agent_session *netsnmp_agent_queued_list = NULL;
 
+/*
+ * Internal queries (netsnmp_query_get() and friends) are handed straight
+ * to netsnmp_handle_request(), rather than being passed through the
+ * callback transport.  The response is returned by netsnmp_wrap_up_request
+ * via the agent session's 'direct' pointer.
+ */
+struct netsnmp_direct_query_s {
+    int             waiting;
+    netsnmp_pdu    *response;
+};
+
+/* for delegated requests whose caller has timed out */
+static struct netsnmp_direct_query_s _direct_abandoned;
+
 
 int             netsnmp_agent_check_packet(netsnmp_session *,
                                            struct netsnmp_transport_s *,
@@ -1430,6 +1444,8 @@ free_agent_snmp_session(netsnmp_agent_session *asp)
     DEBUGMSGTL(("snmp_agent","agent_session %8p released\n", asp));
 
     netsnmp_remove_from_delegated(asp);
+    if (asp->direct)
+        asp->direct->waiting = 0;
     
     DEBUGMSGTL(("verbose:asp", "asp %p reqinfo %p freed\n",
                 asp, asp->reqinfo));
@@ -1795,6 +1811,20 @@ netsnmp_wrap_up_request(netsnmp_agent_session *asp, int status)
         asp->pdu->command = SNMP_MSG_RESPONSE;
         asp->pdu->errstat = asp->status;
         asp->pdu->errindex = asp->index;
+        if (asp->direct) {
+            /*
+             * an internal query: hand the response straight back
+             *   (unless the caller has given up waiting for it)
+             */
+            if (asp->direct->waiting) {
+                asp->direct->response = asp->pdu;
+                asp->direct->waiting = 0;
+            } else
+                snmp_free_pdu(asp->pdu);
+            asp->pdu = NULL;
+            netsnmp_remove_and_free_agent_snmp_session(asp);
+            return 1;
+        }
         if (!snmp_send(asp->session, asp->pdu) &&
              asp->session->s_snmp_errno != SNMPERR_SUCCESS) {
             netsnmp_variable_list *var_ptr;
@@ -2000,6 +2030,167 @@ handle_snmp_packet(int op, netsnmp_session * session, int reqid,
     return rc;
 }
 
+/*
+ * Wait for a delegated internal query to complete, processing other
+ * sessions (but not alarms) in the meantime, as snmp_synch_response does.
+ */
+static int
+_direct_query_wait(netsnmp_session *ss, netsnmp_agent_session *asp,
+                   struct netsnmp_direct_query_s *dq)
+{
+    netsnmp_large_fd_set fdset;
+    struct timeval  timeout, deadline, now, *tvp;
+    int             numfds, count, block;
+    int             status = STAT_SUCCESS;
+
+    gettimeofday(&deadline, NULL);
+    timeout.tv_sec  = ss->timeout / 1000000L;
+    timeout.tv_usec = ss->timeout % 1000000L;
+    NETSNMP_TIMERADD(&deadline, &timeout, &deadline);
+    netsnmp_large_fd_set_init(&fdset, FD_SETSIZE);
+
+    while (dq->waiting) {
+        gettimeofday(&now, NULL);
+        if (ss->timeout > 0 && !timercmp(&now, &deadline, <)) {
+            DEBUGMSGTL(("snmp_agent", "internal query timed out, asp = %8p\n",
+                        asp));
+            asp->direct = &_direct_abandoned;
+            status = STAT_TIMEOUT;
+            break;
+        }
+        numfds = 0;
+        NETSNMP_LARGE_FD_ZERO(&fdset);
+        block = NETSNMP_SNMPBLOCK;
+        tvp = &timeout;
+        timerclear(tvp);
+        snmp_sess_select_info2_flags(NULL, &numfds, &fdset, tvp, &block,
+                                     NETSNMP_SELECT_NOALARMS);
+        if (ss->timeout > 0) {
+            NETSNMP_TIMERSUB(&deadline, &now, &now);
+            if (block || timercmp(&now, tvp, <))
+                *tvp = now;
+        } else if (block)
+            tvp = NULL;
+        count = netsnmp_large_fd_set_select(numfds, &fdset, NULL, NULL, tvp);
+        if (count > 0)
+            snmp_read2(&fdset);
+        else if (count == 0)
+            snmp_timeout();
+        else if (errno != EINTR) {
+            snmp_log_perror("select");
+            asp->direct = &_direct_abandoned;
+            status = STAT_ERROR;
+            break;
+        }
+        netsnmp_check_outstanding_agent_requests();
+    }
+    netsnmp_large_fd_set_cleanup(&fdset);
+    return status;
+}
+
+/**
+ * Run a request from an internal query session within the agent,
+ * without encoding it or passing it through the callback transport.
+ * This has the same calling conventions as snmp_synch_response, and is
+ * registered with netsnmp_query_set_direct_handler() by utilities/iquery.
+ *
+ * Access control is applied as for a request received over the callback
+ * transport, unless the session is flagged with SNMP_FLAGS_IQUERY_NOVACM.
+ *
+ * SET requests which would have to wait for others to complete (and any
+ * request while a SET is being processed) are sent via the transport as
+ * before, so that they are queued in the usual way.
+ */
+int
+netsnmp_agent_direct_query(netsnmp_session *ss, netsnmp_pdu *pdu,
+                           netsnmp_pdu **response)
+{
+    struct netsnmp_direct_query_s dq;
+    netsnmp_agent_session *asp;
+    int             access_ret;
+
+    *response = NULL;
+    if (netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_IQUERY_NO_DIRECT) ||
+        netsnmp_processing_set || netsnmp_agent_queued_list
+#ifndef NETSNMP_NO_WRITE_SUPPORT
+        || (pdu->command == SNMP_MSG_SET && agent_delegated_list)
+#endif /* NETSNMP_NO_WRITE_SUPPORT */
+        )
+        return snmp_synch_response(ss, pdu, response);
+
+    /*
+     * Fill in what snmp_send() would have taken from the session
+     */
+    if (pdu->version == SNMP_DEFAULT_VERSION)
+        pdu->version = ss->version;
+    if (pdu->errstat == SNMP_DEFAULT_ERRSTAT)
+        pdu->errstat = 0;
+    if (pdu->errindex == SNMP_DEFAULT_ERRINDEX)
+        pdu->errindex = 0;
+    if (pdu->version == SNMP_VERSION_3) {
+        if (pdu->securityNameLen == 0 && ss->securityNameLen) {
+            pdu->securityName = netsnmp_strdup_and_null(
+                (u_char *) ss->securityName, ss->securityNameLen);
+            pdu->securityNameLen = ss->securityNameLen;
+        }
+        if (pdu->securityModel == SNMP_DEFAULT_SECMODEL)
+            pdu->securityModel = ss->securityModel;
+        if (pdu->securityLevel == 0)
+            pdu->securityLevel = ss->securityLevel;
+    } else if (pdu->community_len == 0 && ss->community_len) {
+        memdup(&pdu->community, ss->community, ss->community_len);
+        pdu->community_len = ss->community_len;
+    }
+    pdu->reqid = snmp_get_next_reqid();
+    pdu->msgid = snmp_get_next_msgid();
+    pdu->transid = snmp_get_next_transid();
+
+    DEBUGMSGTL(("snmp_agent", "internal query on session %8p\n", ss));
+    asp = init_agent_snmp_session(ss, pdu);
+    snmp_free_pdu(pdu);
+    if (asp == NULL)
+        return STAT_ERROR;
+
+    if ((access_ret = check_access(asp->pdu)) != 0) {
+        if (access_ret == VACM_NOSUCHCONTEXT)
+            snmp_increment_statistic(STAT_SNMPUNKNOWNCONTEXTS);
+        else
+            send_easy_trap(SNMP_TRAP_AUTHFAIL, 0);
+        if (access_ret == VACM_NOSUCHCONTEXT ||
+            asp->pdu->version != SNMP_VERSION_3) {
+            /*
+             * dropped: the caller would have timed out
+             */
+            netsnmp_remove_and_free_agent_snmp_session(asp);
+            return STAT_TIMEOUT;
+        }
+        asp->pdu->errstat = SNMP_ERR_AUTHORIZATIONERROR;
+        asp->pdu->command = SNMP_MSG_RESPONSE;
+        *response = asp->pdu;
+        asp->pdu = NULL;
+        netsnmp_remove_and_free_agent_snmp_session(asp);
+        return STAT_SUCCESS;
+    }
+
+    dq.waiting = 1;
+    dq.response = NULL;
+    asp->direct = &dq;
+    netsnmp_handle_request(asp, SNMP_ERR_NOERROR);
+    if (dq.waiting) {
+        /*
+         * delegated: asp is still live until the request completes
+         */
+        int status = _direct_query_wait(ss, asp, &dq);
+        if (status != STAT_SUCCESS)
+            return status;
+    }
+    if (dq.response == NULL)
+        return STAT_ERROR;
+    *response = dq.response;
+    return STAT_SUCCESS;
+}
+
 netsnmp_request_info *
 netsnmp_add_varbind_to_cache(netsnmp_agent_session *asp, int vbcount,
                              netsnmp_variable_list * varbind_ptr,
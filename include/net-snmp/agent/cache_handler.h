@@ -70,6 +70,20 @@ extern          "C" {
     };
 
 
+    /*
+     * the part of a table that the request loading a cache needs,
+     * see netsnmp_cache_hint_range()
+     */
+    typedef struct netsnmp_cache_range_s {
+        /** 1: only the row with this index, 0: the first row after it */
+        int           exact;
+        netsnmp_index index;
+        oid           index_oid[MAX_OID_LEN];
+    } netsnmp_cache_range;
+
+    int netsnmp_cache_hint_range(netsnmp_cache *cache,
+                                 netsnmp_cache_range *range);
+
     void netsnmp_cache_reqinfo_insert(netsnmp_cache* cache,
                                       netsnmp_agent_request_info * reqinfo,
                                       const char *name);
@@ -120,6 +134,7 @@ extern          "C" {
 #define NETSNMP_CACHE_PRELOAD                               0x0010
 #define NETSNMP_CACHE_AUTO_RELOAD                           0x0020
 #define NETSNMP_CACHE_RESET_TIMER_ON_USE                    0x0040
+#define NETSNMP_CACHE_PARTIAL_LOAD                          0x0080
 
 #define NETSNMP_CACHE_HINT_HANDLER_ARGS                     0x1000
 
@@ -36,6 +36,7 @@
 #define NETSNMP_DS_AGENT_DISKIO_NO_FD   18      /* 1 = don't report /dev/fd*   entries in diskIOTable */
 #define NETSNMP_DS_AGENT_DISKIO_NO_LOOP 19      /* 1 = don't report /dev/loop* entries in diskIOTable */
 #define NETSNMP_DS_AGENT_DISKIO_NO_RAM  20      /* 1 = don't report /dev/ram*  entries in diskIOTable */
+#define NETSNMP_DS_AGENT_IQUERY_NO_DIRECT 21    /* 1 = internal queries via the callback transport */
 
 /* WARNING: The trap receiver also uses DS flags and must not conflict with these!
  * If you define additional boolean entries, check in "apps/snmptrapd_ds.h" first */
@@ -70,5 +71,8 @@
 #define NETSNMP_DS_AGENT_INTERNAL_SECLEVEL 12   /* used by internal queries */
 #define NETSNMP_DS_AGENT_MAX_GETBULKREPEATS 13 /* max getbulk repeats */
 #define NETSNMP_DS_AGENT_MAX_GETBULKRESPONSES 14   /* max getbulk respones */
+#define NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING 15 /* per subagent window */
+#define NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MIN 16     /* adaptive timeout */
+#define NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MAX 17     /*     bounds (usec) */
 
 #endif
@@ -15,6 +15,25 @@ struct netsnmp_cpu_history {
      unsigned long long swpo_hist;
      unsigned long long pagei_hist;
      unsigned long long pageo_hist;
+
+     unsigned long long time_hist;      /* msec, when it was taken */
+};
+
+                 /* Worked out over the last minute, as each sample is taken */
+struct netsnmp_cpu_rates {
+     int  valid;                        /* there are two samples to compare */
+     unsigned long long total;          /* ticks between them */
+
+     long user;                         /* percentages */
+     long sys;
+     long idle;
+
+     unsigned long long ctx;            /* per second */
+     unsigned long long intr;
+     unsigned long long swpi;
+     unsigned long long swpo;
+     unsigned long long pagei;
+     unsigned long long pageo;
 };
 
 struct netsnmp_cpu_info_s {
@@ -50,7 +69,8 @@ struct netsnmp_cpu_info_s {
      unsigned long long nInterrupts;
      unsigned long long nCtxSwitches;
 
-     struct netsnmp_cpu_history *history;
+     struct netsnmp_cpu_history *history;   /* a ring of recent samples */
+     struct netsnmp_cpu_rates    rates;
 
      netsnmp_cpu_info *next;
 };
@@ -64,5 +84,7 @@ netsnmp_cpu_info *netsnmp_cpu_get_next( netsnmp_cpu_info* );
 netsnmp_cpu_info *netsnmp_cpu_get_byIdx(  int,   int );
 netsnmp_cpu_info *netsnmp_cpu_get_byName( char*, int );
 
+struct netsnmp_cpu_history *netsnmp_cpu_get_history( netsnmp_cpu_info* );
+
 netsnmp_cache *netsnmp_cpu_get_cache( void );
 int netsnmp_cpu_load( void );
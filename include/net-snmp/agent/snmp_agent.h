@@ -205,6 +205,11 @@ extern          "C" {
         int             treecache_num;  /* number of current cache entries */
         netsnmp_cachemap *cache_store;
         int             vbcount;
+
+        /*
+         * set for internal queries run in-process
+         */
+        struct netsnmp_direct_query_s *direct;
     } netsnmp_agent_session;
 
     /*
@@ -221,6 +226,9 @@ extern          "C" {
      */
     int             handle_snmp_packet(int, netsnmp_session *, int,
                                        netsnmp_pdu *, void *);
+    int             netsnmp_agent_direct_query(netsnmp_session *,
+                                               netsnmp_pdu *,
+                                               netsnmp_pdu **);
     void            snmp_agent_parse_config(char *, char *);
     netsnmp_agent_session *init_agent_snmp_session(netsnmp_session *,
                                                    netsnmp_pdu *);
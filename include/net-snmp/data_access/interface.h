@@ -234,6 +234,21 @@ void netsnmp_access_interface_container_free(netsnmp_container *container,
 #define NETSNMP_ACCESS_INTERFACE_FREE_NOFLAGS               0x0000
 #define NETSNMP_ACCESS_INTERFACE_FREE_DONT_CLEAR            0x0001
 
+/*
+ * interface change notifications. The hook owns the entry it is
+ * passed. After _RESYNC (entry is NULL), changes were lost and the
+ * caller should reload.
+ */
+typedef void (NetsnmpAccessInterfaceChange)(int change,
+                                            netsnmp_interface_entry *entry,
+                                            void *ctx);
+#define NETSNMP_ACCESS_INTERFACE_CHANGE_UPDATE              1
+#define NETSNMP_ACCESS_INTERFACE_CHANGE_DELETE              2
+#define NETSNMP_ACCESS_INTERFACE_CHANGE_RESYNC              3
+
+int netsnmp_access_interface_changes_start(NetsnmpAccessInterfaceChange *hook,
+                                           void *ctx);
+void netsnmp_access_interface_changes_stop(void);
 
 /*
  * create/free an ifentry
@@ -99,6 +99,7 @@ netsnmp_access_route_container_load(netsnmp_container* container,
                                     u_int load_flags);
 #define NETSNMP_ACCESS_ROUTE_LOAD_NOFLAGS               0x0000
 #define NETSNMP_ACCESS_ROUTE_LOAD_IPV4_ONLY             0x0001
+#define NETSNMP_ACCESS_ROUTE_LOAD_MAIN_TABLE_ONLY       0x0002
 
 void netsnmp_access_route_container_free(netsnmp_container *container,
                                          u_int free_flags);
@@ -106,6 +107,25 @@ void netsnmp_access_route_container_free(netsnmp_container *container,
 #define NETSNMP_ACCESS_ROUTE_FREE_DONT_CLEAR            0x0001
 #define NETSNMP_ACCESS_ROUTE_FREE_KEEP_CONTAINER        0x0002
 
+/*
+ * route change notifications. The hook owns the entry it is passed.
+ * _REPLACE removes the routes to the same destination and prefix length
+ * in the same table (see the policy) with the same metric1, before
+ * adding entry. After _RESYNC (entry is NULL), changes were lost and
+ * the caller should reload.
+ */
+typedef void (NetsnmpAccessRouteChange)(int change,
+                                        netsnmp_route_entry *entry,
+                                        void *ctx);
+#define NETSNMP_ACCESS_ROUTE_CHANGE_UPDATE                  1
+#define NETSNMP_ACCESS_ROUTE_CHANGE_DELETE                  2
+#define NETSNMP_ACCESS_ROUTE_CHANGE_RESYNC                  3
+#define NETSNMP_ACCESS_ROUTE_CHANGE_REPLACE                 4
+
+int netsnmp_access_route_changes_start(NetsnmpAccessRouteChange *hook,
+                                       void *ctx);
+void netsnmp_access_route_changes_stop(void);
+
 
 /*
  * create/copy/free a route entry
@@ -51,6 +51,13 @@ extern "C" {
          */
         int32_t         hrSWRunPerfCPU;
         int32_t         hrSWRunPerfMem;
+
+        /*
+         * for incremental loads: when the process started, in the
+         * architecture's units, and the last load that found it
+         */
+        u_long          start_time;
+        u_int           generation;
         
     } netsnmp_swrun_entry;
 
@@ -92,7 +99,12 @@ extern "C" {
 #define NETSNMP_SWRUN_NOFLAGS            0x00000000
 #define NETSNMP_SWRUN_ALL_OR_NONE        0x00000001
 #define NETSNMP_SWRUN_DONT_FREE_ITEMS    0x00000002
-/*#define NETSNMP_SWRUN_xx                0x00000004 */
+/*
+ * update the entries already in the container, and only read the
+ * static columns of new processes (NETSNMP_ACCESS_SWRUN_HAVE_INCREMENTAL)
+ */
+#define NETSNMP_SWRUN_INCREMENTAL        0x00000004
+/*#define NETSNMP_SWRUN_xx                0x00000008 */
 
 #ifdef  __cplusplus
 }
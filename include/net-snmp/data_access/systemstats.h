@@ -66,12 +66,24 @@ netsnmp_container * netsnmp_access_systemstats_container_init(u_int init_flags);
 /**
  * Load container. If the NETSNMP_ACCESS_SYSTEMSTATS_LOAD_IFTABLE is set
  * the ipIfSystemStats table is loaded, else ipSystemStatsTable is loaded.
+ * If NETSNMP_ACCESS_SYSTEMSTATS_LOAD_INDEXES is also set, the entries
+ * only have their indexes, and the statistics of each can be loaded
+ * later with netsnmp_access_systemstats_entry_load.
  */
 netsnmp_container*
 netsnmp_access_systemstats_container_load(netsnmp_container* container,
                                     u_int load_flags);
 #define NETSNMP_ACCESS_SYSTEMSTATS_LOAD_NOFLAGS               0x0000
 #define NETSNMP_ACCESS_SYSTEMSTATS_LOAD_IFTABLE               0x0001 
+#define NETSNMP_ACCESS_SYSTEMSTATS_LOAD_INDEXES               0x0002
+
+/**
+ * Load the statistics of one entry (for one interface, with
+ * NETSNMP_ACCESS_SYSTEMSTATS_LOAD_IFTABLE).
+ */
+int
+netsnmp_access_systemstats_entry_load(netsnmp_systemstats_entry *entry,
+                                      u_int load_flags);
 
 void netsnmp_access_systemstats_container_free(netsnmp_container *container,
                                          u_int free_flags);
@@ -76,6 +76,26 @@ extern          "C" {
 #define NETSNMP_ACCESS_TCPCONN_LOAD_ONLYLISTEN            0x0002
 #define NETSNMP_ACCESS_TCPCONN_LOAD_IPV4_ONLY             0x0004
 
+/*
+ * load only the one connection a request needs: the one with the
+ * addresses and ports of exact, or else the first one after the index
+ * after, in the order of the indexes that index() makes. index() fills
+ * in index->oids, which has room for index->len oids, sets index->len
+ * and returns 0. Returns NULL if the arch can't do this.
+ */
+    typedef int (NetsnmpAccessTcpconnIndex)(netsnmp_tcpconn_entry *entry,
+                                            netsnmp_index *index);
+    typedef struct netsnmp_tcpconn_filter_s {
+        netsnmp_tcpconn_entry     *exact;
+        const netsnmp_index       *after;
+        NetsnmpAccessTcpconnIndex *index;
+    } netsnmp_tcpconn_filter;
+
+    netsnmp_container*
+    netsnmp_access_tcpconn_container_load_filter(netsnmp_container* container,
+                                                 u_int load_flags,
+                                                 netsnmp_tcpconn_filter *filter);
+
     void netsnmp_access_tcpconn_container_free(netsnmp_container *container,
                                                u_int free_flags);
 #define NETSNMP_ACCESS_TCPCONN_FREE_NOFLAGS               0x0000
@@ -65,6 +65,26 @@ extern          "C" {
                                           u_int load_flags);
 #define NETSNMP_ACCESS_UDP_ENDPOINT_LOAD_NOFLAGS               0x0000
 
+/*
+ * load only the one endpoint a request needs: the one with the
+ * addresses, ports and instance of exact, or else the first one after
+ * the index after, in the order of the indexes that index() makes (see
+ * netsnmp_tcpconn_filter). index() is called before the endpoint's pid
+ * is known. Returns NULL if the arch can't do this.
+ */
+    typedef int (NetsnmpAccessUdpEndpointIndex)(netsnmp_udp_endpoint_entry *e,
+                                                netsnmp_index *index);
+    typedef struct netsnmp_udp_endpoint_filter_s {
+        netsnmp_udp_endpoint_entry    *exact;
+        const netsnmp_index           *after;
+        NetsnmpAccessUdpEndpointIndex *index;
+    } netsnmp_udp_endpoint_filter;
+
+    netsnmp_container*
+    netsnmp_access_udp_endpoint_container_load_filter(netsnmp_container* c,
+                                                      u_int load_flags,
+                                                      netsnmp_udp_endpoint_filter *filter);
+
     void netsnmp_access_udp_endpoint_container_free(netsnmp_container *c,
                                                u_int free_flags);
 #define NETSNMP_ACCESS_UDP_ENDPOINT_FREE_NOFLAGS               0x0000
@@ -0,0 +1,44 @@
+#ifndef _SNMPSHMDOMAIN_H
+#define _SNMPSHMDOMAIN_H
+
+#ifdef NETSNMP_TRANSPORT_SHM_DOMAIN
+
+#if !defined(linux)
+    config_error(Shared memory transport support is only available for Linux)
+#endif
+
+#include <net-snmp/library/snmp_transport.h>
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+/*
+ * The shared memory transport domain is a private Net-SNMP domain
+ * (netSnmpShmDomain in NET-SNMP-TC).
+ *
+ * A "shm:/name" server listens on the abstract Unix domain socket
+ * "net-snmp-shm:/name".  A client connects to it and hands over a shared
+ * memory region holding one ring buffer for each direction, plus an
+ * eventfd for each end; after that the socket is only used to notice
+ * that the other end has gone away.  This is only useful between
+ * processes on the same host, e.g. an AgentX master and its subagents.
+ */
+
+#define TRANSPORT_DOMAIN_SHM	1,3,6,1,4,1,8072,3,3,11
+NETSNMP_IMPORT oid netsnmp_ShmDomain[];
+
+netsnmp_transport *netsnmp_shm_transport(const char *name, int local);
+
+/*
+ * "Constructor" for transport domain object.
+ */
+
+void            netsnmp_shm_ctor(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif                          /* NETSNMP_TRANSPORT_SHM_DOMAIN */
+
+#endif                          /* _SNMPSHMDOMAIN_H */
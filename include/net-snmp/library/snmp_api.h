@@ -160,6 +160,8 @@ typedef struct request_list {
 
 #define SNMP_DETAIL_SIZE        512
 
+#define SNMP_FLAGS_IQUERY_NOVACM   0x2000     /* internal queries bypass VACM */
+#define SNMP_FLAGS_IQUERY          0x1000     /* internal (in-process) queries */
 #define SNMP_FLAGS_UDP_BROADCAST   0x800
 #define SNMP_FLAGS_RESP_CALLBACK   0x400      /* Additional callback on response */
 #define SNMP_FLAGS_USER_CREATED    0x200      /* USM user has been created */
@@ -95,6 +95,9 @@ netsnmp_session * netsnmp_query_get_default_session_unchecked( void );
 NETSNMP_IMPORT
 netsnmp_session * netsnmp_query_get_default_session( void );
 NETSNMP_IMPORT
+void netsnmp_query_set_direct_handler(int (*)(netsnmp_session *,
+                                              netsnmp_pdu *, netsnmp_pdu **));
+NETSNMP_IMPORT
 int netsnmp_query_get(     netsnmp_variable_list *, netsnmp_session *);
 NETSNMP_IMPORT
 int netsnmp_query_getnext( netsnmp_variable_list *, netsnmp_session *);
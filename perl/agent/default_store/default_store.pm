@@ -33,6 +33,13 @@ use vars qw(@ISA %EXPORT_TAGS @EXPORT_OK @EXPORT $VERSION $AUTOLOAD);
 				   NETSNMP_DS_AGENT_DONT_RETAIN_NOTIFICATIONS
 				   NETSNMP_DS_AGENT_DONT_LOG_TCPWRAPPERS_CONNECTS
 				   NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES
+				   NETSNMP_DS_AGENT_REALSTORAGEUNITS
+				   NETSNMP_DS_APP_NUMERIC_IP
+				   NETSNMP_DS_APP_NO_AUTHORIZATION
+				   NETSNMP_DS_AGENT_DISKIO_NO_FD
+				   NETSNMP_DS_AGENT_DISKIO_NO_LOOP
+				   NETSNMP_DS_AGENT_DISKIO_NO_RAM
+				   NETSNMP_DS_AGENT_IQUERY_NO_DIRECT
 				   NETSNMP_DS_AGENT_PROGNAME
 				   NETSNMP_DS_AGENT_X_SOCKET
 				   NETSNMP_DS_AGENT_PORTS
@@ -40,6 +47,7 @@ use vars qw(@ISA %EXPORT_TAGS @EXPORT_OK @EXPORT $VERSION $AUTOLOAD);
 				   NETSNMP_DS_AGENT_PERL_INIT_FILE
 				   NETSNMP_DS_SMUX_SOCKET
 				   NETSNMP_DS_NOTIF_LOG_CTX
+				   NETSNMP_DS_AGENT_TRAP_ADDR
 				   NETSNMP_DS_AGENT_FLAGS
 				   NETSNMP_DS_AGENT_USERID
 				   NETSNMP_DS_AGENT_GROUPID
@@ -55,6 +63,9 @@ use vars qw(@ISA %EXPORT_TAGS @EXPORT_OK @EXPORT $VERSION $AUTOLOAD);
 				   NETSNMP_DS_AGENT_INTERNAL_SECLEVEL
 				   NETSNMP_DS_AGENT_MAX_GETBULKREPEATS
 				   NETSNMP_DS_AGENT_MAX_GETBULKRESPONSES
+				   NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING
+				   NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MIN
+				   NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MAX
 ) ] );
 
 @EXPORT_OK = ( @{ $EXPORT_TAGS{'all'} } );
@@ -73,6 +84,13 @@ use vars qw(@ISA %EXPORT_TAGS @EXPORT_OK @EXPORT $VERSION $AUTOLOAD);
 				   NETSNMP_DS_AGENT_DONT_RETAIN_NOTIFICATIONS
 				   NETSNMP_DS_AGENT_DONT_LOG_TCPWRAPPERS_CONNECTS
 				   NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES
+				   NETSNMP_DS_AGENT_REALSTORAGEUNITS
+				   NETSNMP_DS_APP_NUMERIC_IP
+				   NETSNMP_DS_APP_NO_AUTHORIZATION
+				   NETSNMP_DS_AGENT_DISKIO_NO_FD
+				   NETSNMP_DS_AGENT_DISKIO_NO_LOOP
+				   NETSNMP_DS_AGENT_DISKIO_NO_RAM
+				   NETSNMP_DS_AGENT_IQUERY_NO_DIRECT
 				   NETSNMP_DS_AGENT_PROGNAME
 				   NETSNMP_DS_AGENT_X_SOCKET
 				   NETSNMP_DS_AGENT_PORTS
@@ -80,6 +98,7 @@ use vars qw(@ISA %EXPORT_TAGS @EXPORT_OK @EXPORT $VERSION $AUTOLOAD);
 				   NETSNMP_DS_AGENT_PERL_INIT_FILE
 				   NETSNMP_DS_SMUX_SOCKET
 				   NETSNMP_DS_NOTIF_LOG_CTX
+				   NETSNMP_DS_AGENT_TRAP_ADDR
 				   NETSNMP_DS_AGENT_FLAGS
 				   NETSNMP_DS_AGENT_USERID
 				   NETSNMP_DS_AGENT_GROUPID
@@ -95,6 +114,9 @@ use vars qw(@ISA %EXPORT_TAGS @EXPORT_OK @EXPORT $VERSION $AUTOLOAD);
 				   NETSNMP_DS_AGENT_INTERNAL_SECLEVEL
 				   NETSNMP_DS_AGENT_MAX_GETBULKREPEATS
 				   NETSNMP_DS_AGENT_MAX_GETBULKRESPONSES
+				   NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING
+				   NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MIN
+				   NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MAX
 );
 $VERSION = '5.08';
 
@@ -162,6 +184,13 @@ None by default.
 				   NETSNMP_DS_AGENT_DONT_RETAIN_NOTIFICATIONS
 				   NETSNMP_DS_AGENT_DONT_LOG_TCPWRAPPERS_CONNECTS
 				   NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES
+				   NETSNMP_DS_AGENT_REALSTORAGEUNITS
+				   NETSNMP_DS_APP_NUMERIC_IP
+				   NETSNMP_DS_APP_NO_AUTHORIZATION
+				   NETSNMP_DS_AGENT_DISKIO_NO_FD
+				   NETSNMP_DS_AGENT_DISKIO_NO_LOOP
+				   NETSNMP_DS_AGENT_DISKIO_NO_RAM
+				   NETSNMP_DS_AGENT_IQUERY_NO_DIRECT
 				   NETSNMP_DS_AGENT_PROGNAME
 				   NETSNMP_DS_AGENT_X_SOCKET
 				   NETSNMP_DS_AGENT_PORTS
@@ -169,6 +198,7 @@ None by default.
 				   NETSNMP_DS_AGENT_PERL_INIT_FILE
 				   NETSNMP_DS_SMUX_SOCKET
 				   NETSNMP_DS_NOTIF_LOG_CTX
+				   NETSNMP_DS_AGENT_TRAP_ADDR
 				   NETSNMP_DS_AGENT_FLAGS
 				   NETSNMP_DS_AGENT_USERID
 				   NETSNMP_DS_AGENT_GROUPID
@@ -184,180 +214,9 @@ None by default.
 				   NETSNMP_DS_AGENT_INTERNAL_SECLEVEL
 				   NETSNMP_DS_AGENT_MAX_GETBULKREPEATS
 				   NETSNMP_DS_AGENT_MAX_GETBULKRESPONSES
-
-
-				   NETSNMP_DS_AGENT_VERBOSE
-				   NETSNMP_DS_AGENT_ROLE
-				   NETSNMP_DS_AGENT_NO_ROOT_ACCESS
-				   NETSNMP_DS_AGENT_AGENTX_MASTER
-				   NETSNMP_DS_AGENT_QUIT_IMMEDIATELY
-				   NETSNMP_DS_AGENT_DISABLE_PERL
-				   NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS
-				   NETSNMP_DS_AGENT_LEAVE_PIDFILE
-				   NETSNMP_DS_AGENT_NO_CACHING
-				   NETSNMP_DS_AGENT_STRICT_DISMAN
-				   NETSNMP_DS_AGENT_DONT_RETAIN_NOTIFICATIONS
-				   NETSNMP_DS_AGENT_DONT_LOG_TCPWRAPPERS_CONNECTS
-				   NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES
-				   NETSNMP_DS_AGENT_PROGNAME
-				   NETSNMP_DS_AGENT_X_SOCKET
-				   NETSNMP_DS_AGENT_PORTS
-				   NETSNMP_DS_AGENT_INTERNAL_SECNAME
-				   NETSNMP_DS_AGENT_PERL_INIT_FILE
-				   NETSNMP_DS_SMUX_SOCKET
-				   NETSNMP_DS_NOTIF_LOG_CTX
-				   NETSNMP_DS_AGENT_FLAGS
-				   NETSNMP_DS_AGENT_USERID
-				   NETSNMP_DS_AGENT_GROUPID
-				   NETSNMP_DS_AGENT_AGENTX_PING_INTERVAL
-				   NETSNMP_DS_AGENT_AGENTX_TIMEOUT
-				   NETSNMP_DS_AGENT_AGENTX_RETRIES
-				   NETSNMP_DS_AGENT_X_SOCK_PERM
-				   NETSNMP_DS_AGENT_X_DIR_PERM
-				   NETSNMP_DS_AGENT_X_SOCK_USER
-				   NETSNMP_DS_AGENT_X_SOCK_GROUP
-				   NETSNMP_DS_AGENT_CACHE_TIMEOUT
-				   NETSNMP_DS_AGENT_INTERNAL_VERSION
-				   NETSNMP_DS_AGENT_INTERNAL_SECLEVEL
-
-
-				   NETSNMP_DS_AGENT_VERBOSE
-				   NETSNMP_DS_AGENT_ROLE
-				   NETSNMP_DS_AGENT_NO_ROOT_ACCESS
-				   NETSNMP_DS_AGENT_AGENTX_MASTER
-				   NETSNMP_DS_AGENT_QUIT_IMMEDIATELY
-				   NETSNMP_DS_AGENT_DISABLE_PERL
-				   NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS
-				   NETSNMP_DS_AGENT_LEAVE_PIDFILE
-				   NETSNMP_DS_AGENT_NO_CACHING
-				   NETSNMP_DS_AGENT_STRICT_DISMAN
-				   NETSNMP_DS_AGENT_DONT_RETAIN_NOTIFICATIONS
-				   NETSNMP_DS_AGENT_DONT_LOG_TCPWRAPPERS_CONNECTS
-				   NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES
-				   NETSNMP_DS_AGENT_PROGNAME
-				   NETSNMP_DS_AGENT_X_SOCKET
-				   NETSNMP_DS_AGENT_PORTS
-				   NETSNMP_DS_AGENT_INTERNAL_SECNAME
-				   NETSNMP_DS_AGENT_PERL_INIT_FILE
-				   NETSNMP_DS_SMUX_SOCKET
-				   NETSNMP_DS_NOTIF_LOG_CTX
-				   NETSNMP_DS_AGENT_FLAGS
-				   NETSNMP_DS_AGENT_USERID
-				   NETSNMP_DS_AGENT_GROUPID
-				   NETSNMP_DS_AGENT_AGENTX_PING_INTERVAL
-				   NETSNMP_DS_AGENT_AGENTX_TIMEOUT
-				   NETSNMP_DS_AGENT_AGENTX_RETRIES
-				   NETSNMP_DS_AGENT_X_SOCK_PERM
-				   NETSNMP_DS_AGENT_X_DIR_PERM
-				   NETSNMP_DS_AGENT_X_SOCK_USER
-				   NETSNMP_DS_AGENT_X_SOCK_GROUP
-				   NETSNMP_DS_AGENT_CACHE_TIMEOUT
-				   NETSNMP_DS_AGENT_INTERNAL_VERSION
-				   NETSNMP_DS_AGENT_INTERNAL_SECLEVEL
-
-
-				   NETSNMP_DS_AGENT_VERBOSE
-				   NETSNMP_DS_AGENT_ROLE
-				   NETSNMP_DS_AGENT_NO_ROOT_ACCESS
-				   NETSNMP_DS_AGENT_AGENTX_MASTER
-				   NETSNMP_DS_AGENT_QUIT_IMMEDIATELY
-				   NETSNMP_DS_AGENT_DISABLE_PERL
-				   NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS
-				   NETSNMP_DS_AGENT_LEAVE_PIDFILE
-				   NETSNMP_DS_AGENT_NO_CACHING
-				   NETSNMP_DS_AGENT_STRICT_DISMAN
-				   NETSNMP_DS_AGENT_DONT_RETAIN_NOTIFICATIONS
-				   NETSNMP_DS_AGENT_DONT_LOG_TCPWRAPPERS_CONNECTS
-				   NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES
-				   NETSNMP_DS_AGENT_PROGNAME
-				   NETSNMP_DS_AGENT_X_SOCKET
-				   NETSNMP_DS_AGENT_PORTS
-				   NETSNMP_DS_AGENT_INTERNAL_SECNAME
-				   NETSNMP_DS_AGENT_PERL_INIT_FILE
-				   NETSNMP_DS_SMUX_SOCKET
-				   NETSNMP_DS_NOTIF_LOG_CTX
-				   NETSNMP_DS_AGENT_FLAGS
-				   NETSNMP_DS_AGENT_USERID
-				   NETSNMP_DS_AGENT_GROUPID
-				   NETSNMP_DS_AGENT_AGENTX_PING_INTERVAL
-				   NETSNMP_DS_AGENT_AGENTX_TIMEOUT
-				   NETSNMP_DS_AGENT_AGENTX_RETRIES
-				   NETSNMP_DS_AGENT_X_SOCK_PERM
-				   NETSNMP_DS_AGENT_X_DIR_PERM
-				   NETSNMP_DS_AGENT_X_SOCK_USER
-				   NETSNMP_DS_AGENT_X_SOCK_GROUP
-				   NETSNMP_DS_AGENT_CACHE_TIMEOUT
-				   NETSNMP_DS_AGENT_INTERNAL_VERSION
-				   NETSNMP_DS_AGENT_INTERNAL_SECLEVEL
-
-
-				   NETSNMP_DS_AGENT_VERBOSE
-				   NETSNMP_DS_AGENT_ROLE
-				   NETSNMP_DS_AGENT_NO_ROOT_ACCESS
-				   NETSNMP_DS_AGENT_AGENTX_MASTER
-				   NETSNMP_DS_AGENT_QUIT_IMMEDIATELY
-				   NETSNMP_DS_AGENT_DISABLE_PERL
-				   NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS
-				   NETSNMP_DS_AGENT_LEAVE_PIDFILE
-				   NETSNMP_DS_AGENT_NO_CACHING
-				   NETSNMP_DS_AGENT_STRICT_DISMAN
-				   NETSNMP_DS_AGENT_DONT_RETAIN_NOTIFICATIONS
-				   NETSNMP_DS_AGENT_DONT_LOG_TCPWRAPPERS_CONNECTS
-				   NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES
-				   NETSNMP_DS_AGENT_PROGNAME
-				   NETSNMP_DS_AGENT_X_SOCKET
-				   NETSNMP_DS_AGENT_PORTS
-				   NETSNMP_DS_AGENT_INTERNAL_SECNAME
-				   NETSNMP_DS_AGENT_PERL_INIT_FILE
-				   NETSNMP_DS_SMUX_SOCKET
-				   NETSNMP_DS_NOTIF_LOG_CTX
-				   NETSNMP_DS_AGENT_FLAGS
-				   NETSNMP_DS_AGENT_USERID
-				   NETSNMP_DS_AGENT_GROUPID
-				   NETSNMP_DS_AGENT_AGENTX_PING_INTERVAL
-				   NETSNMP_DS_AGENT_AGENTX_TIMEOUT
-				   NETSNMP_DS_AGENT_AGENTX_RETRIES
-				   NETSNMP_DS_AGENT_X_SOCK_PERM
-				   NETSNMP_DS_AGENT_X_DIR_PERM
-				   NETSNMP_DS_AGENT_X_SOCK_USER
-				   NETSNMP_DS_AGENT_X_SOCK_GROUP
-				   NETSNMP_DS_AGENT_CACHE_TIMEOUT
-				   NETSNMP_DS_AGENT_INTERNAL_VERSION
-				   NETSNMP_DS_AGENT_INTERNAL_SECLEVEL
-
-
-
-
-				   NETSNMP_DS_AGENT_VERBOSE
-				   NETSNMP_DS_AGENT_ROLE
-				   NETSNMP_DS_AGENT_NO_ROOT_ACCESS
-				   NETSNMP_DS_AGENT_AGENTX_MASTER
-				   NETSNMP_DS_AGENT_QUIT_IMMEDIATELY
-				   NETSNMP_DS_AGENT_DISABLE_PERL
-				   NETSNMP_DS_AGENT_PROGNAME
-				   NETSNMP_DS_AGENT_X_SOCKET
-				   NETSNMP_DS_AGENT_PORTS
-				   NETSNMP_DS_AGENT_INTERNAL_SECNAME
-				   NETSNMP_DS_AGENT_PERL_INIT_FILE
-				   NETSNMP_DS_AGENT_FLAGS
-				   NETSNMP_DS_AGENT_USERID
-				   NETSNMP_DS_AGENT_GROUPID
-				   NETSNMP_DS_AGENT_AGENTX_PING_INTERVAL
-
-
-  DS_AGENT_AGENTX_MASTER
-  DS_AGENT_AGENTX_PING_INTERVAL
-  DS_AGENT_FLAGS
-  DS_AGENT_GROUPID
-  DS_AGENT_INTERNAL_SECNAME
-  DS_AGENT_NO_ROOT_ACCESS
-  DS_AGENT_PORTS
-  DS_AGENT_PROGNAME
-  DS_AGENT_ROLE
-  DS_AGENT_USERID
-  DS_AGENT_VERBOSE
-  DS_AGENT_X_SOCKET
-
+				   NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING
+				   NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MIN
+				   NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MAX
 
 =head1 AUTHOR
 
@@ -123,12 +123,103 @@ constant_24 (pTHX_ const char *name, IV *iv_return) {
   return PERL_constant_NOTFOUND;
 }
 
+static int
+constant_25 (pTHX_ const char *name, IV *iv_return) {
+  /* When generated this function returned values for the list of names given
+     here.  However, subsequent manual editing may have added or removed some.
+     NETSNMP_DS_AGENT_PROGNAME NETSNMP_DS_AGENT_X_SOCKET
+     NETSNMP_DS_APP_NUMERIC_IP */
+  /* Offset 19 gives the best switch position.  */
+  switch (name[19]) {
+  case 'O':
+    if (memEQ(name, "NETSNMP_DS_AGENT_PROGNAME", 25)) {
+    /*                                  ^            */
+#ifdef NETSNMP_DS_AGENT_PROGNAME
+      *iv_return = NETSNMP_DS_AGENT_PROGNAME;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'R':
+    if (memEQ(name, "NETSNMP_DS_APP_NUMERIC_IP", 25)) {
+    /*                                  ^            */
+#ifdef NETSNMP_DS_APP_NUMERIC_IP
+      *iv_return = NETSNMP_DS_APP_NUMERIC_IP;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'S':
+    if (memEQ(name, "NETSNMP_DS_AGENT_X_SOCKET", 25)) {
+    /*                                  ^            */
+#ifdef NETSNMP_DS_AGENT_X_SOCKET
+      *iv_return = NETSNMP_DS_AGENT_X_SOCKET;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  }
+  return PERL_constant_NOTFOUND;
+}
+
+static int
+constant_29 (pTHX_ const char *name, IV *iv_return) {
+  /* When generated this function returned values for the list of names given
+     here.  However, subsequent manual editing may have added or removed some.
+     NETSNMP_DS_AGENT_DISABLE_PERL NETSNMP_DS_AGENT_DISKIO_NO_FD
+     NETSNMP_DS_AGENT_X_SOCK_GROUP */
+  /* Offset 25 gives the best switch position.  */
+  switch (name[25]) {
+  case 'O':
+    if (memEQ(name, "NETSNMP_DS_AGENT_DISKIO_NO_FD", 29)) {
+    /*                                        ^          */
+#ifdef NETSNMP_DS_AGENT_DISKIO_NO_FD
+      *iv_return = NETSNMP_DS_AGENT_DISKIO_NO_FD;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'P':
+    if (memEQ(name, "NETSNMP_DS_AGENT_DISABLE_PERL", 29)) {
+    /*                                        ^          */
+#ifdef NETSNMP_DS_AGENT_DISABLE_PERL
+      *iv_return = NETSNMP_DS_AGENT_DISABLE_PERL;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'R':
+    if (memEQ(name, "NETSNMP_DS_AGENT_X_SOCK_GROUP", 29)) {
+    /*                                        ^          */
+#ifdef NETSNMP_DS_AGENT_X_SOCK_GROUP
+      *iv_return = NETSNMP_DS_AGENT_X_SOCK_GROUP;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  }
+  return PERL_constant_NOTFOUND;
+}
+
 static int
 constant_30 (pTHX_ const char *name, IV *iv_return) {
   /* When generated this function returned values for the list of names given
      here.  However, subsequent manual editing may have added or removed some.
      NETSNMP_DS_AGENT_AGENTX_MASTER NETSNMP_DS_AGENT_CACHE_TIMEOUT
-     NETSNMP_DS_AGENT_LEAVE_PIDFILE NETSNMP_DS_AGENT_STRICT_DISMAN */
+     NETSNMP_DS_AGENT_DISKIO_NO_RAM NETSNMP_DS_AGENT_LEAVE_PIDFILE
+     NETSNMP_DS_AGENT_STRICT_DISMAN */
   /* Offset 27 gives the best switch position.  */
   switch (name[27]) {
   case 'I':
@@ -161,6 +252,17 @@ constant_30 (pTHX_ const char *name, IV *iv_return) {
       return PERL_constant_ISIV;
 #else
       return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'R':
+    if (memEQ(name, "NETSNMP_DS_AGENT_DISKIO_NO_RAM", 30)) {
+    /*                                          ^         */
+#ifdef NETSNMP_DS_AGENT_DISKIO_NO_RAM
+      *iv_return = NETSNMP_DS_AGENT_DISKIO_NO_RAM;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
 #endif
     }
     break;
@@ -184,7 +286,8 @@ constant_31 (pTHX_ const char *name, IV *iv_return) {
   /* When generated this function returned values for the list of names given
      here.  However, subsequent manual editing may have added or removed some.
      NETSNMP_DS_AGENT_AGENTX_RETRIES NETSNMP_DS_AGENT_AGENTX_TIMEOUT
-     NETSNMP_DS_AGENT_NO_ROOT_ACCESS NETSNMP_DS_AGENT_PERL_INIT_FILE */
+     NETSNMP_DS_AGENT_DISKIO_NO_LOOP NETSNMP_DS_AGENT_NO_ROOT_ACCESS
+     NETSNMP_DS_AGENT_PERL_INIT_FILE NETSNMP_DS_APP_NO_AUTHORIZATION */
   /* Offset 27 gives the best switch position.  */
   switch (name[27]) {
   case 'C':
@@ -217,6 +320,17 @@ constant_31 (pTHX_ const char *name, IV *iv_return) {
       return PERL_constant_ISIV;
 #else
       return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'L':
+    if (memEQ(name, "NETSNMP_DS_AGENT_DISKIO_NO_LOOP", 31)) {
+    /*                                          ^          */
+#ifdef NETSNMP_DS_AGENT_DISKIO_NO_LOOP
+      *iv_return = NETSNMP_DS_AGENT_DISKIO_NO_LOOP;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
 #endif
     }
     break;
@@ -228,6 +342,17 @@ constant_31 (pTHX_ const char *name, IV *iv_return) {
       return PERL_constant_ISIV;
 #else
       return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'T':
+    if (memEQ(name, "NETSNMP_DS_APP_NO_AUTHORIZATION", 31)) {
+    /*                                          ^          */
+#ifdef NETSNMP_DS_APP_NO_AUTHORIZATION
+      *iv_return = NETSNMP_DS_APP_NO_AUTHORIZATION;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
 #endif
     }
     break;
@@ -240,9 +365,21 @@ constant_33 (pTHX_ const char *name, IV *iv_return) {
   /* When generated this function returned values for the list of names given
      here.  However, subsequent manual editing may have added or removed some.
      NETSNMP_DS_AGENT_INTERNAL_SECNAME NETSNMP_DS_AGENT_INTERNAL_VERSION
-     NETSNMP_DS_AGENT_QUIT_IMMEDIATELY */
+     NETSNMP_DS_AGENT_IQUERY_NO_DIRECT NETSNMP_DS_AGENT_QUIT_IMMEDIATELY
+     NETSNMP_DS_AGENT_REALSTORAGEUNITS */
   /* Offset 31 gives the best switch position.  */
   switch (name[31]) {
+  case 'C':
+    if (memEQ(name, "NETSNMP_DS_AGENT_IQUERY_NO_DIRECT", 33)) {
+    /*                                              ^        */
+#ifdef NETSNMP_DS_AGENT_IQUERY_NO_DIRECT
+      *iv_return = NETSNMP_DS_AGENT_IQUERY_NO_DIRECT;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
   case 'L':
     if (memEQ(name, "NETSNMP_DS_AGENT_QUIT_IMMEDIATELY", 33)) {
     /*                                              ^        */
@@ -273,6 +410,108 @@ constant_33 (pTHX_ const char *name, IV *iv_return) {
       return PERL_constant_ISIV;
 #else
       return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'T':
+    if (memEQ(name, "NETSNMP_DS_AGENT_REALSTORAGEUNITS", 33)) {
+    /*                                              ^        */
+#ifdef NETSNMP_DS_AGENT_REALSTORAGEUNITS
+      *iv_return = NETSNMP_DS_AGENT_REALSTORAGEUNITS;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  }
+  return PERL_constant_NOTFOUND;
+}
+
+static int
+constant_35 (pTHX_ const char *name, IV *iv_return) {
+  /* When generated this function returned values for the list of names given
+     here.  However, subsequent manual editing may have added or removed some.
+     NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MAX NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MIN
+     NETSNMP_DS_AGENT_MAX_GETBULKREPEATS */
+  /* Offset 34 gives the best switch position.  */
+  switch (name[34]) {
+  case 'N':
+    if (memEQ(name, "NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MI", 34)) {
+    /*                                                 N      */
+#ifdef NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MIN
+      *iv_return = NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MIN;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'S':
+    if (memEQ(name, "NETSNMP_DS_AGENT_MAX_GETBULKREPEAT", 34)) {
+    /*                                                 S      */
+#ifdef NETSNMP_DS_AGENT_MAX_GETBULKREPEATS
+      *iv_return = NETSNMP_DS_AGENT_MAX_GETBULKREPEATS;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'X':
+    if (memEQ(name, "NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MA", 34)) {
+    /*                                                 X      */
+#ifdef NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MAX
+      *iv_return = NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MAX;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  }
+  return PERL_constant_NOTFOUND;
+}
+
+static int
+constant_39 (pTHX_ const char *name, IV *iv_return) {
+  /* When generated this function returned values for the list of names given
+     here.  However, subsequent manual editing may have added or removed some.
+     NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING
+     NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS
+     NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES */
+  /* Offset 21 gives the best switch position.  */
+  switch (name[21]) {
+  case 'N':
+    if (memEQ(name, "NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES", 39)) {
+    /*                                    ^                        */
+#ifdef NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES
+      *iv_return = NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'O':
+    if (memEQ(name, "NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS", 39)) {
+    /*                                    ^                        */
+#ifdef NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS
+      *iv_return = NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
+#endif
+    }
+    break;
+  case 'T':
+    if (memEQ(name, "NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING", 39)) {
+    /*                                    ^                        */
+#ifdef NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING
+      *iv_return = NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING;
+      return PERL_constant_ISIV;
+#else
+      return PERL_constant_NOTDEF;
 #endif
     }
     break;
@@ -298,35 +537,43 @@ use ExtUtils::Constant qw (constant_types C_constant XS_constant);
 
 my $types = {map {($_, 1)} qw(IV)};
 my @names = (qw(NETSNMP_DS_AGENT_AGENTX_MASTER
+	       NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING
 	       NETSNMP_DS_AGENT_AGENTX_PING_INTERVAL
 	       NETSNMP_DS_AGENT_AGENTX_RETRIES NETSNMP_DS_AGENT_AGENTX_TIMEOUT
+	       NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MAX
+	       NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MIN
 	       NETSNMP_DS_AGENT_CACHE_TIMEOUT NETSNMP_DS_AGENT_DISABLE_PERL
+	       NETSNMP_DS_AGENT_DISKIO_NO_FD NETSNMP_DS_AGENT_DISKIO_NO_LOOP
+	       NETSNMP_DS_AGENT_DISKIO_NO_RAM
 	       NETSNMP_DS_AGENT_DONT_LOG_TCPWRAPPERS_CONNECTS
 	       NETSNMP_DS_AGENT_DONT_RETAIN_NOTIFICATIONS
 	       NETSNMP_DS_AGENT_FLAGS NETSNMP_DS_AGENT_GROUPID
 	       NETSNMP_DS_AGENT_INTERNAL_SECLEVEL
 	       NETSNMP_DS_AGENT_INTERNAL_SECNAME
-	       NETSNMP_DS_AGENT_INTERNAL_VERSION NETSNMP_DS_AGENT_LEAVE_PIDFILE
+	       NETSNMP_DS_AGENT_INTERNAL_VERSION
+	       NETSNMP_DS_AGENT_IQUERY_NO_DIRECT NETSNMP_DS_AGENT_LEAVE_PIDFILE
 	       NETSNMP_DS_AGENT_MAX_GETBULKREPEATS
 	       NETSNMP_DS_AGENT_MAX_GETBULKRESPONSES
 	       NETSNMP_DS_AGENT_NO_CACHING
 	       NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS
 	       NETSNMP_DS_AGENT_NO_ROOT_ACCESS NETSNMP_DS_AGENT_PERL_INIT_FILE
 	       NETSNMP_DS_AGENT_PORTS NETSNMP_DS_AGENT_PROGNAME
-	       NETSNMP_DS_AGENT_QUIT_IMMEDIATELY NETSNMP_DS_AGENT_ROLE
+	       NETSNMP_DS_AGENT_QUIT_IMMEDIATELY
+	       NETSNMP_DS_AGENT_REALSTORAGEUNITS NETSNMP_DS_AGENT_ROLE
 	       NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES
-	       NETSNMP_DS_AGENT_STRICT_DISMAN NETSNMP_DS_AGENT_USERID
-	       NETSNMP_DS_AGENT_VERBOSE NETSNMP_DS_AGENT_X_DIR_PERM
-	       NETSNMP_DS_AGENT_X_SOCKET NETSNMP_DS_AGENT_X_SOCK_GROUP
-	       NETSNMP_DS_AGENT_X_SOCK_PERM NETSNMP_DS_AGENT_X_SOCK_USER
-	       NETSNMP_DS_APP_DONT_LOG NETSNMP_DS_NOTIF_LOG_CTX
-	       NETSNMP_DS_SMUX_SOCKET));
+	       NETSNMP_DS_AGENT_STRICT_DISMAN NETSNMP_DS_AGENT_TRAP_ADDR
+	       NETSNMP_DS_AGENT_USERID NETSNMP_DS_AGENT_VERBOSE
+	       NETSNMP_DS_AGENT_X_DIR_PERM NETSNMP_DS_AGENT_X_SOCKET
+	       NETSNMP_DS_AGENT_X_SOCK_GROUP NETSNMP_DS_AGENT_X_SOCK_PERM
+	       NETSNMP_DS_AGENT_X_SOCK_USER NETSNMP_DS_APP_DONT_LOG
+	       NETSNMP_DS_APP_NO_AUTHORIZATION NETSNMP_DS_APP_NUMERIC_IP
+	       NETSNMP_DS_NOTIF_LOG_CTX NETSNMP_DS_SMUX_SOCKET));
 
-print constant_types(); # macro defs
+print constant_types(), "\n"; # macro defs
 foreach (C_constant ("NetSNMP::agent::default_store", 'constant', 'IV', $types, undef, 3, @names) ) {
     print $_, "\n"; # C constant subs
 }
-print "#### XS Section:\n";
+print "\n#### XS Section:\n";
 print XS_constant ("NetSNMP::agent::default_store", $types);
 __END__
    */
@@ -378,32 +625,16 @@ __END__
     return constant_24 (aTHX_ name, iv_return);
     break;
   case 25:
-    /* Names all of length 25.  */
-    /* NETSNMP_DS_AGENT_PROGNAME NETSNMP_DS_AGENT_X_SOCKET */
-    /* Offset 19 gives the best switch position.  */
-    switch (name[19]) {
-    case 'O':
-      if (memEQ(name, "NETSNMP_DS_AGENT_PROGNAME", 25)) {
-      /*                                  ^            */
-#ifdef NETSNMP_DS_AGENT_PROGNAME
-        *iv_return = NETSNMP_DS_AGENT_PROGNAME;
-        return PERL_constant_ISIV;
-#else
-        return PERL_constant_NOTDEF;
-#endif
-      }
-      break;
-    case 'S':
-      if (memEQ(name, "NETSNMP_DS_AGENT_X_SOCKET", 25)) {
-      /*                                  ^            */
-#ifdef NETSNMP_DS_AGENT_X_SOCKET
-        *iv_return = NETSNMP_DS_AGENT_X_SOCKET;
-        return PERL_constant_ISIV;
+    return constant_25 (aTHX_ name, iv_return);
+    break;
+  case 26:
+    if (memEQ(name, "NETSNMP_DS_AGENT_TRAP_ADDR", 26)) {
+#ifdef NETSNMP_DS_AGENT_TRAP_ADDR
+      *iv_return = NETSNMP_DS_AGENT_TRAP_ADDR;
+      return PERL_constant_ISIV;
 #else
-        return PERL_constant_NOTDEF;
+      return PERL_constant_NOTDEF;
 #endif
-      }
-      break;
     }
     break;
   case 27:
@@ -465,33 +696,7 @@ __END__
     }
     break;
   case 29:
-    /* Names all of length 29.  */
-    /* NETSNMP_DS_AGENT_DISABLE_PERL NETSNMP_DS_AGENT_X_SOCK_GROUP */
-    /* Offset 21 gives the best switch position.  */
-    switch (name[21]) {
-    case 'B':
-      if (memEQ(name, "NETSNMP_DS_AGENT_DISABLE_PERL", 29)) {
-      /*                                    ^              */
-#ifdef NETSNMP_DS_AGENT_DISABLE_PERL
-        *iv_return = NETSNMP_DS_AGENT_DISABLE_PERL;
-        return PERL_constant_ISIV;
-#else
-        return PERL_constant_NOTDEF;
-#endif
-      }
-      break;
-    case 'C':
-      if (memEQ(name, "NETSNMP_DS_AGENT_X_SOCK_GROUP", 29)) {
-      /*                                    ^              */
-#ifdef NETSNMP_DS_AGENT_X_SOCK_GROUP
-        *iv_return = NETSNMP_DS_AGENT_X_SOCK_GROUP;
-        return PERL_constant_ISIV;
-#else
-        return PERL_constant_NOTDEF;
-#endif
-      }
-      break;
-    }
+    return constant_29 (aTHX_ name, iv_return);
     break;
   case 30:
     return constant_30 (aTHX_ name, iv_return);
@@ -513,14 +718,7 @@ __END__
     }
     break;
   case 35:
-    if (memEQ(name, "NETSNMP_DS_AGENT_MAX_GETBULKREPEATS", 35)) {
-#ifdef NETSNMP_DS_AGENT_MAX_GETBULKREPEATS
-      *iv_return = NETSNMP_DS_AGENT_MAX_GETBULKREPEATS;
-      return PERL_constant_ISIV;
-#else
-      return PERL_constant_NOTDEF;
-#endif
-    }
+    return constant_35 (aTHX_ name, iv_return);
     break;
   case 37:
     /* Names all of length 37.  */
@@ -553,34 +751,7 @@ __END__
     }
     break;
   case 39:
-    /* Names all of length 39.  */
-    /* NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS
-       NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES */
-    /* Offset 21 gives the best switch position.  */
-    switch (name[21]) {
-    case 'N':
-      if (memEQ(name, "NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES", 39)) {
-      /*                                    ^                        */
-#ifdef NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES
-        *iv_return = NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES;
-        return PERL_constant_ISIV;
-#else
-        return PERL_constant_NOTDEF;
-#endif
-      }
-      break;
-    case 'O':
-      if (memEQ(name, "NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS", 39)) {
-      /*                                    ^                        */
-#ifdef NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS
-        *iv_return = NETSNMP_DS_AGENT_NO_CONNECTION_WARNINGS;
-        return PERL_constant_ISIV;
-#else
-        return PERL_constant_NOTDEF;
-#endif
-      }
-      break;
-    }
+    return constant_39 (aTHX_ name, iv_return);
     break;
   case 42:
     if (memEQ(name, "NETSNMP_DS_AGENT_DONT_RETAIN_NOTIFICATIONS", 42)) {
@@ -622,7 +793,7 @@ constant(sv)
 #endif
 	STRLEN		len;
         int		type;
-	IV		iv;
+	IV		iv = 0; /* avoid uninit var warning */
 	/* NV		nv;	Uncomment this if you need to return NVs */
 	/* const char	*pv;	Uncomment this if you need to return PVs */
     INPUT:
@@ -636,46 +807,48 @@ constant(sv)
            Second, if present, is found value */
         switch (type) {
         case PERL_constant_NOTFOUND:
-          sv = sv_2mortal(newSVpvf("%s is not a valid NetSNMP::agent::default_store macro", s));
+          sv =
+	    sv_2mortal(newSVpvf("%s is not a valid NetSNMP::agent::default_store macro", s));
           PUSHs(sv);
           break;
         case PERL_constant_NOTDEF:
           sv = sv_2mortal(newSVpvf(
-	    "Your vendor has not defined NetSNMP::agent::default_store macro %s, used", s));
+	    "Your vendor has not defined NetSNMP::agent::default_store macro %s, used",
+				   s));
           PUSHs(sv);
           break;
         case PERL_constant_ISIV:
-          EXTEND(SP, 1);
+          EXTEND(SP, 2);
           PUSHs(&PL_sv_undef);
           PUSHi(iv);
           break;
 	/* Uncomment this if you need to return NOs
         case PERL_constant_ISNO:
-          EXTEND(SP, 1);
+          EXTEND(SP, 2);
           PUSHs(&PL_sv_undef);
           PUSHs(&PL_sv_no);
           break; */
 	/* Uncomment this if you need to return NVs
         case PERL_constant_ISNV:
-          EXTEND(SP, 1);
+          EXTEND(SP, 2);
           PUSHs(&PL_sv_undef);
           PUSHn(nv);
           break; */
 	/* Uncomment this if you need to return PVs
         case PERL_constant_ISPV:
-          EXTEND(SP, 1);
+          EXTEND(SP, 2);
           PUSHs(&PL_sv_undef);
           PUSHp(pv, strlen(pv));
           break; */
 	/* Uncomment this if you need to return PVNs
         case PERL_constant_ISPVN:
-          EXTEND(SP, 1);
+          EXTEND(SP, 2);
           PUSHs(&PL_sv_undef);
           PUSHp(pv, iv);
           break; */
 	/* Uncomment this if you need to return SVs
         case PERL_constant_ISSV:
-          EXTEND(SP, 1);
+          EXTEND(SP, 2);
           PUSHs(&PL_sv_undef);
           PUSHs(sv);
           break; */
@@ -684,13 +857,13 @@ constant(sv)
           break; */
 	/* Uncomment this if you need to return UVs
         case PERL_constant_ISUV:
-          EXTEND(SP, 1);
+          EXTEND(SP, 2);
           PUSHs(&PL_sv_undef);
           PUSHu((UV)iv);
           break; */
 	/* Uncomment this if you need to return YESs
         case PERL_constant_ISYES:
-          EXTEND(SP, 1);
+          EXTEND(SP, 2);
           PUSHs(&PL_sv_undef);
           PUSHs(&PL_sv_yes);
           break; */
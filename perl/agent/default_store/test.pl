@@ -22,6 +22,13 @@ BEGIN { $| = 1;
                   "NETSNMP_DS_AGENT_DONT_RETAIN_NOTIFICATIONS" => 10,
                   "NETSNMP_DS_AGENT_DONT_LOG_TCPWRAPPERS_CONNECTS" => 12,
                   "NETSNMP_DS_AGENT_SKIPNFSINHOSTRESOURCES" => 13,
+                  "NETSNMP_DS_AGENT_REALSTORAGEUNITS"      => 14,
+                  "NETSNMP_DS_APP_NUMERIC_IP"              => 16,
+                  "NETSNMP_DS_APP_NO_AUTHORIZATION"        => 17,
+                  "NETSNMP_DS_AGENT_DISKIO_NO_FD"          => 18,
+                  "NETSNMP_DS_AGENT_DISKIO_NO_LOOP"        => 19,
+                  "NETSNMP_DS_AGENT_DISKIO_NO_RAM"         => 20,
+                  "NETSNMP_DS_AGENT_IQUERY_NO_DIRECT"      => 21,
                   "NETSNMP_DS_AGENT_PROGNAME"              => 0,
                   "NETSNMP_DS_AGENT_X_SOCKET"              => 1,
                   "NETSNMP_DS_AGENT_PORTS"                 => 2,
@@ -29,6 +36,7 @@ BEGIN { $| = 1;
                   "NETSNMP_DS_AGENT_PERL_INIT_FILE"        => 4,
                   "NETSNMP_DS_SMUX_SOCKET"                 => 5,
                   "NETSNMP_DS_NOTIF_LOG_CTX"               => 6,
+                  "NETSNMP_DS_AGENT_TRAP_ADDR"             => 7,
                   "NETSNMP_DS_AGENT_FLAGS"                 => 0,
                   "NETSNMP_DS_AGENT_USERID"                => 1,
                   "NETSNMP_DS_AGENT_GROUPID"               => 2,
@@ -44,6 +52,9 @@ BEGIN { $| = 1;
                   "NETSNMP_DS_AGENT_INTERNAL_SECLEVEL"     => 12,
                   "NETSNMP_DS_AGENT_MAX_GETBULKREPEATS"    => 13,
                   "NETSNMP_DS_AGENT_MAX_GETBULKRESPONSES"  => 14,
+                  "NETSNMP_DS_AGENT_AGENTX_MAX_OUTSTANDING" => 15,
+                  "NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MIN"    => 16,
+                  "NETSNMP_DS_AGENT_AGENTX_TIMEOUT_MAX"    => 17,
 		  );
 
 	print "1.." . (scalar(keys(%tests)) + 2) . "\n"; 
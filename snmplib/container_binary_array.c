@@ -37,6 +37,7 @@ typedef struct binary_array_table_s {
     size_t                     max_size;   /* Size of the current data table */
     size_t                     count;      /* Index of the next free entry */
     int                        dirty;
+    size_t                     sorted;     /* Leading entries in order */
     void                     **data;       /* The table itself */
 } binary_array_table;
 
@@ -90,6 +91,54 @@ array_qsort(void **data, int first, int last, netsnmp_container_compare *f)
         array_qsort(data, i, last, f);
 }
 
+/*
+ * sort the entries appended since the table was last sorted, and move
+ * them into place among the sorted ones. A few inserts into a large
+ * table (one kept up to date in place, say) then cost a binary search
+ * and a memmove each, instead of a sort of the whole table.
+ */
+static void
+array_merge_tail(binary_array_table *t, netsnmp_container_compare *f)
+{
+    size_t          tail_count = t->count - t->sorted;
+    void          **tail;
+    size_t          i, j, k, lo, hi, mid;
+
+    tail = (void **) malloc(tail_count * sizeof(void *));
+    if (NULL == tail) {
+        array_qsort(t->data, 0, t->count - 1, f);
+        return;
+    }
+
+    if (tail_count > 1)
+        array_qsort(t->data, t->sorted, t->count - 1, f);
+    memcpy(tail, &t->data[t->sorted], tail_count * sizeof(void *));
+
+    /*
+     * place the tail from its largest entry down, moving the sorted
+     * entries above each one up; k == i + j throughout.
+     */
+    i = t->sorted;
+    k = t->count;
+    for (j = tail_count; j > 0; --j) {
+        lo = 0;
+        hi = i;
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            if ((*f)(t->data[mid], tail[j - 1]) > 0)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        k -= i - lo;
+        memmove(&t->data[k], &t->data[lo], (i - lo) * sizeof(void *));
+        i = lo;
+        t->data[--k] = tail[j - 1];
+    }
+
+    free(tail);
+}
+
 static int
 Sort_Array(netsnmp_container *c)
 {
@@ -104,9 +153,12 @@ Sort_Array(netsnmp_container *c)
         /*
          * Sort the table 
          */
-        if (t->count > 1)
+        if (t->sorted > 0 && t->sorted < t->count)
+            array_merge_tail(t, c->compare);
+        else if (t->count > 1)
             array_qsort(t->data, 0, t->count - 1, c->compare);
         t->dirty = 0;
+        t->sorted = t->count;
 
         /*
          * no way to know if it actually changed... just assume so.
@@ -220,6 +272,7 @@ netsnmp_binary_array_initialize(void)
     t->max_size = 0;
     t->count = 0;
     t->dirty = 0;
+    t->sorted = 0;
     t->data = NULL;
 
     return t;
@@ -313,6 +366,8 @@ netsnmp_binary_array_remove_at(netsnmp_container *c, size_t index, void **save)
      * if entry was last item, just decrement count
      */
     --t->count;
+    if (index < t->sorted)
+        --t->sorted;
     if (index != t->count) {
         /*
          * otherwise, shift array down
@@ -386,6 +441,7 @@ netsnmp_binary_array_clear(netsnmp_container *c,
 
     t->count = 0;
     t->dirty = 0;
+    t->sorted = 0;
     ++c->sync;
 }
 
@@ -430,6 +486,8 @@ netsnmp_binary_array_insert(netsnmp_container *c, const void *entry)
     /*
      * Insert the new entry into the data array
      */
+    if (!t->dirty)
+        t->sorted = t->count;
     t->data[t->count++] = NETSNMP_REMOVE_CONST(void *, entry);
     t->dirty = 1;
 
@@ -648,6 +706,7 @@ _ba_duplicate(netsnmp_container *c, void *ctx, u_int flags)
     dupt->max_size = t->max_size;
     dupt->count = t->count;
     dupt->dirty = t->dirty;
+    dupt->sorted = t->sorted;
 
     /*
      * shallow copy
@@ -52,6 +52,7 @@ typedef struct sl_container_s {
    
    size_t                     count;      /* Index of the next free entry */
    sl_node                   *head;       /* head of list */
+   sl_node                   *tail;       /* tail of list */
 
    int                        unsorted;   /* unsorted list? */
    int                        fifo;       /* lifo or fifo? */
@@ -155,7 +156,7 @@ _ssll_insert(netsnmp_container *c, const void *data)
      * first node?
      */
     if(NULL == sl->head) {
-        sl->head = new_node;
+        sl->head = sl->tail = new_node;
         return 0;
     }
 
@@ -170,9 +171,8 @@ _ssll_insert(netsnmp_container *c, const void *data)
             /*
              * fifo: insert at tail
              */
-            while(NULL != curr->next)
-                curr = curr->next;
-            curr->next = new_node;
+            sl->tail->next = new_node;
+            sl->tail = new_node;
         }
         else {
             /*
@@ -199,6 +199,8 @@ _ssll_insert(netsnmp_container *c, const void *data)
             new_node->next = last->next;
             last->next = new_node;
         }
+        if(NULL == new_node->next)
+            sl->tail = new_node;
     }
     
     return 0;
@@ -220,6 +222,8 @@ _ssll_remove(netsnmp_container *c, const void *data)
         (sl->c.compare(sl->head->data, data) == 0)) {
         curr = sl->head;
         sl->head = sl->head->next;
+        if(NULL == sl->head)
+            sl->tail = NULL;
     }
     else {
         sl_node *last = sl->head;
@@ -228,6 +232,8 @@ _ssll_remove(netsnmp_container *c, const void *data)
             rc = sl->c.compare(curr->data, data);
             if (rc == 0) {
                 last->next = curr->next;
+                if(sl->tail == curr)
+                    sl->tail = last;
                 break;
             }
             else if ((rc > 0) && (0 == sl->unsorted)) {
@@ -303,6 +309,7 @@ _ssll_clear(netsnmp_container *c, netsnmp_container_obj_func *f,
         free(curr);
     }
     sl->head = NULL;
+    sl->tail = NULL;
     sl->count = 0;
     ++c->sync;
 }
@@ -1224,6 +1224,8 @@ snmp_errstring(int errstat)
 #include <net-snmp/library/snmp_debug.h>
 
 static netsnmp_session *_def_query_session = NULL;
+static int (*_query_direct)(netsnmp_session *, netsnmp_pdu *,
+                            netsnmp_pdu **) = NULL;
 
 #ifndef NETSNMP_FEATURE_REMOVE_QUERY_SET_DEFAULT_SESSION
 void
@@ -1266,6 +1268,21 @@ netsnmp_query_get_default_session( void ) {
 }
 
 
+/**
+ * Register a routine to run queries on internal sessions (those flagged
+ * with SNMP_FLAGS_IQUERY) within the same process, rather than sending
+ * them over the session's transport.  The routine has the same calling
+ * conventions as snmp_synch_response (and may fall back to it).
+ * The agent uses this to hand internal queries straight to its request
+ * processing code.  Pass NULL to send all queries over their transport.
+ */
+void
+netsnmp_query_set_direct_handler(int (*handler)(netsnmp_session *,
+                                                netsnmp_pdu *,
+                                                netsnmp_pdu **)) {
+    _query_direct = handler;
+}
+
 /*
  * Internal utility routine to actually send the query
  */
@@ -1273,26 +1290,31 @@ static int _query(netsnmp_variable_list *list,
                   int                    request,
                   netsnmp_session       *session) {
 
-    netsnmp_pdu *pdu      = snmp_pdu_create( request );
+    netsnmp_pdu *pdu;
     netsnmp_pdu *response = NULL;
     netsnmp_variable_list *vb1, *vb2, *vtmp;
     int ret, count;
 
+    if ( !session )
+        session = _def_query_session;
+    if ( !session ) {
+        /* No session specified */
+        return SNMP_ERR_GENERR;
+    }
+
     DEBUGMSGTL(("iquery", "query on session %p\n", session));
     /*
      * Clone the varbind list into the request PDU...
      */
+    pdu = snmp_pdu_create( request );
     pdu->variables = snmp_clone_varbind( list );
 retry:
-    if ( session )
-        ret = snmp_synch_response(            session, pdu, &response );
-    else if (_def_query_session)
-        ret = snmp_synch_response( _def_query_session, pdu, &response );
-    else {
-        /* No session specified */
-        snmp_free_pdu(pdu);
-        return SNMP_ERR_GENERR;
-    }
+    if ( session->flags & SNMP_FLAGS_IQUERY_NOVACM )
+        pdu->flags |= UCD_MSG_FLAG_ALWAYS_IN_VIEW;
+    if ( _query_direct && (session->flags & SNMP_FLAGS_IQUERY))
+        ret = (*_query_direct)(    session, pdu, &response );
+    else
+        ret = snmp_synch_response( session, pdu, &response );
     DEBUGMSGTL(("iquery", "query returned %d\n", ret));
 
     /*
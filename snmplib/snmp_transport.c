@@ -67,6 +67,9 @@
 #ifdef NETSNMP_TRANSPORT_TCPIPV6_DOMAIN
 #include <net-snmp/library/snmpTCPIPv6Domain.h>
 #endif
+#ifdef NETSNMP_TRANSPORT_SHM_DOMAIN
+#include <net-snmp/library/snmpShmDomain.h>
+#endif
 #include <net-snmp/library/snmp_api.h>
 #include <net-snmp/library/snmp_service.h>
 #include <net-snmp/library/read_config.h>
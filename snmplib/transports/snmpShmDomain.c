@@ -0,0 +1,928 @@
+#include <net-snmp/net-snmp-config.h>
+
+#include <sys/types.h>
+#include <net-snmp/library/snmpShmDomain.h>
+
+#include <stddef.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+
+#if HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+#if HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#if HAVE_STDINT_H
+#include <stdint.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#if HAVE_SYS_UN_H
+#include <sys/un.h>
+#endif
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#if HAVE_DMALLOC_H
+#include <dmalloc.h>
+#endif
+
+#include <net-snmp/types.h>
+#include <net-snmp/output_api.h>
+
+#include <net-snmp/library/snmp_transport.h>
+#include <net-snmp/library/tools.h>
+
+#ifndef NETSNMP_STREAM_QUEUE_LEN
+#define NETSNMP_STREAM_QUEUE_LEN  5
+#endif
+
+/*
+ * Size of each ring (one per direction).  Must be a power of two.
+ */
+#ifndef NETSNMP_SHM_RING_SIZE
+#define NETSNMP_SHM_RING_SIZE     (256 * 1024)
+#endif
+
+/*
+ * How much data a sender queues while the other end makes room in a
+ * full ring, before refusing to send any more.
+ */
+#ifndef NETSNMP_SHM_MAX_PENDING
+#define NETSNMP_SHM_MAX_PENDING   (4 * NETSNMP_SHM_RING_SIZE)
+#endif
+
+/*
+ * How long (in milliseconds) a client waits for the server to accept
+ * the shared region before giving up.
+ */
+#ifndef NETSNMP_SHM_CONNECT_TIMEOUT
+#define NETSNMP_SHM_CONNECT_TIMEOUT 5000
+#endif
+
+#define NETSNMP_SHM_MAGIC         0x4e53484d    /* "NSHM" */
+#define NETSNMP_SHM_VERSION       2
+#define NETSNMP_SHM_PREFIX        "net-snmp-shm:"
+
+oid netsnmp_ShmDomain[] = { TRANSPORT_DOMAIN_SHM };
+static netsnmp_tdomain shmDomain;
+
+/*
+ * The shared region is this header, followed by the data of the client
+ * to server ring and then the data of the server to client ring.  head
+ * and tail are free running byte counts; head is only written by the
+ * reader of a ring and tail only by its writer, so they're kept on
+ * separate cache lines.  The writer sets waiting when it has found the
+ * ring full, and the reader clears it (and wakes the writer up) once it
+ * has made room.
+ */
+
+typedef struct netsnmp_shm_ring_s {
+    volatile uint32_t head;
+    char            pad0[60];
+    volatile uint32_t tail;
+    volatile uint32_t waiting;
+    char            pad1[56];
+} netsnmp_shm_ring;
+
+typedef struct netsnmp_shm_header_s {
+    uint32_t        magic;
+    uint32_t        version;
+    uint32_t        ring_size;
+    char            pad[52];
+    netsnmp_shm_ring ring[2];
+} netsnmp_shm_header;
+
+/*
+ * Our end of a connection.  On the server side, hdr is NULL until the
+ * client's shared region has arrived over sock.
+ */
+
+typedef struct netsnmp_shm_conn_s {
+    int             sock;       /* only used to notice the peer going away */
+    int             efd_rx;     /* signalled by the peer after writing to rx */
+    int             efd_tx;     /* signalled by us after writing to tx */
+    netsnmp_shm_header *hdr;
+    size_t          map_len;
+    netsnmp_shm_ring *rx, *tx;
+    u_char         *rx_data, *tx_data;
+    uint32_t        size;
+    u_char         *pending;    /* sent, but not yet room for in tx */
+    size_t          pending_len;
+} netsnmp_shm_conn;
+
+/*
+ * This is the structure we use to hold transport-specific data.
+ */
+
+typedef struct netsnmp_shm_data_s {
+    int             local;
+    char            name[sizeof(((struct sockaddr_un *) 0)->sun_path)];
+    netsnmp_shm_conn *conn;
+} netsnmp_shm_data;
+
+#define NETSNMP_SHM_BARRIER()   __sync_synchronize()
+
+
+/*
+ * Return a string representing the address of the transport.
+ */
+
+static char *
+netsnmp_shm_fmtaddr(netsnmp_transport *t, void *data, int len)
+{
+    netsnmp_shm_data *sd;
+    char           *tmp;
+
+    if (t == NULL || t->data == NULL)
+        return strdup("shm: unknown");
+
+    sd = (netsnmp_shm_data *) t->data;
+    tmp = (char *) malloc(5 + strlen(sd->name));
+    if (tmp != NULL)
+        sprintf(tmp, "shm:%s", sd->name);
+    return tmp;
+}
+
+static int
+netsnmp_shm_sockaddr(const char *name, struct sockaddr_un *addr,
+                     socklen_t *addr_len)
+{
+    size_t          len = strlen(NETSNMP_SHM_PREFIX) + strlen(name);
+
+    if (len + 2 > sizeof(addr->sun_path))
+        return -1;
+
+    /*
+     * Use the abstract namespace (a leading NUL), so there's no socket
+     * file to create or clean up.
+     */
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    snprintf(addr->sun_path + 1, sizeof(addr->sun_path) - 1, "%s%s",
+             NETSNMP_SHM_PREFIX, name);
+    *addr_len = offsetof(struct sockaddr_un, sun_path) + 1 + len;
+    return 0;
+}
+
+static void
+netsnmp_shm_signal(int efd)
+{
+    uint64_t        one = 1;
+
+    if (write(efd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        DEBUGMSGTL(("netsnmp_shm", "eventfd %d write failed: %s\n",
+                    efd, strerror(errno)));
+}
+
+static void
+netsnmp_shm_conn_free(netsnmp_shm_conn *conn)
+{
+    if (conn == NULL)
+        return;
+    if (conn->hdr != NULL)
+        munmap(conn->hdr, conn->map_len);
+    if (conn->efd_rx >= 0)
+        close(conn->efd_rx);
+    if (conn->efd_tx >= 0)
+        close(conn->efd_tx);
+    if (conn->sock >= 0)
+        close(conn->sock);
+    free(conn->pending);
+    free(conn);
+}
+
+/*
+ * Wrap a mapped region up as our end of a connection (the client writes
+ * to ring 0 and reads from ring 1, the server the other way around).
+ */
+
+static void
+netsnmp_shm_conn_rings(netsnmp_shm_conn *conn, int server)
+{
+    u_char         *base = (u_char *) conn->hdr + sizeof(netsnmp_shm_header);
+
+    conn->size = conn->hdr->ring_size;
+    conn->rx = &conn->hdr->ring[server ? 0 : 1];
+    conn->tx = &conn->hdr->ring[server ? 1 : 0];
+    conn->rx_data = base + (server ? 0 : conn->size);
+    conn->tx_data = base + (server ? conn->size : 0);
+}
+
+/*
+ * Return an epoll descriptor that becomes readable when there's data to
+ * read (once there is a receive eventfd) or the peer has gone away.
+ */
+
+static int
+netsnmp_shm_conn_epoll(netsnmp_shm_conn *conn)
+{
+    struct epoll_event ev;
+    int             epfd;
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0)
+        return -1;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    if ((conn->efd_rx >= 0 &&
+         epoll_ctl(epfd, EPOLL_CTL_ADD, conn->efd_rx, &ev) != 0) ||
+        epoll_ctl(epfd, EPOLL_CTL_ADD, conn->sock, &ev) != 0) {
+        close(epfd);
+        return -1;
+    }
+    return epfd;
+}
+
+/*
+ * Copy as much of p as there is room for into the send ring, and
+ * return how much that was.
+ */
+
+static int
+netsnmp_shm_ring_write(netsnmp_shm_conn *conn, const u_char *p,
+                       uint32_t left)
+{
+    uint32_t        head, tail, used, off, n;
+
+    tail = conn->tx->tail;
+    head = conn->tx->head;
+    NETSNMP_SHM_BARRIER();
+    used = tail - head;
+    if (used > conn->size) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    n = conn->size - used;
+    if (n > left)
+        n = left;
+    if (n == 0)
+        return 0;
+    off = tail & (conn->size - 1);
+    if (off + n <= conn->size) {
+        memcpy(conn->tx_data + off, p, n);
+    } else {
+        memcpy(conn->tx_data + off, p, conn->size - off);
+        memcpy(conn->tx_data, p + (conn->size - off),
+               n - (conn->size - off));
+    }
+
+    NETSNMP_SHM_BARRIER();
+    conn->tx->tail = tail + n;
+    NETSNMP_SHM_BARRIER();
+
+    /*
+     * Only wake the reader if it had emptied the ring before this
+     * write, and so may be waiting; otherwise it will find this data
+     * when it rechecks the ring after its current read.
+     */
+    if (conn->tx->head == tail)
+        netsnmp_shm_signal(conn->efd_tx);
+    return n;
+}
+
+/*
+ * Move as much queued data into the send ring as will fit.  If some is
+ * left, ask the reader to wake us up when it has made room.
+ */
+
+static int
+netsnmp_shm_flush(netsnmp_shm_conn *conn)
+{
+    int             n;
+
+    if (conn->hdr == NULL)
+        return 0;
+
+    while (conn->pending_len > 0) {
+        n = netsnmp_shm_ring_write(conn, conn->pending, conn->pending_len);
+        if (n < 0)
+            return -1;
+        if (n == 0) {
+            if (conn->tx->waiting)
+                break;
+            conn->tx->waiting = 1;
+            NETSNMP_SHM_BARRIER();
+            /*
+             * look again, in case the reader made room before it could
+             * have seen the flag
+             */
+            continue;
+        }
+        conn->pending_len -= n;
+        memmove(conn->pending, conn->pending + n, conn->pending_len);
+    }
+    return 0;
+}
+
+/*
+ * The server end of the handshake: receive the shared region and
+ * eventfds from the client, check them, and acknowledge.  This is done
+ * as the client's message arrives, rather than waiting for it in
+ * accept(), so that a slow or stuck client doesn't hold up anything
+ * else.  Returns 1 once the connection is set up, 0 if the message
+ * hasn't arrived yet, and -1 if the connection should be dropped.
+ */
+
+static int
+netsnmp_shm_handshake(netsnmp_transport *t, netsnmp_shm_conn *conn)
+{
+    netsnmp_shm_data *sd = (netsnmp_shm_data *) t->data;
+    struct epoll_event ev;
+    struct msghdr   msg;
+    struct iovec    iov;
+    struct cmsghdr *cmsg;
+    union {
+        struct cmsghdr  align;
+        char            buf[CMSG_SPACE(3 * sizeof(int))];
+    } control;
+    struct stat     st;
+    int             fds[3] = { -1, -1, -1 };
+    int             rc, i;
+    char            c;
+
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base = &c;
+    iov.iov_len = 1;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    rc = recvmsg(conn->sock, &msg, MSG_CMSG_CLOEXEC | MSG_DONTWAIT);
+    if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK ||
+                   errno == EINTR))
+        return 0;
+    if (rc != 1)
+        return -1;
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(3 * sizeof(int)))
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    }
+    if (fds[0] < 0 || (msg.msg_flags & MSG_CTRUNC))
+        goto fail;
+    conn->efd_rx = fds[1];
+    conn->efd_tx = fds[2];
+    fds[1] = fds[2] = -1;
+
+    if (fstat(fds[0], &st) != 0 ||
+        st.st_size <= (off_t) sizeof(netsnmp_shm_header))
+        goto fail;
+    conn->map_len = st.st_size;
+    conn->hdr = (netsnmp_shm_header *) mmap(NULL, conn->map_len,
+                                            PROT_READ | PROT_WRITE,
+                                            MAP_SHARED, fds[0], 0);
+    if (conn->hdr == MAP_FAILED) {
+        conn->hdr = NULL;
+        goto fail;
+    }
+    close(fds[0]);
+    fds[0] = -1;
+
+    if (conn->hdr->magic != NETSNMP_SHM_MAGIC ||
+        conn->hdr->version != NETSNMP_SHM_VERSION ||
+        conn->hdr->ring_size < 4096 ||
+        (conn->hdr->ring_size & (conn->hdr->ring_size - 1)) != 0 ||
+        conn->map_len != sizeof(netsnmp_shm_header) +
+                         2 * (size_t) conn->hdr->ring_size) {
+        snmp_log(LOG_WARNING, "shm: bad shared region offered on %s\n",
+                 sd->name);
+        goto fail;
+    }
+    netsnmp_shm_conn_rings(conn, 1);
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    if (epoll_ctl(t->sock, EPOLL_CTL_ADD, conn->efd_rx, &ev) != 0 ||
+        send(conn->sock, "", 1, MSG_NOSIGNAL | MSG_DONTWAIT) != 1)
+        goto fail;
+
+    DEBUGMSGTL(("netsnmp_shm", "connection on %s set up (fd %d)\n",
+                sd->name, t->sock));
+    if (netsnmp_shm_flush(conn) < 0)
+        return -1;
+    return 1;
+
+  fail:
+    for (i = 0; i < 3; i++)
+        if (fds[i] >= 0)
+            close(fds[i]);
+    if (conn->hdr != NULL) {
+        munmap(conn->hdr, conn->map_len);
+        conn->hdr = NULL;
+    }
+    return -1;
+}
+
+
+
+/*
+ * Copy as much as is available (up to size) out of the receive ring.
+ * The transport is a byte stream, so the AgentX/SNMP packet checking
+ * puts messages back together if they arrive in pieces.
+ */
+
+static int
+netsnmp_shm_recv(netsnmp_transport *t, void *buf, int size,
+                 void **opaque, int *olength)
+{
+    netsnmp_shm_data *sd;
+    netsnmp_shm_conn *conn;
+    uint64_t        count;
+    uint32_t        head, avail, off, n;
+    char            c;
+    int             rc;
+
+    if (t == NULL || t->data == NULL || size <= 0)
+        return -1;
+    sd = (netsnmp_shm_data *) t->data;
+    conn = sd->conn;
+    if (conn == NULL)
+        return -1;
+
+    if (conn->hdr == NULL) {
+        if (netsnmp_shm_handshake(t, conn) < 0)
+            return 0;
+        t->flags |= NETSNMP_TRANSPORT_FLAG_EMPTY_PKT;
+        return 0;
+    }
+
+    /*
+     * Clear the wakeup before looking at the ring: anything written after
+     * this point either shows up below or signals again.
+     */
+    if (read(conn->efd_rx, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        DEBUGMSGTL(("netsnmp_shm", "eventfd %d read failed: %s\n",
+                    conn->efd_rx, strerror(errno)));
+
+    /*
+     * The wakeup may have been the peer making room for data we queued.
+     */
+    if (conn->pending_len > 0 && netsnmp_shm_flush(conn) < 0) {
+        snmp_log(LOG_ERR, "shm: corrupt send ring on %s\n", sd->name);
+        return 0;
+    }
+
+    head = conn->rx->head;
+    avail = conn->rx->tail - head;
+    NETSNMP_SHM_BARRIER();
+
+    if (avail > conn->size) {
+        snmp_log(LOG_ERR, "shm: corrupt receive ring on %s\n", sd->name);
+        return 0;
+    }
+
+    if (avail == 0) {
+        /*
+         * Nothing to read: either a stale wakeup, or the peer has closed
+         * its socket.  It never sends anything over it after the
+         * handshake, so any data is a protocol error too.
+         */
+        rc = recv(conn->sock, &c, 1, MSG_DONTWAIT);
+        if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK ||
+                       errno == EINTR)) {
+            t->flags |= NETSNMP_TRANSPORT_FLAG_EMPTY_PKT;
+            return 0;
+        }
+        DEBUGMSGTL(("netsnmp_shm", "peer on %s closed\n", sd->name));
+        return 0;
+    }
+
+    n = avail < (uint32_t) size ? avail : (uint32_t) size;
+    off = head & (conn->size - 1);
+    if (off + n <= conn->size) {
+        memcpy(buf, conn->rx_data + off, n);
+    } else {
+        memcpy(buf, conn->rx_data + off, conn->size - off);
+        memcpy((u_char *) buf + (conn->size - off), conn->rx_data,
+               n - (conn->size - off));
+    }
+
+    NETSNMP_SHM_BARRIER();
+    conn->rx->head = head + n;
+    NETSNMP_SHM_BARRIER();
+
+    if (conn->rx->waiting) {
+        conn->rx->waiting = 0;
+        netsnmp_shm_signal(conn->efd_tx);
+    }
+
+    /*
+     * If there's still something left (or more has arrived since the
+     * writer last saw the ring empty), make sure we get woken up again.
+     */
+    if (conn->rx->tail != head + n)
+        netsnmp_shm_signal(conn->efd_rx);
+
+    DEBUGMSGTL(("netsnmp_shm", "recv on %s got %u bytes\n", sd->name, n));
+    return n;
+}
+
+
+
+/*
+ * Never wait for the other end: whatever doesn't fit into the send ring
+ * is queued, and moved into it when the reader wakes us up.
+ */
+
+static int
+netsnmp_shm_send(netsnmp_transport *t, void *buf, int size,
+                 void **opaque, int *olength)
+{
+    netsnmp_shm_data *sd;
+    netsnmp_shm_conn *conn;
+    u_char         *pending;
+    int             n = 0;
+
+    if (t == NULL || t->data == NULL || size < 0)
+        return -1;
+    sd = (netsnmp_shm_data *) t->data;
+    conn = sd->conn;
+    if (conn == NULL)
+        return -1;
+
+    DEBUGMSGTL(("netsnmp_shm", "send %d bytes on %s\n", size, sd->name));
+
+    if (conn->pending_len + size > NETSNMP_SHM_MAX_PENDING) {
+        DEBUGMSGTL(("netsnmp_shm", "send queue on %s is full\n",
+                    sd->name));
+        errno = EAGAIN;
+        return -1;
+    }
+
+    /*
+     * Anything already queued has to go first.
+     */
+    if (conn->hdr != NULL && conn->pending_len == 0) {
+        n = netsnmp_shm_ring_write(conn, (const u_char *) buf, size);
+        if (n < 0) {
+            snmp_log(LOG_ERR, "shm: corrupt send ring on %s\n", sd->name);
+            return -1;
+        }
+    }
+    if (n < size) {
+        pending = (u_char *) realloc(conn->pending,
+                                     conn->pending_len + size - n);
+        if (pending == NULL)
+            return -1;
+        memcpy(pending + conn->pending_len, (const u_char *) buf + n,
+               size - n);
+        conn->pending = pending;
+        conn->pending_len += size - n;
+        DEBUGMSGTL(("netsnmp_shm", "queued %d bytes on %s\n", size - n,
+                    sd->name));
+        if (netsnmp_shm_flush(conn) < 0)
+            return -1;
+    }
+    return size;
+}
+
+
+
+static int
+netsnmp_shm_close(netsnmp_transport *t)
+{
+    netsnmp_shm_data *sd = (netsnmp_shm_data *) t->data;
+    int             rc = -1;
+
+    if (sd != NULL && sd->conn != NULL) {
+        netsnmp_shm_conn_free(sd->conn);
+        sd->conn = NULL;
+    }
+    if (t->sock >= 0) {
+        DEBUGMSGTL(("netsnmp_shm", "close fd %d\n", t->sock));
+        rc = close(t->sock);
+        t->sock = -1;
+    }
+    return rc;
+}
+
+
+
+/*
+ * Accept a connection on a listening transport.  The new connection is
+ * left in the listener's data for netsnmp_shm_copy() to hand on to the
+ * transport that snmp_api creates for it, and is set up by
+ * netsnmp_shm_handshake() once the client's shared region arrives.
+ */
+
+static int
+netsnmp_shm_accept(netsnmp_transport *t)
+{
+    netsnmp_shm_data *sd = (netsnmp_shm_data *) t->data;
+    netsnmp_shm_conn *conn;
+    struct ucred    cred;
+    socklen_t       cred_len = sizeof(cred);
+    int             newsock, epfd;
+
+    if (sd == NULL || t->sock < 0)
+        return -1;
+
+    newsock = accept(t->sock, NULL, NULL);
+    if (newsock < 0) {
+        DEBUGMSGTL(("netsnmp_shm", "accept failed: %s\n", strerror(errno)));
+        return -1;
+    }
+
+    conn = (netsnmp_shm_conn *) calloc(1, sizeof(netsnmp_shm_conn));
+    if (conn == NULL) {
+        close(newsock);
+        return -1;
+    }
+    conn->sock = newsock;
+    conn->efd_rx = conn->efd_tx = -1;
+
+    /*
+     * Anyone on the host can reach an abstract socket, so only talk to
+     * processes running as ourselves or root.
+     */
+    if (getsockopt(newsock, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) != 0 ||
+        (cred.uid != geteuid() && cred.uid != 0)) {
+        snmp_log(LOG_WARNING, "shm: rejecting connection on %s from uid %d\n",
+                 sd->name, (int) cred.uid);
+        netsnmp_shm_conn_free(conn);
+        return -1;
+    }
+
+    epfd = netsnmp_shm_conn_epoll(conn);
+    if (epfd < 0) {
+        netsnmp_shm_conn_free(conn);
+        return -1;
+    }
+
+    netsnmp_shm_conn_free(sd->conn);
+    sd->conn = conn;
+    DEBUGMSGTL(("netsnmp_shm", "accepted connection on %s (fd %d)\n",
+                sd->name, epfd));
+    return epfd;
+}
+
+/*
+ * The accepted connection belongs to the new transport only.
+ */
+
+static int
+netsnmp_shm_copy(netsnmp_transport *oldt, netsnmp_transport *newt)
+{
+    ((netsnmp_shm_data *) oldt->data)->conn = NULL;
+    ((netsnmp_shm_data *) newt->data)->local = 0;
+    return 0;
+}
+
+
+
+/*
+ * Set up the client end of a connection: create the shared region and
+ * eventfds, pass them to the server and wait for it to accept them.
+ */
+
+static netsnmp_shm_conn *
+netsnmp_shm_connect(const struct sockaddr_un *addr, socklen_t addr_len)
+{
+    netsnmp_shm_conn *conn;
+    struct msghdr   msg;
+    struct iovec    iov;
+    struct cmsghdr *cmsg;
+    union {
+        struct cmsghdr  align;
+        char            buf[CMSG_SPACE(3 * sizeof(int))];
+    } control;
+    struct pollfd   pfd;
+    char            path[] = "/dev/shm/net-snmp-shm.XXXXXX";
+    int             fds[3];
+    int             memfd;
+    char            c = 0;
+
+    conn = (netsnmp_shm_conn *) calloc(1, sizeof(netsnmp_shm_conn));
+    if (conn == NULL)
+        return NULL;
+    conn->sock = conn->efd_rx = conn->efd_tx = -1;
+
+    memfd = mkstemp(path);
+    if (memfd < 0) {
+        strcpy(path, "/tmp/net-snmp-shm.XXXXXX");
+        memfd = mkstemp(path);
+    }
+    if (memfd < 0) {
+        DEBUGMSGTL(("netsnmp_shm", "mkstemp failed: %s\n", strerror(errno)));
+        free(conn);
+        return NULL;
+    }
+    unlink(path);
+
+    conn->map_len = sizeof(netsnmp_shm_header) + 2 * NETSNMP_SHM_RING_SIZE;
+    if (ftruncate(memfd, conn->map_len) != 0)
+        goto fail;
+    conn->hdr = (netsnmp_shm_header *) mmap(NULL, conn->map_len,
+                                            PROT_READ | PROT_WRITE,
+                                            MAP_SHARED, memfd, 0);
+    if (conn->hdr == MAP_FAILED) {
+        conn->hdr = NULL;
+        goto fail;
+    }
+    conn->hdr->magic = NETSNMP_SHM_MAGIC;
+    conn->hdr->version = NETSNMP_SHM_VERSION;
+    conn->hdr->ring_size = NETSNMP_SHM_RING_SIZE;
+
+    /*
+     * efd_rx is signalled by the server when it writes to the server to
+     * client ring, and efd_tx by us; the server gets them swapped round.
+     */
+    conn->efd_rx = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    conn->efd_tx = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    conn->sock = socket(PF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (conn->efd_rx < 0 || conn->efd_tx < 0 || conn->sock < 0)
+        goto fail;
+    if (connect(conn->sock, (const struct sockaddr *) addr, addr_len) != 0) {
+        DEBUGMSGTL(("netsnmp_shm", "couldn't connect to \"%s\": %s\n",
+                    addr->sun_path + 1, strerror(errno)));
+        goto fail;
+    }
+
+    fds[0] = memfd;
+    fds[1] = conn->efd_tx;
+    fds[2] = conn->efd_rx;
+    memset(&msg, 0, sizeof(msg));
+    memset(&control, 0, sizeof(control));
+    iov.iov_base = &c;
+    iov.iov_len = 1;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = CMSG_SPACE(sizeof(fds));
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    if (sendmsg(conn->sock, &msg, MSG_NOSIGNAL) != 1)
+        goto fail;
+
+    pfd.fd = conn->sock;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, NETSNMP_SHM_CONNECT_TIMEOUT) <= 0 ||
+        recv(conn->sock, &c, 1, 0) != 1) {
+        DEBUGMSGTL(("netsnmp_shm", "server on \"%s\" didn't accept\n",
+                    addr->sun_path + 1));
+        goto fail;
+    }
+
+    close(memfd);
+    return conn;
+
+  fail:
+    close(memfd);
+    netsnmp_shm_conn_free(conn);
+    return NULL;
+}
+
+
+
+/*
+ * Open a shared memory transport.  Local is TRUE if this is to listen for
+ * connections on name (i.e. this is a server-type session); otherwise
+ * connect to the server listening on name.
+ */
+
+netsnmp_transport *
+netsnmp_shm_transport(const char *name, int local)
+{
+    netsnmp_transport *t = NULL;
+    netsnmp_shm_data *sd = NULL;
+    struct sockaddr_un addr;
+    socklen_t       addr_len;
+
+    if (name == NULL || *name == '\0' ||
+        strlen(name) >= sizeof(sd->name) ||
+        netsnmp_shm_sockaddr(name, &addr, &addr_len) != 0) {
+        snmp_log(LOG_ERR, "Bad name for shared memory transport\n");
+        return NULL;
+    }
+
+    DEBUGMSGTL(("netsnmp_shm", "open %s %s\n", local ? "local" : "remote",
+                name));
+
+    t = SNMP_MALLOC_TYPEDEF(netsnmp_transport);
+    if (t == NULL)
+        return NULL;
+    t->sock = -1;
+
+    t->domain = netsnmp_ShmDomain;
+    t->domain_length = sizeof(netsnmp_ShmDomain) / sizeof(netsnmp_ShmDomain[0]);
+
+    sd = SNMP_MALLOC_TYPEDEF(netsnmp_shm_data);
+    if (sd == NULL) {
+        netsnmp_transport_free(t);
+        return NULL;
+    }
+    t->data = sd;
+    t->data_length = sizeof(netsnmp_shm_data);
+    sd->local = local;
+    strcpy(sd->name, name);
+
+    t->flags = NETSNMP_TRANSPORT_FLAG_STREAM;
+
+    if (local) {
+        t->local = (u_char *) strdup(name);
+        if (t->local == NULL) {
+            netsnmp_transport_free(t);
+            return NULL;
+        }
+        t->local_length = strlen(name);
+
+        t->sock = socket(PF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (t->sock < 0 ||
+            bind(t->sock, (struct sockaddr *) &addr, addr_len) != 0 ||
+            listen(t->sock, NETSNMP_STREAM_QUEUE_LEN) != 0) {
+            DEBUGMSGTL(("netsnmp_shm", "couldn't listen on \"%s\": %s\n",
+                        name, strerror(errno)));
+            netsnmp_shm_close(t);
+            netsnmp_transport_free(t);
+            return NULL;
+        }
+        t->flags |= NETSNMP_TRANSPORT_FLAG_LISTEN;
+    } else {
+        t->remote = (u_char *) strdup(name);
+        if (t->remote == NULL) {
+            netsnmp_transport_free(t);
+            return NULL;
+        }
+        t->remote_length = strlen(name);
+
+        sd->conn = netsnmp_shm_connect(&addr, addr_len);
+        if (sd->conn != NULL)
+            netsnmp_shm_conn_rings(sd->conn, 0);
+        if (sd->conn == NULL ||
+            (t->sock = netsnmp_shm_conn_epoll(sd->conn)) < 0) {
+            netsnmp_shm_close(t);
+            netsnmp_transport_free(t);
+            return NULL;
+        }
+    }
+
+    /*
+     * Message size is not limited by this transport (hence msgMaxSize
+     * is equal to the maximum legal size of an SNMP message).
+     */
+
+    t->msgMaxSize = 0x7fffffff;
+    t->f_recv     = netsnmp_shm_recv;
+    t->f_send     = netsnmp_shm_send;
+    t->f_close    = netsnmp_shm_close;
+    t->f_accept   = netsnmp_shm_accept;
+    t->f_copy     = netsnmp_shm_copy;
+    t->f_fmtaddr  = netsnmp_shm_fmtaddr;
+
+    return t;
+}
+
+netsnmp_transport *
+netsnmp_shm_create_tstring(const char *string, int local,
+                           const char *default_target)
+{
+    if (string == NULL || *string == '\0')
+        string = default_target;
+    return netsnmp_shm_transport(string, local);
+}
+
+netsnmp_transport *
+netsnmp_shm_create_ostring(const u_char * o, size_t o_len, int local)
+{
+    char            name[sizeof(((struct sockaddr_un *) 0)->sun_path)];
+
+    if (o_len == 0 || o_len >= sizeof(name))
+        return NULL;
+    memcpy(name, o, o_len);
+    name[o_len] = '\0';
+    return netsnmp_shm_transport(name, local);
+}
+
+
+
+void
+netsnmp_shm_ctor(void)
+{
+    shmDomain.name = netsnmp_ShmDomain;
+    shmDomain.name_length = sizeof(netsnmp_ShmDomain) / sizeof(oid);
+    shmDomain.prefix = (const char**)calloc(2, sizeof(char *));
+    shmDomain.prefix[0] = "shm";
+
+    shmDomain.f_create_from_tstring     = NULL;
+    shmDomain.f_create_from_tstring_new = netsnmp_shm_create_tstring;
+    shmDomain.f_create_from_ostring     = netsnmp_shm_create_ostring;
+
+    netsnmp_tdomain_register(&shmDomain);
+}
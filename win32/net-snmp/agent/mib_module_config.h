@@ -248,6 +248,9 @@
 
 #ifdef USING_DISMAN_EVENT_MODULE 
  
+/* Define if compiling with the disman/event/mteSample module files.  */
+#define USING_DISMAN_EVENT_MTESAMPLE_MODULE 1
+ 
 /* Define if compiling with the disman/event/mteScalars module files.  */
 #define USING_DISMAN_EVENT_MTESCALARS_MODULE 1
  
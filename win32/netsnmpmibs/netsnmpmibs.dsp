@@ -197,6 +197,10 @@ SOURCE=..\..\agent\mibgroup\disman\event\mteObjectsTable.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\agent\mibgroup\disman\event\mteSample.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\agent\mibgroup\disman\event\mteScalars.c
 # End Source File
 # Begin Source File